@@ -22,6 +22,8 @@
 #include <stdexcept>
 #include <string>
 
+// METAPP_EXCEPTION_ENABLED is defined if exceptions are enabled in the compiler and METAPP_DISABLE_EXCEPTION is not defined.
+// The source files use it to guard try/catch.
 #ifndef METAPP_DISABLE_EXCEPTION
 
 #ifdef METAPP_COMPILER_VC
@@ -131,6 +133,19 @@ public:
 	}
 };
 
+// Status codes returned by the exception-free try* functions, such as Variant::tryCast,
+// tryCallableInvoke, tryIndexableGet, and tryAccessibleSet.
+// Each non-ok code corresponds to the exception the throwing counterpart raises.
+enum class ErrorCode
+{
+	ok,
+	unsupported,
+	badCast,
+	illegalArgument,
+	outOfRange,
+	unwritable
+};
+
 // When calling raiseException, the caller should put a "return" after the call,
 // because if exception is disabled, no exception will be throw and the execute flow
 // may coninue if there is no "return".
@@ -146,9 +161,5 @@ void raiseException(Args && ... args)
 
 } // namespace metapp
 
-#ifdef METAPP_EXCEPTION_ENABLED
-#undef METAPP_EXCEPTION_ENABLED
-#endif
-
 
 #endif
@@ -0,0 +1,52 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_CASTCACHE_I_H_969872685611
+#define METAPP_CASTCACHE_I_H_969872685611
+
+#include <cstdint>
+
+namespace metapp {
+
+class MetaType;
+
+namespace internal_ {
+
+enum class CastCacheResult
+{
+	no,
+	yes,
+	unknown
+};
+
+// A lock free memo of canCast results, keyed by (from meta type, to meta type).
+// The entries are stamped with the inheritance generation, which the caller reads before computing the result,
+// so registering base classes or repos invalidates the entries, and registering items doesn't.
+// It must not be used for types whose cast depends on the value, that's the types without tfCastCacheable.
+CastCacheResult findCanCastCache(const MetaType * fromMetaType, const MetaType * toMetaType, const std::uint64_t generation);
+void storeCanCastCache(
+	const MetaType * fromMetaType,
+	const MetaType * toMetaType,
+	const std::uint64_t generation,
+	const bool canCast
+);
+
+} // namespace internal_
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,46 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef METAPP_CHANGETRACKER_I_H_969872685611
+#define METAPP_CHANGETRACKER_I_H_969872685611
+
+#include <atomic>
+#include <cstddef>
+
+namespace metapp {
+
+class Variant;
+
+namespace internal_ {
+
+// The number of the instances tracked by ChangeTracker. The hooks only check it when there is no tracked instance.
+extern std::atomic<std::size_t> trackedInstanceCount;
+
+inline bool isChangeTrackingActive()
+{
+	return trackedInstanceCount.load(std::memory_order_relaxed) != 0;
+}
+
+// Called after the value is written, they do nothing if the instance, indexable, or mappable is not tracked.
+void recordAccessibleChange(const Variant & accessible, const Variant & instance);
+void recordIndexableChange(const Variant & indexable, const std::size_t index);
+void recordMappableChange(const Variant & mappable, const Variant & key);
+
+} // namespace internal_
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,174 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_COPYONWRITE_I_H_969872685611
+#define METAPP_COPYONWRITE_I_H_969872685611
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace metapp {
+
+namespace internal_ {
+
+// A value that is read lock free and written by copying it.
+// The readers hold a Reader while they use the value. The writer publishes a modified copy,
+// and frees the replaced versions once no reader is active, so the memory stays at one version
+// plus the versions that are still being read.
+// The readers are counted in padded shards to avoid the readers on different threads contending on one cache line.
+// All the counter and pointer operations are sequentially consistent. If the writer sees zero readers
+// after it published the new version, any reader that comes later must load the new version.
+template <typename T>
+class CopyOnWriteValue
+{
+private:
+	static constexpr std::size_t shardCount = 16;
+
+	struct Shard
+	{
+		std::atomic<std::size_t> readerCount;
+		char padding[64 - sizeof(std::atomic<std::size_t>)];
+	};
+
+public:
+	class Reader
+	{
+	public:
+		Reader(const Reader &) = delete;
+		Reader & operator = (const Reader &) = delete;
+
+		Reader(Reader && other) noexcept : owner(other.owner), shard(other.shard), value(other.value) {
+			other.owner = nullptr;
+		}
+
+		~Reader() {
+			if(owner != nullptr) {
+				owner->leave(shard);
+			}
+		}
+
+		const T & operator * () const {
+			return *value;
+		}
+
+		const T * operator -> () const {
+			return value;
+		}
+
+	private:
+		Reader(const CopyOnWriteValue * owner_, Shard * shard_)
+			: owner(owner_), shard(shard_), value(owner_->current.load())
+		{
+		}
+
+	private:
+		const CopyOnWriteValue * owner;
+		Shard * shard;
+		const T * value;
+
+		friend class CopyOnWriteValue;
+	};
+
+public:
+	CopyOnWriteValue() : shards(), current(new T()), mutex(), retiredList(), hasRetired(false) {
+		for(auto & shard : shards) {
+			shard.readerCount.store(0);
+		}
+	}
+
+	~CopyOnWriteValue() {
+		delete current.load();
+	}
+
+	CopyOnWriteValue(const CopyOnWriteValue &) = delete;
+	CopyOnWriteValue & operator = (const CopyOnWriteValue &) = delete;
+
+	Reader read() const {
+		Shard * shard = &shards[getShardIndex()];
+		shard->readerCount.fetch_add(1);
+		return Reader(this, shard);
+	}
+
+	// Calls modifier(T & copy) with a copy of the current value while holding the writer lock.
+	// The copy is published only if the modifier returns true.
+	template <typename F>
+	void update(F && modifier) {
+		std::lock_guard<std::mutex> lock(mutex);
+		const T * oldValue = current.load();
+		std::unique_ptr<T> newValue(new T(*oldValue));
+		if(! modifier(*newValue)) {
+			return;
+		}
+		current.store(newValue.release());
+		retiredList.emplace_back(oldValue);
+		hasRetired.store(true);
+		doReclaim();
+	}
+
+private:
+	static std::size_t getShardIndex() {
+		// Each thread has its own marker, hashing its address spreads the threads over the shards
+		// without initializing anything per thread.
+		static thread_local char marker;
+		static_assert(shardCount == 16, "The hash takes the top 4 bits");
+		return static_cast<std::size_t>(
+			(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(&marker)) * 11400714819323198485ull) >> 60
+		);
+	}
+
+	void leave(Shard * shard) const {
+		if(shard->readerCount.fetch_sub(1) == 1 && hasRetired.load()) {
+			// The last reader in the shard frees the replaced versions the writer couldn't free.
+			std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+			if(lock.owns_lock()) {
+				doReclaim();
+			}
+		}
+	}
+
+	// Must be called with the mutex locked.
+	void doReclaim() const {
+		if(retiredList.empty()) {
+			return;
+		}
+		for(const auto & shard : shards) {
+			if(shard.readerCount.load() != 0) {
+				return;
+			}
+		}
+		retiredList.clear();
+		hasRetired.store(false);
+	}
+
+private:
+	mutable Shard shards[shardCount];
+	std::atomic<const T *> current;
+	// Serializes the writers and the reclamation.
+	mutable std::mutex mutex;
+	mutable std::vector<std::unique_ptr<const T> > retiredList;
+	mutable std::atomic<bool> hasRetired;
+};
+
+} // namespace internal_
+
+} // namespace metapp
+
+#endif
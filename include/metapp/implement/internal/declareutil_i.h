@@ -25,6 +25,8 @@
 #include <numeric>
 #include <algorithm>
 #include <limits>
+#include <tuple>
+#include <array>
 
 namespace metapp {
 
@@ -197,6 +199,287 @@ struct MetaCallableInvoker <Class, void, ArgList>
 	}
 };
 
+#ifdef METAPP_ENABLE_PROFILING
+
+template <typename Class>
+struct ProfiledTargetCaller
+{
+	template <typename FT, typename ...Args>
+	static auto call(FT && func, void * instance, Args && ... args)
+		-> decltype((static_cast<Class *>(instance)->*func)(std::forward<Args>(args)...))
+	{
+		return (static_cast<Class *>(instance)->*func)(std::forward<Args>(args)...);
+	}
+};
+
+template <>
+struct ProfiledTargetCaller <void>
+{
+	template <typename FT, typename ...Args>
+	static auto call(FT && func, void * /*instance*/, Args && ... args)
+		-> decltype(func(std::forward<Args>(args)...))
+	{
+		return func(std::forward<Args>(args)...);
+	}
+};
+
+template <typename Class, typename RT>
+struct ProfiledResultBoxer
+{
+	template <typename FT, typename ...Args>
+	static Variant callAndBox(ProfileTimer & timer, const Variant * key, FT && func, void * instance, Args && ... args) {
+		RT && result = ProfiledTargetCaller<Class>::call(std::forward<FT>(func), instance, std::forward<Args>(args)...);
+		timer.record(key, ProfilePhase::call);
+		Variant boxed = Variant::create<RT>(std::forward<RT>(result));
+		timer.record(key, ProfilePhase::box);
+		return boxed;
+	}
+};
+
+template <typename Class>
+struct ProfiledResultBoxer <Class, void>
+{
+	template <typename FT, typename ...Args>
+	static Variant callAndBox(ProfileTimer & timer, const Variant * key, FT && func, void * instance, Args && ... args) {
+		ProfiledTargetCaller<Class>::call(std::forward<FT>(func), instance, std::forward<Args>(args)...);
+		timer.record(key, ProfilePhase::call);
+		return Variant();
+	}
+};
+
+// Same as MetaCallableInvoker, but casts all arguments before the call, so the cast, call, and box phases
+// are timed separately. It's only used when the profiler is recording.
+template <typename Class, typename RT, typename ArgList>
+struct MetaCallableProfilingInvoker
+{
+	using ArgumentTypeList = ArgList;
+	static constexpr int argCount = TypeListCount<ArgumentTypeList>::value;
+
+	template <typename FT>
+	static Variant invoke(FT && func, void * instance, const ArgumentSpan & arguments, const Variant * key) {
+		using Sequence = typename MakeIntSequence<argCount>::Type;
+		return doInvoke(std::forward<FT>(func), instance, arguments, key, Sequence());
+	}
+
+	template <typename FT, int ...Indexes>
+	static Variant doInvoke(FT && func, void * instance, const ArgumentSpan & arguments, const Variant * key, IntConstantList<Indexes...>) {
+		ProfileTimer timer;
+		std::array<Variant, argCount> castedArguments {{
+			arguments[Indexes].template cast<typename TypeListGetAt<ArgumentTypeList, Indexes>::Type>()...
+		}};
+		timer.record(key, ProfilePhase::cast);
+		return ProfiledResultBoxer<Class, RT>::callAndBox(
+			timer,
+			key,
+			std::forward<FT>(func),
+			instance,
+			castedArguments[Indexes].template get<typename TypeListGetAt<ArgumentTypeList, Indexes>::Type &>()...
+		);
+	}
+};
+
+#endif
+
+// BatchArgumentReader reads one argument column in MetaCallable::invokeBatch.
+// The cast plan is decided once on the first row. A row which has the same meta type as the first row
+// and matches the parameter type exactly is passed to the function without any cast.
+// Any other row is casted the same way as MetaCallable::invoke does.
+template <typename T>
+struct BatchArgumentReader
+{
+	explicit BatchArgumentReader(const ArgumentSpan & column)
+		:
+			column(column),
+			planMetaType(column.empty() ? nullptr : column[0].getMetaType()),
+			exactMatch(planMetaType != nullptr
+				&& getNonReferenceMetaType(planMetaType)->equal(getNonReferenceMetaType(getMetaType<T>()))),
+			casted()
+	{
+	}
+
+	T & read(const std::size_t row) {
+		const Variant & argument = column[row];
+		if(exactMatch && argument.getMetaType() == planMetaType) {
+			return argument.template get<T &>();
+		}
+		casted = argument.template cast<T>();
+		return casted.template get<T &>();
+	}
+
+	ArgumentSpan column;
+	const MetaType * planMetaType;
+	bool exactMatch;
+	Variant casted;
+};
+
+template <typename Class, typename RT>
+struct BatchRowCaller
+{
+	template <typename FT, typename ...Args>
+	static void call(FT && func, void * instance, Variant * result, Args && ... args) {
+		if(result != nullptr) {
+			*result = Variant::create<RT>((static_cast<Class *>(instance)->*func)(std::forward<Args>(args)...));
+		}
+		else {
+			(static_cast<Class *>(instance)->*func)(std::forward<Args>(args)...);
+		}
+	}
+};
+
+template <typename Class>
+struct BatchRowCaller <Class, void>
+{
+	template <typename FT, typename ...Args>
+	static void call(FT && func, void * instance, Variant * /*result*/, Args && ... args) {
+		(static_cast<Class *>(instance)->*func)(std::forward<Args>(args)...);
+	}
+};
+
+template <typename RT>
+struct BatchRowCaller <void, RT>
+{
+	template <typename FT, typename ...Args>
+	static void call(FT && func, void * /*instance*/, Variant * result, Args && ... args) {
+		if(result != nullptr) {
+			*result = Variant::create<RT>(func(std::forward<Args>(args)...));
+		}
+		else {
+			func(std::forward<Args>(args)...);
+		}
+	}
+};
+
+template <>
+struct BatchRowCaller <void, void>
+{
+	template <typename FT, typename ...Args>
+	static void call(FT && func, void * /*instance*/, Variant * /*result*/, Args && ... args) {
+		func(std::forward<Args>(args)...);
+	}
+};
+
+// RefArgumentReader reads one argument in MetaCallable::invokeRef.
+// An argument which matches the parameter type exactly is passed to the function from its address without any Variant,
+// any other argument is casted the same way as MetaCallable::invoke does.
+template <typename T>
+struct RefArgumentReader
+{
+	explicit RefArgumentReader(const VariantRef & argument)
+		: argument(argument), hasCasted(false)
+	{
+	}
+
+	~RefArgumentReader() {
+		if(hasCasted) {
+			getCasted().~Variant();
+		}
+	}
+
+	RefArgumentReader(const RefArgumentReader &) = delete;
+	RefArgumentReader & operator = (const RefArgumentReader &) = delete;
+
+	T & read() {
+		if(getNonReferenceMetaType(argument)->equal(getNonReferenceMetaType(getMetaType<T>()))) {
+			return argument.template get<T &>();
+		}
+		new (&castedStorage) Variant(argument.toVariant().template cast<T>());
+		hasCasted = true;
+		return getCasted().template get<T &>();
+	}
+
+	Variant & getCasted() {
+		return *reinterpret_cast<Variant *>(&castedStorage);
+	}
+
+	VariantRef argument;
+	// The casted argument is only constructed if the argument doesn't match exactly.
+	typename std::aligned_storage<sizeof(Variant), alignof(Variant)>::type castedStorage;
+	bool hasCasted;
+};
+
+template <typename Class, typename RT, typename ArgList>
+struct MetaCallableRefInvoker
+{
+	using ArgumentTypeList = ArgList;
+	static constexpr int argCount = TypeListCount<ArgumentTypeList>::value;
+
+	template <typename FT>
+	static Variant invoke(FT && func, void * instance, const ArgumentRefSpan & arguments) {
+		using Sequence = typename MakeIntSequence<argCount>::Type;
+		return doInvoke(std::forward<FT>(func), instance, arguments, Sequence());
+	}
+
+	template <typename FT, int ...Indexes>
+	static Variant doInvoke(FT && func, void * instance, const ArgumentRefSpan & arguments, IntConstantList<Indexes...>) {
+		// avoid unused warning if there is no arguments
+		(void)arguments;
+		std::tuple<RefArgumentReader<typename TypeListGetAt<ArgumentTypeList, Indexes>::Type>...> readers(
+			arguments[Indexes]...
+		);
+		(void)readers;
+		Variant result;
+		BatchRowCaller<Class, RT>::call(func, instance, &result, std::get<Indexes>(readers).read()...);
+		return result;
+	}
+};
+
+template <typename Class, typename RT, typename ArgList>
+struct MetaCallableBatchInvoker
+{
+	using ArgumentTypeList = ArgList;
+	static constexpr int argCount = TypeListCount<ArgumentTypeList>::value;
+
+	template <typename FT>
+	static void invoke(
+			FT && func,
+			const ArgumentSpan & instances,
+			const ArgumentColumnSpan & argumentColumns,
+			const ResultColumnSpan & resultColumn
+		) {
+		const int rowCount = getBatchRowCount(instances, argumentColumns, resultColumn);
+		if(rowCount < 0 || argumentColumns.size() != (std::size_t)argCount) {
+			raiseException<IllegalArgumentException>();
+			return;
+		}
+		using Sequence = typename MakeIntSequence<argCount>::Type;
+		doInvoke(std::forward<FT>(func), instances, argumentColumns, resultColumn, (std::size_t)rowCount, Sequence());
+	}
+
+	template <typename FT, int ...Indexes>
+	static void doInvoke(
+			FT && func,
+			const ArgumentSpan & instances,
+			const ArgumentColumnSpan & argumentColumns,
+			const ResultColumnSpan & resultColumn,
+			const std::size_t rowCount,
+			IntConstantList<Indexes...>
+		) {
+		// avoid unused warning if there is no arguments
+		(void)argumentColumns;
+		std::tuple<BatchArgumentReader<typename TypeListGetAt<ArgumentTypeList, Indexes>::Type>...> readers(
+			argumentColumns[Indexes]...
+		);
+		(void)readers;
+		const bool sameInstance = (instances.size() <= 1);
+		void * instance = sameInstance ? getPointer(getBatchInstance(instances, 0)) : nullptr;
+		Variant * result = resultColumn.empty() ? nullptr : resultColumn.data();
+		for(std::size_t row = 0; row < rowCount; ++row) {
+			if(! sameInstance) {
+				instance = getPointer(instances[row]);
+			}
+			BatchRowCaller<Class, RT>::call(
+				func,
+				instance,
+				result,
+				std::get<Indexes>(readers).read(row)...
+			);
+			if(result != nullptr) {
+				++result;
+			}
+		}
+	}
+};
+
 
 } // namespace internal_
 
@@ -20,6 +20,7 @@
 #include <array>
 #include <vector>
 #include <iterator>
+#include <algorithm>
 
 namespace metapp {
 
@@ -34,40 +35,55 @@ private:
 	struct ContainerItem
 	{
 		const Container * container;
+		int size;
+		// Sum of the sizes of this container and all containers before it
 		int totalSize;
 	};
 
 public:
+	// The iterator keeps both the flat index and the position in the container list,
+	// so stepping doesn't search the container list, and jumping uses binary search.
 	class Iterator
 	{
 	public:
-		using iterator_category = std::forward_iterator_tag;
+		using iterator_category = std::random_access_iterator_tag;
 		using difference_type = std::ptrdiff_t;
 		using value_type = const ValueType;
 		using pointer = const value_type *;
 		using reference = const value_type &;
 
 	public:
-		Iterator(const DisjointView * view, const int listIndex, const int itemIndex)
-			: view(view), listIndex(listIndex), itemIndex(itemIndex)
+		Iterator()
+			: view(nullptr), listIndex(0), itemIndex(0), index(0)
 		{}
 
+		Iterator(const DisjointView * view, const int index)
+			: view(view), listIndex(0), itemIndex(0), index(index)
+		{
+			view->splitIndex(index, &listIndex, &itemIndex);
+		}
+
 		reference operator * () const {
-			return view->listPointer[listIndex].container->at(itemIndex);
+			return (*view->listPointer[listIndex].container)[itemIndex];
 		}
 
 		pointer operator -> () const {
-			return &view->listPointer[listIndex].container->at(itemIndex);
+			return &(*view->listPointer[listIndex].container)[itemIndex];
+		}
+
+		reference operator [] (const difference_type n) const {
+			return view->at((size_type)(index + n));
 		}
 
 		Iterator & operator ++ () {
+			++index;
 			++itemIndex;
-			if(itemIndex >= (int)view->listPointer[listIndex].container->size()) {
+			if(itemIndex >= view->listPointer[listIndex].size) {
 				itemIndex = 0;
 				++listIndex;
 			}
 			return *this;
-		}  
+		}
 
 		Iterator operator ++ (int) {
 			Iterator temp = *this;
@@ -75,18 +91,79 @@ public:
 			return temp;
 		}
 
+		Iterator & operator -- () {
+			--index;
+			if(itemIndex == 0) {
+				--listIndex;
+				itemIndex = view->listPointer[listIndex].size - 1;
+			}
+			else {
+				--itemIndex;
+			}
+			return *this;
+		}
+
+		Iterator operator -- (int) {
+			Iterator temp = *this;
+			--(*this);
+			return temp;
+		}
+
+		Iterator & operator += (const difference_type n) {
+			index += (int)n;
+			view->splitIndex(index, &listIndex, &itemIndex);
+			return *this;
+		}
+
+		Iterator & operator -= (const difference_type n) {
+			return *this += -n;
+		}
+
+		friend Iterator operator + (Iterator a, const difference_type n) {
+			return a += n;
+		}
+
+		friend Iterator operator + (const difference_type n, Iterator a) {
+			return a += n;
+		}
+
+		friend Iterator operator - (Iterator a, const difference_type n) {
+			return a -= n;
+		}
+
+		friend difference_type operator - (const Iterator & a, const Iterator & b) {
+			return (difference_type)a.index - (difference_type)b.index;
+		}
+
 		friend bool operator == (const Iterator & a, const Iterator & b) {
-			return a.listIndex == b.listIndex && a.itemIndex == b.itemIndex;
-		};
+			return a.index == b.index;
+		}
 
 		friend bool operator != (const Iterator & a, const Iterator & b) {
-			return ! operator == (a, b);
-		};  
+			return a.index != b.index;
+		}
+
+		friend bool operator < (const Iterator & a, const Iterator & b) {
+			return a.index < b.index;
+		}
+
+		friend bool operator > (const Iterator & a, const Iterator & b) {
+			return a.index > b.index;
+		}
+
+		friend bool operator <= (const Iterator & a, const Iterator & b) {
+			return a.index <= b.index;
+		}
+
+		friend bool operator >= (const Iterator & a, const Iterator & b) {
+			return a.index >= b.index;
+		}
 
 	private:
 		const DisjointView * view;
 		int listIndex;
 		int itemIndex;
+		int index;
 	};
 
 	using value_type = const ValueType;
@@ -163,11 +240,19 @@ public:
 	}
 
 	iterator begin() const {
-		return Iterator(this, 0, 0);
+		return Iterator(this, 0);
 	}
 
 	iterator end() const {
-		return Iterator(this, listCount, 0);
+		return Iterator(this, (int)size());
+	}
+
+	reverse_iterator rbegin() const {
+		return reverse_iterator(end());
+	}
+
+	reverse_iterator rend() const {
+		return reverse_iterator(begin());
 	}
 
 	bool empty() const {
@@ -182,7 +267,7 @@ public:
 		int listIndex;
 		int itemIndex;
 		splitIndex((int)index, &listIndex, &itemIndex);
-		return listPointer[listIndex].container->at(itemIndex);
+		return (*listPointer[listIndex].container)[itemIndex];
 	}
 
 	reference operator [] (const size_type index) const {
@@ -190,39 +275,48 @@ public:
 	}
 
 	void addContainer(const Container * container) {
-		int totalSize = (int)container->size();
-		if(totalSize == 0) {
+		const int size = (int)container->size();
+		if(size == 0) {
 			return;
 		}
+		int totalSize = size;
 		if(listCount > 0) {
 			totalSize += listPointer[listCount - 1].totalSize;
 		}
 		if(listCount < smallListSize) {
-			smallList[listCount] = { container, totalSize };
+			smallList[listCount] = { container, size, totalSize };
 		}
 		else {
 			if(listCount == smallListSize) {
 				largeList.insert(largeList.end(), smallList.begin(), smallList.end());
 			}
-			largeList.push_back({ container, totalSize });
+			largeList.push_back({ container, size, totalSize });
 		}
 		++listCount;
 		resetListPointer(); // must be after ++listCount
 	}
 
 private:
+	// If index is out of range, listIndex is listCount and itemIndex is 0, that's the end position.
 	void splitIndex(const int index, int * listIndex, int * itemIndex) const {
-		*listIndex = 0;
-		*itemIndex = 0;
-		while(*listIndex < listCount) {
-			if(index < listPointer[*listIndex].totalSize) {
-				*itemIndex = index;
-				if(*listIndex > 0) {
-					*itemIndex -= listPointer[*listIndex - 1].totalSize;
-				}
-				break;
+		// Most views have only one container
+		if(listCount > 0 && index < listPointer[0].totalSize) {
+			*listIndex = 0;
+			*itemIndex = index;
+			return;
+		}
+		const ContainerItem * it = std::upper_bound(
+			listPointer,
+			listPointer + listCount,
+			index,
+			[](const int value, const ContainerItem & item) {
+				return value < item.totalSize;
 			}
-			++*listIndex;
+		);
+		*listIndex = (int)(it - listPointer);
+		*itemIndex = 0;
+		if(*listIndex < listCount) {
+			*itemIndex = index - (it->totalSize - it->size);
 		}
 	}
 
@@ -20,11 +20,13 @@
 #include "metapp/variant.h"
 #include "metapp/metatype.h"
 #include "metapp/implement/internal/disjointview_i.h"
+#include "metapp/implement/internal/util_i.h"
 
 #include <deque>
 #include <set>
 #include <map>
 #include <type_traits>
+#include <typeinfo>
 #include <cmath>
 #include <algorithm>
 
@@ -48,6 +50,25 @@ using BaseView = internal_::DisjointView<const MetaType *, std::deque<internal_:
 
 namespace internal_ {
 
+// A polymorphic class which is registered to any InheritanceRepo, either as a base or a derived class.
+struct PolymorphicTypeEntry
+{
+	const MetaType * metaType;
+	// const, volatile, and const volatile of the class, so a pointer to const class can be found without comparing meta types.
+	const MetaType * cvMetaTypeList[3];
+	// The reference to the class, it's used to create Variant which refers to the object.
+	const MetaType * referenceMetaType;
+	const std::type_info * typeInfo;
+	// Returns typeid of the most derived object, instance points to the class.
+	const std::type_info & (*getDynamicTypeInfo)(const void * instance);
+	// Returns the address of the most derived object, instance points to the class.
+	void * (*getDynamicAddress)(void * instance);
+};
+
+// Adds the class to the global registry which is used by getDynamicMetaType.
+// Adding a class which is already added does nothing.
+void registerPolymorphicType(const PolymorphicTypeEntry & entry);
+
 struct MetaTypeLess
 {
 	bool operator() (const MetaType * a, const MetaType * b) const {
@@ -153,6 +174,7 @@ public:
 	void clear()
 	{
 		classInfoMap.clear();
+		increaseInheritanceGeneration();
 	}
 
 private:
@@ -185,6 +207,39 @@ private:
 			}) == baseClassInfo.derivedList.end()) {
 			baseClassInfo.derivedList.push_back({ classMetaType, &castObject<B, C> });
 		}
+		doRegisterPolymorphicType<C>();
+		doRegisterPolymorphicType<B>();
+		increaseInheritanceGeneration();
+	}
+
+	template <typename T>
+	static void doRegisterPolymorphicType(typename std::enable_if<std::is_polymorphic<T>::value>::type * = nullptr)
+	{
+		registerPolymorphicType(PolymorphicTypeEntry {
+			getMetaType<T>(),
+			{ getMetaType<const T>(), getMetaType<volatile T>(), getMetaType<const volatile T>() },
+			getMetaType<T &>(),
+			&typeid(T),
+			&getDynamicTypeInfo<T>,
+			&getDynamicAddress<T>
+		});
+	}
+
+	template <typename T>
+	static void doRegisterPolymorphicType(typename std::enable_if<! std::is_polymorphic<T>::value>::type * = nullptr)
+	{
+	}
+
+	template <typename T>
+	static const std::type_info & getDynamicTypeInfo(const void * instance)
+	{
+		return typeid(*static_cast<const T *>(instance));
+	}
+
+	template <typename T>
+	static void * getDynamicAddress(void * instance)
+	{
+		return dynamic_cast<void *>(static_cast<T *>(instance));
 	}
 
 	template <typename T>
@@ -273,6 +328,8 @@ private:
 
 private:
 	std::map<const MetaType *, ClassInfo, MetaTypeLess> classInfoMap;
+
+	friend class MetaMemoryCounter;
 };
 
 } // namespace internal_
@@ -0,0 +1,99 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef METAPP_METAITEMINDEX_I_H_969872685611
+#define METAPP_METAITEMINDEX_I_H_969872685611
+
+#include <deque>
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <string>
+#include <memory>
+
+namespace metapp {
+
+class MetaType;
+class MetaItem;
+class Variant;
+
+using MetaItemPointerList = std::vector<const MetaItem *>;
+
+namespace internal_ {
+
+class MetaItemIndexData;
+
+// Secondary indexes over the items in a MetaRepoBase.
+// The indexes are built on the first query, and rebuilt on the next query after the items in the repo change.
+// itemGeneration is the generation of the items in the repo, the indexes are rebuilt when it changes.
+class MetaItemIndex
+{
+public:
+	// The item lists of accessibles, callables, variables, and types.
+	using ItemListSet = std::array<const std::deque<MetaItem> *, 4>;
+
+public:
+	MetaItemIndex();
+	~MetaItemIndex();
+
+	// The index data is never shared or copied, the copy builds its own indexes on demand.
+	MetaItemIndex(const MetaItemIndex & other);
+	MetaItemIndex & operator = (const MetaItemIndex & other);
+
+	void findCallablesByArity(
+		MetaItemPointerList & result,
+		const ItemListSet & itemListSet,
+		const std::uint64_t itemGeneration,
+		const int arity
+	) const;
+	void findCallablesByParameter(
+		MetaItemPointerList & result,
+		const ItemListSet & itemListSet,
+		const std::uint64_t itemGeneration,
+		const int arity,
+		const int parameterIndex,
+		const MetaType * parameterType
+	) const;
+	void findCallablesByReturnType(
+		MetaItemPointerList & result,
+		const ItemListSet & itemListSet,
+		const std::uint64_t itemGeneration,
+		const MetaType * returnType
+	) const;
+	void findItemsByAnnotation(
+		MetaItemPointerList & result,
+		const ItemListSet & itemListSet,
+		const std::uint64_t itemGeneration,
+		const std::string & name
+	) const;
+	void findItemsByAnnotationValue(
+		MetaItemPointerList & result,
+		const ItemListSet & itemListSet,
+		const std::uint64_t itemGeneration,
+		const std::string & name,
+		const Variant & value
+	) const;
+
+private:
+	std::unique_ptr<MetaItemIndexData> data;
+};
+
+
+} // namespace internal_
+
+} // namespace metapp
+
+#endif
@@ -21,6 +21,7 @@
 #include "metapp/exception.h"
 #include "metapp/implement/internal/util_i.h"
 #include "metapp/implement/internal/disjointview_i.h"
+#include "metapp/implement/internal/metaitemindex_i.h"
 
 #include <map>
 #include <deque>
@@ -58,6 +59,10 @@ public:
 protected:
 	struct ItemData
 	{
+		ItemData() : itemList(), nameItemMap() {
+		}
+		~ItemData();
+
 		MetaItemList itemList;
 		std::map<
 			std::reference_wrapper<const std::string>,
@@ -65,7 +70,7 @@ protected:
 			std::less<const std::string>
 		> nameItemMap;
 
-		MetaItem & addItem(const MetaItem::Type type, const std::string & name, const Variant & target);
+		MetaItem & addItem(const MetaItem::Type type, const std::string & name, const Variant & target, ScopedGeneration * generation);
 		const MetaItem & findItem(const std::string & name) const;
 	};
 
@@ -110,6 +115,24 @@ protected:
 	
 	const MetaItem & doGetItem(const std::string & name) const;
 
+	// The generation of the items in this repo, it changes only when the items in this repo change.
+	std::uint64_t doGetItemGeneration() const;
+	ScopedGeneration * doRequireItemGeneration();
+
+	void doFindCallablesByArity(MetaItemPointerList & result, const int arity) const;
+	void doFindCallablesByParameter(
+		MetaItemPointerList & result,
+		const int arity,
+		const int parameterIndex,
+		const MetaType * parameterType
+	) const;
+	void doFindCallablesByReturnType(MetaItemPointerList & result, const MetaType * returnType) const;
+	void doFindItemsByAnnotation(MetaItemPointerList & result, const std::string & name) const;
+	void doFindItemsByAnnotationValue(MetaItemPointerList & result, const std::string & name, const Variant & value) const;
+
+private:
+	MetaItemIndex::ItemListSet doGetItemListSet() const;
+
 private:
 	std::shared_ptr<ItemData> accessibleData;
 	std::shared_ptr<ItemData> callableData;
@@ -121,7 +144,14 @@ private:
 		std::map<const MetaType *, MetaItem *> typeTypeMap;
 	};
 	std::shared_ptr<TypeData> typeData;
+	// Increased when an item is added, or an item's annotation or target is changed.
+	// It's shared by the copies of the repo as the item data is, the items refer to it without owning it.
+	std::shared_ptr<ScopedGeneration> itemGeneration;
+
+	MetaItemIndex itemIndex;
 
+	friend class MetaMemoryCounter;
+	friend class NameIndexImplement;
 };
 
 Variant doCombineOverloadedCallable(const Variant & target, const Variant & callable);
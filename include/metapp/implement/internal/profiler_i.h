@@ -0,0 +1,109 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_PROFILER_I_H_969872685611
+#define METAPP_PROFILER_I_H_969872685611
+
+#include "metapp/compiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define METAPP_PROFILER_USE_TSC
+	#ifdef METAPP_COMPILER_VC
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+#endif
+
+namespace metapp {
+
+class Variant;
+
+enum class ProfilePhase
+{
+	// callableInvoke, from the call to the return
+	invoke,
+	// findCallable, ranking the candidate callables
+	rank,
+	// casting the arguments to the parameter types
+	cast,
+	// calling the target function
+	call,
+	// creating the result Variant
+	box,
+	// accessibleGet
+	get,
+	// accessibleSet
+	set
+};
+
+constexpr std::size_t profilePhaseCount = 7;
+
+namespace internal_ {
+
+// True if the profiler records histograms or trace events. The hooks only check this flag when they are not recording.
+extern std::atomic<bool> profilingEnabled;
+
+inline bool isProfilingEnabled()
+{
+	return profilingEnabled.load(std::memory_order_relaxed);
+}
+
+// The ticks are the time stamp counter on x86, otherwise nanoseconds from steady_clock.
+// They are converted to nanoseconds when the histograms or the trace are read.
+inline std::uint64_t readProfileTicks()
+{
+#ifdef METAPP_PROFILER_USE_TSC
+	return __rdtsc();
+#else
+	return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+#endif
+}
+
+// item is the Variant which holds the callable or accessible, the sample is recorded to the identity of item,
+// see Profiler::getKey.
+void recordProfileSample(const Variant * item, const ProfilePhase phase, const std::uint64_t startTicks, const std::uint64_t endTicks);
+
+class ProfileTimer
+{
+public:
+	ProfileTimer() : startTicks(readProfileTicks()) {
+	}
+
+	// Records the time since the construction or the last record, and restarts the timer.
+	void record(const Variant * item, const ProfilePhase phase) {
+		const std::uint64_t endTicks = readProfileTicks();
+		recordProfileSample(item, phase, startTicks, endTicks);
+		startTicks = endTicks;
+	}
+
+private:
+	std::uint64_t startTicks;
+};
+
+} // namespace internal_
+
+} // namespace metapp
+
+#endif
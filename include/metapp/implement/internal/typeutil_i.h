@@ -131,6 +131,7 @@ METAPP_HAS_MEMBER(constructData);
 METAPP_HAS_MEMBER(destroy);
 METAPP_HAS_MEMBER(cast);
 METAPP_HAS_MEMBER(castFrom);
+METAPP_HAS_MEMBER(castCacheable);
 METAPP_HAS_MEMBER(typeKind);
 METAPP_HAS_MEMBER(typeFlags);
 METAPP_HAS_MEMBER(setup);
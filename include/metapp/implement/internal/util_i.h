@@ -19,11 +19,46 @@
 
 #include <string>
 #include <array>
+#include <atomic>
+#include <cstdint>
 
 namespace metapp {
 
 namespace internal_ {
 
+// The generation is increased whenever a meta item or a base class is registered, or a MetaRepo is created or destroyed.
+// increaseRegistrationGeneration returns the increased generation.
+std::uint64_t getRegistrationGeneration();
+std::uint64_t increaseRegistrationGeneration();
+
+// The inheritance generation is increased whenever a base class is registered, or a MetaRepo is created or destroyed.
+// Caches built from the class hierarchy compare it to detect they are stale.
+// Increasing it also increases the registration generation.
+std::uint64_t getInheritanceGeneration();
+void increaseInheritanceGeneration();
+
+// The generation of a group of meta data, such as the items in a MetaRepo, a MetaClass, or a MetaEnum.
+// It's set to a new registration generation when the group is modified, so it only increases, and a cache built
+// from several groups can use the maximum generation of the groups. Such cache is only invalidated by the registrations
+// in the groups, not by the registrations elsewhere, such as the lazy initialization of unrelated meta classes.
+class ScopedGeneration
+{
+public:
+	ScopedGeneration() : generation(0) {
+	}
+
+	std::uint64_t get() const {
+		return generation.load(std::memory_order_acquire);
+	}
+
+	void increase() {
+		generation.store(increaseRegistrationGeneration(), std::memory_order_release);
+	}
+
+private:
+	std::atomic<std::uint64_t> generation;
+};
+
 template <typename ...Types>
 inline const MetaType * getMetaTypeAt(const int index)
 {
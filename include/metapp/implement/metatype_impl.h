@@ -74,6 +74,20 @@ using SelectDeclareClass = typename std::conditional<
 	CommonDeclareMetaType<T>
 >::type;
 
+// The cast is cacheable if DeclareMetaType declares castCacheable, or if it doesn't implement cast nor castFrom,
+// the default implementations only depend on the types and the class hierarchy.
+template <typename M, bool hasCastCacheable>
+struct CastCacheableGetter
+{
+	static constexpr bool value = ! HasMember_cast<M>::value && ! HasMember_castFrom<M>::value;
+};
+
+template <typename M>
+struct CastCacheableGetter <M, true>
+{
+	static constexpr bool value = M::castCacheable;
+};
+
 template <typename T> struct DeepRemoveCv { using Type = T; };
 template <typename T> struct DeepRemoveCv <T const> : DeepRemoveCv<T> {};
 template <typename T> struct DeepRemoveCv <T volatile> : DeepRemoveCv<T> {};
@@ -99,6 +113,7 @@ const MetaType * doGetMetaTypeStorage()
 		},
 		doGetUnifiedType<typename std::remove_cv<T>::type>(),
 		SelectDeclareClass<T, HasMember_typeFlags<M>::value>::typeFlags | CommonDeclareMetaType<T>::typeFlags
+			| (CastCacheableGetter<M, HasMember_castCacheable<M>::value>::value ? tfCastCacheable : 0)
 	);
 	return &metaType;
 }
@@ -259,6 +259,12 @@ inline Variant Variant::castSilently() const
 	return castSilently(metapp::getMetaType<T>());
 }
 
+template <typename T>
+inline ErrorCode Variant::tryCast(Variant * result) const
+{
+	return tryCast(result, metapp::getMetaType<T>());
+}
+
 inline bool Variant::isEmpty() const noexcept
 {
 	return metaType->isVoid();
@@ -110,6 +110,10 @@ public:
 	template <typename T>
 	Variant castSilently() const;
 
+	ErrorCode tryCast(Variant * result, const MetaType * toMetaType) const;
+	template <typename T>
+	ErrorCode tryCast(Variant * result) const;
+
 	bool isEmpty() const noexcept;
 
 	Variant clone() const;
@@ -42,7 +42,9 @@ public:
 			&metaCallableGetParameterType,
 			&metaCallableRankInvoke,
 			&metaCallableCanInvoke,
-			&metaCallableInvoke
+			&metaCallableInvoke,
+			&metaCallableInvokeBatch,
+			&metaCallableInvokeRef
 		);
 		return &metaCallable;
 	}
@@ -91,9 +93,44 @@ public:
 		}
 
 		FunctionType & f = callable.get<FunctionType &>();
+#ifdef METAPP_ENABLE_PROFILING
+		if(internal_::isProfilingEnabled()) {
+			return internal_::MetaCallableProfilingInvoker<Class, RT, ArgumentTypeList>::invoke(
+				f, getPointer(instance), arguments, &callable
+			);
+		}
+#endif
 		return internal_::MetaCallableInvoker<Class, RT, ArgumentTypeList>::invoke(f, getPointer(instance), arguments);
 	}
 
+	static Variant metaCallableInvokeRef(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments)
+	{
+		if(arguments.size() != argsCount) {
+			raiseException<IllegalArgumentException>();
+			return Variant();
+		}
+
+#ifdef METAPP_ENABLE_PROFILING
+		// The Variant path records the cast, call, and box phases separately.
+		if(internal_::isProfilingEnabled()) {
+			return internal_::invokeRefByVariants(callable, instance, arguments);
+		}
+#endif
+		FunctionType & f = callable.get<FunctionType &>();
+		return internal_::MetaCallableRefInvoker<Class, RT, ArgumentTypeList>::invoke(f, getPointer(instance), arguments);
+	}
+
+	static void metaCallableInvokeBatch(
+		const Variant & callable,
+		const ArgumentSpan & instances,
+		const ArgumentColumnSpan & argumentColumns,
+		const ResultColumnSpan & resultColumn
+	)
+	{
+		FunctionType & f = callable.get<FunctionType &>();
+		internal_::MetaCallableBatchInvoker<Class, RT, ArgumentTypeList>::invoke(f, instances, argumentColumns, resultColumn);
+	}
+
 };
 
 
@@ -53,6 +53,81 @@ struct ResizeHelper <std::array<T, length> >
 	}
 };
 
+// DataHelper provides the pointer to the contiguous elements, only for containers which store elements contiguously.
+template <typename T>
+struct DataHelper
+{
+	static constexpr void * (*getData)(const Variant & indexable) = nullptr;
+};
+
+template <typename T, typename Allocator>
+struct DataHelper <std::vector<T, Allocator> >
+{
+	static void * getData(const Variant & indexable)
+	{
+		auto & container = indexable.get<std::vector<T, Allocator> &>();
+		return container.empty() ? nullptr : (void *)container.data();
+	}
+};
+
+template <typename Allocator>
+struct DataHelper <std::vector<bool, Allocator> >
+{
+	static constexpr void * (*getData)(const Variant & indexable) = nullptr;
+};
+
+template <typename T, std::size_t length>
+struct DataHelper <std::array<T, length> >
+{
+	static void * getData(const Variant & indexable)
+	{
+		return (void *)indexable.get<std::array<T, length> &>().data();
+	}
+};
+
+// ElementAddressHelper provides the address of a single element, for containers which store each element as an object,
+// so the element can be accessed without a Variant even if the container is not contiguous.
+template <typename T>
+struct ElementAddressHelper
+{
+	static constexpr void * (*getElementAddress)(const Variant & indexable, const std::size_t index) = nullptr;
+};
+
+template <typename T, typename Allocator>
+struct ElementAddressHelper <std::deque<T, Allocator> >
+{
+	static void * getElementAddress(const Variant & indexable, const std::size_t index)
+	{
+		auto & container = indexable.get<std::deque<T, Allocator> &>();
+		return index < container.size() ? (void *)&container[index] : nullptr;
+	}
+};
+
+template <typename T, typename Allocator>
+struct ElementAddressHelper <std::vector<T, Allocator> >
+{
+	static void * getElementAddress(const Variant & indexable, const std::size_t index)
+	{
+		auto & container = indexable.get<std::vector<T, Allocator> &>();
+		return index < container.size() ? (void *)&container[index] : nullptr;
+	}
+};
+
+template <typename Allocator>
+struct ElementAddressHelper <std::vector<bool, Allocator> >
+{
+	static constexpr void * (*getElementAddress)(const Variant & indexable, const std::size_t index) = nullptr;
+};
+
+template <typename T, std::size_t length>
+struct ElementAddressHelper <std::array<T, length> >
+{
+	static void * getElementAddress(const Variant & indexable, const std::size_t index)
+	{
+		return index < length ? (void *)&indexable.get<std::array<T, length> &>()[index] : nullptr;
+	}
+};
+
 } // namespace internal_
 
 template <typename ContainerType>
@@ -64,7 +139,9 @@ struct MetaIndexableBase
 			&metaIndexableGetValueType,
 			&metaIndexableResize,
 			&metaIndexableGet,
-			&metaIndexableSet
+			&metaIndexableSet,
+			internal_::DataHelper<ContainerType>::getData,
+			internal_::ElementAddressHelper<ContainerType>::getElementAddress
 		);
 		return &metaIndexable;
 	}
@@ -20,6 +20,14 @@
 #include "metapp/variant.h"
 #include "metapp/utilities/utility.h"
 
+#ifdef METAPP_ENABLE_CHANGE_TRACKING
+#include "metapp/implement/internal/changetracker_i.h"
+#endif
+
+#ifdef METAPP_ENABLE_PROFILING
+#include "metapp/implement/internal/profiler_i.h"
+#endif
+
 namespace metapp {
 
 class MetaAccessible
@@ -75,12 +83,62 @@ inline bool accessibleIsStatic(const Variant & accessible)
 
 inline Variant accessibleGet(const Variant & accessible, const Variant & instance)
 {
+#ifdef METAPP_ENABLE_PROFILING
+	if(internal_::isProfilingEnabled()) {
+		internal_::ProfileTimer timer;
+		Variant result = getNonReferenceMetaType(accessible)->getMetaAccessible()->get(accessible, instance);
+		timer.record(&accessible, ProfilePhase::get);
+		return result;
+	}
+#endif
 	return getNonReferenceMetaType(accessible)->getMetaAccessible()->get(accessible, instance);
 }
 
 inline void accessibleSet(const Variant & accessible, const Variant & instance, const Variant & value)
 {
+#ifdef METAPP_ENABLE_PROFILING
+	if(internal_::isProfilingEnabled()) {
+		internal_::ProfileTimer timer;
+		getNonReferenceMetaType(accessible)->getMetaAccessible()->set(accessible, instance, value);
+		timer.record(&accessible, ProfilePhase::set);
+#ifdef METAPP_ENABLE_CHANGE_TRACKING
+		if(internal_::isChangeTrackingActive()) {
+			internal_::recordAccessibleChange(accessible, instance);
+		}
+#endif
+		return;
+	}
+#endif
 	getNonReferenceMetaType(accessible)->getMetaAccessible()->set(accessible, instance, value);
+#ifdef METAPP_ENABLE_CHANGE_TRACKING
+	if(internal_::isChangeTrackingActive()) {
+		internal_::recordAccessibleChange(accessible, instance);
+	}
+#endif
+}
+
+inline ErrorCode tryAccessibleSet(const Variant & accessible, const Variant & instance, const Variant & value)
+{
+	const MetaAccessible * metaAccessible = getNonReferenceMetaType(accessible)->getMetaAccessible();
+	if(metaAccessible == nullptr) {
+		return ErrorCode::unsupported;
+	}
+	if(metaAccessible->isReadOnly(accessible)) {
+		return ErrorCode::unwritable;
+	}
+	if(instance.isEmpty() && ! metaAccessible->isStatic(accessible)) {
+		return ErrorCode::illegalArgument;
+	}
+	if(! value.canCast(metaAccessible->getValueType(accessible))) {
+		return ErrorCode::badCast;
+	}
+	metaAccessible->set(accessible, instance, value);
+#ifdef METAPP_ENABLE_CHANGE_TRACKING
+	if(internal_::isChangeTrackingActive()) {
+		internal_::recordAccessibleChange(accessible, instance);
+	}
+#endif
+	return ErrorCode::ok;
 }
 
 } // namespace metapp
@@ -18,14 +18,26 @@
 #define METAPP_METACALLABLE_H_969872685611
 
 #include "metapp/metatype.h"
+#include "metapp/variantref.h"
 #include "metapp/utilities/span.h"
 #include "metapp/utilities/utility.h"
 
+#include <vector>
+#include <array>
+#include <limits>
+
+#ifdef METAPP_ENABLE_PROFILING
+#include "metapp/implement/internal/profiler_i.h"
+#endif
+
 namespace metapp {
 
 class Variant;
 
 using ArgumentSpan = metapp::span<const Variant>;
+using ArgumentColumnSpan = metapp::span<const ArgumentSpan>;
+using ResultColumnSpan = metapp::span<Variant>;
+using ArgumentRefSpan = metapp::span<const VariantRef>;
 
 class MetaCallable
 {
@@ -89,6 +101,36 @@ public:
 		int (*rankInvoke)(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments),
 		bool (*canInvoke)(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments),
 		Variant (*invoke)(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments)
+	)
+		: MetaCallable(
+			getClassType,
+			getParameterCountInfo,
+			getReturnType,
+			getParameterType,
+			rankInvoke,
+			canInvoke,
+			invoke,
+			nullptr,
+			nullptr
+		)
+	{
+	}
+
+	MetaCallable(
+		const MetaType * (*getClassType)(const Variant & callable),
+		ParameterCountInfo (*getParameterCountInfo)(const Variant & callable),
+		const MetaType * (*getReturnType)(const Variant & callable),
+		const MetaType * (*getParameterType)(const Variant & callable, const int index),
+		int (*rankInvoke)(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments),
+		bool (*canInvoke)(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments),
+		Variant (*invoke)(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments),
+		void (*invokeBatch)(
+			const Variant & callable,
+			const ArgumentSpan & instances,
+			const ArgumentColumnSpan & argumentColumns,
+			const ResultColumnSpan & resultColumn
+		),
+		Variant (*invokeRef)(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments) = nullptr
 	)
 		:
 			getClassType(getClassType),
@@ -97,7 +139,9 @@ public:
 			getParameterType(getParameterType),
 			rankInvoke(rankInvoke),
 			canInvoke(canInvoke),
-			invoke(invoke)
+			invoke(invoke),
+			invokeBatch_(invokeBatch),
+			invokeRef_(invokeRef)
 	{
 	}
 
@@ -113,6 +157,24 @@ public:
 	bool isStatic(const Variant & callable) const {
 		return getClassType(callable)->isVoid();
 	}
+
+	void invokeBatch(
+		const Variant & callable,
+		const ArgumentSpan & instances,
+		const ArgumentColumnSpan & argumentColumns,
+		const ResultColumnSpan & resultColumn
+	) const;
+
+	Variant invokeRef(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments) const;
+
+private:
+	void (*invokeBatch_)(
+		const Variant & callable,
+		const ArgumentSpan & instances,
+		const ArgumentColumnSpan & argumentColumns,
+		const ResultColumnSpan & resultColumn
+	);
+	Variant (*invokeRef_)(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments);
 };
 
 static constexpr int invokeRankMatch = 1000;
@@ -131,6 +193,12 @@ Iterator findCallable(
 {
 	Iterator result = last;
 
+#ifdef METAPP_ENABLE_PROFILING
+	const bool profiling = internal_::isProfilingEnabled();
+	const std::uint64_t startTicks = profiling ? internal_::readProfileTicks() : 0;
+	const Variant * firstCallable = (profiling && first != last) ? &(const Variant &)*first : nullptr;
+#endif
+
 	int maxRank = 0;
 	for(; first != last; ++first) {
 		const Variant & callable = (const Variant &)*first;
@@ -148,21 +216,156 @@ Iterator findCallable(
 		*resultMaxRank = maxRank;
 	}
 
+#ifdef METAPP_ENABLE_PROFILING
+	// The ranking time is recorded to the chosen callable, or to the first candidate if none matches.
+	if(firstCallable != nullptr) {
+		internal_::recordProfileSample(
+			result != last ? &(const Variant &)*result : firstCallable,
+			ProfilePhase::rank,
+			startTicks,
+			internal_::readProfileTicks()
+		);
+	}
+#endif
+
 	return result;
 }
 
 namespace internal_ {
 
+// Returns the row count of a batch, or -1 if the columns don't have consistent size.
+// `instances` may have 0 (static callable), 1 (same instance for all rows), or row count elements.
+// `resultColumn` may be empty if the results are not needed.
+inline int getBatchRowCount(
+	const ArgumentSpan & instances,
+	const ArgumentColumnSpan & argumentColumns,
+	const ResultColumnSpan & resultColumn
+)
+{
+	std::size_t rowCount = 0;
+	if(! argumentColumns.empty()) {
+		rowCount = argumentColumns[0].size();
+	}
+	else if(! resultColumn.empty()) {
+		rowCount = resultColumn.size();
+	}
+	else {
+		rowCount = instances.size();
+	}
+	for(const ArgumentSpan & column : argumentColumns) {
+		if(column.size() != rowCount) {
+			return -1;
+		}
+	}
+	if(! resultColumn.empty() && resultColumn.size() != rowCount) {
+		return -1;
+	}
+	if(instances.size() > 1 && instances.size() != rowCount) {
+		return -1;
+	}
+	return (int)rowCount;
+}
+
+inline const Variant & getBatchInstance(const ArgumentSpan & instances, const std::size_t row)
+{
+	static const Variant noInstance;
+	if(instances.empty()) {
+		return noInstance;
+	}
+	return instances.size() == 1 ? instances[0] : instances[row];
+}
+
+// Fallback for callables which don't implement invokeBatch, it's equivalent to invoking row by row.
+inline void invokeBatchByRows(
+	const Variant & callable,
+	const ArgumentSpan & instances,
+	const ArgumentColumnSpan & argumentColumns,
+	const ResultColumnSpan & resultColumn
+)
+{
+	const int rowCount = getBatchRowCount(instances, argumentColumns, resultColumn);
+	if(rowCount < 0) {
+		raiseException<IllegalArgumentException>();
+		return;
+	}
+	const MetaCallable * metaCallable = getNonReferenceMetaType(callable)->getMetaCallable();
+	const std::size_t columnCount = argumentColumns.size();
+	std::vector<Variant> arguments(columnCount);
+	for(std::size_t row = 0; row < (std::size_t)rowCount; ++row) {
+		for(std::size_t i = 0; i < columnCount; ++i) {
+			arguments[i] = argumentColumns[i][row];
+		}
+		Variant result = metaCallable->invoke(callable, getBatchInstance(instances, row), arguments);
+		if(! resultColumn.empty()) {
+			resultColumn[row] = std::move(result);
+		}
+	}
+}
+
+// Fallback for callables which don't implement invokeRef, the arguments are converted to Variants.
+inline Variant invokeRefByVariants(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments)
+{
+	constexpr std::size_t fixedArgumentCount = 8;
+	const MetaCallable * metaCallable = getNonReferenceMetaType(callable)->getMetaCallable();
+	if(arguments.size() <= fixedArgumentCount) {
+		std::array<Variant, fixedArgumentCount> variantList;
+		for(std::size_t i = 0; i < arguments.size(); ++i) {
+			variantList[i] = arguments[i].toVariant();
+		}
+		return metaCallable->invoke(callable, instance, ArgumentSpan(variantList.data(), arguments.size()));
+	}
+	std::vector<Variant> variantList(arguments.size());
+	for(std::size_t i = 0; i < arguments.size(); ++i) {
+		variantList[i] = arguments[i].toVariant();
+	}
+	return metaCallable->invoke(callable, instance, variantList);
+}
+
+// Resolves the callable (and the overload for OverloadedFunction) by rank before invoking,
+// so a mismatch is reported as ErrorCode::illegalArgument instead of an exception.
+ErrorCode tryInvokeCallable(
+	Variant * result,
+	const Variant & callable,
+	const Variant & instance,
+	const ArgumentSpan & arguments
+);
+
+inline Variant doInvokeCallable(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments)
+{
+#ifdef METAPP_ENABLE_PROFILING
+	if(isProfilingEnabled()) {
+		ProfileTimer timer;
+		Variant result = getNonReferenceMetaType(callable)->getMetaCallable()->invoke(callable, instance, arguments);
+		timer.record(&callable, ProfilePhase::invoke);
+		return result;
+	}
+#endif
+	return getNonReferenceMetaType(callable)->getMetaCallable()->invoke(callable, instance, arguments);
+}
+
+inline Variant doInvokeCallableRef(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments)
+{
+#ifdef METAPP_ENABLE_PROFILING
+	if(isProfilingEnabled()) {
+		ProfileTimer timer;
+		Variant result = getNonReferenceMetaType(callable)->getMetaCallable()->invokeRef(callable, instance, arguments);
+		timer.record(&callable, ProfilePhase::invoke);
+		return result;
+	}
+#endif
+	return getNonReferenceMetaType(callable)->getMetaCallable()->invokeRef(callable, instance, arguments);
+}
+
 template <std::size_t ArgCount>
 struct CallableInvoker
 {
 	template <typename ...Args>
 	static Variant invoke(const Variant & callable, const Variant & instance, Args && ... args)
 	{
-		Variant arguments[sizeof...(Args)] = {
-			Variant::reference(args)...
+		const VariantRef arguments[sizeof...(Args)] = {
+			VariantRef::reference(args)...
 		};
-		return getNonReferenceMetaType(callable)->getMetaCallable()->invoke(callable, instance, arguments);
+		return doInvokeCallableRef(callable, instance, arguments);
 	}
 
 	template <typename ...Args>
@@ -183,6 +386,15 @@ struct CallableInvoker
 		return getNonReferenceMetaType(callable)->getMetaCallable()->canInvoke(callable, instance, arguments);
 	}
 
+	template <typename ...Args>
+	static ErrorCode tryInvoke(Variant * result, const Variant & callable, const Variant & instance, Args && ... args)
+	{
+		Variant arguments[sizeof...(Args)] = {
+			Variant::reference(args)...
+		};
+		return tryInvokeCallable(result, callable, instance, arguments);
+	}
+
 };
 
 template <>
@@ -190,7 +402,7 @@ struct CallableInvoker <0>
 {
 	static Variant invoke(const Variant & callable, const Variant & instance)
 	{
-		return getNonReferenceMetaType(callable)->getMetaCallable()->invoke(callable, instance, {});
+		return doInvokeCallable(callable, instance, {});
 	}
 
 	static int rankInvoke(const Variant & callable, const Variant & instance)
@@ -203,6 +415,11 @@ struct CallableInvoker <0>
 		return getNonReferenceMetaType(callable)->getMetaCallable()->canInvoke(callable, instance, {});
 	}
 
+	static ErrorCode tryInvoke(Variant * result, const Variant & callable, const Variant & instance)
+	{
+		return tryInvokeCallable(result, callable, instance, {});
+	}
+
 };
 
 } //namespace internal_
@@ -245,11 +462,55 @@ inline Variant callableInvoke(const Variant & callable, const Variant & instance
 	return internal_::CallableInvoker<sizeof...(Args)>::invoke(callable, instance, std::forward<Args>(args)...);
 }
 
+inline Variant callableInvokeRef(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments)
+{
+	return internal_::doInvokeCallableRef(callable, instance, arguments);
+}
+
+template <typename ...Args>
+inline ErrorCode tryCallableInvoke(Variant * result, const Variant & callable, const Variant & instance, Args && ... args)
+{
+	return internal_::CallableInvoker<sizeof...(Args)>::tryInvoke(result, callable, instance, std::forward<Args>(args)...);
+}
+
 inline bool callableIsStatic(const Variant & callable)
 {
 	return getNonReferenceMetaType(callable)->getMetaCallable()->isStatic(callable);
 }
 
+inline void callableInvokeBatch(
+	const Variant & callable,
+	const ArgumentSpan & instances,
+	const ArgumentColumnSpan & argumentColumns,
+	const ResultColumnSpan & resultColumn
+)
+{
+	getNonReferenceMetaType(callable)->getMetaCallable()->invokeBatch(callable, instances, argumentColumns, resultColumn);
+}
+
+inline void MetaCallable::invokeBatch(
+	const Variant & callable,
+	const ArgumentSpan & instances,
+	const ArgumentColumnSpan & argumentColumns,
+	const ResultColumnSpan & resultColumn
+) const
+{
+	if(invokeBatch_ != nullptr) {
+		invokeBatch_(callable, instances, argumentColumns, resultColumn);
+	}
+	else {
+		internal_::invokeBatchByRows(callable, instances, argumentColumns, resultColumn);
+	}
+}
+
+inline Variant MetaCallable::invokeRef(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments) const
+{
+	if(invokeRef_ != nullptr) {
+		return invokeRef_(callable, instance, arguments);
+	}
+	return internal_::invokeRefByVariants(callable, instance, arguments);
+}
+
 
 } // namespace metapp
 
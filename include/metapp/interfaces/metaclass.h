@@ -36,7 +36,9 @@ public:
 	MetaClass(const MetaType * classMetaType, FT callback)
 		:
 			internal_::MetaRepoBase(),
-			classMetaType(classMetaType)
+			classMetaType(classMetaType),
+			constructorItem(),
+			viewCache(doCreateViewCache())
 	{
 		callback(*this);
 	}
@@ -60,16 +62,46 @@ public:
 
 	const MetaItem & getItem(const std::string & name) const;
 
+	MetaItemPointerList findCallablesByArity(const int arity, const Flags flags = flagIncludeBase) const;
+	MetaItemPointerList findCallablesByParameter(
+		const int arity,
+		const int parameterIndex,
+		const MetaType * parameterType, const Flags flags = flagIncludeBase
+	) const;
+	MetaItemPointerList findCallablesByReturnType(const MetaType * returnType, const Flags flags = flagIncludeBase) const;
+	MetaItemPointerList findItemsByAnnotation(const std::string & name, const Flags flags = flagIncludeBase) const;
+	MetaItemPointerList findItemsByAnnotationValue(const std::string & name, const Variant & value, const Flags flags = flagIncludeBase) const;
+
 private:
+	// The views which include base classes are cached, see metaclass.cpp
+	struct ViewCache;
+
+	enum class ViewKind
+	{
+		accessible,
+		callable,
+		variable,
+		type,
+		count
+	};
+
 	bool hasFlag(const Flags flags, const Flags flag) const {
 		return (flags & flag) != 0;
 	}
 
-	MetaItemView doBuildMetaItemView(
+	static std::shared_ptr<ViewCache> doCreateViewCache();
+
+	MetaItemView doGetMetaItemView(
 		const MetaItemList & (MetaClass::*listGetter)() const,
+		const ViewKind viewKind,
 		const Flags flags
 	) const;
 
+	std::shared_ptr<const std::vector<const MetaClass *> > doGetClassList() const;
+
+	template <typename FT>
+	MetaItemPointerList doFindItems(FT && finder, const Flags flags) const;
+
 	const MetaItem & doFindItemByName(
 		const MetaItem & (MetaClass::*itemGetter)(const std::string &) const,
 		const std::string & name,
@@ -79,6 +111,9 @@ private:
 private:
 	const MetaType * classMetaType;
 	MetaItem constructorItem;
+	std::shared_ptr<ViewCache> viewCache;
+
+	friend class internal_::MetaMemoryCounter;
 };
 
 
@@ -27,6 +27,7 @@ namespace metapp {
 
 namespace internal_ {
 extern MetaItem emptyMetaItem;
+class NameIndexImplement;
 } // namespace internal_
 
 class MetaEnum
@@ -40,18 +41,30 @@ public:
 		:
 			valueList(),
 			nameValueMap(),
-			valueNameMap()
+			valueNameMap(),
+			generation(std::make_shared<internal_::ScopedGeneration>())
 	{
 		callback(*this);
 	}
 
+	~MetaEnum() {
+		// The copies of the values may outlive the enum, they must not refer to the generation.
+		if(generation.use_count() == 1) {
+			for(MetaItem & item : valueList) {
+				item.doSetOwnerGeneration(nullptr);
+			}
+		}
+	}
+
 	MetaItem & registerValue(const std::string & name, const Variant & value) {
 		auto it = nameValueMap.find(name);
 		if(it != nameValueMap.end()) {
 			return *it->second;
 		}
 		valueList.emplace_back(MetaItem::Type::enumValue, name, value);
+		generation->increase();
 		MetaItem & registeredEnumValue = valueList.back();
+		registeredEnumValue.doSetOwnerGeneration(generation.get());
 		nameValueMap.insert(typename decltype(nameValueMap)::value_type(registeredEnumValue.getName(), &registeredEnumValue));
 		const Variant casted = value.castSilently<Underlying>();
 		if(! casted.isEmpty()) {
@@ -92,6 +105,11 @@ private:
 		Underlying,
 		MetaItem *
 	> valueNameMap;
+	// Increased when a value is registered or changed. The values refer to it without owning it.
+	std::shared_ptr<internal_::ScopedGeneration> generation;
+
+	friend class internal_::MetaMemoryCounter;
+	friend class internal_::NameIndexImplement;
 };
 
 inline const MetaItem & enumGetByName(const Variant & var, const std::string & name)
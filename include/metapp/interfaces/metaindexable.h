@@ -20,6 +20,10 @@
 #include "metapp/variant.h"
 #include "metapp/utilities/utility.h"
 
+#ifdef METAPP_ENABLE_CHANGE_TRACKING
+#include "metapp/implement/internal/changetracker_i.h"
+#endif
+
 #include <limits>
 
 namespace metapp {
@@ -31,7 +35,7 @@ public:
 	{
 	public:
 		SizeInfo() : SizeInfo(0) {}
-		explicit SizeInfo(const std::size_t size) : size(size), resizable(true), unknowSize(false) {}
+		explicit SizeInfo(const std::size_t size) : size(size), resizable(true), unknowSize(false), randomAccess(true) {}
 
 		std::size_t getSize() const {
 			return size;
@@ -45,6 +49,10 @@ public:
 			return unknowSize;
 		}
 
+		bool isRandomAccess() const {
+			return randomAccess;
+		}
+
 		void setResizable(const bool value) {
 			resizable = value;
 		}
@@ -53,10 +61,15 @@ public:
 			unknowSize = value;
 		}
 
+		void setRandomAccess(const bool value) {
+			randomAccess = value;
+		}
+
 	private:
 		std::size_t size;
 		bool resizable;
 		bool unknowSize;
+		bool randomAccess;
 	};
 
 public:
@@ -67,14 +80,18 @@ public:
 		const MetaType * (*getValueType)(const Variant & indexable, const std::size_t index),
 		void (*resize)(const Variant & indexable, const std::size_t size),
 		Variant (*get)(const Variant & indexable, const std::size_t index),
-		void (*set)(const Variant & indexable, const std::size_t index, const Variant & value)
+		void (*set)(const Variant & indexable, const std::size_t index, const Variant & value),
+		void * (*getData)(const Variant & indexable) = nullptr,
+		void * (*getElementAddress)(const Variant & indexable, const std::size_t index) = nullptr
 	)
 		:
 			getSizeInfo(getSizeInfo),
 			getValueType(getValueType),
 			get(get),
 			set(set),
-			resize_(resize)
+			resize_(resize),
+			getData_(getData),
+			getElementAddress_(getElementAddress)
 	{
 	}
 
@@ -87,9 +104,23 @@ public:
 	}
 	Variant (*get)(const Variant & indexable, const std::size_t index);
 	void (*set)(const Variant & indexable, const std::size_t index, const Variant & value);
+	void * getData(const Variant & indexable) const {
+		if(getData_ != nullptr) {
+			return getData_(indexable);
+		}
+		return nullptr;
+	}
+	void * getElementAddress(const Variant & indexable, const std::size_t index) const {
+		if(getElementAddress_ != nullptr) {
+			return getElementAddress_(indexable, index);
+		}
+		return nullptr;
+	}
 
 private:
 	void (*resize_)(const Variant & indexable, const std::size_t size);
+	void * (*getData_)(const Variant & indexable);
+	void * (*getElementAddress_)(const Variant & indexable, const std::size_t index);
 };
 
 inline MetaIndexable::SizeInfo indexableGetSizeInfo(const Variant & indexable)
@@ -107,9 +138,40 @@ inline Variant indexableGet(const Variant & indexable, const std::size_t index)
 	return getNonReferenceMetaType(indexable)->getMetaIndexable()->get(indexable, index);
 }
 
+inline ErrorCode tryIndexableGet(Variant * result, const Variant & indexable, const std::size_t index)
+{
+	const MetaIndexable * metaIndexable = getNonReferenceMetaType(indexable)->getMetaIndexable();
+	if(metaIndexable == nullptr) {
+		return ErrorCode::unsupported;
+	}
+	const MetaIndexable::SizeInfo sizeInfo = metaIndexable->getSizeInfo(indexable);
+	if(! sizeInfo.isUnknownSize() && index >= sizeInfo.getSize()) {
+		return ErrorCode::outOfRange;
+	}
+	if(result != nullptr) {
+		*result = metaIndexable->get(indexable, index);
+	}
+	return ErrorCode::ok;
+}
+
 inline void indexableSet(const Variant & indexable, const std::size_t index, const Variant & value)
 {
 	getNonReferenceMetaType(indexable)->getMetaIndexable()->set(indexable, index, value);
+#ifdef METAPP_ENABLE_CHANGE_TRACKING
+	if(internal_::isChangeTrackingActive()) {
+		internal_::recordIndexableChange(indexable, index);
+	}
+#endif
+}
+
+inline void * indexableGetData(const Variant & indexable)
+{
+	return getNonReferenceMetaType(indexable)->getMetaIndexable()->getData(indexable);
+}
+
+inline void * indexableGetElementAddress(const Variant & indexable, const std::size_t index)
+{
+	return getNonReferenceMetaType(indexable)->getMetaIndexable()->getElementAddress(indexable, index);
 }
 
 
@@ -20,6 +20,10 @@
 #include "metapp/variant.h"
 #include "metapp/utilities/utility.h"
 
+#ifdef METAPP_ENABLE_CHANGE_TRACKING
+#include "metapp/implement/internal/changetracker_i.h"
+#endif
+
 #include <functional>
 
 namespace metapp {
@@ -62,6 +66,11 @@ inline Variant mappableGet(const Variant & mappable, const Variant & key)
 inline void mappableSet(const Variant & mappable, const Variant & key, const Variant & value)
 {
 	getNonReferenceMetaType(mappable)->getMetaMappable()->set(mappable, key, value);
+#ifdef METAPP_ENABLE_CHANGE_TRACKING
+	if(internal_::isChangeTrackingActive()) {
+		internal_::recordMappableChange(mappable, key);
+	}
+#endif
 }
 
 inline void mappableForEach(const Variant & mappable, const MetaMappable::Callback & callback)
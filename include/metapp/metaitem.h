@@ -23,6 +23,14 @@ namespace metapp {
 
 class MetaRepo;
 
+namespace internal_ {
+class MetaMemoryCounter;
+class MetaRepoBase;
+class ScopedGeneration;
+} // namespace internal_
+
+class MetaEnum;
+
 class MetaItem
 {
 public:
@@ -41,13 +49,16 @@ private:
 	struct Data
 	{
 		Data(const Type type, const std::string & name, const Variant & target)
-			: type(type), name(name), target(target)
+			: type(type), name(name), target(target), ownerGeneration(nullptr)
 		{
 		}
 
 		Type type;
 		std::string name;
 		Variant target;
+		// The generation of the repo or the enum that owns the item, it's increased when the item is changed.
+		// The owner owns the generation, and resets the pointer when it's destroyed.
+		internal_::ScopedGeneration * ownerGeneration;
 	};
 
 public:
@@ -87,10 +98,16 @@ public:
 private:
 	const Variant & doGetVariant() const;
 	void doCheckType(const Type type) const;
+	void doSetOwnerGeneration(internal_::ScopedGeneration * generation);
+	void doIncreaseOwnerGeneration();
 
 private:
 	std::shared_ptr<Data> data;
 	std::shared_ptr<std::map<std::string, Variant> > annotationMap;
+
+	friend class internal_::MetaMemoryCounter;
+	friend class internal_::MetaRepoBase;
+	friend class MetaEnum;
 };
 
 
@@ -28,6 +28,7 @@ class MetaRepoList;
 namespace internal_ {
 
 MetaRepoList * doGetMetaRepoList();
+class NameIndexImplement;
 
 } // namespace internal_
 
@@ -37,8 +38,9 @@ public:
 	MetaRepo();
 	~MetaRepo();
 
-	MetaRepo(const MetaRepo &) = default;
-	MetaRepo(MetaRepo &&) = default;
+	// The copy is added to MetaRepoList as a new repo.
+	MetaRepo(const MetaRepo & other);
+	MetaRepo(MetaRepo && other);
 
 	const MetaItem & getAccessible(const std::string & name) const;
 	MetaItemView getAccessibleView() const;
@@ -60,6 +62,16 @@ public:
 
 	const MetaItem & getItem(const std::string & name) const;
 
+	MetaItemPointerList findCallablesByArity(const int arity) const;
+	MetaItemPointerList findCallablesByParameter(
+		const int arity,
+		const int parameterIndex,
+		const MetaType * parameterType
+	) const;
+	MetaItemPointerList findCallablesByReturnType(const MetaType * returnType) const;
+	MetaItemPointerList findItemsByAnnotation(const std::string & name) const;
+	MetaItemPointerList findItemsByAnnotationValue(const std::string & name, const Variant & value) const;
+
 private:
 	std::shared_ptr<ItemData> repoData;
 
@@ -68,6 +80,8 @@ private:
 	MetaRepo * next;
 
 	friend class MetaRepoList;
+	friend class internal_::MetaMemoryCounter;
+	friend class internal_::NameIndexImplement;
 };
 
 class MetaRepoList
@@ -178,6 +192,17 @@ private:
 
 const MetaRepoList * getMetaRepoList();
 
+// Returns the meta type of the most derived class of the object which var points to or refers to.
+// var can be a pointer, a reference, a value, or a pointer wrapper such as std::shared_ptr.
+// The classes must be polymorphic and registered by registerBase, either as a base or a derived class.
+// If the dynamic type can't be resolved, returns the static type, the same as getPointedType(var).
+const MetaType * getDynamicMetaType(const Variant & var);
+
+// Returns a Variant which refers to the most derived object, the address is adjusted by dynamic_cast<void *>.
+// If the dynamic type can't be resolved, refers to the object as the static type.
+// Returns empty Variant if the static type is not a registered polymorphic class, or the pointer is nullptr.
+Variant getDynamicReference(const Variant & var);
+
 } // namespace metapp
 
 
@@ -80,6 +80,9 @@ struct MetaTable
 	const void * module;
 };
 
+// Internal type flag, set if canCast results of the type only depend on the types, so they can be memoized.
+constexpr TypeFlags tfCastCacheable = 1 << 15;
+
 } // namespace internal_
 
 class Constness
@@ -339,6 +342,10 @@ private:
 		return metaTable.rawType;
 	}
 
+	bool isCastCacheable() const noexcept {
+		return typeFlags & internal_::tfCastCacheable;
+	}
+
 	bool doCheckEqualCrossModules(const MetaType * other) const;
 
 	template <typename T>
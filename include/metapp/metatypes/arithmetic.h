@@ -36,6 +36,7 @@ struct DeclareMetaTypeBase <T,
 	: MetaStreamableBase<T>
 {
 	static constexpr TypeKind typeKind = TypeKind(tkFundamentalBegin + TypeListIndexOf<internal_::ArithmeticTypeList, T>::value);
+	static constexpr bool castCacheable = true;
 
 	// The casting can be done by inheriting from CastToTypes<internal_::ArithmeticTypeList>, and no need to implement `cast` here.
 	// The problem is CastToTypes has O(N) time complexity, N is the target type count which is large (near 20) here, so
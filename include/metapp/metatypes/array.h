@@ -38,6 +38,7 @@ struct DeclareMetaTypeArrayBase : MetaStreamableBase<T>
 	using UpType = typename std::remove_extent<typename std::remove_cv<T>::type>::type;
 
 	static constexpr TypeKind typeKind = tkArray;
+	static constexpr bool castCacheable = true;
 
 	static const MetaIndexable * getMetaIndexable() {
 		static MetaIndexable metaIndexable(
@@ -45,7 +46,8 @@ struct DeclareMetaTypeArrayBase : MetaStreamableBase<T>
 			&metaIndexableGetValueType,
 			nullptr,
 			&metaIndexableGet,
-			&metaIndexableSet
+			&metaIndexableSet,
+			&metaIndexableGetData
 		);
 		return &metaIndexable;
 	}
@@ -170,7 +172,7 @@ private:
 
 	static const MetaType * metaIndexableGetValueType(const Variant & /*var*/, const std::size_t /*index*/)
 	{
-		return getMetaType<T>();
+		return getMetaType<ElementType>();
 	}
 
 	static Variant metaIndexableGet(const Variant & var, const std::size_t index)
@@ -190,6 +192,11 @@ private:
 		}
 	}
 
+	static void * metaIndexableGetData(const Variant & var)
+	{
+		return var.getAddress();
+	}
+
 };
 
 template <typename T>
@@ -30,6 +30,7 @@ struct DeclareMetaTypeBase <T, typename std::enable_if<std::is_enum<T>::value>::
 {
 	using UpType = typename std::underlying_type<T>::type;
 	static constexpr TypeKind typeKind = tkEnum;
+	static constexpr bool castCacheable = true;
 };
 
 
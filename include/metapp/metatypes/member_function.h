@@ -41,7 +41,9 @@ public:
 			&DeclareMetaTypeMemberFunctionBase::metaCallableGetParameterType,
 			&DeclareMetaTypeMemberFunctionBase::metaCallableRankInvoke,
 			&DeclareMetaTypeMemberFunctionBase::metaCallableCanInvoke,
-			&DeclareMetaTypeMemberFunctionBase::metaCallableInvoke
+			&DeclareMetaTypeMemberFunctionBase::metaCallableInvoke,
+			&DeclareMetaTypeMemberFunctionBase::metaCallableInvokeBatch,
+			&DeclareMetaTypeMemberFunctionBase::metaCallableInvokeRef
 		);
 		return &metaCallable;
 	}
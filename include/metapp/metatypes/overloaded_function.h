@@ -23,6 +23,7 @@
 #include "metapp/utilities/utility.h"
 
 #include <deque>
+#include <vector>
 
 namespace metapp {
 
@@ -72,7 +73,8 @@ public:
 			&metaCallableGetParameterType,
 			&metaCallableRankInvoke,
 			&metaCallableCanInvoke,
-			&metaCallableInvoke
+			&metaCallableInvoke,
+			&metaCallableInvokeBatch
 		);
 		return &metaCallable;
 	}
@@ -132,6 +134,66 @@ public:
 		return Variant();
 	}
 
+	// If every column holds the same meta type on all rows, the overload is resolved only once
+	// using the first row, and the whole batch is forwarded to the chosen callable.
+	// Otherwise each row may resolve to a different overload, so the batch is invoked row by row.
+	static void metaCallableInvokeBatch(
+		const Variant & func,
+		const ArgumentSpan & instances,
+		const ArgumentColumnSpan & argumentColumns,
+		const ResultColumnSpan & resultColumn
+	)
+	{
+		const int rowCount = internal_::getBatchRowCount(instances, argumentColumns, resultColumn);
+		if(rowCount <= 0 || ! isHomogeneousBatch(instances, argumentColumns)) {
+			internal_::invokeBatchByRows(func, instances, argumentColumns, resultColumn);
+			return;
+		}
+
+		std::vector<Variant> firstRow;
+		firstRow.reserve(argumentColumns.size());
+		for(const auto & column : argumentColumns) {
+			firstRow.push_back(column[0]);
+		}
+		const Variant & firstInstance = internal_::getBatchInstance(instances, 0);
+		const auto & callableList = func.get<const OverloadedFunction &>().getCallableList();
+		auto it = findCallable(callableList.begin(), callableList.end(), firstInstance, firstRow, nullptr);
+		if(it == callableList.end()) {
+			raiseException<IllegalArgumentException>();
+			return;
+		}
+		getNonReferenceMetaType(*it)->getMetaCallable()->invokeBatch(*it, instances, argumentColumns, resultColumn);
+	}
+
+private:
+	static bool isHomogeneousColumn(const ArgumentSpan & column) {
+		if(column.empty()) {
+			return true;
+		}
+		const MetaType * metaType = column[0].getMetaType();
+		if(getNonReferenceMetaType(metaType)->getTypeKind() == tkVariant) {
+			return false;
+		}
+		for(const auto & item : column) {
+			if(item.getMetaType() != metaType) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool isHomogeneousBatch(const ArgumentSpan & instances, const ArgumentColumnSpan & argumentColumns) {
+		if(! isHomogeneousColumn(instances)) {
+			return false;
+		}
+		for(const auto & column : argumentColumns) {
+			if(! isHomogeneousColumn(column)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
 };
 
 
@@ -36,6 +36,7 @@ struct DeclareMetaTypePointerBase
 	using UpType = typename std::remove_pointer<T>::type;
 
 	static constexpr TypeKind typeKind = tkPointer;
+	static constexpr bool castCacheable = true;
 
 };
 
@@ -77,6 +78,9 @@ private:
 template <typename T>
 struct DeclareMetaTypeVoidPtrBase : DeclareMetaTypePointerBase<T>
 {
+	// cast and castFrom only check whether the other type is a pointer.
+	static constexpr bool castCacheable = true;
+
 	static bool cast(Variant * result, const Variant * fromVar, const MetaType * toMetaType) {
 		if(toMetaType->isPointer()) {
 			if(result != nullptr) {
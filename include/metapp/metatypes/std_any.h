@@ -18,15 +18,172 @@
 #define METAPP_STD_ANY_H_969872685611
 
 #include "metapp/metatype.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/implement/internal/util_i.h"
+#include "metapp/implement/internal/copyonwrite_i.h"
+#include "metapp/metatypes/std_string.h"
 
 #include <any>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include <memory>
 
 namespace metapp {
 
+namespace internal_ {
+
+// std::any only exposes std::type_info of the held value, so the types that can be accessed
+// through MetaAccessible are kept in a registry which maps std::type_index to the accessors.
+// The map is a CopyOnWriteValue, so finding an entry doesn't lock, and the replaced maps are freed
+// once no reader uses them. The entries are never freed, so the pointers found by readers are always valid.
+// Registering a type which is already registered does nothing. A type can't be unregistered.
+class StdAnyTypeRegistry
+{
+public:
+	struct Entry
+	{
+		const MetaType * metaType;
+		Variant (*get)(std::any & any);
+		void (*set)(std::any & any, const Variant & value);
+	};
+
+private:
+	using EntryMap = std::unordered_map<std::type_index, const Entry *>;
+
+public:
+	template <typename T>
+	void registerType() {
+		if(findEntry(typeid(T)) != nullptr) {
+			return;
+		}
+		entryMap.update([this](EntryMap & map) -> bool {
+			if(map.find(std::type_index(typeid(T))) != map.end()) {
+				return false;
+			}
+			doRegisterType<T>(map);
+			return true;
+		});
+	}
+
+	const Entry * findEntry(const std::type_info & typeInfo) const {
+		const auto reader = entryMap.read();
+		auto it = reader->find(std::type_index(typeInfo));
+		return it == reader->end() ? nullptr : it->second;
+	}
+
+	static StdAnyTypeRegistry & getInstance() {
+		static StdAnyTypeRegistry instance;
+		return instance;
+	}
+
+private:
+	StdAnyTypeRegistry() : entryList(), entryMap() {
+		entryMap.update([this](EntryMap & map) -> bool {
+			doRegisterTypes<
+				bool, char, wchar_t, signed char, unsigned char, short, unsigned short,
+				int, unsigned int, long, unsigned long, long long, unsigned long long,
+				float, double, long double,
+				std::string, std::wstring
+			>(map);
+			return true;
+		});
+	}
+
+	template <typename T>
+	static Variant entryGet(std::any & any) {
+		return Variant::reference(*std::any_cast<T>(&any));
+	}
+
+	template <typename T>
+	static void entrySet(std::any & any, const Variant & value) {
+		assignValue(*std::any_cast<T>(&any), value.cast<T>().template get<const T &>());
+	}
+
+	// Called inside CopyOnWriteValue::update, which serializes the writers.
+	template <typename T>
+	void doRegisterType(EntryMap & map) {
+		entryList.emplace_back(new Entry { getMetaType<T>(), &entryGet<T>, &entrySet<T> });
+		map[std::type_index(typeid(T))] = entryList.back().get();
+	}
+
+	template <typename ...Types>
+	void doRegisterTypes(EntryMap & map) {
+		using Expander = int[];
+		(void)Expander { 0, (doRegisterType<Types>(map), 0)... };
+	}
+
+private:
+	std::vector<std::unique_ptr<const Entry> > entryList;
+	CopyOnWriteValue<EntryMap> entryMap;
+};
+
+} // namespace internal_
+
+template <typename T>
+void registerStdAnyType()
+{
+	internal_::StdAnyTypeRegistry::getInstance().registerType<typename std::decay<T>::type>();
+}
+
 template <>
 struct DeclareMetaTypeBase <std::any>
 {
 	static constexpr TypeKind typeKind = tkStdAny;
+
+	// The accessible value is the value held by std::any.
+	static const MetaAccessible * getMetaAccessible() {
+		static MetaAccessible metaAccessible(
+			&accessibleGetValueType,
+			&accessibleIsReadOnly,
+			internal_::voidMetaTypeFromVariant,
+			&accessibleGet,
+			&accessibleSet
+		);
+		return &metaAccessible;
+	}
+
+private:
+	static const internal_::StdAnyTypeRegistry::Entry * findEntry(std::any & any) {
+		if(! any.has_value()) {
+			return nullptr;
+		}
+		return internal_::StdAnyTypeRegistry::getInstance().findEntry(any.type());
+	}
+
+	static const MetaType * accessibleGetValueType(const Variant & accessible) {
+		const internal_::StdAnyTypeRegistry::Entry * entry = findEntry(accessible.get<std::any &>());
+		return entry == nullptr ? getMetaType<void>() : entry->metaType;
+	}
+
+	static bool accessibleIsReadOnly(const Variant & /*accessible*/) {
+		return false;
+	}
+
+	static Variant accessibleGet(const Variant & accessible, const Variant & /*instance*/) {
+		std::any & any = accessible.get<std::any &>();
+		if(! any.has_value()) {
+			return Variant();
+		}
+		const internal_::StdAnyTypeRegistry::Entry * entry = findEntry(any);
+		if(entry == nullptr) {
+			raiseException<UnsupportedException>("The type in std::any is not registered by registerStdAnyType");
+			return Variant();
+		}
+		return entry->get(any);
+	}
+
+	static void accessibleSet(const Variant & accessible, const Variant & /*instance*/, const Variant & value) {
+		requireMutable(accessible);
+
+		std::any & any = accessible.get<std::any &>();
+		const internal_::StdAnyTypeRegistry::Entry * entry = findEntry(any);
+		if(entry == nullptr) {
+			raiseException<UnsupportedException>("The type in std::any is not registered by registerStdAnyType");
+			return;
+		}
+		entry->set(any, value);
+	}
 };
 
 
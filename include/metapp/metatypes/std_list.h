@@ -50,7 +50,9 @@ private:
 
 	static MetaIndexable::SizeInfo metaIndexableGetSizeInfo(const Variant & var)
 	{
-		return MetaIndexable::SizeInfo { var.get<ContainerType &>().size() };
+		MetaIndexable::SizeInfo sizeInfo { var.get<ContainerType &>().size() };
+		sizeInfo.setRandomAccess(false);
+		return sizeInfo;
 	}
 
 	static const MetaType * metaIndexableGetValueType(const Variant & /*var*/, const std::size_t /*index*/)
@@ -67,6 +67,7 @@ struct DeclareMetaTypeBase <std::shared_ptr<T> >
 
 	using UpType = T;
 	static constexpr TypeKind typeKind = tkStdSharedPtr;
+	static constexpr bool castCacheable = true;
 
 	static VariantData constructVariantData(const void * copyFrom, const CopyStrategy /*copyStrategy*/) {
 		if(copyFrom == nullptr) {
@@ -18,17 +18,121 @@
 #define METAPP_STD_VARIANT_H_969872685611
 
 #include "metapp/metatype.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/implement/internal/util_i.h"
 
 #include <variant>
+#include <utility>
+#include <type_traits>
 
 namespace metapp {
 
+namespace internal_ {
+
+template <std::size_t index, typename StdVariant, typename T>
+void emplaceStdVariant(StdVariant & stdVariant, const Variant & value,
+	typename std::enable_if<std::is_copy_constructible<T>::value>::type * = nullptr)
+{
+	stdVariant.template emplace<index>(value.cast<T>().template get<const T &>());
+}
+
+template <std::size_t index, typename StdVariant, typename T>
+void emplaceStdVariant(StdVariant & /*stdVariant*/, const Variant & /*value*/,
+	typename std::enable_if<! std::is_copy_constructible<T>::value>::type * = nullptr)
+{
+	raiseException<UnwritableException>();
+}
+
+} // namespace internal_
+
 template <typename ...Types>
 struct DeclareMetaTypeBase <std::variant<Types...> >
 {
+	using StdVariant = std::variant<Types...>;
+
 	using UpType = TypeList<Types...>;
 	static constexpr TypeKind typeKind = tkStdVariant;
 
+	// The accessible value is the active alternative.
+	static const MetaAccessible * getMetaAccessible() {
+		static MetaAccessible metaAccessible(
+			&accessibleGetValueType,
+			&accessibleIsReadOnly,
+			internal_::voidMetaTypeFromVariant,
+			&accessibleGet,
+			&accessibleSet
+		);
+		return &metaAccessible;
+	}
+
+private:
+	using GetFunc = Variant (*)(StdVariant & stdVariant);
+	using SetFunc = void (*)(StdVariant & stdVariant, const Variant & value);
+
+	static constexpr std::size_t alternativeCount = sizeof...(Types);
+
+	static const MetaType * accessibleGetValueType(const Variant & accessible) {
+		const std::size_t index = accessible.get<StdVariant &>().index();
+		if(index == std::variant_npos) {
+			return getMetaType<void>();
+		}
+		static const MetaType * const typeTable[] = { getMetaType<Types>()... };
+		return typeTable[index];
+	}
+
+	static bool accessibleIsReadOnly(const Variant & /*accessible*/) {
+		return false;
+	}
+
+	static Variant accessibleGet(const Variant & accessible, const Variant & /*instance*/) {
+		StdVariant & stdVariant = accessible.get<StdVariant &>();
+		if(stdVariant.valueless_by_exception()) {
+			return Variant();
+		}
+		return doGet(stdVariant, std::index_sequence_for<Types...>());
+	}
+
+	// If the type of value is exactly one of the alternatives, that alternative becomes active,
+	// otherwise value is casted to the active alternative.
+	static void accessibleSet(const Variant & accessible, const Variant & /*instance*/, const Variant & value) {
+		requireMutable(accessible);
+
+		StdVariant & stdVariant = accessible.get<StdVariant &>();
+		const MetaType * valueType = getNonReferenceMetaType(value);
+		static const MetaType * const typeTable[] = { getMetaType<Types>()... };
+		std::size_t index = stdVariant.valueless_by_exception() ? 0 : stdVariant.index();
+		for(std::size_t i = 0; i < alternativeCount; ++i) {
+			if(valueType->equal(typeTable[i])) {
+				index = i;
+				break;
+			}
+		}
+		doSet(stdVariant, index, value, std::index_sequence_for<Types...>());
+	}
+
+	template <std::size_t index>
+	static Variant doGetAlternative(StdVariant & stdVariant) {
+		return Variant::reference(*std::get_if<index>(&stdVariant));
+	}
+
+	template <std::size_t index>
+	static void doSetAlternative(StdVariant & stdVariant, const Variant & value) {
+		internal_::emplaceStdVariant<index, StdVariant, std::variant_alternative_t<index, StdVariant> >(stdVariant, value);
+	}
+
+	// The jump tables are indexed by the alternative index, so get and set are O(1)
+	// regardless of the number of alternatives.
+	template <std::size_t ...indexes>
+	static Variant doGet(StdVariant & stdVariant, std::index_sequence<indexes...>) {
+		static constexpr GetFunc funcTable[] = { &doGetAlternative<indexes>... };
+		return funcTable[stdVariant.index()](stdVariant);
+	}
+
+	template <std::size_t ...indexes>
+	static void doSet(StdVariant & stdVariant, const std::size_t index, const Variant & value, std::index_sequence<indexes...>) {
+		static constexpr SetFunc funcTable[] = { &doSetAlternative<indexes>... };
+		funcTable[index](stdVariant, value);
+	}
 };
 
 
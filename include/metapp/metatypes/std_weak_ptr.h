@@ -30,6 +30,7 @@ struct DeclareMetaTypeBase <std::weak_ptr<T> >
 
 	using UpType = T;
 	static constexpr TypeKind typeKind = tkStdWeakPtr;
+	static constexpr bool castCacheable = true;
 
 	static bool cast(Variant * result, const Variant * fromVar, const MetaType * toMetaType) {
 		const MetaType * nonRef = getNonReferenceMetaType(toMetaType);
@@ -0,0 +1,106 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_THUNK_FUNCTION_H_969872685611
+#define METAPP_THUNK_FUNCTION_H_969872685611
+
+#include "metapp/metatype.h"
+#include "metapp/variant.h"
+#include "metapp/interfaces/metacallable.h"
+
+namespace metapp {
+
+// ThunkFunction is a callable described by plain data instead of template parameters.
+// The generated registration code (tools/genregistration.py) uses it, so all generated callables share
+// one meta type, and the functions with the same signature share one thunk.
+// `data` points to the function pointer (a trampoline taking `void *` instance for member functions),
+// it's passed to `invoke` as is, and must outlive the ThunkFunction.
+// `parameterTypes` points to `parameterCount` meta types, it must outlive the ThunkFunction too.
+class ThunkFunction
+{
+public:
+	using Invoke = Variant (*)(const void * data, void * instance, const ArgumentSpan & arguments);
+
+	ThunkFunction()
+		: invoke(nullptr), data(nullptr), classType(voidMetaType), returnType(voidMetaType), parameterTypes(nullptr), parameterCount(0)
+	{
+	}
+
+	ThunkFunction(
+		const Invoke invoke,
+		const void * data,
+		const MetaType * classType,
+		const MetaType * returnType,
+		const MetaType * const * parameterTypes,
+		const int parameterCount
+	)
+		:
+			invoke(invoke),
+			data(data),
+			classType(classType),
+			returnType(returnType),
+			parameterTypes(parameterTypes),
+			parameterCount(parameterCount)
+	{
+	}
+
+	Invoke getInvoke() const {
+		return invoke;
+	}
+
+	const void * getData() const {
+		return data;
+	}
+
+	const MetaType * getClassType() const {
+		return classType;
+	}
+
+	const MetaType * getReturnType() const {
+		return returnType;
+	}
+
+	const MetaType * getParameterType(const int index) const {
+		if(index < 0 || index >= parameterCount) {
+			return voidMetaType;
+		}
+		return parameterTypes[index];
+	}
+
+	int getParameterCount() const {
+		return parameterCount;
+	}
+
+private:
+	Invoke invoke;
+	const void * data;
+	const MetaType * classType;
+	const MetaType * returnType;
+	const MetaType * const * parameterTypes;
+	int parameterCount;
+};
+
+template <>
+struct DeclareMetaType <ThunkFunction> : DeclareMetaTypeBase <ThunkFunction>
+{
+	static const MetaCallable * getMetaCallable();
+};
+
+
+} // namespace metapp
+
+#endif
@@ -15,6 +15,7 @@
 #define ACCESSORPP_GETTER_H_578722158669
 
 #include "internal/typeutil_i.h"
+#include "internal/callablestorage_i.h"
 #include "metapp/thirdparty/accessorpp/common.h"
 
 #include <functional>
@@ -137,7 +138,7 @@ public:
 	}
 
 private:
-	std::function<Type (const void *)> getterFunc;
+	private_::CallableStorage<Type (const void *)> getterFunc;
 };
 
 template <typename T>
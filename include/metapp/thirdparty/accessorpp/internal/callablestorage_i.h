@@ -0,0 +1,189 @@
+// accessorpp library
+// Copyright (C) 2022 Wang Qi (wqking)
+// Github: https://github.com/wqking/accessorpp
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//   http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ACCESSORPP_CALLABLESTORAGE_I_H_582750282985
+#define ACCESSORPP_CALLABLESTORAGE_I_H_582750282985
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <new>
+
+namespace accessorpp {
+
+namespace private_ {
+
+template <typename Signature>
+class CallableStorage;
+
+// Holds the callable of Getter and Setter.
+// Small trivially copyable callables, such as the lambdas capturing only member pointers,
+// function pointers and instance pointers, are stored in place and invoked through a function pointer
+// which is instantiated for the exact callable type, so the call can be inlined in the thunk.
+// Other callables are allocated on the heap, and the buffer holds the pointer.
+// Both kinds use the same table of function pointers, so the storage is one pointer plus the buffer.
+template <typename R, typename ...Args>
+class CallableStorage <R (Args...)>
+{
+private:
+	using Buffer = typename std::aligned_storage<sizeof(void *) * 4, alignof(void *)>::type;
+
+	struct VirtualTable
+	{
+		R (*invoke)(const Buffer & buffer, Args ... args);
+		// copy and destroy are nullptr if the buffer can be copied bitwise and needn't be destroyed.
+		void (*copy)(Buffer & to, const Buffer & from);
+		void (*destroy)(Buffer & buffer);
+	};
+
+	template <typename F>
+	struct CanStoreInPlace
+	{
+		static constexpr bool value = std::is_trivially_copyable<F>::value
+			&& sizeof(F) <= sizeof(Buffer)
+			&& alignof(Buffer) % alignof(F) == 0
+		;
+	};
+
+	struct EmptyCallable
+	{
+		static R invoke(const Buffer & /*buffer*/, Args ... /*args*/) {
+			throw std::bad_function_call();
+		}
+
+		static const VirtualTable * getVirtualTable() {
+			static const VirtualTable virtualTable { &invoke, nullptr, nullptr };
+			return &virtualTable;
+		}
+	};
+
+	template <typename F>
+	struct InPlaceCallable
+	{
+		static R invoke(const Buffer & buffer, Args ... args) {
+			return (*reinterpret_cast<const F *>(&buffer))(std::forward<Args>(args)...);
+		}
+
+		static const VirtualTable * getVirtualTable() {
+			static const VirtualTable virtualTable { &invoke, nullptr, nullptr };
+			return &virtualTable;
+		}
+	};
+
+	template <typename F>
+	struct HeapCallable
+	{
+		static F * getCallable(const Buffer & buffer) {
+			return *reinterpret_cast<F * const *>(&buffer);
+		}
+
+		static R invoke(const Buffer & buffer, Args ... args) {
+			return (*getCallable(buffer))(std::forward<Args>(args)...);
+		}
+
+		static void copy(Buffer & to, const Buffer & from) {
+			new (&to) F * (new F(*getCallable(from)));
+		}
+
+		static void destroy(Buffer & buffer) {
+			delete getCallable(buffer);
+		}
+
+		static const VirtualTable * getVirtualTable() {
+			static const VirtualTable virtualTable { &invoke, &copy, &destroy };
+			return &virtualTable;
+		}
+	};
+
+public:
+	CallableStorage()
+		: virtualTable(EmptyCallable::getVirtualTable()), buffer()
+	{
+	}
+
+	template <typename F>
+	explicit CallableStorage(F f,
+		typename std::enable_if<CanStoreInPlace<F>::value>::type * = nullptr)
+		: virtualTable(InPlaceCallable<F>::getVirtualTable()), buffer()
+	{
+		new (&buffer) F(f);
+	}
+
+	template <typename F>
+	explicit CallableStorage(F f,
+		typename std::enable_if<! CanStoreInPlace<F>::value>::type * = nullptr)
+		: virtualTable(HeapCallable<F>::getVirtualTable()), buffer()
+	{
+		new (&buffer) F * (new F(std::move(f)));
+	}
+
+	CallableStorage(const CallableStorage & other)
+		: virtualTable(other.virtualTable), buffer()
+	{
+		if(virtualTable->copy == nullptr) {
+			buffer = other.buffer;
+		}
+		else {
+			virtualTable->copy(buffer, other.buffer);
+		}
+	}
+
+	CallableStorage(CallableStorage && other) noexcept
+		: virtualTable(other.virtualTable), buffer(other.buffer)
+	{
+		other.virtualTable = EmptyCallable::getVirtualTable();
+	}
+
+	~CallableStorage() {
+		doDestroy();
+	}
+
+	CallableStorage & operator = (const CallableStorage & other) {
+		if(this != &other) {
+			CallableStorage copied(other);
+			*this = std::move(copied);
+		}
+		return *this;
+	}
+
+	CallableStorage & operator = (CallableStorage && other) noexcept {
+		if(this != &other) {
+			doDestroy();
+			virtualTable = other.virtualTable;
+			buffer = other.buffer;
+			other.virtualTable = EmptyCallable::getVirtualTable();
+		}
+		return *this;
+	}
+
+	R operator() (Args ... args) const {
+		return virtualTable->invoke(buffer, std::forward<Args>(args)...);
+	}
+
+private:
+	void doDestroy() {
+		if(virtualTable->destroy != nullptr) {
+			virtualTable->destroy(buffer);
+		}
+	}
+
+private:
+	const VirtualTable * virtualTable;
+	Buffer buffer;
+};
+
+} // namespace private_
+
+} // namespace accessorpp
+
+#endif
@@ -15,6 +15,7 @@
 #define ACCESSORPP_SETTER_H_578722158669
 
 #include "internal/typeutil_i.h"
+#include "internal/callablestorage_i.h"
 
 #include <functional>
 #include <type_traits>
@@ -109,7 +110,7 @@ public:
 	}
 
 private:
-	std::function<void (void *, const ValueType &)> setterFunc;
+	private_::CallableStorage<void (void *, const ValueType &)> setterFunc;
 };
 
 template <typename T>
@@ -0,0 +1,121 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_ASYNCINVOKE_H_969872685611
+#define METAPP_ASYNCINVOKE_H_969872685611
+
+#include "metapp/variant.h"
+#include "metapp/interfaces/metacallable.h"
+#include "metapp/utilities/threadpool.h"
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace metapp {
+
+namespace internal_ {
+
+// A pooled slot that holds everything an asynchronous invocation needs.
+// The slots are recycled, and `arguments` keeps its capacity, so after warm up
+// submitting an invocation doesn't allocate memory.
+struct AsyncInvokeSlot : ExecutorTask
+{
+	AsyncInvokeSlot();
+
+	Variant callable;
+	Variant instance;
+	std::vector<Variant> arguments;
+	Variant result;
+	std::exception_ptr exception;
+	std::atomic<bool> ready;
+	// One reference for the executor, one for the InvokeFuture
+	std::atomic<int> referenceCount;
+	std::mutex mutex;
+	std::condition_variable condition;
+	AsyncInvokeSlot * nextFree;
+};
+
+AsyncInvokeSlot * acquireAsyncInvokeSlot();
+void releaseAsyncInvokeSlot(AsyncInvokeSlot * slot);
+
+template <typename ...Args>
+void pushAsyncInvokeArguments(std::vector<Variant> & /*arguments*/)
+{
+}
+
+template <typename T, typename ...Args>
+void pushAsyncInvokeArguments(std::vector<Variant> & arguments, T && first, Args && ... args)
+{
+	arguments.emplace_back(std::forward<T>(first));
+	pushAsyncInvokeArguments(arguments, std::forward<Args>(args)...);
+}
+
+} // namespace internal_
+
+class InvokeFuture
+{
+public:
+	InvokeFuture() noexcept;
+	// Takes over one reference of the slot
+	explicit InvokeFuture(internal_::AsyncInvokeSlot * slot) noexcept;
+	~InvokeFuture();
+
+	InvokeFuture(const InvokeFuture & other) noexcept;
+	InvokeFuture(InvokeFuture && other) noexcept;
+	InvokeFuture & operator = (InvokeFuture other) noexcept;
+
+	bool isValid() const noexcept;
+	bool isReady() const noexcept;
+	void wait() const;
+	// Waits for the invocation, then returns the result, or rethrows the exception thrown by the callable.
+	Variant get() const;
+
+private:
+	internal_::AsyncInvokeSlot * slot;
+};
+
+namespace internal_ {
+
+InvokeFuture submitAsyncInvoke(Executor & executor, AsyncInvokeSlot * slot);
+
+} // namespace internal_
+
+template <typename ...Args>
+InvokeFuture callableInvokeAsync(Executor & executor, const Variant & callable, const Variant & instance, Args && ... args)
+{
+	internal_::AsyncInvokeSlot * slot = internal_::acquireAsyncInvokeSlot();
+	slot->callable = callable;
+	slot->instance = instance;
+	internal_::pushAsyncInvokeArguments(slot->arguments, std::forward<Args>(args)...);
+	return internal_::submitAsyncInvoke(executor, slot);
+}
+
+void callableInvokeAsyncBatch(
+	Executor & executor,
+	const Variant & callable,
+	const ArgumentSpan & instances,
+	const ArgumentColumnSpan & argumentColumns,
+	const metapp::span<InvokeFuture> & futures
+);
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,71 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_BULKCONVERT_H_969872685611
+#define METAPP_BULKCONVERT_H_969872685611
+
+#include "metapp/typekind.h"
+
+#include <cstddef>
+
+namespace metapp {
+
+class Variant;
+
+// The instruction sets used by bulkConvert kernels.
+enum class BulkConvertIsa
+{
+	scalar,
+	sse2,
+	avx2,
+	avx512
+};
+
+// Returns true if both type kinds are arithmetic, then bulkConvert can convert between them.
+bool canBulkConvert(const TypeKind sourceTypeKind, const TypeKind destinationTypeKind);
+
+// Converts count arithmetic values at source to destination, element by element, as static_cast does,
+// except that floating point to integer conversions saturate: NaN becomes 0, and the values out of the range
+// of the integer become its minimum or maximum. All instruction sets give the same result.
+// The kernel is dispatched once per call, it's vectorized using the best instruction set supported by the CPU.
+// source and destination must not overlap. Throws UnsupportedException if any type kind is not arithmetic.
+void bulkConvert(
+	const void * source,
+	const TypeKind sourceTypeKind,
+	const std::size_t count,
+	void * destination,
+	const TypeKind destinationTypeKind
+);
+
+// Converts all elements in indexable source to indexable destination.
+// destination is resized to the size of source if it's resizable.
+// If both containers are contiguous (MetaIndexable::getData is not nullptr) and the value types are arithmetic,
+// the conversion uses the bulk kernels, otherwise the elements are converted one by one.
+// The arithmetic elements saturate the same in both cases.
+// Returns the number of converted elements.
+std::size_t bulkConvert(const Variant & source, const Variant & destination);
+
+// Returns the instruction set used by the kernels.
+BulkConvertIsa getBulkConvertIsa();
+// Limits the instruction set used by the kernels, mainly for testing and benchmarking.
+// If the CPU doesn't support isa, the best supported instruction set lower than isa is used.
+// Returns the instruction set actually used.
+BulkConvertIsa setBulkConvertIsa(const BulkConvertIsa isa);
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,111 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef METAPP_CHANGETRACKER_H_969872685611
+#define METAPP_CHANGETRACKER_H_969872685611
+
+#include "metapp/variant.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace metapp {
+
+enum class ChangedFieldType
+{
+	// Written by accessibleSet or tryAccessibleSet
+	accessible,
+	// Written by indexableSet
+	index,
+	// Written by mappableSet
+	key
+};
+
+struct ChangedField
+{
+	ChangedFieldType type;
+	// The generation of the last write to the field.
+	std::uint64_t generation;
+	// If type is accessible, the accessible, and its name in the MetaClass of the instance.
+	// The name is empty if the accessible is not registered in the MetaClass or its base classes.
+	Variant accessible;
+	std::string name;
+	// If type is index, the index in the indexable.
+	std::size_t index;
+	// If type is key, the key in the mappable, it's a long long or std::string.
+	Variant key;
+};
+
+struct ChangedInstance
+{
+	// The address and the type of the tracked object.
+	void * address;
+	const MetaType * metaType;
+	// The generation of the last write to the instance.
+	std::uint64_t generation;
+	std::vector<ChangedField> fieldList;
+};
+
+// ChangeTracker records the writes to the tracked instances, so the fields changed since a generation can be
+// listed without reading and comparing all fields.
+// The writes through accessibleSet, tryAccessibleSet, indexableSet, and mappableSet are recorded. An instance is
+// identified by its address and type, so the write is recorded only if the instance (or the indexable, or the mappable)
+// passed to the function refers to the tracked object with the same type. To track a container member, track
+// the container itself, for example, the result of accessibleGet.
+// Each write increases the global generation and stores it to the field, and moves the field to the head of a list
+// in the instance, and moves the instance to the head of a global list, so getChangedFields and getChangedInstances
+// only visit the changed fields and instances.
+// Indexes and integral or enum keys are identified by the value as long long, the other keys are identified by the value
+// as std::string, the writes with keys which can't cast to std::string are not recorded.
+// Writing a member in C++ is not recorded, call markChanged for it.
+// The hooks are only compiled if METAPP_ENABLE_CHANGE_TRACKING is defined, it must be defined for all translation units
+// (the CMake option METAPP_ENABLE_CHANGE_TRACKING does it). Without the macro, only markChanged records the changes.
+// When there is no tracked instance, the hooks only check an atomic counter. Otherwise they check a counting filter
+// of the tracked addresses without locking, and lock only if the address may be tracked.
+// All functions are thread safe.
+class ChangeTracker
+{
+public:
+	// instance is the object, a reference or a pointer to the object. Tracking a tracked instance does nothing.
+	// Untrack the instance before it's destroyed, otherwise another object created at the same address has its changes.
+	static void track(const Variant & instance);
+	static void untrack(const Variant & instance);
+	static bool isTracked(const Variant & instance);
+	static std::size_t getTrackedCount();
+
+	// The generation of the last write to any tracked instance, it's 0 before any write.
+	static std::uint64_t getGeneration();
+	// The generation of the last write to instance, it's 0 if instance is not tracked or never written.
+	static std::uint64_t getGeneration(const Variant & instance);
+
+	// The fields of instance written after sinceGeneration, the latest first. Each field is listed once.
+	// The time is proportional to the number of the returned fields.
+	// Returns empty list if instance is not tracked.
+	static std::vector<ChangedField> getChangedFields(const Variant & instance, const std::uint64_t sinceGeneration);
+	// The tracked instances written after sinceGeneration and their changed fields, the latest first.
+	// The time is proportional to the number of the returned instances and fields, not the number of the tracked instances.
+	static std::vector<ChangedInstance> getChangedInstances(const std::uint64_t sinceGeneration);
+
+	// Records a write to the accessible of instance which doesn't go through accessibleSet.
+	static void markChanged(const Variant & instance, const Variant & accessible);
+};
+
+
+} // namespace metapp
+
+#endif
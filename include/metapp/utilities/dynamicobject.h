@@ -0,0 +1,243 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_DYNAMICOBJECT_H_969872685611
+#define METAPP_DYNAMICOBJECT_H_969872685611
+
+#include "metapp/variant.h"
+#include "metapp/metatype.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace metapp {
+
+class MetaAccessible;
+class MetaMappable;
+
+// DynamicShape describes the property layout of DynamicObject, similar to the hidden classes in JavaScript engines.
+// A shape is the property names in order of adding, the slot of a property is its index in the names.
+// Shapes are immutable and shared. Adding a property transitions to a child shape, objects which add the same
+// properties in the same order get the same shape. Shapes are never destroyed before the program exits.
+// A shape only stores its parent and the name it adds, the lookup table of the names is built when the shape
+// is looked up the first time, so the shapes passed through while adding properties cost O(1) memory each.
+// All functions are thread safe.
+class DynamicShape
+{
+public:
+	static constexpr std::size_t npos = (std::size_t)-1;
+
+	// The shape without any property.
+	static const DynamicShape * getRoot();
+
+	~DynamicShape();
+
+	DynamicShape(const DynamicShape &) = delete;
+	DynamicShape & operator = (const DynamicShape &) = delete;
+
+	// The id is unique in the program, it's never 0.
+	std::uint32_t getId() const {
+		return id;
+	}
+
+	const DynamicShape * getParent() const {
+		return parent;
+	}
+
+	std::size_t getPropertyCount() const {
+		return propertyCount;
+	}
+
+	const std::string & getPropertyName(const std::size_t slot) const;
+
+	// Returns npos if the property doesn't exist.
+	std::size_t findSlot(const std::string & name) const;
+
+	// Returns the shape which has the properties in this shape and name, name is the last slot.
+	// Returns this if the property exists.
+	const DynamicShape * addProperty(const std::string & name) const;
+	// Returns the shape which has the properties in this shape except name, the slots after name are moved forward by one.
+	// Returns this if the property doesn't exist.
+	const DynamicShape * removeProperty(const std::string & name) const;
+
+private:
+	DynamicShape(const DynamicShape * parent, const std::string & name);
+
+	struct Transition;
+	struct Lookup;
+
+	const Lookup * getLookup() const;
+	bool hasPropertyInChain(const std::string & name) const;
+
+	std::uint32_t id;
+	const DynamicShape * parent;
+	// The property added by this shape, it's in the last slot.
+	std::string name;
+	std::size_t propertyCount;
+	mutable std::atomic<const Lookup *> lookup;
+	std::unique_ptr<Transition> transition;
+};
+
+// DynamicObject is an object whose properties are added at running time. The values are stored in slots
+// indexed by the shape. The object doesn't own the shape.
+class DynamicObject
+{
+public:
+	DynamicObject();
+	// Creates an object which has all properties in shape, the values are empty.
+	explicit DynamicObject(const DynamicShape * shape);
+
+	const DynamicShape * getShape() const {
+		return shape;
+	}
+
+	std::size_t getPropertyCount() const {
+		return slotList.size();
+	}
+
+	bool hasProperty(const std::string & name) const {
+		return shape->findSlot(name) != DynamicShape::npos;
+	}
+
+	// Returns nullptr if the property doesn't exist.
+	const Variant * find(const std::string & name) const;
+	Variant * find(const std::string & name);
+
+	// Returns a reference to the value, or an empty Variant if the property doesn't exist.
+	Variant get(const std::string & name) const;
+	// Adds the property if it doesn't exist.
+	void set(const std::string & name, const Variant & value);
+	// Returns false if the property doesn't exist.
+	bool remove(const std::string & name);
+
+	const Variant & getSlot(const std::size_t slot) const {
+		return slotList[slot];
+	}
+
+	Variant & getSlot(const std::size_t slot) {
+		return slotList[slot];
+	}
+
+private:
+	void transitionTo(const DynamicShape * newShape);
+
+private:
+	const DynamicShape * shape;
+	std::vector<Variant> slotList;
+
+	friend class DynamicPropertyCache;
+};
+
+// DynamicPropertyCache is an inline cache of a property name, it caches the slots of the last several shapes
+// it has seen. If the shape of an object is cached, accessing the property is a shape id comparison and an index.
+// The cache is thread safe, the objects are not.
+class DynamicPropertyCache
+{
+public:
+	explicit DynamicPropertyCache(std::string name);
+
+	DynamicPropertyCache(const DynamicPropertyCache &) = delete;
+	DynamicPropertyCache & operator = (const DynamicPropertyCache &) = delete;
+
+	const std::string & getName() const {
+		return name;
+	}
+
+	// Returns nullptr if the property doesn't exist.
+	const Variant * find(const DynamicObject & object) const {
+		const std::size_t slot = findSlot(object.shape);
+		return slot == DynamicShape::npos ? nullptr : &object.slotList[slot];
+	}
+
+	Variant * find(DynamicObject & object) const {
+		const std::size_t slot = findSlot(object.shape);
+		return slot == DynamicShape::npos ? nullptr : &object.slotList[slot];
+	}
+
+	// Returns a reference to the value, or an empty Variant if the property doesn't exist.
+	Variant get(const DynamicObject & object) const;
+	// Adds the property if it doesn't exist.
+	void set(DynamicObject & object, const Variant & value) const;
+
+private:
+	static constexpr std::size_t entryCount = 4;
+	// An entry is (shape id << 32) | slot, the slot is invalidSlot if the shape doesn't have the property.
+	static constexpr std::uint32_t invalidSlot = 0xffffffffu;
+
+	std::size_t findSlot(const DynamicShape * shape) const {
+		const std::uint64_t id = shape->getId();
+		for(const auto & entry : entryList) {
+			const std::uint64_t value = entry.load(std::memory_order_relaxed);
+			if((value >> 32) == id) {
+				const std::uint32_t slot = (std::uint32_t)value;
+				return slot == invalidSlot ? DynamicShape::npos : (std::size_t)slot;
+			}
+		}
+		return doFindSlot(shape);
+	}
+
+	std::size_t doFindSlot(const DynamicShape * shape) const;
+
+private:
+	std::string name;
+	mutable std::array<std::atomic<std::uint64_t>, entryCount> entryList;
+	mutable std::atomic<std::uint32_t> nextEntry;
+};
+
+// DynamicProperty is the accessible of a DynamicObject property, it implements MetaAccessible so the code
+// using accessibles works on DynamicObject. The instance is a DynamicObject, or a pointer or reference to it.
+// The value type is Variant. Copies of a DynamicProperty share the inline cache.
+class DynamicProperty
+{
+public:
+	explicit DynamicProperty(std::string name);
+
+	const std::string & getName() const {
+		return cache->getName();
+	}
+
+	const DynamicPropertyCache & getCache() const {
+		return *cache;
+	}
+
+private:
+	std::shared_ptr<DynamicPropertyCache> cache;
+};
+
+// DynamicObject implements MetaMappable, the key is the property name (std::string), the value type is Variant.
+// The code which uses std::map<std::string, Variant> through MetaMappable works on DynamicObject.
+template <>
+struct DeclareMetaType <DynamicObject> : DeclareMetaTypeBase <DynamicObject>
+{
+	static const MetaMappable * getMetaMappable();
+};
+
+template <>
+struct DeclareMetaType <DynamicProperty> : DeclareMetaTypeBase <DynamicProperty>
+{
+	static const MetaAccessible * getMetaAccessible();
+};
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,96 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef METAPP_EXPRESSION_H_969872685611
+#define METAPP_EXPRESSION_H_969872685611
+
+#include "metapp/variant.h"
+
+#include <string>
+#include <memory>
+
+namespace metapp {
+
+class MetaType;
+
+namespace internal_ {
+
+class ExpressionImplement;
+
+} // namespace internal_
+
+// Expression evaluates a small expression language against a reflected object, such as
+// `order.items.size() > limit && customer.tier == Tier::Gold`.
+//
+// The expression is compiled once for the root MetaType to register based bytecode.
+// Each member access and call has an inline cache which is resolved when the expression is compiled or first evaluated.
+// Member data are read at the offset in the object, methods are invoked by the resolved callable, and enum values
+// are constants. The values which types are known when compiling (bool, integers, enums, floating points, and std::string)
+// are kept in typed registers, and the arithmetic and comparisons on them don't create any Variant.
+// The values of other types are kept in Variant, the member accesses on them have polymorphic inline caches keyed
+// by the dynamic type, and the operators on them are evaluated the same as interpret.
+//
+// Syntax, from the lowest precedence:
+// `||`, `&&`, `==` `!=`, `<` `<=` `>` `>=`, `+` `-`, `*` `/` `%`, unary `!` `-`, member access `a.b` and call `a.f(x, y)`.
+// An identifier without an object is a member of the root object. `Type::Value` is an enum value, Type is looked up in
+// the types of the root class then in the MetaRepos.
+// The literals are integers (long long), floating points (double), strings in double quotes, `true`, and `false`.
+// `size()` is available on the indexable types, such as std::vector, if they don't have a callable named size.
+//
+// Integers, including enums and unsigned integers, are computed as long long, and wrap around on overflow.
+// Integer division by zero raises IllegalArgumentException. `+` concatenates strings.
+// Accessing a member of a nullptr object raises IllegalArgumentException.
+//
+// The result of evaluate and interpret is bool, long long, double, std::string, or a Variant which refers to the
+// object if the result is an object.
+//
+// Syntax errors and unknown names raise IllegalArgumentException, operators on unsupported types raise UnsupportedException.
+// A compiled expression can be evaluated by several threads at the same time.
+class Expression
+{
+public:
+	Expression(const MetaType * rootMetaType, const std::string & source);
+	~Expression();
+
+	Expression(Expression && other) noexcept;
+	Expression & operator = (Expression && other) noexcept;
+
+	template <typename T>
+	static Expression compile(const std::string & source) {
+		return Expression(getMetaType<T>(), source);
+	}
+
+	const MetaType * getRootMetaType() const;
+	const std::string & getSource() const;
+
+	// root is the object, a reference or a pointer to the object, its type must be the root MetaType.
+	// Runs the compiled bytecode.
+	Variant evaluate(const Variant & root) const;
+	// Evaluates the expression as a condition, integers and floating points are true if they are not zero.
+	// It doesn't box the result in Variant, so it's faster than evaluate for the rules.
+	bool evaluateBool(const Variant & root) const;
+	// Walks the syntax tree, looks up the members by name and invokes with Variant on every node.
+	// It's much slower than evaluate, and gives the same result.
+	Variant interpret(const Variant & root) const;
+
+private:
+	std::unique_ptr<internal_::ExpressionImplement> implement;
+};
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,154 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_MEMORYREPORT_H_969872685611
+#define METAPP_MEMORYREPORT_H_969872685611
+
+#include <array>
+#include <vector>
+#include <set>
+#include <string>
+#include <ostream>
+#include <cstddef>
+
+namespace metapp {
+
+class MetaRepo;
+class MetaClass;
+class MetaEnum;
+
+namespace internal_ {
+class MetaMemoryCounter;
+} // namespace internal_
+
+enum class MemoryKind
+{
+	// The MetaRepo, MetaClass, or MetaEnum object itself, it's usually not on the heap.
+	object,
+	// The item lists (std::deque<MetaItem>) and the blocks holding them.
+	itemList,
+	// The std::map indexes by name, type kind, meta type, or enum value.
+	nameIndex,
+	// The shared data blocks of MetaItem.
+	itemData,
+	// The heap buffers of the item names, short names are stored in the std::string.
+	name,
+	// The annotation maps, including the names and the values.
+	annotation,
+	// The heap storage of the registered Variant, such as accessors. The size of the object is not known, only the
+	// shared block header is counted in bytes.
+	target,
+	// The OverloadedFunction objects and their callable lists.
+	overloadedFunction,
+	// The base and derived classes registered in MetaRepo.
+	inheritance
+};
+
+constexpr std::size_t memoryKindCount = 9;
+
+struct MemoryUsage
+{
+	MemoryUsage() : byteCount(0), allocationCount(0) {
+	}
+
+	MemoryUsage(const std::size_t byteCount, const std::size_t allocationCount)
+		: byteCount(byteCount), allocationCount(allocationCount) {
+	}
+
+	MemoryUsage & operator += (const MemoryUsage & other) {
+		byteCount += other.byteCount;
+		allocationCount += other.allocationCount;
+		return *this;
+	}
+
+	std::size_t byteCount;
+	std::size_t allocationCount;
+};
+
+struct MemoryReportEntry
+{
+	enum class Source
+	{
+		metaRepo,
+		metaClass,
+		metaEnum
+	};
+
+	Source source;
+	std::string name;
+	// The MetaRepo, MetaClass, or MetaEnum.
+	const void * address;
+	std::array<MemoryUsage, memoryKindCount> usageList;
+
+	const MemoryUsage & getUsage(const MemoryKind kind) const {
+		return usageList[(std::size_t)kind];
+	}
+
+	MemoryUsage getTotal() const;
+};
+
+// MemoryReport estimates the memory used by the meta data. The sizes of the standard containers are estimated
+// from the layouts in the common standard libraries (libstdc++, libc++, MSVC), the overhead of the memory allocator
+// is not included. The blocks shared by several items (such as copied MetaItem, or copied MetaRepo) are counted once.
+// The caches built on demand (such as the views and the indexes for queries) are not included.
+// MemoryReport is not thread safe, the meta data must not be modified during adding.
+class MemoryReport
+{
+public:
+	MemoryReport();
+
+	// Adds metaRepo, the MetaClass and MetaEnum of the registered types (named as "name::TypeName"),
+	// and the sub repos (named as "name::subName"), the "name::" is omitted if name is empty.
+	// A MetaClass or MetaEnum which is already added is skipped.
+	void addMetaRepo(const MetaRepo * metaRepo, const std::string & name = std::string());
+	// Adds the items registered in metaClass, not including the base classes.
+	void addMetaClass(const MetaClass * metaClass, const std::string & name);
+	void addMetaEnum(const MetaEnum * metaEnum, const std::string & name);
+	// Adds all MetaRepo in MetaRepoList, the repos are named as "repo#index".
+	void addAllMetaRepos();
+
+	const std::vector<MemoryReportEntry> & getEntryList() const {
+		return entryList;
+	}
+
+	MemoryUsage getTotal() const;
+	MemoryUsage getTotal(const MemoryKind kind) const;
+	MemoryUsage getTotal(const MemoryReportEntry::Source source) const;
+
+	// Writes the totals per kind and per source, then at most maxEntryCount entries, sorted by bytes.
+	// maxEntryCount 0 means all entries.
+	void write(std::ostream & stream, const std::size_t maxEntryCount = 20) const;
+
+private:
+	MemoryReportEntry & doAddEntry(const MemoryReportEntry::Source source, const std::string & name, const void * address);
+
+private:
+	std::vector<MemoryReportEntry> entryList;
+	// The added MetaRepo, MetaClass, and MetaEnum.
+	std::set<const void *> sourceSet;
+	// The shared blocks which are counted.
+	std::set<const void *> visitedSet;
+
+	friend class internal_::MetaMemoryCounter;
+};
+
+const char * getMemoryKindName(const MemoryKind kind);
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,83 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_NAMEINDEX_H_969872685611
+#define METAPP_NAMEINDEX_H_969872685611
+
+#include "metapp/metaitem.h"
+#include "metapp/implement/internal/metaitemindex_i.h"
+
+#include <string>
+#include <memory>
+#include <cstddef>
+
+namespace metapp {
+
+class MetaRepo;
+class MetaClass;
+class MetaEnum;
+
+namespace internal_ {
+
+class NameIndexImplement;
+
+} // namespace internal_
+
+// NameIndex indexes the names of registered items in a trie, for prefix (completion) and fuzzy searching.
+// The sources (MetaRepo, MetaClass, MetaEnum) must outlive the index.
+// NameIndex is not thread safe.
+class NameIndex
+{
+public:
+	NameIndex();
+	~NameIndex();
+
+	NameIndex(const NameIndex &) = delete;
+	NameIndex & operator = (const NameIndex &) = delete;
+
+	// Adds the accessibles, callables, variables, types, and sub repos in metaRepo.
+	// The MetaClass and MetaEnum of the registered types are added too.
+	void addMetaRepo(const MetaRepo * metaRepo);
+	// Adds the items registered in metaClass, not including the base classes.
+	void addMetaClass(const MetaClass * metaClass);
+	void addMetaEnum(const MetaEnum * metaEnum);
+	// Adds the MetaClass and MetaEnum of metaType, if any.
+	void addMetaType(const MetaType * metaType);
+	// Adds a single item. The item must outlive the index.
+	void addItem(const MetaItem & item);
+
+	// Indexes the items registered to the sources since last update.
+	// The find functions call it automatically, it skips the sources which are not changed since last update.
+	void update();
+
+	std::size_t getItemCount() const;
+
+	// Returns the items whose names start with prefix, in the lexicographical order of the names.
+	// limit 0 means no limit.
+	MetaItemPointerList findByPrefix(const std::string & prefix, const std::size_t limit = 0);
+	// Returns the items whose names are within Levenshtein distance maxDistance to name,
+	// sorted by the distance, then by the names.
+	MetaItemPointerList findFuzzy(const std::string & name, const std::size_t maxDistance, const std::size_t limit = 0);
+
+private:
+	std::unique_ptr<internal_::NameIndexImplement> implement;
+};
+
+
+} // namespace metapp
+
+#endif
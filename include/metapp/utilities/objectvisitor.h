@@ -0,0 +1,73 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_OBJECTVISITOR_H_969872685611
+#define METAPP_OBJECTVISITOR_H_969872685611
+
+#include "metapp/variant.h"
+#include "metapp/metaitem.h"
+
+#include <functional>
+#include <memory>
+
+namespace metapp {
+
+class Executor;
+
+namespace internal_ {
+
+class ObjectVisitorImplement;
+
+} // namespace internal_
+
+class ObjectVisitor
+{
+public:
+	struct Node
+	{
+		// Reference to the object, or the value if the object can't be referenced, such as a value returned by an accessor.
+		Variant object;
+		// The accessible item which the object is got from, nullptr if the object is the root, a container element, or a pointee.
+		const MetaItem * accessible;
+		std::size_t depth;
+	};
+
+	// Returns false to skip the children of the node.
+	using Callback = std::function<bool (const Node & node)>;
+
+	ObjectVisitor();
+	~ObjectVisitor();
+
+	ObjectVisitor(const ObjectVisitor &) = delete;
+	ObjectVisitor & operator = (const ObjectVisitor &) = delete;
+
+	// The children of the nodes at maxDepth are not visited. Default is unlimited.
+	ObjectVisitor & setMaxDepth(const std::size_t maxDepth);
+	// If executor is not nullptr, the subgraphs are distributed to the executor, and the callback is invoked concurrently.
+	// Default is nullptr, the graph is visited in the calling thread.
+	ObjectVisitor & setExecutor(Executor * executor);
+
+	void visit(const Variant & root, const Callback & callback);
+
+private:
+	std::unique_ptr<internal_::ObjectVisitorImplement> implement;
+};
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,355 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_PARALLEL_H_969872685611
+#define METAPP_PARALLEL_H_969872685611
+
+#include "metapp/variant.h"
+#include "metapp/interfaces/metaindexable.h"
+#include "metapp/interfaces/metaiterable.h"
+#include "metapp/utilities/threadpool.h"
+#include "metapp/utilities/utility.h"
+#include "metapp/exception.h"
+
+#include <vector>
+#include <type_traits>
+
+namespace metapp {
+
+namespace internal_ {
+
+using ParallelRangeFunc = void (*)(void * context, const std::size_t begin, const std::size_t end);
+
+// Splits [0, count) into chunks of `grain` elements, and runs the chunks on the executor and the calling thread.
+// It returns after all chunks are finished, and rethrows the first exception thrown by `func`.
+void parallelRun(
+	Executor & executor,
+	const std::size_t count,
+	const std::size_t grain,
+	ParallelRangeFunc func,
+	void * context
+);
+
+template <typename F>
+void parallelRunRange(Executor & executor, const std::size_t count, const std::size_t grain, F & func)
+{
+	parallelRun(executor, count, grain, [](void * context, const std::size_t begin, const std::size_t end) {
+		(*static_cast<F *>(context))(begin, end);
+	}, &func);
+}
+
+// Returns nullptr if the container can't be accessed by index efficiently.
+inline const MetaIndexable * getRandomAccessIndexable(const Variant & container, std::size_t * size)
+{
+	const MetaIndexable * metaIndexable = getNonReferenceMetaType(container)->getMetaIndexable();
+	if(metaIndexable != nullptr) {
+		const MetaIndexable::SizeInfo sizeInfo = metaIndexable->getSizeInfo(container);
+		if(sizeInfo.isRandomAccess() && ! sizeInfo.isUnknownSize()) {
+			*size = sizeInfo.getSize();
+			return metaIndexable;
+		}
+	}
+	return nullptr;
+}
+
+inline const MetaIterable * requireIterable(const Variant & container)
+{
+	const MetaIterable * metaIterable = getNonReferenceMetaType(container)->getMetaIterable();
+	if(metaIterable == nullptr) {
+		raiseException<UnsupportedException>("The container is neither random access indexable nor iterable");
+	}
+	return metaIterable;
+}
+
+template <typename T>
+bool isParallelElementType(const MetaType * metaType)
+{
+	return getNonReferenceMetaType(metaType)->equal(getMetaType<typename std::remove_cv<T>::type>());
+}
+
+template <typename T>
+void requireParallelElementType(const MetaType * metaType)
+{
+	if(! isParallelElementType<T>(metaType)) {
+		raiseException<BadCastException>("The element type doesn't match");
+	}
+}
+
+// Calls `callback(T & element, index)` for each element in [begin, end).
+// The element is accessed by raw pointer if the container is contiguous, by MetaIndexable::getElementAddress
+// if the container provides it, such as std::deque, otherwise by MetaIndexable::get, or by the pointers collected by MetaIterable.
+// If MetaIndexable::get returns the element by value, such as a bit packed container, the callback gets a copy.
+template <typename T>
+class TypedElementAccessor
+{
+private:
+	enum class AccessMode
+	{
+		contiguous,
+		elementAddress,
+		indexable,
+		pointerList
+	};
+
+public:
+	explicit TypedElementAccessor(const Variant & container)
+		:
+			container(container),
+			accessMode(AccessMode::indexable),
+			metaIndexable(nullptr),
+			data(nullptr),
+			pointerList(),
+			size(0)
+	{
+		metaIndexable = getRandomAccessIndexable(container, &size);
+		if(metaIndexable != nullptr) {
+			if(size > 0) {
+				requireParallelElementType<T>(metaIndexable->getValueType(container, 0));
+				data = static_cast<T *>(metaIndexable->getData(container));
+				if(data != nullptr) {
+					accessMode = AccessMode::contiguous;
+				}
+				else if(metaIndexable->getElementAddress(container, 0) != nullptr) {
+					accessMode = AccessMode::elementAddress;
+				}
+			}
+		}
+		else {
+			accessMode = AccessMode::pointerList;
+			requireIterable(container)->forEach(container, [this](const Variant & element) -> bool {
+				if(pointerList.empty()) {
+					requireParallelElementType<T>(element.getMetaType());
+				}
+				pointerList.push_back(&element.get<T &>());
+				return true;
+			});
+			size = pointerList.size();
+		}
+	}
+
+	std::size_t getSize() const {
+		return size;
+	}
+
+	template <typename Callback>
+	void forRange(const std::size_t begin, const std::size_t end, Callback && callback) const {
+		switch(accessMode) {
+		case AccessMode::contiguous:
+			for(std::size_t i = begin; i < end; ++i) {
+				callback(data[i], i);
+			}
+			break;
+
+		case AccessMode::elementAddress:
+			for(std::size_t i = begin; i < end; ++i) {
+				callback(*static_cast<T *>(metaIndexable->getElementAddress(container, i)), i);
+			}
+			break;
+
+		case AccessMode::indexable:
+			for(std::size_t i = begin; i < end; ++i) {
+				// Keep the Variant alive during the callback, it holds the element if get returns by value.
+				const Variant element = metaIndexable->get(container, i);
+				callback(element.template get<T &>(), i);
+			}
+			break;
+
+		case AccessMode::pointerList:
+			for(std::size_t i = begin; i < end; ++i) {
+				callback(*pointerList[i], i);
+			}
+			break;
+		}
+	}
+
+private:
+	const Variant & container;
+	AccessMode accessMode;
+	const MetaIndexable * metaIndexable;
+	T * data;
+	std::vector<T *> pointerList;
+	std::size_t size;
+};
+
+inline const MetaIndexable * prepareTransformDestination(const Variant & destination, const std::size_t count)
+{
+	const MetaIndexable * metaIndexable = getNonReferenceMetaType(destination)->getMetaIndexable();
+	if(metaIndexable == nullptr) {
+		raiseException<UnsupportedException>("The destination is not indexable");
+		return nullptr;
+	}
+	MetaIndexable::SizeInfo sizeInfo = metaIndexable->getSizeInfo(destination);
+	if(! sizeInfo.isRandomAccess()) {
+		raiseException<UnsupportedException>("The destination is not random access");
+		return nullptr;
+	}
+	if(sizeInfo.getSize() != count && sizeInfo.isResizable()) {
+		metaIndexable->resize(destination, count);
+		sizeInfo = metaIndexable->getSizeInfo(destination);
+	}
+	if(! sizeInfo.isUnknownSize() && sizeInfo.getSize() < count) {
+		raiseException<OutOfRangeException>();
+		return nullptr;
+	}
+	return metaIndexable;
+}
+
+} // namespace internal_
+
+// `func` is called as func(const Variant & element, const std::size_t index), element is a reference to the element.
+template <typename Func>
+void parallelForEach(
+	const Variant & container,
+	Func && func,
+	const std::size_t grain = 0,
+	Executor & executor = getDefaultThreadPool()
+)
+{
+	std::size_t size = 0;
+	const MetaIndexable * metaIndexable = internal_::getRandomAccessIndexable(container, &size);
+	if(metaIndexable != nullptr) {
+		auto rangeFunc = [metaIndexable, &container, &func](const std::size_t begin, const std::size_t end) {
+			for(std::size_t i = begin; i < end; ++i) {
+				func(metaIndexable->get(container, i), i);
+			}
+		};
+		internal_::parallelRunRange(executor, size, grain, rangeFunc);
+		return;
+	}
+
+	const MetaIterable * metaIterable = internal_::requireIterable(container);
+	if(metaIterable == nullptr) {
+		return;
+	}
+	// Node based containers are iterated sequentially, then the element references are processed in chunks.
+	std::vector<Variant> elementList;
+	metaIterable->forEach(container, [&elementList](const Variant & element) -> bool {
+		elementList.push_back(element);
+		return true;
+	});
+	auto rangeFunc = [&elementList, &func](const std::size_t begin, const std::size_t end) {
+		for(std::size_t i = begin; i < end; ++i) {
+			func(elementList[i], i);
+		}
+	};
+	internal_::parallelRunRange(executor, elementList.size(), grain, rangeFunc);
+}
+
+// `func` is called as func(T & element, const std::size_t index).
+// No Variant is created per element for contiguous containers, or containers that are iterated.
+template <typename T, typename Func>
+void parallelForEachAs(
+	const Variant & container,
+	Func && func,
+	const std::size_t grain = 0,
+	Executor & executor = getDefaultThreadPool()
+)
+{
+	const internal_::TypedElementAccessor<T> accessor(container);
+	auto rangeFunc = [&accessor, &func](const std::size_t begin, const std::size_t end) {
+		accessor.forRange(begin, end, func);
+	};
+	internal_::parallelRunRange(executor, accessor.getSize(), grain, rangeFunc);
+}
+
+// `func` is called as Variant func(const Variant & element, const std::size_t index),
+// the result is set to the element at the same index in destination.
+// destination is resized to the source size if it's resizable.
+// If destination is not contiguous, `func` still runs in parallel, but the results are set on the calling thread.
+template <typename Func>
+void parallelTransform(
+	const Variant & source,
+	const Variant & destination,
+	Func && func,
+	const std::size_t grain = 0,
+	Executor & executor = getDefaultThreadPool()
+)
+{
+	std::size_t size = 0;
+	if(internal_::getRandomAccessIndexable(source, &size) == nullptr) {
+		internal_::requireIterable(source)->forEach(source, [&size](const Variant &) -> bool {
+			++size;
+			return true;
+		});
+	}
+	const MetaIndexable * destinationIndexable = internal_::prepareTransformDestination(destination, size);
+	if(destinationIndexable == nullptr) {
+		return;
+	}
+	if(destinationIndexable->getData(destination) != nullptr) {
+		parallelForEach(source, [destinationIndexable, &destination, &func](const Variant & element, const std::size_t index) {
+			destinationIndexable->set(destination, index, func(element, index));
+		}, grain, executor);
+		return;
+	}
+	// Writing the elements of a non contiguous container, such as a bit packed container, from several threads
+	// may be a data race, so the results are set on the calling thread.
+	std::vector<Variant> resultList(size);
+	parallelForEach(source, [&resultList, &func](const Variant & element, const std::size_t index) {
+		resultList[index] = func(element, index);
+	}, grain, executor);
+	for(std::size_t i = 0; i < size; ++i) {
+		destinationIndexable->set(destination, i, resultList[i]);
+	}
+}
+
+// `func` is called as To func(From & element, const std::size_t index).
+template <typename From, typename To, typename Func>
+void parallelTransformAs(
+	const Variant & source,
+	const Variant & destination,
+	Func && func,
+	const std::size_t grain = 0,
+	Executor & executor = getDefaultThreadPool()
+)
+{
+	const internal_::TypedElementAccessor<From> accessor(source);
+	const std::size_t size = accessor.getSize();
+	const MetaIndexable * destinationIndexable = internal_::prepareTransformDestination(destination, size);
+	if(destinationIndexable == nullptr || size == 0) {
+		return;
+	}
+	To * data = nullptr;
+	if(internal_::isParallelElementType<To>(destinationIndexable->getValueType(destination, 0))) {
+		data = static_cast<To *>(destinationIndexable->getData(destination));
+	}
+	if(data != nullptr) {
+		auto rangeFunc = [&accessor, data, &func](const std::size_t begin, const std::size_t end) {
+			accessor.forRange(begin, end, [data, &func](From & element, const std::size_t index) {
+				data[index] = func(element, index);
+			});
+		};
+		internal_::parallelRunRange(executor, size, grain, rangeFunc);
+		return;
+	}
+	// The destination is set on the calling thread, the same as parallelTransform.
+	std::vector<Variant> resultList(size);
+	auto rangeFunc = [&accessor, &resultList, &func](const std::size_t begin, const std::size_t end) {
+		accessor.forRange(begin, end, [&resultList, &func](From & element, const std::size_t index) {
+			resultList[index] = Variant(func(element, index));
+		});
+	};
+	internal_::parallelRunRange(executor, size, grain, rangeFunc);
+	for(std::size_t i = 0; i < size; ++i) {
+		destinationIndexable->set(destination, i, resultList[i]);
+	}
+}
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,159 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_PROFILER_H_969872685611
+#define METAPP_PROFILER_H_969872685611
+
+#include "metapp/implement/internal/profiler_i.h"
+
+#include <array>
+#include <functional>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+namespace metapp {
+
+class Variant;
+class MetaType;
+class MetaItem;
+class MetaClass;
+class MetaRepo;
+
+// Identifies a callable or accessible. It's the meta type and the target of the Variant which holds the callable or accessible.
+// The target is the small value stored in the Variant, such as a function pointer or a member data pointer,
+// or the address of the object which the Variant stores on the heap or refers to.
+// So the copies of a Variant have the same key.
+struct ProfileKey
+{
+	const MetaType * metaType;
+	std::array<std::uint64_t, 2> target;
+};
+
+inline bool operator == (const ProfileKey & a, const ProfileKey & b)
+{
+	return a.metaType == b.metaType && a.target == b.target;
+}
+
+inline bool operator != (const ProfileKey & a, const ProfileKey & b)
+{
+	return ! (a == b);
+}
+
+inline bool operator < (const ProfileKey & a, const ProfileKey & b)
+{
+	if(a.metaType != b.metaType) {
+		return std::less<const MetaType *>()(a.metaType, b.metaType);
+	}
+	return a.target < b.target;
+}
+
+// Latency histogram of one phase of one item, the values are in nanoseconds.
+// The buckets are log-linear (HDR style), the relative error of the percentiles is within 1/16.
+class ProfileHistogram
+{
+public:
+	ProfileHistogram();
+	ProfileHistogram(
+		std::vector<std::uint64_t> bucketList,
+		const std::uint64_t totalTicks,
+		const std::uint64_t maxTicks,
+		const double nanosecondsPerTick
+	);
+
+	std::uint64_t getCount() const {
+		return count;
+	}
+
+	double getTotal() const;
+	double getMean() const;
+	double getMax() const;
+	// percentile is in [0, 100].
+	double getPercentile(const double percentile) const;
+
+private:
+	std::vector<std::uint64_t> bucketList;
+	std::uint64_t count;
+	std::uint64_t totalTicks;
+	std::uint64_t maxTicks;
+	double nanosecondsPerTick;
+};
+
+struct ProfileRecord
+{
+	ProfileKey key;
+	// The name given by Profiler::setName or Profiler::addMetaXxx, or found in the MetaRepos when the record is read,
+	// or the target address if there is no name.
+	std::string name;
+	std::array<ProfileHistogram, profilePhaseCount> histogramList;
+
+	const ProfileHistogram & getHistogram(const ProfilePhase phase) const {
+		return histogramList[(std::size_t)phase];
+	}
+};
+
+// Profiler records the latency of callableInvoke, findCallable, accessibleGet, and accessibleSet per item and phase,
+// and exports Chrome trace (Perfetto compatible) JSON.
+// The hooks are only compiled if METAPP_ENABLE_PROFILING is defined, it must be defined for all translation units
+// (the CMake option METAPP_ENABLE_PROFILING does it). Without the macro, the functions here work but nothing is recorded.
+// All functions are thread safe.
+class Profiler
+{
+public:
+	static void enable();
+	static void disable();
+	static bool isEnabled();
+	// Clears all histograms, the names are kept.
+	static void reset();
+
+	// The items are identified by the key of the Variant which holds the callable or accessible,
+	// so the name applies to all copies of item.
+	static ProfileKey getKey(const Variant & item);
+	static void setName(const Variant & item, const std::string & name);
+	// Names the callable or accessible in item, the overloads in an OverloadedFunction are named as name#index.
+	static void addMetaItem(const MetaItem & item, const std::string & prefix = std::string());
+	// Names the callables and accessibles registered in metaClass, not including the base classes.
+	static void addMetaClass(const MetaClass * metaClass, const std::string & prefix = std::string());
+	// Names the callables and accessibles in metaRepo, the MetaClass of the registered types, and the sub repos.
+	static void addMetaRepo(const MetaRepo * metaRepo);
+
+	// The items which have any samples, sorted by name.
+	// The items without a name given by setName or addMetaXxx are named from the MetaRepos which exist when the function is called.
+	static std::vector<ProfileRecord> getRecordList();
+	// Writes a text table of the count, mean, percentiles, and max for each item and phase.
+	static void writeReport(std::ostream & stream);
+	// The number of samples not recorded because there are too many items.
+	static std::uint64_t getDroppedSampleCount();
+
+	// Starts recording trace events, at most maxEventCount events are kept, the later events are dropped.
+	// Starting a trace discards the previous trace.
+	static void startTrace(const std::size_t maxEventCount = 100000);
+	static void stopTrace();
+	static bool isTracing();
+	static std::size_t getTraceEventCount();
+	// Writes the trace events in Chrome trace event format, which can be opened in chrome://tracing or Perfetto.
+	static void writeTrace(std::ostream & stream);
+	// Returns false if the file can't be written.
+	static bool writeTrace(const std::string & fileName);
+};
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,103 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_QUERY_H_969872685611
+#define METAPP_QUERY_H_969872685611
+
+#include "metapp/variant.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+
+namespace metapp {
+
+class MetaType;
+class Executor;
+
+namespace internal_ {
+
+class QueryImplement;
+
+} // namespace internal_
+
+enum class QueryOperator
+{
+	equal,
+	notEqual,
+	less,
+	lessEqual,
+	greater,
+	greaterEqual
+};
+
+struct QueryGroup
+{
+	// A copy of the property value of the first element in the group, empty for the group of the null elements.
+	Variant key;
+	// The indexes of the elements in the container.
+	std::vector<std::size_t> indexList;
+};
+
+// Query filters, sorts, and groups the elements in a container by the properties (accessibles) in the MetaClass
+// of the element type. The properties are resolved once when the query is built. When the query is executed,
+// each property used by the query is read once per element into a typed column, then the filtering and sorting
+// work on the columns. Member data are read from the object at the offset of the member, without Variant.
+// The supported property types are arithmetic types, enums, and std::string.
+// The null pointer elements don't match any condition, and are placed first when sorting and grouping.
+// Query is not thread safe, but a built query can be executed by several threads at the same time.
+class Query
+{
+public:
+	// classMetaType is the element type of the containers, the containers can also contain pointers to the class.
+	explicit Query(const MetaType * classMetaType);
+	~Query();
+
+	Query(Query && other) noexcept;
+	Query & operator = (Query && other) noexcept;
+
+	template <typename T>
+	static Query from() {
+		return Query(getMetaType<T>());
+	}
+
+	// The elements which match all where conditions are kept.
+	// value is cast to the property type domain (long long, unsigned long long, double, or std::string) once.
+	// long double properties are compared as double.
+	Query & where(const std::string & propertyName, const QueryOperator op, const Variant & value);
+	// Sorts by the property, the first orderBy is the primary key. The sorting is stable.
+	Query & orderBy(const std::string & propertyName, const bool descending = false);
+	// The columns are extracted and filtered on executor. nullptr, the default, runs on the calling thread.
+	Query & setExecutor(Executor * executor);
+
+	// Returns the indexes of the matched elements in the container, in the sorted order.
+	std::vector<std::size_t> execute(const Variant & container) const;
+	// Returns the number of the matched elements.
+	std::size_t count(const Variant & container) const;
+	// Groups the matched elements by the property, the groups are sorted by the property value,
+	// the elements in each group are in the sorted order.
+	std::vector<QueryGroup> group(const Variant & container, const std::string & propertyName) const;
+
+private:
+	std::unique_ptr<internal_::QueryImplement> implement;
+};
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,83 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_REGISTRATIONTABLE_H_969872685611
+#define METAPP_REGISTRATIONTABLE_H_969872685611
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace metapp {
+
+// An entry in the static tables emitted by tools/genregistration.py.
+// For a field, value is the offset of the field in the class.
+// For a callable, value is the number of overloads.
+struct RegistrationEntry
+{
+	const char * name;
+	std::uint32_t nameHash;
+	std::size_t value;
+};
+
+// 32 bit FNV-1a. tools/genregistration.py computes the same hash offline.
+constexpr std::uint32_t hashRegistrationName(const char * name, const std::uint32_t hash = 2166136261u)
+{
+	return *name == 0 ? hash : hashRegistrationName(name + 1, (hash ^ (std::uint32_t)(unsigned char)*name) * 16777619u);
+}
+
+// The entries in [first, last) must be sorted by nameHash, the generator emits them sorted.
+// Returns nullptr if name is not found.
+inline const RegistrationEntry * findRegistrationEntry(
+	const RegistrationEntry * first,
+	const RegistrationEntry * last,
+	const char * name
+)
+{
+	const std::uint32_t nameHash = hashRegistrationName(name);
+	auto it = std::lower_bound(first, last, nameHash, [](const RegistrationEntry & entry, const std::uint32_t hash) {
+		return entry.nameHash < hash;
+	});
+	for(; it != last && it->nameHash == nameHash; ++it) {
+		if(std::strcmp(it->name, name) == 0) {
+			return it;
+		}
+	}
+	return nullptr;
+}
+
+struct RegistrationTable
+{
+	const RegistrationEntry * fields;
+	std::size_t fieldCount;
+	const RegistrationEntry * callables;
+	std::size_t callableCount;
+
+	const RegistrationEntry * findField(const char * name) const {
+		return findRegistrationEntry(fields, fields + fieldCount, name);
+	}
+
+	const RegistrationEntry * findCallable(const char * name) const {
+		return findRegistrationEntry(callables, callables + callableCount, name);
+	}
+};
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,216 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef METAPP_RPCDISPATCHER_H_969872685611
+#define METAPP_RPCDISPATCHER_H_969872685611
+
+#include "metapp/variant.h"
+#include "metapp/exception.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+namespace metapp {
+
+class MetaRepo;
+
+namespace internal_ {
+
+class RpcDispatcherImplement;
+
+} // namespace internal_
+
+// The binary encoding used by RpcDispatcher.
+// The values are in the native byte order and sizes, the client and the server must run on machines with the same
+// byte order and the same sizes of the arithmetic types.
+// Arithmetic values are written as their bytes, enums are written as the underlying type,
+// strings are a 32 bit length followed by the characters, without the null terminator.
+//
+// A request is the 32 bit method ID followed by the arguments.
+// A response is one byte of ErrorCode, followed by the result if the ErrorCode is ok and the method doesn't return void.
+
+constexpr std::uint32_t invalidRpcMethodId = 0xffffffffu;
+
+class RpcWriter
+{
+public:
+	explicit RpcWriter(std::vector<char> & buffer)
+		: buffer(buffer)
+	{
+	}
+
+	template <typename T>
+	void write(const T & value) {
+		static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "RpcWriter only writes arithmetic, enum, and strings");
+		writeBytes(&value, sizeof(T));
+	}
+
+	void write(const std::string & value) {
+		doWriteString(value.data(), value.size());
+	}
+
+	void write(const char * value) {
+		doWriteString(value, std::strlen(value));
+	}
+
+	void writeBytes(const void * data, const std::size_t size) {
+		const char * p = static_cast<const char *>(data);
+		buffer.insert(buffer.end(), p, p + size);
+	}
+
+private:
+	void doWriteString(const char * s, const std::size_t length) {
+		const std::uint32_t size = (std::uint32_t)length;
+		writeBytes(&size, sizeof(size));
+		writeBytes(s, length);
+	}
+
+private:
+	std::vector<char> & buffer;
+};
+
+// The read functions return false if there are not enough bytes, and the value is not changed.
+class RpcReader
+{
+public:
+	RpcReader(const void * data, const std::size_t size)
+		: data(static_cast<const char *>(data)), size(size), position(0)
+	{
+	}
+
+	template <typename T>
+	bool read(T * value) {
+		static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "RpcReader only reads arithmetic, enum, and strings");
+		return readBytes(value, sizeof(T));
+	}
+
+	bool read(std::string * value) {
+		std::uint32_t length;
+		if(! readBytes(&length, sizeof(length)) || getRemainingSize() < length) {
+			return false;
+		}
+		value->assign(data + position, length);
+		position += length;
+		return true;
+	}
+
+	bool readBytes(void * buffer, const std::size_t count) {
+		if(getRemainingSize() < count) {
+			return false;
+		}
+		std::memcpy(buffer, data + position, count);
+		position += count;
+		return true;
+	}
+
+	std::size_t getRemainingSize() const {
+		return size - position;
+	}
+
+private:
+	const char * data;
+	std::size_t size;
+	std::size_t position;
+};
+
+// Appends a request to buffer.
+template <typename ...Args>
+void writeRpcRequest(std::vector<char> & buffer, const std::uint32_t methodId, const Args & ... args)
+{
+	RpcWriter writer(buffer);
+	writer.write(methodId);
+	// Expand the arguments in order.
+	int dummy[] = { 0, (writer.write(args), 0)... };
+	(void)dummy;
+}
+
+// Reads the ErrorCode in the response, and the result to *result if the ErrorCode is ok.
+// Returns ErrorCode::illegalArgument if the response is truncated.
+template <typename T>
+ErrorCode readRpcResponse(const void * response, const std::size_t size, T * result)
+{
+	RpcReader reader(response, size);
+	std::uint8_t code;
+	if(! reader.read(&code)) {
+		return ErrorCode::illegalArgument;
+	}
+	if((ErrorCode)code != ErrorCode::ok) {
+		return (ErrorCode)code;
+	}
+	if(! reader.read(result)) {
+		return ErrorCode::illegalArgument;
+	}
+	return ErrorCode::ok;
+}
+
+// For the methods which return void.
+ErrorCode readRpcResponse(const void * response, const std::size_t size);
+
+// RpcDispatcher assigns integer IDs to the callables in a MetaRepo, decodes the requests, invokes the callables,
+// and encodes the results.
+// The IDs are assigned in the registration order of the callables, each overload of an overloaded callable
+// has its own ID. So the IDs are stable as long as the callables are registered in the same order.
+// getFingerprint can be used to check whether the client and the server have the same methods.
+// For each method, the decoders of the parameters and the encoder of the result are planned when the dispatcher is created.
+// The arguments are decoded to the slots which have the parameter types, and are passed to MetaCallable::invokeRef
+// without any Variant or overload ranking.
+//
+// The supported parameter types are arithmetic types, enums, and std::string, they can be passed by value or by reference.
+// The supported result types are the same, plus const char *, and void.
+// The methods with other types still have IDs, dispatching them responds ErrorCode::unsupported.
+// The callables are non-member functions or static member functions, the dispatcher doesn't have any instance.
+//
+// The MetaRepo must outlive the dispatcher. dispatch is thread safe.
+class RpcDispatcher
+{
+public:
+	explicit RpcDispatcher(const MetaRepo * metaRepo);
+	~RpcDispatcher();
+
+	RpcDispatcher(const RpcDispatcher &) = delete;
+	RpcDispatcher & operator = (const RpcDispatcher &) = delete;
+
+	std::size_t getMethodCount() const;
+
+	// overloadIndex is the index of the overload in the registration order.
+	// Returns invalidRpcMethodId if the method is not found.
+	std::uint32_t findMethodId(const std::string & name, const std::size_t overloadIndex = 0) const;
+	const std::string & getMethodName(const std::uint32_t methodId) const;
+	const Variant & getMethod(const std::uint32_t methodId) const;
+	bool isMethodSupported(const std::uint32_t methodId) const;
+
+	// A hash of the names and the signatures of all methods in the ID order.
+	std::uint64_t getFingerprint() const;
+
+	// Decodes the request, invokes the method, and appends the response to response.
+	// Returns the ErrorCode in the response.
+	// ErrorCode::outOfRange if the method ID is unknown, ErrorCode::illegalArgument if the arguments are truncated
+	// or have extra bytes, ErrorCode::unsupported if the signature is not supported.
+	ErrorCode dispatch(const void * request, const std::size_t requestSize, std::vector<char> & response) const;
+
+private:
+	std::unique_ptr<internal_::RpcDispatcherImplement> implement;
+};
+
+
+} // namespace metapp
+
+#endif
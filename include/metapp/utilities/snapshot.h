@@ -0,0 +1,180 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_SNAPSHOT_H_969872685611
+#define METAPP_SNAPSHOT_H_969872685611
+
+#include "metapp/variant.h"
+#include "metapp/metatype.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace metapp {
+
+class MetaIndexable;
+class MetaMappable;
+
+namespace internal_ {
+
+struct SnapshotSchemaData;
+class SnapshotMapping;
+
+} // namespace internal_
+
+// A snapshot is a position independent binary image of a reflected object graph.
+// The image starts with a header, then the values, then the schema table. The references to the strings,
+// the arrays, and the schemas are offsets, so the image can be mapped at any address and shared by processes.
+// The values are in the native byte order and alignment, the arithmetic values are read in place.
+//
+// The supported value types are,
+// arithmetic types and enums, which are written as the underlying type,
+// std::string and const char *,
+// classes with MetaClass, the non static accessibles, including the accessibles in the base classes, are written as fields,
+// containers with MetaIndexable or MetaIterable which have one up type, they are written as arrays.
+// Other types, including the pointers to objects, raise UnsupportedException.
+
+// Writes the image of root to a byte vector.
+std::vector<char> createSnapshot(const Variant & root);
+// Writes the image of root to the file. Raises IllegalArgumentException if the file can't be written.
+void writeSnapshotFile(const std::string & fileName, const Variant & root);
+
+// The fingerprint of the schema of the type. It's the same for the same type layout in all programs,
+// it changes if the name, order, or type of any field changes.
+std::uint64_t getSnapshotFingerprint(const MetaType * metaType);
+
+// A read only view of an array in a snapshot.
+// It implements MetaIndexable, the elements are the same as get.
+class SnapshotArray
+{
+public:
+	SnapshotArray();
+
+	std::size_t getSize() const;
+
+	// Arithmetic elements are const references into the image, strings are const char *,
+	// objects are SnapshotObject, arrays are SnapshotArray.
+	// Raises OutOfRangeException if index is out of range, and IllegalArgumentException if the string or array
+	// referred by the element is out of the image, which means the image is corrupt.
+	Variant get(const std::size_t index) const;
+
+	// The element data if the elements are arithmetic, otherwise nullptr.
+	const void * getData() const;
+	// The element type if the elements are arithmetic, otherwise nullptr.
+	const MetaType * getElementMetaType() const;
+
+private:
+	SnapshotArray(const char * image, const char * data, const std::size_t size, const internal_::SnapshotSchemaData * elementSchema);
+
+private:
+	// The start of the image, the references are checked against the image size in the header.
+	const char * image;
+	const char * data;
+	std::size_t size;
+	const internal_::SnapshotSchemaData * elementSchema;
+
+	friend class SnapshotObject;
+	friend class Snapshot;
+	friend struct internal_::SnapshotSchemaData;
+};
+
+// A read only view of an object in a snapshot.
+// It implements MetaMappable, the key is the field name, the value is the same as get.
+class SnapshotObject
+{
+public:
+	SnapshotObject();
+
+	std::size_t getFieldCount() const;
+	std::string getFieldName(const std::size_t index) const;
+	bool hasField(const std::string & name) const;
+
+	// Returns an empty Variant if the field doesn't exist. The values are the same as SnapshotArray::get.
+	Variant get(const std::string & name) const;
+	// Raises OutOfRangeException if index is out of range.
+	Variant get(const std::size_t index) const;
+
+private:
+	SnapshotObject(const char * image, const char * data, const internal_::SnapshotSchemaData * schema);
+
+private:
+	const char * image;
+	const char * data;
+	const internal_::SnapshotSchemaData * schema;
+
+	friend class SnapshotArray;
+	friend class Snapshot;
+	friend struct internal_::SnapshotSchemaData;
+};
+
+// Snapshot maps a snapshot image and gives the views of the values without deserialization.
+// The views point into the image, they must not be used after the Snapshot is destroyed.
+class Snapshot
+{
+public:
+	// Maps the file read only. Raises IllegalArgumentException if the file can't be mapped or is not a valid snapshot.
+	static Snapshot fromFile(const std::string & fileName);
+	// Uses the image in memory, it's not copied, and it must be alive while the Snapshot and the views are used.
+	// data must be aligned to 8 bytes. Raises IllegalArgumentException if it's not a valid snapshot.
+	static Snapshot fromMemory(const void * data, const std::size_t size);
+
+	Snapshot();
+	~Snapshot();
+
+	Snapshot(Snapshot && other) noexcept;
+	Snapshot & operator = (Snapshot && other) noexcept;
+
+	bool isValid() const;
+
+	// The root value, the same kinds as SnapshotArray::get.
+	Variant getRoot() const;
+
+	std::size_t getSchemaCount() const;
+	std::uint64_t getSchemaFingerprint(const std::size_t index) const;
+	std::uint64_t getRootFingerprint() const;
+
+	// Returns true if the root was written from type T with the same layout as T in this program.
+	template <typename T>
+	bool matches() const {
+		return isValid() && getRootFingerprint() == getSnapshotFingerprint(getMetaType<T>());
+	}
+
+private:
+	std::unique_ptr<internal_::SnapshotMapping> mapping;
+	const char * image;
+	std::size_t imageSize;
+};
+
+template <>
+struct DeclareMetaType <SnapshotArray> : DeclareMetaTypeBase <SnapshotArray>
+{
+	static const MetaIndexable * getMetaIndexable();
+};
+
+template <>
+struct DeclareMetaType <SnapshotObject> : DeclareMetaTypeBase <SnapshotObject>
+{
+	static const MetaMappable * getMetaMappable();
+};
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,293 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_STATICMEMBERS_H_969872685611
+#define METAPP_STATICMEMBERS_H_969872685611
+
+#include "metapp/metatype.h"
+#include "metapp/variant.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/metarepo.h"
+#include "metapp/implement/internal/util_i.h"
+
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+
+namespace metapp {
+
+// StaticMember describes a data member at compile time, the name and the member pointer.
+template <typename C, typename T>
+struct StaticMember
+{
+	using ClassType = C;
+	using ValueType = T;
+
+	constexpr StaticMember(const char * name, T C::* pointer)
+		: name(name), pointer(pointer)
+	{
+	}
+
+	T & get(C & instance) const {
+		return instance.*pointer;
+	}
+
+	const T & get(const C & instance) const {
+		return instance.*pointer;
+	}
+
+	const char * name;
+	T C::* pointer;
+};
+
+template <typename C, typename T>
+constexpr StaticMember<C, T> staticMember(const char * name, T C::* pointer)
+{
+	return StaticMember<C, T>(name, pointer);
+}
+
+// StaticMemberList is a constexpr tuple of StaticMember.
+// forEach is expanded at compile time, the compiler can inline the code for each member.
+template <typename ...Members>
+class StaticMemberList;
+
+template <>
+class StaticMemberList <>
+{
+public:
+	constexpr StaticMemberList() {}
+
+	static constexpr std::size_t getSize() {
+		return 0;
+	}
+
+	template <typename Func>
+	void forEach(Func && /*func*/) const {
+	}
+};
+
+template <typename First, typename ...Rest>
+class StaticMemberList <First, Rest...>
+{
+public:
+	constexpr StaticMemberList(const First & first, const Rest & ... rest)
+		: first(first), rest(rest...)
+	{
+	}
+
+	static constexpr std::size_t getSize() {
+		return sizeof...(Rest) + 1;
+	}
+
+	constexpr const First & getFirst() const {
+		return first;
+	}
+
+	constexpr const StaticMemberList<Rest...> & getRest() const {
+		return rest;
+	}
+
+	template <typename Func>
+	void forEach(Func && func) const {
+		func(first);
+		rest.forEach(func);
+	}
+
+private:
+	First first;
+	StaticMemberList<Rest...> rest;
+};
+
+template <typename ...Members>
+constexpr StaticMemberList<Members...> makeStaticMemberList(const Members & ... members)
+{
+	return StaticMemberList<Members...>(members...);
+}
+
+namespace internal_ {
+
+template <typename T>
+struct HasStaticMembers
+{
+private:
+	template <typename C> static std::true_type test(decltype(DeclareMetaType<C>::getStaticMembers()) *);
+	template <typename C> static std::false_type test(...);
+
+public:
+	static constexpr bool value = decltype(test<T>(nullptr))::value;
+};
+
+template <typename T, typename Func>
+struct StaticMemberInstanceCaller
+{
+	T & instance;
+	Func & func;
+
+	template <typename Member>
+	void operator() (const Member & member) const {
+		func(member.name, member.get(instance));
+	}
+};
+
+struct StaticMemberRegister
+{
+	MetaClass & metaClass;
+
+	template <typename Member>
+	void operator() (const Member & member) const {
+		// Pass a non-const copy, a const member pointer would be registered as read only.
+		auto pointer = member.pointer;
+		metaClass.registerAccessible(member.name, pointer);
+	}
+};
+
+// Returns true if T has base classes registered in any MetaRepo.
+// The result is cached until the class hierarchy changes, the generation and the result are packed
+// in one atomic so they are always consistent, so the static path doesn't pay for the hierarchy lookup.
+template <typename T>
+bool hasRegisteredBases()
+{
+	static std::atomic<std::uint64_t> cachedState(0);
+	const std::uint64_t generation = getInheritanceGeneration();
+	const std::uint64_t state = cachedState.load(std::memory_order_acquire);
+	if((state & 2) != 0 && (state >> 2) == generation) {
+		return (state & 1) != 0;
+	}
+	const MetaType * metaType = getMetaType<T>();
+	int classCount = 0;
+	getMetaRepoList()->traverseBases(metaType, [&classCount](const MetaType *) -> bool {
+		++classCount;
+		return classCount < 2;
+	});
+	const bool result = classCount > 1;
+	// Bit 0 is the result, bit 1 marks the state is set, as generation 0 is valid.
+	cachedState.store((generation << 2) | 2 | (result ? 1 : 0), std::memory_order_release);
+	return result;
+}
+
+// The base classes are only known at runtime, by MetaRepo::registerBase, so the members of the base classes
+// are visited through the MetaClass of T. The merged view lists the own accessibles first, they are skipped.
+template <typename T, typename Func>
+void doForEachBaseMember(T & instance, Func & func)
+{
+	using U = typename std::remove_cv<T>::type;
+	if(! hasRegisteredBases<U>()) {
+		return;
+	}
+	const MetaClass * metaClass = getMetaType<U>()->getMetaClass();
+	if(metaClass == nullptr) {
+		return;
+	}
+	const std::size_t ownCount = metaClass->getAccessibleView(MetaClass::flagNone).size();
+	const MetaItemView view = metaClass->getAccessibleView();
+	if(view.size() <= ownCount) {
+		return;
+	}
+	const Variant pointer(&instance);
+	for(std::size_t i = ownCount; i < view.size(); ++i) {
+		const MetaItem & item = view[i];
+		func(item.getName().c_str(), accessibleGet(item.asAccessible(), pointer));
+	}
+}
+
+template <typename T, typename Func>
+void doForEachMember(T & instance, Func & func, std::true_type)
+{
+	using U = typename std::remove_cv<T>::type;
+	DeclareMetaType<U>::getStaticMembers().forEach(StaticMemberInstanceCaller<T, Func> { instance, func });
+	doForEachBaseMember(instance, func);
+}
+
+template <typename T, typename Func>
+void doForEachMember(T & instance, Func & func, std::false_type)
+{
+	const MetaClass * metaClass = getMetaType<T>()->getMetaClass();
+	if(metaClass == nullptr) {
+		return;
+	}
+	const Variant pointer(&instance);
+	for(const MetaItem & item : metaClass->getAccessibleView()) {
+		func(item.getName().c_str(), accessibleGet(item.asAccessible(), pointer));
+	}
+}
+
+} // namespace internal_
+
+// True if DeclareMetaType<T> has function getStaticMembers() which returns a StaticMemberList.
+template <typename T>
+struct HasStaticMembers : std::integral_constant<bool, internal_::HasStaticMembers<typename std::remove_cv<T>::type>::value>
+{
+};
+
+template <typename T>
+constexpr auto getStaticMembers() -> decltype(DeclareMetaType<typename std::remove_cv<T>::type>::getStaticMembers())
+{
+	return DeclareMetaType<typename std::remove_cv<T>::type>::getStaticMembers();
+}
+
+// Calls func(const char * name, V & value) for each static member of T, V is the member type.
+// Only the members declared in getStaticMembers of T are visited, the base classes are not.
+template <typename T, typename Func>
+void forEachStaticMember(T & instance, Func && func)
+{
+	static_assert(HasStaticMembers<T>::value, "forEachStaticMember requires DeclareMetaType<T>::getStaticMembers");
+	using U = typename std::remove_cv<T>::type;
+	DeclareMetaType<U>::getStaticMembers().forEach(internal_::StaticMemberInstanceCaller<T, Func> { instance, func });
+}
+
+// Visits the members of T and its base classes, the members of T first, then the members of the base classes
+// in the order of MetaClass::getAccessibleView.
+// If T has static members, calls func(const char * name, V & value) for each static member of T.
+// Otherwise calls func(const char * name, const Variant & value) for each accessible in the MetaClass of T.
+// The base classes registered by MetaRepo::registerBase are visited through the MetaClass of T in both cases,
+// func is called with the Variant form for them.
+// func is usually a generic lambda or a functor which can accept both forms.
+template <typename T, typename Func>
+void forEachMember(T & instance, Func && func)
+{
+	internal_::doForEachMember(instance, func, HasStaticMembers<T>());
+}
+
+// Registers each static member as an accessible in metaClass.
+template <typename ...Members>
+void registerStaticMembers(MetaClass & metaClass, const StaticMemberList<Members...> & memberList)
+{
+	memberList.forEach(internal_::StaticMemberRegister { metaClass });
+}
+
+// Returns a MetaClass which accessibles are generated from the static members of T.
+// It's intended to be returned by DeclareMetaType<T>::getMetaClass, so the runtime and static reflection
+// come from the same declaration.
+template <typename T>
+const MetaClass * getMetaClassFromStaticMembers()
+{
+	static const MetaClass metaClass(
+		getMetaType<T>(),
+		[](MetaClass & mc) {
+			registerStaticMembers(mc, getStaticMembers<T>());
+		}
+	);
+	return &metaClass;
+}
+
+
+} // namespace metapp
+
+#endif
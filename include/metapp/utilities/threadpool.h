@@ -0,0 +1,99 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef METAPP_THREADPOOL_H_969872685611
+#define METAPP_THREADPOOL_H_969872685611
+
+#include <cstddef>
+#include <memory>
+#include <functional>
+#include <exception>
+
+namespace metapp {
+
+// ExecutorTask is an intrusive task node, an executor never allocates memory to queue a task.
+// `previous` and `next` are owned by the executor while the task is queued.
+struct ExecutorTask
+{
+	explicit ExecutorTask(void (*run)(ExecutorTask * task) = nullptr)
+		: run(run), previous(nullptr), next(nullptr)
+	{
+	}
+
+	void (*run)(ExecutorTask * task);
+	ExecutorTask * previous;
+	ExecutorTask * next;
+};
+
+class Executor
+{
+public:
+	virtual ~Executor() = default;
+
+	virtual void execute(ExecutorTask * task) = 0;
+	virtual void executeBatch(ExecutorTask * const * tasks, const std::size_t count);
+	// The number of tasks the executor can run at the same time
+	virtual std::size_t getConcurrency() const;
+};
+
+namespace internal_ {
+
+class ThreadPoolImplement;
+
+// If the current thread is a ThreadPool worker, runs one pending task of the pool and returns true.
+// It's used to keep the worker busy when a task waits for another task, to avoid dead lock.
+bool runPendingTaskInCurrentWorker();
+
+} // namespace internal_
+
+class ThreadPool : public Executor
+{
+public:
+	// threadCount 0 means std::thread::hardware_concurrency()
+	explicit ThreadPool(const std::size_t threadCount = 0);
+	// The destructor runs all pending tasks then joins the threads.
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool & operator = (const ThreadPool &) = delete;
+
+	std::size_t getThreadCount() const;
+
+	using TaskExceptionHandler = std::function<void (std::exception_ptr)>;
+
+	// An exception thrown by a task doesn't stop the worker thread. It's passed to the task exception handler,
+	// or if there is no handler, it's kept and can be retrieved by takeTaskException.
+	void execute(ExecutorTask * task) override;
+	void executeBatch(ExecutorTask * const * tasks, const std::size_t count) override;
+	std::size_t getConcurrency() const override;
+
+	// The handler is called in the worker thread which ran the task.
+	void setTaskExceptionHandler(TaskExceptionHandler handler);
+	// Returns the first exception kept since the last call, or nullptr. The later exceptions are discarded
+	// until the kept exception is taken.
+	std::exception_ptr takeTaskException();
+
+private:
+	std::unique_ptr<internal_::ThreadPoolImplement> implement;
+};
+
+ThreadPool & getDefaultThreadPool();
+
+
+} // namespace metapp
+
+#endif
@@ -29,10 +29,13 @@ namespace metapp {
 
 class VariantData
 {
-private:
+public:
+	// The small trivial values are stored in place in a buffer of this size, the buffer is zero initialized.
 	static constexpr std::size_t bufferSize = internal_::maxOf(sizeof(long long), internal_::maxOf(sizeof(long double), sizeof(void *)));
 	static_assert(bufferSize >= sizeof(int), "VariantData, wrong bufferSize");
 
+private:
+
 	template <typename T>
 	using FitBuffer = std::integral_constant<bool,
 		std::is_trivial<T>::value
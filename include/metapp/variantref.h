@@ -0,0 +1,93 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef METAPP_VARIANTREF_H_969872685611
+#define METAPP_VARIANTREF_H_969872685611
+
+#include "metapp/variant.h"
+
+#include <type_traits>
+
+namespace metapp {
+
+// A non-owning view of a value, it's a MetaType and an address, and is trivially copyable.
+// An empty VariantRef has the meta type of void, same as an empty Variant.
+// The object at the address has the type getNonReferenceMetaType(getMetaType()).
+// VariantRef doesn't extend the lifetime of the object, the object must be alive while the VariantRef is used.
+class VariantRef
+{
+public:
+	template <typename T>
+	static VariantRef reference(T && value) {
+		return VariantRef(metapp::getMetaType<T &>(), (void *)&value);
+	}
+
+	VariantRef() noexcept
+		: metaType(metapp::getMetaType<void>()), address(nullptr)
+	{
+	}
+
+	VariantRef(const MetaType * metaType, void * address) noexcept
+		: metaType(metaType), address(address)
+	{
+	}
+
+	// Refers to the value in var, or the object which var refers to. var must be alive while the VariantRef is used.
+	VariantRef(const Variant & var) noexcept
+		: metaType(var.getMetaType()), address(var.getAddress())
+	{
+	}
+
+	const MetaType * getMetaType() const noexcept {
+		return metaType;
+	}
+
+	void * getAddress() const noexcept {
+		return address;
+	}
+
+	bool isEmpty() const noexcept {
+		return metaType->isVoid();
+	}
+
+	// Returns the object as T &, T must be the type of the object, there is no check or cast.
+	template <typename T>
+	typename std::remove_reference<T>::type & get() const {
+		return *static_cast<typename std::remove_reference<T>::type *>(address);
+	}
+
+	// If getMetaType() is a reference, returns a Variant which refers to the object, otherwise returns a copy of the object.
+	Variant toVariant() const {
+		if(isEmpty()) {
+			return Variant();
+		}
+		return Variant(metaType, address);
+	}
+
+private:
+	const MetaType * metaType;
+	void * address;
+};
+
+inline const MetaType * getNonReferenceMetaType(const VariantRef & ref)
+{
+	return getNonReferenceMetaType(ref.getMetaType());
+}
+
+
+} // namespace metapp
+
+#endif
@@ -0,0 +1,261 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/utilities/asyncinvoke.h"
+#include "metapp/exception.h"
+#include "metapp/utilities/utility.h"
+#include "metapp/allmetatypes.h"
+
+#include <deque>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+void runAsyncInvokeSlot(ExecutorTask * task)
+{
+	AsyncInvokeSlot * slot = static_cast<AsyncInvokeSlot *>(task);
+#ifdef METAPP_EXCEPTION_ENABLED
+	try {
+#endif
+		slot->result = getNonReferenceMetaType(slot->callable)->getMetaCallable()->invoke(
+			slot->callable, slot->instance, slot->arguments
+		);
+#ifdef METAPP_EXCEPTION_ENABLED
+	}
+	catch(...) {
+		slot->exception = std::current_exception();
+	}
+#endif
+	// Free the arguments early, the capacity of the vector is kept for the next invocation.
+	slot->arguments.clear();
+	slot->callable = Variant();
+	slot->instance = Variant();
+	{
+		std::lock_guard<std::mutex> lock(slot->mutex);
+		slot->ready.store(true, std::memory_order_release);
+	}
+	slot->condition.notify_all();
+	releaseAsyncInvokeSlot(slot);
+}
+
+class AsyncInvokeSlotPool
+{
+public:
+	AsyncInvokeSlotPool() : mutex(), slotList(), freeList(nullptr) {
+	}
+
+	AsyncInvokeSlot * acquire() {
+		std::lock_guard<std::mutex> lock(mutex);
+		AsyncInvokeSlot * slot = freeList;
+		if(slot != nullptr) {
+			freeList = slot->nextFree;
+		}
+		else {
+			slotList.emplace_back();
+			slot = &slotList.back();
+		}
+		return slot;
+	}
+
+	void release(AsyncInvokeSlot * slot) {
+		std::lock_guard<std::mutex> lock(mutex);
+		slot->nextFree = freeList;
+		freeList = slot;
+	}
+
+private:
+	std::mutex mutex;
+	// std::deque never moves its elements, the slots are not movable.
+	std::deque<AsyncInvokeSlot> slotList;
+	AsyncInvokeSlot * freeList;
+};
+
+AsyncInvokeSlotPool & getAsyncInvokeSlotPool()
+{
+	// Intentionally leaked, tasks running in a static ThreadPool may still release slots during exit.
+	static AsyncInvokeSlotPool * pool = new AsyncInvokeSlotPool();
+	return *pool;
+}
+
+} // namespace
+
+AsyncInvokeSlot::AsyncInvokeSlot()
+	:
+		ExecutorTask(&runAsyncInvokeSlot),
+		callable(),
+		instance(),
+		arguments(),
+		result(),
+		exception(),
+		ready(false),
+		referenceCount(0),
+		mutex(),
+		condition(),
+		nextFree(nullptr)
+{
+}
+
+AsyncInvokeSlot * acquireAsyncInvokeSlot()
+{
+	AsyncInvokeSlot * slot = getAsyncInvokeSlotPool().acquire();
+	slot->ready.store(false, std::memory_order_relaxed);
+	slot->referenceCount.store(2, std::memory_order_relaxed);
+	return slot;
+}
+
+void releaseAsyncInvokeSlot(AsyncInvokeSlot * slot)
+{
+	if(slot->referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		slot->result = Variant();
+		slot->exception = nullptr;
+		getAsyncInvokeSlotPool().release(slot);
+	}
+}
+
+InvokeFuture submitAsyncInvoke(Executor & executor, AsyncInvokeSlot * slot)
+{
+	InvokeFuture future(slot);
+	executor.execute(slot);
+	return future;
+}
+
+} // namespace internal_
+
+InvokeFuture::InvokeFuture() noexcept
+	: slot(nullptr)
+{
+}
+
+InvokeFuture::InvokeFuture(internal_::AsyncInvokeSlot * slot) noexcept
+	: slot(slot)
+{
+}
+
+InvokeFuture::~InvokeFuture()
+{
+	if(slot != nullptr) {
+		internal_::releaseAsyncInvokeSlot(slot);
+	}
+}
+
+InvokeFuture::InvokeFuture(const InvokeFuture & other) noexcept
+	: slot(other.slot)
+{
+	if(slot != nullptr) {
+		slot->referenceCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+InvokeFuture::InvokeFuture(InvokeFuture && other) noexcept
+	: slot(other.slot)
+{
+	other.slot = nullptr;
+}
+
+InvokeFuture & InvokeFuture::operator = (InvokeFuture other) noexcept
+{
+	std::swap(slot, other.slot);
+	return *this;
+}
+
+bool InvokeFuture::isValid() const noexcept
+{
+	return slot != nullptr;
+}
+
+bool InvokeFuture::isReady() const noexcept
+{
+	return slot != nullptr && slot->ready.load(std::memory_order_acquire);
+}
+
+void InvokeFuture::wait() const
+{
+	if(slot == nullptr) {
+		return;
+	}
+	// When waiting inside a worker, run other pending tasks instead of blocking the worker,
+	// the task we are waiting for may be queued on this worker.
+	while(! slot->ready.load(std::memory_order_acquire)) {
+		if(! internal_::runPendingTaskInCurrentWorker()) {
+			break;
+		}
+	}
+	if(slot->ready.load(std::memory_order_acquire)) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock(slot->mutex);
+	slot->condition.wait(lock, [this]() {
+		return slot->ready.load(std::memory_order_acquire);
+	});
+}
+
+Variant InvokeFuture::get() const
+{
+	if(slot == nullptr) {
+		raiseException<IllegalArgumentException>();
+		return Variant();
+	}
+	wait();
+	if(slot->exception) {
+		std::rethrow_exception(slot->exception);
+	}
+	return slot->result;
+}
+
+void callableInvokeAsyncBatch(
+	Executor & executor,
+	const Variant & callable,
+	const ArgumentSpan & instances,
+	const ArgumentColumnSpan & argumentColumns,
+	const metapp::span<InvokeFuture> & futures
+)
+{
+	const int rowCount = internal_::getBatchRowCount(instances, argumentColumns, ResultColumnSpan());
+	if(rowCount < 0 || futures.size() != (std::size_t)rowCount) {
+		raiseException<IllegalArgumentException>();
+		return;
+	}
+	// The tasks are submitted in chunks, so the executor locks its queues once per chunk rather than once per row.
+	constexpr std::size_t chunkSize = 64;
+	ExecutorTask * taskList[chunkSize];
+	std::size_t taskCount = 0;
+	for(std::size_t row = 0; row < (std::size_t)rowCount; ++row) {
+		internal_::AsyncInvokeSlot * slot = internal_::acquireAsyncInvokeSlot();
+		slot->callable = callable;
+		slot->instance = internal_::getBatchInstance(instances, row);
+		for(const auto & column : argumentColumns) {
+			slot->arguments.push_back(column[row]);
+		}
+		futures[row] = InvokeFuture(slot);
+		taskList[taskCount] = slot;
+		++taskCount;
+		if(taskCount == chunkSize) {
+			executor.executeBatch(taskList, taskCount);
+			taskCount = 0;
+		}
+	}
+	if(taskCount > 0) {
+		executor.executeBatch(taskList, taskCount);
+	}
+}
+
+
+} // namespace metapp
+
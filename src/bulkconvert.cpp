@@ -0,0 +1,752 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/utilities/bulkconvert.h"
+#include "metapp/variant.h"
+#include "metapp/interfaces/metaindexable.h"
+#include "metapp/utilities/utility.h"
+#include "metapp/utilities/typelist.h"
+#include "metapp/implement/internal/knowntypes_i.h"
+#include "metapp/exception.h"
+
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <type_traits>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#define METAPP_BULKCONVERT_X86
+	#define METAPP_BULKCONVERT_TARGET(isa) __attribute__((target(isa)))
+	#include <immintrin.h>
+#endif
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+using BulkConvertFunc = void (*)(const void * source, void * destination, const std::size_t count);
+
+constexpr int arithmeticTypeCount = tkArithmeticEnd - tkArithmeticBegin + 1;
+constexpr int bulkConvertIsaCount = (int)BulkConvertIsa::avx512 + 1;
+
+struct BulkConvertTable
+{
+	BulkConvertFunc funcList[arithmeticTypeCount][arithmeticTypeCount];
+};
+
+template <typename From, typename To>
+struct IsFloatToInteger
+{
+	static constexpr bool value = std::is_floating_point<From>::value
+		&& std::is_integral<To>::value && ! std::is_same<To, bool>::value
+	;
+};
+
+template <typename From, typename To>
+To convertValue(const From value, typename std::enable_if<! IsFloatToInteger<From, To>::value>::type * = nullptr)
+{
+	return static_cast<To>(value);
+}
+
+// static_cast from a floating point value which is out of the range of the integer is undefined behavior,
+// and the vector instructions give the "integer indefinite" value (the minimum) for it.
+// So the conversion saturates, NaN is converted to 0, the values out of range are clamped to the range of To.
+template <typename From, typename To>
+To convertValue(const From value, typename std::enable_if<IsFloatToInteger<From, To>::value>::type * = nullptr)
+{
+	// 2^digits, the maximum + 1, it's a power of 2 so it's exact in From.
+	const From upperBound = From(2) * static_cast<From>(std::numeric_limits<To>::max() / 2 + 1);
+	if(value != value) {
+		return 0;
+	}
+	if(value >= upperBound) {
+		return std::numeric_limits<To>::max();
+	}
+	if(value <= static_cast<From>(std::numeric_limits<To>::lowest())) {
+		return std::numeric_limits<To>::lowest();
+	}
+	return static_cast<To>(value);
+}
+
+template <typename From, typename To>
+void convertScalar(const void * source, void * destination, const std::size_t count)
+{
+	const From * from = static_cast<const From *>(source);
+	To * to = static_cast<To *>(destination);
+	for(std::size_t i = 0; i < count; ++i) {
+		to[i] = convertValue<From, To>(from[i]);
+	}
+}
+
+template <std::size_t size>
+void copyBytes(const void * source, void * destination, const std::size_t count)
+{
+	std::memcpy(destination, source, count * size);
+}
+
+// Integers of the same size and signedness, except bool, have the same representation, so they are copied.
+template <typename From, typename To>
+struct IsSameRepresentation
+{
+	static constexpr bool value = std::is_same<From, To>::value
+		|| (
+			std::is_integral<From>::value && std::is_integral<To>::value
+			&& ! std::is_same<To, bool>::value && ! std::is_same<From, bool>::value
+			&& sizeof(From) == sizeof(To) && std::is_signed<From>::value == std::is_signed<To>::value
+		)
+	;
+};
+
+template <typename From, typename To>
+BulkConvertFunc selectGenericKernel(typename std::enable_if<IsSameRepresentation<From, To>::value>::type * = nullptr)
+{
+	return &copyBytes<sizeof(From)>;
+}
+
+template <typename From, typename To>
+BulkConvertFunc selectGenericKernel(typename std::enable_if<! IsSameRepresentation<From, To>::value>::type * = nullptr)
+{
+	return &convertScalar<From, To>;
+}
+
+template <typename From, typename ...Tos>
+void fillGenericRow(BulkConvertFunc * row, TypeList<Tos...>)
+{
+	const BulkConvertFunc funcList[] = { selectGenericKernel<From, Tos>()... };
+	for(int i = 0; i < arithmeticTypeCount; ++i) {
+		row[i] = funcList[i];
+	}
+}
+
+template <typename ...Froms>
+void fillGenericTable(BulkConvertTable & table, TypeList<Froms...>)
+{
+	int index = 0;
+	using Expander = int[];
+	(void)Expander { 0, (fillGenericRow<Froms>(table.funcList[index++], ArithmeticTypeList()), 0)... };
+}
+
+#ifdef METAPP_BULKCONVERT_X86
+
+// The vectorized kernels work on the machine representation, the type kinds are mapped to it.
+enum class Representation
+{
+	none,
+	int32,
+	int64,
+	float32,
+	float64
+};
+
+template <typename T>
+constexpr Representation getRepresentation()
+{
+	return std::is_same<T, float>::value ? Representation::float32
+		: std::is_same<T, double>::value ? Representation::float64
+		: (std::is_integral<T>::value && std::is_signed<T>::value && ! std::is_same<T, bool>::value) ?
+			(sizeof(T) == 4 ? Representation::int32 : sizeof(T) == 8 ? Representation::int64 : Representation::none)
+		: Representation::none
+	;
+}
+
+template <typename ...Types>
+const Representation * getRepresentationList(TypeList<Types...>)
+{
+	static const Representation representationList[] = { getRepresentation<Types>()... };
+	return representationList;
+}
+
+// The vector kernels saturate the same as convertValue.
+// cvtt gives the minimum integer for NaN and the values out of range, the kernels converting to integers fix up
+// the lanes which are NaN or not less than 2^31 (2^63), the negative values out of range are already the minimum.
+// For double to int32, the value is clamped before converting, because the mask lanes are wider than the result lanes.
+
+// SSE2
+
+METAPP_BULKCONVERT_TARGET("sse2")
+inline __m128i saturateFloatToInt32Sse2(const __m128 value)
+{
+	const __m128i converted = _mm_cvttps_epi32(value);
+	const __m128i overflow = _mm_castps_si128(_mm_cmpge_ps(value, _mm_set1_ps(2147483648.0f)));
+	const __m128i ordered = _mm_castps_si128(_mm_cmpord_ps(value, value));
+	// The minimum xor all bits set is the maximum.
+	return _mm_and_si128(_mm_xor_si128(converted, overflow), ordered);
+}
+
+METAPP_BULKCONVERT_TARGET("sse2")
+inline __m128i saturateDoubleToInt32Sse2(const __m128d value)
+{
+	const __m128d notNan = _mm_and_pd(value, _mm_cmpord_pd(value, value));
+	const __m128d clamped = _mm_min_pd(_mm_max_pd(notNan, _mm_set1_pd(-2147483648.0)), _mm_set1_pd(2147483647.0));
+	return _mm_cvttpd_epi32(clamped);
+}
+
+METAPP_BULKCONVERT_TARGET("sse2")
+void convertInt32ToDoubleSse2(const void * source, void * destination, const std::size_t count)
+{
+	const std::int32_t * from = static_cast<const std::int32_t *>(source);
+	double * to = static_cast<double *>(destination);
+	std::size_t i = 0;
+	for(; i + 2 <= count; i += 2) {
+		_mm_storeu_pd(to + i, _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(from + i))));
+	}
+	convertScalar<std::int32_t, double>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_TARGET("sse2")
+void convertInt32ToFloatSse2(const void * source, void * destination, const std::size_t count)
+{
+	const std::int32_t * from = static_cast<const std::int32_t *>(source);
+	float * to = static_cast<float *>(destination);
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		_mm_storeu_ps(to + i, _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(from + i))));
+	}
+	convertScalar<std::int32_t, float>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_TARGET("sse2")
+void convertFloatToDoubleSse2(const void * source, void * destination, const std::size_t count)
+{
+	const float * from = static_cast<const float *>(source);
+	double * to = static_cast<double *>(destination);
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		const __m128 value = _mm_loadu_ps(from + i);
+		_mm_storeu_pd(to + i, _mm_cvtps_pd(value));
+		_mm_storeu_pd(to + i + 2, _mm_cvtps_pd(_mm_movehl_ps(value, value)));
+	}
+	convertScalar<float, double>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_TARGET("sse2")
+void convertDoubleToFloatSse2(const void * source, void * destination, const std::size_t count)
+{
+	const double * from = static_cast<const double *>(source);
+	float * to = static_cast<float *>(destination);
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		const __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(from + i));
+		const __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(from + i + 2));
+		_mm_storeu_ps(to + i, _mm_movelh_ps(low, high));
+	}
+	convertScalar<double, float>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_TARGET("sse2")
+void convertFloatToInt32Sse2(const void * source, void * destination, const std::size_t count)
+{
+	const float * from = static_cast<const float *>(source);
+	std::int32_t * to = static_cast<std::int32_t *>(destination);
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(to + i), saturateFloatToInt32Sse2(_mm_loadu_ps(from + i)));
+	}
+	convertScalar<float, std::int32_t>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_TARGET("sse2")
+void convertDoubleToInt32Sse2(const void * source, void * destination, const std::size_t count)
+{
+	const double * from = static_cast<const double *>(source);
+	std::int32_t * to = static_cast<std::int32_t *>(destination);
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		const __m128i low = saturateDoubleToInt32Sse2(_mm_loadu_pd(from + i));
+		const __m128i high = saturateDoubleToInt32Sse2(_mm_loadu_pd(from + i + 2));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(to + i), _mm_unpacklo_epi64(low, high));
+	}
+	convertScalar<double, std::int32_t>(from + i, to + i, count - i);
+}
+
+// AVX2
+
+METAPP_BULKCONVERT_TARGET("avx2")
+inline __m256i saturateFloatToInt32Avx2(const __m256 value)
+{
+	const __m256i converted = _mm256_cvttps_epi32(value);
+	const __m256i overflow = _mm256_castps_si256(_mm256_cmp_ps(value, _mm256_set1_ps(2147483648.0f), _CMP_GE_OQ));
+	const __m256i ordered = _mm256_castps_si256(_mm256_cmp_ps(value, value, _CMP_ORD_Q));
+	return _mm256_and_si256(_mm256_xor_si256(converted, overflow), ordered);
+}
+
+METAPP_BULKCONVERT_TARGET("avx2")
+inline __m128i saturateDoubleToInt32Avx2(const __m256d value)
+{
+	const __m256d notNan = _mm256_and_pd(value, _mm256_cmp_pd(value, value, _CMP_ORD_Q));
+	const __m256d clamped = _mm256_min_pd(
+		_mm256_max_pd(notNan, _mm256_set1_pd(-2147483648.0)),
+		_mm256_set1_pd(2147483647.0)
+	);
+	return _mm256_cvttpd_epi32(clamped);
+}
+
+METAPP_BULKCONVERT_TARGET("avx2")
+void convertInt32ToDoubleAvx2(const void * source, void * destination, const std::size_t count)
+{
+	const std::int32_t * from = static_cast<const std::int32_t *>(source);
+	double * to = static_cast<double *>(destination);
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		_mm256_storeu_pd(to + i, _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(from + i))));
+	}
+	convertScalar<std::int32_t, double>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_TARGET("avx2")
+void convertInt32ToFloatAvx2(const void * source, void * destination, const std::size_t count)
+{
+	const std::int32_t * from = static_cast<const std::int32_t *>(source);
+	float * to = static_cast<float *>(destination);
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm256_storeu_ps(to + i, _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(from + i))));
+	}
+	convertScalar<std::int32_t, float>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_TARGET("avx2")
+void convertFloatToDoubleAvx2(const void * source, void * destination, const std::size_t count)
+{
+	const float * from = static_cast<const float *>(source);
+	double * to = static_cast<double *>(destination);
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		_mm256_storeu_pd(to + i, _mm256_cvtps_pd(_mm_loadu_ps(from + i)));
+	}
+	convertScalar<float, double>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_TARGET("avx2")
+void convertDoubleToFloatAvx2(const void * source, void * destination, const std::size_t count)
+{
+	const double * from = static_cast<const double *>(source);
+	float * to = static_cast<float *>(destination);
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		_mm_storeu_ps(to + i, _mm256_cvtpd_ps(_mm256_loadu_pd(from + i)));
+	}
+	convertScalar<double, float>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_TARGET("avx2")
+void convertFloatToInt32Avx2(const void * source, void * destination, const std::size_t count)
+{
+	const float * from = static_cast<const float *>(source);
+	std::int32_t * to = static_cast<std::int32_t *>(destination);
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(to + i), saturateFloatToInt32Avx2(_mm256_loadu_ps(from + i)));
+	}
+	convertScalar<float, std::int32_t>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_TARGET("avx2")
+void convertDoubleToInt32Avx2(const void * source, void * destination, const std::size_t count)
+{
+	const double * from = static_cast<const double *>(source);
+	std::int32_t * to = static_cast<std::int32_t *>(destination);
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(to + i), saturateDoubleToInt32Avx2(_mm256_loadu_pd(from + i)));
+	}
+	convertScalar<double, std::int32_t>(from + i, to + i, count - i);
+}
+
+// AVX-512, requires AVX512F and AVX512DQ
+
+#define METAPP_BULKCONVERT_AVX512 METAPP_BULKCONVERT_TARGET("avx512f,avx512dq")
+
+// The AVX-512 intrinsics in GCC use deliberately undefined values, which trigger false warnings.
+#if defined(__GNUC__) && ! defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+METAPP_BULKCONVERT_AVX512
+inline __m512i saturateFloatToInt32Avx512(const __m512 value)
+{
+	const __m512i converted = _mm512_mask_mov_epi32(
+		_mm512_cvttps_epi32(value),
+		_mm512_cmp_ps_mask(value, _mm512_set1_ps(2147483648.0f), _CMP_GE_OQ),
+		_mm512_set1_epi32(2147483647)
+	);
+	return _mm512_maskz_mov_epi32(_mm512_cmp_ps_mask(value, value, _CMP_ORD_Q), converted);
+}
+
+METAPP_BULKCONVERT_AVX512
+inline __m256i saturateDoubleToInt32Avx512(const __m512d value)
+{
+	const __m512d notNan = _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(value, value, _CMP_ORD_Q), value);
+	const __m512d clamped = _mm512_min_pd(
+		_mm512_max_pd(notNan, _mm512_set1_pd(-2147483648.0)),
+		_mm512_set1_pd(2147483647.0)
+	);
+	return _mm512_cvttpd_epi32(clamped);
+}
+
+METAPP_BULKCONVERT_AVX512
+inline __m512i saturateDoubleToInt64Avx512(const __m512d value)
+{
+	const __m512i converted = _mm512_mask_mov_epi64(
+		_mm512_cvttpd_epi64(value),
+		_mm512_cmp_pd_mask(value, _mm512_set1_pd(9223372036854775808.0), _CMP_GE_OQ),
+		_mm512_set1_epi64(std::numeric_limits<std::int64_t>::max())
+	);
+	return _mm512_maskz_mov_epi64(_mm512_cmp_pd_mask(value, value, _CMP_ORD_Q), converted);
+}
+
+METAPP_BULKCONVERT_AVX512
+void convertInt32ToDoubleAvx512(const void * source, void * destination, const std::size_t count)
+{
+	const std::int32_t * from = static_cast<const std::int32_t *>(source);
+	double * to = static_cast<double *>(destination);
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm512_storeu_pd(to + i, _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(from + i))));
+	}
+	convertScalar<std::int32_t, double>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_AVX512
+void convertInt32ToFloatAvx512(const void * source, void * destination, const std::size_t count)
+{
+	const std::int32_t * from = static_cast<const std::int32_t *>(source);
+	float * to = static_cast<float *>(destination);
+	std::size_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		_mm512_storeu_ps(to + i, _mm512_cvtepi32_ps(_mm512_loadu_si512(from + i)));
+	}
+	convertScalar<std::int32_t, float>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_AVX512
+void convertFloatToDoubleAvx512(const void * source, void * destination, const std::size_t count)
+{
+	const float * from = static_cast<const float *>(source);
+	double * to = static_cast<double *>(destination);
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm512_storeu_pd(to + i, _mm512_cvtps_pd(_mm256_loadu_ps(from + i)));
+	}
+	convertScalar<float, double>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_AVX512
+void convertDoubleToFloatAvx512(const void * source, void * destination, const std::size_t count)
+{
+	const double * from = static_cast<const double *>(source);
+	float * to = static_cast<float *>(destination);
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm256_storeu_ps(to + i, _mm512_cvtpd_ps(_mm512_loadu_pd(from + i)));
+	}
+	convertScalar<double, float>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_AVX512
+void convertFloatToInt32Avx512(const void * source, void * destination, const std::size_t count)
+{
+	const float * from = static_cast<const float *>(source);
+	std::int32_t * to = static_cast<std::int32_t *>(destination);
+	std::size_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		_mm512_storeu_si512(to + i, saturateFloatToInt32Avx512(_mm512_loadu_ps(from + i)));
+	}
+	convertScalar<float, std::int32_t>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_AVX512
+void convertDoubleToInt32Avx512(const void * source, void * destination, const std::size_t count)
+{
+	const double * from = static_cast<const double *>(source);
+	std::int32_t * to = static_cast<std::int32_t *>(destination);
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(to + i), saturateDoubleToInt32Avx512(_mm512_loadu_pd(from + i)));
+	}
+	convertScalar<double, std::int32_t>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_AVX512
+void convertInt64ToDoubleAvx512(const void * source, void * destination, const std::size_t count)
+{
+	const std::int64_t * from = static_cast<const std::int64_t *>(source);
+	double * to = static_cast<double *>(destination);
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm512_storeu_pd(to + i, _mm512_cvtepi64_pd(_mm512_loadu_si512(from + i)));
+	}
+	convertScalar<std::int64_t, double>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_AVX512
+void convertDoubleToInt64Avx512(const void * source, void * destination, const std::size_t count)
+{
+	const double * from = static_cast<const double *>(source);
+	std::int64_t * to = static_cast<std::int64_t *>(destination);
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm512_storeu_si512(to + i, saturateDoubleToInt64Avx512(_mm512_loadu_pd(from + i)));
+	}
+	convertScalar<double, std::int64_t>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_AVX512
+void convertInt64ToFloatAvx512(const void * source, void * destination, const std::size_t count)
+{
+	const std::int64_t * from = static_cast<const std::int64_t *>(source);
+	float * to = static_cast<float *>(destination);
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm256_storeu_ps(to + i, _mm512_cvtepi64_ps(_mm512_loadu_si512(from + i)));
+	}
+	convertScalar<std::int64_t, float>(from + i, to + i, count - i);
+}
+
+METAPP_BULKCONVERT_AVX512
+void convertFloatToInt64Avx512(const void * source, void * destination, const std::size_t count)
+{
+	const float * from = static_cast<const float *>(source);
+	std::int64_t * to = static_cast<std::int64_t *>(destination);
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		// Widening to double is exact, so the double kernel saturates the float values too.
+		_mm512_storeu_si512(to + i, saturateDoubleToInt64Avx512(_mm512_cvtps_pd(_mm256_loadu_ps(from + i))));
+	}
+	convertScalar<float, std::int64_t>(from + i, to + i, count - i);
+}
+
+#if defined(__GNUC__) && ! defined(__clang__)
+	#pragma GCC diagnostic pop
+#endif
+
+#undef METAPP_BULKCONVERT_AVX512
+
+struct VectorizedKernel
+{
+	BulkConvertIsa isa;
+	Representation from;
+	Representation to;
+	BulkConvertFunc func;
+};
+
+// Sorted by isa, so the kernel of the highest allowed isa overrides the lower ones.
+const VectorizedKernel vectorizedKernelList[] = {
+	{ BulkConvertIsa::sse2, Representation::int32, Representation::float64, &convertInt32ToDoubleSse2 },
+	{ BulkConvertIsa::sse2, Representation::int32, Representation::float32, &convertInt32ToFloatSse2 },
+	{ BulkConvertIsa::sse2, Representation::float32, Representation::float64, &convertFloatToDoubleSse2 },
+	{ BulkConvertIsa::sse2, Representation::float64, Representation::float32, &convertDoubleToFloatSse2 },
+	{ BulkConvertIsa::sse2, Representation::float32, Representation::int32, &convertFloatToInt32Sse2 },
+	{ BulkConvertIsa::sse2, Representation::float64, Representation::int32, &convertDoubleToInt32Sse2 },
+
+	{ BulkConvertIsa::avx2, Representation::int32, Representation::float64, &convertInt32ToDoubleAvx2 },
+	{ BulkConvertIsa::avx2, Representation::int32, Representation::float32, &convertInt32ToFloatAvx2 },
+	{ BulkConvertIsa::avx2, Representation::float32, Representation::float64, &convertFloatToDoubleAvx2 },
+	{ BulkConvertIsa::avx2, Representation::float64, Representation::float32, &convertDoubleToFloatAvx2 },
+	{ BulkConvertIsa::avx2, Representation::float32, Representation::int32, &convertFloatToInt32Avx2 },
+	{ BulkConvertIsa::avx2, Representation::float64, Representation::int32, &convertDoubleToInt32Avx2 },
+
+	{ BulkConvertIsa::avx512, Representation::int32, Representation::float64, &convertInt32ToDoubleAvx512 },
+	{ BulkConvertIsa::avx512, Representation::int32, Representation::float32, &convertInt32ToFloatAvx512 },
+	{ BulkConvertIsa::avx512, Representation::float32, Representation::float64, &convertFloatToDoubleAvx512 },
+	{ BulkConvertIsa::avx512, Representation::float64, Representation::float32, &convertDoubleToFloatAvx512 },
+	{ BulkConvertIsa::avx512, Representation::float32, Representation::int32, &convertFloatToInt32Avx512 },
+	{ BulkConvertIsa::avx512, Representation::float64, Representation::int32, &convertDoubleToInt32Avx512 },
+	{ BulkConvertIsa::avx512, Representation::int64, Representation::float64, &convertInt64ToDoubleAvx512 },
+	{ BulkConvertIsa::avx512, Representation::float64, Representation::int64, &convertDoubleToInt64Avx512 },
+	{ BulkConvertIsa::avx512, Representation::int64, Representation::float32, &convertInt64ToFloatAvx512 },
+	{ BulkConvertIsa::avx512, Representation::float32, Representation::int64, &convertFloatToInt64Avx512 },
+};
+
+void applyVectorizedKernels(BulkConvertTable & table, const BulkConvertIsa isa)
+{
+	const Representation * representationList = getRepresentationList(ArithmeticTypeList());
+	for(const VectorizedKernel & kernel : vectorizedKernelList) {
+		if((int)kernel.isa > (int)isa) {
+			continue;
+		}
+		for(int from = 0; from < arithmeticTypeCount; ++from) {
+			if(representationList[from] != kernel.from) {
+				continue;
+			}
+			for(int to = 0; to < arithmeticTypeCount; ++to) {
+				if(representationList[to] == kernel.to) {
+					table.funcList[from][to] = kernel.func;
+				}
+			}
+		}
+	}
+}
+
+BulkConvertIsa detectBulkConvertIsa()
+{
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+		return BulkConvertIsa::avx512;
+	}
+	if(__builtin_cpu_supports("avx2")) {
+		return BulkConvertIsa::avx2;
+	}
+	if(__builtin_cpu_supports("sse2")) {
+		return BulkConvertIsa::sse2;
+	}
+	return BulkConvertIsa::scalar;
+}
+
+#else
+
+void applyVectorizedKernels(BulkConvertTable & /*table*/, const BulkConvertIsa /*isa*/)
+{
+}
+
+BulkConvertIsa detectBulkConvertIsa()
+{
+	return BulkConvertIsa::scalar;
+}
+
+#endif
+
+struct BulkConvertState
+{
+	BulkConvertState()
+		: supportedIsa(detectBulkConvertIsa()), currentIsa((int)supportedIsa), tableList()
+	{
+		for(int i = 0; i <= (int)supportedIsa; ++i) {
+			fillGenericTable(tableList[i], ArithmeticTypeList());
+			applyVectorizedKernels(tableList[i], (BulkConvertIsa)i);
+		}
+	}
+
+	const BulkConvertTable & getTable() const {
+		return tableList[currentIsa.load(std::memory_order_relaxed)];
+	}
+
+	const BulkConvertIsa supportedIsa;
+	std::atomic<int> currentIsa;
+	BulkConvertTable tableList[bulkConvertIsaCount];
+};
+
+BulkConvertState & getBulkConvertState()
+{
+	static BulkConvertState state;
+	return state;
+}
+
+} // namespace
+
+} // namespace internal_
+
+bool canBulkConvert(const TypeKind sourceTypeKind, const TypeKind destinationTypeKind)
+{
+	return typeKindIsArithmetic(sourceTypeKind) && typeKindIsArithmetic(destinationTypeKind);
+}
+
+void bulkConvert(
+	const void * source,
+	const TypeKind sourceTypeKind,
+	const std::size_t count,
+	void * destination,
+	const TypeKind destinationTypeKind
+)
+{
+	if(! canBulkConvert(sourceTypeKind, destinationTypeKind)) {
+		raiseException<UnsupportedException>("bulkConvert only supports arithmetic types");
+		return;
+	}
+	if(count == 0) {
+		return;
+	}
+	internal_::getBulkConvertState().getTable()
+		.funcList[sourceTypeKind - tkArithmeticBegin][destinationTypeKind - tkArithmeticBegin](source, destination, count);
+}
+
+std::size_t bulkConvert(const Variant & source, const Variant & destination)
+{
+	const MetaIndexable * sourceIndexable = getNonReferenceMetaType(source)->getMetaIndexable();
+	const MetaIndexable * destinationIndexable = getNonReferenceMetaType(destination)->getMetaIndexable();
+	if(sourceIndexable == nullptr || destinationIndexable == nullptr) {
+		raiseException<UnsupportedException>("bulkConvert requires indexable source and destination");
+		return 0;
+	}
+	requireMutable(destination);
+
+	const MetaIndexable::SizeInfo sourceSizeInfo = sourceIndexable->getSizeInfo(source);
+	if(sourceSizeInfo.isUnknownSize()) {
+		raiseException<UnsupportedException>("bulkConvert requires the source size is known");
+		return 0;
+	}
+	const std::size_t count = sourceSizeInfo.getSize();
+	MetaIndexable::SizeInfo destinationSizeInfo = destinationIndexable->getSizeInfo(destination);
+	if(destinationSizeInfo.isResizable()) {
+		destinationIndexable->resize(destination, count);
+		destinationSizeInfo = destinationIndexable->getSizeInfo(destination);
+	}
+	if(destinationSizeInfo.getSize() < count) {
+		raiseException<OutOfRangeException>();
+		return 0;
+	}
+	if(count == 0) {
+		return 0;
+	}
+
+	const TypeKind sourceTypeKind = getNonReferenceMetaType(sourceIndexable->getValueType(source, 0))->getTypeKind();
+	const TypeKind destinationTypeKind = getNonReferenceMetaType(destinationIndexable->getValueType(destination, 0))->getTypeKind();
+	if(canBulkConvert(sourceTypeKind, destinationTypeKind)) {
+		const void * sourceData = sourceIndexable->getData(source);
+		void * destinationData = destinationIndexable->getData(destination);
+		if(sourceData != nullptr && destinationData != nullptr) {
+			bulkConvert(sourceData, sourceTypeKind, count, destinationData, destinationTypeKind);
+			return count;
+		}
+	}
+
+	// The arithmetic elements are converted by the kernels one by one, so they saturate the same as the contiguous
+	// containers, instead of casting by Variant which is undefined for the floating point values out of range.
+	long double buffer;
+	for(std::size_t i = 0; i < count; ++i) {
+		const Variant element = sourceIndexable->get(source, i);
+		const MetaType * elementType = getNonReferenceMetaType(element);
+		const MetaType * destinationValueType = getNonReferenceMetaType(destinationIndexable->getValueType(destination, i));
+		if(canBulkConvert(elementType->getTypeKind(), destinationValueType->getTypeKind())) {
+			bulkConvert(element.getAddress(), elementType->getTypeKind(), 1, &buffer, destinationValueType->getTypeKind());
+			destinationIndexable->set(destination, i, Variant(destinationValueType, &buffer));
+		}
+		else {
+			destinationIndexable->set(destination, i, element);
+		}
+	}
+	return count;
+}
+
+BulkConvertIsa getBulkConvertIsa()
+{
+	return (BulkConvertIsa)internal_::getBulkConvertState().currentIsa.load(std::memory_order_relaxed);
+}
+
+BulkConvertIsa setBulkConvertIsa(const BulkConvertIsa isa)
+{
+	internal_::BulkConvertState & state = internal_::getBulkConvertState();
+	const BulkConvertIsa newIsa = (int)isa < (int)state.supportedIsa ? isa : state.supportedIsa;
+	state.currentIsa.store((int)newIsa, std::memory_order_relaxed);
+	return newIsa;
+}
+
+} // namespace metapp
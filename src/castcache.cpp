@@ -0,0 +1,100 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/implement/internal/castcache_i.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+// Each entry is protected by a sequence lock. The writer makes the sequence odd while it's writing,
+// the reader doesn't retry, it treats a changed or odd sequence as a cache miss.
+// All fields are atomics, so concurrent reading and writing is not a data race.
+struct CastCacheEntry
+{
+	std::atomic<std::uint32_t> sequence;
+	std::atomic<const MetaType *> fromMetaType;
+	std::atomic<const MetaType *> toMetaType;
+	// (generation << 1) | canCast
+	std::atomic<std::uint64_t> value;
+};
+
+constexpr std::size_t castCacheSize = 4096;
+
+// Zero initialized as a static object, generation 0 is never valid because the generation starts from 1.
+CastCacheEntry castCache[castCacheSize];
+
+CastCacheEntry & getCastCacheEntry(const MetaType * fromMetaType, const MetaType * toMetaType)
+{
+	const std::uintptr_t from = reinterpret_cast<std::uintptr_t>(fromMetaType) >> 4;
+	const std::uintptr_t to = reinterpret_cast<std::uintptr_t>(toMetaType) >> 4;
+	const std::size_t hash = (std::size_t)((from * 0x9e3779b97f4a7c15ull) ^ (to * 0xc2b2ae3d27d4eb4full)) >> 7;
+	return castCache[hash & (castCacheSize - 1)];
+}
+
+} // namespace
+
+CastCacheResult findCanCastCache(const MetaType * fromMetaType, const MetaType * toMetaType, const std::uint64_t generation)
+{
+	CastCacheEntry & entry = getCastCacheEntry(fromMetaType, toMetaType);
+	const std::uint32_t sequence = entry.sequence.load(std::memory_order_acquire);
+	if((sequence & 1) != 0) {
+		return CastCacheResult::unknown;
+	}
+	const MetaType * from = entry.fromMetaType.load(std::memory_order_relaxed);
+	const MetaType * to = entry.toMetaType.load(std::memory_order_relaxed);
+	const std::uint64_t value = entry.value.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if(entry.sequence.load(std::memory_order_relaxed) != sequence) {
+		return CastCacheResult::unknown;
+	}
+	if(from != fromMetaType || to != toMetaType || (value >> 1) != generation) {
+		return CastCacheResult::unknown;
+	}
+	return (value & 1) != 0 ? CastCacheResult::yes : CastCacheResult::no;
+}
+
+void storeCanCastCache(
+	const MetaType * fromMetaType,
+	const MetaType * toMetaType,
+	const std::uint64_t generation,
+	const bool canCast
+)
+{
+	CastCacheEntry & entry = getCastCacheEntry(fromMetaType, toMetaType);
+	std::uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+	// If another thread is writing the entry, skip storing, the result will be stored next time.
+	if((sequence & 1) != 0
+		|| ! entry.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire)) {
+		return;
+	}
+	std::atomic_thread_fence(std::memory_order_release);
+	entry.fromMetaType.store(fromMetaType, std::memory_order_relaxed);
+	entry.toMetaType.store(toMetaType, std::memory_order_relaxed);
+	entry.value.store((generation << 1) | (canCast ? 1 : 0), std::memory_order_relaxed);
+	entry.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+} // namespace internal_
+
+} // namespace metapp
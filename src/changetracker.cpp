@@ -0,0 +1,500 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "metapp/utilities/changetracker.h"
+#include "metapp/implement/internal/changetracker_i.h"
+#include "metapp/utilities/profiler.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/allmetatypes.h"
+
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+
+namespace metapp {
+
+namespace internal_ {
+
+std::atomic<std::size_t> trackedInstanceCount(0);
+
+namespace {
+
+// A counting filter of the tracked addresses. The hooks check it without the lock, so writing to the untracked
+// instances doesn't contend on the lock when other instances are tracked. The lock is taken only if the slot
+// of the address is not zero, a collision only costs the lock and the look up.
+constexpr std::size_t addressFilterBits = 12;
+constexpr std::size_t addressFilterSize = (std::size_t)1 << addressFilterBits;
+std::atomic<std::uint32_t> addressFilter[addressFilterSize];
+
+std::atomic<std::uint32_t> & getAddressFilterSlot(const void * address)
+{
+	// Fibonacci hashing, the low bits of the addresses are mostly the same due to the alignment.
+	const std::uint64_t hash = (std::uint64_t)reinterpret_cast<std::uintptr_t>(address) * 0x9e3779b97f4a7c15ull;
+	return addressFilter[(std::size_t)(hash >> (64 - addressFilterBits))];
+}
+
+bool isAddressMaybeTracked(const void * address)
+{
+	return getAddressFilterSlot(address).load(std::memory_order_relaxed) != 0;
+}
+
+constexpr std::uint32_t noChangeEntry = 0xffffffffu;
+
+struct ChangeEntry
+{
+	// 0 if the field is never written, then the entry is not linked.
+	std::uint64_t generation;
+	std::uint32_t previous;
+	std::uint32_t next;
+};
+
+// The entries of the fields, the written ones are linked from the latest written.
+class ChangeList
+{
+public:
+	ChangeList() : entryList(), head(noChangeEntry) {
+	}
+
+	void touch(const std::uint32_t id, const std::uint64_t generation) {
+		if(id >= entryList.size()) {
+			entryList.resize(id + 1, ChangeEntry { 0, noChangeEntry, noChangeEntry });
+		}
+		ChangeEntry & entry = entryList[id];
+		if(entry.generation != 0) {
+			if(head == id) {
+				entry.generation = generation;
+				return;
+			}
+			entryList[entry.previous].next = entry.next;
+			if(entry.next != noChangeEntry) {
+				entryList[entry.next].previous = entry.previous;
+			}
+		}
+		entry.generation = generation;
+		entry.previous = noChangeEntry;
+		entry.next = head;
+		if(head != noChangeEntry) {
+			entryList[head].previous = id;
+		}
+		head = id;
+	}
+
+	void remove(const std::uint32_t id) {
+		if(id >= entryList.size() || entryList[id].generation == 0) {
+			return;
+		}
+		ChangeEntry & entry = entryList[id];
+		if(entry.previous != noChangeEntry) {
+			entryList[entry.previous].next = entry.next;
+		}
+		else {
+			head = entry.next;
+		}
+		if(entry.next != noChangeEntry) {
+			entryList[entry.next].previous = entry.previous;
+		}
+		entry = ChangeEntry { 0, noChangeEntry, noChangeEntry };
+	}
+
+	std::uint64_t getLatestGeneration() const {
+		return head == noChangeEntry ? 0 : entryList[head].generation;
+	}
+
+	template <typename Callback>
+	void forEachSince(const std::uint64_t sinceGeneration, Callback && callback) const {
+		for(std::uint32_t id = head; id != noChangeEntry && entryList[id].generation > sinceGeneration; id = entryList[id].next) {
+			callback(id, entryList[id].generation);
+		}
+	}
+
+private:
+	std::vector<ChangeEntry> entryList;
+	std::uint32_t head;
+};
+
+struct ClassField
+{
+	Variant accessible;
+	std::string name;
+};
+
+// The accessibles of a type, shared by all tracked instances of the type.
+// The accessibles are identified the same as Profiler, so the copies of an accessible are the same field.
+struct ClassFieldTable
+{
+	std::map<ProfileKey, std::uint32_t> fieldIdMap;
+	std::vector<ClassField> fieldList;
+};
+
+struct ElementField
+{
+	ChangedFieldType type;
+	long long number;
+	// Points to the key in TrackedInstance::textElementMap, nullptr if the key is number.
+	const std::string * text;
+};
+
+struct TrackedInstance
+{
+	void * address;
+	const MetaType * metaType;
+	// The index in ChangeTrackerState::instanceList.
+	std::uint32_t id;
+	ClassFieldTable * classFieldTable;
+	ChangeList accessibleChangeList;
+	ChangeList elementChangeList;
+	// The indexes and the integral keys, and the other keys.
+	std::unordered_map<long long, std::uint32_t> numberElementMap;
+	std::unordered_map<std::string, std::uint32_t> textElementMap;
+	std::vector<ElementField> elementFieldList;
+};
+
+struct ChangeTrackerState
+{
+	std::mutex mutex;
+	std::uint64_t generation = 0;
+	std::unordered_multimap<const void *, std::unique_ptr<TrackedInstance> > instanceMap;
+	// The instances which are changed, linked from the latest changed. The ids of the untracked instances are reused.
+	ChangeList instanceChangeList;
+	std::vector<TrackedInstance *> instanceList;
+	std::vector<std::uint32_t> freeInstanceIdList;
+	std::map<const MetaType *, std::unique_ptr<ClassFieldTable> > classFieldTableMap;
+};
+
+ChangeTrackerState & getChangeTrackerState()
+{
+	static ChangeTrackerState state;
+	return state;
+}
+
+ClassFieldTable * getClassFieldTable(ChangeTrackerState & state, const MetaType * metaType)
+{
+	std::unique_ptr<ClassFieldTable> & table = state.classFieldTableMap[metaType];
+	if(! table) {
+		table.reset(new ClassFieldTable());
+		const MetaClass * metaClass = metaType->getMetaClass();
+		if(metaClass != nullptr) {
+			for(const MetaItem & item : metaClass->getAccessibleView()) {
+				const ProfileKey key = Profiler::getKey(item.asAccessible());
+				if(table->fieldIdMap.find(key) == table->fieldIdMap.end()) {
+					table->fieldIdMap[key] = (std::uint32_t)table->fieldList.size();
+					table->fieldList.push_back(ClassField { item.asAccessible(), item.getName() });
+				}
+			}
+		}
+	}
+	return table.get();
+}
+
+std::uint32_t getClassFieldId(ClassFieldTable * table, const Variant & accessible)
+{
+	const ProfileKey key = Profiler::getKey(accessible);
+	auto it = table->fieldIdMap.find(key);
+	if(it != table->fieldIdMap.end()) {
+		return it->second;
+	}
+	// Not registered in the MetaClass, such as an accessible created in place.
+	const std::uint32_t id = (std::uint32_t)table->fieldList.size();
+	table->fieldIdMap[key] = id;
+	table->fieldList.push_back(ClassField { accessible, std::string() });
+	return id;
+}
+
+TrackedInstance * findTrackedInstance(ChangeTrackerState & state, const std::pair<void *, const MetaType *> & pointerAndType)
+{
+	if(pointerAndType.first == nullptr) {
+		return nullptr;
+	}
+	const auto range = state.instanceMap.equal_range(pointerAndType.first);
+	for(auto it = range.first; it != range.second; ++it) {
+		if(it->second->metaType->equal(pointerAndType.second)) {
+			return it->second.get();
+		}
+	}
+	return nullptr;
+}
+
+std::uint64_t nextGeneration(ChangeTrackerState & state, TrackedInstance * trackedInstance)
+{
+	++state.generation;
+	state.instanceChangeList.touch(trackedInstance->id, state.generation);
+	return state.generation;
+}
+
+void collectChangedFields(std::vector<ChangedField> & result, const TrackedInstance * trackedInstance, const std::uint64_t sinceGeneration)
+{
+	const std::size_t firstIndex = result.size();
+	trackedInstance->accessibleChangeList.forEachSince(
+		sinceGeneration,
+		[&result, trackedInstance](const std::uint32_t id, const std::uint64_t generation) {
+			const ClassField & field = trackedInstance->classFieldTable->fieldList[id];
+			result.push_back(ChangedField { ChangedFieldType::accessible, generation, field.accessible, field.name, 0, Variant() });
+		}
+	);
+	const std::size_t elementIndex = result.size();
+	trackedInstance->elementChangeList.forEachSince(
+		sinceGeneration,
+		[&result, trackedInstance](const std::uint32_t id, const std::uint64_t generation) {
+			const ElementField & field = trackedInstance->elementFieldList[id];
+			ChangedField changedField { field.type, generation, Variant(), std::string(), 0, Variant() };
+			if(field.type == ChangedFieldType::index) {
+				changedField.index = (std::size_t)field.number;
+			}
+			else if(field.text != nullptr) {
+				changedField.key = Variant::create<std::string>(*field.text);
+			}
+			else {
+				changedField.key = Variant::create<long long>(field.number);
+			}
+			result.push_back(std::move(changedField));
+		}
+	);
+	// Both lists are in the descending order of the generations.
+	std::inplace_merge(
+		result.begin() + firstIndex,
+		result.begin() + elementIndex,
+		result.end(),
+		[](const ChangedField & a, const ChangedField & b) {
+			return a.generation > b.generation;
+		}
+	);
+}
+
+std::uint32_t getElementFieldId(TrackedInstance * instance, const ChangedFieldType type, const long long number)
+{
+	auto it = instance->numberElementMap.find(number);
+	if(it != instance->numberElementMap.end()) {
+		return it->second;
+	}
+	const std::uint32_t id = (std::uint32_t)instance->elementFieldList.size();
+	instance->numberElementMap[number] = id;
+	instance->elementFieldList.push_back(ElementField { type, number, nullptr });
+	return id;
+}
+
+std::uint32_t getElementFieldId(TrackedInstance * instance, const std::string & text)
+{
+	auto it = instance->textElementMap.find(text);
+	if(it != instance->textElementMap.end()) {
+		return it->second;
+	}
+	const std::uint32_t id = (std::uint32_t)instance->elementFieldList.size();
+	it = instance->textElementMap.insert(std::make_pair(text, id)).first;
+	instance->elementFieldList.push_back(ElementField { ChangedFieldType::key, 0, &it->first });
+	return id;
+}
+
+} // namespace
+
+void recordAccessibleChange(const Variant & accessible, const Variant & instance)
+{
+	const auto pointerAndType = getPointerAndType(instance);
+	if(! isAddressMaybeTracked(pointerAndType.first)) {
+		return;
+	}
+	ChangeTrackerState & state = getChangeTrackerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	TrackedInstance * trackedInstance = findTrackedInstance(state, pointerAndType);
+	if(trackedInstance != nullptr) {
+		const std::uint32_t id = getClassFieldId(trackedInstance->classFieldTable, accessible);
+		trackedInstance->accessibleChangeList.touch(id, nextGeneration(state, trackedInstance));
+	}
+}
+
+void recordIndexableChange(const Variant & indexable, const std::size_t index)
+{
+	const auto pointerAndType = getPointerAndType(indexable);
+	if(! isAddressMaybeTracked(pointerAndType.first)) {
+		return;
+	}
+	ChangeTrackerState & state = getChangeTrackerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	TrackedInstance * trackedInstance = findTrackedInstance(state, pointerAndType);
+	if(trackedInstance != nullptr) {
+		const std::uint32_t id = getElementFieldId(trackedInstance, ChangedFieldType::index, (long long)index);
+		trackedInstance->elementChangeList.touch(id, nextGeneration(state, trackedInstance));
+	}
+}
+
+void recordMappableChange(const Variant & mappable, const Variant & key)
+{
+	const auto pointerAndType = getPointerAndType(mappable);
+	if(! isAddressMaybeTracked(pointerAndType.first)) {
+		return;
+	}
+	ChangeTrackerState & state = getChangeTrackerState();
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if(findTrackedInstance(state, pointerAndType) == nullptr) {
+			return;
+		}
+	}
+
+	// Cast the key without holding the lock.
+	const MetaType * keyType = getNonReferenceMetaType(key);
+	const bool isNumber = (keyType->isIntegral() || keyType->isEnum());
+	long long number = 0;
+	std::string text;
+	if(isNumber) {
+		number = key.cast<long long>().get<long long>();
+	}
+	else if(key.canCast<std::string>()) {
+		text = key.cast<std::string>().get<const std::string &>();
+	}
+	else {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(state.mutex);
+	// The instance may be untracked when the lock is released.
+	TrackedInstance * trackedInstance = findTrackedInstance(state, pointerAndType);
+	if(trackedInstance != nullptr) {
+		const std::uint32_t id = isNumber
+			? getElementFieldId(trackedInstance, ChangedFieldType::key, number)
+			: getElementFieldId(trackedInstance, text)
+		;
+		trackedInstance->elementChangeList.touch(id, nextGeneration(state, trackedInstance));
+	}
+}
+
+} // namespace internal_
+
+void ChangeTracker::track(const Variant & instance)
+{
+	const auto pointerAndType = getPointerAndType(instance);
+	if(pointerAndType.first == nullptr) {
+		raiseException<IllegalArgumentException>("ChangeTracker can't track nullptr");
+	}
+	internal_::ChangeTrackerState & state = internal_::getChangeTrackerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	if(internal_::findTrackedInstance(state, pointerAndType) != nullptr) {
+		return;
+	}
+	std::unique_ptr<internal_::TrackedInstance> trackedInstance(new internal_::TrackedInstance());
+	trackedInstance->address = pointerAndType.first;
+	trackedInstance->metaType = pointerAndType.second;
+	trackedInstance->classFieldTable = internal_::getClassFieldTable(state, pointerAndType.second);
+	if(state.freeInstanceIdList.empty()) {
+		trackedInstance->id = (std::uint32_t)state.instanceList.size();
+		state.instanceList.push_back(trackedInstance.get());
+	}
+	else {
+		trackedInstance->id = state.freeInstanceIdList.back();
+		state.freeInstanceIdList.pop_back();
+		state.instanceList[trackedInstance->id] = trackedInstance.get();
+	}
+	state.instanceMap.emplace(pointerAndType.first, std::move(trackedInstance));
+	internal_::getAddressFilterSlot(pointerAndType.first).fetch_add(1, std::memory_order_relaxed);
+	internal_::trackedInstanceCount.store(state.instanceMap.size(), std::memory_order_relaxed);
+}
+
+void ChangeTracker::untrack(const Variant & instance)
+{
+	const auto pointerAndType = getPointerAndType(instance);
+	internal_::ChangeTrackerState & state = internal_::getChangeTrackerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	const auto range = state.instanceMap.equal_range(pointerAndType.first);
+	for(auto it = range.first; it != range.second; ++it) {
+		if(it->second->metaType->equal(pointerAndType.second)) {
+			const std::uint32_t id = it->second->id;
+			state.instanceChangeList.remove(id);
+			state.instanceList[id] = nullptr;
+			state.freeInstanceIdList.push_back(id);
+			state.instanceMap.erase(it);
+			internal_::getAddressFilterSlot(pointerAndType.first).fetch_sub(1, std::memory_order_relaxed);
+			break;
+		}
+	}
+	internal_::trackedInstanceCount.store(state.instanceMap.size(), std::memory_order_relaxed);
+}
+
+bool ChangeTracker::isTracked(const Variant & instance)
+{
+	const auto pointerAndType = getPointerAndType(instance);
+	internal_::ChangeTrackerState & state = internal_::getChangeTrackerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	return internal_::findTrackedInstance(state, pointerAndType) != nullptr;
+}
+
+std::size_t ChangeTracker::getTrackedCount()
+{
+	internal_::ChangeTrackerState & state = internal_::getChangeTrackerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	return state.instanceMap.size();
+}
+
+std::uint64_t ChangeTracker::getGeneration()
+{
+	internal_::ChangeTrackerState & state = internal_::getChangeTrackerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	return state.generation;
+}
+
+std::uint64_t ChangeTracker::getGeneration(const Variant & instance)
+{
+	const auto pointerAndType = getPointerAndType(instance);
+	internal_::ChangeTrackerState & state = internal_::getChangeTrackerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	const internal_::TrackedInstance * trackedInstance = internal_::findTrackedInstance(state, pointerAndType);
+	if(trackedInstance == nullptr) {
+		return 0;
+	}
+	return std::max(
+		trackedInstance->accessibleChangeList.getLatestGeneration(),
+		trackedInstance->elementChangeList.getLatestGeneration()
+	);
+}
+
+std::vector<ChangedField> ChangeTracker::getChangedFields(const Variant & instance, const std::uint64_t sinceGeneration)
+{
+	std::vector<ChangedField> result;
+	const auto pointerAndType = getPointerAndType(instance);
+	internal_::ChangeTrackerState & state = internal_::getChangeTrackerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	const internal_::TrackedInstance * trackedInstance = internal_::findTrackedInstance(state, pointerAndType);
+	if(trackedInstance != nullptr) {
+		internal_::collectChangedFields(result, trackedInstance, sinceGeneration);
+	}
+	return result;
+}
+
+std::vector<ChangedInstance> ChangeTracker::getChangedInstances(const std::uint64_t sinceGeneration)
+{
+	std::vector<ChangedInstance> result;
+	internal_::ChangeTrackerState & state = internal_::getChangeTrackerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.instanceChangeList.forEachSince(
+		sinceGeneration,
+		[&result, &state, sinceGeneration](const std::uint32_t id, const std::uint64_t generation) {
+			const internal_::TrackedInstance * trackedInstance = state.instanceList[id];
+			result.push_back(ChangedInstance { trackedInstance->address, trackedInstance->metaType, generation, {} });
+			internal_::collectChangedFields(result.back().fieldList, trackedInstance, sinceGeneration);
+		}
+	);
+	return result;
+}
+
+void ChangeTracker::markChanged(const Variant & instance, const Variant & accessible)
+{
+	internal_::recordAccessibleChange(accessible, instance);
+}
+
+
+} // namespace metapp
@@ -0,0 +1,384 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/utilities/dynamicobject.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/interfaces/metamappable.h"
+#include "metapp/allmetatypes.h"
+
+#include <map>
+#include <mutex>
+#include <algorithm>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+// Above this count, DynamicShape::findSlot uses binary search instead of linear search.
+constexpr std::size_t linearSearchPropertyCount = 8;
+
+std::atomic<std::uint32_t> nextDynamicShapeId(1);
+
+// A Variant which holds a Variant is unwrapped, so the slot holds the value directly.
+const Variant & getDynamicSlotValue(const Variant & value)
+{
+	if(getNonReferenceMetaType(value)->getTypeKind() == tkVariant) {
+		return value.get<const Variant &>();
+	}
+	return value;
+}
+
+const MetaType * dynamicObjectGetValueType(const Variant & /*mappable*/)
+{
+	return getMetaType<Variant>();
+}
+
+Variant dynamicObjectGet(const Variant & mappable, const Variant & key)
+{
+	return mappable.get<const DynamicObject &>().get(key.cast<const std::string &>().get<const std::string &>());
+}
+
+void dynamicObjectSet(const Variant & mappable, const Variant & key, const Variant & value)
+{
+	requireMutable(mappable);
+	mappable.get<DynamicObject &>().set(key.cast<const std::string &>().get<const std::string &>(), value);
+}
+
+void dynamicObjectForEach(const Variant & mappable, const MetaMappable::Callback & callback)
+{
+	DynamicObject & object = mappable.get<DynamicObject &>();
+	const DynamicShape * shape = object.getShape();
+	for(std::size_t i = 0; i < object.getPropertyCount(); ++i) {
+		if(! callback(Variant::reference(shape->getPropertyName(i)), Variant::reference(object.getSlot(i)))) {
+			break;
+		}
+	}
+}
+
+const MetaType * dynamicPropertyGetValueType(const Variant & /*accessible*/)
+{
+	return getMetaType<Variant>();
+}
+
+bool dynamicPropertyIsReadOnly(const Variant & /*accessible*/)
+{
+	return false;
+}
+
+const MetaType * dynamicPropertyGetClassType(const Variant & /*accessible*/)
+{
+	return getMetaType<DynamicObject>();
+}
+
+Variant dynamicPropertyGet(const Variant & accessible, const Variant & instance)
+{
+	const DynamicObject * object = static_cast<const DynamicObject *>(getPointer(instance));
+	return accessible.get<const DynamicProperty &>().getCache().get(*object);
+}
+
+void dynamicPropertySet(const Variant & accessible, const Variant & instance, const Variant & value)
+{
+	requireMutable(instance);
+	DynamicObject * object = static_cast<DynamicObject *>(getPointer(instance));
+	accessible.get<const DynamicProperty &>().getCache().set(*object, value);
+}
+
+} // namespace
+
+} // namespace internal_
+
+constexpr std::size_t DynamicShape::npos;
+constexpr std::size_t DynamicPropertyCache::entryCount;
+constexpr std::uint32_t DynamicPropertyCache::invalidSlot;
+
+struct DynamicShape::Transition
+{
+	std::mutex mutex;
+	std::map<std::string, std::unique_ptr<DynamicShape> > childMap;
+};
+
+struct DynamicShape::Lookup
+{
+	// The names by slot, they point to the names in the shapes of the chain.
+	std::vector<const std::string *> nameList;
+	// Only used if there are many properties, otherwise the chain is searched linearly.
+	std::vector<std::pair<const std::string *, std::size_t> > sortedSlotList;
+};
+
+const DynamicShape * DynamicShape::getRoot()
+{
+	static const DynamicShape root(nullptr, std::string());
+	return &root;
+}
+
+DynamicShape::DynamicShape(const DynamicShape * parent, const std::string & name)
+	:
+		id(internal_::nextDynamicShapeId.fetch_add(1, std::memory_order_relaxed)),
+		parent(parent),
+		name(name),
+		propertyCount(parent == nullptr ? 0 : parent->propertyCount + 1),
+		lookup(nullptr),
+		transition(new Transition())
+{
+}
+
+DynamicShape::~DynamicShape()
+{
+	delete lookup.load(std::memory_order_acquire);
+}
+
+const DynamicShape::Lookup * DynamicShape::getLookup() const
+{
+	const Lookup * result = lookup.load(std::memory_order_acquire);
+	if(result != nullptr) {
+		return result;
+	}
+	std::unique_ptr<Lookup> newLookup(new Lookup());
+	newLookup->nameList.resize(propertyCount);
+	for(const DynamicShape * shape = this; shape->parent != nullptr; shape = shape->parent) {
+		newLookup->nameList[shape->propertyCount - 1] = &shape->name;
+	}
+	if(propertyCount > internal_::linearSearchPropertyCount) {
+		newLookup->sortedSlotList.reserve(propertyCount);
+		for(std::size_t i = 0; i < propertyCount; ++i) {
+			newLookup->sortedSlotList.push_back(std::make_pair(newLookup->nameList[i], i));
+		}
+		std::sort(
+			newLookup->sortedSlotList.begin(),
+			newLookup->sortedSlotList.end(),
+			[](const std::pair<const std::string *, std::size_t> & a, const std::pair<const std::string *, std::size_t> & b) {
+				return *a.first < *b.first;
+			}
+		);
+	}
+	// Another thread may build the lookup at the same time, the first one wins.
+	if(lookup.compare_exchange_strong(result, newLookup.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+		return newLookup.release();
+	}
+	return result;
+}
+
+bool DynamicShape::hasPropertyInChain(const std::string & name) const
+{
+	for(const DynamicShape * shape = this; shape->parent != nullptr; shape = shape->parent) {
+		if(shape->name == name) {
+			return true;
+		}
+	}
+	return false;
+}
+
+const std::string & DynamicShape::getPropertyName(const std::size_t slot) const
+{
+	return *getLookup()->nameList[slot];
+}
+
+std::size_t DynamicShape::findSlot(const std::string & name) const
+{
+	if(propertyCount <= internal_::linearSearchPropertyCount) {
+		for(const DynamicShape * shape = this; shape->parent != nullptr; shape = shape->parent) {
+			if(shape->name == name) {
+				return shape->propertyCount - 1;
+			}
+		}
+		return npos;
+	}
+	const Lookup * currentLookup = getLookup();
+	auto it = std::lower_bound(
+		currentLookup->sortedSlotList.begin(),
+		currentLookup->sortedSlotList.end(),
+		name,
+		[](const std::pair<const std::string *, std::size_t> & item, const std::string & name) {
+			return *item.first < name;
+		}
+	);
+	if(it != currentLookup->sortedSlotList.end() && *it->first == name) {
+		return it->second;
+	}
+	return npos;
+}
+
+const DynamicShape * DynamicShape::addProperty(const std::string & name) const
+{
+	if(propertyCount <= internal_::linearSearchPropertyCount || lookup.load(std::memory_order_acquire) != nullptr) {
+		if(findSlot(name) != npos) {
+			return this;
+		}
+	}
+	{
+		// The children only have the names not in this shape, so an existing child doesn't need the lookup.
+		std::lock_guard<std::mutex> lock(transition->mutex);
+		auto it = transition->childMap.find(name);
+		if(it != transition->childMap.end()) {
+			return it->second.get();
+		}
+	}
+	// Walk the chain instead of findSlot, so adding properties doesn't build the lookup of the passed shapes.
+	if(hasPropertyInChain(name)) {
+		return this;
+	}
+	std::lock_guard<std::mutex> lock(transition->mutex);
+	std::unique_ptr<DynamicShape> & child = transition->childMap[name];
+	if(! child) {
+		child.reset(new DynamicShape(this, name));
+	}
+	return child.get();
+}
+
+const DynamicShape * DynamicShape::removeProperty(const std::string & name) const
+{
+	if(findSlot(name) == npos) {
+		return this;
+	}
+	// Rebuild from the root, so the objects removing the same property from the same shape share the result.
+	const DynamicShape * result = getRoot();
+	for(const std::string * propertyName : getLookup()->nameList) {
+		if(*propertyName != name) {
+			result = result->addProperty(*propertyName);
+		}
+	}
+	return result;
+}
+
+DynamicObject::DynamicObject()
+	: DynamicObject(DynamicShape::getRoot())
+{
+}
+
+DynamicObject::DynamicObject(const DynamicShape * shape)
+	: shape(shape), slotList(shape->getPropertyCount())
+{
+}
+
+const Variant * DynamicObject::find(const std::string & name) const
+{
+	const std::size_t slot = shape->findSlot(name);
+	return slot == DynamicShape::npos ? nullptr : &slotList[slot];
+}
+
+Variant * DynamicObject::find(const std::string & name)
+{
+	const std::size_t slot = shape->findSlot(name);
+	return slot == DynamicShape::npos ? nullptr : &slotList[slot];
+}
+
+Variant DynamicObject::get(const std::string & name) const
+{
+	const Variant * value = find(name);
+	return value == nullptr ? Variant() : Variant::reference(*value);
+}
+
+void DynamicObject::set(const std::string & name, const Variant & value)
+{
+	// addProperty first, so adding properties to a new object doesn't build the lookup of the passed shapes.
+	const DynamicShape * newShape = shape->addProperty(name);
+	if(newShape != shape) {
+		// value may refer to a slot in this object, copy it before the slots are reallocated.
+		Variant newValue = internal_::getDynamicSlotValue(value);
+		transitionTo(newShape);
+		slotList.back() = std::move(newValue);
+	}
+	else {
+		*find(name) = internal_::getDynamicSlotValue(value);
+	}
+}
+
+bool DynamicObject::remove(const std::string & name)
+{
+	const std::size_t slot = shape->findSlot(name);
+	if(slot == DynamicShape::npos) {
+		return false;
+	}
+	slotList.erase(slotList.begin() + slot);
+	shape = shape->removeProperty(name);
+	return true;
+}
+
+void DynamicObject::transitionTo(const DynamicShape * newShape)
+{
+	shape = newShape;
+	slotList.resize(newShape->getPropertyCount());
+}
+
+DynamicPropertyCache::DynamicPropertyCache(std::string name)
+	: name(std::move(name)), entryList(), nextEntry(0)
+{
+	for(auto & entry : entryList) {
+		entry.store(0, std::memory_order_relaxed);
+	}
+}
+
+Variant DynamicPropertyCache::get(const DynamicObject & object) const
+{
+	const Variant * value = find(object);
+	return value == nullptr ? Variant() : Variant::reference(*value);
+}
+
+void DynamicPropertyCache::set(DynamicObject & object, const Variant & value) const
+{
+	Variant * slotValue = find(object);
+	if(slotValue == nullptr) {
+		object.set(name, value);
+	}
+	else {
+		*slotValue = internal_::getDynamicSlotValue(value);
+	}
+}
+
+std::size_t DynamicPropertyCache::doFindSlot(const DynamicShape * shape) const
+{
+	const std::size_t slot = shape->findSlot(name);
+	const std::uint64_t value = ((std::uint64_t)shape->getId() << 32)
+		| (slot == DynamicShape::npos ? invalidSlot : (std::uint32_t)slot);
+	// Replace the entries in round robin, a racing thread may overwrite an entry, it only causes a cache miss.
+	const std::uint32_t index = nextEntry.fetch_add(1, std::memory_order_relaxed) % entryCount;
+	entryList[index].store(value, std::memory_order_relaxed);
+	return slot;
+}
+
+DynamicProperty::DynamicProperty(std::string name)
+	: cache(std::make_shared<DynamicPropertyCache>(std::move(name)))
+{
+}
+
+const MetaMappable * DeclareMetaType<DynamicObject>::getMetaMappable()
+{
+	static const MetaMappable metaMappable(
+		&internal_::dynamicObjectGetValueType,
+		&internal_::dynamicObjectGet,
+		&internal_::dynamicObjectSet,
+		&internal_::dynamicObjectForEach
+	);
+	return &metaMappable;
+}
+
+const MetaAccessible * DeclareMetaType<DynamicProperty>::getMetaAccessible()
+{
+	static const MetaAccessible metaAccessible(
+		&internal_::dynamicPropertyGetValueType,
+		&internal_::dynamicPropertyIsReadOnly,
+		&internal_::dynamicPropertyGetClassType,
+		&internal_::dynamicPropertyGet,
+		&internal_::dynamicPropertySet
+	);
+	return &metaAccessible;
+}
+
+
+} // namespace metapp
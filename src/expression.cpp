@@ -0,0 +1,2167 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "metapp/utilities/expression.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/interfaces/metacallable.h"
+#include "metapp/interfaces/metaindexable.h"
+#include "metapp/interfaces/metaenum.h"
+#include "metapp/variantref.h"
+#include "metapp/metarepo.h"
+#include "metapp/allmetatypes.h"
+
+#include <atomic>
+#include <mutex>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+enum class ExpressionOperator : std::uint8_t
+{
+	none,
+	logicalOr,
+	logicalAnd,
+	equal,
+	notEqual,
+	less,
+	lessEqual,
+	greater,
+	greaterEqual,
+	add,
+	subtract,
+	multiply,
+	divide,
+	modulo,
+	logicalNot,
+	negate
+};
+
+enum class NodeType
+{
+	literal,
+	enumValue,
+	member,
+	call,
+	unary,
+	binary
+};
+
+struct ExpressionNode
+{
+	NodeType type;
+	// The position in the source, for the error messages.
+	std::size_t position;
+	ExpressionOperator op;
+	// The value of literal.
+	Variant value;
+	// The name of member and call.
+	std::string name;
+	// The qualified name of enum value, such as {"Tier", "Gold"}.
+	std::vector<std::string> path;
+	// The object of member and call, nullptr for the root object.
+	std::unique_ptr<ExpressionNode> object;
+	// The arguments of call, the operand of unary, the left and right operands of binary.
+	std::vector<std::unique_ptr<ExpressionNode> > children;
+};
+
+using NodePointer = std::unique_ptr<ExpressionNode>;
+
+void raiseSyntaxError(const std::string & message, const std::size_t position)
+{
+	raiseException<IllegalArgumentException>("Expression syntax error at " + std::to_string(position) + ": " + message);
+}
+
+class ExpressionParser
+{
+public:
+	explicit ExpressionParser(const std::string & source)
+		: source(source), position(0)
+	{
+	}
+
+	NodePointer parse() {
+		NodePointer node = parseBinary(1);
+		skipSpaces();
+		if(position < source.size()) {
+			raiseSyntaxError("unexpected character", position);
+		}
+		return node;
+	}
+
+private:
+	// Precedence climbing, the operators with precedence less than minPrecedence are left to the caller.
+	NodePointer parseBinary(const int minPrecedence) {
+		NodePointer left = parseUnary();
+		for(;;) {
+			skipSpaces();
+			std::size_t length = 0;
+			const ExpressionOperator op = peekBinaryOperator(&length);
+			const int precedence = getPrecedence(op);
+			if(op == ExpressionOperator::none || precedence < minPrecedence) {
+				break;
+			}
+			const std::size_t operatorPosition = position;
+			position += length;
+			NodePointer right = parseBinary(precedence + 1);
+			NodePointer node = makeNode(NodeType::binary, operatorPosition);
+			node->op = op;
+			node->children.push_back(std::move(left));
+			node->children.push_back(std::move(right));
+			left = std::move(node);
+		}
+		return left;
+	}
+
+	NodePointer parseUnary() {
+		skipSpaces();
+		if(position < source.size()
+			&& (source[position] == '-' || (source[position] == '!' && peekChar(1) != '='))) {
+			NodePointer node = makeNode(NodeType::unary, position);
+			node->op = (source[position] == '-' ? ExpressionOperator::negate : ExpressionOperator::logicalNot);
+			++position;
+			node->children.push_back(parseUnary());
+			return node;
+		}
+		return parsePostfix(parsePrimary());
+	}
+
+	NodePointer parsePostfix(NodePointer node) {
+		for(;;) {
+			skipSpaces();
+			if(position >= source.size() || source[position] != '.') {
+				return node;
+			}
+			++position;
+			skipSpaces();
+			const std::size_t namePosition = position;
+			NodePointer member = parseMember(readIdentifier(), namePosition);
+			member->object = std::move(node);
+			node = std::move(member);
+		}
+	}
+
+	NodePointer parsePrimary() {
+		skipSpaces();
+		if(position >= source.size()) {
+			raiseSyntaxError("unexpected end", position);
+			return NodePointer();
+		}
+		const char c = source[position];
+		if(c == '(') {
+			++position;
+			NodePointer node = parseBinary(1);
+			expect(')');
+			return node;
+		}
+		if(isDigit(c) || (c == '.' && isDigit(peekChar(1)))) {
+			return parseNumber();
+		}
+		if(c == '"') {
+			return parseString();
+		}
+		const std::size_t namePosition = position;
+		const std::string name = readIdentifier();
+		if(name == "true" || name == "false") {
+			NodePointer node = makeNode(NodeType::literal, namePosition);
+			node->value = (name == "true");
+			return node;
+		}
+		skipSpaces();
+		if(source.compare(position, 2, "::") == 0) {
+			NodePointer node = makeNode(NodeType::enumValue, namePosition);
+			node->path.push_back(name);
+			while(source.compare(position, 2, "::") == 0) {
+				position += 2;
+				skipSpaces();
+				node->path.push_back(readIdentifier());
+				skipSpaces();
+			}
+			return node;
+		}
+		return parseMember(name, namePosition);
+	}
+
+	// A member or a call, the object is set by the caller.
+	NodePointer parseMember(const std::string & name, const std::size_t namePosition) {
+		skipSpaces();
+		if(position >= source.size() || source[position] != '(') {
+			NodePointer node = makeNode(NodeType::member, namePosition);
+			node->name = name;
+			return node;
+		}
+		++position;
+		NodePointer node = makeNode(NodeType::call, namePosition);
+		node->name = name;
+		skipSpaces();
+		if(position < source.size() && source[position] == ')') {
+			++position;
+			return node;
+		}
+		for(;;) {
+			node->children.push_back(parseBinary(1));
+			skipSpaces();
+			if(position < source.size() && source[position] == ',') {
+				++position;
+				continue;
+			}
+			expect(')');
+			return node;
+		}
+	}
+
+	NodePointer parseNumber() {
+		const std::size_t start = position;
+		bool isReal = false;
+		while(position < source.size()) {
+			const char c = source[position];
+			if(isDigit(c)) {
+				++position;
+			}
+			else if(c == '.') {
+				isReal = true;
+				++position;
+			}
+			else if(c == 'e' || c == 'E') {
+				isReal = true;
+				++position;
+				if(position < source.size() && (source[position] == '+' || source[position] == '-')) {
+					++position;
+				}
+			}
+			else {
+				break;
+			}
+		}
+		const std::string text = source.substr(start, position - start);
+		NodePointer node = makeNode(NodeType::literal, start);
+		char * end = nullptr;
+		if(isReal) {
+			node->value = std::strtod(text.c_str(), &end);
+		}
+		else {
+			node->value = (long long)std::strtoll(text.c_str(), &end, 10);
+		}
+		if(end != text.c_str() + text.size()) {
+			raiseSyntaxError("invalid number " + text, start);
+		}
+		return node;
+	}
+
+	NodePointer parseString() {
+		const std::size_t start = position;
+		++position;
+		std::string text;
+		for(;;) {
+			if(position >= source.size()) {
+				raiseSyntaxError("unterminated string", start);
+				return NodePointer();
+			}
+			char c = source[position++];
+			if(c == '"') {
+				break;
+			}
+			if(c == '\\' && position < source.size()) {
+				c = source[position++];
+				if(c == 'n') {
+					c = '\n';
+				}
+				else if(c == 't') {
+					c = '\t';
+				}
+			}
+			text.push_back(c);
+		}
+		NodePointer node = makeNode(NodeType::literal, start);
+		node->value = text;
+		return node;
+	}
+
+	std::string readIdentifier() {
+		const std::size_t start = position;
+		while(position < source.size()
+			&& (isDigit(source[position]) || source[position] == '_'
+				|| (source[position] >= 'a' && source[position] <= 'z') || (source[position] >= 'A' && source[position] <= 'Z'))) {
+			++position;
+		}
+		if(position == start || isDigit(source[start])) {
+			raiseSyntaxError("expect identifier", start);
+		}
+		return source.substr(start, position - start);
+	}
+
+	ExpressionOperator peekBinaryOperator(std::size_t * length) const {
+		*length = 2;
+		const char c = (position < source.size() ? source[position] : 0);
+		const char next = peekChar(1);
+		switch(c) {
+		case '|':
+			return next == '|' ? ExpressionOperator::logicalOr : ExpressionOperator::none;
+		case '&':
+			return next == '&' ? ExpressionOperator::logicalAnd : ExpressionOperator::none;
+		case '=':
+			return next == '=' ? ExpressionOperator::equal : ExpressionOperator::none;
+		case '!':
+			return next == '=' ? ExpressionOperator::notEqual : ExpressionOperator::none;
+		case '<':
+			if(next == '=') {
+				return ExpressionOperator::lessEqual;
+			}
+			*length = 1;
+			return ExpressionOperator::less;
+		case '>':
+			if(next == '=') {
+				return ExpressionOperator::greaterEqual;
+			}
+			*length = 1;
+			return ExpressionOperator::greater;
+		default:
+			break;
+		}
+		*length = 1;
+		switch(c) {
+		case '+':
+			return ExpressionOperator::add;
+		case '-':
+			return ExpressionOperator::subtract;
+		case '*':
+			return ExpressionOperator::multiply;
+		case '/':
+			return ExpressionOperator::divide;
+		case '%':
+			return ExpressionOperator::modulo;
+		default:
+			return ExpressionOperator::none;
+		}
+	}
+
+	static int getPrecedence(const ExpressionOperator op) {
+		switch(op) {
+		case ExpressionOperator::logicalOr:
+			return 1;
+		case ExpressionOperator::logicalAnd:
+			return 2;
+		case ExpressionOperator::equal:
+		case ExpressionOperator::notEqual:
+			return 3;
+		case ExpressionOperator::less:
+		case ExpressionOperator::lessEqual:
+		case ExpressionOperator::greater:
+		case ExpressionOperator::greaterEqual:
+			return 4;
+		case ExpressionOperator::add:
+		case ExpressionOperator::subtract:
+			return 5;
+		case ExpressionOperator::multiply:
+		case ExpressionOperator::divide:
+		case ExpressionOperator::modulo:
+			return 6;
+		default:
+			return 0;
+		}
+	}
+
+	void expect(const char c) {
+		skipSpaces();
+		if(position >= source.size() || source[position] != c) {
+			raiseSyntaxError(std::string("expect ") + c, position);
+		}
+		++position;
+	}
+
+	void skipSpaces() {
+		while(position < source.size()
+			&& (source[position] == ' ' || source[position] == '\t' || source[position] == '\r' || source[position] == '\n')) {
+			++position;
+		}
+	}
+
+	char peekChar(const std::size_t offset) const {
+		return position + offset < source.size() ? source[position + offset] : 0;
+	}
+
+	static bool isDigit(const char c) {
+		return c >= '0' && c <= '9';
+	}
+
+	static NodePointer makeNode(const NodeType type, const std::size_t position) {
+		NodePointer node(new ExpressionNode());
+		node->type = type;
+		node->position = position;
+		node->op = ExpressionOperator::none;
+		return node;
+	}
+
+private:
+	const std::string & source;
+	std::size_t position;
+};
+
+// How a value is stored in a register.
+enum class ValueKind : std::uint8_t
+{
+	boolean,
+	integer,
+	real,
+	string,
+	// Any type other than the above. The object is at the address in the register.
+	object,
+	// The type is not known when compiling, the value is in a Variant.
+	variant
+};
+
+// A register. The objects and the variants are referred by the register, they are not copied.
+struct ExpressionSlot
+{
+	union {
+		bool boolean;
+		long long integer;
+		double real;
+		const std::string * string;
+		void * object;
+	};
+	// For objects, the reference or pointer type which refers to the object, to make the instance Variant.
+	// Not used if holder is not nullptr.
+	const MetaType * instanceType;
+	// The Variant which holds the object or the value, such as the root, or the value returned by a call.
+	const Variant * holder;
+};
+
+using ValueReader = void (*)(const void * address, ExpressionSlot & slot);
+
+template <typename T>
+void readInteger(const void * address, ExpressionSlot & slot)
+{
+	slot.integer = (long long)*static_cast<const T *>(address);
+}
+
+template <typename T>
+void readReal(const void * address, ExpressionSlot & slot)
+{
+	slot.real = (double)*static_cast<const T *>(address);
+}
+
+void readBoolean(const void * address, ExpressionSlot & slot)
+{
+	slot.boolean = *static_cast<const bool *>(address);
+}
+
+void readString(const void * address, ExpressionSlot & slot)
+{
+	slot.string = static_cast<const std::string *>(address);
+}
+
+void readObject(const void * address, ExpressionSlot & slot)
+{
+	slot.object = const_cast<void *>(address);
+}
+
+void readPointer(const void * address, ExpressionSlot & slot)
+{
+	slot.object = *static_cast<void * const *>(address);
+}
+
+void readVariant(const void * address, ExpressionSlot & slot)
+{
+	slot.holder = static_cast<const Variant *>(address);
+}
+
+void readNothing(const void * /*address*/, ExpressionSlot & /*slot*/)
+{
+}
+
+// The static type of a value.
+struct ValueInfo
+{
+	ValueKind kind;
+	ValueReader reader;
+	// For objects, the non reference type of the object.
+	const MetaType * objectType;
+	// For the objects which are referred by pointers, the pointer type.
+	const MetaType * pointerType;
+};
+
+ValueInfo makeValueInfo(const ValueKind kind, const ValueReader reader)
+{
+	return ValueInfo { kind, reader, nullptr, nullptr };
+}
+
+// metaType is not a reference.
+ValueInfo getValueInfo(const MetaType * metaType)
+{
+	switch(metaType->getTypeKind()) {
+	case tkBool:
+		return makeValueInfo(ValueKind::boolean, &readBoolean);
+	case tkChar:
+		return makeValueInfo(ValueKind::integer, &readInteger<char>);
+	case tkWideChar:
+		return makeValueInfo(ValueKind::integer, &readInteger<wchar_t>);
+	case tkChar8:
+		return makeValueInfo(ValueKind::integer, &readInteger<unsigned char>);
+	case tkChar16:
+		return makeValueInfo(ValueKind::integer, &readInteger<char16_t>);
+	case tkChar32:
+		return makeValueInfo(ValueKind::integer, &readInteger<char32_t>);
+	case tkSignedChar:
+		return makeValueInfo(ValueKind::integer, &readInteger<signed char>);
+	case tkUnsignedChar:
+		return makeValueInfo(ValueKind::integer, &readInteger<unsigned char>);
+	case tkShort:
+		return makeValueInfo(ValueKind::integer, &readInteger<short>);
+	case tkUnsignedShort:
+		return makeValueInfo(ValueKind::integer, &readInteger<unsigned short>);
+	case tkInt:
+		return makeValueInfo(ValueKind::integer, &readInteger<int>);
+	case tkUnsignedInt:
+		return makeValueInfo(ValueKind::integer, &readInteger<unsigned int>);
+	case tkLong:
+		return makeValueInfo(ValueKind::integer, &readInteger<long>);
+	case tkUnsignedLong:
+		return makeValueInfo(ValueKind::integer, &readInteger<unsigned long>);
+	case tkLongLong:
+		return makeValueInfo(ValueKind::integer, &readInteger<long long>);
+	case tkUnsignedLongLong:
+		return makeValueInfo(ValueKind::integer, &readInteger<unsigned long long>);
+	case tkFloat:
+		return makeValueInfo(ValueKind::real, &readReal<float>);
+	case tkDouble:
+		return makeValueInfo(ValueKind::real, &readReal<double>);
+	case tkLongDouble:
+		return makeValueInfo(ValueKind::real, &readReal<long double>);
+	case tkEnum:
+		// The enum is read as its underlying type.
+		return getValueInfo(metaType->getUpType());
+	case tkStdString:
+		return makeValueInfo(ValueKind::string, &readString);
+	case tkVariant:
+		return makeValueInfo(ValueKind::variant, &readVariant);
+	case tkVoid:
+		return makeValueInfo(ValueKind::variant, &readNothing);
+	case tkPointer:
+		return ValueInfo { ValueKind::object, &readPointer, metaType->getUpType(), metaType };
+	default:
+		return ValueInfo { ValueKind::object, &readObject, metaType, nullptr };
+	}
+}
+
+// The values in Variant are classified the same way, the objects include pointers.
+ValueKind getVariantKind(const Variant & value)
+{
+	const ValueKind kind = getValueInfo(getNonReferenceMetaType(value)).kind;
+	return kind == ValueKind::variant ? ValueKind::object : kind;
+}
+
+// Returns the Variant inside var if var holds a Variant.
+const Variant & unwrapVariant(const Variant & var)
+{
+	const Variant * result = &var;
+	while(getNonReferenceMetaType(*result)->getTypeKind() == tkVariant) {
+		result = &result->get<const Variant &>();
+	}
+	return *result;
+}
+
+const char * getKindName(const ValueKind kind)
+{
+	switch(kind) {
+	case ValueKind::boolean:
+		return "bool";
+	case ValueKind::integer:
+		return "integer";
+	case ValueKind::real:
+		return "floating point";
+	case ValueKind::string:
+		return "string";
+	default:
+		return "object";
+	}
+}
+
+void raiseUnsupportedOperand(const ValueKind kind)
+{
+	raiseException<UnsupportedException>(std::string("Expression operator doesn't support ") + getKindName(kind));
+}
+
+void raiseNullObject(const std::string & name)
+{
+	raiseException<IllegalArgumentException>("Expression accesses member " + name + " of nullptr");
+}
+
+// The arithmetic and comparisons, shared by the bytecode and the interpreter.
+// The integers wrap around on overflow instead of undefined behavior.
+
+long long addInteger(const long long a, const long long b)
+{
+	return (long long)((unsigned long long)a + (unsigned long long)b);
+}
+
+long long subtractInteger(const long long a, const long long b)
+{
+	return (long long)((unsigned long long)a - (unsigned long long)b);
+}
+
+long long multiplyInteger(const long long a, const long long b)
+{
+	return (long long)((unsigned long long)a * (unsigned long long)b);
+}
+
+long long negateInteger(const long long a)
+{
+	return (long long)(0ULL - (unsigned long long)a);
+}
+
+long long divideInteger(const long long a, const long long b)
+{
+	if(b == 0) {
+		raiseException<IllegalArgumentException>("Expression integer division by zero");
+		return 0;
+	}
+	if(b == -1) {
+		return negateInteger(a);
+	}
+	return a / b;
+}
+
+long long moduloInteger(const long long a, const long long b)
+{
+	if(b == 0) {
+		raiseException<IllegalArgumentException>("Expression integer division by zero");
+		return 0;
+	}
+	if(b == -1) {
+		return 0;
+	}
+	return a % b;
+}
+
+template <typename T>
+bool compareValues(const ExpressionOperator op, const T & a, const T & b)
+{
+	switch(op) {
+	case ExpressionOperator::equal:
+		return a == b;
+	case ExpressionOperator::notEqual:
+		return ! (a == b);
+	case ExpressionOperator::less:
+		return a < b;
+	case ExpressionOperator::lessEqual:
+		return a <= b;
+	case ExpressionOperator::greater:
+		return a > b;
+	case ExpressionOperator::greaterEqual:
+		return a >= b;
+	default:
+		return false;
+	}
+}
+
+bool isComparison(const ExpressionOperator op)
+{
+	return op >= ExpressionOperator::equal && op <= ExpressionOperator::greaterEqual;
+}
+
+long long variantToInteger(const Variant & value, const ValueKind kind)
+{
+	if(kind == ValueKind::boolean) {
+		return value.get<bool>() ? 1 : 0;
+	}
+	return value.cast<long long>().get<long long>();
+}
+
+double variantToReal(const Variant & value, const ValueKind kind)
+{
+	if(kind == ValueKind::real) {
+		return value.cast<double>().get<double>();
+	}
+	return (double)variantToInteger(value, kind);
+}
+
+bool variantToBoolean(const Variant & var)
+{
+	const Variant & value = unwrapVariant(var);
+	const ValueKind kind = getVariantKind(value);
+	switch(kind) {
+	case ValueKind::boolean:
+		return value.get<bool>();
+	case ValueKind::integer:
+		return variantToInteger(value, kind) != 0;
+	case ValueKind::real:
+		return variantToReal(value, kind) != 0;
+	default:
+		raiseUnsupportedOperand(kind);
+		return false;
+	}
+}
+
+Variant applyUnary(const ExpressionOperator op, const Variant & var)
+{
+	if(op == ExpressionOperator::logicalNot) {
+		return ! variantToBoolean(var);
+	}
+	const Variant & value = unwrapVariant(var);
+	const ValueKind kind = getVariantKind(value);
+	switch(kind) {
+	case ValueKind::boolean:
+	case ValueKind::integer:
+		return negateInteger(variantToInteger(value, kind));
+	case ValueKind::real:
+		return -variantToReal(value, kind);
+	default:
+		raiseUnsupportedOperand(kind);
+		return Variant();
+	}
+}
+
+// op is not logicalAnd or logicalOr, they are short circuited by the callers.
+Variant applyBinary(const ExpressionOperator op, const Variant & a, const Variant & b)
+{
+	const Variant & left = unwrapVariant(a);
+	const Variant & right = unwrapVariant(b);
+	const ValueKind leftKind = getVariantKind(left);
+	const ValueKind rightKind = getVariantKind(right);
+	if(leftKind == ValueKind::object || rightKind == ValueKind::object) {
+		raiseUnsupportedOperand(ValueKind::object);
+		return Variant();
+	}
+	if(leftKind == ValueKind::string || rightKind == ValueKind::string) {
+		if(leftKind != rightKind) {
+			raiseUnsupportedOperand(leftKind == ValueKind::string ? rightKind : leftKind);
+			return Variant();
+		}
+		const std::string & leftString = left.get<const std::string &>();
+		const std::string & rightString = right.get<const std::string &>();
+		if(op == ExpressionOperator::add) {
+			return leftString + rightString;
+		}
+		if(! isComparison(op)) {
+			raiseUnsupportedOperand(ValueKind::string);
+			return Variant();
+		}
+		return compareValues(op, leftString, rightString);
+	}
+	if(leftKind == ValueKind::real || rightKind == ValueKind::real) {
+		const double x = variantToReal(left, leftKind);
+		const double y = variantToReal(right, rightKind);
+		switch(op) {
+		case ExpressionOperator::add:
+			return x + y;
+		case ExpressionOperator::subtract:
+			return x - y;
+		case ExpressionOperator::multiply:
+			return x * y;
+		case ExpressionOperator::divide:
+			return x / y;
+		case ExpressionOperator::modulo:
+			raiseUnsupportedOperand(ValueKind::real);
+			return Variant();
+		default:
+			return compareValues(op, x, y);
+		}
+	}
+	const long long x = variantToInteger(left, leftKind);
+	const long long y = variantToInteger(right, rightKind);
+	switch(op) {
+	case ExpressionOperator::add:
+		return addInteger(x, y);
+	case ExpressionOperator::subtract:
+		return subtractInteger(x, y);
+	case ExpressionOperator::multiply:
+		return multiplyInteger(x, y);
+	case ExpressionOperator::divide:
+		return divideInteger(x, y);
+	case ExpressionOperator::modulo:
+		return moduloInteger(x, y);
+	default:
+		return compareValues(op, x, y);
+	}
+}
+
+// Converts the result to bool, long long, double, or std::string, the objects are kept as is.
+Variant normalizeResult(const Variant & var)
+{
+	const Variant & value = unwrapVariant(var);
+	const ValueKind kind = getVariantKind(value);
+	switch(kind) {
+	case ValueKind::boolean:
+		return value.get<bool>();
+	case ValueKind::integer:
+		return variantToInteger(value, kind);
+	case ValueKind::real:
+		return variantToReal(value, kind);
+	case ValueKind::string:
+		return Variant::create<std::string>(value.get<const std::string &>());
+	default:
+		return value;
+	}
+}
+
+// Finds the type by the qualified name, the first name is looked up in the root class then in the MetaRepos.
+const MetaType * findTypeByPath(const std::vector<std::string> & path, const std::size_t count, const MetaType * rootMetaType)
+{
+	const MetaType * metaType = nullptr;
+	const MetaClass * rootClass = rootMetaType->getMetaClass();
+	if(rootClass != nullptr) {
+		const MetaItem & item = rootClass->getType(path[0]);
+		if(! item.isEmpty()) {
+			metaType = item.asMetaType();
+		}
+	}
+	if(metaType == nullptr) {
+		for(const MetaRepo * repo : *getMetaRepoList()) {
+			const MetaItem & item = repo->getType(path[0]);
+			if(! item.isEmpty()) {
+				metaType = item.asMetaType();
+				break;
+			}
+		}
+	}
+	for(std::size_t i = 1; metaType != nullptr && i < count; ++i) {
+		const MetaClass * metaClass = metaType->getMetaClass();
+		const MetaItem * item = (metaClass == nullptr ? nullptr : &metaClass->getType(path[i]));
+		metaType = (item == nullptr || item->isEmpty() ? nullptr : item->asMetaType());
+	}
+	return metaType;
+}
+
+Variant resolveEnumValue(const std::vector<std::string> & path, const MetaType * rootMetaType)
+{
+	std::string qualifiedName;
+	for(const std::string & name : path) {
+		qualifiedName += (qualifiedName.empty() ? "" : "::") + name;
+	}
+	const MetaType * metaType = findTypeByPath(path, path.size() - 1, rootMetaType);
+	const MetaEnum * metaEnum = (metaType == nullptr ? nullptr : metaType->getMetaEnum());
+	if(metaEnum != nullptr) {
+		const MetaItem & item = metaEnum->getByName(path.back());
+		if(! item.isEmpty()) {
+			return item.asEnumValue();
+		}
+	}
+	raiseException<IllegalArgumentException>("Expression can't find enum value " + qualifiedName);
+	return Variant();
+}
+
+// Finds the accessible, or the callable if isCall is true, in the class.
+// *metaIndexable is set instead of *item for the builtin size().
+void findMember(
+	const MetaType * classType,
+	const std::string & name,
+	const bool isCall,
+	Variant * item,
+	const MetaIndexable ** metaIndexable
+)
+{
+	*metaIndexable = nullptr;
+	const MetaClass * metaClass = classType->getMetaClass();
+	if(metaClass != nullptr) {
+		const MetaItem & found = (isCall ? metaClass->getCallable(name) : metaClass->getAccessible(name));
+		if(! found.isEmpty()) {
+			*item = (isCall ? found.asCallable() : found.asAccessible());
+			return;
+		}
+	}
+	if(isCall && name == "size" && classType->getMetaIndexable() != nullptr) {
+		*metaIndexable = classType->getMetaIndexable();
+		return;
+	}
+	raiseException<IllegalArgumentException>("Expression can't find " + std::string(isCall ? "callable " : "member ") + name);
+}
+
+std::size_t getIndexableSize(const MetaIndexable * metaIndexable, const Variant & instance)
+{
+	return metaIndexable->getSizeInfo(depointer(instance)).getSize();
+}
+
+VariantRef slotToRef(const ExpressionSlot & slot, const ValueKind kind)
+{
+	switch(kind) {
+	case ValueKind::boolean:
+		return VariantRef(getMetaType<bool>(), const_cast<bool *>(&slot.boolean));
+	case ValueKind::integer:
+		return VariantRef(getMetaType<long long>(), const_cast<long long *>(&slot.integer));
+	case ValueKind::real:
+		return VariantRef(getMetaType<double>(), const_cast<double *>(&slot.real));
+	case ValueKind::string:
+		return VariantRef(getMetaType<std::string>(), const_cast<std::string *>(slot.string));
+	default:
+		if(slot.holder != nullptr) {
+			return VariantRef(*slot.holder);
+		}
+		// A reference type refers to the object, a pointer type refers to the pointer in the register.
+		return VariantRef(
+			slot.instanceType,
+			slot.instanceType->isPointer() ? const_cast<void **>(&slot.object) : slot.object
+		);
+	}
+}
+
+// Returns the Variant which is used as the instance of accessible and callable. temp keeps the Variant alive.
+const Variant & getInstance(const ExpressionSlot & slot, Variant & temp)
+{
+	if(slot.holder != nullptr) {
+		return *slot.holder;
+	}
+	temp = slotToRef(slot, ValueKind::object).toVariant();
+	return temp;
+}
+
+// Writes a value in a register as the parameter type, so invokeRef gets the exact parameter type.
+using ArgumentWriter = void (*)(const ExpressionSlot & slot, const ValueKind kind, void * buffer);
+
+template <typename T>
+void writeArgument(const ExpressionSlot & slot, const ValueKind kind, void * buffer)
+{
+	switch(kind) {
+	case ValueKind::boolean:
+		*static_cast<T *>(buffer) = (T)slot.boolean;
+		break;
+	case ValueKind::integer:
+		*static_cast<T *>(buffer) = (T)slot.integer;
+		break;
+	default:
+		*static_cast<T *>(buffer) = (T)slot.real;
+		break;
+	}
+}
+
+template <>
+void writeArgument<bool>(const ExpressionSlot & slot, const ValueKind kind, void * buffer)
+{
+	switch(kind) {
+	case ValueKind::boolean:
+		*static_cast<bool *>(buffer) = slot.boolean;
+		break;
+	case ValueKind::integer:
+		*static_cast<bool *>(buffer) = (slot.integer != 0);
+		break;
+	default:
+		*static_cast<bool *>(buffer) = (slot.real != 0);
+		break;
+	}
+}
+
+ArgumentWriter getArgumentWriter(const MetaType * metaType)
+{
+	switch(metaType->getTypeKind()) {
+	case tkBool:
+		return &writeArgument<bool>;
+	case tkChar:
+		return &writeArgument<char>;
+	case tkWideChar:
+		return &writeArgument<wchar_t>;
+	case tkChar8:
+		return &writeArgument<unsigned char>;
+	case tkChar16:
+		return &writeArgument<char16_t>;
+	case tkChar32:
+		return &writeArgument<char32_t>;
+	case tkSignedChar:
+		return &writeArgument<signed char>;
+	case tkUnsignedChar:
+		return &writeArgument<unsigned char>;
+	case tkShort:
+		return &writeArgument<short>;
+	case tkUnsignedShort:
+		return &writeArgument<unsigned short>;
+	case tkInt:
+		return &writeArgument<int>;
+	case tkUnsignedInt:
+		return &writeArgument<unsigned int>;
+	case tkLong:
+		return &writeArgument<long>;
+	case tkUnsignedLong:
+		return &writeArgument<unsigned long>;
+	case tkLongLong:
+		return &writeArgument<long long>;
+	case tkUnsignedLongLong:
+		return &writeArgument<unsigned long long>;
+	case tkFloat:
+		return &writeArgument<float>;
+	case tkDouble:
+		return &writeArgument<double>;
+	case tkLongDouble:
+		return &writeArgument<long double>;
+	case tkEnum:
+		return getArgumentWriter(metaType->getUpType());
+	default:
+		return nullptr;
+	}
+}
+
+struct ExpressionArgument
+{
+	std::uint16_t slotIndex;
+	ValueKind kind;
+	// The non reference parameter type which the value is written as, nullptr if the value is passed as is.
+	const MetaType * parameterType;
+	ArgumentWriter writer;
+};
+
+// The buffer for an arithmetic argument which is written as the parameter type.
+using ArgumentBuffer = std::aligned_storage<sizeof(long double), alignof(long double)>::type;
+
+enum class OpCode : std::uint8_t
+{
+	loadField,
+	loadProperty,
+	callMethod,
+	getSize,
+	loadDynamicMember,
+	callDynamicMethod,
+
+	move,
+	booleanToInteger,
+	integerToReal,
+	integerToBoolean,
+	realToBoolean,
+	variantToBoolean,
+	jumpIfFalse,
+	jumpIfTrue,
+
+	logicalNot,
+	negateInteger,
+	negateReal,
+	addInteger,
+	subtractInteger,
+	multiplyInteger,
+	divideInteger,
+	moduloInteger,
+	addReal,
+	subtractReal,
+	multiplyReal,
+	divideReal,
+	equalInteger,
+	notEqualInteger,
+	lessInteger,
+	lessEqualInteger,
+	equalReal,
+	notEqualReal,
+	lessReal,
+	lessEqualReal,
+	equalString,
+	notEqualString,
+	lessString,
+	lessEqualString,
+	concatString,
+	genericUnary,
+	genericBinary
+};
+
+struct ExpressionInstruction
+{
+	OpCode opCode;
+	// The kinds of the operands of genericUnary and genericBinary.
+	ValueKind firstKind;
+	ValueKind secondKind;
+	// The operator of genericUnary and genericBinary.
+	ExpressionOperator op;
+	std::uint16_t target;
+	std::uint16_t first;
+	std::uint16_t second;
+	// The index of the site, the jump target, or the index of the Variant which holds the result.
+	std::uint32_t index;
+};
+
+constexpr std::ptrdiff_t unresolvedOffset = PTRDIFF_MIN;
+
+// The inline cache of a member data. The offset of the member in the object is resolved on the first evaluation,
+// then the member is read at the offset without accessibleGet.
+struct FieldSite
+{
+	std::string name;
+	Variant accessible;
+	ValueInfo valueInfo;
+	std::atomic<std::ptrdiff_t> offset;
+	// The type of the reference to the member, it's resolved with the offset.
+	std::atomic<const MetaType *> referenceType;
+};
+
+// A member which is not member data, such as an accessor, it's read by accessibleGet.
+struct PropertySite
+{
+	std::string name;
+	Variant accessible;
+	ValueInfo valueInfo;
+	std::uint16_t variantIndex;
+};
+
+// A method resolved when compiling, it's invoked by invokeRef with the arguments in the registers.
+struct CallSite
+{
+	std::string name;
+	Variant callable;
+	const MetaCallable * metaCallable;
+	ValueInfo valueInfo;
+	std::vector<ExpressionArgument> argumentList;
+	std::uint16_t variantIndex;
+};
+
+struct SizeSite
+{
+	const MetaIndexable * metaIndexable;
+};
+
+struct DynamicEntry
+{
+	const MetaType * metaType;
+	Variant item;
+	const MetaIndexable * metaIndexable;
+};
+
+// A member access or a call on a value which type is not known when compiling.
+// The inline cache is polymorphic, it keeps the members of the last few types, so the values which alternate among
+// a few types don't miss. On a miss, the member is looked up in entryList, which has one entry for each type seen
+// by the site, and is only looked up by name if the type is new. The entries are kept until the expression is destroyed,
+// so the evaluating threads never see a freed entry, and the memory is bounded by the number of types.
+struct DynamicSite
+{
+	static constexpr std::size_t cacheSize = 4;
+
+	std::string name;
+	bool isCall;
+	std::vector<ExpressionArgument> argumentList;
+	std::uint16_t variantIndex;
+	std::atomic<const DynamicEntry *> cache[cacheSize];
+	std::mutex mutex;
+	std::vector<std::unique_ptr<const DynamicEntry> > entryList;
+	// The cache slot replaced by the next miss, guarded by mutex.
+	std::size_t nextCacheIndex;
+
+	const DynamicEntry * find(const MetaType * metaType) {
+		for(std::size_t i = 0; i < cacheSize; ++i) {
+			const DynamicEntry * cached = cache[i].load(std::memory_order_acquire);
+			if(cached == nullptr) {
+				break;
+			}
+			if(cached->metaType == metaType) {
+				return cached;
+			}
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		const DynamicEntry * found = nullptr;
+		for(const auto & item : entryList) {
+			if(item->metaType == metaType) {
+				found = item.get();
+				break;
+			}
+		}
+		if(found == nullptr) {
+			std::unique_ptr<DynamicEntry> newEntry(new DynamicEntry());
+			newEntry->metaType = metaType;
+			findMember(metaType, name, isCall, &newEntry->item, &newEntry->metaIndexable);
+			found = newEntry.get();
+			entryList.push_back(std::move(newEntry));
+		}
+		cache[nextCacheIndex].store(found, std::memory_order_release);
+		nextCacheIndex = (nextCacheIndex + 1) % cacheSize;
+		return found;
+	}
+};
+
+// The registers and the Variants of one evaluation. They are on the stack unless the expression is large.
+class ExpressionFrame
+{
+private:
+	static constexpr std::size_t inlineSlotCount = 16;
+	static constexpr std::size_t inlineVariantCount = 4;
+
+public:
+	ExpressionFrame(const std::size_t slotCount, const std::size_t variantCount)
+		: slotBuffer(), variantBuffer(), slots(inlineSlots), variants(nullptr), variantCount(variantCount)
+	{
+		if(slotCount > inlineSlotCount) {
+			slotBuffer.reset(new ExpressionSlot[slotCount]);
+			slots = slotBuffer.get();
+		}
+		if(variantCount > inlineVariantCount) {
+			variantBuffer.reset(new Variant[variantCount]);
+			variants = variantBuffer.get();
+		}
+		else if(variantCount > 0) {
+			variants = reinterpret_cast<Variant *>(inlineVariants);
+			for(std::size_t i = 0; i < variantCount; ++i) {
+				new (&variants[i]) Variant();
+			}
+		}
+	}
+
+	~ExpressionFrame() {
+		if(variantCount > 0 && variantCount <= inlineVariantCount) {
+			for(std::size_t i = 0; i < variantCount; ++i) {
+				variants[i].~Variant();
+			}
+		}
+	}
+
+	ExpressionFrame(const ExpressionFrame &) = delete;
+	ExpressionFrame & operator = (const ExpressionFrame &) = delete;
+
+	ExpressionSlot * getSlots() const {
+		return slots;
+	}
+
+
+	Variant * getVariants() const {
+		return variants;
+	}
+
+private:
+	ExpressionSlot inlineSlots[inlineSlotCount];
+	std::aligned_storage<sizeof(Variant), alignof(Variant)>::type inlineVariants[inlineVariantCount];
+	std::unique_ptr<ExpressionSlot[]> slotBuffer;
+	std::unique_ptr<Variant[]> variantBuffer;
+	ExpressionSlot * slots;
+	Variant * variants;
+	std::size_t variantCount;
+};
+
+struct CompiledValue
+{
+	std::uint16_t slotIndex;
+	ValueInfo valueInfo;
+};
+
+} // namespace
+
+class ExpressionImplement
+{
+public:
+	ExpressionImplement(const MetaType * rootMetaType, const std::string & source)
+		:
+			rootMetaType(rootMetaType),
+			source(source),
+			root(),
+			instructionList(),
+			constantList(),
+			fieldSiteList(),
+			propertySiteList(),
+			callSiteList(),
+			sizeSiteList(),
+			dynamicSiteList(),
+			slotCount(0),
+			variantCount(0),
+			rootSlotIndex(0),
+			result()
+	{
+		root = ExpressionParser(this->source).parse();
+		rootSlotIndex = allocateSlot();
+		result = compileNode(*root);
+	}
+
+	const MetaType * getRootMetaType() const {
+		return rootMetaType;
+	}
+
+	const std::string & getSource() const {
+		return source;
+	}
+
+	Variant evaluate(const Variant & rootObject) const {
+		const ExpressionFrame frame(slotCount, variantCount);
+		execute(rootObject, frame.getSlots(), frame.getVariants());
+		return boxResult(frame.getSlots()[result.slotIndex], result.valueInfo.kind);
+	}
+
+	bool evaluateBool(const Variant & rootObject) const {
+		const ExpressionFrame frame(slotCount, variantCount);
+		execute(rootObject, frame.getSlots(), frame.getVariants());
+		const ExpressionSlot & slot = frame.getSlots()[result.slotIndex];
+		switch(result.valueInfo.kind) {
+		case ValueKind::boolean:
+			return slot.boolean;
+		case ValueKind::integer:
+			return slot.integer != 0;
+		case ValueKind::real:
+			return slot.real != 0;
+		case ValueKind::variant:
+			return variantToBoolean(*slot.holder);
+		default:
+			raiseUnsupportedOperand(result.valueInfo.kind);
+			return false;
+		}
+	}
+
+	Variant interpret(const Variant & rootObject) const {
+		requireRoot(rootObject);
+		return normalizeResult(interpretNode(*root, rootObject));
+	}
+
+private:
+	// Returns the address of the root object.
+	void * requireRoot(const Variant & rootObject) const {
+		const auto pointerAndType = getPointerAndType(rootObject);
+		if(! pointerAndType.second->equal(rootMetaType)) {
+			raiseException<IllegalArgumentException>("Expression root object has wrong type");
+		}
+		if(pointerAndType.first == nullptr) {
+			raiseException<IllegalArgumentException>("Expression root object is nullptr");
+		}
+		return pointerAndType.first;
+	}
+
+	void execute(const Variant & rootObject, ExpressionSlot * slots, Variant * variants) const;
+
+	Variant interpretNode(const ExpressionNode & node, const Variant & rootObject) const;
+	Variant interpretMember(const ExpressionNode & node, const Variant & rootObject) const;
+
+	std::uint16_t allocateSlot() {
+		if(slotCount >= 0xffff) {
+			raiseException<UnsupportedException>("Expression is too large");
+		}
+		return (std::uint16_t)slotCount++;
+	}
+
+	std::uint16_t allocateVariant() {
+		return (std::uint16_t)variantCount++;
+	}
+
+	CompiledValue newValue(const ValueInfo & valueInfo) {
+		return CompiledValue { allocateSlot(), valueInfo };
+	}
+
+	std::size_t emit(
+		const OpCode opCode,
+		const std::uint16_t target,
+		const std::uint16_t first = 0,
+		const std::uint16_t second = 0,
+		const std::uint32_t index = 0,
+		const ExpressionOperator op = ExpressionOperator::none,
+		const ValueKind firstKind = ValueKind::variant,
+		const ValueKind secondKind = ValueKind::variant
+	) {
+		instructionList.push_back(ExpressionInstruction { opCode, firstKind, secondKind, op, target, first, second, index });
+		return instructionList.size() - 1;
+	}
+
+	CompiledValue compileConstant(const Variant & value) {
+		const ValueKind kind = getVariantKind(value);
+		CompiledValue compiled = newValue(makeValueInfo(kind, nullptr));
+		ExpressionSlot slot;
+		slot.instanceType = nullptr;
+		slot.holder = nullptr;
+		switch(kind) {
+		case ValueKind::boolean:
+			slot.boolean = value.get<bool>();
+			break;
+		case ValueKind::integer:
+			slot.integer = variantToInteger(value, kind);
+			break;
+		case ValueKind::real:
+			slot.real = variantToReal(value, kind);
+			break;
+		default:
+			// String literals are in the syntax tree which lives as long as the expression.
+			slot.string = &value.get<const std::string &>();
+			break;
+		}
+		constantList.push_back(std::make_pair(compiled.slotIndex, slot));
+		return compiled;
+	}
+
+	CompiledValue compileNode(const ExpressionNode & node) {
+		switch(node.type) {
+		case NodeType::literal:
+			return compileConstant(node.value);
+
+		case NodeType::enumValue:
+			return compileConstant(resolveEnumValue(node.path, rootMetaType));
+
+		case NodeType::member:
+		case NodeType::call:
+			return compileMember(node);
+
+		case NodeType::unary:
+			return compileUnary(node);
+
+		default:
+			return compileBinary(node);
+		}
+	}
+
+	CompiledValue compileMember(const ExpressionNode & node) {
+		CompiledValue object;
+		if(node.object) {
+			object = compileNode(*node.object);
+		}
+		else {
+			object = CompiledValue { rootSlotIndex, ValueInfo { ValueKind::object, &readObject, rootMetaType, nullptr } };
+		}
+		const bool isCall = (node.type == NodeType::call);
+		std::vector<ExpressionArgument> argumentList;
+		for(const NodePointer & child : node.children) {
+			const CompiledValue argument = compileNode(*child);
+			argumentList.push_back(ExpressionArgument { argument.slotIndex, argument.valueInfo.kind, nullptr, nullptr });
+		}
+
+		if(object.valueInfo.kind == ValueKind::variant) {
+			std::unique_ptr<DynamicSite> site(new DynamicSite());
+			site->name = node.name;
+			site->isCall = isCall;
+			site->argumentList = std::move(argumentList);
+			site->variantIndex = allocateVariant();
+			for(auto & cached : site->cache) {
+				cached.store(nullptr, std::memory_order_relaxed);
+			}
+			site->nextCacheIndex = 0;
+			dynamicSiteList.push_back(std::move(site));
+			const CompiledValue compiled = newValue(makeValueInfo(ValueKind::variant, nullptr));
+			emit(isCall ? OpCode::callDynamicMethod : OpCode::loadDynamicMember,
+				compiled.slotIndex, object.slotIndex, 0, (std::uint32_t)(dynamicSiteList.size() - 1));
+			return compiled;
+		}
+		if(object.valueInfo.kind != ValueKind::object) {
+			raiseException<UnsupportedException>("Expression can't access member " + node.name
+				+ " of " + getKindName(object.valueInfo.kind));
+		}
+
+		Variant item;
+		const MetaIndexable * metaIndexable = nullptr;
+		findMember(object.valueInfo.objectType, node.name, isCall, &item, &metaIndexable);
+		if(metaIndexable != nullptr) {
+			if(! argumentList.empty()) {
+				raiseException<IllegalArgumentException>("Expression size() doesn't have arguments");
+			}
+			sizeSiteList.push_back(SizeSite { metaIndexable });
+			const CompiledValue compiled = newValue(makeValueInfo(ValueKind::integer, nullptr));
+			emit(OpCode::getSize, compiled.slotIndex, object.slotIndex, 0, (std::uint32_t)(sizeSiteList.size() - 1));
+			return compiled;
+		}
+		if(isCall) {
+			return compileCall(node, object, item, std::move(argumentList));
+		}
+		const ValueInfo valueInfo = getValueInfo(getNonReferenceMetaType(accessibleGetValueType(item)));
+		const CompiledValue compiled = newValue(valueInfo);
+		if(getNonReferenceMetaType(item)->getTypeKind() == tkMemberPointer) {
+			std::unique_ptr<FieldSite> site(new FieldSite());
+			site->name = node.name;
+			site->accessible = item;
+			site->valueInfo = valueInfo;
+			site->offset.store(unresolvedOffset, std::memory_order_relaxed);
+			site->referenceType.store(nullptr, std::memory_order_relaxed);
+			fieldSiteList.push_back(std::move(site));
+			emit(OpCode::loadField, compiled.slotIndex, object.slotIndex, 0, (std::uint32_t)(fieldSiteList.size() - 1));
+		}
+		else {
+			std::unique_ptr<PropertySite> site(new PropertySite());
+			site->name = node.name;
+			site->accessible = item;
+			site->valueInfo = valueInfo;
+			site->variantIndex = allocateVariant();
+			propertySiteList.push_back(std::move(site));
+			emit(OpCode::loadProperty, compiled.slotIndex, object.slotIndex, 0, (std::uint32_t)(propertySiteList.size() - 1));
+		}
+		return compiled;
+	}
+
+	CompiledValue compileCall(
+		const ExpressionNode & node,
+		const CompiledValue & object,
+		const Variant & callable,
+		std::vector<ExpressionArgument> argumentList
+	) {
+		const MetaType * callableType = getNonReferenceMetaType(callable);
+		// The arithmetic arguments of a function which is not overloaded are written as the parameter types,
+		// so invokeRef doesn't cast them.
+		const TypeKind callableKind = callableType->getTypeKind();
+		if((callableKind == tkFunction || callableKind == tkMemberFunction)
+			&& (std::size_t)callableGetParameterCountInfo(callable).getMaxParameterCount() == argumentList.size()) {
+			for(std::size_t i = 0; i < argumentList.size(); ++i) {
+				ExpressionArgument & argument = argumentList[i];
+				if(argument.kind != ValueKind::boolean && argument.kind != ValueKind::integer && argument.kind != ValueKind::real) {
+					continue;
+				}
+				const MetaType * parameterType = getNonReferenceMetaType(callableGetParameterType(callable, (int)i));
+				argument.writer = getArgumentWriter(parameterType);
+				if(argument.writer != nullptr) {
+					argument.parameterType = parameterType;
+				}
+			}
+		}
+		const MetaType * returnType = callableGetReturnType(callable);
+		std::unique_ptr<CallSite> site(new CallSite());
+		site->name = node.name;
+		site->callable = callable;
+		site->metaCallable = callableType->getMetaCallable();
+		site->valueInfo = (returnType == nullptr
+			? makeValueInfo(ValueKind::variant, &readNothing) : getValueInfo(getNonReferenceMetaType(returnType)));
+		site->argumentList = std::move(argumentList);
+		site->variantIndex = allocateVariant();
+		const CompiledValue compiled = newValue(site->valueInfo);
+		callSiteList.push_back(std::move(site));
+		emit(OpCode::callMethod, compiled.slotIndex, object.slotIndex, 0, (std::uint32_t)(callSiteList.size() - 1));
+		return compiled;
+	}
+
+	// Converts a boolean to integer, so the comparisons and arithmetic only work on integers and reals.
+	CompiledValue promoteBoolean(const CompiledValue & value) {
+		if(value.valueInfo.kind != ValueKind::boolean) {
+			return value;
+		}
+		const CompiledValue compiled = newValue(makeValueInfo(ValueKind::integer, nullptr));
+		emit(OpCode::booleanToInteger, compiled.slotIndex, value.slotIndex);
+		return compiled;
+	}
+
+	CompiledValue promoteToReal(const CompiledValue & value) {
+		if(value.valueInfo.kind == ValueKind::real) {
+			return value;
+		}
+		const CompiledValue compiled = newValue(makeValueInfo(ValueKind::real, nullptr));
+		emit(OpCode::integerToReal, compiled.slotIndex, value.slotIndex);
+		return compiled;
+	}
+
+	void emitToBoolean(const CompiledValue & value, const std::uint16_t target) {
+		switch(value.valueInfo.kind) {
+		case ValueKind::boolean:
+			emit(OpCode::move, target, value.slotIndex);
+			break;
+		case ValueKind::integer:
+			emit(OpCode::integerToBoolean, target, value.slotIndex);
+			break;
+		case ValueKind::real:
+			emit(OpCode::realToBoolean, target, value.slotIndex);
+			break;
+		case ValueKind::variant:
+			emit(OpCode::variantToBoolean, target, value.slotIndex);
+			break;
+		default:
+			raiseUnsupportedOperand(value.valueInfo.kind);
+			break;
+		}
+	}
+
+	CompiledValue compileUnary(const ExpressionNode & node) {
+		const CompiledValue operand = compileNode(*node.children[0]);
+		if(node.op == ExpressionOperator::logicalNot) {
+			const CompiledValue compiled = newValue(makeValueInfo(ValueKind::boolean, nullptr));
+			emitToBoolean(operand, compiled.slotIndex);
+			emit(OpCode::logicalNot, compiled.slotIndex, compiled.slotIndex);
+			return compiled;
+		}
+		if(operand.valueInfo.kind == ValueKind::variant) {
+			const CompiledValue compiled = newValue(makeValueInfo(ValueKind::variant, nullptr));
+			emit(OpCode::genericUnary, compiled.slotIndex, operand.slotIndex, 0, allocateVariant(), node.op, ValueKind::variant);
+			return compiled;
+		}
+		const CompiledValue value = promoteBoolean(operand);
+		if(value.valueInfo.kind == ValueKind::integer) {
+			const CompiledValue compiled = newValue(makeValueInfo(ValueKind::integer, nullptr));
+			emit(OpCode::negateInteger, compiled.slotIndex, value.slotIndex);
+			return compiled;
+		}
+		if(value.valueInfo.kind == ValueKind::real) {
+			const CompiledValue compiled = newValue(makeValueInfo(ValueKind::real, nullptr));
+			emit(OpCode::negateReal, compiled.slotIndex, value.slotIndex);
+			return compiled;
+		}
+		raiseUnsupportedOperand(value.valueInfo.kind);
+		return value;
+	}
+
+	CompiledValue compileLogical(const ExpressionNode & node) {
+		const CompiledValue compiled = newValue(makeValueInfo(ValueKind::boolean, nullptr));
+		emitToBoolean(compileNode(*node.children[0]), compiled.slotIndex);
+		const std::size_t jump = emit(
+			node.op == ExpressionOperator::logicalAnd ? OpCode::jumpIfFalse : OpCode::jumpIfTrue,
+			compiled.slotIndex,
+			compiled.slotIndex
+		);
+		emitToBoolean(compileNode(*node.children[1]), compiled.slotIndex);
+		instructionList[jump].index = (std::uint32_t)instructionList.size();
+		return compiled;
+	}
+
+	CompiledValue compileBinary(const ExpressionNode & node) {
+		if(node.op == ExpressionOperator::logicalAnd || node.op == ExpressionOperator::logicalOr) {
+			return compileLogical(node);
+		}
+		CompiledValue left = compileNode(*node.children[0]);
+		CompiledValue right = compileNode(*node.children[1]);
+		const ValueKind leftKind = left.valueInfo.kind;
+		const ValueKind rightKind = right.valueInfo.kind;
+		if(leftKind == ValueKind::variant || rightKind == ValueKind::variant) {
+			const CompiledValue compiled = newValue(makeValueInfo(ValueKind::variant, nullptr));
+			emit(OpCode::genericBinary, compiled.slotIndex, left.slotIndex, right.slotIndex,
+				allocateVariant(), node.op, leftKind, rightKind);
+			return compiled;
+		}
+		if(leftKind == ValueKind::object || rightKind == ValueKind::object) {
+			raiseUnsupportedOperand(ValueKind::object);
+		}
+
+		ExpressionOperator op = node.op;
+		// a > b is b < a, a >= b is b <= a.
+		if(op == ExpressionOperator::greater || op == ExpressionOperator::greaterEqual) {
+			std::swap(left, right);
+			op = (op == ExpressionOperator::greater ? ExpressionOperator::less : ExpressionOperator::lessEqual);
+		}
+
+		if(leftKind == ValueKind::string || rightKind == ValueKind::string) {
+			if(leftKind != rightKind) {
+				raiseUnsupportedOperand(leftKind == ValueKind::string ? rightKind : leftKind);
+			}
+			if(op == ExpressionOperator::add) {
+				const CompiledValue compiled = newValue(makeValueInfo(ValueKind::string, nullptr));
+				emit(OpCode::concatString, compiled.slotIndex, left.slotIndex, right.slotIndex, allocateVariant());
+				return compiled;
+			}
+			if(! isComparison(op)) {
+				raiseUnsupportedOperand(ValueKind::string);
+			}
+			return emitComparison(OpCode::equalString, op, left, right);
+		}
+
+		left = promoteBoolean(left);
+		right = promoteBoolean(right);
+		const bool isReal = (left.valueInfo.kind == ValueKind::real || right.valueInfo.kind == ValueKind::real);
+		if(isReal) {
+			left = promoteToReal(left);
+			right = promoteToReal(right);
+		}
+		if(isComparison(op)) {
+			return emitComparison(isReal ? OpCode::equalReal : OpCode::equalInteger, op, left, right);
+		}
+		OpCode opCode = OpCode::addInteger;
+		switch(op) {
+		case ExpressionOperator::add:
+			opCode = (isReal ? OpCode::addReal : OpCode::addInteger);
+			break;
+		case ExpressionOperator::subtract:
+			opCode = (isReal ? OpCode::subtractReal : OpCode::subtractInteger);
+			break;
+		case ExpressionOperator::multiply:
+			opCode = (isReal ? OpCode::multiplyReal : OpCode::multiplyInteger);
+			break;
+		case ExpressionOperator::divide:
+			opCode = (isReal ? OpCode::divideReal : OpCode::divideInteger);
+			break;
+		default:
+			if(isReal) {
+				raiseUnsupportedOperand(ValueKind::real);
+			}
+			opCode = OpCode::moduloInteger;
+			break;
+		}
+		const CompiledValue compiled = newValue(makeValueInfo(isReal ? ValueKind::real : ValueKind::integer, nullptr));
+		emit(opCode, compiled.slotIndex, left.slotIndex, right.slotIndex);
+		return compiled;
+	}
+
+	// equalOpCode is the equal op code of the kind, followed by notEqual, less, and lessEqual.
+	CompiledValue emitComparison(
+		const OpCode equalOpCode,
+		const ExpressionOperator op,
+		const CompiledValue & left,
+		const CompiledValue & right
+	) {
+		const CompiledValue compiled = newValue(makeValueInfo(ValueKind::boolean, nullptr));
+		const int offset = (int)op - (int)ExpressionOperator::equal;
+		emit((OpCode)((int)equalOpCode + offset), compiled.slotIndex, left.slotIndex, right.slotIndex);
+		return compiled;
+	}
+
+	void doCallMethod(
+		const CallSite & site,
+		const ExpressionSlot * slots,
+		Variant * variants,
+		const ExpressionSlot & object,
+		ExpressionSlot & target
+	) const;
+	void doLoadDynamic(
+		DynamicSite & site,
+		const ExpressionSlot * slots,
+		Variant * variants,
+		const ExpressionSlot & object,
+		ExpressionSlot & target
+	) const;
+	static void storeResult(Variant && value, const ValueInfo & valueInfo, Variant & holder, ExpressionSlot & target);
+	static std::ptrdiff_t resolveField(FieldSite & site, const ExpressionSlot & object);
+	static Variant boxResult(const ExpressionSlot & slot, const ValueKind kind);
+
+private:
+	const MetaType * rootMetaType;
+	std::string source;
+	NodePointer root;
+	std::vector<ExpressionInstruction> instructionList;
+	std::vector<std::pair<std::uint16_t, ExpressionSlot> > constantList;
+	std::vector<std::unique_ptr<FieldSite> > fieldSiteList;
+	std::vector<std::unique_ptr<PropertySite> > propertySiteList;
+	std::vector<std::unique_ptr<CallSite> > callSiteList;
+	std::vector<SizeSite> sizeSiteList;
+	std::vector<std::unique_ptr<DynamicSite> > dynamicSiteList;
+	std::size_t slotCount;
+	std::size_t variantCount;
+	std::uint16_t rootSlotIndex;
+	CompiledValue result;
+};
+
+void ExpressionImplement::execute(const Variant & rootObject, ExpressionSlot * slots, Variant * variants) const
+{
+	for(const auto & constant : constantList) {
+		slots[constant.first] = constant.second;
+	}
+	ExpressionSlot & rootSlot = slots[rootSlotIndex];
+	rootSlot.object = requireRoot(rootObject);
+	rootSlot.instanceType = nullptr;
+	rootSlot.holder = &rootObject;
+
+	const std::size_t instructionCount = instructionList.size();
+	for(std::size_t pc = 0; pc < instructionCount; ++pc) {
+		const ExpressionInstruction & instruction = instructionList[pc];
+		ExpressionSlot & target = slots[instruction.target];
+		const ExpressionSlot & first = slots[instruction.first];
+		const ExpressionSlot & second = slots[instruction.second];
+		switch(instruction.opCode) {
+		case OpCode::loadField: {
+			FieldSite & site = *fieldSiteList[instruction.index];
+			if(first.object == nullptr) {
+				raiseNullObject(site.name);
+			}
+			std::ptrdiff_t offset = site.offset.load(std::memory_order_acquire);
+			if(offset == unresolvedOffset) {
+				offset = resolveField(site, first);
+			}
+			target.holder = nullptr;
+			target.instanceType = (site.valueInfo.pointerType != nullptr
+				? site.valueInfo.pointerType : site.referenceType.load(std::memory_order_relaxed));
+			site.valueInfo.reader(static_cast<const char *>(first.object) + offset, target);
+			break;
+		}
+
+		case OpCode::loadProperty: {
+			const PropertySite & site = *propertySiteList[instruction.index];
+			if(first.object == nullptr) {
+				raiseNullObject(site.name);
+			}
+			Variant temp;
+			storeResult(accessibleGet(site.accessible, getInstance(first, temp)), site.valueInfo, variants[site.variantIndex], target);
+			break;
+		}
+
+		case OpCode::callMethod: {
+			const CallSite & site = *callSiteList[instruction.index];
+			if(first.object == nullptr) {
+				raiseNullObject(site.name);
+			}
+			doCallMethod(site, slots, variants, first, target);
+			break;
+		}
+
+		case OpCode::getSize: {
+			if(first.object == nullptr) {
+				raiseNullObject("size");
+			}
+			Variant temp;
+			target.integer = (long long)getIndexableSize(sizeSiteList[instruction.index].metaIndexable, getInstance(first, temp));
+			break;
+		}
+
+		case OpCode::loadDynamicMember:
+		case OpCode::callDynamicMethod:
+			doLoadDynamic(*dynamicSiteList[instruction.index], slots, variants, first, target);
+			break;
+
+		case OpCode::move:
+			target = first;
+			break;
+
+		case OpCode::booleanToInteger:
+			target.integer = (first.boolean ? 1 : 0);
+			break;
+
+		case OpCode::integerToReal:
+			target.real = (double)first.integer;
+			break;
+
+		case OpCode::integerToBoolean:
+			target.boolean = (first.integer != 0);
+			break;
+
+		case OpCode::realToBoolean:
+			target.boolean = (first.real != 0);
+			break;
+
+		case OpCode::variantToBoolean:
+			target.boolean = variantToBoolean(*first.holder);
+			break;
+
+		case OpCode::jumpIfFalse:
+			if(! first.boolean) {
+				pc = instruction.index - 1;
+			}
+			break;
+
+		case OpCode::jumpIfTrue:
+			if(first.boolean) {
+				pc = instruction.index - 1;
+			}
+			break;
+
+		case OpCode::logicalNot:
+			target.boolean = ! first.boolean;
+			break;
+
+		case OpCode::negateInteger:
+			target.integer = negateInteger(first.integer);
+			break;
+
+		case OpCode::negateReal:
+			target.real = -first.real;
+			break;
+
+		case OpCode::addInteger:
+			target.integer = addInteger(first.integer, second.integer);
+			break;
+
+		case OpCode::subtractInteger:
+			target.integer = subtractInteger(first.integer, second.integer);
+			break;
+
+		case OpCode::multiplyInteger:
+			target.integer = multiplyInteger(first.integer, second.integer);
+			break;
+
+		case OpCode::divideInteger:
+			target.integer = divideInteger(first.integer, second.integer);
+			break;
+
+		case OpCode::moduloInteger:
+			target.integer = moduloInteger(first.integer, second.integer);
+			break;
+
+		case OpCode::addReal:
+			target.real = first.real + second.real;
+			break;
+
+		case OpCode::subtractReal:
+			target.real = first.real - second.real;
+			break;
+
+		case OpCode::multiplyReal:
+			target.real = first.real * second.real;
+			break;
+
+		case OpCode::divideReal:
+			target.real = first.real / second.real;
+			break;
+
+		case OpCode::equalInteger:
+			target.boolean = (first.integer == second.integer);
+			break;
+
+		case OpCode::notEqualInteger:
+			target.boolean = (first.integer != second.integer);
+			break;
+
+		case OpCode::lessInteger:
+			target.boolean = (first.integer < second.integer);
+			break;
+
+		case OpCode::lessEqualInteger:
+			target.boolean = (first.integer <= second.integer);
+			break;
+
+		case OpCode::equalReal:
+			target.boolean = (first.real == second.real);
+			break;
+
+		case OpCode::notEqualReal:
+			target.boolean = (first.real != second.real);
+			break;
+
+		case OpCode::lessReal:
+			target.boolean = (first.real < second.real);
+			break;
+
+		case OpCode::lessEqualReal:
+			target.boolean = (first.real <= second.real);
+			break;
+
+		case OpCode::equalString:
+			target.boolean = (*first.string == *second.string);
+			break;
+
+		case OpCode::notEqualString:
+			target.boolean = (*first.string != *second.string);
+			break;
+
+		case OpCode::lessString:
+			target.boolean = (*first.string < *second.string);
+			break;
+
+		case OpCode::lessEqualString:
+			target.boolean = (*first.string <= *second.string);
+			break;
+
+		case OpCode::concatString: {
+			Variant & holder = variants[instruction.index];
+			holder = *first.string + *second.string;
+			target.string = &holder.get<const std::string &>();
+			break;
+		}
+
+		case OpCode::genericUnary: {
+			Variant & holder = variants[instruction.index];
+			holder = applyUnary(instruction.op, slotToRef(first, instruction.firstKind).toVariant());
+			target.holder = &holder;
+			break;
+		}
+
+		case OpCode::genericBinary: {
+			Variant & holder = variants[instruction.index];
+			holder = applyBinary(
+				instruction.op,
+				slotToRef(first, instruction.firstKind).toVariant(),
+				slotToRef(second, instruction.secondKind).toVariant()
+			);
+			target.holder = &holder;
+			break;
+		}
+		}
+	}
+}
+
+std::ptrdiff_t ExpressionImplement::resolveField(FieldSite & site, const ExpressionSlot & object)
+{
+	// Several threads may resolve the same site at the same time, they store the same values.
+	Variant temp;
+	const Variant value = accessibleGet(site.accessible, getInstance(object, temp));
+	const std::ptrdiff_t offset = static_cast<const char *>(value.getAddress()) - static_cast<const char *>(object.object);
+	site.referenceType.store(value.getMetaType(), std::memory_order_relaxed);
+	site.offset.store(offset, std::memory_order_release);
+	return offset;
+}
+
+void ExpressionImplement::storeResult(Variant && value, const ValueInfo & valueInfo, Variant & holder, ExpressionSlot & target)
+{
+	holder = std::move(value);
+	target.holder = nullptr;
+	if(valueInfo.kind == ValueKind::variant) {
+		// The Variant which is returned as Variant is unwrapped, so the dynamic sites see the value type.
+		if(getNonReferenceMetaType(holder)->getTypeKind() == tkVariant) {
+			holder = Variant(unwrapVariant(holder));
+		}
+		target.holder = &holder;
+		return;
+	}
+	valueInfo.reader(holder.getAddress(), target);
+	if(valueInfo.kind == ValueKind::object) {
+		target.holder = &holder;
+	}
+}
+
+void ExpressionImplement::doCallMethod(
+	const CallSite & site,
+	const ExpressionSlot * slots,
+	Variant * variants,
+	const ExpressionSlot & object,
+	ExpressionSlot & target
+) const
+{
+	constexpr std::size_t fixedArgumentCount = 8;
+	const std::size_t argumentCount = site.argumentList.size();
+	std::array<VariantRef, fixedArgumentCount> fixedReferenceList;
+	std::array<ArgumentBuffer, fixedArgumentCount> fixedBufferList;
+	std::vector<VariantRef> referenceList;
+	std::vector<ArgumentBuffer> bufferList;
+	VariantRef * references = fixedReferenceList.data();
+	ArgumentBuffer * buffers = fixedBufferList.data();
+	if(argumentCount > fixedArgumentCount) {
+		referenceList.resize(argumentCount);
+		bufferList.resize(argumentCount);
+		references = referenceList.data();
+		buffers = bufferList.data();
+	}
+	for(std::size_t i = 0; i < argumentCount; ++i) {
+		const ExpressionArgument & argument = site.argumentList[i];
+		const ExpressionSlot & slot = slots[argument.slotIndex];
+		if(argument.writer != nullptr) {
+			argument.writer(slot, argument.kind, &buffers[i]);
+			references[i] = VariantRef(argument.parameterType, &buffers[i]);
+		}
+		else {
+			references[i] = slotToRef(slot, argument.kind);
+		}
+	}
+	Variant temp;
+	storeResult(
+		doInvokeCallableRef(site.callable, getInstance(object, temp), ArgumentRefSpan(references, argumentCount)),
+		site.valueInfo,
+		variants[site.variantIndex],
+		target
+	);
+}
+
+void ExpressionImplement::doLoadDynamic(
+	DynamicSite & site,
+	const ExpressionSlot * slots,
+	Variant * variants,
+	const ExpressionSlot & object,
+	ExpressionSlot & target
+) const
+{
+	const Variant & instance = *object.holder;
+	const auto pointerAndType = getPointerAndType(instance);
+	if(pointerAndType.first == nullptr) {
+		raiseNullObject(site.name);
+	}
+	const DynamicEntry * entry = site.find(pointerAndType.second);
+	Variant value;
+	if(entry->metaIndexable != nullptr) {
+		value = (long long)getIndexableSize(entry->metaIndexable, instance);
+	}
+	else if(! site.isCall) {
+		value = accessibleGet(entry->item, instance);
+	}
+	else {
+		std::vector<Variant> argumentList(site.argumentList.size());
+		for(std::size_t i = 0; i < argumentList.size(); ++i) {
+			argumentList[i] = slotToRef(slots[site.argumentList[i].slotIndex], site.argumentList[i].kind).toVariant();
+		}
+		value = doInvokeCallable(entry->item, instance, ArgumentSpan(argumentList.data(), argumentList.size()));
+	}
+	storeResult(std::move(value), makeValueInfo(ValueKind::variant, &readNothing), variants[site.variantIndex], target);
+}
+
+Variant ExpressionImplement::boxResult(const ExpressionSlot & slot, const ValueKind kind)
+{
+	switch(kind) {
+	case ValueKind::boolean:
+		return Variant::create<bool>(slot.boolean);
+	case ValueKind::integer:
+		return Variant::create<long long>(slot.integer);
+	case ValueKind::real:
+		return Variant::create<double>(slot.real);
+	case ValueKind::string:
+		return Variant::create<std::string>(*slot.string);
+	case ValueKind::object:
+		return slotToRef(slot, kind).toVariant();
+	default:
+		return normalizeResult(*slot.holder);
+	}
+}
+
+Variant ExpressionImplement::interpretNode(const ExpressionNode & node, const Variant & rootObject) const
+{
+	switch(node.type) {
+	case NodeType::literal:
+		return node.value;
+
+	case NodeType::enumValue:
+		return resolveEnumValue(node.path, rootMetaType);
+
+	case NodeType::member:
+	case NodeType::call:
+		return interpretMember(node, rootObject);
+
+	case NodeType::unary:
+		return applyUnary(node.op, interpretNode(*node.children[0], rootObject));
+
+	default:
+		break;
+	}
+	if(node.op == ExpressionOperator::logicalAnd) {
+		return variantToBoolean(interpretNode(*node.children[0], rootObject))
+			&& variantToBoolean(interpretNode(*node.children[1], rootObject));
+	}
+	if(node.op == ExpressionOperator::logicalOr) {
+		return variantToBoolean(interpretNode(*node.children[0], rootObject))
+			|| variantToBoolean(interpretNode(*node.children[1], rootObject));
+	}
+	return applyBinary(node.op, interpretNode(*node.children[0], rootObject), interpretNode(*node.children[1], rootObject));
+}
+
+Variant ExpressionImplement::interpretMember(const ExpressionNode & node, const Variant & rootObject) const
+{
+	Variant temp;
+	if(node.object) {
+		temp = interpretNode(*node.object, rootObject);
+		if(getNonReferenceMetaType(temp)->getTypeKind() == tkVariant) {
+			temp = Variant(unwrapVariant(temp));
+		}
+	}
+	const Variant & object = (node.object ? temp : rootObject);
+	const auto pointerAndType = getPointerAndType(object);
+	if(pointerAndType.first == nullptr) {
+		raiseNullObject(node.name);
+	}
+	const bool isCall = (node.type == NodeType::call);
+	Variant item;
+	const MetaIndexable * metaIndexable = nullptr;
+	findMember(pointerAndType.second, node.name, isCall, &item, &metaIndexable);
+	if(metaIndexable != nullptr) {
+		return (long long)getIndexableSize(metaIndexable, object);
+	}
+	if(! isCall) {
+		return accessibleGet(item, object);
+	}
+	std::vector<Variant> argumentList;
+	for(const NodePointer & child : node.children) {
+		argumentList.push_back(interpretNode(*child, rootObject));
+	}
+	return doInvokeCallable(item, object, ArgumentSpan(argumentList.data(), argumentList.size()));
+}
+
+} // namespace internal_
+
+Expression::Expression(const MetaType * rootMetaType, const std::string & source)
+	: implement(new internal_::ExpressionImplement(rootMetaType, source))
+{
+}
+
+Expression::~Expression()
+{
+}
+
+Expression::Expression(Expression && other) noexcept = default;
+Expression & Expression::operator = (Expression && other) noexcept = default;
+
+const MetaType * Expression::getRootMetaType() const
+{
+	return implement->getRootMetaType();
+}
+
+const std::string & Expression::getSource() const
+{
+	return implement->getSource();
+}
+
+Variant Expression::evaluate(const Variant & root) const
+{
+	return implement->evaluate(root);
+}
+
+bool Expression::evaluateBool(const Variant & root) const
+{
+	return implement->evaluateBool(root);
+}
+
+Variant Expression::interpret(const Variant & root) const
+{
+	return implement->interpret(root);
+}
+
+} // namespace metapp
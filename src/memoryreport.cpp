@@ -0,0 +1,424 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/utilities/memoryreport.h"
+#include "metapp/metarepo.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaenum.h"
+#include "metapp/allmetatypes.h"
+
+#include <iomanip>
+#include <algorithm>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+// The header of the block allocated by std::make_shared, a virtual table pointer and two reference counters.
+constexpr std::size_t sharedBlockHeaderSize = sizeof(void *) + 2 * sizeof(int);
+
+// The header of a node in std::map, the parent, left, right pointers and the color.
+constexpr std::size_t mapNodeHeaderSize = 4 * sizeof(void *);
+
+std::size_t alignSize(const std::size_t size)
+{
+	return (size + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+}
+
+template <typename T>
+MemoryUsage getSharedBlockUsage()
+{
+	return MemoryUsage(alignSize(sharedBlockHeaderSize + sizeof(T)), 1);
+}
+
+template <typename Map>
+MemoryUsage getMapNodeUsage(const Map & map)
+{
+	return MemoryUsage(alignSize(mapNodeHeaderSize + sizeof(typename Map::value_type)) * map.size(), map.size());
+}
+
+MemoryUsage getStringUsage(const std::string & s)
+{
+	static const std::size_t localCapacity = std::string().capacity();
+	if(s.capacity() > localCapacity) {
+		return MemoryUsage(s.capacity() + 1, 1);
+	}
+	return MemoryUsage();
+}
+
+// The blocks and the block map of std::deque.
+template <typename T>
+MemoryUsage getDequeUsage(const std::deque<T> & deque)
+{
+	const std::size_t size = deque.size();
+#if defined(_LIBCPP_VERSION)
+	const std::size_t blockElementCount = (sizeof(T) < 256 ? 4096 / sizeof(T) : 16);
+	const std::size_t blockCount = (size + blockElementCount - 1) / blockElementCount;
+	if(blockCount == 0) {
+		return MemoryUsage();
+	}
+	return MemoryUsage(blockCount * blockElementCount * sizeof(T) + blockCount * sizeof(void *), blockCount + 1);
+#elif defined(_MSC_VER)
+	const std::size_t blockElementCount = (sizeof(T) <= 1 ? 16 : sizeof(T) <= 2 ? 8 : sizeof(T) <= 4 ? 4 : sizeof(T) <= 8 ? 2 : 1);
+	const std::size_t blockCount = (size + blockElementCount - 1) / blockElementCount;
+	if(blockCount == 0) {
+		return MemoryUsage();
+	}
+	std::size_t mapSize = 8;
+	while(mapSize < blockCount) {
+		mapSize *= 2;
+	}
+	return MemoryUsage(blockCount * blockElementCount * sizeof(T) + mapSize * sizeof(void *), blockCount + 1);
+#else
+	// libstdc++ always allocates the map and one block, even if the deque is empty.
+	const std::size_t blockElementCount = (sizeof(T) < 512 ? 512 / sizeof(T) : 1);
+	const std::size_t blockCount = size / blockElementCount + 1;
+	const std::size_t mapSize = std::max<std::size_t>(8, blockCount + 2);
+	return MemoryUsage(blockCount * blockElementCount * sizeof(T) + mapSize * sizeof(void *), blockCount + 1);
+#endif
+}
+
+} // namespace
+
+class MetaMemoryCounter
+{
+public:
+	MetaMemoryCounter(MemoryReport & report, MemoryReportEntry & entry)
+		: report(report), entry(entry)
+	{
+	}
+
+	void countMetaRepo(const MetaRepo * metaRepo)
+	{
+		add(MemoryKind::object, MemoryUsage(sizeof(MetaRepo), 0));
+		countMetaRepoBase(*metaRepo);
+		countItemData(metaRepo->repoData);
+
+		const auto & classInfoMap = metaRepo->classInfoMap;
+		add(MemoryKind::inheritance, getMapNodeUsage(classInfoMap));
+		for(const auto & item : classInfoMap) {
+			add(MemoryKind::inheritance, getDequeUsage(item.second.baseList));
+			add(MemoryKind::inheritance, getDequeUsage(item.second.derivedList));
+		}
+	}
+
+	void countMetaClass(const MetaClass * metaClass)
+	{
+		add(MemoryKind::object, MemoryUsage(sizeof(MetaClass), 0));
+		countMetaRepoBase(*metaClass);
+		countMetaItem(metaClass->constructorItem);
+	}
+
+	void countMetaEnum(const MetaEnum * metaEnum)
+	{
+		add(MemoryKind::object, MemoryUsage(sizeof(MetaEnum), 0));
+		add(MemoryKind::itemList, getDequeUsage(metaEnum->valueList));
+		add(MemoryKind::nameIndex, getMapNodeUsage(metaEnum->nameValueMap));
+		add(MemoryKind::nameIndex, getMapNodeUsage(metaEnum->valueNameMap));
+		for(const MetaItem & item : metaEnum->valueList) {
+			countMetaItem(item);
+		}
+	}
+
+private:
+	void add(const MemoryKind kind, const MemoryUsage & usage)
+	{
+		entry.usageList[(std::size_t)kind] += usage;
+	}
+
+	// Returns true if the block is not counted yet.
+	bool visit(const void * address)
+	{
+		return report.visitedSet.insert(address).second;
+	}
+
+	void countMetaRepoBase(const MetaRepoBase & repoBase)
+	{
+		countItemData(repoBase.accessibleData);
+		countItemData(repoBase.callableData);
+		countItemData(repoBase.constantData);
+		if(countItemData(repoBase.typeData)) {
+			add(MemoryKind::nameIndex, getMapNodeUsage(repoBase.typeData->kindTypeMap));
+			add(MemoryKind::nameIndex, getMapNodeUsage(repoBase.typeData->typeTypeMap));
+		}
+	}
+
+	template <typename T>
+	bool countItemData(const std::shared_ptr<T> & itemData)
+	{
+		if(! itemData || ! visit(itemData.get())) {
+			return false;
+		}
+		add(MemoryKind::itemList, getSharedBlockUsage<T>());
+		add(MemoryKind::itemList, getDequeUsage(itemData->itemList));
+		add(MemoryKind::nameIndex, getMapNodeUsage(itemData->nameItemMap));
+		for(const MetaItem & item : itemData->itemList) {
+			countMetaItem(item);
+		}
+		return true;
+	}
+
+	void countMetaItem(const MetaItem & item)
+	{
+		if(item.data && visit(item.data.get())) {
+			add(MemoryKind::itemData, getSharedBlockUsage<MetaItem::Data>());
+			add(MemoryKind::name, getStringUsage(item.data->name));
+			countVariant(item.data->target, MemoryKind::target);
+		}
+		if(item.annotationMap && visit(item.annotationMap.get())) {
+			add(MemoryKind::annotation, getSharedBlockUsage<std::map<std::string, Variant> >());
+			add(MemoryKind::annotation, getMapNodeUsage(*item.annotationMap));
+			for(const auto & annotation : *item.annotationMap) {
+				add(MemoryKind::annotation, getStringUsage(annotation.first));
+				countVariant(annotation.second, MemoryKind::annotation);
+			}
+		}
+	}
+
+	void countVariant(const Variant & value, const MemoryKind kind)
+	{
+		const MetaType * metaType = value.getMetaType();
+		if(metaType == nullptr || metaType->isReference()) {
+			return;
+		}
+		const void * address = value.getAddress();
+		// The value is stored in the Variant.
+		if(address == nullptr
+			|| ((const char *)address >= (const char *)&value && (const char *)address < (const char *)(&value + 1))) {
+			return;
+		}
+		if(! visit(address)) {
+			return;
+		}
+		if(metaType->getTypeKind() == tkOverloadedFunction) {
+			const auto & callableList = static_cast<const OverloadedFunction *>(address)->getCallableList();
+			add(MemoryKind::overloadedFunction, getSharedBlockUsage<OverloadedFunction>());
+			add(MemoryKind::overloadedFunction, getDequeUsage(callableList));
+			for(const Variant & callable : callableList) {
+				countVariant(callable, MemoryKind::overloadedFunction);
+			}
+		}
+		else {
+			// The size of the object is not known.
+			add(kind, MemoryUsage(sharedBlockHeaderSize, 1));
+		}
+	}
+
+private:
+	MemoryReport & report;
+	MemoryReportEntry & entry;
+};
+
+} // namespace internal_
+
+MemoryUsage MemoryReportEntry::getTotal() const
+{
+	MemoryUsage total;
+	for(const MemoryUsage & usage : usageList) {
+		total += usage;
+	}
+	return total;
+}
+
+MemoryReport::MemoryReport()
+	: entryList(), sourceSet(), visitedSet()
+{
+}
+
+void MemoryReport::addMetaRepo(const MetaRepo * metaRepo, const std::string & name)
+{
+	if(metaRepo == nullptr || sourceSet.count(metaRepo) > 0) {
+		return;
+	}
+	MemoryReportEntry & entry = doAddEntry(MemoryReportEntry::Source::metaRepo, name, metaRepo);
+	internal_::MetaMemoryCounter(*this, entry).countMetaRepo(metaRepo);
+
+	const std::string prefix = (name.empty() ? name : name + "::");
+	for(const MetaItem & item : metaRepo->getTypeView()) {
+		const MetaType * metaType = getNonReferenceMetaType(item.asMetaType());
+		const std::string typeName = prefix + item.getName();
+		if(metaType->getMetaClass() != nullptr) {
+			addMetaClass(metaType->getMetaClass(), typeName);
+		}
+		if(metaType->getMetaEnum() != nullptr) {
+			addMetaEnum(metaType->getMetaEnum(), typeName);
+		}
+	}
+	for(const MetaItem & item : metaRepo->getRepoView()) {
+		addMetaRepo(item.asMetaRepo(), prefix + item.getName());
+	}
+}
+
+void MemoryReport::addMetaClass(const MetaClass * metaClass, const std::string & name)
+{
+	if(metaClass == nullptr || sourceSet.count(metaClass) > 0) {
+		return;
+	}
+	MemoryReportEntry & entry = doAddEntry(MemoryReportEntry::Source::metaClass, name, metaClass);
+	internal_::MetaMemoryCounter(*this, entry).countMetaClass(metaClass);
+}
+
+void MemoryReport::addMetaEnum(const MetaEnum * metaEnum, const std::string & name)
+{
+	if(metaEnum == nullptr || sourceSet.count(metaEnum) > 0) {
+		return;
+	}
+	MemoryReportEntry & entry = doAddEntry(MemoryReportEntry::Source::metaEnum, name, metaEnum);
+	internal_::MetaMemoryCounter(*this, entry).countMetaEnum(metaEnum);
+}
+
+void MemoryReport::addAllMetaRepos()
+{
+	int index = 0;
+	for(const MetaRepo * metaRepo : *getMetaRepoList()) {
+		addMetaRepo(metaRepo, "repo#" + std::to_string(index));
+		++index;
+	}
+}
+
+MemoryUsage MemoryReport::getTotal() const
+{
+	MemoryUsage total;
+	for(const MemoryReportEntry & entry : entryList) {
+		total += entry.getTotal();
+	}
+	return total;
+}
+
+MemoryUsage MemoryReport::getTotal(const MemoryKind kind) const
+{
+	MemoryUsage total;
+	for(const MemoryReportEntry & entry : entryList) {
+		total += entry.getUsage(kind);
+	}
+	return total;
+}
+
+MemoryUsage MemoryReport::getTotal(const MemoryReportEntry::Source source) const
+{
+	MemoryUsage total;
+	for(const MemoryReportEntry & entry : entryList) {
+		if(entry.source == source) {
+			total += entry.getTotal();
+		}
+	}
+	return total;
+}
+
+void MemoryReport::write(std::ostream & stream, const std::size_t maxEntryCount) const
+{
+	const char * const sourceNameList[] = { "metaRepo", "metaClass", "metaEnum" };
+
+	const auto flags = stream.flags();
+	stream << std::left << std::setw(24) << "Kind" << std::right
+		<< std::setw(14) << "Bytes" << std::setw(14) << "Allocations" << std::endl;
+	for(std::size_t i = 0; i < memoryKindCount; ++i) {
+		const MemoryUsage usage = getTotal((MemoryKind)i);
+		stream << std::left << std::setw(24) << getMemoryKindName((MemoryKind)i) << std::right
+			<< std::setw(14) << usage.byteCount << std::setw(14) << usage.allocationCount << std::endl;
+	}
+	const MemoryUsage total = getTotal();
+	stream << std::left << std::setw(24) << "total" << std::right
+		<< std::setw(14) << total.byteCount << std::setw(14) << total.allocationCount << std::endl;
+
+	stream << std::endl << std::left << std::setw(24) << "Source" << std::right
+		<< std::setw(14) << "Bytes" << std::setw(14) << "Allocations" << std::setw(10) << "Count" << std::endl;
+	for(std::size_t i = 0; i < 3; ++i) {
+		const MemoryReportEntry::Source source = (MemoryReportEntry::Source)i;
+		const MemoryUsage usage = getTotal(source);
+		const auto count = std::count_if(entryList.begin(), entryList.end(), [source](const MemoryReportEntry & entry) {
+			return entry.source == source;
+		});
+		stream << std::left << std::setw(24) << sourceNameList[i] << std::right
+			<< std::setw(14) << usage.byteCount << std::setw(14) << usage.allocationCount
+			<< std::setw(10) << count << std::endl;
+	}
+
+	std::vector<const MemoryReportEntry *> sortedList;
+	for(const MemoryReportEntry & entry : entryList) {
+		sortedList.push_back(&entry);
+	}
+	std::stable_sort(sortedList.begin(), sortedList.end(), [](const MemoryReportEntry * a, const MemoryReportEntry * b) {
+		return a->getTotal().byteCount > b->getTotal().byteCount;
+	});
+	if(maxEntryCount > 0 && sortedList.size() > maxEntryCount) {
+		sortedList.resize(maxEntryCount);
+	}
+	std::size_t nameWidth = 4;
+	for(const MemoryReportEntry * entry : sortedList) {
+		nameWidth = std::max(nameWidth, entry->name.size());
+	}
+	stream << std::endl << std::left << std::setw((int)nameWidth) << "Name"
+		<< std::setw(12) << "  Source" << std::right
+		<< std::setw(14) << "Bytes" << std::setw(14) << "Allocations" << std::endl;
+	for(const MemoryReportEntry * entry : sortedList) {
+		const MemoryUsage usage = entry->getTotal();
+		stream << std::left << std::setw((int)nameWidth) << entry->name
+			<< "  " << std::setw(10) << sourceNameList[(std::size_t)entry->source] << std::right
+			<< std::setw(14) << usage.byteCount << std::setw(14) << usage.allocationCount << std::endl;
+	}
+	stream.flags(flags);
+}
+
+MemoryReportEntry & MemoryReport::doAddEntry(const MemoryReportEntry::Source source, const std::string & name, const void * address)
+{
+	sourceSet.insert(address);
+	entryList.push_back(MemoryReportEntry());
+	MemoryReportEntry & entry = entryList.back();
+	entry.source = source;
+	entry.name = name;
+	entry.address = address;
+	return entry;
+}
+
+const char * getMemoryKindName(const MemoryKind kind)
+{
+	switch(kind) {
+	case MemoryKind::object:
+		return "object";
+
+	case MemoryKind::itemList:
+		return "itemList";
+
+	case MemoryKind::nameIndex:
+		return "nameIndex";
+
+	case MemoryKind::itemData:
+		return "itemData";
+
+	case MemoryKind::name:
+		return "name";
+
+	case MemoryKind::annotation:
+		return "annotation";
+
+	case MemoryKind::target:
+		return "target";
+
+	case MemoryKind::overloadedFunction:
+		return "overloadedFunction";
+
+	case MemoryKind::inheritance:
+		return "inheritance";
+	}
+	return "";
+}
+
+
+} // namespace metapp
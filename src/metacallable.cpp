@@ -0,0 +1,65 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/interfaces/metacallable.h"
+#include "metapp/metatypes/overloaded_function.h"
+#include "metapp/allmetatypes.h"
+
+namespace metapp {
+
+namespace internal_ {
+
+ErrorCode tryInvokeCallable(
+	Variant * result,
+	const Variant & callable,
+	const Variant & instance,
+	const ArgumentSpan & arguments
+)
+{
+	const MetaType * metaType = getNonReferenceMetaType(callable);
+	const MetaCallable * metaCallable = metaType->getMetaCallable();
+	if(metaCallable == nullptr) {
+		return ErrorCode::unsupported;
+	}
+	const Variant * target = &callable;
+	// Rank the overloads only once, then invoke the chosen one directly,
+	// OverloadedFunction::invoke would rank them again.
+	if(metaType->getTypeKind() == tkOverloadedFunction) {
+		const auto & callableList = callable.get<const OverloadedFunction &>().getCallableList();
+		auto it = findCallable(callableList.begin(), callableList.end(), instance, arguments, nullptr);
+		if(it == callableList.end()) {
+			return ErrorCode::illegalArgument;
+		}
+		target = &*it;
+		metaCallable = getNonReferenceMetaType(*target)->getMetaCallable();
+	}
+	else if(metaCallable->rankInvoke(callable, instance, arguments) == invokeRankNone) {
+		return ErrorCode::illegalArgument;
+	}
+	if(result != nullptr) {
+		*result = metaCallable->invoke(*target, instance, arguments);
+	}
+	else {
+		metaCallable->invoke(*target, instance, arguments);
+	}
+	return ErrorCode::ok;
+}
+
+} // namespace internal_
+
+} // namespace metapp
+
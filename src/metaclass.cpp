@@ -19,8 +19,43 @@
 #include "metapp/metarepo.h"
 #include "metapp/allmetatypes.h"
 
+#include <array>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
 namespace metapp {
 
+// Building a view including base classes traverses the class hierarchy, which is much slower than copying a view.
+// The class list is rebuilt when the class hierarchy changes (the inheritance generation).
+// The cached views are rebuilt when the class list changes, or the items in this class or its bases change,
+// the registrations in other classes don't invalidate the cache.
+// If nothing is registered anywhere since an entry is validated, the entry is used without checking the classes.
+struct MetaClass::ViewCache
+{
+	struct Entry
+	{
+		Entry() : registrationGeneration(0), classList(), itemGeneration(0), view() {
+		}
+
+		std::uint64_t registrationGeneration;
+		std::shared_ptr<const std::vector<const MetaClass *> > classList;
+		std::uint64_t itemGeneration;
+		MetaItemView view;
+	};
+
+	using ClassList = std::vector<const MetaClass *>;
+
+	ViewCache() : mutex(), entryList(), classListGeneration(0), classList() {
+	}
+
+	std::mutex mutex;
+	std::array<Entry, (std::size_t)ViewKind::count> entryList;
+	// The meta classes of this class and all its bases, used by the views and the queries
+	std::uint64_t classListGeneration;
+	std::shared_ptr<const ClassList> classList;
+};
+
 namespace internal_ {
 
 extern MetaItem emptyMetaItem;
@@ -57,7 +92,7 @@ const MetaItem & MetaClass::getAccessible(const std::string & name, const Flags
 
 MetaItemView MetaClass::getAccessibleView(const Flags flags) const
 {
-	return doBuildMetaItemView(&MetaClass::doGetAccessibleList, flags);
+	return doGetMetaItemView(&MetaClass::doGetAccessibleList, ViewKind::accessible, flags);
 }
 
 const MetaItem & MetaClass::getCallable(const std::string & name, const Flags flags) const
@@ -67,7 +102,7 @@ const MetaItem & MetaClass::getCallable(const std::string & name, const Flags fl
 
 MetaItemView MetaClass::getCallableView(const Flags flags) const
 {
-	return doBuildMetaItemView(&MetaClass::doGetCallableList, flags);
+	return doGetMetaItemView(&MetaClass::doGetCallableList, ViewKind::callable, flags);
 }
 
 const MetaItem & MetaClass::getVariable(const std::string & name, const Flags flags) const
@@ -77,7 +112,7 @@ const MetaItem & MetaClass::getVariable(const std::string & name, const Flags fl
 
 MetaItemView MetaClass::getVariableView(const Flags flags) const
 {
-	return doBuildMetaItemView(&MetaClass::doGetVariableList, flags);
+	return doGetMetaItemView(&MetaClass::doGetVariableList, ViewKind::variable, flags);
 }
 
 const MetaItem & MetaClass::getType(const std::string & name, const Flags flags) const
@@ -129,7 +164,7 @@ const MetaItem & MetaClass::getType(const MetaType * metaType, const Flags flags
 
 MetaItemView MetaClass::getTypeView(const Flags flags) const
 {
-	return doBuildMetaItemView(&MetaClass::doGetTypeList, flags);
+	return doGetMetaItemView(&MetaClass::doGetTypeList, ViewKind::type, flags);
 }
 
 const MetaItem & MetaClass::getItem(const std::string & name) const
@@ -137,25 +172,133 @@ const MetaItem & MetaClass::getItem(const std::string & name) const
 	return doGetItem(name);
 }
 
-MetaItemView MetaClass::doBuildMetaItemView(
+MetaItemPointerList MetaClass::findCallablesByArity(const int arity, const Flags flags) const
+{
+	return doFindItems([arity](const MetaClass * metaClass, MetaItemPointerList & result) {
+		metaClass->doFindCallablesByArity(result, arity);
+	}, flags);
+}
+
+MetaItemPointerList MetaClass::findCallablesByParameter(
+		const int arity,
+		const int parameterIndex,
+		const MetaType * parameterType,
+		const Flags flags
+	) const
+{
+	return doFindItems([arity, parameterIndex, parameterType](const MetaClass * metaClass, MetaItemPointerList & result) {
+		metaClass->doFindCallablesByParameter(result, arity, parameterIndex, parameterType);
+	}, flags);
+}
+
+MetaItemPointerList MetaClass::findCallablesByReturnType(const MetaType * returnType, const Flags flags) const
+{
+	return doFindItems([returnType](const MetaClass * metaClass, MetaItemPointerList & result) {
+		metaClass->doFindCallablesByReturnType(result, returnType);
+	}, flags);
+}
+
+MetaItemPointerList MetaClass::findItemsByAnnotation(const std::string & name, const Flags flags) const
+{
+	return doFindItems([&name](const MetaClass * metaClass, MetaItemPointerList & result) {
+		metaClass->doFindItemsByAnnotation(result, name);
+	}, flags);
+}
+
+MetaItemPointerList MetaClass::findItemsByAnnotationValue(const std::string & name, const Variant & value, const Flags flags) const
+{
+	return doFindItems([&name, &value](const MetaClass * metaClass, MetaItemPointerList & result) {
+		metaClass->doFindItemsByAnnotationValue(result, name, value);
+	}, flags);
+}
+
+std::shared_ptr<MetaClass::ViewCache> MetaClass::doCreateViewCache()
+{
+	return std::make_shared<ViewCache>();
+}
+
+MetaItemView MetaClass::doGetMetaItemView(
 		const MetaItemList & (MetaClass::*listGetter)() const,
+		const ViewKind viewKind,
 		const Flags flags
 	) const
 {
+	if(! hasFlag(flags, flagIncludeBase)) {
+		MetaItemView view;
+		view.addContainer(&(this->*listGetter)());
+		return view;
+	}
+
+	ViewCache::Entry & entry = viewCache->entryList[(std::size_t)viewKind];
+	// Get the generations before building, so the registrations happen during building make the entry stale.
+	const std::uint64_t registrationGeneration = internal_::getRegistrationGeneration();
+	{
+		std::lock_guard<std::mutex> lock(viewCache->mutex);
+		if(entry.registrationGeneration == registrationGeneration) {
+			return entry.view;
+		}
+	}
+	const std::shared_ptr<const ViewCache::ClassList> classList = doGetClassList();
+	std::uint64_t itemGeneration = 0;
+	for(const MetaClass * metaClass : *classList) {
+		itemGeneration = std::max(itemGeneration, metaClass->doGetItemGeneration());
+	}
+	{
+		std::lock_guard<std::mutex> lock(viewCache->mutex);
+		if(entry.classList == classList && entry.itemGeneration == itemGeneration) {
+			entry.registrationGeneration = registrationGeneration;
+			return entry.view;
+		}
+	}
 	MetaItemView view;
+	for(const MetaClass * metaClass : *classList) {
+		view.addContainer(&(metaClass->*listGetter)());
+	}
+	std::lock_guard<std::mutex> lock(viewCache->mutex);
+	entry.registrationGeneration = registrationGeneration;
+	entry.classList = classList;
+	entry.itemGeneration = itemGeneration;
+	entry.view = view;
+	return view;
+}
+
+std::shared_ptr<const std::vector<const MetaClass *> > MetaClass::doGetClassList() const
+{
+	{
+		std::lock_guard<std::mutex> lock(viewCache->mutex);
+		if(viewCache->classListGeneration == internal_::getInheritanceGeneration()) {
+			return viewCache->classList;
+		}
+	}
+	const std::uint64_t generation = internal_::getInheritanceGeneration();
+	std::shared_ptr<ViewCache::ClassList> classList = std::make_shared<ViewCache::ClassList>();
+	getMetaRepoList()->traverseBases(classMetaType, [&classList](const MetaType * metaType) -> bool {
+		const MetaClass * metaClass = metaType->getMetaClass();
+		if(metaClass != nullptr) {
+			classList->push_back(metaClass);
+		}
+		return true;
+		});
+	std::lock_guard<std::mutex> lock(viewCache->mutex);
+	viewCache->classListGeneration = generation;
+	viewCache->classList = classList;
+	return classList;
+}
+
+template <typename FT>
+MetaItemPointerList MetaClass::doFindItems(FT && finder, const Flags flags) const
+{
+	MetaItemPointerList result;
 	if(hasFlag(flags, flagIncludeBase)) {
-		getMetaRepoList()->traverseBases(classMetaType, [&view, &listGetter](const MetaType * metaType) -> bool {
-			const MetaClass * metaClass = metaType->getMetaClass();
-			if(metaClass != nullptr) {
-				view.addContainer(&(metaClass->*listGetter)());
-			}
-			return true;
-			});
+		const std::shared_ptr<const ViewCache::ClassList> classList = doGetClassList();
+		for(const MetaClass * metaClass : *classList) {
+			finder(metaClass, result);
+		}
 	}
 	else {
-		view.addContainer(&(this->*listGetter)());
+		finder(this, result);
 	}
-	return view;
+	return result;
 }
 
 const MetaItem & MetaClass::doFindItemByName(
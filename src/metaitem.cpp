@@ -32,12 +32,12 @@ extern std::string emptyString;
 } // namespace internal_
 
 MetaItem::MetaItem()
-	: data()
+	: data(), annotationMap()
 {
 }
 
 MetaItem::MetaItem(const Type type, const std::string & name, const Variant & target)
-	: data(std::make_shared<Data>(type, name, target))
+	: data(std::make_shared<Data>(type, name, target)), annotationMap()
 {
 }
 
@@ -103,6 +103,7 @@ void MetaItem::registerAnnotation(const std::string & name, const Variant & valu
 		annotationMap = std::make_shared<std::map<std::string, Variant> >();
 	}
 	annotationMap->insert(std::make_pair(name, value));
+	doIncreaseOwnerGeneration();
 }
 
 const Variant & MetaItem::getAnnotation(const std::string & name) const
@@ -128,6 +129,24 @@ void MetaItem::setTarget(const Variant & target)
 {
 	if(data) {
 		data->target = target;
+		doIncreaseOwnerGeneration();
+	}
+}
+
+void MetaItem::doSetOwnerGeneration(internal_::ScopedGeneration * generation)
+{
+	if(data) {
+		data->ownerGeneration = generation;
+	}
+}
+
+void MetaItem::doIncreaseOwnerGeneration()
+{
+	if(data && data->ownerGeneration != nullptr) {
+		data->ownerGeneration->increase();
+	}
+	else {
+		internal_::increaseRegistrationGeneration();
 	}
 }
 
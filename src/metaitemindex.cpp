@@ -0,0 +1,335 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "metapp/implement/internal/metaitemindex_i.h"
+#include "metapp/metaitem.h"
+#include "metapp/metatype.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/implement/internal/inheritancerepo_i.h"
+
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <utility>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+// A callable accepting more parameters than this is variadic,
+// it's only found by arity, and not indexed by parameter types.
+constexpr int maxIndexedParameterCount = 32;
+
+struct ParameterKey
+{
+	int arity;
+	int parameterIndex;
+	const MetaType * parameterType;
+};
+
+struct ParameterKeyLess
+{
+	bool operator() (const ParameterKey & a, const ParameterKey & b) const {
+		if(a.arity != b.arity) {
+			return a.arity < b.arity;
+		}
+		if(a.parameterIndex != b.parameterIndex) {
+			return a.parameterIndex < b.parameterIndex;
+		}
+		return MetaTypeLess()(a.parameterType, b.parameterType);
+	}
+};
+
+struct AnnotatedItem
+{
+	const MetaItem * item;
+	const Variant * value;
+};
+
+// Parameter and return types are indexed without reference, so `const T &`, `T &` and `T` are found by `T`.
+const MetaType * normalizeIndexedType(const MetaType * metaType)
+{
+	return getNonReferenceMetaType(metaType);
+}
+
+void addUniqueItem(MetaItemPointerList & itemList, const MetaItem * item)
+{
+	// The items are added in order, so the duplicated item can only be the last one.
+	if(itemList.empty() || itemList.back() != item) {
+		itemList.push_back(item);
+	}
+}
+
+bool getAnnotationString(const Variant & value, std::string * result)
+{
+	const MetaType * metaType = getNonReferenceMetaType(value);
+	if(metaType->isArithmetic() || metaType->isEnum() || ! value.canCast<std::string>()) {
+		return false;
+	}
+	*result = value.cast<std::string>().get<const std::string &>();
+	return true;
+}
+
+double getAnnotationDouble(const Variant & value)
+{
+	if(getNonReferenceMetaType(value)->isEnum()) {
+		return (double)value.cast<long long>().get<long long>();
+	}
+	return value.cast<double>().get<double>();
+}
+
+// Annotations are arbitrary Variants, only strings and arithmetic values (including enums) are comparable.
+bool isAnnotationValueEqual(const Variant & a, const Variant & b)
+{
+	std::string textA;
+	std::string textB;
+	const bool isTextA = getAnnotationString(a, &textA);
+	const bool isTextB = getAnnotationString(b, &textB);
+	if(isTextA || isTextB) {
+		return isTextA && isTextB && textA == textB;
+	}
+	const MetaType * metaTypeA = getNonReferenceMetaType(a);
+	const MetaType * metaTypeB = getNonReferenceMetaType(b);
+	if(! (metaTypeA->isArithmetic() || metaTypeA->isEnum()) || ! (metaTypeB->isArithmetic() || metaTypeB->isEnum())) {
+		return false;
+	}
+	if(metaTypeA->isFloat() || metaTypeB->isFloat()) {
+		return getAnnotationDouble(a) == getAnnotationDouble(b);
+	}
+	return a.cast<long long>().get<long long>() == b.cast<long long>().get<long long>();
+}
+
+} // namespace
+
+class MetaItemIndexData
+{
+public:
+	MetaItemIndexData()
+		:
+			mutex(),
+			generation(0),
+			arityMap(),
+			variadicList(),
+			parameterMap(),
+			returnTypeMap(),
+			annotationMap(),
+			annotationTextMap()
+	{
+	}
+
+	// Must be called with mutex locked
+	void prepare(const MetaItemIndex::ItemListSet & itemListSet, const std::uint64_t currentGeneration) {
+		if(generation == currentGeneration) {
+			return;
+		}
+		clear();
+		for(const std::deque<MetaItem> * itemList : itemListSet) {
+			for(const MetaItem & item : *itemList) {
+				if(item.getType() == MetaItem::Type::callable) {
+					addCallable(&item, item.asCallable());
+				}
+				addAnnotations(&item);
+			}
+		}
+		generation = currentGeneration;
+	}
+
+	void clear() {
+		arityMap.clear();
+		variadicList.clear();
+		parameterMap.clear();
+		returnTypeMap.clear();
+		annotationMap.clear();
+		annotationTextMap.clear();
+	}
+
+private:
+	void addCallable(const MetaItem * item, const Variant & callable) {
+		if(getNonReferenceMetaType(callable)->getTypeKind() == tkOverloadedFunction) {
+			for(const Variant & overload : callable.get<const OverloadedFunction &>().getCallableList()) {
+				addCallable(item, overload);
+			}
+			return;
+		}
+
+		const MetaCallable::ParameterCountInfo countInfo = callableGetParameterCountInfo(callable);
+		addUniqueItem(returnTypeMap[normalizeIndexedType(callableGetReturnType(callable))], item);
+		if(countInfo.getMaxParameterCount() > maxIndexedParameterCount) {
+			addUniqueItem(variadicList, item);
+			return;
+		}
+		// Functions with default arguments are indexed for each acceptable arity.
+		for(int arity = countInfo.getMinParameterCount(); arity <= countInfo.getMaxParameterCount(); ++arity) {
+			addUniqueItem(arityMap[arity], item);
+			for(int i = 0; i < arity; ++i) {
+				const ParameterKey key { arity, i, normalizeIndexedType(callableGetParameterType(callable, i)) };
+				addUniqueItem(parameterMap[key], item);
+			}
+		}
+	}
+
+	void addAnnotations(const MetaItem * item) {
+		for(const auto & annotation : item->getAllAnnotations()) {
+			annotationMap[annotation.first].push_back(AnnotatedItem { item, &annotation.second });
+			std::string text;
+			if(getAnnotationString(annotation.second, &text)) {
+				annotationTextMap[std::make_pair(annotation.first, text)].push_back(item);
+			}
+		}
+	}
+
+public:
+	std::mutex mutex;
+	std::uint64_t generation;
+
+	std::map<int, MetaItemPointerList> arityMap;
+	// The callables accepting unlimited parameters, sorted in the registered order
+	MetaItemPointerList variadicList;
+	std::map<ParameterKey, MetaItemPointerList, ParameterKeyLess> parameterMap;
+	std::map<const MetaType *, MetaItemPointerList, MetaTypeLess> returnTypeMap;
+	std::map<std::string, std::vector<AnnotatedItem> > annotationMap;
+	std::map<std::pair<std::string, std::string>, MetaItemPointerList> annotationTextMap;
+};
+
+namespace {
+
+template <typename Map, typename Key>
+void appendFoundItems(MetaItemPointerList & result, const Map & map, const Key & key)
+{
+	auto it = map.find(key);
+	if(it != map.end()) {
+		result.insert(result.end(), it->second.begin(), it->second.end());
+	}
+}
+
+} // namespace
+
+MetaItemIndex::MetaItemIndex()
+	: data(new MetaItemIndexData())
+{
+}
+
+MetaItemIndex::~MetaItemIndex()
+{
+}
+
+MetaItemIndex::MetaItemIndex(const MetaItemIndex & /*other*/)
+	: MetaItemIndex()
+{
+}
+
+MetaItemIndex & MetaItemIndex::operator = (const MetaItemIndex & other)
+{
+	if(this != &other) {
+		std::lock_guard<std::mutex> lock(data->mutex);
+		data->clear();
+		data->generation = 0;
+	}
+	return *this;
+}
+
+void MetaItemIndex::findCallablesByArity(
+		MetaItemPointerList & result,
+		const ItemListSet & itemListSet,
+		const std::uint64_t itemGeneration,
+		const int arity
+	) const
+{
+	std::lock_guard<std::mutex> lock(data->mutex);
+	data->prepare(itemListSet, itemGeneration);
+	appendFoundItems(result, data->arityMap, arity);
+	for(const MetaItem * item : data->variadicList) {
+		if(callableGetParameterCountInfo(item->asCallable()).getMinParameterCount() <= arity) {
+			result.push_back(item);
+		}
+	}
+}
+
+void MetaItemIndex::findCallablesByParameter(
+		MetaItemPointerList & result,
+		const ItemListSet & itemListSet,
+		const std::uint64_t itemGeneration,
+		const int arity,
+		const int parameterIndex,
+		const MetaType * parameterType
+	) const
+{
+	std::lock_guard<std::mutex> lock(data->mutex);
+	data->prepare(itemListSet, itemGeneration);
+	appendFoundItems(result, data->parameterMap, ParameterKey { arity, parameterIndex, normalizeIndexedType(parameterType) });
+}
+
+void MetaItemIndex::findCallablesByReturnType(
+		MetaItemPointerList & result,
+		const ItemListSet & itemListSet,
+		const std::uint64_t itemGeneration,
+		const MetaType * returnType
+	) const
+{
+	std::lock_guard<std::mutex> lock(data->mutex);
+	data->prepare(itemListSet, itemGeneration);
+	appendFoundItems(result, data->returnTypeMap, normalizeIndexedType(returnType));
+}
+
+void MetaItemIndex::findItemsByAnnotation(
+		MetaItemPointerList & result,
+		const ItemListSet & itemListSet,
+		const std::uint64_t itemGeneration,
+		const std::string & name
+	) const
+{
+	std::lock_guard<std::mutex> lock(data->mutex);
+	data->prepare(itemListSet, itemGeneration);
+	auto it = data->annotationMap.find(name);
+	if(it != data->annotationMap.end()) {
+		for(const AnnotatedItem & annotatedItem : it->second) {
+			result.push_back(annotatedItem.item);
+		}
+	}
+}
+
+void MetaItemIndex::findItemsByAnnotationValue(
+		MetaItemPointerList & result,
+		const ItemListSet & itemListSet,
+		const std::uint64_t itemGeneration,
+		const std::string & name,
+		const Variant & value
+	) const
+{
+	std::lock_guard<std::mutex> lock(data->mutex);
+	data->prepare(itemListSet, itemGeneration);
+	std::string text;
+	if(getAnnotationString(value, &text)) {
+		appendFoundItems(result, data->annotationTextMap, std::make_pair(name, text));
+		return;
+	}
+	auto it = data->annotationMap.find(name);
+	if(it != data->annotationMap.end()) {
+		for(const AnnotatedItem & annotatedItem : it->second) {
+			if(isAnnotationValueEqual(*annotatedItem.value, value)) {
+				result.push_back(annotatedItem.item);
+			}
+		}
+	}
+}
+
+
+} // namespace internal_
+
+} // namespace metapp
+
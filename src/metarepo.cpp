@@ -17,11 +17,158 @@
 #include "metapp/metatype.h"
 #include "metapp/metarepo.h"
 #include "metapp/allmetatypes.h"
+#include "metapp/utilities/utility.h"
+#include "metapp/implement/internal/copyonwrite_i.h"
+
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
 
 namespace metapp {
 
 namespace internal_ {
 
+namespace {
+
+std::atomic<std::uint64_t> registrationGeneration(1);
+std::atomic<std::uint64_t> inheritanceGeneration(1);
+
+// Maps std::type_info of the most derived object to the entry, and the static meta type to the entry
+// which can get the std::type_info of an object.
+// The maps keyed by the addresses are probed first, they always hit in a single module. The maps keyed by
+// std::type_index and by comparing meta types are used for the types which come from other modules.
+// The tables are a CopyOnWriteValue, so finding an entry doesn't lock, and the replaced tables are freed
+// once no reader uses them. The entries are never freed, so the pointers found by readers are always valid.
+class PolymorphicTypeRegistry
+{
+private:
+	struct Tables
+	{
+		std::unordered_map<const std::type_info *, const PolymorphicTypeEntry *> typeInfoAddressMap;
+		std::unordered_map<std::type_index, const PolymorphicTypeEntry *> typeInfoMap;
+		std::unordered_map<const MetaType *, const PolymorphicTypeEntry *> metaTypeAddressMap;
+		std::map<const MetaType *, const PolymorphicTypeEntry *, MetaTypeLess> metaTypeMap;
+	};
+
+public:
+	PolymorphicTypeRegistry() : entryList(), tables() {
+	}
+
+	void registerType(const PolymorphicTypeEntry & entry) {
+		if(isRegistered(*tables.read(), entry)) {
+			return;
+		}
+		tables.update([this, &entry](Tables & newTables) -> bool {
+			if(isRegistered(newTables, entry)) {
+				return false;
+			}
+			entryList.emplace_back(new PolymorphicTypeEntry(entry));
+			const PolymorphicTypeEntry * newEntry = entryList.back().get();
+			newTables.typeInfoAddressMap[entry.typeInfo] = newEntry;
+			newTables.typeInfoMap[std::type_index(*entry.typeInfo)] = newEntry;
+			newTables.metaTypeAddressMap[entry.metaType] = newEntry;
+			for(const MetaType * cvMetaType : entry.cvMetaTypeList) {
+				newTables.metaTypeAddressMap[cvMetaType] = newEntry;
+			}
+			newTables.metaTypeMap[entry.metaType] = newEntry;
+			return true;
+		});
+	}
+
+	// Returns the entry of the most derived class, and adjusts *instance to point to the most derived object.
+	// Falls back to the static type if the dynamic type is not registered.
+	const PolymorphicTypeEntry * findDynamicTypeEntry(void ** instance, const MetaType * staticMetaType) const {
+		const auto reader = tables.read();
+		const PolymorphicTypeEntry * staticEntry = findByMetaType(*reader, staticMetaType);
+		if(staticEntry == nullptr) {
+			return nullptr;
+		}
+		const std::type_info & typeInfo = staticEntry->getDynamicTypeInfo(*instance);
+		if(typeInfo == *staticEntry->typeInfo) {
+			return staticEntry;
+		}
+		const PolymorphicTypeEntry * dynamicEntry = findByTypeInfo(*reader, typeInfo);
+		if(dynamicEntry == nullptr) {
+			return staticEntry;
+		}
+		*instance = staticEntry->getDynamicAddress(*instance);
+		return dynamicEntry;
+	}
+
+private:
+	static const PolymorphicTypeEntry * findByTypeInfo(const Tables & currentTables, const std::type_info & typeInfo) {
+		auto addressIt = currentTables.typeInfoAddressMap.find(&typeInfo);
+		if(addressIt != currentTables.typeInfoAddressMap.end()) {
+			return addressIt->second;
+		}
+		auto it = currentTables.typeInfoMap.find(std::type_index(typeInfo));
+		return it == currentTables.typeInfoMap.end() ? nullptr : it->second;
+	}
+
+	static const PolymorphicTypeEntry * findByMetaType(const Tables & currentTables, const MetaType * metaType) {
+		auto addressIt = currentTables.metaTypeAddressMap.find(metaType);
+		if(addressIt != currentTables.metaTypeAddressMap.end()) {
+			return addressIt->second;
+		}
+		auto it = currentTables.metaTypeMap.find(metaType);
+		return it == currentTables.metaTypeMap.end() ? nullptr : it->second;
+	}
+
+	static bool isRegistered(const Tables & currentTables, const PolymorphicTypeEntry & entry) {
+		return currentTables.typeInfoMap.find(std::type_index(*entry.typeInfo)) != currentTables.typeInfoMap.end();
+	}
+
+private:
+	// Only modified inside CopyOnWriteValue::update, which serializes the writers.
+	std::vector<std::unique_ptr<const PolymorphicTypeEntry> > entryList;
+	CopyOnWriteValue<Tables> tables;
+};
+
+PolymorphicTypeRegistry & getPolymorphicTypeRegistry()
+{
+	static PolymorphicTypeRegistry registry;
+	return registry;
+}
+
+const PolymorphicTypeEntry * findDynamicTypeEntry(void ** instance, const MetaType * staticMetaType)
+{
+	if(*instance == nullptr) {
+		return nullptr;
+	}
+	return getPolymorphicTypeRegistry().findDynamicTypeEntry(instance, staticMetaType);
+}
+
+} // namespace
+
+void registerPolymorphicType(const PolymorphicTypeEntry & entry)
+{
+	getPolymorphicTypeRegistry().registerType(entry);
+}
+
+std::uint64_t getRegistrationGeneration()
+{
+	return registrationGeneration.load(std::memory_order_acquire);
+}
+
+std::uint64_t increaseRegistrationGeneration()
+{
+	return registrationGeneration.fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+std::uint64_t getInheritanceGeneration()
+{
+	return inheritanceGeneration.load(std::memory_order_acquire);
+}
+
+void increaseInheritanceGeneration()
+{
+	inheritanceGeneration.fetch_add(1, std::memory_order_acq_rel);
+	increaseRegistrationGeneration();
+}
+
 Variant emptyVariant;
 std::string emptyString;
 MetaItem emptyMetaItem;
@@ -177,10 +324,25 @@ int InheritanceRepo::doFindDerivedClass(
 	return 0;
 }
 
-MetaItem & MetaRepoBase::ItemData::addItem(const MetaItem::Type type, const std::string & name, const Variant & target)
+MetaRepoBase::ItemData::~ItemData()
+{
+	// The copies of the items may outlive the repo, they must not refer to the generation.
+	for(MetaItem & item : itemList) {
+		item.doSetOwnerGeneration(nullptr);
+	}
+}
+
+MetaItem & MetaRepoBase::ItemData::addItem(
+		const MetaItem::Type type,
+		const std::string & name,
+		const Variant & target,
+		ScopedGeneration * generation
+	)
 {
 	itemList.emplace_back(type, name, target);
+	generation->increase();
 	MetaItem & item = itemList.back();
+	item.doSetOwnerGeneration(generation);
 	if(! item.getName().empty()) {
 		nameItemMap.insert(typename decltype(nameItemMap)::value_type(
 			item.getName(), &item
@@ -204,7 +366,9 @@ MetaRepoBase::MetaRepoBase()
 		accessibleData(),
 		callableData(),
 		constantData(),
-		typeData()
+		typeData(),
+		itemGeneration(),
+		itemIndex()
 {
 }
 
@@ -222,7 +386,7 @@ MetaItem & MetaRepoBase::registerAccessible(const std::string & name, const Vari
 	if(it != accessibleData->nameItemMap.end()) {
 		return *it->second;
 	}
-	return accessibleData->addItem(MetaItem::Type::accessible, name, accessible);
+	return accessibleData->addItem(MetaItem::Type::accessible, name, accessible, doRequireItemGeneration());
 }
 
 MetaItem & MetaRepoBase::registerCallable(const std::string & name, const Variant & callable)
@@ -241,7 +405,7 @@ MetaItem & MetaRepoBase::registerCallable(const std::string & name, const Varian
 		it->second->setTarget(doCombineOverloadedCallable(target, callable));
 		return *it->second;
 	}
-	return callableData->addItem(MetaItem::Type::callable, name, callable);
+	return callableData->addItem(MetaItem::Type::callable, name, callable, doRequireItemGeneration());
 }
 
 MetaItem & MetaRepoBase::registerVariable(const std::string & name, const Variant & variable)
@@ -254,7 +418,7 @@ MetaItem & MetaRepoBase::registerVariable(const std::string & name, const Varian
 	if(it != constantData->nameItemMap.end()) {
 		return *it->second;
 	}
-	return constantData->addItem(MetaItem::Type::variable, name, variable);
+	return constantData->addItem(MetaItem::Type::variable, name, variable, doRequireItemGeneration());
 }
 
 MetaItem & MetaRepoBase::registerType(std::string name, const MetaType * metaType)
@@ -271,7 +435,7 @@ MetaItem & MetaRepoBase::registerType(std::string name, const MetaType * metaTyp
 	if(it != typeData->typeTypeMap.end()) {
 		return *it->second;
 	}
-	MetaItem & registeredType = typeData->addItem(MetaItem::Type::metaType, name, metaType);
+	MetaItem & registeredType = typeData->addItem(MetaItem::Type::metaType, name, metaType, doRequireItemGeneration());
 	typeData->kindTypeMap[metaType->getTypeKind()] = &registeredType;
 	typeData->typeTypeMap[metaType] = &registeredType;
 
@@ -350,6 +514,59 @@ const MetaItem & MetaRepoBase::doGetItem(const std::string & name) const
 	return *result;
 }
 
+std::uint64_t MetaRepoBase::doGetItemGeneration() const
+{
+	return itemGeneration ? itemGeneration->get() : 0;
+}
+
+ScopedGeneration * MetaRepoBase::doRequireItemGeneration()
+{
+	if(! itemGeneration) {
+		itemGeneration = std::make_shared<ScopedGeneration>();
+	}
+	return itemGeneration.get();
+}
+
+void MetaRepoBase::doFindCallablesByArity(MetaItemPointerList & result, const int arity) const
+{
+	itemIndex.findCallablesByArity(result, doGetItemListSet(), doGetItemGeneration(), arity);
+}
+
+void MetaRepoBase::doFindCallablesByParameter(
+		MetaItemPointerList & result,
+		const int arity,
+		const int parameterIndex,
+		const MetaType * parameterType
+	) const
+{
+	itemIndex.findCallablesByParameter(result, doGetItemListSet(), doGetItemGeneration(), arity, parameterIndex, parameterType);
+}
+
+void MetaRepoBase::doFindCallablesByReturnType(MetaItemPointerList & result, const MetaType * returnType) const
+{
+	itemIndex.findCallablesByReturnType(result, doGetItemListSet(), doGetItemGeneration(), returnType);
+}
+
+void MetaRepoBase::doFindItemsByAnnotation(MetaItemPointerList & result, const std::string & name) const
+{
+	itemIndex.findItemsByAnnotation(result, doGetItemListSet(), doGetItemGeneration(), name);
+}
+
+void MetaRepoBase::doFindItemsByAnnotationValue(MetaItemPointerList & result, const std::string & name, const Variant & value) const
+{
+	itemIndex.findItemsByAnnotationValue(result, doGetItemListSet(), doGetItemGeneration(), name, value);
+}
+
+MetaItemIndex::ItemListSet MetaRepoBase::doGetItemListSet() const
+{
+	return MetaItemIndex::ItemListSet {
+		&doGetAccessibleList(),
+		&doGetCallableList(),
+		&doGetVariableList(),
+		&doGetTypeList()
+	};
+}
+
 Variant doCombineOverloadedCallable(const Variant & target, const Variant & callable)
 {
 	if(getNonReferenceMetaType(target)->getTypeKind() == tkOverloadedFunction) {
@@ -386,6 +603,28 @@ MetaRepo::MetaRepo()
 	internal_::doGetMetaRepoList()->addMetaRepo(this);
 }
 
+MetaRepo::MetaRepo(const MetaRepo & other)
+	:
+		internal_::MetaRepoBase(other),
+		internal_::InheritanceRepo(other),
+		repoData(other.repoData),
+		previous(nullptr),
+		next(nullptr)
+{
+	internal_::doGetMetaRepoList()->addMetaRepo(this);
+}
+
+MetaRepo::MetaRepo(MetaRepo && other)
+	:
+		internal_::MetaRepoBase(std::move(other)),
+		internal_::InheritanceRepo(std::move(other)),
+		repoData(std::move(other.repoData)),
+		previous(nullptr),
+		next(nullptr)
+{
+	internal_::doGetMetaRepoList()->addMetaRepo(this);
+}
+
 MetaRepo::~MetaRepo()
 {
 	internal_::doGetMetaRepoList()->removeMetaRepo(this);
@@ -449,7 +688,7 @@ MetaItem & MetaRepo::registerRepo(const std::string & name, Variant repo)
 	if(! repoData) {
 		repoData = std::make_shared<ItemData>();
 	}
-	return repoData->addItem(MetaItem::Type::metaRepo, name, repo);
+	return repoData->addItem(MetaItem::Type::metaRepo, name, repo, doRequireItemGeneration());
 }
 
 const MetaItem & MetaRepo::getRepo(const std::string & name) const
@@ -471,6 +710,45 @@ const MetaItem & MetaRepo::getItem(const std::string & name) const
 	return *result;
 }
 
+MetaItemPointerList MetaRepo::findCallablesByArity(const int arity) const
+{
+	MetaItemPointerList result;
+	doFindCallablesByArity(result, arity);
+	return result;
+}
+
+MetaItemPointerList MetaRepo::findCallablesByParameter(
+		const int arity,
+		const int parameterIndex,
+		const MetaType * parameterType
+	) const
+{
+	MetaItemPointerList result;
+	doFindCallablesByParameter(result, arity, parameterIndex, parameterType);
+	return result;
+}
+
+MetaItemPointerList MetaRepo::findCallablesByReturnType(const MetaType * returnType) const
+{
+	MetaItemPointerList result;
+	doFindCallablesByReturnType(result, returnType);
+	return result;
+}
+
+MetaItemPointerList MetaRepo::findItemsByAnnotation(const std::string & name) const
+{
+	MetaItemPointerList result;
+	doFindItemsByAnnotation(result, name);
+	return result;
+}
+
+MetaItemPointerList MetaRepo::findItemsByAnnotationValue(const std::string & name, const Variant & value) const
+{
+	MetaItemPointerList result;
+	doFindItemsByAnnotationValue(result, name, value);
+	return result;
+}
+
 
 const MetaRepoList * getMetaRepoList()
 {
@@ -490,6 +768,7 @@ MetaRepoList::~MetaRepoList()
 
 void MetaRepoList::addMetaRepo(MetaRepo * repo)
 {
+	internal_::increaseInheritanceGeneration();
 	if(head == nullptr) {
 		head = repo;
 		tail = repo;
@@ -503,6 +782,7 @@ void MetaRepoList::addMetaRepo(MetaRepo * repo)
 
 void MetaRepoList::removeMetaRepo(MetaRepo * repo)
 {
+	internal_::increaseInheritanceGeneration();
 	if(repo->next != nullptr) {
 		repo->next->previous = repo->previous;
 	}
@@ -529,5 +809,22 @@ const MetaRepo * MetaRepoList::findMetaRepoForHierarchy(const MetaType * classMe
 	return nullptr;
 }
 
+const MetaType * getDynamicMetaType(const Variant & var)
+{
+	std::pair<void *, const MetaType *> pointerAndType = getPointerAndType(var);
+	const internal_::PolymorphicTypeEntry * entry = internal_::findDynamicTypeEntry(&pointerAndType.first, pointerAndType.second);
+	return entry == nullptr ? pointerAndType.second : entry->metaType;
+}
+
+Variant getDynamicReference(const Variant & var)
+{
+	std::pair<void *, const MetaType *> pointerAndType = getPointerAndType(var);
+	const internal_::PolymorphicTypeEntry * entry = internal_::findDynamicTypeEntry(&pointerAndType.first, pointerAndType.second);
+	if(entry == nullptr) {
+		return Variant();
+	}
+	return Variant(entry->referenceMetaType, pointerAndType.first);
+}
+
 
 } // namespace metapp
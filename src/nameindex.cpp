@@ -0,0 +1,398 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "metapp/utilities/nameindex.h"
+#include "metapp/metarepo.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaenum.h"
+#include "metapp/allmetatypes.h"
+
+#include <vector>
+#include <set>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+constexpr std::uint32_t invalidIndex = 0xffffffffu;
+
+// Trie node. The children of a node are a singly linked list sorted by label,
+// it's compact, and completion lists come out in lexicographical order.
+struct TrieNode
+{
+	char label;
+	std::uint32_t firstChild;
+	std::uint32_t nextSibling;
+	std::uint32_t firstItem;
+	std::uint32_t lastItem;
+};
+
+struct TrieItem
+{
+	const MetaItem * item;
+	std::uint32_t next;
+};
+
+struct FuzzyMatch
+{
+	const MetaItem * item;
+	std::size_t distance;
+};
+
+} // namespace
+
+class NameIndexImplement
+{
+public:
+	enum class SourceKind
+	{
+		metaRepo,
+		metaClass,
+		metaEnum
+	};
+
+private:
+	static constexpr std::size_t maxSourceListCount = 5;
+
+	// The item lists of a source only grow, so indexedCountList records how many items are indexed in each list.
+	// generation is the item generation of the source when it was indexed, the source is skipped if it's not changed.
+	struct Source
+	{
+		SourceKind kind;
+		const void * pointer;
+		std::array<std::size_t, maxSourceListCount> indexedCountList;
+		std::uint64_t generation;
+	};
+
+public:
+	NameIndexImplement()
+		:
+			nodeList(),
+			itemList(),
+			sourceList(),
+			sourceSet()
+	{
+		nodeList.push_back(TrieNode { 0, invalidIndex, invalidIndex, invalidIndex, invalidIndex });
+	}
+
+	void addSource(const SourceKind kind, const void * pointer) {
+		if(pointer != nullptr && sourceSet.insert(pointer).second) {
+			sourceList.push_back(Source { kind, pointer, {}, 0 });
+		}
+	}
+
+	void addMetaType(const MetaType * metaType) {
+		addSource(SourceKind::metaClass, metaType->getMetaClass());
+		addSource(SourceKind::metaEnum, metaType->getMetaEnum());
+	}
+
+	void update() {
+		// Indexing a repo may add more sources, so the loop can't use iterators.
+		for(std::size_t i = 0; i < sourceList.size(); ++i) {
+			// Get the generation before indexing, so the items registered during indexing are indexed on next update.
+			const std::uint64_t sourceGeneration = getSourceGeneration(sourceList[i]);
+			if(sourceList[i].generation == sourceGeneration) {
+				continue;
+			}
+			switch(sourceList[i].kind) {
+			case SourceKind::metaRepo: {
+				const MetaRepo * metaRepo = static_cast<const MetaRepo *>(sourceList[i].pointer);
+				updateSourceList(i, 0, metaRepo->getAccessibleView());
+				updateSourceList(i, 1, metaRepo->getCallableView());
+				updateSourceList(i, 2, metaRepo->getVariableView());
+				updateSourceList(i, 3, metaRepo->getTypeView());
+				updateSourceList(i, 4, metaRepo->getRepoView());
+				break;
+			}
+
+			case SourceKind::metaClass: {
+				const MetaClass * metaClass = static_cast<const MetaClass *>(sourceList[i].pointer);
+				updateSourceList(i, 0, metaClass->getAccessibleView(MetaClass::flagNone));
+				updateSourceList(i, 1, metaClass->getCallableView(MetaClass::flagNone));
+				updateSourceList(i, 2, metaClass->getVariableView(MetaClass::flagNone));
+				updateSourceList(i, 3, metaClass->getTypeView(MetaClass::flagNone));
+				break;
+			}
+
+			case SourceKind::metaEnum:
+				updateSourceList(i, 0, static_cast<const MetaEnum *>(sourceList[i].pointer)->getValueView());
+				break;
+			}
+			sourceList[i].generation = sourceGeneration;
+		}
+	}
+
+	void addItem(const MetaItem * item) {
+		const std::string & name = item->getName();
+		if(name.empty()) {
+			return;
+		}
+		std::uint32_t nodeIndex = 0;
+		for(const char c : name) {
+			nodeIndex = findOrAddChild(nodeIndex, c);
+		}
+		const std::uint32_t itemIndex = (std::uint32_t)itemList.size();
+		itemList.push_back(TrieItem { item, invalidIndex });
+		TrieNode & node = nodeList[nodeIndex];
+		if(node.lastItem == invalidIndex) {
+			node.firstItem = itemIndex;
+		}
+		else {
+			itemList[node.lastItem].next = itemIndex;
+		}
+		node.lastItem = itemIndex;
+	}
+
+	std::size_t getItemCount() const {
+		return itemList.size();
+	}
+
+	MetaItemPointerList findByPrefix(const std::string & prefix, const std::size_t limit) const {
+		MetaItemPointerList result;
+		std::uint32_t nodeIndex = 0;
+		for(const char c : prefix) {
+			nodeIndex = findChild(nodeIndex, c);
+			if(nodeIndex == invalidIndex) {
+				return result;
+			}
+		}
+		collectItems(nodeIndex, result, limit);
+		return result;
+	}
+
+	MetaItemPointerList findFuzzy(const std::string & name, const std::size_t maxDistance, const std::size_t limit) const {
+		std::vector<FuzzyMatch> matchList;
+		// rowList holds one row of the Levenshtein matrix per trie depth, the row at depth 0 is 0, 1, ... n.
+		const std::size_t columnCount = name.size() + 1;
+		std::vector<std::size_t> rowList(columnCount);
+		for(std::size_t i = 0; i < columnCount; ++i) {
+			rowList[i] = i;
+		}
+		if(name.size() <= maxDistance) {
+			addFuzzyMatches(0, name.size(), matchList);
+		}
+		for(std::uint32_t child = nodeList[0].firstChild; child != invalidIndex; child = nodeList[child].nextSibling) {
+			doFindFuzzy(child, 1, name, maxDistance, rowList, matchList);
+		}
+
+		std::stable_sort(matchList.begin(), matchList.end(), [](const FuzzyMatch & a, const FuzzyMatch & b) {
+			return a.distance < b.distance;
+		});
+		MetaItemPointerList result;
+		for(const FuzzyMatch & match : matchList) {
+			if(limit > 0 && result.size() >= limit) {
+				break;
+			}
+			result.push_back(match.item);
+		}
+		return result;
+	}
+
+private:
+	static std::uint64_t getSourceGeneration(const Source & source) {
+		switch(source.kind) {
+		case SourceKind::metaRepo: {
+			return static_cast<const MetaRepo *>(source.pointer)->doGetItemGeneration();
+		}
+
+		case SourceKind::metaClass:
+			return static_cast<const MetaClass *>(source.pointer)->doGetItemGeneration();
+
+		case SourceKind::metaEnum:
+			return static_cast<const MetaEnum *>(source.pointer)->generation->get();
+		}
+		return 0;
+	}
+
+	template <typename View>
+	void updateSourceList(const std::size_t sourceIndex, const std::size_t listIndex, const View & view) {
+		const std::size_t size = view.size();
+		for(std::size_t i = sourceList[sourceIndex].indexedCountList[listIndex]; i < size; ++i) {
+			const MetaItem & item = view[i];
+			addItem(&item);
+			if(item.getType() == MetaItem::Type::metaType) {
+				addMetaType(item.asMetaType());
+			}
+			else if(item.getType() == MetaItem::Type::metaRepo) {
+				addSource(SourceKind::metaRepo, item.asMetaRepo());
+			}
+		}
+		// Don't use the reference to sourceList[sourceIndex] before the loop, addSource may reallocate sourceList.
+		sourceList[sourceIndex].indexedCountList[listIndex] = size;
+	}
+
+	std::uint32_t findChild(const std::uint32_t nodeIndex, const char c) const {
+		for(std::uint32_t child = nodeList[nodeIndex].firstChild; child != invalidIndex; child = nodeList[child].nextSibling) {
+			if(nodeList[child].label == c) {
+				return child;
+			}
+			if((unsigned char)nodeList[child].label > (unsigned char)c) {
+				break;
+			}
+		}
+		return invalidIndex;
+	}
+
+	std::uint32_t findOrAddChild(const std::uint32_t nodeIndex, const char c) {
+		std::uint32_t previous = invalidIndex;
+		std::uint32_t child = nodeList[nodeIndex].firstChild;
+		while(child != invalidIndex && (unsigned char)nodeList[child].label < (unsigned char)c) {
+			previous = child;
+			child = nodeList[child].nextSibling;
+		}
+		if(child != invalidIndex && nodeList[child].label == c) {
+			return child;
+		}
+		const std::uint32_t newIndex = (std::uint32_t)nodeList.size();
+		nodeList.push_back(TrieNode { c, invalidIndex, child, invalidIndex, invalidIndex });
+		if(previous == invalidIndex) {
+			nodeList[nodeIndex].firstChild = newIndex;
+		}
+		else {
+			nodeList[previous].nextSibling = newIndex;
+		}
+		return newIndex;
+	}
+
+	// Returns false if the limit is reached.
+	bool collectItems(const std::uint32_t nodeIndex, MetaItemPointerList & result, const std::size_t limit) const {
+		for(std::uint32_t i = nodeList[nodeIndex].firstItem; i != invalidIndex; i = itemList[i].next) {
+			if(limit > 0 && result.size() >= limit) {
+				return false;
+			}
+			result.push_back(itemList[i].item);
+		}
+		for(std::uint32_t child = nodeList[nodeIndex].firstChild; child != invalidIndex; child = nodeList[child].nextSibling) {
+			if(! collectItems(child, result, limit)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void addFuzzyMatches(const std::uint32_t nodeIndex, const std::size_t distance, std::vector<FuzzyMatch> & matchList) const {
+		for(std::uint32_t i = nodeList[nodeIndex].firstItem; i != invalidIndex; i = itemList[i].next) {
+			matchList.push_back(FuzzyMatch { itemList[i].item, distance });
+		}
+	}
+
+	void doFindFuzzy(
+		const std::uint32_t nodeIndex,
+		const std::size_t depth,
+		const std::string & name,
+		const std::size_t maxDistance,
+		std::vector<std::size_t> & rowList,
+		std::vector<FuzzyMatch> & matchList
+	) const {
+		const std::size_t columnCount = name.size() + 1;
+		rowList.resize((depth + 1) * columnCount);
+		const std::size_t * previousRow = &rowList[(depth - 1) * columnCount];
+		std::size_t * row = &rowList[depth * columnCount];
+		const char c = nodeList[nodeIndex].label;
+		row[0] = previousRow[0] + 1;
+		std::size_t rowMinimum = row[0];
+		for(std::size_t i = 1; i < columnCount; ++i) {
+			row[i] = std::min(
+				std::min(previousRow[i] + 1, row[i - 1] + 1),
+				previousRow[i - 1] + (name[i - 1] == c ? 0 : 1)
+			);
+			rowMinimum = std::min(rowMinimum, row[i]);
+		}
+		if(row[columnCount - 1] <= maxDistance) {
+			addFuzzyMatches(nodeIndex, row[columnCount - 1], matchList);
+		}
+		// No name in the subtree can be closer than the minimum of the row.
+		if(rowMinimum > maxDistance) {
+			return;
+		}
+		for(std::uint32_t child = nodeList[nodeIndex].firstChild; child != invalidIndex; child = nodeList[child].nextSibling) {
+			doFindFuzzy(child, depth + 1, name, maxDistance, rowList, matchList);
+		}
+	}
+
+public:
+	std::vector<TrieNode> nodeList;
+	std::vector<TrieItem> itemList;
+	std::vector<Source> sourceList;
+	std::set<const void *> sourceSet;
+};
+
+} // namespace internal_
+
+NameIndex::NameIndex()
+	: implement(new internal_::NameIndexImplement())
+{
+}
+
+NameIndex::~NameIndex()
+{
+}
+
+void NameIndex::addMetaRepo(const MetaRepo * metaRepo)
+{
+	implement->addSource(internal_::NameIndexImplement::SourceKind::metaRepo, metaRepo);
+}
+
+void NameIndex::addMetaClass(const MetaClass * metaClass)
+{
+	implement->addSource(internal_::NameIndexImplement::SourceKind::metaClass, metaClass);
+}
+
+void NameIndex::addMetaEnum(const MetaEnum * metaEnum)
+{
+	implement->addSource(internal_::NameIndexImplement::SourceKind::metaEnum, metaEnum);
+}
+
+void NameIndex::addMetaType(const MetaType * metaType)
+{
+	implement->addMetaType(metaType);
+}
+
+void NameIndex::addItem(const MetaItem & item)
+{
+	implement->addItem(&item);
+}
+
+void NameIndex::update()
+{
+	implement->update();
+}
+
+std::size_t NameIndex::getItemCount() const
+{
+	return implement->getItemCount();
+}
+
+MetaItemPointerList NameIndex::findByPrefix(const std::string & prefix, const std::size_t limit)
+{
+	implement->update();
+	return implement->findByPrefix(prefix, limit);
+}
+
+MetaItemPointerList NameIndex::findFuzzy(const std::string & name, const std::size_t maxDistance, const std::size_t limit)
+{
+	implement->update();
+	return implement->findFuzzy(name, maxDistance, limit);
+}
+
+
+} // namespace metapp
+
@@ -0,0 +1,471 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/utilities/objectvisitor.h"
+#include "metapp/utilities/threadpool.h"
+#include "metapp/utilities/utility.h"
+#include "metapp/exception.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/interfaces/metaindexable.h"
+#include "metapp/interfaces/metaiterable.h"
+#include "metapp/allmetatypes.h"
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+using Node = ObjectVisitor::Node;
+using NodeStack = std::vector<Node>;
+
+// How to find the children of a type, it's computed once per meta type.
+struct ChildPlan
+{
+	enum class Kind
+	{
+		leaf,
+		pointer,
+		members,
+		indexable,
+		iterable
+	};
+
+	ChildPlan() : kind(Kind::leaf), metaIndexable(nullptr), metaIterable(nullptr), accessibleList() {
+	}
+
+	Kind kind;
+	const MetaIndexable * metaIndexable;
+	const MetaIterable * metaIterable;
+	std::vector<const MetaItem *> accessibleList;
+};
+
+// An object is identified by its address and meta type, a member at the same address as its owner is a different object.
+struct ObjectKey
+{
+	const void * address;
+	const MetaType * metaType;
+
+	bool operator == (const ObjectKey & other) const {
+		return address == other.address && metaType == other.metaType;
+	}
+};
+
+struct ObjectKeyHash
+{
+	std::size_t operator() (const ObjectKey & key) const {
+		return std::hash<const void *>()(key.address) ^ (std::hash<const void *>()(key.metaType) << 1);
+	}
+};
+
+// The visited set is split into shards, so threads rarely contend on the same lock in parallel mode.
+class VisitedSet
+{
+private:
+	static constexpr std::size_t shardCount = 32;
+
+	struct Shard
+	{
+		std::mutex mutex;
+		std::unordered_set<ObjectKey, ObjectKeyHash> keySet;
+	};
+
+public:
+	explicit VisitedSet(const bool concurrent) : concurrent(concurrent), shardList() {
+	}
+
+	// Returns true if the key is not visited before
+	bool insert(const ObjectKey & key) {
+		Shard & shard = shardList[(ObjectKeyHash()(key) >> 4) % shardCount];
+		if(concurrent) {
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			return shard.keySet.insert(key).second;
+		}
+		return shard.keySet.insert(key).second;
+	}
+
+private:
+	bool concurrent;
+	Shard shardList[shardCount];
+};
+
+} // namespace
+
+class ObjectVisitorImplement
+{
+private:
+	// The plans already used by a task. A task takes planMutex only the first time it meets a type,
+	// so the workers don't contend on planMutex for each node.
+	using LocalPlanMap = std::unordered_map<const MetaType *, const ChildPlan *>;
+
+	// A task in parallel mode owns a part of the work stack.
+	struct ParallelVisitTask;
+
+	struct ParallelVisitJob
+	{
+		ParallelVisitJob(ObjectVisitorImplement * visitor, const ObjectVisitor::Callback & callback, Executor * executor)
+			:
+				visitor(visitor),
+				callback(callback),
+				executor(executor),
+				visitedSet(true),
+				splitLimit(executor->getConcurrency() * 4),
+				failed(false),
+				pendingTaskCount(0),
+				mutex(),
+				condition(),
+				exception()
+		{
+		}
+
+		ObjectVisitorImplement * visitor;
+		const ObjectVisitor::Callback & callback;
+		Executor * executor;
+		VisitedSet visitedSet;
+		std::size_t splitLimit;
+		std::atomic<bool> failed;
+		std::size_t pendingTaskCount;
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::exception_ptr exception;
+	};
+
+	struct ParallelVisitTask : ExecutorTask
+	{
+		explicit ParallelVisitTask(ParallelVisitJob * job) : ExecutorTask(&doRun), job(job), stack(), localPlanMap() {
+		}
+
+		static void doRun(ExecutorTask * task) {
+			ParallelVisitTask * visitTask = static_cast<ParallelVisitTask *>(task);
+			ParallelVisitJob * job = visitTask->job;
+#ifdef METAPP_EXCEPTION_ENABLED
+			try {
+#endif
+				job->visitor->doVisitParallel(*job, visitTask->stack, visitTask->localPlanMap);
+#ifdef METAPP_EXCEPTION_ENABLED
+			}
+			catch(...) {
+				std::lock_guard<std::mutex> lock(job->mutex);
+				if(! job->exception) {
+					job->exception = std::current_exception();
+				}
+				job->failed.store(true);
+			}
+#endif
+			delete visitTask;
+			// Notify while holding the lock, the job is destroyed as soon as the caller sees no pending tasks.
+			std::lock_guard<std::mutex> lock(job->mutex);
+			--job->pendingTaskCount;
+			job->condition.notify_all();
+		}
+
+		ParallelVisitJob * job;
+		NodeStack stack;
+		LocalPlanMap localPlanMap;
+	};
+
+	// A task splits half of its stack to a new task when the stack has at least this number of nodes.
+	static constexpr std::size_t splitStackSize = 16;
+
+public:
+	ObjectVisitorImplement()
+		: maxDepth(std::numeric_limits<std::size_t>::max()), executor(nullptr), planMutex(), planMap()
+	{
+	}
+
+	void setMaxDepth(const std::size_t maxDepth_) {
+		maxDepth = maxDepth_;
+	}
+
+	void setExecutor(Executor * executor_) {
+		executor = executor_;
+	}
+
+	void visit(const Variant & root, const ObjectVisitor::Callback & callback) {
+		NodeStack stack;
+		LocalPlanMap localPlanMap;
+		if(executor == nullptr || executor->getConcurrency() <= 1) {
+			VisitedSet visitedSet(false);
+			pushChild(stack, visitedSet, localPlanMap, root, nullptr, 0, false);
+			while(! stack.empty()) {
+				Node node = std::move(stack.back());
+				stack.pop_back();
+				if(callback(node)) {
+					expandChildren(node, stack, visitedSet, localPlanMap);
+				}
+			}
+			return;
+		}
+
+		ParallelVisitJob job(this, callback, executor);
+		pushChild(stack, job.visitedSet, localPlanMap, root, nullptr, 0, false);
+#ifdef METAPP_EXCEPTION_ENABLED
+		try {
+#endif
+			doVisitParallel(job, stack, localPlanMap);
+#ifdef METAPP_EXCEPTION_ENABLED
+		}
+		catch(...) {
+			// Don't leave before the tasks finish, they refer to the job.
+			std::lock_guard<std::mutex> lock(job.mutex);
+			if(! job.exception) {
+				job.exception = std::current_exception();
+			}
+			job.failed.store(true);
+		}
+#endif
+		for(;;) {
+			{
+				std::lock_guard<std::mutex> lock(job.mutex);
+				if(job.pendingTaskCount == 0) {
+					break;
+				}
+			}
+			if(runPendingTaskInCurrentWorker()) {
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(job.mutex);
+			job.condition.wait(lock, [&job]() {
+				return job.pendingTaskCount == 0;
+			});
+			break;
+		}
+		if(job.exception) {
+			std::rethrow_exception(job.exception);
+		}
+	}
+
+private:
+	// An object which may have children is recorded in the visited set, so it's visited only once
+	// no matter it's reached by value (a member or an element) or by pointers.
+	// Pointees are always recorded. Values which are not references (such as the result of an accessor)
+	// are temporary, their addresses are not identities, so they are not recorded.
+	void pushChild(
+		NodeStack & stack,
+		VisitedSet & visitedSet,
+		LocalPlanMap & localPlanMap,
+		Variant child,
+		const MetaItem * accessible,
+		const std::size_t depth,
+		const bool fromPointer
+	) {
+		const MetaType * metaType = child.getMetaType();
+		if(metaType->isReference()) {
+			metaType = metaType->getUpType();
+			const ChildPlan::Kind kind = getPlan(metaType, localPlanMap).kind;
+			if(fromPointer || (kind != ChildPlan::Kind::leaf && kind != ChildPlan::Kind::pointer)) {
+				if(! visitedSet.insert(ObjectKey { child.getAddress(), metaType })) {
+					return;
+				}
+			}
+		}
+		stack.push_back(Node { std::move(child), accessible, depth });
+	}
+
+	void doVisitParallel(ParallelVisitJob & job, NodeStack & stack, LocalPlanMap & localPlanMap) {
+		while(! stack.empty() && ! job.failed.load(std::memory_order_relaxed)) {
+			Node node = std::move(stack.back());
+			stack.pop_back();
+			if(job.callback(node)) {
+				expandChildren(node, stack, job.visitedSet, localPlanMap);
+			}
+			if(stack.size() >= splitStackSize) {
+				trySplit(job, stack);
+			}
+		}
+	}
+
+	void trySplit(ParallelVisitJob & job, NodeStack & stack) {
+		{
+			std::lock_guard<std::mutex> lock(job.mutex);
+			if(job.pendingTaskCount >= job.splitLimit) {
+				return;
+			}
+			++job.pendingTaskCount;
+		}
+		// The bottom of the stack holds the nodes closest to the root, they likely have the largest subgraphs.
+		ParallelVisitTask * task = new ParallelVisitTask(&job);
+		const std::size_t half = stack.size() / 2;
+		task->stack.assign(
+			std::make_move_iterator(stack.begin()),
+			std::make_move_iterator(stack.begin() + half)
+		);
+		stack.erase(stack.begin(), stack.begin() + half);
+		job.executor->execute(task);
+	}
+
+	const ChildPlan & getPlan(const MetaType * metaType, LocalPlanMap & localPlanMap) {
+		auto it = localPlanMap.find(metaType);
+		if(it != localPlanMap.end()) {
+			return *it->second;
+		}
+		const ChildPlan * plan = getSharedPlan(metaType);
+		localPlanMap.insert(std::make_pair(metaType, plan));
+		return *plan;
+	}
+
+	// The plans are never removed from planMap, so the pointers stay valid during the visitor's life.
+	const ChildPlan * getSharedPlan(const MetaType * metaType) {
+		std::lock_guard<std::mutex> lock(planMutex);
+		std::unique_ptr<ChildPlan> & plan = planMap[metaType];
+		if(! plan) {
+			plan.reset(new ChildPlan());
+			buildPlan(metaType, *plan);
+		}
+		return plan.get();
+	}
+
+	static void buildPlan(const MetaType * metaType, ChildPlan & plan) {
+		if(metaType->isPointer() || (metaType->hasMetaPointerWrapper() && metaType->hasMetaAccessible())) {
+			plan.kind = ChildPlan::Kind::pointer;
+			return;
+		}
+		const MetaClass * metaClass = metaType->getMetaClass();
+		if(metaClass != nullptr) {
+			for(const MetaItem & item : metaClass->getAccessibleView()) {
+				plan.accessibleList.push_back(&item);
+			}
+			if(! plan.accessibleList.empty()) {
+				plan.kind = ChildPlan::Kind::members;
+				return;
+			}
+		}
+		plan.metaIterable = metaType->getMetaIterable();
+		plan.metaIndexable = metaType->getMetaIndexable();
+		if(plan.metaIndexable != nullptr) {
+			plan.kind = ChildPlan::Kind::indexable;
+			return;
+		}
+		if(plan.metaIterable != nullptr) {
+			plan.kind = ChildPlan::Kind::iterable;
+			return;
+		}
+	}
+
+	void expandChildren(const Node & node, NodeStack & stack, VisitedSet & visitedSet, LocalPlanMap & localPlanMap) {
+		if(node.depth >= maxDepth) {
+			return;
+		}
+		const std::size_t depth = node.depth + 1;
+		const ChildPlan & plan = getPlan(getNonReferenceMetaType(node.object), localPlanMap);
+		switch(plan.kind) {
+		case ChildPlan::Kind::leaf:
+			break;
+
+		case ChildPlan::Kind::pointer: {
+			const auto pointerAndType = getPointerAndType(node.object);
+			if(pointerAndType.first == nullptr || pointerAndType.second->isVoid()) {
+				break;
+			}
+			pushChild(stack, visitedSet, localPlanMap, depointer(node.object), nullptr, depth, true);
+			break;
+		}
+
+		case ChildPlan::Kind::members:
+			// Pushed in reverse order, so the members are visited in the registered order.
+			for(auto it = plan.accessibleList.rbegin(); it != plan.accessibleList.rend(); ++it) {
+				pushChild(stack, visitedSet, localPlanMap, accessibleGet((*it)->asAccessible(), node.object), *it, depth, false);
+			}
+			break;
+
+		case ChildPlan::Kind::indexable: {
+			const MetaIndexable::SizeInfo sizeInfo = plan.metaIndexable->getSizeInfo(node.object);
+			if(sizeInfo.isRandomAccess() && ! sizeInfo.isUnknownSize()) {
+				for(std::size_t i = sizeInfo.getSize(); i > 0; --i) {
+					pushChild(stack, visitedSet, localPlanMap, plan.metaIndexable->get(node.object, i - 1), nullptr, depth, false);
+				}
+			}
+			else if(plan.metaIterable != nullptr) {
+				pushIterableChildren(plan.metaIterable, node, stack, visitedSet, localPlanMap, depth);
+			}
+			break;
+		}
+
+		case ChildPlan::Kind::iterable:
+			pushIterableChildren(plan.metaIterable, node, stack, visitedSet, localPlanMap, depth);
+			break;
+		}
+	}
+
+	void pushIterableChildren(
+		const MetaIterable * metaIterable,
+		const Node & node,
+		NodeStack & stack,
+		VisitedSet & visitedSet,
+		LocalPlanMap & localPlanMap,
+		const std::size_t depth
+	) {
+		const std::size_t firstIndex = stack.size();
+		metaIterable->forEach(node.object, [this, &stack, &visitedSet, &localPlanMap, depth](const Variant & element) -> bool {
+			pushChild(stack, visitedSet, localPlanMap, element, nullptr, depth, false);
+			return true;
+		});
+		std::reverse(stack.begin() + firstIndex, stack.end());
+	}
+
+private:
+	std::size_t maxDepth;
+	Executor * executor;
+	std::mutex planMutex;
+	std::unordered_map<const MetaType *, std::unique_ptr<ChildPlan> > planMap;
+};
+
+constexpr std::size_t ObjectVisitorImplement::splitStackSize;
+
+} // namespace internal_
+
+ObjectVisitor::ObjectVisitor()
+	: implement(new internal_::ObjectVisitorImplement())
+{
+}
+
+ObjectVisitor::~ObjectVisitor()
+{
+}
+
+ObjectVisitor & ObjectVisitor::setMaxDepth(const std::size_t maxDepth)
+{
+	implement->setMaxDepth(maxDepth);
+	return *this;
+}
+
+ObjectVisitor & ObjectVisitor::setExecutor(Executor * executor)
+{
+	implement->setExecutor(executor);
+	return *this;
+}
+
+void ObjectVisitor::visit(const Variant & root, const Callback & callback)
+{
+	implement->visit(root, callback);
+}
+
+
+} // namespace metapp
+
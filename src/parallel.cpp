@@ -0,0 +1,171 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/utilities/parallel.h"
+#include "metapp/exception.h"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+// The chunks are claimed from an atomic counter by the helper tasks and the calling thread,
+// so a slow chunk doesn't stall the others, and idle workers steal the helper tasks.
+struct ParallelJob
+{
+	ParallelJob(ParallelRangeFunc func, void * context, const std::size_t count, const std::size_t grain)
+		:
+			func(func),
+			context(context),
+			count(count),
+			grain(grain),
+			chunkCount((count + grain - 1) / grain),
+			nextChunk(0),
+			failed(false),
+			remainingHelperCount(0),
+			mutex(),
+			condition(),
+			exception()
+	{
+	}
+
+	void work() {
+		for(;;) {
+			const std::size_t chunk = nextChunk.fetch_add(1);
+			if(chunk >= chunkCount || failed.load(std::memory_order_relaxed)) {
+				break;
+			}
+			const std::size_t begin = chunk * grain;
+			const std::size_t end = std::min(begin + grain, count);
+#ifdef METAPP_EXCEPTION_ENABLED
+			try {
+#endif
+				func(context, begin, end);
+#ifdef METAPP_EXCEPTION_ENABLED
+			}
+			catch(...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if(! exception) {
+					exception = std::current_exception();
+				}
+				failed.store(true);
+			}
+#endif
+		}
+	}
+
+	ParallelRangeFunc func;
+	void * context;
+	std::size_t count;
+	std::size_t grain;
+	std::size_t chunkCount;
+	std::atomic<std::size_t> nextChunk;
+	std::atomic<bool> failed;
+	std::size_t remainingHelperCount;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::exception_ptr exception;
+};
+
+struct ParallelHelperTask : ExecutorTask
+{
+	ParallelHelperTask() : ExecutorTask(&doRun), job(nullptr) {
+	}
+
+	static void doRun(ExecutorTask * task) {
+		ParallelJob * job = static_cast<ParallelHelperTask *>(task)->job;
+		job->work();
+		// Notify while holding the lock, the job is destroyed as soon as the caller sees no remaining helpers.
+		std::lock_guard<std::mutex> lock(job->mutex);
+		--job->remainingHelperCount;
+		job->condition.notify_all();
+	}
+
+	ParallelJob * job;
+};
+
+} // namespace
+
+void parallelRun(
+	Executor & executor,
+	const std::size_t count,
+	std::size_t grain,
+	ParallelRangeFunc func,
+	void * context
+)
+{
+	if(count == 0) {
+		return;
+	}
+	const std::size_t concurrency = std::max<std::size_t>(executor.getConcurrency(), 1);
+	if(grain == 0) {
+		// Several chunks per thread, so the work is still balanced when the elements have uneven cost.
+		grain = std::max<std::size_t>(count / (concurrency * 8), 1);
+	}
+	ParallelJob job(func, context, count, grain);
+	const std::size_t helperCount = std::min(concurrency, job.chunkCount - 1);
+	if(helperCount == 0) {
+		func(context, 0, count);
+		return;
+	}
+
+	std::vector<ParallelHelperTask> helperList(helperCount);
+	std::vector<ExecutorTask *> taskList(helperCount);
+	for(std::size_t i = 0; i < helperCount; ++i) {
+		helperList[i].job = &job;
+		taskList[i] = &helperList[i];
+	}
+	job.remainingHelperCount = helperCount;
+	executor.executeBatch(taskList.data(), helperCount);
+
+	job.work();
+
+	for(;;) {
+		{
+			std::lock_guard<std::mutex> lock(job.mutex);
+			if(job.remainingHelperCount == 0) {
+				break;
+			}
+		}
+		// If we are in a worker, a helper may be queued on this worker, run it rather than block.
+		if(runPendingTaskInCurrentWorker()) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(job.mutex);
+		job.condition.wait(lock, [&job]() {
+			return job.remainingHelperCount == 0;
+		});
+		break;
+	}
+
+	if(job.exception) {
+		std::rethrow_exception(job.exception);
+	}
+}
+
+} // namespace internal_
+
+
+} // namespace metapp
+
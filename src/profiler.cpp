@@ -0,0 +1,801 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/utilities/profiler.h"
+#include "metapp/metarepo.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/allmetatypes.h"
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+
+namespace metapp {
+
+namespace internal_ {
+
+std::atomic<bool> profilingEnabled(false);
+
+namespace {
+
+// Log-linear buckets. Values below subBucketCount have their own buckets, a larger value with the highest bit
+// at exponent E is in one of the subBucketCount buckets which split [2^E, 2^(E+1)).
+constexpr int subBucketBits = 4;
+constexpr std::uint64_t subBucketCount = 1u << subBucketBits;
+// Values larger than 2^(maxExponent + 1) ticks are in the last bucket.
+constexpr int maxExponent = 47;
+constexpr std::size_t bucketCount = (maxExponent - subBucketBits + 2) * subBucketCount;
+
+constexpr std::size_t itemTableSize = 4096;
+
+const char * const phaseNameList[profilePhaseCount] = {
+	"invoke",
+	"rank",
+	"cast",
+	"call",
+	"box",
+	"get",
+	"set"
+};
+
+struct PhaseHistogram
+{
+	std::array<std::atomic<std::uint64_t>, bucketCount> bucketList;
+	std::atomic<std::uint64_t> totalTicks;
+	std::atomic<std::uint64_t> maxTicks;
+};
+
+struct ItemStatistics
+{
+	ProfileKey key;
+	// Allocated on the first sample of the phase, an accessible only uses two phases.
+	std::array<std::atomic<PhaseHistogram *>, profilePhaseCount> histogramList;
+};
+
+struct TraceEvent
+{
+	ProfileKey key;
+	std::uint64_t startTicks;
+	std::uint64_t endTicks;
+	std::uint32_t threadId;
+	ProfilePhase phase;
+	std::atomic<bool> ready;
+};
+
+struct TraceBuffer
+{
+	explicit TraceBuffer(const std::size_t capacity)
+		:
+			eventList(new TraceEvent[capacity]),
+			capacity(capacity),
+			reservedCount(0),
+			startTicks(readProfileTicks())
+	{
+		for(std::size_t i = 0; i < capacity; ++i) {
+			eventList[i].ready.store(false, std::memory_order_relaxed);
+		}
+	}
+
+	std::unique_ptr<TraceEvent[]> eventList;
+	std::size_t capacity;
+	std::atomic<std::size_t> reservedCount;
+	std::uint64_t startTicks;
+};
+
+struct ProfilerState
+{
+	std::mutex mutex;
+	bool histogramEnabled = false;
+	std::map<ProfileKey, std::string> nameMap;
+	// The buffer of the current trace and the previous trace. The previous one is kept because a thread may still
+	// be writing to it after a new trace starts.
+	std::unique_ptr<TraceBuffer> traceBuffer;
+	std::unique_ptr<TraceBuffer> previousTraceBuffer;
+	bool calibrated = false;
+	std::uint64_t calibrationTicks = 0;
+	std::chrono::steady_clock::time_point calibrationTime;
+};
+
+// The item table and the flags are zero initialized static data, they are valid before any dynamic initialization.
+// The items are never freed, the hooks may access them at any time.
+std::atomic<ItemStatistics *> itemTable[itemTableSize];
+std::atomic<bool> histogramEnabled(false);
+std::atomic<TraceBuffer *> currentTraceBuffer(nullptr);
+std::atomic<std::uint64_t> droppedSampleCount(0);
+
+ProfilerState & getProfilerState()
+{
+	static ProfilerState state;
+	return state;
+}
+
+int getHighestBit(std::uint64_t value)
+{
+#if defined(METAPP_COMPILER_GCC) || defined(METAPP_COMPILER_CLANG)
+	return 63 - __builtin_clzll(value);
+#else
+	int bit = 0;
+	for(int shift = 32; shift > 0; shift >>= 1) {
+		if((value >> shift) != 0) {
+			value >>= shift;
+			bit += shift;
+		}
+	}
+	return bit;
+#endif
+}
+
+std::size_t getBucketIndex(const std::uint64_t ticks)
+{
+	if(ticks < subBucketCount) {
+		return (std::size_t)ticks;
+	}
+	const int exponent = getHighestBit(ticks);
+	if(exponent > maxExponent) {
+		return bucketCount - 1;
+	}
+	return (std::size_t)(exponent - subBucketBits + 1) * subBucketCount
+		+ (std::size_t)((ticks >> (exponent - subBucketBits)) & (subBucketCount - 1));
+}
+
+std::uint64_t getBucketLowerBound(const std::size_t index)
+{
+	if(index < subBucketCount) {
+		return index;
+	}
+	const int exponent = (int)(index / subBucketCount) + subBucketBits - 1;
+	return (subBucketCount + index % subBucketCount) << (exponent - subBucketBits);
+}
+
+std::uint64_t getBucketWidth(const std::size_t index)
+{
+	if(index < subBucketCount) {
+		return 1;
+	}
+	const int exponent = (int)(index / subBucketCount) + subBucketBits - 1;
+	return (std::uint64_t)1 << (exponent - subBucketBits);
+}
+
+static_assert(VariantData::bufferSize <= sizeof(ProfileKey::target), "ProfileKey, target is too small");
+
+ProfileKey makeProfileKey(const Variant & item)
+{
+	ProfileKey key {};
+	key.metaType = getNonReferenceMetaType(item);
+	const void * address = item.getAddress();
+	const std::uintptr_t itemBegin = reinterpret_cast<std::uintptr_t>(&item);
+	const std::uintptr_t target = reinterpret_cast<std::uintptr_t>(address);
+	// The value is stored in the buffer in the Variant, the copies of the Variant have the same buffer content.
+	// The buffer is zero initialized, so the bytes after the value are the same too.
+	if(! item.getMetaType()->isReference() && target >= itemBegin && target < itemBegin + sizeof(Variant)) {
+		std::memcpy(key.target.data(), address, VariantData::bufferSize);
+	}
+	else {
+		key.target[0] = (std::uint64_t)target;
+	}
+	return key;
+}
+
+std::size_t getItemTableIndex(const ProfileKey & key)
+{
+	std::uint64_t value = (std::uint64_t)reinterpret_cast<std::uintptr_t>(key.metaType) >> 3;
+	value = (value ^ key.target[0]) * 0x9e3779b97f4a7c15ull;
+	value = (value ^ key.target[1] ^ (value >> 29)) * 0x9e3779b97f4a7c15ull;
+	return (std::size_t)(value >> 52) & (itemTableSize - 1);
+}
+
+ItemStatistics * findItemStatistics(const ProfileKey & key, const bool create)
+{
+	std::size_t index = getItemTableIndex(key);
+	for(std::size_t probe = 0; probe < itemTableSize; ++probe) {
+		std::atomic<ItemStatistics *> & slot = itemTable[index];
+		ItemStatistics * item = slot.load(std::memory_order_acquire);
+		if(item == nullptr) {
+			if(! create) {
+				return nullptr;
+			}
+			std::unique_ptr<ItemStatistics> newItem(new ItemStatistics());
+			newItem->key = key;
+			if(slot.compare_exchange_strong(item, newItem.get(), std::memory_order_acq_rel)) {
+				return newItem.release();
+			}
+			// Another thread filled the slot, item is the filled value.
+		}
+		if(item->key == key) {
+			return item;
+		}
+		index = (index + 1) & (itemTableSize - 1);
+	}
+	return nullptr;
+}
+
+PhaseHistogram * getPhaseHistogram(ItemStatistics * item, const ProfilePhase phase)
+{
+	std::atomic<PhaseHistogram *> & slot = item->histogramList[(std::size_t)phase];
+	PhaseHistogram * histogram = slot.load(std::memory_order_acquire);
+	if(histogram == nullptr) {
+		std::unique_ptr<PhaseHistogram> newHistogram(new PhaseHistogram());
+		if(slot.compare_exchange_strong(histogram, newHistogram.get(), std::memory_order_acq_rel)) {
+			histogram = newHistogram.release();
+		}
+	}
+	return histogram;
+}
+
+std::uint32_t getProfileThreadId()
+{
+	static std::atomic<std::uint32_t> nextThreadId(1);
+	thread_local std::uint32_t threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+	return threadId;
+}
+
+void recordHistogram(const ProfileKey & key, const ProfilePhase phase, const std::uint64_t ticks)
+{
+	ItemStatistics * item = findItemStatistics(key, true);
+	if(item == nullptr) {
+		droppedSampleCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	PhaseHistogram * histogram = getPhaseHistogram(item, phase);
+	histogram->bucketList[getBucketIndex(ticks)].fetch_add(1, std::memory_order_relaxed);
+	histogram->totalTicks.fetch_add(ticks, std::memory_order_relaxed);
+	std::uint64_t maxTicks = histogram->maxTicks.load(std::memory_order_relaxed);
+	while(ticks > maxTicks
+		&& ! histogram->maxTicks.compare_exchange_weak(maxTicks, ticks, std::memory_order_relaxed)) {
+	}
+}
+
+void recordTraceEvent(
+	TraceBuffer * buffer,
+	const ProfileKey & key,
+	const ProfilePhase phase,
+	const std::uint64_t startTicks,
+	const std::uint64_t endTicks
+)
+{
+	const std::size_t index = buffer->reservedCount.fetch_add(1, std::memory_order_relaxed);
+	if(index >= buffer->capacity) {
+		return;
+	}
+	TraceEvent & event = buffer->eventList[index];
+	event.key = key;
+	event.startTicks = startTicks;
+	event.endTicks = endTicks;
+	event.threadId = getProfileThreadId();
+	event.phase = phase;
+	event.ready.store(true, std::memory_order_release);
+}
+
+// Must be called with the state locked.
+void updateProfilingEnabled(ProfilerState & state)
+{
+	if(! state.calibrated) {
+		state.calibrated = true;
+		state.calibrationTicks = readProfileTicks();
+		state.calibrationTime = std::chrono::steady_clock::now();
+	}
+	histogramEnabled.store(state.histogramEnabled, std::memory_order_relaxed);
+	profilingEnabled.store(state.histogramEnabled || currentTraceBuffer.load() != nullptr, std::memory_order_relaxed);
+}
+
+double getNanosecondsPerTick()
+{
+#ifdef METAPP_PROFILER_USE_TSC
+	ProfilerState & state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	if(! state.calibrated) {
+		state.calibrated = true;
+		state.calibrationTicks = readProfileTicks();
+		state.calibrationTime = std::chrono::steady_clock::now();
+	}
+	// The time stamp counter is calibrated against steady_clock over at least 10 ms.
+	const std::chrono::milliseconds minimumDuration(10);
+	const auto elapsed = std::chrono::steady_clock::now() - state.calibrationTime;
+	if(elapsed < minimumDuration) {
+		std::this_thread::sleep_for(minimumDuration - elapsed);
+	}
+	const std::uint64_t ticks = readProfileTicks();
+	const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - state.calibrationTime
+	).count();
+	if(ticks <= state.calibrationTicks) {
+		return 1.0;
+	}
+	return (double)nanoseconds / (double)(ticks - state.calibrationTicks);
+#else
+	return 1.0;
+#endif
+}
+
+using NameMap = std::map<ProfileKey, std::string>;
+
+std::string getItemName(const NameMap & nameMap, const ProfileKey & key)
+{
+	auto it = nameMap.find(key);
+	if(it != nameMap.end()) {
+		return it->second;
+	}
+	std::ostringstream stream;
+	stream << std::hex << "0x" << key.target[0];
+	return stream.str();
+}
+
+void writeJsonString(std::ostream & stream, const std::string & text)
+{
+	stream << '"';
+	for(const char c : text) {
+		switch(c) {
+		case '"':
+			stream << "\\\"";
+			break;
+
+		case '\\':
+			stream << "\\\\";
+			break;
+
+		case '\n':
+			stream << "\\n";
+			break;
+
+		case '\r':
+			stream << "\\r";
+			break;
+
+		case '\t':
+			stream << "\\t";
+			break;
+
+		default:
+			if((unsigned char)c < 0x20) {
+				stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec << std::setfill(' ');
+			}
+			else {
+				stream << c;
+			}
+			break;
+		}
+	}
+	stream << '"';
+}
+
+void doAddMetaItem(NameMap & nameMap, const MetaItem & item, const std::string & prefix)
+{
+	if(item.isEmpty()) {
+		return;
+	}
+	const std::string name = prefix + item.getName();
+	if(item.getType() == MetaItem::Type::accessible) {
+		nameMap[makeProfileKey(item.asAccessible())] = name;
+	}
+	else if(item.getType() == MetaItem::Type::callable) {
+		const Variant & callable = item.asCallable();
+		nameMap[makeProfileKey(callable)] = name;
+		if(getNonReferenceMetaType(callable)->getTypeKind() == tkOverloadedFunction) {
+			const auto & callableList = callable.get<const OverloadedFunction &>().getCallableList();
+			for(std::size_t i = 0; i < callableList.size(); ++i) {
+				nameMap[makeProfileKey(callableList[i])] = name + "#" + std::to_string(i);
+			}
+		}
+	}
+}
+
+void doAddMetaClass(NameMap & nameMap, const MetaClass * metaClass, const std::string & prefix)
+{
+	for(const MetaItem & item : metaClass->getAccessibleView(MetaClass::flagNone)) {
+		doAddMetaItem(nameMap, item, prefix);
+	}
+	for(const MetaItem & item : metaClass->getCallableView(MetaClass::flagNone)) {
+		doAddMetaItem(nameMap, item, prefix);
+	}
+}
+
+void doAddMetaRepo(NameMap & nameMap, const MetaRepo * metaRepo, const std::string & prefix)
+{
+	for(const MetaItem & item : metaRepo->getAccessibleView()) {
+		doAddMetaItem(nameMap, item, prefix);
+	}
+	for(const MetaItem & item : metaRepo->getCallableView()) {
+		doAddMetaItem(nameMap, item, prefix);
+	}
+	for(const MetaItem & item : metaRepo->getTypeView()) {
+		const MetaClass * metaClass = getNonReferenceMetaType(item.asMetaType())->getMetaClass();
+		if(metaClass != nullptr) {
+			doAddMetaClass(nameMap, metaClass, prefix + item.getName() + "::");
+		}
+	}
+	for(const MetaItem & item : metaRepo->getRepoView()) {
+		doAddMetaRepo(nameMap, item.asMetaRepo(), prefix + item.getName() + "::");
+	}
+}
+
+void addNames(const NameMap & nameMap)
+{
+	ProfilerState & state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	for(const auto & item : nameMap) {
+		state.nameMap[item.first] = item.second;
+	}
+}
+
+void collectSubRepos(std::set<const MetaRepo *> & subRepoSet, const MetaRepo * metaRepo)
+{
+	for(const MetaItem & item : metaRepo->getRepoView()) {
+		if(subRepoSet.insert(item.asMetaRepo()).second) {
+			collectSubRepos(subRepoSet, item.asMetaRepo());
+		}
+	}
+}
+
+// The names from all existing MetaRepos, overridden by the names given to the profiler.
+// The sub repos are named from their parents, so their items have the qualified names.
+NameMap buildNameMap()
+{
+	NameMap nameMap;
+	const MetaRepoList * repoList = getMetaRepoList();
+	std::set<const MetaRepo *> subRepoSet;
+	for(const MetaRepo * metaRepo : *repoList) {
+		collectSubRepos(subRepoSet, metaRepo);
+	}
+	for(const MetaRepo * metaRepo : *repoList) {
+		if(subRepoSet.find(metaRepo) == subRepoSet.end()) {
+			doAddMetaRepo(nameMap, metaRepo, std::string());
+		}
+	}
+	ProfilerState & state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	for(const auto & item : state.nameMap) {
+		nameMap[item.first] = item.second;
+	}
+	return nameMap;
+}
+
+} // namespace
+
+void recordProfileSample(const Variant * item, const ProfilePhase phase, const std::uint64_t startTicks, const std::uint64_t endTicks)
+{
+	const ProfileKey key = makeProfileKey(*item);
+	const std::uint64_t ticks = (endTicks > startTicks ? endTicks - startTicks : 0);
+	if(histogramEnabled.load(std::memory_order_relaxed)) {
+		recordHistogram(key, phase, ticks);
+	}
+	TraceBuffer * buffer = currentTraceBuffer.load(std::memory_order_acquire);
+	if(buffer != nullptr) {
+		recordTraceEvent(buffer, key, phase, startTicks, endTicks);
+	}
+}
+
+} // namespace internal_
+
+ProfileHistogram::ProfileHistogram()
+	: bucketList(), count(0), totalTicks(0), maxTicks(0), nanosecondsPerTick(1.0)
+{
+}
+
+ProfileHistogram::ProfileHistogram(
+		std::vector<std::uint64_t> bucketList,
+		const std::uint64_t totalTicks,
+		const std::uint64_t maxTicks,
+		const double nanosecondsPerTick
+	)
+	:
+		bucketList(std::move(bucketList)),
+		count(0),
+		totalTicks(totalTicks),
+		maxTicks(maxTicks),
+		nanosecondsPerTick(nanosecondsPerTick)
+{
+	for(const std::uint64_t bucket : this->bucketList) {
+		count += bucket;
+	}
+}
+
+double ProfileHistogram::getTotal() const
+{
+	return (double)totalTicks * nanosecondsPerTick;
+}
+
+double ProfileHistogram::getMean() const
+{
+	return count == 0 ? 0.0 : getTotal() / (double)count;
+}
+
+double ProfileHistogram::getMax() const
+{
+	return (double)maxTicks * nanosecondsPerTick;
+}
+
+double ProfileHistogram::getPercentile(const double percentile) const
+{
+	if(count == 0) {
+		return 0.0;
+	}
+	const double clamped = std::min(100.0, std::max(0.0, percentile));
+	const std::uint64_t rank = std::max<std::uint64_t>(1, (std::uint64_t)(clamped / 100.0 * (double)count + 0.5));
+	std::uint64_t cumulative = 0;
+	for(std::size_t i = 0; i < bucketList.size(); ++i) {
+		cumulative += bucketList[i];
+		if(cumulative >= rank) {
+			// The middle of the bucket, but not larger than the max value.
+			const double ticks = (double)internal_::getBucketLowerBound(i)
+				+ (double)(internal_::getBucketWidth(i) - 1) / 2.0;
+			return std::min(ticks, (double)maxTicks) * nanosecondsPerTick;
+		}
+	}
+	return getMax();
+}
+
+void Profiler::enable()
+{
+	internal_::ProfilerState & state = internal_::getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.histogramEnabled = true;
+	internal_::updateProfilingEnabled(state);
+}
+
+void Profiler::disable()
+{
+	internal_::ProfilerState & state = internal_::getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.histogramEnabled = false;
+	internal_::updateProfilingEnabled(state);
+}
+
+bool Profiler::isEnabled()
+{
+	return internal_::histogramEnabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::reset()
+{
+	for(auto & slot : internal_::itemTable) {
+		internal_::ItemStatistics * item = slot.load(std::memory_order_acquire);
+		if(item == nullptr) {
+			continue;
+		}
+		for(auto & histogramSlot : item->histogramList) {
+			internal_::PhaseHistogram * histogram = histogramSlot.load(std::memory_order_acquire);
+			if(histogram == nullptr) {
+				continue;
+			}
+			for(auto & bucket : histogram->bucketList) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+			histogram->totalTicks.store(0, std::memory_order_relaxed);
+			histogram->maxTicks.store(0, std::memory_order_relaxed);
+		}
+	}
+	internal_::droppedSampleCount.store(0, std::memory_order_relaxed);
+}
+
+ProfileKey Profiler::getKey(const Variant & item)
+{
+	return internal_::makeProfileKey(item);
+}
+
+void Profiler::setName(const Variant & item, const std::string & name)
+{
+	const ProfileKey key = internal_::makeProfileKey(item);
+	internal_::ProfilerState & state = internal_::getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.nameMap[key] = name;
+}
+
+void Profiler::addMetaItem(const MetaItem & item, const std::string & prefix)
+{
+	internal_::NameMap nameMap;
+	internal_::doAddMetaItem(nameMap, item, prefix);
+	internal_::addNames(nameMap);
+}
+
+void Profiler::addMetaClass(const MetaClass * metaClass, const std::string & prefix)
+{
+	internal_::NameMap nameMap;
+	internal_::doAddMetaClass(nameMap, metaClass, prefix);
+	internal_::addNames(nameMap);
+}
+
+void Profiler::addMetaRepo(const MetaRepo * metaRepo)
+{
+	internal_::NameMap nameMap;
+	internal_::doAddMetaRepo(nameMap, metaRepo, std::string());
+	internal_::addNames(nameMap);
+}
+
+std::vector<ProfileRecord> Profiler::getRecordList()
+{
+	const double nanosecondsPerTick = internal_::getNanosecondsPerTick();
+	const internal_::NameMap nameMap = internal_::buildNameMap();
+
+	std::vector<ProfileRecord> recordList;
+	for(auto & slot : internal_::itemTable) {
+		internal_::ItemStatistics * item = slot.load(std::memory_order_acquire);
+		if(item == nullptr) {
+			continue;
+		}
+		ProfileRecord record;
+		record.key = item->key;
+		bool hasSample = false;
+		for(std::size_t phase = 0; phase < profilePhaseCount; ++phase) {
+			internal_::PhaseHistogram * histogram = item->histogramList[phase].load(std::memory_order_acquire);
+			if(histogram == nullptr) {
+				continue;
+			}
+			std::vector<std::uint64_t> bucketList(internal_::bucketCount);
+			for(std::size_t i = 0; i < internal_::bucketCount; ++i) {
+				bucketList[i] = histogram->bucketList[i].load(std::memory_order_relaxed);
+			}
+			record.histogramList[phase] = ProfileHistogram(
+				std::move(bucketList),
+				histogram->totalTicks.load(std::memory_order_relaxed),
+				histogram->maxTicks.load(std::memory_order_relaxed),
+				nanosecondsPerTick
+			);
+			hasSample = hasSample || record.histogramList[phase].getCount() > 0;
+		}
+		if(hasSample) {
+			record.name = internal_::getItemName(nameMap, item->key);
+			recordList.push_back(std::move(record));
+		}
+	}
+	std::sort(recordList.begin(), recordList.end(), [](const ProfileRecord & a, const ProfileRecord & b) {
+		return a.name < b.name;
+	});
+	return recordList;
+}
+
+void Profiler::writeReport(std::ostream & stream)
+{
+	const std::vector<ProfileRecord> recordList = getRecordList();
+	std::size_t nameWidth = 4;
+	for(const ProfileRecord & record : recordList) {
+		nameWidth = std::max(nameWidth, record.name.size());
+	}
+	const auto flags = stream.flags();
+	stream << std::left << std::setw((int)nameWidth) << "Name" << std::right
+		<< std::setw(8) << "Phase"
+		<< std::setw(12) << "Count"
+		<< std::setw(12) << "Mean(ns)"
+		<< std::setw(12) << "P50(ns)"
+		<< std::setw(12) << "P90(ns)"
+		<< std::setw(12) << "P99(ns)"
+		<< std::setw(12) << "Max(ns)"
+		<< std::endl;
+	stream << std::fixed << std::setprecision(1);
+	for(const ProfileRecord & record : recordList) {
+		for(std::size_t phase = 0; phase < profilePhaseCount; ++phase) {
+			const ProfileHistogram & histogram = record.histogramList[phase];
+			if(histogram.getCount() == 0) {
+				continue;
+			}
+			stream << std::left << std::setw((int)nameWidth) << record.name << std::right
+				<< std::setw(8) << internal_::phaseNameList[phase]
+				<< std::setw(12) << histogram.getCount()
+				<< std::setw(12) << histogram.getMean()
+				<< std::setw(12) << histogram.getPercentile(50)
+				<< std::setw(12) << histogram.getPercentile(90)
+				<< std::setw(12) << histogram.getPercentile(99)
+				<< std::setw(12) << histogram.getMax()
+				<< std::endl;
+		}
+	}
+	stream.flags(flags);
+}
+
+std::uint64_t Profiler::getDroppedSampleCount()
+{
+	return internal_::droppedSampleCount.load(std::memory_order_relaxed);
+}
+
+void Profiler::startTrace(const std::size_t maxEventCount)
+{
+	internal_::ProfilerState & state = internal_::getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	std::unique_ptr<internal_::TraceBuffer> buffer(new internal_::TraceBuffer(maxEventCount));
+	internal_::currentTraceBuffer.store(buffer.get(), std::memory_order_release);
+	if(state.traceBuffer) {
+		state.previousTraceBuffer = std::move(state.traceBuffer);
+	}
+	state.traceBuffer = std::move(buffer);
+	internal_::updateProfilingEnabled(state);
+}
+
+void Profiler::stopTrace()
+{
+	internal_::ProfilerState & state = internal_::getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	internal_::currentTraceBuffer.store(nullptr, std::memory_order_release);
+	internal_::updateProfilingEnabled(state);
+}
+
+bool Profiler::isTracing()
+{
+	return internal_::currentTraceBuffer.load(std::memory_order_relaxed) != nullptr;
+}
+
+std::size_t Profiler::getTraceEventCount()
+{
+	internal_::ProfilerState & state = internal_::getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	if(! state.traceBuffer) {
+		return 0;
+	}
+	return std::min(state.traceBuffer->reservedCount.load(std::memory_order_relaxed), state.traceBuffer->capacity);
+}
+
+void Profiler::writeTrace(std::ostream & stream)
+{
+	const double nanosecondsPerTick = internal_::getNanosecondsPerTick();
+	const internal_::NameMap nameMap = internal_::buildNameMap();
+	internal_::ProfilerState & state = internal_::getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+
+	const auto flags = stream.flags();
+	stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	if(state.traceBuffer) {
+		const internal_::TraceBuffer & buffer = *state.traceBuffer;
+		const std::size_t eventCount = std::min(buffer.reservedCount.load(std::memory_order_relaxed), buffer.capacity);
+		bool first = true;
+		stream << std::fixed << std::setprecision(3);
+		for(std::size_t i = 0; i < eventCount; ++i) {
+			const internal_::TraceEvent & event = buffer.eventList[i];
+			// The event is still being written by another thread.
+			if(! event.ready.load(std::memory_order_acquire)) {
+				continue;
+			}
+			const std::size_t phase = (std::size_t)event.phase;
+			std::string name = internal_::getItemName(nameMap, event.key);
+			if(event.phase != ProfilePhase::invoke && event.phase != ProfilePhase::get && event.phase != ProfilePhase::set) {
+				name += "/";
+				name += internal_::phaseNameList[phase];
+			}
+			const std::uint64_t startTicks = event.startTicks > buffer.startTicks ? event.startTicks - buffer.startTicks : 0;
+			stream << (first ? "\n" : ",\n");
+			first = false;
+			stream << "{\"name\":";
+			internal_::writeJsonString(stream, name);
+			stream << ",\"cat\":\"" << internal_::phaseNameList[phase] << "\""
+				<< ",\"ph\":\"X\""
+				<< ",\"ts\":" << (double)startTicks * nanosecondsPerTick / 1000.0
+				<< ",\"dur\":" << (double)(event.endTicks - event.startTicks) * nanosecondsPerTick / 1000.0
+				<< ",\"pid\":1"
+				<< ",\"tid\":" << event.threadId
+				<< "}";
+		}
+	}
+	stream << "\n]}\n";
+	stream.flags(flags);
+}
+
+bool Profiler::writeTrace(const std::string & fileName)
+{
+	std::ofstream file(fileName.c_str());
+	if(! file) {
+		return false;
+	}
+	writeTrace(file);
+	return file.good();
+}
+
+
+} // namespace metapp
@@ -0,0 +1,949 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/utilities/query.h"
+#include "metapp/utilities/parallel.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/interfaces/metaindexable.h"
+#include "metapp/interfaces/metaiterable.h"
+#include "metapp/metarepo.h"
+#include "metapp/allmetatypes.h"
+
+#include <algorithm>
+#include <cstring>
+#include <array>
+#include <memory>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+const std::string emptyString;
+
+enum class ColumnKind
+{
+	signedInteger,
+	unsignedInteger,
+	real,
+	string
+};
+
+// The numeric properties are stored as unsigned 64 bit keys which have the same order as the values,
+// so all numeric columns are compared, filtered, and radix sorted the same way.
+std::uint64_t encodeKey(const long long value)
+{
+	return (std::uint64_t)value ^ ((std::uint64_t)1 << 63);
+}
+
+std::uint64_t encodeKey(const unsigned long long value)
+{
+	return (std::uint64_t)value;
+}
+
+std::uint64_t encodeKey(double value)
+{
+	// -0.0 and 0.0 are equal.
+	if(value == 0) {
+		value = 0;
+	}
+	std::uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	const std::uint64_t signBit = (std::uint64_t)1 << 63;
+	return (bits & signBit) != 0 ? ~bits : (bits | signBit);
+}
+
+template <typename T, typename Enabled = void>
+struct KeyTraits;
+
+template <typename T>
+struct KeyTraits <T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type>
+{
+	static constexpr ColumnKind columnKind = ColumnKind::signedInteger;
+
+	static std::uint64_t encode(const T value) {
+		return encodeKey((long long)value);
+	}
+};
+
+template <typename T>
+struct KeyTraits <T, typename std::enable_if<std::is_integral<T>::value && ! std::is_signed<T>::value>::type>
+{
+	static constexpr ColumnKind columnKind = ColumnKind::unsignedInteger;
+
+	static std::uint64_t encode(const T value) {
+		return encodeKey((unsigned long long)value);
+	}
+};
+
+template <typename T>
+struct KeyTraits <T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+	static constexpr ColumnKind columnKind = ColumnKind::real;
+
+	static std::uint64_t encode(const T value) {
+		return encodeKey((double)value);
+	}
+};
+
+// The addresses of the elements in a container. Contiguous containers are accessed by the data pointer
+// and the stride, the other containers are accessed by the address list collected once.
+class ElementSource
+{
+public:
+	ElementSource(const Variant & container, const MetaType * classMetaType)
+		:
+			container(container),
+			metaIndexable(nullptr),
+			data(nullptr),
+			stride(0),
+			size(0),
+			isPointer(false),
+			addressList(),
+			elementList(),
+			nullList()
+	{
+		metaIndexable = getRandomAccessIndexable(container, &size);
+		if(metaIndexable != nullptr) {
+			if(size == 0) {
+				return;
+			}
+			const Variant first = metaIndexable->get(container, 0);
+			doCheckElementType(first.getMetaType(), classMetaType);
+			char * dataPointer = static_cast<char *>(metaIndexable->getData(container));
+			if(dataPointer != nullptr && dataPointer == first.getAddress()) {
+				data = dataPointer;
+				stride = (size > 1 ? (std::size_t)((char *)metaIndexable->get(container, 1).getAddress() - data) : 0);
+			}
+			else {
+				addressList.resize(size);
+				for(std::size_t i = 0; i < size; ++i) {
+					addressList[i] = static_cast<char *>(metaIndexable->get(container, i).getAddress());
+				}
+			}
+		}
+		else {
+			requireIterable(container)->forEach(container, [this](const Variant & element) -> bool {
+				elementList.push_back(element);
+				return true;
+			});
+			size = elementList.size();
+			if(size > 0) {
+				doCheckElementType(elementList[0].getMetaType(), classMetaType);
+			}
+			addressList.resize(size);
+			for(std::size_t i = 0; i < size; ++i) {
+				addressList[i] = static_cast<char *>(elementList[i].getAddress());
+			}
+		}
+		if(isPointer) {
+			nullList.resize(size);
+			for(std::size_t i = 0; i < size; ++i) {
+				nullList[i] = (getInstance(i) == nullptr ? 1 : 0);
+			}
+		}
+	}
+
+	std::size_t getSize() const {
+		return size;
+	}
+
+	bool isPointerElement() const {
+		return isPointer;
+	}
+
+	// A null element doesn't have property values, it doesn't match any condition, and is placed first in sorting and grouping.
+	bool isNull(const std::size_t index) const {
+		return ! nullList.empty() && nullList[index] != 0;
+	}
+
+	// Replaces the elements with their base class objects of baseMetaType, using the registered inheritance.
+	// Returns false if the elements can't be cast.
+	bool castToBase(const MetaType * classMetaType, const MetaType * baseMetaType) {
+		const MetaRepo * repo = getMetaRepoList()->findMetaRepoForHierarchy(classMetaType);
+		if(repo == nullptr || size == 0) {
+			return false;
+		}
+		if(! isPointer) {
+			// The elements are complete objects of the class, the base class is at the same offset in all elements.
+			char * first = const_cast<char *>(getInstance(0));
+			char * base = static_cast<char *>(repo->cast(first, classMetaType, baseMetaType));
+			if(base == nullptr) {
+				return false;
+			}
+			if(data != nullptr) {
+				data += base - first;
+			}
+			else {
+				for(char * & address : addressList) {
+					address += base - first;
+				}
+			}
+			return true;
+		}
+		std::vector<char *> baseList(size);
+		for(std::size_t i = 0; i < size; ++i) {
+			if(! isNull(i)) {
+				baseList[i] = static_cast<char *>(repo->cast(const_cast<char *>(getInstance(i)), classMetaType, baseMetaType));
+				if(baseList[i] == nullptr) {
+					return false;
+				}
+			}
+		}
+		addressList.swap(baseList);
+		data = nullptr;
+		isPointer = false;
+		return true;
+	}
+
+	// The address of the object, nullptr if the element is a null pointer.
+	const char * getInstance(const std::size_t index) const {
+		const char * address = (data != nullptr ? data + index * stride : addressList[index]);
+		return isPointer ? *(const char * const *)address : address;
+	}
+
+	// The element as a Variant which can be passed as the instance to accessibleGet.
+	Variant getElement(const std::size_t index) const {
+		if(! elementList.empty()) {
+			return elementList[index];
+		}
+		return metaIndexable->get(container, index);
+	}
+
+private:
+	void doCheckElementType(const MetaType * elementType, const MetaType * classMetaType) {
+		elementType = getNonReferenceMetaType(elementType);
+		if(elementType->isPointer()) {
+			isPointer = true;
+			elementType = elementType->getUpType();
+		}
+		if(classMetaType->getMetaClass() == nullptr || ! elementType->equal(classMetaType)) {
+			raiseException<BadCastException>("The element type doesn't match the query class");
+		}
+	}
+
+private:
+	const Variant & container;
+	const MetaIndexable * metaIndexable;
+	char * data;
+	std::size_t stride;
+	std::size_t size;
+	bool isPointer;
+	std::vector<char *> addressList;
+	std::vector<Variant> elementList;
+	// Empty if the elements are not pointers, otherwise 1 for the null pointers.
+	std::vector<char> nullList;
+};
+
+// The values of the null elements are not read, they are 0 or an empty string and must not be compared.
+struct QueryColumn
+{
+	std::vector<std::uint64_t> keyList;
+	std::vector<const std::string *> stringList;
+	// The strings which are not member data are copied here.
+	std::vector<std::string> stringStorage;
+	// If the property is member data which is read at memberOffset in the objects in memberSource,
+	// memberSource is the elements, or baseSource which are the base class objects in the elements.
+	const ElementSource * memberSource = nullptr;
+	std::ptrdiff_t memberOffset = 0;
+	std::unique_ptr<ElementSource> baseSource;
+};
+
+using ReadKeyRange = void (*)(
+	const ElementSource & source,
+	const std::ptrdiff_t offset,
+	std::uint64_t * keyList,
+	const std::size_t begin,
+	const std::size_t end
+);
+
+template <typename T>
+void readKeyRange(
+	const ElementSource & source,
+	const std::ptrdiff_t offset,
+	std::uint64_t * keyList,
+	const std::size_t begin,
+	const std::size_t end
+)
+{
+	for(std::size_t i = begin; i < end; ++i) {
+		if(! source.isNull(i)) {
+			keyList[i] = KeyTraits<T>::encode(*(const T *)(source.getInstance(i) + offset));
+		}
+	}
+}
+
+struct PropertyReader
+{
+	ColumnKind columnKind;
+	// nullptr if the property is std::string or is not an arithmetic type.
+	ReadKeyRange readKeyRange;
+};
+
+template <typename T>
+PropertyReader makePropertyReader()
+{
+	return PropertyReader { KeyTraits<T>::columnKind, &readKeyRange<T> };
+}
+
+bool getPropertyReader(const MetaType * valueType, PropertyReader * reader)
+{
+	switch(valueType->getTypeKind()) {
+	case tkBool:
+		*reader = makePropertyReader<bool>();
+		return true;
+
+	case tkChar:
+		*reader = makePropertyReader<char>();
+		return true;
+
+	case tkWideChar:
+		*reader = makePropertyReader<wchar_t>();
+		return true;
+
+	case tkChar16:
+		*reader = makePropertyReader<char16_t>();
+		return true;
+
+	case tkChar32:
+		*reader = makePropertyReader<char32_t>();
+		return true;
+
+	case tkSignedChar:
+		*reader = makePropertyReader<signed char>();
+		return true;
+
+	case tkUnsignedChar:
+		*reader = makePropertyReader<unsigned char>();
+		return true;
+
+	case tkShort:
+		*reader = makePropertyReader<short>();
+		return true;
+
+	case tkUnsignedShort:
+		*reader = makePropertyReader<unsigned short>();
+		return true;
+
+	case tkInt:
+		*reader = makePropertyReader<int>();
+		return true;
+
+	case tkUnsignedInt:
+		*reader = makePropertyReader<unsigned int>();
+		return true;
+
+	case tkLong:
+		*reader = makePropertyReader<long>();
+		return true;
+
+	case tkUnsignedLong:
+		*reader = makePropertyReader<unsigned long>();
+		return true;
+
+	case tkLongLong:
+		*reader = makePropertyReader<long long>();
+		return true;
+
+	case tkUnsignedLongLong:
+		*reader = makePropertyReader<unsigned long long>();
+		return true;
+
+	case tkFloat:
+		*reader = makePropertyReader<float>();
+		return true;
+
+	case tkDouble:
+		*reader = makePropertyReader<double>();
+		return true;
+
+	case tkLongDouble:
+		*reader = makePropertyReader<long double>();
+		return true;
+
+	case tkStdString:
+		*reader = PropertyReader { ColumnKind::string, nullptr };
+		return true;
+
+	case tkEnum:
+		// The size of the enum is not known, it's read by accessibleGet and cast to long long.
+		*reader = PropertyReader { ColumnKind::signedInteger, nullptr };
+		return true;
+
+	default:
+		break;
+	}
+	return false;
+}
+
+struct QueryProperty
+{
+	std::string name;
+	Variant accessible;
+	const MetaType * valueType;
+	PropertyReader reader;
+	// True if the accessible is a member data pointer, which value is at a fixed offset in the object.
+	bool isMemberData;
+	// The class which declares the member data, it's the query class or a base class.
+	const MetaType * memberClassType;
+};
+
+struct QueryCondition
+{
+	std::size_t propertyIndex;
+	QueryOperator op;
+	std::uint64_t key;
+	std::string text;
+};
+
+struct QueryOrder
+{
+	std::size_t propertyIndex;
+	bool descending;
+};
+
+template <typename T>
+bool compareByOperator(const T & a, const T & b, const QueryOperator op)
+{
+	switch(op) {
+	case QueryOperator::equal:
+		return a == b;
+
+	case QueryOperator::notEqual:
+		return ! (a == b);
+
+	case QueryOperator::less:
+		return a < b;
+
+	case QueryOperator::lessEqual:
+		return ! (b < a);
+
+	case QueryOperator::greater:
+		return b < a;
+
+	case QueryOperator::greaterEqual:
+		return ! (a < b);
+	}
+	return false;
+}
+
+template <typename F>
+void runRange(Executor * executor, const std::size_t count, F & func)
+{
+	if(executor == nullptr) {
+		func(0, count);
+	}
+	else {
+		parallelRunRange(*executor, count, 0, func);
+	}
+}
+
+// Stable LSD radix sort of indexList by keyList[index]. The bytes which are the same in all keys are skipped.
+void radixSortIndexes(std::vector<std::size_t> & indexList, const std::vector<std::uint64_t> & keyList, const bool descending)
+{
+	struct Item
+	{
+		std::uint64_t key;
+		std::size_t index;
+	};
+
+	const std::size_t count = indexList.size();
+	const std::uint64_t flip = (descending ? ~(std::uint64_t)0 : 0);
+	std::vector<Item> itemList(count);
+	std::uint64_t differentBits = 0;
+	for(std::size_t i = 0; i < count; ++i) {
+		itemList[i].key = keyList[indexList[i]] ^ flip;
+		itemList[i].index = indexList[i];
+		differentBits |= itemList[i].key ^ itemList[0].key;
+	}
+	if(differentBits == 0) {
+		return;
+	}
+	if(count < 256) {
+		std::stable_sort(itemList.begin(), itemList.end(), [](const Item & a, const Item & b) {
+			return a.key < b.key;
+		});
+	}
+	else {
+		std::vector<Item> tempList(count);
+		for(int shift = 0; shift < 64; shift += 8) {
+			if(((differentBits >> shift) & 0xff) == 0) {
+				continue;
+			}
+			std::array<std::size_t, 257> offsetList {};
+			for(const Item & item : itemList) {
+				++offsetList[((item.key >> shift) & 0xff) + 1];
+			}
+			for(std::size_t i = 1; i < offsetList.size(); ++i) {
+				offsetList[i] += offsetList[i - 1];
+			}
+			for(const Item & item : itemList) {
+				tempList[offsetList[(item.key >> shift) & 0xff]++] = item;
+			}
+			itemList.swap(tempList);
+		}
+	}
+	for(std::size_t i = 0; i < count; ++i) {
+		indexList[i] = itemList[i].index;
+	}
+}
+
+} // namespace
+
+class QueryImplement
+{
+public:
+	explicit QueryImplement(const MetaType * classMetaType)
+		:
+			classMetaType(getNonReferenceMetaType(classMetaType)),
+			propertyList(),
+			conditionList(),
+			orderList(),
+			executor(nullptr)
+	{
+	}
+
+	bool findProperty(const std::string & name, std::size_t * index)
+	{
+		for(std::size_t i = 0; i < propertyList.size(); ++i) {
+			if(propertyList[i].name == name) {
+				*index = i;
+				return true;
+			}
+		}
+		QueryProperty property;
+		if(! resolveProperty(name, &property)) {
+			return false;
+		}
+		propertyList.push_back(property);
+		*index = propertyList.size() - 1;
+		return true;
+	}
+
+	bool resolveProperty(const std::string & name, QueryProperty * property) const
+	{
+		const MetaClass * metaClass = classMetaType->getMetaClass();
+		if(metaClass == nullptr) {
+			raiseException<UnsupportedException>("The query class doesn't have MetaClass");
+			return false;
+		}
+		const MetaItem & item = metaClass->getAccessible(name);
+		if(item.isEmpty()) {
+			raiseException<IllegalArgumentException>("Can't find the property " + name);
+			return false;
+		}
+		property->name = name;
+		property->accessible = item.asAccessible();
+		property->valueType = getNonReferenceMetaType(accessibleGetValueType(property->accessible));
+		if(! getPropertyReader(property->valueType, &property->reader)) {
+			raiseException<UnsupportedException>("The type of the property " + name + " is not supported");
+			return false;
+		}
+		property->isMemberData = (getNonReferenceMetaType(property->accessible)->getTypeKind() == tkMemberPointer);
+		property->memberClassType = (property->isMemberData
+			? getNonReferenceMetaType(accessibleGetClassType(property->accessible)) : nullptr);
+		return true;
+	}
+
+	void addCondition(const std::string & propertyName, const QueryOperator op, const Variant & value)
+	{
+		QueryCondition condition;
+		if(! findProperty(propertyName, &condition.propertyIndex)) {
+			return;
+		}
+		condition.op = op;
+		condition.key = 0;
+		switch(propertyList[condition.propertyIndex].reader.columnKind) {
+		case ColumnKind::signedInteger:
+			condition.key = encodeKey(value.cast<long long>().get<long long>());
+			break;
+
+		case ColumnKind::unsignedInteger:
+			condition.key = encodeKey(value.cast<unsigned long long>().get<unsigned long long>());
+			break;
+
+		case ColumnKind::real:
+			condition.key = encodeKey(value.cast<double>().get<double>());
+			break;
+
+		case ColumnKind::string:
+			condition.text = value.cast<std::string>().get<const std::string &>();
+			break;
+		}
+		conditionList.push_back(condition);
+	}
+
+	void addOrder(const std::string & propertyName, const bool descending)
+	{
+		QueryOrder order;
+		if(findProperty(propertyName, &order.propertyIndex)) {
+			order.descending = descending;
+			orderList.push_back(order);
+		}
+	}
+
+	void setExecutor(Executor * executor_)
+	{
+		executor = executor_;
+	}
+
+	std::vector<std::size_t> execute(const Variant & container) const
+	{
+		const ElementSource source(container, classMetaType);
+		return doExecute(source);
+	}
+
+	std::vector<QueryGroup> group(const Variant & container, const std::string & propertyName) const
+	{
+		std::vector<QueryGroup> result;
+		QueryProperty property;
+		if(! resolveProperty(propertyName, &property)) {
+			return result;
+		}
+		const ElementSource source(container, classMetaType);
+		std::vector<std::size_t> indexList = doExecute(source);
+		if(indexList.empty()) {
+			return result;
+		}
+		QueryColumn column;
+		doExtractColumn(source, property, column);
+
+		// The null elements are in the first group, which key is empty.
+		auto firstValue = std::stable_partition(indexList.begin(), indexList.end(), [&source](const std::size_t index) {
+			return source.isNull(index);
+		});
+		if(firstValue != indexList.begin()) {
+			result.push_back(QueryGroup());
+			result.back().indexList.assign(indexList.begin(), firstValue);
+			indexList.erase(indexList.begin(), firstValue);
+			if(indexList.empty()) {
+				return result;
+			}
+		}
+
+		const bool isString = (property.reader.columnKind == ColumnKind::string);
+		if(isString) {
+			std::stable_sort(indexList.begin(), indexList.end(), [&column](const std::size_t a, const std::size_t b) {
+				return *column.stringList[a] < *column.stringList[b];
+			});
+		}
+		else {
+			radixSortIndexes(indexList, column.keyList, false);
+		}
+
+		auto isSameKey = [isString, &column](const std::size_t a, const std::size_t b) {
+			return isString ? (*column.stringList[a] == *column.stringList[b]) : (column.keyList[a] == column.keyList[b]);
+		};
+		for(std::size_t i = 0; i < indexList.size(); ++i) {
+			if(i == 0 || ! isSameKey(indexList[i - 1], indexList[i])) {
+				result.push_back(QueryGroup());
+				if(column.memberSource != nullptr) {
+					result.back().key = Variant(property.valueType, column.memberSource->getInstance(indexList[i]) + column.memberOffset);
+				}
+				else {
+					const Variant value = accessibleGet(property.accessible, source.getElement(indexList[i]));
+					const MetaType * metaType = value.getMetaType();
+					result.back().key = (metaType->isReference() ? Variant(metaType->getUpType(), value.getAddress()) : value);
+				}
+			}
+			result.back().indexList.push_back(indexList[i]);
+		}
+		return result;
+	}
+
+private:
+	std::vector<std::size_t> doExecute(const ElementSource & source) const
+	{
+		const std::size_t size = source.getSize();
+
+		std::vector<QueryColumn> columnList(propertyList.size());
+		std::vector<bool> extractedList(propertyList.size(), false);
+		auto extract = [&](const std::size_t propertyIndex) {
+			if(! extractedList[propertyIndex]) {
+				extractedList[propertyIndex] = true;
+				doExtractColumn(source, propertyList[propertyIndex], columnList[propertyIndex]);
+			}
+		};
+
+		std::vector<std::size_t> indexList;
+		if(conditionList.empty()) {
+			indexList.resize(size);
+			for(std::size_t i = 0; i < size; ++i) {
+				indexList[i] = i;
+			}
+		}
+		else {
+			for(const QueryCondition & condition : conditionList) {
+				extract(condition.propertyIndex);
+			}
+			std::vector<char> matchList(size);
+			auto filter = [this, &source, &columnList, &matchList](const std::size_t begin, const std::size_t end) {
+				for(std::size_t i = begin; i < end; ++i) {
+					matchList[i] = (! source.isNull(i) && doMatch(columnList, i)) ? 1 : 0;
+				}
+			};
+			runRange(executor, size, filter);
+			for(std::size_t i = 0; i < size; ++i) {
+				if(matchList[i] != 0) {
+					indexList.push_back(i);
+				}
+			}
+		}
+
+		if(! orderList.empty() && indexList.size() > 1) {
+			for(const QueryOrder & order : orderList) {
+				extract(order.propertyIndex);
+			}
+			// The null elements are placed first, in the order in the container.
+			auto firstValue = std::stable_partition(indexList.begin(), indexList.end(), [&source](const std::size_t index) {
+				return source.isNull(index);
+			});
+			if(firstValue == indexList.begin()) {
+				doSort(indexList, columnList);
+			}
+			else {
+				std::vector<std::size_t> valueIndexList(firstValue, indexList.end());
+				doSort(valueIndexList, columnList);
+				std::copy(valueIndexList.begin(), valueIndexList.end(), firstValue);
+			}
+		}
+		return indexList;
+	}
+
+	void doExtractColumn(const ElementSource & source, const QueryProperty & property, QueryColumn & column) const
+	{
+		const std::size_t size = source.getSize();
+		const bool isString = (property.reader.columnKind == ColumnKind::string);
+		if(isString) {
+			column.stringList.resize(size);
+		}
+		else {
+			column.keyList.resize(size);
+		}
+		if(size == 0) {
+			return;
+		}
+
+		// The offset of member data in the class which declares it is the same in all elements,
+		// it's found from the first non-null element.
+		// If the member is in a base class, the elements are cast to the base class by the registered inheritance.
+		// The pointer elements are cast one by one, they may point to objects of derived classes in which
+		// a virtual base is at different offsets. If the pointer elements can't be cast, the member is read by accessibleGet.
+		bool hasOffset = false;
+		std::ptrdiff_t offset = 0;
+		const ElementSource * memberSource = &source;
+		if(property.isMemberData) {
+			bool canUseOffset = true;
+			if(! property.memberClassType->equal(classMetaType)) {
+				std::unique_ptr<ElementSource> baseSource(new ElementSource(source));
+				if(baseSource->castToBase(classMetaType, property.memberClassType)) {
+					column.baseSource = std::move(baseSource);
+					memberSource = column.baseSource.get();
+				}
+				else {
+					// Without the inheritance accessibleGet reads the member as if the base class is at the start of the object,
+					// the offset does the same for the objects stored by value.
+					canUseOffset = ! source.isPointerElement();
+				}
+			}
+			for(std::size_t i = 0; canUseOffset && i < size; ++i) {
+				if(! source.isNull(i)) {
+					// accessibleGet doesn't adjust the instance to the member class, so this is the offset in the member class.
+					const Variant value = accessibleGet(property.accessible, source.getElement(i));
+					if(value.getMetaType()->isReference()) {
+						hasOffset = true;
+						offset = (const char *)value.getAddress() - source.getInstance(i);
+					}
+					break;
+				}
+			}
+		}
+
+		if(hasOffset) {
+			column.memberSource = memberSource;
+			column.memberOffset = offset;
+		}
+
+		if(hasOffset && property.reader.readKeyRange != nullptr) {
+			ReadKeyRange readRange = property.reader.readKeyRange;
+			std::uint64_t * keyList = column.keyList.data();
+			auto func = [memberSource, readRange, offset, keyList](const std::size_t begin, const std::size_t end) {
+				readRange(*memberSource, offset, keyList, begin, end);
+			};
+			runRange(executor, size, func);
+			return;
+		}
+		if(hasOffset && isString) {
+			const std::string * empty = &emptyString;
+			auto func = [memberSource, offset, &column, empty](const std::size_t begin, const std::size_t end) {
+				for(std::size_t i = begin; i < end; ++i) {
+					column.stringList[i] = (memberSource->isNull(i)
+						? empty : (const std::string *)(memberSource->getInstance(i) + offset));
+				}
+			};
+			runRange(executor, size, func);
+			return;
+		}
+
+		// Accessors and enums are read by accessibleGet, and cast to the column type.
+		if(isString) {
+			column.stringStorage.resize(size);
+		}
+		const ColumnKind columnKind = property.reader.columnKind;
+		auto func = [&source, &property, &column, columnKind](const std::size_t begin, const std::size_t end) {
+			for(std::size_t i = begin; i < end; ++i) {
+				if(source.isNull(i)) {
+					if(columnKind == ColumnKind::string) {
+						column.stringList[i] = &column.stringStorage[i];
+					}
+					continue;
+				}
+				const Variant value = accessibleGet(property.accessible, source.getElement(i));
+				switch(columnKind) {
+				case ColumnKind::signedInteger:
+					column.keyList[i] = encodeKey(value.cast<long long>().get<long long>());
+					break;
+
+				case ColumnKind::unsignedInteger:
+					column.keyList[i] = encodeKey(value.cast<unsigned long long>().get<unsigned long long>());
+					break;
+
+				case ColumnKind::real:
+					column.keyList[i] = encodeKey(value.cast<double>().get<double>());
+					break;
+
+				case ColumnKind::string:
+					column.stringStorage[i] = value.cast<std::string>().get<const std::string &>();
+					column.stringList[i] = &column.stringStorage[i];
+					break;
+				}
+			}
+		};
+		runRange(executor, size, func);
+	}
+
+	bool doMatch(const std::vector<QueryColumn> & columnList, const std::size_t index) const
+	{
+		for(const QueryCondition & condition : conditionList) {
+			const QueryColumn & column = columnList[condition.propertyIndex];
+			const bool matched = (propertyList[condition.propertyIndex].reader.columnKind == ColumnKind::string)
+				? compareByOperator(*column.stringList[index], condition.text, condition.op)
+				: compareByOperator(column.keyList[index], condition.key, condition.op);
+			if(! matched) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void doSort(std::vector<std::size_t> & indexList, const std::vector<QueryColumn> & columnList) const
+	{
+		const bool hasString = std::any_of(orderList.begin(), orderList.end(), [this](const QueryOrder & order) {
+			return propertyList[order.propertyIndex].reader.columnKind == ColumnKind::string;
+		});
+		if(! hasString) {
+			// Radix sort is stable, sorting from the last key to the first key gives the order by all keys.
+			for(auto it = orderList.rbegin(); it != orderList.rend(); ++it) {
+				radixSortIndexes(indexList, columnList[it->propertyIndex].keyList, it->descending);
+			}
+			return;
+		}
+		std::stable_sort(indexList.begin(), indexList.end(), [this, &columnList](const std::size_t a, const std::size_t b) {
+			for(const QueryOrder & order : orderList) {
+				const QueryColumn & column = columnList[order.propertyIndex];
+				int result = 0;
+				if(propertyList[order.propertyIndex].reader.columnKind == ColumnKind::string) {
+					result = column.stringList[a]->compare(*column.stringList[b]);
+				}
+				else {
+					result = (column.keyList[a] < column.keyList[b] ? -1 : (column.keyList[b] < column.keyList[a] ? 1 : 0));
+				}
+				if(result != 0) {
+					return order.descending ? result > 0 : result < 0;
+				}
+			}
+			return false;
+		});
+	}
+
+private:
+	const MetaType * classMetaType;
+	std::vector<QueryProperty> propertyList;
+	std::vector<QueryCondition> conditionList;
+	std::vector<QueryOrder> orderList;
+	Executor * executor;
+};
+
+} // namespace internal_
+
+Query::Query(const MetaType * classMetaType)
+	: implement(new internal_::QueryImplement(classMetaType))
+{
+}
+
+Query::~Query()
+{
+}
+
+Query::Query(Query && other) noexcept
+	: implement(std::move(other.implement))
+{
+}
+
+Query & Query::operator = (Query && other) noexcept
+{
+	implement = std::move(other.implement);
+	return *this;
+}
+
+Query & Query::where(const std::string & propertyName, const QueryOperator op, const Variant & value)
+{
+	implement->addCondition(propertyName, op, value);
+	return *this;
+}
+
+Query & Query::orderBy(const std::string & propertyName, const bool descending)
+{
+	implement->addOrder(propertyName, descending);
+	return *this;
+}
+
+Query & Query::setExecutor(Executor * executor)
+{
+	implement->setExecutor(executor);
+	return *this;
+}
+
+std::vector<std::size_t> Query::execute(const Variant & container) const
+{
+	return implement->execute(container);
+}
+
+std::size_t Query::count(const Variant & container) const
+{
+	return implement->execute(container).size();
+}
+
+std::vector<QueryGroup> Query::group(const Variant & container, const std::string & propertyName) const
+{
+	return implement->group(container, propertyName);
+}
+
+
+} // namespace metapp
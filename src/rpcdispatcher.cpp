@@ -0,0 +1,546 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "metapp/utilities/rpcdispatcher.h"
+#include "metapp/interfaces/metacallable.h"
+#include "metapp/metarepo.h"
+#include "metapp/allmetatypes.h"
+
+#include <algorithm>
+#include <new>
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+// Decodes a value to a slot, and encodes a value from its address.
+struct RpcCodec
+{
+	// The non reference type of the slot, the arguments are passed to invokeRef as this type.
+	const MetaType * metaType;
+	std::uint32_t size;
+	std::uint32_t alignment;
+	// The encoded type kind, it's the underlying type kind for enums.
+	TypeKind typeKind;
+	// Constructs the value in the slot. Returns false if the request is truncated, then the slot is not constructed.
+	bool (*decode)(RpcReader & reader, void * slot);
+	// nullptr if the value is trivially destructible.
+	void (*destroy)(void * slot);
+	// nullptr for void.
+	void (*encode)(RpcWriter & writer, const void * value);
+};
+
+template <typename T>
+bool decodeArithmetic(RpcReader & reader, void * slot)
+{
+	return reader.read(static_cast<T *>(slot));
+}
+
+template <>
+bool decodeArithmetic<bool>(RpcReader & reader, void * slot)
+{
+	// Any byte other than 0 is true, reading it as bool directly is undefined behavior.
+	std::uint8_t value;
+	if(! reader.readBytes(&value, sizeof(bool))) {
+		return false;
+	}
+	*static_cast<bool *>(slot) = (value != 0);
+	return true;
+}
+
+template <typename T>
+void encodeArithmetic(RpcWriter & writer, const void * value)
+{
+	writer.write(*static_cast<const T *>(value));
+}
+
+bool decodeString(RpcReader & reader, void * slot)
+{
+	std::string * s = new (slot) std::string();
+	if(! reader.read(s)) {
+		s->~basic_string();
+		return false;
+	}
+	return true;
+}
+
+void destroyString(void * slot)
+{
+	static_cast<std::string *>(slot)->~basic_string();
+}
+
+void encodeString(RpcWriter & writer, const void * value)
+{
+	writer.write(*static_cast<const std::string *>(value));
+}
+
+void encodeCharPointer(RpcWriter & writer, const void * value)
+{
+	const char * s = *static_cast<const char * const *>(value);
+	writer.write(s == nullptr ? "" : s);
+}
+
+template <typename T>
+RpcCodec makeArithmeticCodec(const MetaType * metaType)
+{
+	return RpcCodec {
+		metaType,
+		(std::uint32_t)sizeof(T),
+		(std::uint32_t)alignof(T),
+		getMetaType<T>()->getTypeKind(),
+		&decodeArithmetic<T>,
+		nullptr,
+		&encodeArithmetic<T>
+	};
+}
+
+bool getArithmeticCodec(const MetaType * metaType, const TypeKind typeKind, RpcCodec * codec)
+{
+	switch(typeKind) {
+	case tkBool:
+		*codec = makeArithmeticCodec<bool>(metaType);
+		return true;
+
+	case tkChar:
+		*codec = makeArithmeticCodec<char>(metaType);
+		return true;
+
+	case tkWideChar:
+		*codec = makeArithmeticCodec<wchar_t>(metaType);
+		return true;
+
+	case tkChar16:
+		*codec = makeArithmeticCodec<char16_t>(metaType);
+		return true;
+
+	case tkChar32:
+		*codec = makeArithmeticCodec<char32_t>(metaType);
+		return true;
+
+	case tkSignedChar:
+		*codec = makeArithmeticCodec<signed char>(metaType);
+		return true;
+
+	case tkUnsignedChar:
+		*codec = makeArithmeticCodec<unsigned char>(metaType);
+		return true;
+
+	case tkShort:
+		*codec = makeArithmeticCodec<short>(metaType);
+		return true;
+
+	case tkUnsignedShort:
+		*codec = makeArithmeticCodec<unsigned short>(metaType);
+		return true;
+
+	case tkInt:
+		*codec = makeArithmeticCodec<int>(metaType);
+		return true;
+
+	case tkUnsignedInt:
+		*codec = makeArithmeticCodec<unsigned int>(metaType);
+		return true;
+
+	case tkLong:
+		*codec = makeArithmeticCodec<long>(metaType);
+		return true;
+
+	case tkUnsignedLong:
+		*codec = makeArithmeticCodec<unsigned long>(metaType);
+		return true;
+
+	case tkLongLong:
+		*codec = makeArithmeticCodec<long long>(metaType);
+		return true;
+
+	case tkUnsignedLongLong:
+		*codec = makeArithmeticCodec<unsigned long long>(metaType);
+		return true;
+
+	case tkFloat:
+		*codec = makeArithmeticCodec<float>(metaType);
+		return true;
+
+	case tkDouble:
+		*codec = makeArithmeticCodec<double>(metaType);
+		return true;
+
+	case tkLongDouble:
+		*codec = makeArithmeticCodec<long double>(metaType);
+		return true;
+
+	default:
+		break;
+	}
+	return false;
+}
+
+bool getCodec(const MetaType * metaType, const bool isResult, RpcCodec * codec)
+{
+	metaType = getNonReferenceMetaType(metaType);
+	if(isResult && metaType->isVoid()) {
+		*codec = RpcCodec { metaType, 0, 1, tkVoid, nullptr, nullptr, nullptr };
+		return true;
+	}
+	const MetaType * valueType = metaType;
+	if(valueType->getTypeKind() == tkEnum) {
+		valueType = valueType->getUpType();
+	}
+	if(getArithmeticCodec(metaType, valueType->getTypeKind(), codec)) {
+		return true;
+	}
+	if(metaType->getTypeKind() == tkStdString) {
+		*codec = RpcCodec {
+			metaType,
+			(std::uint32_t)sizeof(std::string),
+			(std::uint32_t)alignof(std::string),
+			tkStdString,
+			&decodeString,
+			&destroyString,
+			&encodeString
+		};
+		return true;
+	}
+	if(isResult && metaType->getTypeKind() == tkPointer && metaType->getUpType()->getTypeKind() == tkChar) {
+		// Encoded the same as std::string.
+		*codec = RpcCodec { metaType, 0, 1, tkStdString, nullptr, nullptr, &encodeCharPointer };
+		return true;
+	}
+	return false;
+}
+
+std::size_t alignUp(const std::size_t value, const std::size_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// FNV-1a
+class Fingerprint
+{
+public:
+	Fingerprint() : value(14695981039346656037ULL) {
+	}
+
+	void add(const void * data, const std::size_t size) {
+		const unsigned char * p = static_cast<const unsigned char *>(data);
+		for(std::size_t i = 0; i < size; ++i) {
+			value = (value ^ p[i]) * 1099511628211ULL;
+		}
+	}
+
+	void add(const std::uint64_t n) {
+		// Byte by byte so the result doesn't depend on the byte order.
+		for(int i = 0; i < 8; ++i) {
+			const unsigned char c = (unsigned char)(n >> (i * 8));
+			add(&c, 1);
+		}
+	}
+
+	std::uint64_t getValue() const {
+		return value;
+	}
+
+private:
+	std::uint64_t value;
+};
+
+constexpr std::uint64_t unsupportedTypeKind = 0xffffffffULL;
+
+struct RpcMethod
+{
+	std::string name;
+	Variant callable;
+	const MetaCallable * metaCallable;
+	bool supported;
+	std::vector<RpcCodec> parameterCodecList;
+	std::vector<std::size_t> slotOffsetList;
+	std::size_t frameSize;
+	RpcCodec resultCodec;
+};
+
+// Destroys the decoded arguments, also if the method throws.
+class RpcFrameGuard
+{
+public:
+	RpcFrameGuard(const RpcMethod & method, char * frame)
+		: method(method), frame(frame), decodedCount(0)
+	{
+	}
+
+	~RpcFrameGuard() {
+		for(std::size_t i = 0; i < decodedCount; ++i) {
+			const RpcCodec & codec = method.parameterCodecList[i];
+			if(codec.destroy != nullptr) {
+				codec.destroy(frame + method.slotOffsetList[i]);
+			}
+		}
+	}
+
+	RpcFrameGuard(const RpcFrameGuard &) = delete;
+	RpcFrameGuard & operator = (const RpcFrameGuard &) = delete;
+
+	void addDecoded() {
+		++decodedCount;
+	}
+
+private:
+	const RpcMethod & method;
+	char * frame;
+	std::size_t decodedCount;
+};
+
+} // namespace
+
+class RpcDispatcherImplement
+{
+public:
+	explicit RpcDispatcherImplement(const MetaRepo * metaRepo)
+		: methodList(), emptyInstance()
+	{
+		for(const MetaItem & item : metaRepo->getCallableView()) {
+			const Variant & callable = item.asCallable();
+			if(getNonReferenceMetaType(callable)->getTypeKind() == tkOverloadedFunction) {
+				for(const Variant & overload : callable.get<const OverloadedFunction &>().getCallableList()) {
+					addMethod(item.getName(), overload);
+				}
+			}
+			else {
+				addMethod(item.getName(), callable);
+			}
+		}
+		computeFingerprint();
+	}
+
+	std::size_t getMethodCount() const {
+		return methodList.size();
+	}
+
+	std::uint32_t findMethodId(const std::string & name, std::size_t overloadIndex) const {
+		for(std::size_t i = 0; i < methodList.size(); ++i) {
+			if(methodList[i].name == name) {
+				if(overloadIndex == 0) {
+					return (std::uint32_t)i;
+				}
+				--overloadIndex;
+			}
+		}
+		return invalidRpcMethodId;
+	}
+
+	const RpcMethod & getMethod(const std::uint32_t methodId) const {
+		if(methodId >= methodList.size()) {
+			raiseException<OutOfRangeException>("RpcDispatcher method ID is out of range");
+		}
+		return methodList[methodId];
+	}
+
+	std::uint64_t getFingerprint() const {
+		return fingerprint;
+	}
+
+	ErrorCode dispatch(const void * request, const std::size_t requestSize, std::vector<char> & response) const {
+		const std::size_t codePosition = response.size();
+		response.push_back((char)ErrorCode::ok);
+		const ErrorCode code = doDispatch(request, requestSize, response);
+		if(code != ErrorCode::ok) {
+			response.resize(codePosition + 1);
+			response[codePosition] = (char)code;
+		}
+		return code;
+	}
+
+private:
+	void addMethod(const std::string & name, const Variant & callable) {
+		methodList.emplace_back();
+		RpcMethod & method = methodList.back();
+		method.name = name;
+		method.callable = callable;
+		method.metaCallable = getNonReferenceMetaType(callable)->getMetaCallable();
+		method.supported = false;
+		method.frameSize = 0;
+		method.resultCodec = RpcCodec();
+
+		const MetaCallable::ParameterCountInfo countInfo = method.metaCallable->getParameterCountInfo(callable);
+		if(! method.metaCallable->isStatic(callable)
+			|| countInfo.getMinParameterCount() != countInfo.getMaxParameterCount()) {
+			return;
+		}
+		if(! getCodec(method.metaCallable->getReturnType(callable), true, &method.resultCodec)) {
+			return;
+		}
+		const int parameterCount = countInfo.getMaxParameterCount();
+		std::size_t frameSize = 0;
+		for(int i = 0; i < parameterCount; ++i) {
+			RpcCodec codec;
+			if(! getCodec(method.metaCallable->getParameterType(callable, i), false, &codec)) {
+				method.parameterCodecList.clear();
+				method.slotOffsetList.clear();
+				return;
+			}
+			frameSize = alignUp(frameSize, codec.alignment);
+			method.parameterCodecList.push_back(codec);
+			method.slotOffsetList.push_back(frameSize);
+			frameSize += codec.size;
+		}
+		method.frameSize = frameSize;
+		method.supported = true;
+	}
+
+	void computeFingerprint() {
+		Fingerprint hash;
+		for(const RpcMethod & method : methodList) {
+			hash.add(method.name.size());
+			hash.add(method.name.data(), method.name.size());
+			if(! method.supported) {
+				hash.add(unsupportedTypeKind);
+				continue;
+			}
+			hash.add((std::uint64_t)method.resultCodec.typeKind);
+			hash.add(method.parameterCodecList.size());
+			for(const RpcCodec & codec : method.parameterCodecList) {
+				hash.add((std::uint64_t)codec.typeKind);
+			}
+		}
+		fingerprint = hash.getValue();
+	}
+
+	ErrorCode doDispatch(const void * request, const std::size_t requestSize, std::vector<char> & response) const {
+		constexpr std::size_t fixedFrameSize = 256;
+		constexpr std::size_t fixedArgumentCount = 8;
+
+		RpcReader reader(request, requestSize);
+		std::uint32_t methodId;
+		if(! reader.read(&methodId)) {
+			return ErrorCode::illegalArgument;
+		}
+		if(methodId >= methodList.size()) {
+			return ErrorCode::outOfRange;
+		}
+		const RpcMethod & method = methodList[methodId];
+		if(! method.supported) {
+			return ErrorCode::unsupported;
+		}
+
+		// The slots and the argument views are on the stack for the common signatures.
+		typename std::aligned_storage<fixedFrameSize, alignof(std::max_align_t)>::type fixedFrame;
+		std::unique_ptr<char[]> dynamicFrame;
+		char * frame = reinterpret_cast<char *>(&fixedFrame);
+		if(method.frameSize > fixedFrameSize) {
+			dynamicFrame.reset(new char[method.frameSize]);
+			frame = dynamicFrame.get();
+		}
+		const std::size_t argumentCount = method.parameterCodecList.size();
+		VariantRef fixedArgumentList[fixedArgumentCount];
+		std::vector<VariantRef> dynamicArgumentList;
+		VariantRef * argumentList = fixedArgumentList;
+		if(argumentCount > fixedArgumentCount) {
+			dynamicArgumentList.resize(argumentCount);
+			argumentList = dynamicArgumentList.data();
+		}
+
+		RpcFrameGuard guard(method, frame);
+		for(std::size_t i = 0; i < argumentCount; ++i) {
+			const RpcCodec & codec = method.parameterCodecList[i];
+			void * slot = frame + method.slotOffsetList[i];
+			if(! codec.decode(reader, slot)) {
+				return ErrorCode::illegalArgument;
+			}
+			guard.addDecoded();
+			argumentList[i] = VariantRef(codec.metaType, slot);
+		}
+		if(reader.getRemainingSize() != 0) {
+			return ErrorCode::illegalArgument;
+		}
+
+		// The arguments match the parameter types exactly, invokeRef passes them without casting.
+		const Variant result = method.metaCallable->invokeRef(
+			method.callable,
+			emptyInstance,
+			ArgumentRefSpan(argumentList, argumentCount)
+		);
+		if(method.resultCodec.encode != nullptr) {
+			RpcWriter writer(response);
+			method.resultCodec.encode(writer, result.getAddress());
+		}
+		return ErrorCode::ok;
+	}
+
+private:
+	std::vector<RpcMethod> methodList;
+	Variant emptyInstance;
+	std::uint64_t fingerprint;
+};
+
+} // namespace internal_
+
+ErrorCode readRpcResponse(const void * response, const std::size_t size)
+{
+	RpcReader reader(response, size);
+	std::uint8_t code;
+	if(! reader.read(&code)) {
+		return ErrorCode::illegalArgument;
+	}
+	return (ErrorCode)code;
+}
+
+RpcDispatcher::RpcDispatcher(const MetaRepo * metaRepo)
+	: implement(new internal_::RpcDispatcherImplement(metaRepo))
+{
+}
+
+RpcDispatcher::~RpcDispatcher()
+{
+}
+
+std::size_t RpcDispatcher::getMethodCount() const
+{
+	return implement->getMethodCount();
+}
+
+std::uint32_t RpcDispatcher::findMethodId(const std::string & name, const std::size_t overloadIndex) const
+{
+	return implement->findMethodId(name, overloadIndex);
+}
+
+const std::string & RpcDispatcher::getMethodName(const std::uint32_t methodId) const
+{
+	return implement->getMethod(methodId).name;
+}
+
+const Variant & RpcDispatcher::getMethod(const std::uint32_t methodId) const
+{
+	return implement->getMethod(methodId).callable;
+}
+
+bool RpcDispatcher::isMethodSupported(const std::uint32_t methodId) const
+{
+	return implement->getMethod(methodId).supported;
+}
+
+std::uint64_t RpcDispatcher::getFingerprint() const
+{
+	return implement->getFingerprint();
+}
+
+ErrorCode RpcDispatcher::dispatch(const void * request, const std::size_t requestSize, std::vector<char> & response) const
+{
+	return implement->dispatch(request, requestSize, response);
+}
+
+
+} // namespace metapp
@@ -0,0 +1,1220 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/utilities/snapshot.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/interfaces/metaindexable.h"
+#include "metapp/interfaces/metaiterable.h"
+#include "metapp/interfaces/metamappable.h"
+#include "metapp/allmetatypes.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace metapp {
+
+namespace internal_ {
+
+namespace {
+
+constexpr char snapshotMagic[8] = { 'm', 'e', 't', 'a', 's', 'n', 'a', 'p' };
+constexpr std::uint32_t snapshotVersion = 1;
+constexpr std::uint32_t snapshotByteOrder = 0x01020304;
+
+enum class SnapshotKind : std::uint32_t
+{
+	arithmetic = 1,
+	string = 2,
+	array = 3,
+	object = 4
+};
+
+struct SnapshotHeader
+{
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byteOrder;
+	std::uint64_t imageSize;
+	std::uint64_t rootOffset;
+	std::uint64_t schemaTableOffset;
+	std::uint32_t schemaCount;
+	std::uint32_t rootSchemaIndex;
+	std::uint64_t reserved[3];
+};
+
+// A string or an array in a value slot. offset is relative to the slot.
+struct SnapshotReference
+{
+	std::int64_t offset;
+	std::uint64_t size;
+};
+
+struct SnapshotField
+{
+	// Relative to this field.
+	std::int64_t nameOffset;
+	std::int64_t schemaOffset;
+	std::uint32_t nameLength;
+	// The offset of the field in the object.
+	std::uint32_t offset;
+
+	const char * getName() const {
+		return reinterpret_cast<const char *>(this) + nameOffset;
+	}
+
+	const SnapshotSchemaData * getSchema() const {
+		return reinterpret_cast<const SnapshotSchemaData *>(reinterpret_cast<const char *>(this) + schemaOffset);
+	}
+};
+
+static_assert(sizeof(SnapshotHeader) == 72, "SnapshotHeader has wrong size");
+static_assert(sizeof(SnapshotReference) == 16, "SnapshotReference has wrong size");
+static_assert(sizeof(SnapshotField) == 24, "SnapshotField has wrong size");
+
+std::size_t alignUp(const std::size_t value, const std::size_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+bool isInRange(const char * image, const std::size_t imageSize, const char * p, const std::size_t size)
+{
+	return p >= image && (std::size_t)(p - image) <= imageSize && size <= imageSize - (std::size_t)(p - image);
+}
+
+std::size_t getImageSize(const char * image)
+{
+	return (std::size_t)reinterpret_cast<const SnapshotHeader *>(image)->imageSize;
+}
+
+// Returns p + offset if the size bytes from it are in the image, otherwise nullptr. p must be in the image.
+const char * getInImage(const char * image, const std::size_t imageSize, const char * p, const std::int64_t offset, const std::size_t size)
+{
+	const std::int64_t limit = (std::int64_t)imageSize;
+	if(offset < -limit || offset > limit) {
+		return nullptr;
+	}
+	const std::int64_t position = (std::int64_t)(p - image) + offset;
+	if(position < 0 || position > limit || size > (std::size_t)(limit - position)) {
+		return nullptr;
+	}
+	return image + position;
+}
+
+struct ArithmeticInfo
+{
+	std::uint32_t size;
+	std::uint32_t alignment;
+	const MetaType * metaType;
+	Variant (*makeReference)(const void * data);
+};
+
+template <typename T>
+Variant makeArithmeticReference(const void * data)
+{
+	return Variant::reference(*static_cast<const T *>(data));
+}
+
+template <typename T>
+ArithmeticInfo makeArithmeticInfo()
+{
+	return ArithmeticInfo {
+		(std::uint32_t)sizeof(T),
+		(std::uint32_t)alignof(T),
+		getMetaType<T>(),
+		&makeArithmeticReference<T>
+	};
+}
+
+bool getArithmeticInfo(const TypeKind typeKind, ArithmeticInfo * info)
+{
+	switch(typeKind) {
+	case tkBool:
+		*info = makeArithmeticInfo<bool>();
+		return true;
+
+	case tkChar:
+		*info = makeArithmeticInfo<char>();
+		return true;
+
+	case tkWideChar:
+		*info = makeArithmeticInfo<wchar_t>();
+		return true;
+
+	case tkChar16:
+		*info = makeArithmeticInfo<char16_t>();
+		return true;
+
+	case tkChar32:
+		*info = makeArithmeticInfo<char32_t>();
+		return true;
+
+	case tkSignedChar:
+		*info = makeArithmeticInfo<signed char>();
+		return true;
+
+	case tkUnsignedChar:
+		*info = makeArithmeticInfo<unsigned char>();
+		return true;
+
+	case tkShort:
+		*info = makeArithmeticInfo<short>();
+		return true;
+
+	case tkUnsignedShort:
+		*info = makeArithmeticInfo<unsigned short>();
+		return true;
+
+	case tkInt:
+		*info = makeArithmeticInfo<int>();
+		return true;
+
+	case tkUnsignedInt:
+		*info = makeArithmeticInfo<unsigned int>();
+		return true;
+
+	case tkLong:
+		*info = makeArithmeticInfo<long>();
+		return true;
+
+	case tkUnsignedLong:
+		*info = makeArithmeticInfo<unsigned long>();
+		return true;
+
+	case tkLongLong:
+		*info = makeArithmeticInfo<long long>();
+		return true;
+
+	case tkUnsignedLongLong:
+		*info = makeArithmeticInfo<unsigned long long>();
+		return true;
+
+	case tkFloat:
+		*info = makeArithmeticInfo<float>();
+		return true;
+
+	case tkDouble:
+		*info = makeArithmeticInfo<double>();
+		return true;
+
+	case tkLongDouble:
+		*info = makeArithmeticInfo<long double>();
+		return true;
+
+	default:
+		break;
+	}
+	return false;
+}
+
+bool isCharPointer(const MetaType * metaType)
+{
+	return metaType->getTypeKind() == tkPointer && metaType->getUpType()->getTypeKind() == tkChar;
+}
+
+// FNV-1a
+class Fingerprint
+{
+public:
+	Fingerprint() : value(14695981039346656037ULL) {
+	}
+
+	void add(const void * data, const std::size_t size) {
+		const unsigned char * p = static_cast<const unsigned char *>(data);
+		for(std::size_t i = 0; i < size; ++i) {
+			value = (value ^ p[i]) * 1099511628211ULL;
+		}
+	}
+
+	void add(const std::uint64_t n) {
+		// Byte by byte so the result doesn't depend on the byte order.
+		for(int i = 0; i < 8; ++i) {
+			const unsigned char c = (unsigned char)(n >> (i * 8));
+			add(&c, 1);
+		}
+	}
+
+	std::uint64_t getValue() const {
+		return value;
+	}
+
+private:
+	std::uint64_t value;
+};
+
+} // namespace
+
+// The schema in the image.
+struct SnapshotSchemaData
+{
+	std::uint64_t fingerprint;
+	std::uint32_t kind;
+	std::int32_t typeKind;
+	std::uint32_t size;
+	std::uint32_t alignment;
+	// Relative to this schema.
+	std::int64_t elementSchemaOffset;
+	// Relative to this schema.
+	std::int64_t fieldTableOffset;
+	std::uint32_t fieldCount;
+	std::uint32_t reserved;
+
+	SnapshotKind getKind() const {
+		return static_cast<SnapshotKind>(kind);
+	}
+
+	const SnapshotSchemaData * getElementSchema() const {
+		return reinterpret_cast<const SnapshotSchemaData *>(reinterpret_cast<const char *>(this) + elementSchemaOffset);
+	}
+
+	const SnapshotField * getField(const std::size_t index) const {
+		return reinterpret_cast<const SnapshotField *>(reinterpret_cast<const char *>(this) + fieldTableOffset) + index;
+	}
+
+	// data is in the image, verifyImage checked the schemas, and the references are checked here,
+	// so a corrupt image raises IllegalArgumentException instead of reading out of the image.
+	static Variant makeValue(const char * image, const char * data, const SnapshotSchemaData * schema)
+	{
+		switch(schema->getKind()) {
+		case SnapshotKind::arithmetic: {
+			ArithmeticInfo info;
+			getArithmeticInfo(schema->typeKind, &info);
+			return info.makeReference(data);
+		}
+
+		case SnapshotKind::string: {
+			const SnapshotReference * reference = reinterpret_cast<const SnapshotReference *>(data);
+			const std::size_t imageSize = getImageSize(image);
+			// The string is followed by the null terminator.
+			const char * text = (reference->size < imageSize
+				? getInImage(image, imageSize, data, reference->offset, (std::size_t)reference->size + 1)
+				: nullptr
+			);
+			if(text == nullptr || text[reference->size] != 0) {
+				raiseException<IllegalArgumentException>("Snapshot string is out of the image");
+				return Variant();
+			}
+			return Variant(text);
+		}
+
+		case SnapshotKind::array: {
+			const SnapshotReference * reference = reinterpret_cast<const SnapshotReference *>(data);
+			const std::size_t imageSize = getImageSize(image);
+			const SnapshotSchemaData * elementSchema = schema->getElementSchema();
+			const std::size_t stride = elementSchema->size;
+			const char * elementData = ((stride == 0 ? reference->size <= imageSize : reference->size <= imageSize / stride)
+				? getInImage(image, imageSize, data, reference->offset, (std::size_t)reference->size * stride)
+				: nullptr
+			);
+			if(elementData == nullptr || (std::size_t)(elementData - image) % elementSchema->alignment != 0) {
+				raiseException<IllegalArgumentException>("Snapshot array is out of the image");
+				return Variant();
+			}
+			return SnapshotArray(image, elementData, (std::size_t)reference->size, elementSchema);
+		}
+
+		case SnapshotKind::object:
+			return SnapshotObject(image, data, schema);
+		}
+		return Variant();
+	}
+
+	static const MetaType * getValueMetaType(const SnapshotSchemaData * schema)
+	{
+		switch(schema->getKind()) {
+		case SnapshotKind::arithmetic: {
+			ArithmeticInfo info;
+			getArithmeticInfo(schema->typeKind, &info);
+			return info.metaType;
+		}
+
+		case SnapshotKind::string:
+			return getMetaType<const char *>();
+
+		case SnapshotKind::array:
+			return getMetaType<SnapshotArray>();
+
+		case SnapshotKind::object:
+			return getMetaType<SnapshotObject>();
+		}
+		return getMetaType<void>();
+	}
+};
+
+static_assert(sizeof(SnapshotSchemaData) == 48, "SnapshotSchemaData has wrong size");
+
+namespace {
+
+struct WriterField
+{
+	std::string name;
+	Variant accessible;
+	std::uint32_t schemaIndex;
+	std::uint32_t offset;
+};
+
+struct WriterSchema
+{
+	const MetaType * metaType;
+	SnapshotKind kind;
+	TypeKind typeKind;
+	std::uint32_t size;
+	std::uint32_t alignment;
+	std::uint32_t elementSchemaIndex;
+	std::vector<WriterField> fieldList;
+	std::uint64_t fingerprint;
+};
+
+// Builds the schemas from the meta types, the schemas don't depend on the values.
+class SchemaBuilder
+{
+private:
+	enum class State
+	{
+		none,
+		building,
+		done
+	};
+
+public:
+	std::uint32_t getSchemaIndex(const MetaType * metaType)
+	{
+		metaType = getNonReferenceMetaType(metaType);
+		for(std::size_t i = 0; i < schemaList.size(); ++i) {
+			if(schemaList[i].metaType->equal(metaType)) {
+				return (std::uint32_t)i;
+			}
+		}
+
+		const std::uint32_t index = (std::uint32_t)schemaList.size();
+		schemaList.push_back(WriterSchema());
+		WriterSchema & schema = schemaList.back();
+		schema.metaType = metaType;
+		schema.typeKind = tkVoid;
+		schema.size = 0;
+		schema.alignment = 1;
+		schema.elementSchemaIndex = 0;
+		schema.fingerprint = 0;
+
+		const MetaType * valueType = metaType;
+		if(valueType->getTypeKind() == tkEnum) {
+			valueType = valueType->getUpType();
+		}
+		ArithmeticInfo arithmeticInfo;
+		if(getArithmeticInfo(valueType->getTypeKind(), &arithmeticInfo)) {
+			schema.kind = SnapshotKind::arithmetic;
+			schema.typeKind = valueType->getTypeKind();
+			schema.size = arithmeticInfo.size;
+			schema.alignment = arithmeticInfo.alignment;
+		}
+		else if(metaType->getTypeKind() == tkStdString || isCharPointer(metaType)) {
+			schema.kind = SnapshotKind::string;
+			schema.size = sizeof(SnapshotReference);
+			schema.alignment = alignof(SnapshotReference);
+		}
+		else if(metaType->getMetaClass() != nullptr) {
+			schema.kind = SnapshotKind::object;
+			doBuildObject(index);
+		}
+		else if((metaType->getMetaIndexable() != nullptr || metaType->getMetaIterable() != nullptr)
+			&& metaType->getUpTypeCount() == 1) {
+			schema.kind = SnapshotKind::array;
+			schema.size = sizeof(SnapshotReference);
+			schema.alignment = alignof(SnapshotReference);
+			// schema may be invalidated by the recursive call.
+			const std::uint32_t elementSchemaIndex = getSchemaIndex(metaType->getUpType());
+			schemaList[index].elementSchemaIndex = elementSchemaIndex;
+		}
+		else {
+			schemaList.pop_back();
+			raiseException<UnsupportedException>("Snapshot doesn't support the type");
+			return 0;
+		}
+		return index;
+	}
+
+	const WriterSchema & getSchema(const std::uint32_t index) const {
+		return schemaList[index];
+	}
+
+	const std::vector<WriterSchema> & getSchemaList() const {
+		return schemaList;
+	}
+
+	void computeFingerprints()
+	{
+		std::vector<State> stateList(schemaList.size(), State::none);
+		for(std::uint32_t i = 0; i < (std::uint32_t)schemaList.size(); ++i) {
+			doComputeFingerprint(i, stateList);
+		}
+	}
+
+private:
+	void doBuildObject(const std::uint32_t index)
+	{
+		const MetaClass * metaClass = schemaList[index].metaType->getMetaClass();
+		std::vector<WriterField> fieldList;
+		for(const MetaItem & item : metaClass->getAccessibleView()) {
+			const Variant & accessible = item.asAccessible();
+			if(accessibleIsStatic(accessible)) {
+				continue;
+			}
+			WriterField field;
+			field.name = item.getName();
+			field.accessible = accessible;
+			field.schemaIndex = getSchemaIndex(accessibleGetValueType(accessible));
+			field.offset = 0;
+			fieldList.push_back(field);
+		}
+
+		std::uint32_t offset = 0;
+		std::uint32_t alignment = 1;
+		for(WriterField & field : fieldList) {
+			const WriterSchema & fieldSchema = schemaList[field.schemaIndex];
+			offset = (std::uint32_t)alignUp(offset, fieldSchema.alignment);
+			field.offset = offset;
+			offset += fieldSchema.size;
+			alignment = std::max(alignment, fieldSchema.alignment);
+		}
+		WriterSchema & schema = schemaList[index];
+		schema.fieldList.swap(fieldList);
+		schema.alignment = alignment;
+		schema.size = (std::uint32_t)alignUp(offset, alignment);
+	}
+
+	std::uint64_t doComputeFingerprint(const std::uint32_t index, std::vector<State> & stateList)
+	{
+		if(stateList[index] == State::done) {
+			return schemaList[index].fingerprint;
+		}
+		Fingerprint fingerprint;
+		if(stateList[index] == State::building) {
+			// A container of the object in the object.
+			fingerprint.add(0xffffffffULL);
+			return fingerprint.getValue();
+		}
+		stateList[index] = State::building;
+		const WriterSchema & schema = schemaList[index];
+		fingerprint.add((std::uint64_t)schema.kind);
+		fingerprint.add((std::uint64_t)schema.typeKind);
+		fingerprint.add(schema.size);
+		if(schema.kind == SnapshotKind::array) {
+			fingerprint.add(doComputeFingerprint(schema.elementSchemaIndex, stateList));
+		}
+		for(const WriterField & field : schema.fieldList) {
+			fingerprint.add(field.name.size());
+			fingerprint.add(field.name.data(), field.name.size());
+			fingerprint.add(field.offset);
+			fingerprint.add(doComputeFingerprint(field.schemaIndex, stateList));
+		}
+		schemaList[index].fingerprint = fingerprint.getValue();
+		stateList[index] = State::done;
+		return schemaList[index].fingerprint;
+	}
+
+private:
+	std::vector<WriterSchema> schemaList;
+};
+
+class ImageWriter
+{
+public:
+	std::vector<char> write(const Variant & root)
+	{
+		Variant value = root;
+		const MetaType * metaType = getNonReferenceMetaType(value);
+		if(metaType->isPointer() && ! isCharPointer(metaType)) {
+			if(getPointer(value) == nullptr) {
+				raiseException<IllegalArgumentException>("Snapshot root is nullptr");
+				return buffer;
+			}
+			value = depointer(value);
+		}
+		const std::uint32_t rootSchemaIndex = schemaBuilder.getSchemaIndex(value.getMetaType());
+		schemaBuilder.computeFingerprints();
+
+		allocate(sizeof(SnapshotHeader), 8);
+		const WriterSchema & rootSchema = schemaBuilder.getSchema(rootSchemaIndex);
+		const std::size_t rootOffset = allocate(rootSchema.size, rootSchema.alignment);
+		doWriteValue(value, rootSchemaIndex, rootOffset);
+
+		const std::size_t schemaTableOffset = doWriteSchemaTable();
+
+		SnapshotHeader header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, snapshotMagic, sizeof(header.magic));
+		header.version = snapshotVersion;
+		header.byteOrder = snapshotByteOrder;
+		header.imageSize = buffer.size();
+		header.rootOffset = rootOffset;
+		header.schemaTableOffset = schemaTableOffset;
+		header.schemaCount = (std::uint32_t)schemaBuilder.getSchemaList().size();
+		header.rootSchemaIndex = rootSchemaIndex;
+		std::memcpy(buffer.data(), &header, sizeof(header));
+
+		return std::move(buffer);
+	}
+
+private:
+	std::size_t allocate(const std::size_t size, const std::size_t alignment)
+	{
+		const std::size_t position = alignUp(buffer.size(), alignment);
+		buffer.resize(position + size, 0);
+		return position;
+	}
+
+	void writeReference(const std::size_t position, const std::size_t target, const std::size_t size)
+	{
+		SnapshotReference reference;
+		reference.offset = (std::int64_t)target - (std::int64_t)position;
+		reference.size = size;
+		std::memcpy(buffer.data() + position, &reference, sizeof(reference));
+	}
+
+	void doWriteValue(const Variant & value, const std::uint32_t schemaIndex, const std::size_t position)
+	{
+		const WriterSchema & schema = schemaBuilder.getSchema(schemaIndex);
+		switch(schema.kind) {
+		case SnapshotKind::arithmetic:
+			std::memcpy(buffer.data() + position, value.getAddress(), schema.size);
+			break;
+
+		case SnapshotKind::string:
+			doWriteString(value, position);
+			break;
+
+		case SnapshotKind::array:
+			doWriteArray(value, schema, position);
+			break;
+
+		case SnapshotKind::object:
+			for(const WriterField & field : schema.fieldList) {
+				doWriteValue(accessibleGet(field.accessible, value), field.schemaIndex, position + field.offset);
+			}
+			break;
+		}
+	}
+
+	void doWriteString(const Variant & value, const std::size_t position)
+	{
+		const char * text = "";
+		std::size_t length = 0;
+		if(getNonReferenceMetaType(value)->getTypeKind() == tkStdString) {
+			const std::string & s = value.get<const std::string &>();
+			text = s.c_str();
+			length = s.size();
+		}
+		else {
+			const char * p = value.get<const char *>();
+			if(p != nullptr) {
+				text = p;
+				length = std::strlen(p);
+			}
+		}
+		// text may point into buffer if value is a reference to another snapshot, copy it before resizing.
+		const std::string copy(text, length);
+		const std::size_t target = allocate(length + 1, 1);
+		std::memcpy(buffer.data() + target, copy.data(), length);
+		writeReference(position, target, length);
+	}
+
+	void doWriteArray(const Variant & value, const WriterSchema & schema, const std::size_t position)
+	{
+		const std::uint32_t elementSchemaIndex = schema.elementSchemaIndex;
+		const WriterSchema & elementSchema = schemaBuilder.getSchema(elementSchemaIndex);
+		const std::size_t stride = elementSchema.size;
+		const MetaType * metaType = getNonReferenceMetaType(value);
+		const MetaIndexable * metaIndexable = metaType->getMetaIndexable();
+		if(metaIndexable != nullptr) {
+			const std::size_t size = metaIndexable->getSizeInfo(value).getSize();
+			const std::size_t target = allocate(stride * size, elementSchema.alignment);
+			writeReference(position, target, size);
+			const void * data = metaIndexable->getData(value);
+			if(elementSchema.kind == SnapshotKind::arithmetic && data != nullptr && size > 0) {
+				std::memcpy(buffer.data() + target, data, stride * size);
+				return;
+			}
+			for(std::size_t i = 0; i < size; ++i) {
+				doWriteValue(metaIndexable->get(value, i), elementSchemaIndex, target + i * stride);
+			}
+		}
+		else {
+			std::vector<Variant> elementList;
+			metaType->getMetaIterable()->forEach(value, [&elementList](const Variant & element) -> bool {
+				elementList.push_back(element);
+				return true;
+			});
+			const std::size_t target = allocate(stride * elementList.size(), elementSchema.alignment);
+			writeReference(position, target, elementList.size());
+			for(std::size_t i = 0; i < elementList.size(); ++i) {
+				doWriteValue(elementList[i], elementSchemaIndex, target + i * stride);
+			}
+		}
+	}
+
+	std::size_t doWriteSchemaTable()
+	{
+		const std::vector<WriterSchema> & schemaList = schemaBuilder.getSchemaList();
+		const std::size_t schemaTableOffset = allocate(sizeof(SnapshotSchemaData) * schemaList.size(), 8);
+		auto getSchemaOffset = [schemaTableOffset](const std::uint32_t index) -> std::size_t {
+			return schemaTableOffset + index * sizeof(SnapshotSchemaData);
+		};
+		for(std::uint32_t i = 0; i < (std::uint32_t)schemaList.size(); ++i) {
+			const WriterSchema & schema = schemaList[i];
+			const std::size_t schemaOffset = getSchemaOffset(i);
+			const std::size_t fieldTableOffset = allocate(sizeof(SnapshotField) * schema.fieldList.size(), 8);
+
+			SnapshotSchemaData data;
+			std::memset(&data, 0, sizeof(data));
+			data.fingerprint = schema.fingerprint;
+			data.kind = (std::uint32_t)schema.kind;
+			data.typeKind = schema.typeKind;
+			data.size = schema.size;
+			data.alignment = schema.alignment;
+			data.elementSchemaOffset = (schema.kind == SnapshotKind::array
+				? (std::int64_t)getSchemaOffset(schema.elementSchemaIndex) - (std::int64_t)schemaOffset : 0);
+			data.fieldTableOffset = (std::int64_t)fieldTableOffset - (std::int64_t)schemaOffset;
+			data.fieldCount = (std::uint32_t)schema.fieldList.size();
+			std::memcpy(buffer.data() + schemaOffset, &data, sizeof(data));
+
+			for(std::size_t k = 0; k < schema.fieldList.size(); ++k) {
+				const WriterField & field = schema.fieldList[k];
+				const std::size_t fieldOffset = fieldTableOffset + k * sizeof(SnapshotField);
+				const std::size_t nameOffset = allocate(field.name.size() + 1, 1);
+				std::memcpy(buffer.data() + nameOffset, field.name.data(), field.name.size());
+				SnapshotField snapshotField;
+				snapshotField.nameOffset = (std::int64_t)nameOffset - (std::int64_t)fieldOffset;
+				snapshotField.schemaOffset = (std::int64_t)getSchemaOffset(field.schemaIndex) - (std::int64_t)fieldOffset;
+				snapshotField.nameLength = (std::uint32_t)field.name.size();
+				snapshotField.offset = field.offset;
+				std::memcpy(buffer.data() + fieldOffset, &snapshotField, sizeof(snapshotField));
+			}
+		}
+		allocate(0, 8);
+		return schemaTableOffset;
+	}
+
+private:
+	SchemaBuilder schemaBuilder;
+	std::vector<char> buffer;
+};
+
+} // namespace
+
+class SnapshotMapping
+{
+public:
+	explicit SnapshotMapping(const std::string & fileName)
+		: data(nullptr), size(0)
+#if defined(_WIN32)
+			, fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#endif
+	{
+#if defined(_WIN32)
+		fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if(fileHandle == INVALID_HANDLE_VALUE) {
+			return;
+		}
+		LARGE_INTEGER fileSize;
+		if(! GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+			return;
+		}
+		mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(mappingHandle == nullptr) {
+			return;
+		}
+		data = static_cast<const char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if(data != nullptr) {
+			size = (std::size_t)fileSize.QuadPart;
+		}
+#else
+		const int fd = open(fileName.c_str(), O_RDONLY);
+		if(fd < 0) {
+			return;
+		}
+		struct stat fileStat;
+		if(fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+			void * address = mmap(nullptr, (std::size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			if(address != MAP_FAILED) {
+				data = static_cast<const char *>(address);
+				size = (std::size_t)fileStat.st_size;
+			}
+		}
+		close(fd);
+#endif
+	}
+
+	~SnapshotMapping()
+	{
+#if defined(_WIN32)
+		if(data != nullptr) {
+			UnmapViewOfFile(data);
+		}
+		if(mappingHandle != nullptr) {
+			CloseHandle(mappingHandle);
+		}
+		if(fileHandle != INVALID_HANDLE_VALUE) {
+			CloseHandle(fileHandle);
+		}
+#else
+		if(data != nullptr) {
+			munmap(const_cast<char *>(data), size);
+		}
+#endif
+	}
+
+	SnapshotMapping(const SnapshotMapping &) = delete;
+	SnapshotMapping & operator = (const SnapshotMapping &) = delete;
+
+	const char * getData() const {
+		return data;
+	}
+
+	std::size_t getSize() const {
+		return size;
+	}
+
+private:
+	const char * data;
+	std::size_t size;
+#if defined(_WIN32)
+	HANDLE fileHandle;
+	HANDLE mappingHandle;
+#endif
+};
+
+namespace {
+
+// Checks the header and the schemas. The references to strings and arrays are checked when they are read by makeValue,
+// checking them here requires reading the whole image.
+bool verifyImage(const char * image, const std::size_t mappedSize)
+{
+	if(image == nullptr || (reinterpret_cast<std::uintptr_t>(image) % 8) != 0 || mappedSize < sizeof(SnapshotHeader)) {
+		return false;
+	}
+	const SnapshotHeader * header = reinterpret_cast<const SnapshotHeader *>(image);
+	if(std::memcmp(header->magic, snapshotMagic, sizeof(snapshotMagic)) != 0
+		|| header->version != snapshotVersion
+		|| header->byteOrder != snapshotByteOrder
+		|| header->imageSize > mappedSize
+		|| header->imageSize < sizeof(SnapshotHeader)
+	) {
+		return false;
+	}
+	// The values are read within imageSize, see makeValue.
+	const std::size_t imageSize = (std::size_t)header->imageSize;
+	if(header->rootSchemaIndex >= header->schemaCount
+		|| header->schemaTableOffset % 8 != 0
+		|| header->schemaTableOffset > imageSize
+		|| header->schemaCount > imageSize / sizeof(SnapshotSchemaData)
+		|| ! isInRange(image, imageSize, image + header->schemaTableOffset, header->schemaCount * sizeof(SnapshotSchemaData))
+	) {
+		return false;
+	}
+	const char * schemaTable = image + header->schemaTableOffset;
+	const char * schemaTableEnd = schemaTable + header->schemaCount * sizeof(SnapshotSchemaData);
+	// p is the result of getInImage, it's nullptr if the offset is out of the image.
+	auto isSchema = [schemaTable, schemaTableEnd](const char * p) {
+		return p != nullptr && p >= schemaTable && p < schemaTableEnd && (std::size_t)(p - schemaTable) % sizeof(SnapshotSchemaData) == 0;
+	};
+	// The alignments are checked first, the fields are checked against the alignments of their schemas.
+	for(std::uint32_t i = 0; i < header->schemaCount; ++i) {
+		const SnapshotSchemaData * schema = reinterpret_cast<const SnapshotSchemaData *>(schemaTable) + i;
+		if(schema->alignment == 0 || schema->alignment > 8 || (schema->alignment & (schema->alignment - 1)) != 0) {
+			return false;
+		}
+	}
+	for(std::uint32_t i = 0; i < header->schemaCount; ++i) {
+		const SnapshotSchemaData * schema = reinterpret_cast<const SnapshotSchemaData *>(schemaTable) + i;
+		const char * schemaData = reinterpret_cast<const char *>(schema);
+		ArithmeticInfo info;
+		switch(schema->getKind()) {
+		case SnapshotKind::arithmetic:
+			if(! getArithmeticInfo(schema->typeKind, &info) || info.size != schema->size) {
+				return false;
+			}
+			break;
+
+		case SnapshotKind::string:
+			if(schema->size != sizeof(SnapshotReference) || schema->alignment != alignof(SnapshotReference)) {
+				return false;
+			}
+			break;
+
+		case SnapshotKind::array:
+			if(schema->size != sizeof(SnapshotReference) || schema->alignment != alignof(SnapshotReference)
+				|| ! isSchema(getInImage(image, imageSize, schemaData, schema->elementSchemaOffset, sizeof(SnapshotSchemaData)))) {
+				return false;
+			}
+			break;
+
+		case SnapshotKind::object: {
+			const char * fieldTable = getInImage(image, imageSize, schemaData, schema->fieldTableOffset, (std::size_t)schema->fieldCount * sizeof(SnapshotField));
+			if(fieldTable == nullptr || (std::size_t)(fieldTable - image) % 8 != 0) {
+				return false;
+			}
+			for(std::uint32_t k = 0; k < schema->fieldCount; ++k) {
+				const SnapshotField * field = schema->getField(k);
+				const char * fieldData = reinterpret_cast<const char *>(field);
+				if(! isSchema(getInImage(image, imageSize, fieldData, field->schemaOffset, sizeof(SnapshotSchemaData)))
+					|| getInImage(image, imageSize, fieldData, field->nameOffset, (std::size_t)field->nameLength + 1) == nullptr
+					|| (std::uint64_t)field->offset + field->getSchema()->size > schema->size
+					|| field->offset % field->getSchema()->alignment != 0
+				) {
+					return false;
+				}
+			}
+			break;
+		}
+
+		default:
+			return false;
+		}
+	}
+	const SnapshotSchemaData * rootSchema = reinterpret_cast<const SnapshotSchemaData *>(schemaTable) + header->rootSchemaIndex;
+	return header->rootOffset % rootSchema->alignment == 0
+		&& header->rootOffset <= imageSize
+		&& isInRange(image, imageSize, image + header->rootOffset, rootSchema->size);
+}
+
+} // namespace
+
+} // namespace internal_
+
+std::vector<char> createSnapshot(const Variant & root)
+{
+	return internal_::ImageWriter().write(root);
+}
+
+void writeSnapshotFile(const std::string & fileName, const Variant & root)
+{
+	const std::vector<char> image = createSnapshot(root);
+	std::ofstream stream(fileName, std::ios::binary | std::ios::trunc);
+	if(stream) {
+		stream.write(image.data(), (std::streamsize)image.size());
+	}
+	if(! stream) {
+		raiseException<IllegalArgumentException>("Can't write the snapshot file " + fileName);
+		return;
+	}
+}
+
+std::uint64_t getSnapshotFingerprint(const MetaType * metaType)
+{
+	internal_::SchemaBuilder schemaBuilder;
+	const std::uint32_t index = schemaBuilder.getSchemaIndex(metaType);
+	schemaBuilder.computeFingerprints();
+	return schemaBuilder.getSchema(index).fingerprint;
+}
+
+SnapshotArray::SnapshotArray()
+	: image(nullptr), data(nullptr), size(0), elementSchema(nullptr)
+{
+}
+
+SnapshotArray::SnapshotArray(const char * image, const char * data, const std::size_t size, const internal_::SnapshotSchemaData * elementSchema)
+	: image(image), data(data), size(size), elementSchema(elementSchema)
+{
+}
+
+std::size_t SnapshotArray::getSize() const
+{
+	return size;
+}
+
+Variant SnapshotArray::get(const std::size_t index) const
+{
+	if(index >= size) {
+		raiseException<OutOfRangeException>();
+		return Variant();
+	}
+	return internal_::SnapshotSchemaData::makeValue(image, data + index * elementSchema->size, elementSchema);
+}
+
+const void * SnapshotArray::getData() const
+{
+	return getElementMetaType() != nullptr ? data : nullptr;
+}
+
+const MetaType * SnapshotArray::getElementMetaType() const
+{
+	if(elementSchema == nullptr || elementSchema->getKind() != internal_::SnapshotKind::arithmetic) {
+		return nullptr;
+	}
+	return internal_::SnapshotSchemaData::getValueMetaType(elementSchema);
+}
+
+SnapshotObject::SnapshotObject()
+	: image(nullptr), data(nullptr), schema(nullptr)
+{
+}
+
+SnapshotObject::SnapshotObject(const char * image, const char * data, const internal_::SnapshotSchemaData * schema)
+	: image(image), data(data), schema(schema)
+{
+}
+
+std::size_t SnapshotObject::getFieldCount() const
+{
+	return schema == nullptr ? 0 : schema->fieldCount;
+}
+
+std::string SnapshotObject::getFieldName(const std::size_t index) const
+{
+	if(index >= getFieldCount()) {
+		raiseException<OutOfRangeException>();
+		return std::string();
+	}
+	const internal_::SnapshotField * field = schema->getField(index);
+	return std::string(field->getName(), field->nameLength);
+}
+
+bool SnapshotObject::hasField(const std::string & name) const
+{
+	return ! get(name).isEmpty();
+}
+
+Variant SnapshotObject::get(const std::string & name) const
+{
+	const std::size_t count = getFieldCount();
+	for(std::size_t i = 0; i < count; ++i) {
+		const internal_::SnapshotField * field = schema->getField(i);
+		if(field->nameLength == name.size() && std::memcmp(field->getName(), name.data(), name.size()) == 0) {
+			return get(i);
+		}
+	}
+	return Variant();
+}
+
+Variant SnapshotObject::get(const std::size_t index) const
+{
+	if(index >= getFieldCount()) {
+		raiseException<OutOfRangeException>();
+		return Variant();
+	}
+	const internal_::SnapshotField * field = schema->getField(index);
+	return internal_::SnapshotSchemaData::makeValue(image, data + field->offset, field->getSchema());
+}
+
+Snapshot Snapshot::fromFile(const std::string & fileName)
+{
+	Snapshot snapshot;
+	std::unique_ptr<internal_::SnapshotMapping> mapping(new internal_::SnapshotMapping(fileName));
+	if(! internal_::verifyImage(mapping->getData(), mapping->getSize())) {
+		raiseException<IllegalArgumentException>("Can't map the snapshot file " + fileName);
+		return snapshot;
+	}
+	snapshot.image = mapping->getData();
+	snapshot.imageSize = mapping->getSize();
+	snapshot.mapping = std::move(mapping);
+	return snapshot;
+}
+
+Snapshot Snapshot::fromMemory(const void * data, const std::size_t size)
+{
+	Snapshot snapshot;
+	if(! internal_::verifyImage(static_cast<const char *>(data), size)) {
+		raiseException<IllegalArgumentException>("Invalid snapshot image");
+		return snapshot;
+	}
+	snapshot.image = static_cast<const char *>(data);
+	snapshot.imageSize = size;
+	return snapshot;
+}
+
+Snapshot::Snapshot()
+	: mapping(), image(nullptr), imageSize(0)
+{
+}
+
+Snapshot::~Snapshot()
+{
+}
+
+Snapshot::Snapshot(Snapshot && other) noexcept
+	: mapping(std::move(other.mapping)), image(other.image), imageSize(other.imageSize)
+{
+	other.image = nullptr;
+	other.imageSize = 0;
+}
+
+Snapshot & Snapshot::operator = (Snapshot && other) noexcept
+{
+	if(this != &other) {
+		mapping = std::move(other.mapping);
+		image = other.image;
+		imageSize = other.imageSize;
+		other.image = nullptr;
+		other.imageSize = 0;
+	}
+	return *this;
+}
+
+bool Snapshot::isValid() const
+{
+	return image != nullptr;
+}
+
+Variant Snapshot::getRoot() const
+{
+	if(! isValid()) {
+		return Variant();
+	}
+	const internal_::SnapshotHeader * header = reinterpret_cast<const internal_::SnapshotHeader *>(image);
+	return internal_::SnapshotSchemaData::makeValue(
+		image,
+		image + header->rootOffset,
+		reinterpret_cast<const internal_::SnapshotSchemaData *>(image + header->schemaTableOffset) + header->rootSchemaIndex
+	);
+}
+
+std::size_t Snapshot::getSchemaCount() const
+{
+	if(! isValid()) {
+		return 0;
+	}
+	return reinterpret_cast<const internal_::SnapshotHeader *>(image)->schemaCount;
+}
+
+std::uint64_t Snapshot::getSchemaFingerprint(const std::size_t index) const
+{
+	if(index >= getSchemaCount()) {
+		raiseException<OutOfRangeException>();
+		return 0;
+	}
+	const internal_::SnapshotHeader * header = reinterpret_cast<const internal_::SnapshotHeader *>(image);
+	return (reinterpret_cast<const internal_::SnapshotSchemaData *>(image + header->schemaTableOffset) + index)->fingerprint;
+}
+
+std::uint64_t Snapshot::getRootFingerprint() const
+{
+	if(! isValid()) {
+		return 0;
+	}
+	return getSchemaFingerprint(reinterpret_cast<const internal_::SnapshotHeader *>(image)->rootSchemaIndex);
+}
+
+namespace internal_ {
+
+namespace {
+
+MetaIndexable::SizeInfo snapshotArrayGetSizeInfo(const Variant & indexable)
+{
+	MetaIndexable::SizeInfo sizeInfo(indexable.get<const SnapshotArray &>().getSize());
+	sizeInfo.setResizable(false);
+	return sizeInfo;
+}
+
+const MetaType * snapshotArrayGetValueType(const Variant & indexable, const std::size_t /*index*/)
+{
+	const SnapshotArray & array = indexable.get<const SnapshotArray &>();
+	const MetaType * metaType = array.getElementMetaType();
+	if(metaType == nullptr) {
+		// The elements are strings, objects, or arrays, get the type from an element.
+		metaType = (array.getSize() > 0 ? array.get(0).getMetaType() : getMetaType<void>());
+	}
+	return metaType;
+}
+
+Variant snapshotArrayGet(const Variant & indexable, const std::size_t index)
+{
+	return indexable.get<const SnapshotArray &>().get(index);
+}
+
+void snapshotArraySet(const Variant & /*indexable*/, const std::size_t /*index*/, const Variant & /*value*/)
+{
+	raiseException<UnwritableException>("Snapshot is read only");
+}
+
+void * snapshotArrayGetData(const Variant & indexable)
+{
+	return const_cast<void *>(indexable.get<const SnapshotArray &>().getData());
+}
+
+const MetaType * snapshotObjectGetValueType(const Variant & /*mappable*/)
+{
+	// The fields have different types.
+	return getMetaType<void>();
+}
+
+Variant snapshotObjectGet(const Variant & mappable, const Variant & key)
+{
+	return mappable.get<const SnapshotObject &>().get(key.cast<std::string>().get<const std::string &>());
+}
+
+void snapshotObjectSet(const Variant & /*mappable*/, const Variant & /*key*/, const Variant & /*value*/)
+{
+	raiseException<UnwritableException>("Snapshot is read only");
+}
+
+void snapshotObjectForEach(const Variant & mappable, const MetaMappable::Callback & callback)
+{
+	const SnapshotObject & object = mappable.get<const SnapshotObject &>();
+	const std::size_t count = object.getFieldCount();
+	for(std::size_t i = 0; i < count; ++i) {
+		if(! callback(object.getFieldName(i), object.get(i))) {
+			break;
+		}
+	}
+}
+
+} // namespace
+
+} // namespace internal_
+
+const MetaIndexable * DeclareMetaType<SnapshotArray>::getMetaIndexable()
+{
+	static const MetaIndexable metaIndexable(
+		&internal_::snapshotArrayGetSizeInfo,
+		&internal_::snapshotArrayGetValueType,
+		nullptr,
+		&internal_::snapshotArrayGet,
+		&internal_::snapshotArraySet,
+		&internal_::snapshotArrayGetData
+	);
+	return &metaIndexable;
+}
+
+const MetaMappable * DeclareMetaType<SnapshotObject>::getMetaMappable()
+{
+	static const MetaMappable metaMappable(
+		&internal_::snapshotObjectGetValueType,
+		&internal_::snapshotObjectGet,
+		&internal_::snapshotObjectSet,
+		&internal_::snapshotObjectForEach
+	);
+	return &metaMappable;
+}
+
+
+} // namespace metapp
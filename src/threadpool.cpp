@@ -0,0 +1,372 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/utilities/threadpool.h"
+#include "metapp/exception.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <utility>
+
+namespace metapp {
+
+namespace internal_ {
+
+class ThreadPoolImplement
+{
+private:
+	// Each worker owns a doubly linked task list.
+	// The owner pushes and pops at the back (LIFO, cache friendly),
+	// other workers steal from the front (FIFO, the oldest and likely largest work).
+	struct Worker
+	{
+		Worker() : mutex(), head(nullptr), tail(nullptr), thread() {
+		}
+
+		void pushBack(ExecutorTask * task) {
+			task->next = nullptr;
+			task->previous = tail;
+			if(tail == nullptr) {
+				head = task;
+			}
+			else {
+				tail->next = task;
+			}
+			tail = task;
+		}
+
+		ExecutorTask * popBack() {
+			std::lock_guard<std::mutex> lock(mutex);
+			ExecutorTask * task = tail;
+			if(task != nullptr) {
+				tail = task->previous;
+				if(tail == nullptr) {
+					head = nullptr;
+				}
+				else {
+					tail->next = nullptr;
+				}
+			}
+			return task;
+		}
+
+		ExecutorTask * popFront() {
+			std::lock_guard<std::mutex> lock(mutex);
+			ExecutorTask * task = head;
+			if(task != nullptr) {
+				head = task->next;
+				if(head == nullptr) {
+					tail = nullptr;
+				}
+				else {
+					head->previous = nullptr;
+				}
+			}
+			return task;
+		}
+
+		std::mutex mutex;
+		ExecutorTask * head;
+		ExecutorTask * tail;
+		std::thread thread;
+	};
+
+public:
+	explicit ThreadPoolImplement(std::size_t threadCount)
+		:
+			workerList(),
+			pendingCount(0),
+			sleepingCount(0),
+			nextWorkerIndex(0),
+			sleepMutex(),
+			sleepCondition(),
+			stopping(false),
+			exceptionMutex(),
+			exceptionHandler(),
+			taskException()
+	{
+		if(threadCount == 0) {
+			threadCount = std::thread::hardware_concurrency();
+			if(threadCount == 0) {
+				threadCount = 1;
+			}
+		}
+		for(std::size_t i = 0; i < threadCount; ++i) {
+			workerList.emplace_back(new Worker());
+		}
+		for(std::size_t i = 0; i < threadCount; ++i) {
+			workerList[i]->thread = std::thread([this, i]() {
+				doWork(i);
+			});
+		}
+	}
+
+	~ThreadPoolImplement() {
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stopping = true;
+		}
+		sleepCondition.notify_all();
+		for(auto & worker : workerList) {
+			worker->thread.join();
+		}
+	}
+
+	std::size_t getThreadCount() const {
+		return workerList.size();
+	}
+
+	void execute(ExecutorTask * task) {
+		// pendingCount must be incremented before the task is published, otherwise a worker may pop the task
+		// and decrement pendingCount first, then pendingCount wraps around.
+		pendingCount.fetch_add(1);
+		Worker & worker = *workerList[selectWorkerIndex()];
+		{
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			worker.pushBack(task);
+		}
+		wakeUp(1);
+	}
+
+	void executeBatch(ExecutorTask * const * tasks, const std::size_t count) {
+		if(count == 0) {
+			return;
+		}
+		pendingCount.fetch_add(count);
+		// Spread the tasks evenly, each worker queue is locked only once.
+		const std::size_t workerCount = workerList.size();
+		const std::size_t firstIndex = selectWorkerIndex();
+		const std::size_t chunkSize = (count + workerCount - 1) / workerCount;
+		std::size_t taskIndex = 0;
+		for(std::size_t i = 0; i < workerCount && taskIndex < count; ++i) {
+			Worker & worker = *workerList[(firstIndex + i) % workerCount];
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			for(std::size_t k = 0; k < chunkSize && taskIndex < count; ++k) {
+				worker.pushBack(tasks[taskIndex]);
+				++taskIndex;
+			}
+		}
+		wakeUp(count);
+	}
+
+	static bool runPendingTaskInCurrentWorker() {
+		if(currentPool == nullptr) {
+			return false;
+		}
+		ExecutorTask * task = currentPool->findTask(currentWorkerIndex);
+		if(task == nullptr) {
+			return false;
+		}
+		currentPool->pendingCount.fetch_sub(1);
+		runTask(task);
+		return true;
+	}
+
+	void setTaskExceptionHandler(ThreadPool::TaskExceptionHandler handler) {
+		std::lock_guard<std::mutex> lock(exceptionMutex);
+		exceptionHandler = std::move(handler);
+	}
+
+	std::exception_ptr takeTaskException() {
+		std::lock_guard<std::mutex> lock(exceptionMutex);
+		std::exception_ptr result = taskException;
+		taskException = nullptr;
+		return result;
+	}
+
+private:
+	std::size_t selectWorkerIndex() {
+		// A task submitted from a worker goes to its own queue, so nested tasks stay on the same thread
+		// unless they are stolen.
+		if(currentPool == this) {
+			return currentWorkerIndex;
+		}
+		return nextWorkerIndex.fetch_add(1, std::memory_order_relaxed) % workerList.size();
+	}
+
+	void wakeUp(const std::size_t count) {
+		// pendingCount is incremented before sleepingCount is read, and a worker increments sleepingCount
+		// before it reads pendingCount, so either the worker sees the task, or we see the worker and notify it.
+		if(sleepingCount.load() == 0) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		if(count == 1) {
+			sleepCondition.notify_one();
+		}
+		else {
+			sleepCondition.notify_all();
+		}
+	}
+
+	// An exception escaping from a task would unwind out of the worker thread and terminate the program,
+	// so it's caught and passed to handleTaskException.
+	static void runTask(ExecutorTask * task) {
+#ifdef METAPP_EXCEPTION_ENABLED
+		try {
+#endif
+			task->run(task);
+#ifdef METAPP_EXCEPTION_ENABLED
+		}
+		catch(...) {
+			currentPool->handleTaskException(std::current_exception());
+		}
+#endif
+	}
+
+	void handleTaskException(std::exception_ptr exception) {
+		ThreadPool::TaskExceptionHandler handler;
+		{
+			std::lock_guard<std::mutex> lock(exceptionMutex);
+			if(! exceptionHandler) {
+				if(! taskException) {
+					taskException = exception;
+				}
+				return;
+			}
+			handler = exceptionHandler;
+		}
+		handler(exception);
+	}
+
+	ExecutorTask * findTask(const std::size_t workerIndex) {
+		ExecutorTask * task = workerList[workerIndex]->popBack();
+		if(task != nullptr) {
+			return task;
+		}
+		const std::size_t workerCount = workerList.size();
+		for(std::size_t i = 1; i < workerCount; ++i) {
+			task = workerList[(workerIndex + i) % workerCount]->popFront();
+			if(task != nullptr) {
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	void doWork(const std::size_t workerIndex) {
+		currentPool = this;
+		currentWorkerIndex = workerIndex;
+		for(;;) {
+			ExecutorTask * task = findTask(workerIndex);
+			if(task != nullptr) {
+				pendingCount.fetch_sub(1);
+				runTask(task);
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			sleepingCount.fetch_add(1);
+			while(pendingCount.load() == 0 && ! stopping) {
+				sleepCondition.wait(lock);
+			}
+			sleepingCount.fetch_sub(1);
+			if(stopping && pendingCount.load() == 0) {
+				break;
+			}
+		}
+		currentPool = nullptr;
+	}
+
+private:
+	std::vector<std::unique_ptr<Worker> > workerList;
+	std::atomic<std::size_t> pendingCount;
+	std::atomic<std::size_t> sleepingCount;
+	std::atomic<std::size_t> nextWorkerIndex;
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+	bool stopping;
+	std::mutex exceptionMutex;
+	ThreadPool::TaskExceptionHandler exceptionHandler;
+	std::exception_ptr taskException;
+
+	static thread_local ThreadPoolImplement * currentPool;
+	static thread_local std::size_t currentWorkerIndex;
+};
+
+thread_local ThreadPoolImplement * ThreadPoolImplement::currentPool = nullptr;
+thread_local std::size_t ThreadPoolImplement::currentWorkerIndex = 0;
+
+bool runPendingTaskInCurrentWorker()
+{
+	return ThreadPoolImplement::runPendingTaskInCurrentWorker();
+}
+
+} // namespace internal_
+
+void Executor::executeBatch(ExecutorTask * const * tasks, const std::size_t count)
+{
+	for(std::size_t i = 0; i < count; ++i) {
+		execute(tasks[i]);
+	}
+}
+
+std::size_t Executor::getConcurrency() const
+{
+	return 1;
+}
+
+ThreadPool::ThreadPool(const std::size_t threadCount)
+	: implement(new internal_::ThreadPoolImplement(threadCount))
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+}
+
+std::size_t ThreadPool::getThreadCount() const
+{
+	return implement->getThreadCount();
+}
+
+void ThreadPool::execute(ExecutorTask * task)
+{
+	implement->execute(task);
+}
+
+void ThreadPool::executeBatch(ExecutorTask * const * tasks, const std::size_t count)
+{
+	implement->executeBatch(tasks, count);
+}
+
+std::size_t ThreadPool::getConcurrency() const
+{
+	return implement->getThreadCount();
+}
+
+void ThreadPool::setTaskExceptionHandler(TaskExceptionHandler handler)
+{
+	implement->setTaskExceptionHandler(std::move(handler));
+}
+
+std::exception_ptr ThreadPool::takeTaskException()
+{
+	return implement->takeTaskException();
+}
+
+ThreadPool & getDefaultThreadPool()
+{
+	static ThreadPool threadPool;
+	return threadPool;
+}
+
+
+} // namespace metapp
+
@@ -0,0 +1,115 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "metapp/metatypes/thunk_function.h"
+#include "metapp/allmetatypes.h"
+
+namespace metapp {
+
+namespace {
+
+const ThunkFunction & getThunkFunction(const Variant & callable)
+{
+	return callable.get<const ThunkFunction &>();
+}
+
+const MetaType * metaCallableGetClassType(const Variant & callable)
+{
+	return getThunkFunction(callable).getClassType();
+}
+
+MetaCallable::ParameterCountInfo metaCallableGetParameterCountInfo(const Variant & callable)
+{
+	const ThunkFunction & thunkFunction = getThunkFunction(callable);
+	return MetaCallable::ParameterCountInfo {
+		thunkFunction.getReturnType()->isVoid() ? 0 : 1,
+		thunkFunction.getParameterCount()
+	};
+}
+
+const MetaType * metaCallableGetReturnType(const Variant & callable)
+{
+	return getThunkFunction(callable).getReturnType();
+}
+
+const MetaType * metaCallableGetParameterType(const Variant & callable, const int index)
+{
+	return getThunkFunction(callable).getParameterType(index);
+}
+
+// Same ranking as internal_::MetaCallableInvokeChecker, with the parameter types known at running time.
+int metaCallableRankInvoke(const Variant & callable, const Variant & /*instance*/, const ArgumentSpan & arguments)
+{
+	const ThunkFunction & thunkFunction = getThunkFunction(callable);
+	if((int)arguments.size() != thunkFunction.getParameterCount()) {
+		return invokeRankNone;
+	}
+	if(arguments.empty()) {
+		return invokeRankMax;
+	}
+	int rank = 0;
+	bool allMatchExactly = true;
+	for(std::size_t i = 0; i < arguments.size(); ++i) {
+		const MetaType * parameterType = thunkFunction.getParameterType((int)i);
+		if(getNonReferenceMetaType(arguments[i])->equal(getNonReferenceMetaType(parameterType))) {
+			rank += invokeRankMatch;
+		}
+		else if(arguments[i].canCast(parameterType)) {
+			rank += invokeRankCast;
+			allMatchExactly = false;
+		}
+		else {
+			return invokeRankNone;
+		}
+	}
+	return allMatchExactly ? invokeRankMax : rank;
+}
+
+bool metaCallableCanInvoke(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments)
+{
+	return metaCallableRankInvoke(callable, instance, arguments) != invokeRankNone;
+}
+
+Variant metaCallableInvoke(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments)
+{
+	const ThunkFunction & thunkFunction = getThunkFunction(callable);
+	if((int)arguments.size() != thunkFunction.getParameterCount()) {
+		raiseException<IllegalArgumentException>();
+		return Variant();
+	}
+	return thunkFunction.getInvoke()(thunkFunction.getData(), getPointer(instance), arguments);
+}
+
+} // namespace
+
+const MetaCallable * DeclareMetaType<ThunkFunction>::getMetaCallable()
+{
+	static const MetaCallable metaCallable(
+		&metaCallableGetClassType,
+		&metaCallableGetParameterCountInfo,
+		&metaCallableGetReturnType,
+		&metaCallableGetParameterType,
+		&metaCallableRankInvoke,
+		&metaCallableCanInvoke,
+		&metaCallableInvoke
+	);
+	return &metaCallable;
+}
+
+
+} // namespace metapp
+
@@ -19,6 +19,8 @@
 #include "metapp/interfaces/metastreamable.h"
 #include "metapp/interfaces/metaaccessible.h"
 #include "metapp/allmetatypes.h"
+#include "metapp/implement/internal/castcache_i.h"
+#include "metapp/implement/internal/util_i.h"
 
 namespace metapp {
 
@@ -73,7 +75,25 @@ bool Variant::canCast(const MetaType * toMetaType) const
 	if(getNonReferenceMetaType(toMetaType)->equal(getNonReferenceMetaType(metaType))) {
 		return true;
 	}
-	return metaType->cast(nullptr, this, toMetaType);
+	const MetaType * fromNonReference = getNonReferenceMetaType(metaType);
+	const MetaType * toNonReference = getNonReferenceMetaType(toMetaType);
+	// Casting between arithmetic types is already O(1) and cheaper than the memo lookup.
+	// The casts which depend on the value, such as metapp::Variant, std::function, and the user casts
+	// which are not declared as castCacheable, can't be memoized.
+	if((typeKindIsArithmetic(fromNonReference->getTypeKind()) && typeKindIsArithmetic(toNonReference->getTypeKind()))
+		|| ! metaType->isCastCacheable() || ! fromNonReference->isCastCacheable()
+		|| ! toMetaType->isCastCacheable() || ! toNonReference->isCastCacheable()) {
+		return metaType->cast(nullptr, this, toMetaType);
+	}
+	// Only the class hierarchy affects the cached results, registering items doesn't invalidate them.
+	const std::uint64_t generation = internal_::getInheritanceGeneration();
+	const internal_::CastCacheResult cached = internal_::findCanCastCache(metaType, toMetaType, generation);
+	if(cached != internal_::CastCacheResult::unknown) {
+		return cached == internal_::CastCacheResult::yes;
+	}
+	const bool result = metaType->cast(nullptr, this, toMetaType);
+	internal_::storeCanCastCache(metaType, toMetaType, generation, result);
+	return result;
 }
 
 Variant Variant::cast(const MetaType * toMetaType) const
@@ -98,6 +118,20 @@ Variant Variant::castSilently(const MetaType * toMetaType) const
 	return result;
 }
 
+ErrorCode Variant::tryCast(Variant * result, const MetaType * toMetaType) const
+{
+	if(getNonReferenceMetaType(toMetaType)->equal(getNonReferenceMetaType(metaType))) {
+		if(result != nullptr) {
+			*result = *this;
+		}
+		return ErrorCode::ok;
+	}
+	if(result == nullptr) {
+		return canCast(toMetaType) ? ErrorCode::ok : ErrorCode::badCast;
+	}
+	return metaType->cast(result, this, toMetaType) ? ErrorCode::ok : ErrorCode::badCast;
+}
+
 Variant Variant::clone() const
 {
 	return Variant(metaType, metaType->constructVariantData(getAddress(), CopyStrategy::copy));
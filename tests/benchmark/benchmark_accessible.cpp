@@ -24,6 +24,14 @@ namespace {
 struct TestClass
 {
 	int value;
+
+	int getValue() const {
+		return value;
+	}
+
+	void setValue(const int newValue) {
+		value = newValue;
+	}
 };
 
 BenchmarkFunc
@@ -56,5 +64,50 @@ BenchmarkFunc
 	printResult(t, iterations, "Accessible, set `TestClass::int`");
 }
 
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	const auto t = measureElapsedTime([iterations]() {
+		metapp::Variant v = metapp::createAccessor(&TestClass::getValue, &TestClass::setValue);
+		TestClass obj;
+		metapp::Variant instance = &obj;
+		const metapp::MetaAccessible * metaAccessible = v.getMetaType()->getMetaAccessible();
+		for(int i = 0; i < iterations; ++i) {
+			metaAccessible->get(v, instance);
+		}
+	});
+	printResult(t, iterations, "Accessible, get `TestClass::getValue` accessor");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	const auto t = measureElapsedTime([iterations]() {
+		metapp::Variant v = metapp::createAccessor(&TestClass::getValue, &TestClass::setValue);
+		TestClass obj;
+		metapp::Variant instance = &obj;
+		const metapp::MetaAccessible * metaAccessible = v.getMetaType()->getMetaAccessible();
+		for(int i = 0; i < iterations; ++i) {
+			metaAccessible->set(v, instance, i);
+		}
+	});
+	printResult(t, iterations, "Accessible, set `TestClass::setValue` accessor");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	const auto t = measureElapsedTime([iterations]() {
+		metapp::Variant v = metapp::createAccessor(&TestClass::value, &TestClass::value);
+		TestClass obj;
+		metapp::Variant instance = &obj;
+		const metapp::MetaAccessible * metaAccessible = v.getMetaType()->getMetaAccessible();
+		for(int i = 0; i < iterations; ++i) {
+			metaAccessible->get(v, instance);
+		}
+	});
+	printResult(t, iterations, "Accessible, get `TestClass::int` accessor");
+}
+
 
 } //namespace
@@ -0,0 +1,78 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/variant.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/utilities/asyncinvoke.h"
+
+#include <vector>
+
+namespace {
+
+int asyncAdd(const int a, const int b)
+{
+	return a + b;
+}
+
+constexpr int asyncIterations = 1000 * 1000;
+constexpr int asyncFanOut = 1000;
+
+BenchmarkFunc
+{
+	constexpr int iterations = asyncIterations;
+	metapp::ThreadPool & threadPool = metapp::getDefaultThreadPool();
+	const auto t = measureElapsedTime([&threadPool]() {
+		metapp::Variant v = &asyncAdd;
+		std::vector<metapp::InvokeFuture> futureList(asyncFanOut);
+		for(int i = 0; i < iterations / asyncFanOut; ++i) {
+			for(int k = 0; k < asyncFanOut; ++k) {
+				futureList[k] = metapp::callableInvokeAsync(threadPool, v, nullptr, k, i);
+			}
+			for(auto & future : futureList) {
+				future.wait();
+			}
+		}
+	});
+	printResult(t, iterations, "Callable, callableInvokeAsync `int asyncAdd(const int a, const int b)`");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = asyncIterations;
+	metapp::ThreadPool & threadPool = metapp::getDefaultThreadPool();
+	std::vector<metapp::Variant> columnA;
+	std::vector<metapp::Variant> columnB;
+	for(int i = 0; i < asyncFanOut; ++i) {
+		columnA.push_back(i);
+		columnB.push_back(i + 1);
+	}
+	const auto t = measureElapsedTime([&threadPool, &columnA, &columnB]() {
+		metapp::Variant v = &asyncAdd;
+		const metapp::ArgumentSpan columns[] = { columnA, columnB };
+		std::vector<metapp::InvokeFuture> futureList(asyncFanOut);
+		for(int i = 0; i < iterations / asyncFanOut; ++i) {
+			metapp::callableInvokeAsyncBatch(threadPool, v, {}, columns, futureList);
+			for(auto & future : futureList) {
+				future.wait();
+			}
+		}
+	});
+	printResult(t, iterations, "Callable, callableInvokeAsyncBatch `int asyncAdd(const int a, const int b)`");
+}
+
+} //namespace
@@ -0,0 +1,85 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/variant.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/utilities/bulkconvert.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+constexpr int bulkConvertIterations = generalIterations;
+// The arrays fit in cache, so the kernels are measured rather than the memory bandwidth.
+constexpr int bulkConvertArraySize = 4096;
+
+template <typename From, typename To>
+void benchmarkBulkConvert(const metapp::BulkConvertIsa isa, const char * message)
+{
+	std::vector<From> source(bulkConvertArraySize);
+	for(std::size_t i = 0; i < source.size(); ++i) {
+		source[i] = static_cast<From>(i % 1000);
+	}
+	std::vector<To> destination(bulkConvertArraySize);
+	const metapp::BulkConvertIsa previousIsa = metapp::getBulkConvertIsa();
+	metapp::setBulkConvertIsa(isa);
+	const auto t = measureElapsedTime([&source, &destination]() {
+		metapp::Variant from = metapp::Variant::reference(source);
+		metapp::Variant to = metapp::Variant::reference(destination);
+		for(int i = 0; i < bulkConvertIterations / bulkConvertArraySize; ++i) {
+			metapp::bulkConvert(from, to);
+		}
+	});
+	metapp::setBulkConvertIsa(previousIsa);
+	REQUIRE(destination.back() == static_cast<To>(source.back()));
+	printResult(t, bulkConvertIterations, message);
+}
+
+BenchmarkFunc
+{
+	std::vector<std::int32_t> source(bulkConvertArraySize, 5);
+	std::vector<double> destination(bulkConvertArraySize);
+	const auto t = measureElapsedTime([&source, &destination]() {
+		metapp::Variant from = metapp::Variant::reference(source);
+		metapp::Variant to = metapp::Variant::reference(destination);
+		for(int k = 0; k < bulkConvertIterations / bulkConvertArraySize; ++k) {
+			for(std::size_t i = 0; i < source.size(); ++i) {
+				metapp::indexableSet(to, i, metapp::indexableGet(from, i));
+			}
+		}
+	});
+	REQUIRE(destination.back() == 5);
+	printResult(t, bulkConvertIterations, "BulkConvert, int32 to double, element by element indexableSet");
+}
+
+BenchmarkFunc
+{
+	benchmarkBulkConvert<std::int32_t, double>(metapp::BulkConvertIsa::scalar, "BulkConvert, int32 to double, scalar");
+	benchmarkBulkConvert<std::int32_t, double>(metapp::BulkConvertIsa::sse2, "BulkConvert, int32 to double, SSE2");
+	benchmarkBulkConvert<std::int32_t, double>(metapp::BulkConvertIsa::avx2, "BulkConvert, int32 to double, AVX2");
+	benchmarkBulkConvert<std::int32_t, double>(metapp::BulkConvertIsa::avx512, "BulkConvert, int32 to double, AVX-512");
+}
+
+BenchmarkFunc
+{
+	benchmarkBulkConvert<float, std::int64_t>(metapp::BulkConvertIsa::scalar, "BulkConvert, float to int64, scalar");
+	benchmarkBulkConvert<float, std::int64_t>(metapp::BulkConvertIsa::avx512, "BulkConvert, float to int64, AVX-512");
+}
+
+} //namespace
@@ -18,6 +18,10 @@
 #include "metapp/variant.h"
 #include "metapp/allmetatypes.h"
 #include "metapp/interfaces/metacallable.h"
+#include "metapp/metarepo.h"
+
+#include <vector>
+#include <string>
 
 namespace {
 
@@ -33,6 +37,30 @@ struct TestClass
 	}
 };
 
+struct OverloadBase
+{
+	int value;
+};
+
+struct OverloadDerived : OverloadBase
+{
+};
+
+int overloadString(const std::string & s, const long n)
+{
+	return (int)s.size() + (int)n;
+}
+
+int overloadDouble(const double a, const double b)
+{
+	return (int)(a + b);
+}
+
+int overloadBase(const OverloadBase * object, const long n)
+{
+	return object->value + (int)n;
+}
+
 BenchmarkFunc
 {
 	constexpr int iterations = generalIterations;
@@ -80,4 +108,97 @@ BenchmarkFunc
 	printResult(t, iterations, "Callable, invoke `int TestClass::add(const int a, const int b)` with `double, double`");
 }
 
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	const auto t = measureElapsedTime([iterations]() {
+		metapp::Variant v = &TestClass::add;
+		TestClass obj;
+		metapp::Variant instance = &obj;
+		const metapp::MetaCallable * metaCallable = v.getMetaType()->getMetaCallable();
+		for(int i = 0; i < iterations; ++i) {
+			const int b = i + 1;
+			const metapp::VariantRef arguments[] { metapp::VariantRef::reference(i), metapp::VariantRef::reference(b) };
+			metaCallable->invokeRef(v, instance, arguments);
+		}
+	});
+	printResult(t, iterations, "Callable, invokeRef `int TestClass::add(const int a, const int b)` with `int, int`");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	const auto t = measureElapsedTime([iterations]() {
+		metapp::Variant v = &TestClass::add;
+		TestClass obj;
+		metapp::Variant instance = &obj;
+		const metapp::MetaCallable * metaCallable = v.getMetaType()->getMetaCallable();
+		for(int i = 0; i < iterations; ++i) {
+			const double a = i;
+			const double b = a + 1.0;
+			const metapp::VariantRef arguments[] { metapp::VariantRef::reference(a), metapp::VariantRef::reference(b) };
+			metaCallable->invokeRef(v, instance, arguments);
+		}
+	});
+	printResult(t, iterations, "Callable, invokeRef `int TestClass::add(const int a, const int b)` with `double, double`");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	const auto t = measureElapsedTime([iterations]() {
+		metapp::Variant v = &TestClass::add;
+		TestClass obj;
+		metapp::Variant instance = &obj;
+		for(int i = 0; i < iterations; ++i) {
+			metapp::callableInvoke(v, instance, i, i + 1);
+		}
+	});
+	printResult(t, iterations, "Callable, callableInvoke `int TestClass::add(const int a, const int b)` with `int, int`");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	constexpr int rowCount = 1000;
+	std::vector<metapp::Variant> columnA;
+	std::vector<metapp::Variant> columnB;
+	for(int i = 0; i < rowCount; ++i) {
+		columnA.push_back(i);
+		columnB.push_back(i + 1);
+	}
+	std::vector<metapp::Variant> results(rowCount);
+	const auto t = measureElapsedTime([&columnA, &columnB, &results]() {
+		metapp::Variant v = &TestClass::add;
+		TestClass obj;
+		metapp::Variant instance = &obj;
+		const metapp::MetaCallable * metaCallable = v.getMetaType()->getMetaCallable();
+		const metapp::ArgumentSpan columns[] = { columnA, columnB };
+		for(int i = 0; i < iterations / rowCount; ++i) {
+			metaCallable->invokeBatch(v, metapp::ArgumentSpan(&instance, 1), columns, results);
+		}
+	});
+	printResult(t, iterations, "Callable, invokeBatch `int TestClass::add(const int a, const int b)` with `int, int` columns");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerBase<OverloadDerived, OverloadBase>();
+	metaRepo.registerCallable("func", &overloadString);
+	metaRepo.registerCallable("func", &overloadDouble);
+	metaRepo.registerCallable("func", &overloadBase);
+	const metapp::Variant & func = metaRepo.getCallable("func").asCallable();
+	OverloadDerived derived;
+	derived.value = 1;
+	const auto t = measureElapsedTime([iterations, &func, &derived]() {
+		for(int i = 0; i < iterations; ++i) {
+			// Ranking the overloads casts OverloadDerived * to OverloadBase * through the class hierarchy.
+			metapp::callableInvoke(func, nullptr, &derived, i);
+		}
+	});
+	printResult(t, iterations, "Callable, invoke overloaded functions, argument casted to base class pointer");
+}
+
 } //namespace
@@ -0,0 +1,196 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/utilities/changetracker.h"
+
+#include <vector>
+#include <string>
+
+namespace {
+
+struct BenchEntity
+{
+	int x;
+	int y;
+	int z;
+	int health;
+	int armor;
+	int ammo;
+	int team;
+	int state;
+	int score;
+	int kills;
+	int deaths;
+	int level;
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <BenchEntity> : metapp::DeclareMetaTypeBase <BenchEntity>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<BenchEntity>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("x", &BenchEntity::x);
+				mc.registerAccessible("y", &BenchEntity::y);
+				mc.registerAccessible("z", &BenchEntity::z);
+				mc.registerAccessible("health", &BenchEntity::health);
+				mc.registerAccessible("armor", &BenchEntity::armor);
+				mc.registerAccessible("ammo", &BenchEntity::ammo);
+				mc.registerAccessible("team", &BenchEntity::team);
+				mc.registerAccessible("state", &BenchEntity::state);
+				mc.registerAccessible("score", &BenchEntity::score);
+				mc.registerAccessible("kills", &BenchEntity::kills);
+				mc.registerAccessible("deaths", &BenchEntity::deaths);
+				mc.registerAccessible("level", &BenchEntity::level);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+// 1000 entities with 12 fields, each tick writes 50 fields by accessibleSet, then finds the changed fields.
+constexpr int entityCount = 1000;
+constexpr int writesPerTick = 50;
+constexpr int tickCount = 200;
+
+std::vector<const metapp::Variant *> getEntityAccessibleList()
+{
+	std::vector<const metapp::Variant *> accessibleList;
+	for(const metapp::MetaItem & item : metapp::getMetaType<BenchEntity>()->getMetaClass()->getAccessibleView()) {
+		accessibleList.push_back(&item.asAccessible());
+	}
+	return accessibleList;
+}
+
+void writeTick(std::vector<BenchEntity> & entityList, const std::vector<const metapp::Variant *> & accessibleList, const int tick)
+{
+	for(int i = 0; i < writesPerTick; ++i) {
+		const int entityIndex = (tick * 7919 + i * 104729) % entityCount;
+		const metapp::Variant & accessible = *accessibleList[(std::size_t)(tick + i) % accessibleList.size()];
+		metapp::accessibleSet(accessible, &entityList[(std::size_t)entityIndex], tick * writesPerTick + i + 1);
+	}
+}
+
+// Reads every field by accessibleGet and compares with the values seen in the previous tick.
+BenchmarkFunc
+{
+	std::vector<BenchEntity> entityList(entityCount, BenchEntity {});
+	const std::vector<const metapp::Variant *> accessibleList = getEntityAccessibleList();
+	std::vector<int> seenValueList(entityCount * accessibleList.size());
+	std::size_t changedCount = 0;
+	const auto t = measureElapsedTime([&entityList, &accessibleList, &seenValueList, &changedCount]() {
+		for(int tick = 0; tick < tickCount; ++tick) {
+			writeTick(entityList, accessibleList, tick);
+			std::size_t index = 0;
+			for(BenchEntity & entity : entityList) {
+				for(const metapp::Variant * accessible : accessibleList) {
+					const int value = metapp::accessibleGet(*accessible, &entity).get<int>();
+					if(value != seenValueList[index]) {
+						seenValueList[index] = value;
+						++changedCount;
+					}
+					++index;
+				}
+			}
+		}
+	});
+	REQUIRE(changedCount == (std::size_t)(tickCount * writesPerTick));
+	printResult(t, tickCount, "ChangeTracker, poll all fields by accessibleGet, 1000 entities * 12 fields, 50 writes per tick");
+}
+
+BenchmarkFunc
+{
+	std::vector<BenchEntity> entityList(entityCount, BenchEntity {});
+	const std::vector<const metapp::Variant *> accessibleList = getEntityAccessibleList();
+	for(BenchEntity & entity : entityList) {
+		metapp::ChangeTracker::track(&entity);
+	}
+	std::size_t changedCount = 0;
+	const auto t = measureElapsedTime([&entityList, &accessibleList, &changedCount]() {
+		std::uint64_t generation = metapp::ChangeTracker::getGeneration();
+		for(int tick = 0; tick < tickCount; ++tick) {
+			writeTick(entityList, accessibleList, tick);
+			for(const metapp::ChangedInstance & instance : metapp::ChangeTracker::getChangedInstances(generation)) {
+				changedCount += instance.fieldList.size();
+			}
+			generation = metapp::ChangeTracker::getGeneration();
+		}
+	});
+	for(BenchEntity & entity : entityList) {
+		metapp::ChangeTracker::untrack(&entity);
+	}
+	REQUIRE(changedCount == (std::size_t)(tickCount * writesPerTick));
+	printResult(t, tickCount, "ChangeTracker, changed fields by getChangedInstances, 1000 entities * 12 fields, 50 writes per tick");
+}
+
+// The cost of the hook in accessibleSet.
+void doBenchmarkAccessibleSet(const bool tracked, const char * message)
+{
+	constexpr int iterations = generalIterations;
+	BenchEntity entity {};
+	BenchEntity otherEntity {};
+	const metapp::Variant & accessible = metapp::getMetaType<BenchEntity>()->getMetaClass()->getAccessible("score").asAccessible();
+	if(tracked) {
+		metapp::ChangeTracker::track(&entity);
+	}
+	else {
+		// Another instance is tracked, so the hook looks up the instance.
+		metapp::ChangeTracker::track(&otherEntity);
+	}
+	const auto t = measureElapsedTime([iterations, &accessible, &entity]() {
+		for(int i = 0; i < iterations; ++i) {
+			metapp::accessibleSet(accessible, &entity, i);
+		}
+	});
+	metapp::ChangeTracker::untrack(&entity);
+	metapp::ChangeTracker::untrack(&otherEntity);
+	REQUIRE(entity.score == iterations - 1);
+	printResult(t, iterations, message);
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	BenchEntity entity {};
+	const metapp::Variant & accessible = metapp::getMetaType<BenchEntity>()->getMetaClass()->getAccessible("score").asAccessible();
+	const auto t = measureElapsedTime([iterations, &accessible, &entity]() {
+		for(int i = 0; i < iterations; ++i) {
+			metapp::accessibleSet(accessible, &entity, i);
+		}
+	});
+	REQUIRE(entity.score == iterations - 1);
+	printResult(t, iterations, "ChangeTracker, accessibleSet, nothing is tracked");
+}
+
+BenchmarkFunc
+{
+	doBenchmarkAccessibleSet(false, "ChangeTracker, accessibleSet, the instance is not tracked");
+}
+
+BenchmarkFunc
+{
+	doBenchmarkAccessibleSet(true, "ChangeTracker, accessibleSet, the instance is tracked");
+}
+
+} //namespace
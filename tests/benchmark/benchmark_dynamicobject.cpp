@@ -0,0 +1,121 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/utilities/dynamicobject.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/interfaces/metamappable.h"
+
+#include <map>
+#include <string>
+
+namespace {
+
+struct BenchStaticObject
+{
+	int x;
+	int y;
+	int z;
+};
+
+constexpr int dynamicObjectIterations = generalIterations;
+
+metapp::DynamicObject createDynamicObject()
+{
+	metapp::DynamicObject object;
+	object.set("x", 1);
+	object.set("y", 2);
+	object.set("z", 3);
+	return object;
+}
+
+BenchmarkFunc
+{
+	metapp::Variant object = std::map<std::string, metapp::Variant> {
+		{ "x", 1 }, { "y", 2 }, { "z", 3 }
+	};
+	const metapp::Variant keyY = std::string("y");
+	long long sum = 0;
+	const auto t = measureElapsedTime([&object, &keyY, &sum]() {
+		for(int i = 0; i < dynamicObjectIterations; ++i) {
+			sum += metapp::mappableGet(object, keyY).get<const metapp::Variant &>().get<int>();
+		}
+	});
+	REQUIRE(sum > 0);
+	printResult(t, dynamicObjectIterations, "DynamicObject, get property from std::map<std::string, Variant> via MetaMappable");
+}
+
+BenchmarkFunc
+{
+	const metapp::DynamicObject object = createDynamicObject();
+	const std::string nameY = "y";
+	long long sum = 0;
+	const auto t = measureElapsedTime([&object, &nameY, &sum]() {
+		for(int i = 0; i < dynamicObjectIterations; ++i) {
+			sum += object.find(nameY)->get<int>();
+		}
+	});
+	REQUIRE(sum > 0);
+	printResult(t, dynamicObjectIterations, "DynamicObject, get property by name, no cache");
+}
+
+BenchmarkFunc
+{
+	const metapp::DynamicObject object = createDynamicObject();
+	const metapp::DynamicPropertyCache cache("y");
+	long long sum = 0;
+	const auto t = measureElapsedTime([&object, &cache, &sum]() {
+		for(int i = 0; i < dynamicObjectIterations; ++i) {
+			sum += cache.find(object)->get<int>();
+		}
+	});
+	REQUIRE(sum > 0);
+	printResult(t, dynamicObjectIterations, "DynamicObject, get property with DynamicPropertyCache");
+}
+
+BenchmarkFunc
+{
+	metapp::DynamicObject object = createDynamicObject();
+	const metapp::Variant accessible = metapp::DynamicProperty("y");
+	const metapp::Variant instance = &object;
+	long long sum = 0;
+	const auto t = measureElapsedTime([&accessible, &instance, &sum]() {
+		for(int i = 0; i < dynamicObjectIterations; ++i) {
+			sum += metapp::accessibleGet(accessible, instance).get<const metapp::Variant &>().get<int>();
+		}
+	});
+	REQUIRE(sum > 0);
+	printResult(t, dynamicObjectIterations, "DynamicObject, get property with DynamicProperty via MetaAccessible");
+}
+
+BenchmarkFunc
+{
+	BenchStaticObject object { 1, 2, 3 };
+	const metapp::Variant accessible = &BenchStaticObject::y;
+	const metapp::Variant instance = &object;
+	long long sum = 0;
+	const auto t = measureElapsedTime([&accessible, &instance, &sum]() {
+		for(int i = 0; i < dynamicObjectIterations; ++i) {
+			sum += metapp::accessibleGet(accessible, instance).get<int>();
+		}
+	});
+	REQUIRE(sum > 0);
+	printResult(t, dynamicObjectIterations, "DynamicObject, get member data of static class via MetaAccessible, for reference");
+}
+
+} //namespace
@@ -0,0 +1,150 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/variant.h"
+#include "metapp/allmetatypes.h"
+
+#include <vector>
+#include <string>
+
+namespace {
+
+// Throwing and catching an exception costs microseconds, so the failure path runs fewer iterations.
+constexpr int failureIterations = generalIterations / 100;
+
+metapp::Variant createOverloadedFunction()
+{
+	metapp::Variant callable = metapp::OverloadedFunction();
+	metapp::OverloadedFunction & overloadedFunction = callable.get<metapp::OverloadedFunction &>();
+	overloadedFunction.addCallable(std::function<int (int)>([](const int n) {
+		return n;
+	}));
+	overloadedFunction.addCallable(std::function<int (const std::string &)>([](const std::string & s) {
+		return (int)s.size();
+	}));
+	return callable;
+}
+
+BenchmarkFunc
+{
+	int failedCount = 0;
+	const auto t = measureElapsedTime([&failedCount]() {
+		const metapp::Variant v(5);
+		for(int i = 0; i < failureIterations; ++i) {
+			try {
+				v.cast<std::vector<int> >();
+			}
+			catch(const metapp::BadCastException &) {
+				++failedCount;
+			}
+		}
+	});
+	REQUIRE(failedCount == failureIterations);
+	printResult(t, failureIterations, "ErrorCode, failed Variant::cast, catch BadCastException");
+}
+
+BenchmarkFunc
+{
+	int failedCount = 0;
+	const auto t = measureElapsedTime([&failedCount]() {
+		const metapp::Variant v(5);
+		metapp::Variant result;
+		for(int i = 0; i < failureIterations; ++i) {
+			if(v.tryCast<std::vector<int> >(&result) != metapp::ErrorCode::ok) {
+				++failedCount;
+			}
+		}
+	});
+	REQUIRE(failedCount == failureIterations);
+	printResult(t, failureIterations, "ErrorCode, failed Variant::tryCast");
+}
+
+BenchmarkFunc
+{
+	int failedCount = 0;
+	metapp::Variant callable = createOverloadedFunction();
+	const auto t = measureElapsedTime([&failedCount, &callable]() {
+		const std::vector<int> argument;
+		for(int i = 0; i < failureIterations; ++i) {
+			try {
+				metapp::callableInvoke(callable, nullptr, argument);
+			}
+			catch(const metapp::IllegalArgumentException &) {
+				++failedCount;
+			}
+		}
+	});
+	REQUIRE(failedCount == failureIterations);
+	printResult(t, failureIterations, "ErrorCode, failed overloaded callableInvoke, catch IllegalArgumentException");
+}
+
+BenchmarkFunc
+{
+	int failedCount = 0;
+	metapp::Variant callable = createOverloadedFunction();
+	const auto t = measureElapsedTime([&failedCount, &callable]() {
+		const std::vector<int> argument;
+		metapp::Variant result;
+		for(int i = 0; i < failureIterations; ++i) {
+			if(metapp::tryCallableInvoke(&result, callable, nullptr, argument) != metapp::ErrorCode::ok) {
+				++failedCount;
+			}
+		}
+	});
+	REQUIRE(failedCount == failureIterations);
+	printResult(t, failureIterations, "ErrorCode, failed overloaded tryCallableInvoke");
+}
+
+BenchmarkFunc
+{
+	int failedCount = 0;
+	std::vector<int> container(10);
+	const auto t = measureElapsedTime([&failedCount, &container]() {
+		const metapp::Variant v = metapp::Variant::reference(container);
+		for(int i = 0; i < failureIterations; ++i) {
+			try {
+				metapp::indexableGet(v, 10);
+			}
+			catch(const metapp::OutOfRangeException &) {
+				++failedCount;
+			}
+		}
+	});
+	REQUIRE(failedCount == failureIterations);
+	printResult(t, failureIterations, "ErrorCode, out of range indexableGet, catch OutOfRangeException");
+}
+
+BenchmarkFunc
+{
+	int failedCount = 0;
+	std::vector<int> container(10);
+	const auto t = measureElapsedTime([&failedCount, &container]() {
+		const metapp::Variant v = metapp::Variant::reference(container);
+		metapp::Variant result;
+		for(int i = 0; i < failureIterations; ++i) {
+			if(metapp::tryIndexableGet(&result, v, 10) != metapp::ErrorCode::ok) {
+				++failedCount;
+			}
+		}
+	});
+	REQUIRE(failedCount == failureIterations);
+	printResult(t, failureIterations, "ErrorCode, out of range tryIndexableGet");
+}
+
+} //namespace
+
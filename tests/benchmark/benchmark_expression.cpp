@@ -0,0 +1,197 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/utilities/expression.h"
+#include "metapp/interfaces/metaclass.h"
+
+#include <vector>
+#include <string>
+
+namespace {
+
+enum class BenchTier
+{
+	silver,
+	gold
+};
+
+struct BenchCustomer
+{
+	std::string name;
+	BenchTier tier;
+	int age;
+};
+
+struct BenchOrderItem
+{
+	double price;
+	int quantity;
+};
+
+struct BenchOrder
+{
+	std::vector<BenchOrderItem> items;
+	BenchCustomer customer;
+	int limit;
+	double discount;
+
+	double discounted(const double amount) const {
+		return amount * (1 - discount);
+	}
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <BenchTier> : metapp::DeclareMetaTypeBase <BenchTier>
+{
+	static const metapp::MetaEnum * getMetaEnum() {
+		static const metapp::MetaEnum metaEnum([](metapp::MetaEnum & me) {
+			me.registerValue("silver", BenchTier::silver);
+			me.registerValue("gold", BenchTier::gold);
+		});
+		return &metaEnum;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <BenchCustomer> : metapp::DeclareMetaTypeBase <BenchCustomer>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<BenchCustomer>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("name", &BenchCustomer::name);
+				mc.registerAccessible("tier", &BenchCustomer::tier);
+				mc.registerAccessible("age", &BenchCustomer::age);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <BenchOrder> : metapp::DeclareMetaTypeBase <BenchOrder>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<BenchOrder>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerType("Tier", metapp::getMetaType<BenchTier>());
+				mc.registerAccessible("items", &BenchOrder::items);
+				mc.registerAccessible("customer", &BenchOrder::customer);
+				mc.registerAccessible("limit", &BenchOrder::limit);
+				mc.registerAccessible("discount", &BenchOrder::discount);
+				mc.registerCallable("discounted", &BenchOrder::discounted);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+constexpr int expressionIterations = 1000 * 1000;
+
+BenchOrder makeBenchOrder()
+{
+	BenchOrder order;
+	order.items = { { 1.5, 4 }, { 12.0, 1 }, { 4.25, 2 } };
+	order.customer = { "Bob", BenchTier::gold, 30 };
+	order.limit = 2;
+	order.discount = 0.1;
+	return order;
+}
+
+const char * const ruleExpression = "items.size() > limit && customer.tier == Tier::gold";
+const char * const arithmeticExpression = "(customer.age * 2 + limit * 3) % 7 < 5 && discount * 100 >= 10.0 && customer.name == \"Bob\"";
+const char * const callExpression = "discounted(limit * 50) > 80";
+
+void benchmarkExpression(const char * source, const bool compiled)
+{
+	constexpr int iterations = expressionIterations;
+	const BenchOrder order = makeBenchOrder();
+	const metapp::Variant root = metapp::Variant::reference(order);
+	const metapp::Expression expression = metapp::Expression::compile<BenchOrder>(source);
+	int count = 0;
+	const auto t = measureElapsedTime([iterations, &expression, &root, &count, compiled]() {
+		for(int i = 0; i < iterations; ++i) {
+			const bool result = (compiled ? expression.evaluateBool(root) : expression.interpret(root).get<bool>());
+			count += (result ? 1 : 0);
+		}
+	});
+	printResult(t, iterations, std::string("Expression, ") + (compiled ? "evaluateBool bytecode" : "interpret") + ", " + source);
+	REQUIRE(count == iterations);
+}
+
+BenchmarkFunc
+{
+	benchmarkExpression(ruleExpression, false);
+}
+
+BenchmarkFunc
+{
+	benchmarkExpression(ruleExpression, true);
+}
+
+BenchmarkFunc
+{
+	benchmarkExpression(arithmeticExpression, false);
+}
+
+BenchmarkFunc
+{
+	benchmarkExpression(arithmeticExpression, true);
+}
+
+BenchmarkFunc
+{
+	benchmarkExpression(callExpression, false);
+}
+
+BenchmarkFunc
+{
+	benchmarkExpression(callExpression, true);
+}
+
+// The same rule written in C++ against the reflected members, looking up by name on every evaluation.
+BenchmarkFunc
+{
+	constexpr int iterations = expressionIterations;
+	const BenchOrder order = makeBenchOrder();
+	const metapp::Variant root = metapp::Variant::reference(order);
+	const metapp::MetaClass * orderClass = metapp::getMetaType<BenchOrder>()->getMetaClass();
+	int count = 0;
+	const auto t = measureElapsedTime([iterations, orderClass, &root, &count]() {
+		for(int i = 0; i < iterations; ++i) {
+			const metapp::Variant items = metapp::accessibleGet(orderClass->getAccessible("items").asAccessible(), root);
+			const metapp::Variant limit = metapp::accessibleGet(orderClass->getAccessible("limit").asAccessible(), root);
+			const metapp::Variant customer = metapp::accessibleGet(orderClass->getAccessible("customer").asAccessible(), root);
+			const metapp::Variant tier = metapp::accessibleGet(
+				metapp::getNonReferenceMetaType(customer)->getMetaClass()->getAccessible("tier").asAccessible(), customer);
+			const metapp::Variant gold = orderClass->getType("Tier").asMetaType()->getMetaEnum()->getByName("gold").asEnumValue();
+			const bool result = (long long)metapp::indexableGetSizeInfo(items).getSize() > limit.cast<long long>().get<long long>()
+				&& tier.cast<long long>().get<long long>() == gold.cast<long long>().get<long long>();
+			count += (result ? 1 : 0);
+		}
+	});
+	printResult(t, iterations, std::string("Expression, hand written reflection lookups, ") + ruleExpression);
+	REQUIRE(count == iterations);
+}
+
+} //namespace
@@ -0,0 +1,144 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/metarepo.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/utilities/memoryreport.h"
+
+#include <string>
+#include <iostream>
+
+// Prints the memory report of a synthetic registry, which is the baseline to compare compact meta data layouts.
+
+namespace {
+
+constexpr int memoryClassCount = 100;
+constexpr int memoryRepoCount = 100;
+constexpr int memoryItemCount = 20;
+
+template <int N>
+struct MemoryClass
+{
+	int value1;
+	int value2;
+	std::string text;
+
+	int get() const {
+		return value1 + N;
+	}
+
+	void set(const int value) {
+		value1 = value;
+	}
+
+	int add(const int a) const {
+		return value1 + a;
+	}
+
+	int add(const int a, const int b) const {
+		return value1 + a + b;
+	}
+};
+
+int memoryFunction1(const int a)
+{
+	return a;
+}
+
+int memoryFunction2(const int a, const int b)
+{
+	return a + b;
+}
+
+} // namespace
+
+template <int N>
+struct metapp::DeclareMetaType <MemoryClass<N> > : metapp::DeclareMetaTypeBase <MemoryClass<N> >
+{
+	static const metapp::MetaClass * getMetaClass() {
+		using C = MemoryClass<N>;
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<C>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerConstructor(metapp::Constructor<C ()>());
+				mc.registerAccessible("value1", &C::value1);
+				mc.registerAccessible("value2", &C::value2);
+				mc.registerAccessible("text", &C::text).registerAnnotation("description", std::string("a text value"));
+				mc.registerCallable("get", &C::get);
+				mc.registerCallable("set", &C::set);
+				mc.registerCallable("add", metapp::selectOverload<int (int) const>(&C::add));
+				mc.registerCallable("add", metapp::selectOverload<int (int, int) const>(&C::add));
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+template <int N>
+struct RegisterMemoryClasses
+{
+	static void registerTypes(metapp::MetaRepo & metaRepo) {
+		RegisterMemoryClasses<N - 1>::registerTypes(metaRepo);
+		metaRepo.registerType<MemoryClass<N - 1> >("MemoryClass" + std::to_string(N - 1));
+	}
+};
+
+template <>
+struct RegisterMemoryClasses <0>
+{
+	static void registerTypes(metapp::MetaRepo & /*metaRepo*/) {
+	}
+};
+
+void buildMemoryRegistry(metapp::MetaRepo & metaRepo)
+{
+	RegisterMemoryClasses<memoryClassCount>::registerTypes(metaRepo);
+	for(int i = 0; i < memoryRepoCount; ++i) {
+		metapp::MetaRepo subRepo;
+		for(int k = 0; k < memoryItemCount; ++k) {
+			const std::string name = "function" + std::to_string(k);
+			subRepo.registerCallable(name, &memoryFunction1);
+			if(k % 4 == 0) {
+				subRepo.registerCallable(name, &memoryFunction2).registerAnnotation("overloaded", true);
+			}
+		}
+		metaRepo.registerRepo("module" + std::to_string(i), subRepo);
+	}
+}
+
+BenchmarkFunc
+{
+	metapp::MetaRepo metaRepo;
+	buildMemoryRegistry(metaRepo);
+
+	metapp::MemoryReport report;
+	const auto t = measureElapsedTime([&report, &metaRepo]() {
+		report.addMetaRepo(&metaRepo, "registry");
+	});
+	printResult(t, 1, "MemoryReport, " + std::to_string(report.getEntryList().size()) + " repos and classes");
+	std::cout << std::endl;
+	report.write(std::cout, 10);
+	std::cout << std::endl;
+	REQUIRE(report.getTotal().byteCount > 0);
+}
+
+} //namespace
+
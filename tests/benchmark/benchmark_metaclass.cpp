@@ -0,0 +1,279 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/variant.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/metarepo.h"
+
+#include <string>
+#include <functional>
+
+namespace {
+
+struct ViewBase
+{
+	int a;
+	int b;
+	int c;
+};
+
+struct ViewDerived : ViewBase
+{
+	int d;
+	int e;
+	int f;
+};
+
+metapp::MetaRepo viewMetaRepo;
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <ViewBase> : metapp::DeclareMetaTypeBase <ViewBase>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<ViewBase>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("a", &ViewBase::a);
+				mc.registerAccessible("b", &ViewBase::b);
+				mc.registerAccessible("c", &ViewBase::c);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <ViewDerived> : metapp::DeclareMetaTypeBase <ViewDerived>
+{
+	static void setup()
+	{
+		viewMetaRepo.registerBase<ViewDerived, ViewBase>();
+	}
+
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<ViewDerived>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("d", &ViewDerived::d);
+				mc.registerAccessible("e", &ViewDerived::e);
+				mc.registerAccessible("f", &ViewDerived::f);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+constexpr int viewIterations = generalIterations / 10;
+
+BenchmarkFunc
+{
+	const metapp::MetaClass * metaClass = metapp::getMetaType<ViewDerived>()->getMetaClass();
+	std::size_t nameLength = 0;
+	const auto t = measureElapsedTime([metaClass, &nameLength]() {
+		for(int i = 0; i < viewIterations; ++i) {
+			for(const auto & item : metaClass->getAccessibleView()) {
+				nameLength += item.getName().size();
+			}
+		}
+	});
+	REQUIRE(nameLength == (std::size_t)viewIterations * 6);
+	printResult(t, viewIterations, "MetaItemView, get and iterate accessible view including bases");
+}
+
+BenchmarkFunc
+{
+	const metapp::MetaClass * metaClass = metapp::getMetaType<ViewDerived>()->getMetaClass();
+	const auto view = metaClass->getAccessibleView();
+	std::size_t nameLength = 0;
+	const auto t = measureElapsedTime([&view, &nameLength]() {
+		for(int i = 0; i < viewIterations; ++i) {
+			for(std::size_t k = 0; k < view.size(); ++k) {
+				nameLength += view[k].getName().size();
+			}
+		}
+	});
+	REQUIRE(nameLength == (std::size_t)viewIterations * 6);
+	printResult(t, viewIterations, "MetaItemView, index accessible view including bases");
+}
+
+// A repo with many handlers, only one of them accepts std::string
+void setupHandlerRepo(metapp::MetaRepo & metaRepo)
+{
+	for(int i = 0; i < 100; ++i) {
+		metaRepo.registerCallable("onInt" + std::to_string(i), std::function<void (int)>([](int) {}));
+	}
+	metaRepo.registerCallable("onString", std::function<void (const std::string &)>([](const std::string &) {}));
+}
+
+constexpr int queryIterations = generalIterations / 100;
+
+BenchmarkFunc
+{
+	metapp::MetaRepo metaRepo;
+	setupHandlerRepo(metaRepo);
+	const metapp::MetaType * parameterType = metapp::getMetaType<std::string>();
+	std::size_t count = 0;
+	const auto t = measureElapsedTime([&metaRepo, parameterType, &count]() {
+		for(int i = 0; i < queryIterations; ++i) {
+			for(const auto & item : metaRepo.getCallableView()) {
+				const metapp::Variant & callable = item.asCallable();
+				if(metapp::callableGetParameterCountInfo(callable).getMaxParameterCount() == 1
+					&& metapp::getNonReferenceMetaType(metapp::callableGetParameterType(callable, 0))->equal(parameterType)) {
+					++count;
+				}
+			}
+		}
+	});
+	REQUIRE(count == (std::size_t)queryIterations);
+	printResult(t, queryIterations, "MetaRepo, find callables by parameter type in 101 callables, iterate view");
+}
+
+BenchmarkFunc
+{
+	metapp::MetaRepo metaRepo;
+	setupHandlerRepo(metaRepo);
+	const metapp::MetaType * parameterType = metapp::getMetaType<std::string>();
+	std::size_t count = 0;
+	const auto t = measureElapsedTime([&metaRepo, parameterType, &count]() {
+		for(int i = 0; i < queryIterations; ++i) {
+			count += metaRepo.findCallablesByParameter(1, 0, parameterType).size();
+		}
+	});
+	REQUIRE(count == (std::size_t)queryIterations);
+	printResult(t, queryIterations, "MetaRepo, find callables by parameter type in 101 callables, findCallablesByParameter");
+}
+
+struct EntityBase
+{
+	virtual ~EntityBase() {}
+	int id = 0;
+};
+
+template <int N>
+struct Entity : EntityBase
+{
+	int value = N;
+};
+
+struct EntityOther
+{
+	virtual ~EntityOther() {}
+	int other = 0;
+};
+
+// The most derived class is the last one in the candidate list, and EntityBase is not its first base.
+struct EntityLast : EntityOther, Entity<7>
+{
+};
+
+using EntityTryCast = bool (*)(EntityBase * entity);
+
+template <typename T>
+bool entityTryCast(EntityBase * entity)
+{
+	return dynamic_cast<T *>(entity) != nullptr;
+}
+
+void setupEntityRepo(metapp::MetaRepo & metaRepo)
+{
+	metaRepo.registerBase<Entity<0>, EntityBase>();
+	metaRepo.registerBase<Entity<1>, EntityBase>();
+	metaRepo.registerBase<Entity<2>, EntityBase>();
+	metaRepo.registerBase<Entity<3>, EntityBase>();
+	metaRepo.registerBase<Entity<4>, EntityBase>();
+	metaRepo.registerBase<Entity<5>, EntityBase>();
+	metaRepo.registerBase<Entity<6>, EntityBase>();
+	metaRepo.registerBase<Entity<7>, EntityBase>();
+	metaRepo.registerBase<EntityLast, EntityOther, Entity<7> >();
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	// The workaround without the registry, try dynamic_cast to each candidate, the most derived first.
+	const std::pair<EntityTryCast, const metapp::MetaType *> candidateList[] = {
+		{ &entityTryCast<EntityLast>, metapp::getMetaType<EntityLast>() },
+		{ &entityTryCast<Entity<0> >, metapp::getMetaType<Entity<0> >() },
+		{ &entityTryCast<Entity<1> >, metapp::getMetaType<Entity<1> >() },
+		{ &entityTryCast<Entity<2> >, metapp::getMetaType<Entity<2> >() },
+		{ &entityTryCast<Entity<3> >, metapp::getMetaType<Entity<3> >() },
+		{ &entityTryCast<Entity<4> >, metapp::getMetaType<Entity<4> >() },
+		{ &entityTryCast<Entity<5> >, metapp::getMetaType<Entity<5> >() },
+		{ &entityTryCast<Entity<6> >, metapp::getMetaType<Entity<6> >() },
+		{ &entityTryCast<Entity<7> >, metapp::getMetaType<Entity<7> >() },
+	};
+	Entity<6> entity;
+	EntityBase * base = &entity;
+	const metapp::MetaType * found = nullptr;
+	const auto t = measureElapsedTime([iterations, &candidateList, base, &found]() {
+		for(int i = 0; i < iterations; ++i) {
+			for(const auto & candidate : candidateList) {
+				if(candidate.first(base)) {
+					found = candidate.second;
+					break;
+				}
+			}
+			dontOptimizeAway(found);
+		}
+	});
+	REQUIRE(found == metapp::getMetaType<Entity<6> >());
+	printResult(t, iterations, "MetaRepo, dynamic type of EntityBase *, dynamic_cast to 9 candidates");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	metapp::MetaRepo metaRepo;
+	setupEntityRepo(metaRepo);
+	Entity<6> entity;
+	const metapp::Variant base = static_cast<EntityBase *>(&entity);
+	const metapp::MetaType * found = nullptr;
+	const auto t = measureElapsedTime([iterations, &base, &found]() {
+		for(int i = 0; i < iterations; ++i) {
+			found = metapp::getDynamicMetaType(base);
+			dontOptimizeAway(found);
+		}
+	});
+	REQUIRE(found == metapp::getMetaType<Entity<6> >());
+	printResult(t, iterations, "MetaRepo, dynamic type of EntityBase *, getDynamicMetaType");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	metapp::MetaRepo metaRepo;
+	setupEntityRepo(metaRepo);
+	EntityLast entity;
+	const metapp::Variant base = static_cast<EntityBase *>(&entity);
+	void * address = nullptr;
+	const auto t = measureElapsedTime([iterations, &base, &address]() {
+		for(int i = 0; i < iterations; ++i) {
+			address = metapp::getDynamicReference(base).getAddress();
+			dontOptimizeAway(address);
+		}
+	});
+	REQUIRE(address == &entity);
+	printResult(t, iterations, "MetaRepo, getDynamicReference of EntityBase *, adjusted through two levels");
+}
+
+} //namespace
@@ -0,0 +1,104 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/variant.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/metarepo.h"
+#include "metapp/utilities/nameindex.h"
+
+#include <string>
+
+namespace {
+
+constexpr int nameCount = 50 * 1000;
+constexpr int nameQueryIterations = 1000;
+
+std::string makeName(int n)
+{
+	static const char * const wordList[] = { "get", "set", "value", "name", "count", "item", "node", "list" };
+	std::string name;
+	for(int i = 0; i < 3; ++i) {
+		name += wordList[n % 8];
+		n /= 8;
+	}
+	return name + std::to_string(n);
+}
+
+void setupNameRepo(metapp::MetaRepo & metaRepo)
+{
+	for(int i = 0; i < nameCount; ++i) {
+		metaRepo.registerVariable(makeName(i), i);
+	}
+}
+
+BenchmarkFunc
+{
+	metapp::MetaRepo metaRepo;
+	setupNameRepo(metaRepo);
+	const std::string prefix = "valuenode";
+	std::size_t count = 0;
+	const auto t = measureElapsedTime([&metaRepo, &prefix, &count]() {
+		for(int i = 0; i < nameQueryIterations; ++i) {
+			for(const auto & item : metaRepo.getVariableView()) {
+				if(item.getName().compare(0, prefix.size(), prefix) == 0) {
+					++count;
+				}
+			}
+		}
+	});
+	REQUIRE(count > 0);
+	printResult(t, nameQueryIterations, "NameIndex, prefix search in 50k names, scan view");
+}
+
+BenchmarkFunc
+{
+	metapp::MetaRepo metaRepo;
+	setupNameRepo(metaRepo);
+	metapp::NameIndex nameIndex;
+	nameIndex.addMetaRepo(&metaRepo);
+	nameIndex.update();
+	const std::string prefix = "valuenode";
+	std::size_t count = 0;
+	const auto t = measureElapsedTime([&nameIndex, &prefix, &count]() {
+		for(int i = 0; i < nameQueryIterations; ++i) {
+			count += nameIndex.findByPrefix(prefix, 20).size();
+		}
+	});
+	REQUIRE(count > 0);
+	printResult(t, nameQueryIterations, "NameIndex, prefix search in 50k names, findByPrefix limit 20");
+}
+
+BenchmarkFunc
+{
+	metapp::MetaRepo metaRepo;
+	setupNameRepo(metaRepo);
+	metapp::NameIndex nameIndex;
+	nameIndex.addMetaRepo(&metaRepo);
+	nameIndex.update();
+	std::size_t count = 0;
+	const auto t = measureElapsedTime([&nameIndex, &count]() {
+		for(int i = 0; i < nameQueryIterations; ++i) {
+			count += nameIndex.findFuzzy("valuenodeiten12", 2).size();
+		}
+	});
+	REQUIRE(count > 0);
+	printResult(t, nameQueryIterations, "NameIndex, fuzzy search in 50k names, findFuzzy distance 2");
+}
+
+} //namespace
+
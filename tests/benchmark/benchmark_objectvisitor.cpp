@@ -0,0 +1,100 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/variant.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/utilities/objectvisitor.h"
+#include "metapp/utilities/threadpool.h"
+
+#include <vector>
+#include <atomic>
+
+namespace {
+
+struct VisitorNode
+{
+	int value;
+	VisitorNode * next;
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <VisitorNode> : metapp::DeclareMetaTypeBase <VisitorNode>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<VisitorNode>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("value", &VisitorNode::value);
+				mc.registerAccessible("next", &VisitorNode::next);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+constexpr int visitorIterations = generalIterations / 10;
+
+std::vector<VisitorNode> makeVisitorNodeList()
+{
+	// Each node is reachable from the vector and from its previous node.
+	std::vector<VisitorNode> nodeList(visitorIterations);
+	for(int i = 0; i < visitorIterations; ++i) {
+		nodeList[i].value = 1;
+		nodeList[i].next = (i + 1 < visitorIterations ? &nodeList[i + 1] : nullptr);
+	}
+	return nodeList;
+}
+
+BenchmarkFunc
+{
+	std::vector<VisitorNode> nodeList = makeVisitorNodeList();
+	std::size_t count = 0;
+	const auto t = measureElapsedTime([&nodeList, &count]() {
+		metapp::ObjectVisitor visitor;
+		visitor.visit(metapp::Variant::reference(nodeList), [&count](const metapp::ObjectVisitor::Node &) -> bool {
+			++count;
+			return true;
+		});
+	});
+	REQUIRE(count > (std::size_t)visitorIterations);
+	printResult(t, visitorIterations, "ObjectVisitor, sequential over linked std::vector<VisitorNode>");
+}
+
+BenchmarkFunc
+{
+	std::vector<VisitorNode> nodeList = makeVisitorNodeList();
+	std::atomic<std::size_t> count(0);
+	const auto t = measureElapsedTime([&nodeList, &count]() {
+		metapp::ObjectVisitor visitor;
+		visitor.setExecutor(&metapp::getDefaultThreadPool());
+		visitor.visit(metapp::Variant::reference(nodeList), [&count](const metapp::ObjectVisitor::Node &) -> bool {
+			count.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		});
+	});
+	REQUIRE(count > (std::size_t)visitorIterations);
+	printResult(t, visitorIterations, "ObjectVisitor, default thread pool over linked std::vector<VisitorNode>");
+}
+
+} //namespace
+
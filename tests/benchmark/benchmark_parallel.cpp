@@ -0,0 +1,70 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/variant.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/utilities/parallel.h"
+
+#include <vector>
+#include <atomic>
+
+namespace {
+
+constexpr int parallelIterations = generalIterations;
+
+BenchmarkFunc
+{
+	std::vector<int> container(parallelIterations, 1);
+	long long sum = 0;
+	const auto t = measureElapsedTime([&container, &sum]() {
+		metapp::Variant v = metapp::Variant::reference(container);
+		const std::size_t size = metapp::indexableGetSizeInfo(v).getSize();
+		for(std::size_t i = 0; i < size; ++i) {
+			sum += metapp::indexableGet(v, i).get<int>();
+		}
+	});
+	REQUIRE(sum == parallelIterations);
+	printResult(t, parallelIterations, "Parallel, sequential indexableGet over std::vector<int>");
+}
+
+BenchmarkFunc
+{
+	std::vector<int> container(parallelIterations, 1);
+	std::atomic<long long> sum(0);
+	const auto t = measureElapsedTime([&container, &sum]() {
+		metapp::parallelForEach(metapp::Variant::reference(container), [&sum](const metapp::Variant & element, const std::size_t) {
+			sum.fetch_add(element.get<int>(), std::memory_order_relaxed);
+		});
+	});
+	REQUIRE(sum == parallelIterations);
+	printResult(t, parallelIterations, "Parallel, parallelForEach over std::vector<int>");
+}
+
+BenchmarkFunc
+{
+	std::vector<int> container(parallelIterations, 1);
+	const auto t = measureElapsedTime([&container]() {
+		metapp::parallelForEachAs<int>(metapp::Variant::reference(container), [](int & element, const std::size_t index) {
+			element += (int)index;
+		});
+	});
+	REQUIRE(container.back() == parallelIterations);
+	printResult(t, parallelIterations, "Parallel, parallelForEachAs<int> over std::vector<int>");
+}
+
+} //namespace
@@ -0,0 +1,84 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/interfaces/metacallable.h"
+#include "metapp/utilities/profiler.h"
+
+// The hooks are only compiled with METAPP_ENABLE_PROFILING, configure with -Dprofiling=1 to compare
+// the overhead of callableInvoke when the profiler is disabled, records histograms, and records trace.
+
+namespace {
+
+constexpr int profilerIterations = generalIterations;
+
+int profiledAdd(const int a, const int b)
+{
+	return a + b;
+}
+
+void doBenchmarkInvoke(const char * message)
+{
+	metapp::Variant callable(&profiledAdd);
+	int sum = 0;
+	const auto t = measureElapsedTime([&callable, &sum]() {
+		for(int i = 0; i < profilerIterations; ++i) {
+			sum += metapp::callableInvoke(callable, nullptr, i, 1).get<int>();
+		}
+	});
+	REQUIRE(sum != 0);
+	printResult(t, profilerIterations, message);
+}
+
+BenchmarkFunc
+{
+	doBenchmarkInvoke("Profiler, callableInvoke, profiler disabled");
+}
+
+BenchmarkFunc
+{
+	metapp::Profiler::enable();
+	doBenchmarkInvoke("Profiler, callableInvoke, histograms enabled");
+	metapp::Profiler::disable();
+	metapp::Profiler::reset();
+}
+
+BenchmarkFunc
+{
+	// Enough events for 1/10 of the invocations, the later events are dropped.
+	metapp::Profiler::startTrace(profilerIterations / 10);
+	doBenchmarkInvoke("Profiler, callableInvoke, trace enabled");
+	metapp::Profiler::stopTrace();
+}
+
+BenchmarkFunc
+{
+	metapp::Profiler::enable();
+	metapp::Variant item;
+	const auto t = measureElapsedTime([&item]() {
+		for(int i = 0; i < profilerIterations; ++i) {
+			metapp::internal_::ProfileTimer().record(&item, metapp::ProfilePhase::invoke);
+		}
+	});
+	metapp::Profiler::disable();
+	metapp::Profiler::reset();
+	printResult(t, profilerIterations, "Profiler, record one histogram sample");
+}
+
+} //namespace
+
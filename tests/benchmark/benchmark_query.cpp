@@ -0,0 +1,160 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/utilities/query.h"
+#include "metapp/utilities/threadpool.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaaccessible.h"
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+struct BenchQueryRecord
+{
+	int id;
+	double score;
+	int level;
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <BenchQueryRecord> : metapp::DeclareMetaTypeBase <BenchQueryRecord>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<BenchQueryRecord>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("id", &BenchQueryRecord::id);
+				mc.registerAccessible("score", &BenchQueryRecord::score);
+				mc.registerAccessible("level", &BenchQueryRecord::level);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+constexpr int queryRecordCount = 1000 * 1000;
+// The naive reflected comparator is too slow to sort all records.
+constexpr int naiveQueryRecordCount = 100 * 1000;
+
+std::vector<BenchQueryRecord> makeRecordList(const int count)
+{
+	std::vector<BenchQueryRecord> recordList(count);
+	unsigned int seed = 1;
+	for(int i = 0; i < count; ++i) {
+		seed = seed * 1103515245 + 12345;
+		recordList[i] = BenchQueryRecord { i, (double)(seed % 100000) / 100.0, (int)((seed >> 16) % 10) };
+	}
+	return recordList;
+}
+
+BenchmarkFunc
+{
+	const std::vector<BenchQueryRecord> recordList = makeRecordList(queryRecordCount);
+	std::vector<std::size_t> indexList;
+	const auto t = measureElapsedTime([&recordList, &indexList]() {
+		for(std::size_t i = 0; i < recordList.size(); ++i) {
+			if(recordList[i].level < 5) {
+				indexList.push_back(i);
+			}
+		}
+		std::stable_sort(indexList.begin(), indexList.end(), [&recordList](const std::size_t a, const std::size_t b) {
+			return recordList[a].score < recordList[b].score;
+		});
+	});
+	REQUIRE(! indexList.empty());
+	printResult(t, queryRecordCount, "Query, filter and sort, native code");
+}
+
+BenchmarkFunc
+{
+	const std::vector<BenchQueryRecord> recordList = makeRecordList(queryRecordCount);
+	const metapp::Variant container = metapp::Variant::reference(recordList);
+	std::vector<std::size_t> indexList;
+	const auto t = measureElapsedTime([&container, &indexList]() {
+		indexList = metapp::Query::from<BenchQueryRecord>()
+			.where("level", metapp::QueryOperator::less, 5)
+			.orderBy("score")
+			.execute(container);
+	});
+	REQUIRE(! indexList.empty());
+	printResult(t, queryRecordCount, "Query, filter and sort, Query");
+}
+
+BenchmarkFunc
+{
+	const std::vector<BenchQueryRecord> recordList = makeRecordList(queryRecordCount);
+	const metapp::Variant container = metapp::Variant::reference(recordList);
+	metapp::ThreadPool threadPool;
+	std::vector<std::size_t> indexList;
+	const auto t = measureElapsedTime([&container, &indexList, &threadPool]() {
+		indexList = metapp::Query::from<BenchQueryRecord>()
+			.where("level", metapp::QueryOperator::less, 5)
+			.orderBy("score")
+			.setExecutor(&threadPool)
+			.execute(container);
+	});
+	REQUIRE(! indexList.empty());
+	printResult(t, queryRecordCount, "Query, filter and sort, Query with ThreadPool");
+}
+
+BenchmarkFunc
+{
+	const std::vector<BenchQueryRecord> recordList = makeRecordList(naiveQueryRecordCount);
+	const metapp::MetaClass * metaClass = metapp::getMetaType<BenchQueryRecord>()->getMetaClass();
+	const metapp::Variant level = metaClass->getAccessible("level").asAccessible();
+	const metapp::Variant score = metaClass->getAccessible("score").asAccessible();
+	std::vector<std::size_t> indexList;
+	const auto t = measureElapsedTime([&recordList, &indexList, &level, &score]() {
+		for(std::size_t i = 0; i < recordList.size(); ++i) {
+			if(metapp::accessibleGet(level, &recordList[i]).cast<int>().get<int>() < 5) {
+				indexList.push_back(i);
+			}
+		}
+		std::stable_sort(indexList.begin(), indexList.end(), [&recordList, &score](const std::size_t a, const std::size_t b) {
+			return metapp::accessibleGet(score, &recordList[a]).cast<double>().get<double>()
+				< metapp::accessibleGet(score, &recordList[b]).cast<double>().get<double>();
+		});
+	});
+	REQUIRE(! indexList.empty());
+	printResult(t, naiveQueryRecordCount, "Query, filter and sort, accessibleGet in the comparator");
+}
+
+BenchmarkFunc
+{
+	const std::vector<BenchQueryRecord> recordList = makeRecordList(naiveQueryRecordCount);
+	const metapp::Variant container = metapp::Variant::reference(recordList);
+	std::vector<std::size_t> indexList;
+	const auto t = measureElapsedTime([&container, &indexList]() {
+		indexList = metapp::Query::from<BenchQueryRecord>()
+			.where("level", metapp::QueryOperator::less, 5)
+			.orderBy("score")
+			.execute(container);
+	});
+	REQUIRE(! indexList.empty());
+	printResult(t, naiveQueryRecordCount, "Query, filter and sort, Query, for comparison with accessibleGet");
+}
+
+} //namespace
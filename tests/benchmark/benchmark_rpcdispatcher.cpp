@@ -0,0 +1,156 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/utilities/rpcdispatcher.h"
+#include "metapp/interfaces/metacallable.h"
+#include "metapp/metarepo.h"
+
+#include <vector>
+#include <string>
+
+namespace {
+
+int rpcAdd(const int a, const long long b)
+{
+	return a + (int)b;
+}
+
+double rpcAdd(const double a, const double b)
+{
+	return a + b;
+}
+
+std::string rpcGreet(const std::string & name, const int count)
+{
+	return name + std::to_string(count);
+}
+
+void registerRpcMethods(metapp::MetaRepo & metaRepo)
+{
+	metaRepo.registerCallable("add", metapp::selectOverload<int (int, long long)>(&rpcAdd));
+	metaRepo.registerCallable("add", metapp::selectOverload<double (double, double)>(&rpcAdd));
+	metaRepo.registerCallable("greet", &rpcGreet);
+}
+
+void printCallsPerSecond(const uint64_t time, const int iterations, const std::string & message)
+{
+	printResult(time, iterations, message);
+	std::cout << "    " << intToString(time == 0 ? 0 : (uint64_t)iterations * 1000 / time) << " calls per second" << std::endl;
+}
+
+// The server looks up the method by name, builds the arguments as Variants, ranks the overloads,
+// and boxes the result. The request is the method name followed by the arguments.
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	metapp::MetaRepo metaRepo;
+	registerRpcMethods(metaRepo);
+	std::vector<char> request;
+	metapp::RpcWriter writer(request);
+	writer.write("add");
+	writer.write(5);
+	writer.write(6LL);
+	std::vector<char> response;
+	const auto t = measureElapsedTime([iterations, &metaRepo, &request, &response]() {
+		for(int i = 0; i < iterations; ++i) {
+			response.clear();
+			metapp::RpcReader reader(request.data(), request.size());
+			std::string name;
+			int a;
+			long long b;
+			reader.read(&name);
+			reader.read(&a);
+			reader.read(&b);
+			const metapp::Variant arguments[] = { a, b };
+			const metapp::Variant & callable = metaRepo.getCallable(name).asCallable();
+			const metapp::Variant result = metapp::callableInvoke(callable, nullptr, arguments[0], arguments[1]);
+			metapp::RpcWriter responseWriter(response);
+			responseWriter.write(result.cast<int>().get<int>());
+		}
+	});
+	printCallsPerSecond(t, iterations, "RpcDispatcher, `int add(int, long long)` by name lookup and Variant arguments");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	metapp::MetaRepo metaRepo;
+	registerRpcMethods(metaRepo);
+	const metapp::RpcDispatcher dispatcher(&metaRepo);
+	std::vector<char> request;
+	metapp::writeRpcRequest(request, dispatcher.findMethodId("add"), 5, 6LL);
+	std::vector<char> response;
+	const auto t = measureElapsedTime([iterations, &dispatcher, &request, &response]() {
+		for(int i = 0; i < iterations; ++i) {
+			response.clear();
+			dispatcher.dispatch(request.data(), request.size(), response);
+		}
+	});
+	printCallsPerSecond(t, iterations, "RpcDispatcher, `int add(int, long long)` by method ID");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	metapp::MetaRepo metaRepo;
+	registerRpcMethods(metaRepo);
+	std::vector<char> request;
+	metapp::RpcWriter writer(request);
+	writer.write("greet");
+	writer.write("metapp");
+	writer.write(5);
+	std::vector<char> response;
+	const auto t = measureElapsedTime([iterations, &metaRepo, &request, &response]() {
+		for(int i = 0; i < iterations; ++i) {
+			response.clear();
+			metapp::RpcReader reader(request.data(), request.size());
+			std::string name;
+			std::string text;
+			int count;
+			reader.read(&name);
+			reader.read(&text);
+			reader.read(&count);
+			const metapp::Variant arguments[] = { text, count };
+			const metapp::Variant & callable = metaRepo.getCallable(name).asCallable();
+			const metapp::Variant result = metapp::callableInvoke(callable, nullptr, arguments[0], arguments[1]);
+			metapp::RpcWriter responseWriter(response);
+			responseWriter.write(result.get<const std::string &>());
+		}
+	});
+	printCallsPerSecond(t, iterations, "RpcDispatcher, `std::string greet(const std::string &, int)` by name lookup and Variant arguments");
+}
+
+BenchmarkFunc
+{
+	constexpr int iterations = generalIterations;
+	metapp::MetaRepo metaRepo;
+	registerRpcMethods(metaRepo);
+	const metapp::RpcDispatcher dispatcher(&metaRepo);
+	std::vector<char> request;
+	metapp::writeRpcRequest(request, dispatcher.findMethodId("greet"), "metapp", 5);
+	std::vector<char> response;
+	const auto t = measureElapsedTime([iterations, &dispatcher, &request, &response]() {
+		for(int i = 0; i < iterations; ++i) {
+			response.clear();
+			dispatcher.dispatch(request.data(), request.size(), response);
+		}
+	});
+	printCallsPerSecond(t, iterations, "RpcDispatcher, `std::string greet(const std::string &, int)` by method ID");
+}
+
+} //namespace
@@ -0,0 +1,151 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/utilities/snapshot.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaaccessible.h"
+
+#include <vector>
+#include <string>
+
+namespace {
+
+struct BenchSnapshotRoute
+{
+	std::string path;
+	int weight;
+	double timeout;
+};
+
+struct BenchSnapshotConfig
+{
+	std::vector<BenchSnapshotRoute> routeList;
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <BenchSnapshotRoute> : metapp::DeclareMetaTypeBase <BenchSnapshotRoute>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<BenchSnapshotRoute>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("path", &BenchSnapshotRoute::path);
+				mc.registerAccessible("weight", &BenchSnapshotRoute::weight);
+				mc.registerAccessible("timeout", &BenchSnapshotRoute::timeout);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <BenchSnapshotConfig> : metapp::DeclareMetaTypeBase <BenchSnapshotConfig>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<BenchSnapshotConfig>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("routeList", &BenchSnapshotConfig::routeList);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+constexpr int snapshotRouteCount = 1000 * 1000;
+
+BenchSnapshotConfig makeConfig()
+{
+	BenchSnapshotConfig config;
+	config.routeList.resize(snapshotRouteCount);
+	for(int i = 0; i < snapshotRouteCount; ++i) {
+		config.routeList[i] = BenchSnapshotRoute { "/api/route/" + std::to_string(i), i % 100, 1.5 };
+	}
+	return config;
+}
+
+BenchmarkFunc
+{
+	const BenchSnapshotConfig source = makeConfig();
+	const metapp::MetaClass * metaClass = metapp::getMetaType<BenchSnapshotRoute>()->getMetaClass();
+	const metapp::Variant path = metaClass->getAccessible("path").asAccessible();
+	const metapp::Variant weight = metaClass->getAccessible("weight").asAccessible();
+	const metapp::Variant timeout = metaClass->getAccessible("timeout").asAccessible();
+	BenchSnapshotConfig config;
+	const auto t = measureElapsedTime([&source, &config, &path, &weight, &timeout]() {
+		// Reconstruct the graph through accessibleSet, as a deserializer does.
+		config.routeList.resize(source.routeList.size());
+		for(std::size_t i = 0; i < source.routeList.size(); ++i) {
+			BenchSnapshotRoute * route = &config.routeList[i];
+			metapp::accessibleSet(path, route, source.routeList[i].path);
+			metapp::accessibleSet(weight, route, source.routeList[i].weight);
+			metapp::accessibleSet(timeout, route, source.routeList[i].timeout);
+		}
+	});
+	REQUIRE(config.routeList.back().weight == 99);
+	printResult(t, snapshotRouteCount, "Snapshot, reconstruct objects via accessibleSet");
+}
+
+BenchmarkFunc
+{
+	const std::vector<char> image = metapp::createSnapshot(metapp::Variant::reference(makeConfig()));
+	long long sum = 0;
+	const auto t = measureElapsedTime([&image, &sum]() {
+		const metapp::Snapshot snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+		const metapp::SnapshotObject config = snapshot.getRoot().get<const metapp::SnapshotObject &>();
+		const metapp::SnapshotArray routeList = config.get("routeList").get<const metapp::SnapshotArray &>();
+		sum += (long long)routeList.getSize();
+	});
+	REQUIRE(sum == snapshotRouteCount);
+	printResult(t, snapshotRouteCount, "Snapshot, open snapshot and get the root array");
+}
+
+BenchmarkFunc
+{
+	const std::vector<char> image = metapp::createSnapshot(metapp::Variant::reference(makeConfig()));
+	long long sum = 0;
+	const auto t = measureElapsedTime([&image, &sum]() {
+		const metapp::Snapshot snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+		const metapp::SnapshotObject config = snapshot.getRoot().get<const metapp::SnapshotObject &>();
+		const metapp::SnapshotArray routeList = config.get("routeList").get<const metapp::SnapshotArray &>();
+		const std::size_t size = routeList.getSize();
+		for(std::size_t i = 0; i < size; ++i) {
+			sum += routeList.get(i).get<const metapp::SnapshotObject &>().get(1).get<int>();
+		}
+	});
+	REQUIRE(sum > 0);
+	printResult(t, snapshotRouteCount, "Snapshot, open snapshot and read a field of all elements");
+}
+
+BenchmarkFunc
+{
+	const BenchSnapshotConfig config = makeConfig();
+	std::size_t size = 0;
+	const auto t = measureElapsedTime([&config, &size]() {
+		size = metapp::createSnapshot(metapp::Variant::reference(config)).size();
+	});
+	REQUIRE(size > 0);
+	printResult(t, snapshotRouteCount, "Snapshot, write snapshot");
+}
+
+} //namespace
@@ -0,0 +1,122 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/utilities/staticmembers.h"
+
+namespace {
+
+struct BenchStaticPoint
+{
+	int x;
+	int y;
+	int z;
+};
+
+struct BenchDynamicPoint
+{
+	int x;
+	int y;
+	int z;
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <BenchStaticPoint> : metapp::DeclareMetaTypeBase <BenchStaticPoint>
+{
+	static constexpr metapp::StaticMemberList<
+		metapp::StaticMember<BenchStaticPoint, int>,
+		metapp::StaticMember<BenchStaticPoint, int>,
+		metapp::StaticMember<BenchStaticPoint, int>
+	> getStaticMembers() {
+		return metapp::makeStaticMemberList(
+			metapp::staticMember("x", &BenchStaticPoint::x),
+			metapp::staticMember("y", &BenchStaticPoint::y),
+			metapp::staticMember("z", &BenchStaticPoint::z)
+		);
+	}
+
+	static const metapp::MetaClass * getMetaClass() {
+		return metapp::getMetaClassFromStaticMembers<BenchStaticPoint>();
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <BenchDynamicPoint> : metapp::DeclareMetaTypeBase <BenchDynamicPoint>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<BenchDynamicPoint>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("x", &BenchDynamicPoint::x);
+				mc.registerAccessible("y", &BenchDynamicPoint::y);
+				mc.registerAccessible("z", &BenchDynamicPoint::z);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+constexpr int staticMembersIterations = generalIterations;
+
+struct SumMember
+{
+	long long * sum;
+
+	void operator() (const char * /*name*/, const int & value) const {
+		*sum += value;
+	}
+
+	void operator() (const char * /*name*/, const metapp::Variant & value) const {
+		*sum += value.get<int>();
+	}
+};
+
+BenchmarkFunc
+{
+	BenchStaticPoint point { 1, 2, 3 };
+	long long sum = 0;
+	const auto t = measureElapsedTime([&point, &sum]() {
+		for(int i = 0; i < staticMembersIterations; ++i) {
+			metapp::forEachMember(point, SumMember { &sum });
+			point.x = i;
+		}
+	});
+	REQUIRE(sum > 0);
+	printResult(t, staticMembersIterations, "StaticMembers, forEachMember on static members, 3 members");
+}
+
+BenchmarkFunc
+{
+	BenchDynamicPoint point { 1, 2, 3 };
+	long long sum = 0;
+	const auto t = measureElapsedTime([&point, &sum]() {
+		for(int i = 0; i < staticMembersIterations; ++i) {
+			metapp::forEachMember(point, SumMember { &sum });
+			point.x = i;
+		}
+	});
+	REQUIRE(sum > 0);
+	printResult(t, staticMembersIterations, "StaticMembers, forEachMember on MetaClass accessibles, 3 members");
+}
+
+} //namespace
+
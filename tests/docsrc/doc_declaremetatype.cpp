@@ -150,6 +150,19 @@ of which is under DeclareMetaType, otherwise returns false.
 If `result` is not nullptr and if the `*fromVar` can be casted, set `result` with the casted value.  
 For the cases when `result` or `fromVar` is nullptr, see `cast`.  
 
+#### Constant castCacheable
+
+```c++
+static constexpr bool castCacheable = true;
+```
+
+`Variant::canCast` memoizes the results for each pair of meta types, so checking the class hierarchy is done only once.
+The results of the types which implement `cast` or `castFrom` are not memoized by default, because the user `cast`
+may depend on `fromVar`. If `cast` and `castFrom` only depend on the types, set `castCacheable` to true to allow memoizing.
+The types that don't implement `cast` nor `castFrom` are always memoized, set `castCacheable` to false to disable it.  
+`CastToTypes`, `CastFromTypes`, and `CastFromToTypes` don't declare `castCacheable`, because the type which inherits
+from them may implement its own `cast` or `castFrom`. Declare it in the type if the casts only depend on the types.  
+
 #### Function setup
 
 ```c++
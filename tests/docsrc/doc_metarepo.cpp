@@ -219,6 +219,24 @@ MetaItemView getRepoView() const;
 
 Returns a MetaItemView for all registered repos.  
 
+## MetaRepo member functions for querying meta data
+
+```c++
+MetaItemPointerList findCallablesByArity(const int arity) const;
+MetaItemPointerList findCallablesByParameter(
+	const int arity,
+	const int parameterIndex,
+	const MetaType * parameterType
+) const;
+MetaItemPointerList findCallablesByReturnType(const MetaType * returnType) const;
+MetaItemPointerList findItemsByAnnotation(const std::string & name) const;
+MetaItemPointerList findItemsByAnnotationValue(const std::string & name, const Variant & value) const;
+```
+
+Find the items by the signatures of callables or by annotations, using the indexes built on demand.
+Sub repos are not searched.
+They are the same as the functions in `MetaClass`, please see [MetaClass](interfaces/metaclass.md) for details.  
+
 
 ## MetaRepo member functions for class hierarchy
 
@@ -248,6 +266,8 @@ void registerBase();
 
 Register base classes of a class.  
 Template parameter `Class` is the derived class, `Bases` are the base classes.  
+If the classes are polymorphic, they are also recorded in a global registry which is keyed by `std::type_info`,
+so `getDynamicMetaType` can find them.  
 
 #### getBases
 
@@ -407,4 +427,63 @@ If no `MetaRepo` is found, `callback` is invoked with `classMetaType` as if ther
 If `callback` returns false, the traversing stops.  
 `traverseBases` returns true if all calls on `callback` returns true, returns false if all calls on `callback` returns false.
 
+## Dynamic type of polymorphic objects
+
+```c++
+const MetaType * getDynamicMetaType(const Variant & var);
+Variant getDynamicReference(const Variant & var);
+```
+
+Given a Variant of `Base *` which points to a `Derived` object, `getDynamicMetaType` returns the meta type of `Derived`.  
+`var` can be a pointer, a reference, a value, or a pointer wrapper such as `std::shared_ptr`.
+The classes must be polymorphic and registered by `MetaRepo::registerBase`, either as a base or a derived class.
+`getDynamicMetaType` gets `typeid` of the object through the static type, then finds the meta type in one hash lookup.  
+If the dynamic type can't be resolved, for example, the most derived class is not registered, or the pointer is nullptr,
+the static type is returned, the same as `getPointedType(var)`.  
+
+`getDynamicReference` returns a Variant which refers to the most derived object. The address is adjusted by `dynamic_cast<void *>`
+which is recorded when the class is registered, so it works for multiple inheritance and virtual base classes.
+If the dynamic type can't be resolved, the Variant refers to the object as the static type.
+If the static type is not a registered polymorphic class, or the pointer is nullptr, an empty Variant is returned.  
+desc*/
+
+//code
+struct DocShape
+{
+	virtual ~DocShape() {}
+};
+
+struct DocNamed
+{
+	virtual ~DocNamed() {}
+	std::string name;
+};
+
+struct DocCircle : DocNamed, DocShape
+{
+	double radius = 2.0;
+};
+//code
+
+ExampleFunc
+{
+	//code
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerBase<DocCircle, DocNamed, DocShape>();
+
+	DocCircle circle;
+	DocShape * shape = &circle;
+	ASSERT(metapp::getDynamicMetaType(shape) == metapp::getMetaType<DocCircle>());
+	// DocShape is not the first base of DocCircle, the address is adjusted.
+	const metapp::Variant ref = metapp::getDynamicReference(shape);
+	ASSERT(&ref.get<DocCircle &>() == &circle);
+	ASSERT(ref.get<DocCircle &>().radius == 2.0);
+	//code
+}
+
+/*desc
+`tests/benchmark/benchmark_metaclass.cpp` finds the dynamic type of an `EntityBase *` which has 9 derived classes.
+Calling `dynamic_cast` on each candidate takes 1,364 ms for 10M times, `getDynamicMetaType` takes 290 ms,
+`getDynamicReference` takes 305 ms.
+
 desc*/
@@ -548,6 +548,17 @@ use `cast` without checking `canCast` explicitly because `cast` will check `canC
 as expensive on performance as `cast`.  
 If you want a variant be casted, and allow the cast fail, use `castSilently`, then check if the result is empty.  
 
+#### tryCast
+```c++
+ErrorCode tryCast(Variant * result, const MetaType * toMetaType) const;
+template <typename T>
+ErrorCode tryCast(Variant * result) const;
+```
+
+Similar to `cast`, but returns `ErrorCode::ok` on success and `ErrorCode::badCast` on failure, and never throws.
+On success, the casted Variant is stored in `result`. `result` can be nullptr, then only the cast-ability is checked.  
+Unlike `castSilently`, the result tells whether the cast failed even if the casted value can be empty.  
+
 #### isEmpty
 ```c++
 bool isEmpty() const noexcept;
@@ -58,6 +58,8 @@ All value types, reference, and pointer are constants. The containers are design
 ```c++
 iterator begin() const;
 iterator end() const;
+reverse_iterator rbegin() const;
+reverse_iterator rend() const;
 
 bool empty() const ;
 size_type size() const;
@@ -66,10 +68,23 @@ reference at(const size_type index) const;
 reference operator [] (const size_type index) const;
 ```
 
+`size()` is O(1). `at` and `operator []` are O(1) if the view has only one underlying container
+(such as the views without `MetaClass::flagIncludeBase`), otherwise O(log N) where N is the number of the underlying containers.  
+`at` doesn't check the range, same as `operator []`.  
+
 Note the views have copy/move constructors and copy/move assignment operators. They are copyable and movable.
 
 ## iterator
 
-The iterator is a forward_iterator.
+The iterator is a random_access_iterator, so the views work with the standard algorithms such as `std::lower_bound`,
+and `end() - begin()` is the size.  
+Incrementing and decrementing the iterator are O(1), adding an offset to the iterator is the same complexity as `operator []`.  
+
+## Cached views in MetaClass
+
+The views returned by `MetaClass` with `flagIncludeBase` are cached in the `MetaClass`,
+so getting the view doesn't traverse the class hierarchy again.
+The cache is rebuilt when the items in the class or its base classes change, or when base classes or `MetaRepo` are registered,
+after the view is built. Registering items in unrelated classes doesn't rebuild the cache.  
 
 desc*/
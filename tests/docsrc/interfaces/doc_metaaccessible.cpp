@@ -46,6 +46,10 @@ const metapp::MetaAccessible * metaAccessible = metaType->getMetaAccessible();
 Pointer, T * (tkPointer)  
 Member data pointer, T C::* (tkMemberPointer)  
 Accessor (tkAccessor)  
+std::shared_ptr (tkStdSharedPtr)  
+std::unique_ptr (tkStdUniquePtr)  
+std::variant (tkStdVariant)  
+std::any (tkStdAny)  
 
 ## MetaAccessible constructor
 
@@ -78,6 +82,9 @@ const MetaType * getValueType(const Variant & accessible);
 
 Returns the meta type of the value.  
 For Accessor, returns the meta type of `Accessor::ValueType`.  
+For `std::variant`, returns the meta type of the active alternative, or meta type of `void` if the variant is valueless.  
+For `std::any`, returns the meta type of the held value, or meta type of `void` if the `std::any` is empty
+or the held type is not registered (see `registerStdAnyType` below).  
 
 #### isReadOnly
 
@@ -115,6 +122,20 @@ For member data pointer `T C::*`, `instance` is used to access the value in the
 constness as the `instance`. For example, if `instance` is a const object, or pointer to const object, the returned Variant
 is a referent to const value. The same for `volatile` and `const volatile`.  
 For Accessor, `instance` is passed to the accessor. The returned Variant is the value get from the accessor.  
+For `std::variant` and `std::any`, `instance` is ignored. The returned Variant is a reference to the held value,
+so the value is not copied. If the `std::variant` is valueless or the `std::any` is empty, an empty Variant is returned.  
+`std::variant` finds the alternative with a jump table indexed by `std::variant::index()`.
+`std::any` only provides `std::type_info` of the held value, so the types held in `std::any` must be registered
+by `registerStdAnyType`, otherwise `UnsupportedException` is thrown. The fundamental types, `std::string` and `std::wstring`
+are registered by default.  
+
+```c++
+template <typename T>
+void registerStdAnyType();
+```
+
+`registerStdAnyType` is declared in `metapp/metatypes/std_any.h`. It's thread safe.
+Registering a type which is already registered does nothing. A registered type can't be unregistered. Finding the registered type doesn't lock.  
 `instance` can be value, reference, pointer, `std::shared_ptr`, `std::unique_ptr`, etc.  
 
 For implementor: we may get the actual pointer from `instance` by using `metapp::getPointer`, get the pointed type
@@ -129,6 +150,9 @@ void set(const Variant & accessible, const Variant & instance, const Variant & v
 ```
 
 Set a new value.  
+For `std::variant`, if the type of `value` is exactly one of the alternatives, the alternative becomes active,
+otherwise `value` is casted to the active alternative.  
+For `std::any`, `value` is casted to the type of the held value. The held type must be registered by `registerStdAnyType`.  
 
 #### isStatic
 
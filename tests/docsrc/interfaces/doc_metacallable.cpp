@@ -66,11 +66,20 @@ MetaCallable(
 	const MetaType * (*getParameterType)(const Variant & callable, const int index),
 	int (*rankInvoke)(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments),
 	bool (*canInvoke)(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments),
-	Variant (*invoke)(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments)
+	Variant (*invoke)(const Variant & callable, const Variant & instance, const ArgumentSpan & arguments),
+	void (*invokeBatch)(
+		const Variant & callable,
+		const ArgumentSpan & instances,
+		const ArgumentColumnSpan & argumentColumns,
+		const ResultColumnSpan & resultColumn
+	) = nullptr,
+	Variant (*invokeRef)(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments) = nullptr
 );
 ```
 
-All arguments are function pointers. All pointers must point to valid functions.  
+All arguments are function pointers. All pointers must point to valid functions, except `invokeBatch` and `invokeRef` which can be nullptr.  
+If `invokeBatch` is nullptr, `MetaCallable::invokeBatch` invokes the callable row by row using `invoke`.  
+If `invokeRef` is nullptr, `MetaCallable::invokeRef` converts the arguments to `Variant` and calls `invoke`.  
 The meaning of each functions are same as the member functions listed below.
 
 ## MetaCallable member functions
@@ -192,6 +201,50 @@ Invokes the callable, returns the result of the callable. If the callable doesn'
 then empty Variant is returned (Variant::isEmpty() is true).  
 Parameter `instance` can be value, reference, pointer, `std::shared_ptr`, `std::unique_ptr`, etc.  
 
+#### invokeBatch
+
+```c++
+void invokeBatch(
+	const Variant & callable,
+	const ArgumentSpan & instances,
+	const ArgumentColumnSpan & argumentColumns,
+	const ResultColumnSpan & resultColumn
+) const;
+```
+
+Invokes the callable many times with arguments in columns, and stores the results in `resultColumn`.  
+The definitions are,  
+```c++
+using ArgumentColumnSpan = metapp::span<const ArgumentSpan>;
+using ResultColumnSpan = metapp::span<Variant>;
+```
+Each element in `argumentColumns` is a column of arguments for one parameter, all columns must have the same size, which is the row count.
+Row `i` is invoked with `argumentColumns[0][i], argumentColumns[1][i], ...`.  
+`instances` can be empty (for non-member callable), has one element that's used for all rows, or has one element per row.  
+`resultColumn` can be empty, then the results are discarded. Otherwise its size must equal to the row count.  
+If the sizes don't match, `IllegalArgumentException` is raised.  
+The result is the same as calling `invoke` on each row, but it's much faster for functions, member functions,
+`std::function` and constructors, because the callable is fetched and the argument cast is planned only once for the whole batch.
+If all rows in a column have the same type as the first row, and the type matches the parameter exactly,
+the arguments are passed without any cast.  
+For overloaded function (tkOverloadedFunction), if every column has the same type on all rows, the overload is
+resolved only once on the first row.  
+
+#### invokeRef
+
+```c++
+Variant invokeRef(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments) const;
+```
+
+Same as `invoke`, but the arguments are `VariantRef` instead of `Variant`. The definition is,  
+```c++
+using ArgumentRefSpan = metapp::span<const VariantRef>;
+```
+For functions, member functions, `std::function` and constructors, an argument which type matches the parameter exactly
+is passed to the function from its address, no `Variant` is constructed. Other arguments are casted the same way as `invoke`.  
+Other callables, such as overloaded function, convert the arguments to `Variant` and call `invoke`.  
+`callableInvoke` with C++ arguments uses `invokeRef`.  
+
 #### isStatic
 
 ```c++
@@ -274,6 +327,59 @@ void demoArgumentSpan(const metapp::ArgumentSpan & arguments)
 }
 //code
 
+/*desc
+## VariantRef and ArgumentRefSpan
+
+`ArgumentRefSpan` is `metapp::span<const VariantRef>`, it's used to pass arguments to `MetaCallable::invokeRef`.  
+`VariantRef` is declared in the header `metapp/variantref.h`. It's a non-owning view of a value, which is a pointer to
+the meta type and the address of the value. `VariantRef` is trivially copyable and has the size of two pointers, so an array
+of `VariantRef` can be built on the stack without constructing any `Variant`.  
+`VariantRef` doesn't own or extend the lifetime of the value, the value must be alive while the `VariantRef` is used.  
+
+```c++
+class VariantRef
+{
+public:
+	template <typename T>
+	static VariantRef reference(T && value);
+
+	VariantRef() noexcept;
+	VariantRef(const MetaType * metaType, void * address) noexcept;
+	VariantRef(const Variant & var) noexcept;
+
+	const MetaType * getMetaType() const noexcept;
+	void * getAddress() const noexcept;
+	bool isEmpty() const noexcept;
+
+	template <typename T>
+	typename std::remove_reference<T>::type & get() const;
+
+	Variant toVariant() const;
+};
+```
+
+`reference` refers to `value`, the meta type is `T &`.  
+The constructor from `Variant` refers to the value in the `Variant`, or the object which the `Variant` refers to.
+So an existing `ArgumentSpan` can be converted to `ArgumentRefSpan` element by element.  
+`get` returns the value as `T &` without any check or cast, `T` must be the type of the value.  
+`toVariant` returns a `Variant` which refers to the value if the meta type is a reference, otherwise returns a copy of the value.  
+desc*/
+
+ExampleFunc
+{
+	//code
+	metapp::Variant callable(std::function<std::string (const std::string &, int)>(
+		[](const std::string & a, int b) {
+			return a + std::to_string(b);
+		}
+	));
+	const std::string a = "a";
+	const int b = 5;
+	const metapp::VariantRef arguments[] { metapp::VariantRef::reference(a), metapp::VariantRef::reference(b) };
+	ASSERT(metapp::callableInvokeRef(callable, nullptr, arguments).get<const std::string &>() == "a5");
+	//code
+}
+
 /*desc
 ## Non-member utility functions
 
@@ -401,6 +507,14 @@ Returns an iterator to the element that's best matched to `arguments` in the ran
 If no matched callable, `last` is returned.  
 `Iterator` must be the iterator to `Variant` or `MetaItem`.
 
+#### callableInvokeRef
+
+```c++
+Variant callableInvokeRef(const Variant & callable, const Variant & instance, const ArgumentRefSpan & arguments);
+```
+
+Shortcut for `MetaCallable::invokeRef()`.
+
 #### callableIsStatic
 
 ```c++
@@ -412,6 +526,19 @@ inline bool callableIsStatic(const Variant & callable)
 
 Shortcut for `MetaCallable::isStatic()`.
 
+#### callableInvokeBatch
+
+```c++
+void callableInvokeBatch(
+	const Variant & callable,
+	const ArgumentSpan & instances,
+	const ArgumentColumnSpan & argumentColumns,
+	const ResultColumnSpan & resultColumn
+);
+```
+
+Shortcut for `MetaCallable::invokeBatch()`.
+
 ## MetaCallable can cast to std::function
 
 Any `MetaCallable` can cast to `std::function` if,
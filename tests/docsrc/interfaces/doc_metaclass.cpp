@@ -515,3 +515,86 @@ MetaItemView getTypeView(const Flags flags = flagIncludeBase) const;
 Returns a MetaItemView for all registered types.  
 
 desc*/
+
+/*desc
+## MetaClass member functions for querying meta data
+
+The query functions find the items by the signatures of callables or by annotations.
+The indexes are built on the first query, and rebuilt automatically after the items in the class or the repo change,
+registering in other classes or repos doesn't rebuild them. So a query doesn't iterate all registered items.  
+The returned `MetaItemPointerList` is `std::vector<const MetaItem *>`. The items are in the order of the classes,
+same as the views, then in the order they are registered.  
+For overloaded callables, the item is returned if any of the overloads matches, and it's returned only once.  
+
+#### findCallablesByArity
+
+```c++
+MetaItemPointerList findCallablesByArity(const int arity, const Flags flags = flagIncludeBase) const;
+```
+
+Returns the callables which can be invoked with `arity` arguments.
+A callable with default arguments matches any arity in its range, a variadic function matches any arity not less than its minimum.  
+
+#### findCallablesByParameter
+
+```c++
+MetaItemPointerList findCallablesByParameter(
+	const int arity,
+	const int parameterIndex,
+	const MetaType * parameterType,
+	const Flags flags = flagIncludeBase
+) const;
+```
+
+Returns the callables which can be invoked with `arity` arguments, and the parameter at `parameterIndex` is `parameterType`.
+References are ignored, so `const T &`, `T &`, and `T` are all matched by `getMetaType<T>()`.
+Variadic functions are not matched.  
+
+#### findCallablesByReturnType
+
+```c++
+MetaItemPointerList findCallablesByReturnType(const MetaType * returnType, const Flags flags = flagIncludeBase) const;
+```
+
+Returns the callables which return `returnType`. References are ignored.  
+
+#### findItemsByAnnotation
+
+```c++
+MetaItemPointerList findItemsByAnnotation(const std::string & name, const Flags flags = flagIncludeBase) const;
+```
+
+Returns the items (accessibles, callables, variables, and types) which have annotation `name`.  
+
+#### findItemsByAnnotationValue
+
+```c++
+MetaItemPointerList findItemsByAnnotationValue(
+	const std::string & name,
+	const Variant & value,
+	const Flags flags = flagIncludeBase
+) const;
+```
+
+Returns the items which have annotation `name` and the annotation value equals to `value`.
+Only strings and arithmetic values (including enums) are comparable. Strings are compared as `std::string`,
+arithmetic values are compared by value, so annotation `1` matches `value` `1.0`.  
+
+**Example**  
+desc*/
+
+ExampleFunc
+{
+	//code
+	const metapp::MetaClass * metaClass = metapp::getMetaType<CaClass>()->getMetaClass();
+
+	// Both overloads of "add" have int parameters, "add" is returned once.
+	const metapp::MetaItemPointerList byParameter = metaClass->findCallablesByParameter(3, 2, metapp::getMetaType<int>());
+	ASSERT(byParameter.size() == 1);
+	ASSERT(byParameter[0]->getName() == "add");
+
+	const metapp::MetaItemPointerList byReturnType = metaClass->findCallablesByReturnType(metapp::getMetaType<std::string>());
+	ASSERT(byReturnType.size() == 1);
+	ASSERT(byReturnType[0]->getName() == "greeting");
+	//code
+}
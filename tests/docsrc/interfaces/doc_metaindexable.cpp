@@ -58,11 +58,13 @@ MetaIndexable(
 	const MetaType * (*getValueType)(const Variant & indexable, const std::size_t index),
 	void (*resize)(const Variant & indexable, const std::size_t size),
 	Variant (*get)(const Variant & indexable, const std::size_t index),
-	void (*set)(const Variant & indexable, const std::size_t index, const Variant & value)
+	void (*set)(const Variant & indexable, const std::size_t index, const Variant & value),
+	void * (*getData)(const Variant & indexable) = nullptr,
+	void * (*getElementAddress)(const Variant & indexable, const std::size_t index) = nullptr
 );
 ```
 
-All arguments are function pointers. All pointers must point to valid function, except that `resize` can be nullptr.  
+All arguments are function pointers. All pointers must point to valid function, except that `resize`, `getData` and `getElementAddress` can be nullptr.  
 The meaning of each functions are same as the member functions listed below.
 
 ## MetaIndexable member functions
@@ -96,19 +98,22 @@ public:
 	std::size_t getSize() const;
 	bool isResizable() const;
 	bool isUnknownSize() const;
+	bool isRandomAccess() const;
 
 	void setResizable(const bool value);
 	void setUnknowSize(const bool value);
+	void setRandomAccess(const bool value);
 };
 ```
 
-The constructors, `setResizable`, `setUnknowSize` are used by `MetaIndexable` implementations.  
-'getSize', `isResizable`, `isUnknownSize` are used by `MetaIndexable` users.  
+The constructors, `setResizable`, `setUnknowSize`, `setRandomAccess` are used by `MetaIndexable` implementations.  
+'getSize', `isResizable`, `isUnknownSize`, `isRandomAccess` are used by `MetaIndexable` users.  
 
 `size` is the number of elements in the indexable.  
 `resizable` means whether the indexable can be changed to another size by calling `resize`.  
 `unknownSize` is false by default for most cases, exception the type `T[]` has true unknownSize. If unknownSize is true,
 both `size` and `resizable` don't make sense.  
+`randomAccess` is true by default, it means `get` and `set` have constant time complexity. For `std::list`, randomAccess is false.  
 
 For `std::pair`, size is 2, resizable is false.  
 For `std::tuple`, size is the tuple size, resizable is false.  
@@ -163,6 +168,31 @@ void (*set)(const Variant & indexable, const std::size_t index, const Variant &
 
 Sets the element at `index` with `value`. The `value` will be casted to the element type, if the cast fails, exception `metapp::BadCastException` is thrown.  
 
+#### getData
+
+```c++
+void * getData(const Variant & indexable) const;
+```
+
+Returns the pointer to the first element if the elements are stored contiguously, otherwise returns nullptr.  
+The element at `index` can be accessed as `static_cast<T *>(getData(indexable))[index]`, where `T` is the element type.  
+For `std::vector` (except `std::vector<bool>`), `std::array`, `T[]` and `T[N]`, the function returns the pointer to the elements.
+For an empty `std::vector`, nullptr is returned.  
+For other containers, or if the `getData` argument in MetaIndexable constructor is nullptr, the function returns nullptr.  
+
+#### getElementAddress
+
+```c++
+void * getElementAddress(const Variant & indexable, const std::size_t index) const;
+```
+
+Returns the address of the element at `index` if each element is stored as an object in the container, otherwise returns nullptr.  
+Unlike `getData`, the elements don't need to be contiguous, so the function works for `std::deque`.
+It lets the code access the elements of the known type without creating a Variant for each element.  
+For `std::deque`, `std::vector` (except `std::vector<bool>`) and `std::array`, the function returns the address of the element.
+If `index` is out of range, nullptr is returned.  
+For other containers, or if the `getElementAddress` argument in MetaIndexable constructor is nullptr, the function returns nullptr.  
+
 ## Non-member utility functions
 
 Below free functions are shortcut functions to use the member functions in `MetaIndexable`.  
@@ -188,6 +218,16 @@ inline void indexableSet(const Variant & indexable, const std::size_t index, con
 {
 	indexable.getMetaType()->getMetaIndexable()->set(indexable, index, value);
 }
+
+inline void * indexableGetData(const Variant & indexable)
+{
+	return indexable.getMetaType()->getMetaIndexable()->getData(indexable);
+}
+
+inline void * indexableGetElementAddress(const Variant & indexable, const std::size_t index)
+{
+	return indexable.getMetaType()->getMetaIndexable()->getElementAddress(indexable, index);
+}
 ```
 
 desc*/
@@ -0,0 +1,137 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+
+#include <vector>
+#include <array>
+
+/*desc
+# Bulk conversion of arithmetic arrays
+
+## Overview
+
+`bulkConvert` converts arrays of arithmetic values between types, such as `int` to `double`, or `float` to `long long`.  
+Converting the elements one by one through reflection (`Variant::cast`, `indexableSet`) creates a Variant and
+dispatches the casting for each element. `bulkConvert` dispatches only once for the whole array, by the source and destination type kinds,
+then runs a kernel which converts the elements in a loop.  
+On x86 with GCC or Clang, the kernels for the common conversions between 32/64 bit signed integers, `float`, and `double`
+are vectorized. The instruction set is detected at runtime, the best one among SSE2, AVX2 and AVX-512 is used.
+The other conversions use scalar loops, which can be vectorized by the compiler. Conversions between integers
+with the same size and signedness are plain memory copy.  
+The result is the same as `static_cast` for each element, except that the conversions from floating point to integer saturate.
+`static_cast` of a floating point value out of the range of the integer is undefined behavior, and the vector instructions
+give the minimum integer for it. `bulkConvert` converts NaN to 0, and clamps the values out of range to the minimum or maximum
+of the integer type, the same in the scalar and the vectorized kernels.  
+`bulkConvert` is a standalone utility, `Variant::cast` and `indexableSet` still convert one element at a time.  
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/bulkconvert.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+ExampleFunc
+{
+	//code
+	// Convert raw memory.
+	const int source[] = { 1, 2, 3 };
+	double destination[3];
+	metapp::bulkConvert(source, metapp::tkInt, 3, destination, metapp::tkDouble);
+	ASSERT(destination[2] == 3.0);
+
+	// Convert containers, the destination is resized to the source size.
+	std::array<float, 3> floatArray { { 1.5f, 2.5f, -3.5f } };
+	std::vector<long long> int64List;
+	metapp::bulkConvert(metapp::Variant::reference(floatArray), metapp::Variant::reference(int64List));
+	ASSERT(int64List.size() == 3);
+	ASSERT(int64List[2] == -3);
+	//code
+}
+
+/*desc
+## Functions
+
+#### canBulkConvert
+
+```c++
+bool canBulkConvert(const TypeKind sourceTypeKind, const TypeKind destinationTypeKind);
+```
+
+Returns true if both type kinds are arithmetic.  
+
+#### bulkConvert (raw memory)
+
+```c++
+void bulkConvert(
+	const void * source,
+	const TypeKind sourceTypeKind,
+	const std::size_t count,
+	void * destination,
+	const TypeKind destinationTypeKind
+);
+```
+
+Converts `count` values of type kind `sourceTypeKind` at `source`, to values of type kind `destinationTypeKind` at `destination`.  
+`source` and `destination` must not overlap.  
+If any type kind is not arithmetic, `UnsupportedException` is thrown.  
+
+#### bulkConvert (indexables)
+
+```c++
+std::size_t bulkConvert(const Variant & source, const Variant & destination);
+```
+
+Converts all elements in `source` to `destination`. Both must implement `MetaIndexable`, otherwise `UnsupportedException` is thrown.  
+If `destination` is resizable, it's resized to the size of `source`.
+If `destination` is smaller than `source` after resizing, `OutOfRangeException` is thrown.  
+If both containers are contiguous (`MetaIndexable::getData` is not nullptr), such as `std::vector`, `std::array` and C array,
+and the value types are arithmetic, the raw memory `bulkConvert` is used.
+Otherwise, the elements are converted one by one using `MetaIndexable::get` and `MetaIndexable::set`.
+The arithmetic elements are still converted by the kernels, so they saturate the same as the contiguous containers.  
+Returns the number of converted elements.  
+
+#### getBulkConvertIsa and setBulkConvertIsa
+
+```c++
+enum class BulkConvertIsa
+{
+	scalar,
+	sse2,
+	avx2,
+	avx512
+};
+
+BulkConvertIsa getBulkConvertIsa();
+BulkConvertIsa setBulkConvertIsa(const BulkConvertIsa isa);
+```
+
+`getBulkConvertIsa` returns the instruction set used by the kernels. By default it's the best one supported by the CPU.  
+`setBulkConvertIsa` limits the instruction set, it's mainly for testing and benchmarking.
+If the CPU doesn't support `isa`, the best supported instruction set lower than `isa` is used.
+Returns the instruction set actually used.  
+`BulkConvertIsa::avx512` requires AVX512F and AVX512DQ.  
+
+desc*/
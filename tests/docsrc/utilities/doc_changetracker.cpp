@@ -0,0 +1,235 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+#include "metapp/interfaces/metaclass.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+/*desc
+# ChangeTracker -- find the changed fields of reflected objects
+
+## Overview
+
+A replication or UI refresh loop can find the changed properties by reading every property with `accessibleGet`
+in each tick and comparing it with the value in the previous tick. The cost is proportional to the number of all properties,
+even if only a few of them are changed.
+`ChangeTracker` records the writes instead. The instances to track are added by `ChangeTracker::track`.
+The writes through `accessibleSet`, `tryAccessibleSet`, `indexableSet`, and `mappableSet` to the tracked instances are recorded
+in a side table, the objects are not changed. Each write increases a global generation, stores it to the field,
+and moves the field to the head of a list in the instance, and the instance to the head of a global list.
+So the changes since a generation are listed by visiting only the changed instances and fields.
+
+The hooks in `accessibleSet` and the other functions are compiled only if the macro `METAPP_ENABLE_CHANGE_TRACKING` is defined,
+the same as the profiler hooks and `METAPP_ENABLE_PROFILING`. Without the macro, there is no overhead at all, and only `markChanged`
+records the changes. The macro must be defined for all translation units which include metapp. The CMake option
+`METAPP_ENABLE_CHANGE_TRACKING` defines it for the `metapp` target and the targets linking it.  
+With the macro, when there is no tracked instance, the hooks only check an atomic counter. When some instances are tracked,
+the hooks check the address of the written object in a counting filter without locking, so the writes to the untracked objects
+don't contend with each other.
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/changetracker.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+//code
+struct DocEntity
+{
+	std::string name;
+	int health;
+	int score;
+	std::map<std::string, int> stats;
+};
+
+template <>
+struct metapp::DeclareMetaType <DocEntity> : metapp::DeclareMetaTypeBase <DocEntity>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<DocEntity>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("name", &DocEntity::name);
+				mc.registerAccessible("health", &DocEntity::health);
+				mc.registerAccessible("score", &DocEntity::score);
+				mc.registerAccessible("stats", &DocEntity::stats);
+			}
+		);
+		return &metaClass;
+	}
+};
+//code
+
+ExampleFunc
+{
+	//code
+	std::vector<DocEntity> entityList(3);
+	for(DocEntity & entity : entityList) {
+		metapp::ChangeTracker::track(&entity);
+	}
+	// The container member is tracked as another instance.
+	const metapp::Variant stats = metapp::accessibleGet(
+		metapp::getMetaType<DocEntity>()->getMetaClass()->getAccessible("stats").asAccessible(),
+		&entityList[0]
+	);
+	metapp::ChangeTracker::track(stats);
+
+	const metapp::MetaClass * metaClass = metapp::getMetaType<DocEntity>()->getMetaClass();
+	std::uint64_t generation = metapp::ChangeTracker::getGeneration();
+
+	// A tick writes some fields.
+	metapp::accessibleSet(metaClass->getAccessible("health").asAccessible(), &entityList[2], 90);
+	metapp::accessibleSet(metaClass->getAccessible("score").asAccessible(), &entityList[2], 5);
+	metapp::accessibleSet(metaClass->getAccessible("health").asAccessible(), &entityList[2], 80);
+	metapp::mappableSet(stats, "speed", 3);
+
+	// Then the changes are read, the latest first.
+	const std::vector<metapp::ChangedInstance> instanceList = metapp::ChangeTracker::getChangedInstances(generation);
+	ASSERT(instanceList.size() == 2);
+	ASSERT(instanceList[0].address == &entityList[0].stats);
+	ASSERT(instanceList[0].fieldList[0].key.get<const std::string &>() == "speed");
+	ASSERT(instanceList[1].address == &entityList[2]);
+	// health is written twice, it's listed once.
+	ASSERT(instanceList[1].fieldList.size() == 2);
+	ASSERT(instanceList[1].fieldList[0].name == "health");
+	ASSERT(instanceList[1].fieldList[1].name == "score");
+
+	// The next tick starts from the current generation.
+	generation = metapp::ChangeTracker::getGeneration();
+	ASSERT(metapp::ChangeTracker::getChangedFields(&entityList[2], generation).empty());
+
+	// Untrack the instances before they are destroyed.
+	metapp::ChangeTracker::untrack(stats);
+	for(DocEntity & entity : entityList) {
+		metapp::ChangeTracker::untrack(&entity);
+	}
+	//code
+}
+
+/*desc
+## Instances and fields
+
+An instance is identified by the address and the type of the object. The instance passed to `accessibleSet`
+can be a pointer, a reference, or the object in a `Variant`, the write is recorded if it refers to a tracked object
+with the same type. A base class at the same address as the derived object is another instance.
+Untrack the instance before it's destroyed, otherwise another object created at the same address inherits its changes.
+
+The fields are
+
+- The accessibles written by `accessibleSet` and `tryAccessibleSet`. They are identified the same as `Profiler`,
+so the copies of an accessible are the same field. `ChangedField::name` is the name of the accessible in the `MetaClass`
+of the instance or its base classes, it's empty if the accessible is not registered in the `MetaClass`.
+- The indexes written by `indexableSet`, in `ChangedField::index`.
+- The keys written by `mappableSet`, in `ChangedField::key`. Integral and enum keys are identified by the value as `long long`,
+the other keys are identified by the value as `std::string`. The writes with the keys which can't cast to `std::string` are not recorded.
+
+A container member is not a field of its object. To track the writes to its elements, track the container itself,
+for example, the result of `accessibleGet`.
+Writing a member directly in C++ is not recorded, call `ChangeTracker::markChanged` for it.
+
+## ChangedField and ChangedInstance
+
+```c++
+enum class ChangedFieldType
+{
+	accessible,
+	index,
+	key
+};
+
+struct ChangedField
+{
+	ChangedFieldType type;
+	std::uint64_t generation;
+	Variant accessible;
+	std::string name;
+	std::size_t index;
+	Variant key;
+};
+
+struct ChangedInstance
+{
+	void * address;
+	const MetaType * metaType;
+	std::uint64_t generation;
+	std::vector<ChangedField> fieldList;
+};
+```
+
+`generation` is the generation of the last write to the field or the instance.
+
+## ChangeTracker
+
+```c++
+class ChangeTracker
+{
+public:
+	static void track(const Variant & instance);
+	static void untrack(const Variant & instance);
+	static bool isTracked(const Variant & instance);
+	static std::size_t getTrackedCount();
+
+	static std::uint64_t getGeneration();
+	static std::uint64_t getGeneration(const Variant & instance);
+
+	static std::vector<ChangedField> getChangedFields(const Variant & instance, const std::uint64_t sinceGeneration);
+	static std::vector<ChangedInstance> getChangedInstances(const std::uint64_t sinceGeneration);
+
+	static void markChanged(const Variant & instance, const Variant & accessible);
+};
+```
+
+`track` raises `IllegalArgumentException` if instance is a nullptr. Tracking a tracked instance does nothing.
+`getGeneration()` returns the generation of the last write to any tracked instance, it's 0 before any write.
+`getGeneration(instance)` returns the generation of the last write to instance, or 0.
+`getChangedFields` returns the fields of instance written after `sinceGeneration`, and `getChangedInstances` returns the
+instances written after `sinceGeneration` with their fields. The latest written are the first, each field and instance is listed once.
+The time is proportional to the number of the returned fields and instances.
+All functions are thread safe. The recording of the writes to the tracked instances is serialized by a mutex, so the writes
+to the tracked instances in many threads don't scale. The writes to the untracked instances don't take the mutex,
+unless the address collides with a tracked address in the filter.
+
+## Performance
+
+One core, `tests/benchmark/benchmark_changetracker.cpp`, GCC 12, -O3.
+1000 objects with 12 `int` fields, each tick writes 50 fields by `accessibleSet`, then finds the changed fields.
+
+|Method                                               |200 ticks |
+|-----------------------------------------------------|----------|
+|Polling all fields by `accessibleGet`                |89 ms     |
+|`ChangeTracker::getChangedInstances`                 |2 ms      |
+
+`accessibleSet` on an `int` member, 10M times.
+
+|Case                                                 |Time      |
+|-----------------------------------------------------|----------|
+|No instance is tracked                               |468 ms    |
+|Another instance is tracked                          |620 ms    |
+|The instance is tracked                              |1154 ms   |
+
+desc*/
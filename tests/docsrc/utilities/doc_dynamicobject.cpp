@@ -0,0 +1,212 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <vector>
+
+/*desc
+# DynamicObject -- objects with properties defined at running time
+
+## Overview
+
+A scripting layer often creates objects whose properties are defined at running time. Modeling them as
+`std::map<std::string, Variant>` costs a string lookup for each property access.  
+`DynamicObject` stores the property values in slots, its layout is described by a `DynamicShape`, similar to the hidden classes
+in JavaScript engines. Shapes are shared, and are linked by transitions, adding a property to an object transitions the object
+to the child shape. Objects which add the same properties in the same order share the same shape.  
+`DynamicPropertyCache` is an inline cache keyed by shape. It remembers the slot of a property name for the last several shapes,
+if the shape of an object is cached, accessing the property is a shape id comparison and an index.  
+`DynamicProperty` implements `MetaAccessible`, and `DynamicObject` implements `MetaMappable`, so the code which works on accessibles
+or on mappables works on `DynamicObject` unchanged.
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/dynamicobject.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+ExampleFunc
+{
+	//code
+	metapp::DynamicObject point;
+	point.set("x", 3);
+	point.set("y", 5);
+	ASSERT(point.get("x").get<int>() == 3);
+	ASSERT(point.hasProperty("y"));
+	ASSERT(! point.hasProperty("z"));
+
+	// Objects with the same properties added in the same order share the shape.
+	metapp::DynamicObject another;
+	another.set("x", 8);
+	another.set("y", 9);
+	ASSERT(point.getShape() == another.getShape());
+
+	// The cache looks up the slot only once for each shape.
+	metapp::DynamicPropertyCache yCache("y");
+	int sum = 0;
+	for(const metapp::DynamicObject * object : { &point, &another, &point, &another }) {
+		sum += yCache.find(*object)->get<int>();
+	}
+	ASSERT(sum == 28);
+
+	// DynamicProperty is an accessible, it can be used by generic reflection code.
+	metapp::Variant accessible = metapp::DynamicProperty("x");
+	metapp::accessibleSet(accessible, &point, 6);
+	ASSERT(metapp::accessibleGet(accessible, &point).cast<int>().get<int>() == 6);
+
+	// DynamicObject is a mappable.
+	metapp::Variant mappable = metapp::Variant::reference(point);
+	std::vector<std::string> nameList;
+	metapp::mappableForEach(mappable, [&nameList](const metapp::Variant & key, const metapp::Variant & /*value*/) {
+		nameList.push_back(key.get<const std::string &>());
+		return true;
+	});
+	ASSERT(nameList == std::vector<std::string> { "x", "y" });
+	//code
+}
+
+/*desc
+## DynamicShape
+
+```c++
+class DynamicShape
+{
+public:
+	static constexpr std::size_t npos = (std::size_t)-1;
+
+	static const DynamicShape * getRoot();
+
+	std::uint32_t getId() const;
+	const DynamicShape * getParent() const;
+	std::size_t getPropertyCount() const;
+	const std::string & getPropertyName(const std::size_t slot) const;
+	std::size_t findSlot(const std::string & name) const;
+
+	const DynamicShape * addProperty(const std::string & name) const;
+	const DynamicShape * removeProperty(const std::string & name) const;
+};
+```
+
+A shape is the property names in the order of adding, the slot of a property is its index.
+`getRoot` returns the shape without any property. The id is unique and is never 0.  
+`findSlot` returns `npos` if the property doesn't exist.  
+`addProperty` returns the child shape which has `name` in the last slot, the child is created only once.
+It returns `this` if the property exists.  
+`removeProperty` returns the shape without `name`, the slots after `name` are moved forward by one.
+It returns `this` if the property doesn't exist.  
+Shapes are immutable and are never destroyed before the program exits. All functions are thread safe.  
+A shape only stores its parent and the name it adds. The table to look up the names and the slots is built when the shape
+is looked up the first time, by `findSlot` or `getPropertyName`. The shapes which are only passed through while adding properties
+don't build the table, so building an object with N properties costs O(N) memory for the shapes, not O(N²).
+
+## DynamicObject
+
+```c++
+class DynamicObject
+{
+public:
+	DynamicObject();
+	explicit DynamicObject(const DynamicShape * shape);
+
+	const DynamicShape * getShape() const;
+	std::size_t getPropertyCount() const;
+	bool hasProperty(const std::string & name) const;
+
+	const Variant * find(const std::string & name) const;
+	Variant * find(const std::string & name);
+	Variant get(const std::string & name) const;
+	void set(const std::string & name, const Variant & value);
+	bool remove(const std::string & name);
+
+	const Variant & getSlot(const std::size_t slot) const;
+	Variant & getSlot(const std::size_t slot);
+};
+```
+
+The default constructor creates an object with the root shape. The constructor with a shape creates an object which has
+all the properties in the shape, the values are empty, it's useful to create many objects with the same properties.  
+`find` returns nullptr if the property doesn't exist. `get` returns a reference to the value, or an empty Variant if the
+property doesn't exist.  
+`set` adds the property if it doesn't exist. If `value` holds a `Variant`, the inner `Variant` is stored.  
+`remove` returns false if the property doesn't exist.  
+
+`DynamicObject` implements `MetaMappable`. The key is the property name, it's cast to `std::string`. The value type is `Variant`.
+
+## DynamicPropertyCache
+
+```c++
+class DynamicPropertyCache
+{
+public:
+	explicit DynamicPropertyCache(std::string name);
+
+	const std::string & getName() const;
+
+	const Variant * find(const DynamicObject & object) const;
+	Variant * find(DynamicObject & object) const;
+	Variant get(const DynamicObject & object) const;
+	void set(DynamicObject & object, const Variant & value) const;
+};
+```
+
+The cache holds the slots of the last 4 shapes it has seen, including the shapes without the property.
+A cache miss looks up the slot in the shape and replaces an entry.  
+`set` adds the property if it doesn't exist, adding a property is not cached.  
+The cache is thread safe, the objects are not.
+
+## DynamicProperty
+
+```c++
+class DynamicProperty
+{
+public:
+	explicit DynamicProperty(std::string name);
+
+	const std::string & getName() const;
+	const DynamicPropertyCache & getCache() const;
+};
+```
+
+`DynamicProperty` implements `MetaAccessible` using a `DynamicPropertyCache`. The instance is a `DynamicObject`,
+or a pointer or reference to it. The value type is `Variant`, the class type is `DynamicObject`, it's not read only.
+Copies of a `DynamicProperty` share the cache.  
+A `MetaClass` is registered per C++ type, it can't describe the properties of each object. To reflect the properties of an object,
+iterate the names in its shape and create `DynamicProperty` for them.
+
+## Performance
+
+Getting an `int` property of an object with 3 properties 10M times (`tests/benchmark/benchmark_dynamicobject.cpp`, GCC 12, -O3),  
+
+|Method                                                    |Time   |
+|----------------------------------------------------------|-------|
+|`std::map<std::string, Variant>` via `mappableGet`        |593 ms |
+|`DynamicObject::find` by name                             |253 ms |
+|`DynamicPropertyCache::find`                              |137 ms |
+|`DynamicProperty` via `accessibleGet`                     |436 ms |
+|Member data `int C::*` via `accessibleGet`, for reference |428 ms |
+
+desc*/
@@ -0,0 +1,225 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+#include "metapp/interfaces/metaclass.h"
+
+#include <string>
+#include <vector>
+
+/*desc
+# Expression -- compiled expressions over reflected objects
+
+## Overview
+
+A rule such as `items.size() > limit && customer.tier == Tier::gold` can be evaluated against a reflected object by walking
+the syntax tree, looking up each member by name, and computing each operator on `Variant`. Every evaluation then pays for
+the name lookups, the `Variant` objects, and the casts.
+`Expression` compiles the source once for the root `MetaType` to register based bytecode. Each member access and each call
+has an inline cache which is resolved when the expression is compiled, or when it's evaluated the first time.
+Member data are read directly at the offset of the member, accessors and methods are invoked by the resolved callable,
+and the enum values become constants.
+The values which types are known at compiling time, i.e, `bool`, integers, enums, floating points, and `std::string`,
+are kept in typed registers, so the arithmetic and the comparisons on them don't create any `Variant`.
+The values of other types, such as a `Variant` member, are kept in `Variant` registers. The member accesses on them
+have polymorphic inline caches keyed by the dynamic type. Each cache keeps the members of the last four types,
+and a member is looked up by name only once for each type.
+
+`interpret` evaluates the same expression by walking the syntax tree with `Variant`, it gives the same result as `evaluate`.
+It's used to verify and measure the bytecode.
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/expression.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+//code
+enum class DocTier
+{
+	silver,
+	gold
+};
+
+struct DocCustomer
+{
+	std::string name;
+	DocTier tier;
+};
+
+struct DocOrder
+{
+	std::vector<double> items;
+	DocCustomer customer;
+	int limit;
+
+	double total() const {
+		double result = 0;
+		for(const double item : items) {
+			result += item;
+		}
+		return result;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <DocTier> : metapp::DeclareMetaTypeBase <DocTier>
+{
+	static const metapp::MetaEnum * getMetaEnum() {
+		static const metapp::MetaEnum metaEnum([](metapp::MetaEnum & me) {
+			me.registerValue("silver", DocTier::silver);
+			me.registerValue("gold", DocTier::gold);
+		});
+		return &metaEnum;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <DocCustomer> : metapp::DeclareMetaTypeBase <DocCustomer>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<DocCustomer>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("name", &DocCustomer::name);
+				mc.registerAccessible("tier", &DocCustomer::tier);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <DocOrder> : metapp::DeclareMetaTypeBase <DocOrder>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<DocOrder>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerType("Tier", metapp::getMetaType<DocTier>());
+				mc.registerAccessible("items", &DocOrder::items);
+				mc.registerAccessible("customer", &DocOrder::customer);
+				mc.registerAccessible("limit", &DocOrder::limit);
+				mc.registerCallable("total", &DocOrder::total);
+			}
+		);
+		return &metaClass;
+	}
+};
+//code
+
+ExampleFunc
+{
+	//code
+	DocOrder order;
+	order.items = { 1.5, 12.0, 4.25 };
+	order.customer = { "Bob", DocTier::gold };
+	order.limit = 2;
+
+	// Compile once, evaluate many times.
+	const metapp::Expression rule = metapp::Expression::compile<DocOrder>(
+		"items.size() > limit && customer.tier == Tier::gold"
+	);
+	ASSERT(rule.evaluateBool(metapp::Variant::reference(order)));
+
+	// The root can also be a pointer to the object.
+	order.limit = 3;
+	ASSERT(! rule.evaluateBool(&order));
+
+	const metapp::Expression price = metapp::Expression::compile<DocOrder>("total() * 2 - 1");
+	ASSERT(price.evaluate(metapp::Variant::reference(order)).get<double>() == 34.5);
+
+	const metapp::Expression greeting = metapp::Expression::compile<DocOrder>("\"Hello \" + customer.name");
+	ASSERT(greeting.evaluate(&order).get<const std::string &>() == "Hello Bob");
+	//code
+}
+
+/*desc
+## Syntax
+
+The operators, from the lowest precedence,
+
+|Operators                   |Description                                       |
+|----------------------------|--------------------------------------------------|
+|`\|\|`                      |Logical or, short circuit                         |
+|`&&`                        |Logical and, short circuit                        |
+|`==` `!=`                   |Equality                                          |
+|`<` `<=` `>` `>=`           |Comparison                                        |
+|`+` `-`                     |Addition and subtraction, `+` concatenates strings|
+|`*` `/` `%`                 |Multiplication, division, and remainder           |
+|`!` `-`                     |Unary not and negation                            |
+|`a.b` `a.f(x, y)`           |Member access and call                            |
+
+An identifier without an object is a member of the root object. `Type::Value` is an enum value, `Type` is looked up
+in the types registered in the root class, then in the `MetaRepo`s.
+The literals are integers (`long long`), floating points (`double`), strings in double quotes, `true`, and `false`.
+`size()` is available on the indexable types, such as `std::vector`, if they don't have a callable named `size`.
+
+Integers, including enums and unsigned integers, are computed as `long long`, and wrap around on overflow.
+If either operand is a floating point, the operator is computed as `double`.
+
+## Expression
+
+```c++
+class Expression
+{
+public:
+	Expression(const MetaType * rootMetaType, const std::string & source);
+
+	template <typename T>
+	static Expression compile(const std::string & source);
+
+	const MetaType * getRootMetaType() const;
+	const std::string & getSource() const;
+
+	Variant evaluate(const Variant & root) const;
+	bool evaluateBool(const Variant & root) const;
+	Variant interpret(const Variant & root) const;
+};
+```
+
+The constructor and `compile` parse and compile `source` for the root type. The syntax errors and the unknown names
+raise `IllegalArgumentException`, the operators on unsupported types raise `UnsupportedException`.
+`root` is the object, a reference to the object, or a pointer to the object. Its type must be the root type,
+otherwise `IllegalArgumentException` is raised.
+`evaluate` returns a `bool`, `long long`, `double`, `std::string`, or a `Variant` which refers to the object
+if the result is an object.
+`evaluateBool` evaluates the expression as a condition, integers and floating points are true if they are not zero.
+It doesn't box the result in a `Variant`, so it's the fastest way to evaluate rules.
+Integer division by zero and accessing a member of a nullptr object raise `IllegalArgumentException`.
+A compiled `Expression` can be evaluated by many threads at the same time.
+
+## Performance
+
+One core, `tests/benchmark/benchmark_expression.cpp`, GCC 12, -O3, 1M evaluations.
+"Lookups" is the first rule written in C++ which looks up the members by name in each evaluation.
+
+|Expression                                                           |interpret |evaluateBool|Lookups   |
+|---------------------------------------------------------------------|----------|------------|----------|
+|`items.size() > limit && customer.tier == Tier::gold`                |939 ms    |76 ms       |508 ms    |
+|`(customer.age * 2 + limit * 3) % 7 < 5 && discount * 100 >= 10.0 && customer.name == "Bob"`|1324 ms   |116 ms      |          |
+|`discounted(limit * 50) > 80`                                        |453 ms    |89 ms       |          |
+
+desc*/
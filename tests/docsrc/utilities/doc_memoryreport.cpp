@@ -0,0 +1,184 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+#include "metapp/metarepo.h"
+
+#include <string>
+#include <sstream>
+
+/*desc
+# MemoryReport -- memory used by the meta data
+
+## Overview
+
+With thousands of reflected classes, the meta data (the item lists in `MetaRepo` and `MetaClass`, the name indexes,
+the `MetaItem` data blocks, the annotations, the `OverloadedFunction` lists, etc) can use a lot of memory.  
+`MemoryReport` walks the registered repos and classes, and reports the bytes and the number of allocations
+per repo, per class, and per kind of structure.  
+The sizes of the standard containers are estimated from the layouts in the common standard libraries (libstdc++, libc++, MSVC),
+the overhead of the memory allocator is not included. The blocks shared by several items (such as copied `MetaItem`,
+or copied `MetaRepo`) are counted once. The caches built on demand (such as the views including base classes and the
+indexes for queries) are not included.  
+
+`tests/benchmark/benchmark_memory.cpp` prints the report for a synthetic registry, it's the baseline to compare
+more compact meta data layouts.
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/memoryreport.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+//code
+namespace {
+
+int add(const int a, const int b)
+{
+	return a + b;
+}
+
+} // namespace
+//code
+
+ExampleFunc
+{
+	//code
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerCallable("add", &add).registerAnnotation("description", std::string("Add two integers"));
+
+	metapp::MemoryReport report;
+	report.addMetaRepo(&metaRepo, "myRepo");
+	const metapp::MemoryReportEntry & entry = report.getEntryList()[0];
+	ASSERT(entry.name == "myRepo");
+	// One MetaItem data block is allocated.
+	ASSERT(entry.getUsage(metapp::MemoryKind::itemData).allocationCount == 1);
+	ASSERT(report.getTotal().byteCount > 0);
+
+	// Writes the totals per kind and per source, then the largest entries.
+	std::ostringstream stream;
+	report.write(stream);
+	//code
+}
+
+/*desc
+## MemoryKind
+
+```c++
+enum class MemoryKind
+{
+	object,
+	itemList,
+	nameIndex,
+	itemData,
+	name,
+	annotation,
+	target,
+	overloadedFunction,
+	inheritance
+};
+```
+
+`object` is the `MetaRepo`, `MetaClass`, or `MetaEnum` object itself, it's usually not on the heap, so there is no allocation.  
+`itemList` is the item lists (`std::deque<MetaItem>`) and the blocks holding them.  
+`nameIndex` is the `std::map` indexes by name, type kind, meta type, or enum value.  
+`itemData` is the shared data blocks of `MetaItem`.  
+`name` is the heap buffers of the item names. Short names are stored in the `std::string` (small string optimization)
+and don't allocate.  
+`annotation` is the annotation maps, including the names and the values.  
+`target` is the heap storage of the registered `Variant`, such as accessors. The size of the object is not known,
+only the shared block header is counted in bytes.  
+`overloadedFunction` is the `OverloadedFunction` objects and their callable lists.  
+`inheritance` is the base and derived classes registered in `MetaRepo`.  
+
+`const char * getMemoryKindName(const MemoryKind kind)` returns the name of the kind.
+
+## MemoryUsage and MemoryReportEntry
+
+```c++
+struct MemoryUsage
+{
+	std::size_t byteCount;
+	std::size_t allocationCount;
+};
+
+struct MemoryReportEntry
+{
+	enum class Source
+	{
+		metaRepo,
+		metaClass,
+		metaEnum
+	};
+
+	Source source;
+	std::string name;
+	const void * address;
+	std::array<MemoryUsage, memoryKindCount> usageList;
+
+	const MemoryUsage & getUsage(const MemoryKind kind) const;
+	MemoryUsage getTotal() const;
+};
+```
+
+`address` is the address of the `MetaRepo`, `MetaClass`, or `MetaEnum`.
+
+## MemoryReport
+
+```c++
+void addMetaRepo(const MetaRepo * metaRepo, const std::string & name = std::string());
+```
+
+Adds `metaRepo`, the `MetaClass` and `MetaEnum` of the registered types (named as "name::TypeName"),
+and the sub repos (named as "name::subName"). The "name::" is omitted if `name` is empty.
+A source which is already added is skipped.
+
+```c++
+void addMetaClass(const MetaClass * metaClass, const std::string & name);
+void addMetaEnum(const MetaEnum * metaEnum, const std::string & name);
+```
+
+Adds the items registered in `metaClass` or `metaEnum`, not including the base classes.
+
+```c++
+void addAllMetaRepos();
+```
+
+Adds all `MetaRepo` in `MetaRepoList`, the repos are named as "repo#index".
+
+```c++
+const std::vector<MemoryReportEntry> & getEntryList() const;
+MemoryUsage getTotal() const;
+MemoryUsage getTotal(const MemoryKind kind) const;
+MemoryUsage getTotal(const MemoryReportEntry::Source source) const;
+void write(std::ostream & stream, const std::size_t maxEntryCount = 20) const;
+```
+
+`write` writes the totals per kind and per source, then at most `maxEntryCount` entries which use most bytes.
+`maxEntryCount` 0 means all entries.  
+
+`MemoryReport` is not thread safe, the meta data must not be modified when it's being added.
+
+desc*/
@@ -0,0 +1,139 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+#include "metapp/metarepo.h"
+
+/*desc
+# NameIndex -- prefix and fuzzy search over registered names
+
+## Overview
+
+`NameIndex` indexes the names of registered meta items in a trie, to find the items by name prefix
+(such as auto completion in an editor) or by approximate name (such as "did you mean" suggestions).  
+The sources of names are `MetaRepo`, `MetaClass`, and `MetaEnum`. When a `MetaRepo` is added,
+the `MetaClass` and `MetaEnum` of the types registered in the repo, and the sub repos, are added automatically.  
+The index is updated incrementally. When items are registered to the sources after the index is built,
+the next query indexes only the new items.  
+A prefix query costs time proportional to the length of the prefix plus the number of returned items,
+it doesn't depend on the number of indexed names.  
+
+`NameIndex` is not thread safe. The sources must outlive the index.
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/nameindex.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+ExampleFunc
+{
+	//code
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerVariable("maxWidth", 100);
+	metaRepo.registerVariable("maxHeight", 50);
+	metaRepo.registerVariable("minWidth", 10);
+
+	metapp::NameIndex nameIndex;
+	nameIndex.addMetaRepo(&metaRepo);
+
+	metapp::MetaItemPointerList itemList = nameIndex.findByPrefix("max");
+	// The items are sorted by name
+	ASSERT(itemList.size() == 2);
+	ASSERT(itemList[0]->getName() == "maxHeight");
+	ASSERT(itemList[1]->getName() == "maxWidth");
+
+	// "maxWidht" is a typo, "maxWidth" is in distance 2.
+	itemList = nameIndex.findFuzzy("maxWidht", 2);
+	ASSERT(itemList.size() == 1);
+	ASSERT(itemList[0]->getName() == "maxWidth");
+
+	// The new item is indexed in the next query.
+	metaRepo.registerVariable("maxDepth", 20);
+	ASSERT(nameIndex.findByPrefix("max").size() == 3);
+	//code
+}
+
+/*desc
+## Member functions
+
+#### Add sources
+
+```c++
+void addMetaRepo(const MetaRepo * metaRepo);
+void addMetaClass(const MetaClass * metaClass);
+void addMetaEnum(const MetaEnum * metaEnum);
+void addMetaType(const MetaType * metaType);
+void addItem(const MetaItem & item);
+```
+
+`addMetaRepo` adds the accessibles, callables, variables, types, and sub repos in `metaRepo`.
+The `MetaClass` and `MetaEnum` of the registered types are added too.  
+`addMetaClass` adds the items in `metaClass`, not including the base classes. Add the base classes separately if needed.  
+`addMetaEnum` adds the enum values.  
+`addMetaType` adds the `MetaClass` and `MetaEnum` of `metaType`, if any.  
+`addItem` adds a single item, it's not updated incrementally.  
+Adding the same source more than once has no effect. Items without name are not indexed.  
+
+#### update
+
+```c++
+void update();
+```
+
+Indexes the items registered to the sources since last update. The find functions call it automatically.
+It skips the sources which are not changed since last update, registering items in other repos or classes doesn't cause any work.
+Call it explicitly to build the index in advance.  
+
+#### getItemCount
+
+```c++
+std::size_t getItemCount() const;
+```
+
+Returns the number of indexed items.  
+
+#### findByPrefix
+
+```c++
+MetaItemPointerList findByPrefix(const std::string & prefix, const std::size_t limit = 0);
+```
+
+Returns the items whose names start with `prefix`, in the lexicographical order of the names.
+Items with the same name are in the order they are indexed.
+If `limit` is not 0, at most `limit` items are returned.  
+
+#### findFuzzy
+
+```c++
+MetaItemPointerList findFuzzy(const std::string & name, const std::size_t maxDistance, const std::size_t limit = 0);
+```
+
+Returns the items whose names are within Levenshtein distance (the number of inserted, deleted, or substituted characters)
+`maxDistance` to `name`, sorted by the distance, then by the names.
+If `limit` is not 0, at most `limit` items are returned.  
+The search prunes the sub trees which can't be within `maxDistance`, so a small `maxDistance` is fast.  
+
+desc*/
@@ -0,0 +1,159 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+#include "metapp/interfaces/metaclass.h"
+
+#include <vector>
+#include <string>
+
+/*desc
+# ObjectVisitor -- traverse reflected object graphs
+
+## Overview
+
+`ObjectVisitor` walks an object graph through reflection, and calls a callback on each object it reaches.  
+The children of an object are found by its meta type,  
+1. If the meta type is a pointer or a pointer wrapper such as `std::shared_ptr`, the child is the pointee. Null pointers have no children.  
+2. If the meta type has `MetaClass`, the children are the values of the accessibles, including the accessibles in base classes,
+in the order they are registered.  
+3. If the meta type implements `MetaIndexable` with known size, the children are the elements.  
+4. If the meta type implements `MetaIterable`, the children are the elements.  
+5. Otherwise, the object is a leaf.  
+
+How to find the children is decided once per meta type and cached, so the per object cost is a lookup.  
+The traversal uses an explicit stack instead of recursion, so deep graphs (such as long linked lists) don't overflow the call stack.  
+Objects which may have children, and all pointees, are recorded in a visited set keyed by the address and the meta type,
+so each object is visited only once even if it's reachable from several pointers, and cycles terminate.  
+Values which are not references (such as the results of accessors returning by value) are temporary, they are always visited.  
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/objectvisitor.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+//code
+struct ListNode
+{
+	int value;
+	ListNode * next;
+};
+
+template <>
+struct metapp::DeclareMetaType <ListNode> : metapp::DeclareMetaTypeBase <ListNode>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<ListNode>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("value", &ListNode::value);
+				mc.registerAccessible("next", &ListNode::next);
+			}
+		);
+		return &metaClass;
+	}
+};
+//code
+
+ExampleFunc
+{
+	//code
+	// A circular list with 3 nodes.
+	std::vector<ListNode> nodeList(3);
+	for(int i = 0; i < 3; ++i) {
+		nodeList[i].value = i;
+		nodeList[i].next = &nodeList[(i + 1) % 3];
+	}
+
+	int sum = 0;
+	int listNodeCount = 0;
+	metapp::ObjectVisitor visitor;
+	visitor.visit(metapp::Variant::reference(nodeList), [&sum, &listNodeCount](const metapp::ObjectVisitor::Node & node) -> bool {
+		if(metapp::getNonReferenceMetaType(node.object)->equal(metapp::getMetaType<ListNode>())) {
+			++listNodeCount;
+		}
+		// node.accessible is the MetaItem of the accessible which the object is got from.
+		if(node.accessible != nullptr && node.accessible->getName() == "value") {
+			sum += node.object.get<int>();
+		}
+		return true;
+	});
+	// Each node is reached both as an element of the vector and by pointer, but it's visited only once.
+	ASSERT(listNodeCount == 3);
+	ASSERT(sum == 0 + 1 + 2);
+	//code
+}
+
+/*desc
+## Member functions
+
+#### setMaxDepth
+
+```c++
+ObjectVisitor & setMaxDepth(const std::size_t maxDepth);
+```
+
+The root has depth 0, its children have depth 1, and so on. The children of the objects at `maxDepth` are not visited.
+Default is unlimited.  
+
+#### setExecutor
+
+```c++
+ObjectVisitor & setExecutor(Executor * executor);
+```
+
+If `executor` is not nullptr and its concurrency is greater than 1, the traversal runs in parallel.
+When the pending stack of a thread grows large, half of it is moved to a new task on the executor,
+so large subgraphs are visited by several threads. The visited set is sharded to reduce lock contention,
+and each task keeps its own copy of the per type visiting plans, so the shared plan cache is only locked the first time a task meets a type.  
+In parallel mode, the callback is invoked concurrently and must be thread safe, and the visiting order is not specified.  
+Default is nullptr, the graph is visited in the calling thread in depth first order.  
+
+#### visit
+
+```c++
+void visit(const Variant & root, const Callback & callback);
+```
+
+Visits `root` and all objects reachable from it. `visit` returns after all objects are visited.  
+`Callback` is `std::function<bool (const Node & node)>`. If it returns false, the children of the node are skipped.  
+If the callback throws exception, the traversal is stopped, and the exception is rethrown from `visit`.  
+`root` should be a reference (`Variant::reference(object)`) or a pointer to the object, otherwise the visitor walks a copy of it.  
+
+The `Node` structure,  
+
+```c++
+struct Node
+{
+	// Reference to the object, or the value if the object can't be referenced, such as a value returned by an accessor.
+	Variant object;
+	// The accessible item which the object is got from, nullptr if the object is the root, a container element, or a pointee.
+	const MetaItem * accessible;
+	std::size_t depth;
+};
+```
+
+desc*/
@@ -0,0 +1,162 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+
+#include <vector>
+#include <atomic>
+
+/*desc
+# Parallel algorithms on containers
+
+## Overview
+
+`parallel.h` provides `parallelForEach` and `parallelTransform` to process the elements of a reflected container
+on multiple threads.  
+The element range is split into chunks, the chunks are run on an `Executor` (the default thread pool by default) and the calling thread.  
+How the elements are accessed depends on the capability of the container meta type,  
+1. If the container is random access `MetaIndexable` (`SizeInfo::isRandomAccess()` is true), such as `std::vector`, `std::deque`, `std::array`,
+and C array, the elements are accessed by index.
+The typed functions access the elements by raw pointer if `MetaIndexable::getData` is not nullptr.  
+2. Otherwise, if the container implements `MetaIterable`, such as `std::list`, `std::set`, and `std::map`,
+the container is iterated sequentially to collect the elements, then the elements are processed in chunks.  
+3. Otherwise, `UnsupportedException` is thrown.  
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/parallel.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+ExampleFunc
+{
+	//code
+	std::vector<int> container(1000, 1);
+	metapp::Variant v = metapp::Variant::reference(container);
+
+	// Typed access, no Variant is created per element for std::vector.
+	metapp::parallelForEachAs<int>(v, [](int & element, const std::size_t index) {
+		element = (int)index;
+	});
+	ASSERT(container[999] == 999);
+
+	// Variant access, it works on any supported container.
+	std::atomic<int> sum(0);
+	metapp::parallelForEach(v, [&sum](const metapp::Variant & element, const std::size_t /*index*/) {
+		sum += element.get<int>();
+	});
+	ASSERT(sum == 999 * 1000 / 2);
+
+	// The destination is resized to the source size.
+	std::vector<std::string> names;
+	metapp::parallelTransformAs<int, std::string>(v, metapp::Variant::reference(names),
+		[](const int & element, const std::size_t /*index*/) {
+			return std::to_string(element);
+		}
+	);
+	ASSERT(names[5] == "5");
+	//code
+}
+
+/*desc
+## Functions
+
+The parameter `grain` is the number of elements in a chunk. If it's 0, the grain is chosen to have several chunks per thread.  
+The parameter `executor` is the executor to run the chunks, default is `getDefaultThreadPool()`.  
+The calling thread also processes the chunks, and the functions return after all elements are processed.
+If `func` throws exception, the remaining chunks are skipped, and the first exception is rethrown.  
+`func` is called concurrently, it must be thread safe.  
+
+#### parallelForEach
+
+```c++
+template <typename Func>
+void parallelForEach(
+	const Variant & container,
+	Func && func,
+	const std::size_t grain = 0,
+	Executor & executor = getDefaultThreadPool()
+);
+```
+
+Calls `func(const Variant & element, const std::size_t index)` for each element in `container`.
+`element` is a reference to the element in the container.  
+
+#### parallelForEachAs
+
+```c++
+template <typename T, typename Func>
+void parallelForEachAs(
+	const Variant & container,
+	Func && func,
+	const std::size_t grain = 0,
+	Executor & executor = getDefaultThreadPool()
+);
+```
+
+Calls `func(T & element, const std::size_t index)` for each element in `container`.
+The element type must be `T` (ignoring cv qualifiers), otherwise `BadCastException` is thrown.  
+For contiguous containers, the elements are accessed by raw pointer, so the loop is as fast as a plain loop on the container.  
+If `MetaIndexable::getElementAddress` is not nullptr, such as `std::deque`, the elements are accessed by the addresses. If the container returns the elements by value, such as a bit packed container,
+`func` gets a copy of the element.  
+
+#### parallelTransform
+
+```c++
+template <typename Func>
+void parallelTransform(
+	const Variant & source,
+	const Variant & destination,
+	Func && func,
+	const std::size_t grain = 0,
+	Executor & executor = getDefaultThreadPool()
+);
+```
+
+For each element in `source`, calls `Variant func(const Variant & element, const std::size_t index)`,
+and sets the result to the element at the same `index` in `destination`.  
+`destination` must be random access `MetaIndexable`, otherwise `UnsupportedException` is thrown.
+If `destination` is resizable, it's resized to the size of `source`.
+If `destination` is smaller than `source` after resizing, `OutOfRangeException` is thrown.  
+If `destination` is not contiguous, such as `std::deque` or a bit packed container, `func` still runs in parallel,
+but the results are set to `destination` on the calling thread, because writing some containers from several threads is a data race.  
+
+#### parallelTransformAs
+
+```c++
+template <typename From, typename To, typename Func>
+void parallelTransformAs(
+	const Variant & source,
+	const Variant & destination,
+	Func && func,
+	const std::size_t grain = 0,
+	Executor & executor = getDefaultThreadPool()
+);
+```
+
+Same as `parallelTransform`, the function is called as `To func(From & element, const std::size_t index)`.
+If `destination` is contiguous and its element type is `To`, the result is written by raw pointer.  
+
+desc*/
@@ -0,0 +1,205 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+#include "metapp/metarepo.h"
+
+#include <string>
+#include <sstream>
+
+/*desc
+# Profiler -- latency histograms and trace of reflected invocations
+
+## Overview
+
+Invoking a function through reflection has costs which don't exist in a direct call, such as choosing an overload,
+casting the arguments, and creating the result `Variant`. When a program (such as a script binding) is slow, it's hard to
+know which registered function is hot and which phase dominates.  
+`Profiler` records the latency of `callableInvoke`, `findCallable`, `accessibleGet`, and `accessibleSet`, for each callable
+or accessible and for each phase. The latencies are recorded in log-linear histograms (HDR style), so the percentiles are
+available with constant memory. The invocations can also be recorded as trace events and exported as Chrome trace JSON,
+which can be opened in `chrome://tracing` or Perfetto.  
+
+The hooks are compiled only if the macro `METAPP_ENABLE_PROFILING` is defined. Without the macro, there is no overhead at all,
+and the profiler functions still work but record nothing. With the macro, the profiler is disabled by default,
+the overhead is one relaxed atomic load per hooked call. When the profiler is enabled, a sample costs two reads of
+the clock (the time stamp counter on x86) and three uncontended atomic additions, that's about 10 to 30 nanoseconds on
+common hardware, and more in virtual machines where reading the time stamp counter is slower.  
+The macro must be defined for all translation units which include metapp. The CMake option `METAPP_ENABLE_PROFILING`
+defines it for the `metapp` target and the targets linking it.
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/profiler.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+//code
+namespace {
+
+int add(const int a, const int b)
+{
+	return a + b;
+}
+
+std::string concat(const std::string & a, const std::string & b)
+{
+	return a + b;
+}
+
+} // namespace
+//code
+
+ExampleFunc
+{
+	//code
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerCallable("add", &add);
+	metaRepo.registerCallable("concat", &concat);
+	// The items in metaRepo are named as "add" and "concat" when the report and the trace are written,
+	// no need to name them explicitly.
+
+	metapp::Profiler::enable();
+	metapp::Profiler::startTrace();
+	for(int i = 0; i < 100; ++i) {
+		metapp::callableInvoke(metaRepo.getCallable("add"), nullptr, i, 1);
+		metapp::callableInvoke(metaRepo.getCallable("concat"), nullptr, std::string("a"), std::string("b"));
+	}
+	metapp::Profiler::stopTrace();
+	metapp::Profiler::disable();
+
+	// The report is a table such as
+	// Name      Phase       Count    Mean(ns)     P50(ns)     P90(ns)     P99(ns)     Max(ns)
+	// add      invoke         100        38.2        36.5        41.5        83.0       412.0
+	// add        cast         100         8.1         7.8         8.5        12.5        95.0
+	std::ostringstream report;
+	metapp::Profiler::writeReport(report);
+
+	// Open the file in chrome://tracing or Perfetto.
+	std::ostringstream trace;
+	metapp::Profiler::writeTrace(trace);
+	ASSERT(trace.str().find("\"traceEvents\"") != std::string::npos);
+	//code
+}
+
+/*desc
+## Phases
+
+```c++
+enum class ProfilePhase
+{
+	invoke,
+	rank,
+	cast,
+	call,
+	box,
+	get,
+	set
+};
+```
+
+`invoke` is the whole `callableInvoke`, including choosing the overload.  
+`rank` is ranking the candidates in `findCallable`, it's recorded to the chosen callable, or to the first candidate
+if none matches. For an `OverloadedFunction`, it's recorded to the chosen overload.  
+`cast`, `call`, and `box` are casting the arguments, calling the underlying function, and creating the result `Variant`.
+They are recorded for the callables implemented by `MetaCallableBase`, such as functions, member functions, and constructors.  
+`get` and `set` are `accessibleGet` and `accessibleSet`.  
+
+Note `invoke` is recorded by `callableInvoke`, calling `MetaCallable::invoke` directly only records the `cast`, `call`, and `box` phases.
+
+## Identifying items
+
+The items are identified by `ProfileKey`, which is the meta type and the target of the `Variant` which holds the callable
+or the accessible. The target is the value if the `Variant` stores a small value in place, such as a function pointer or
+a member data pointer, otherwise it's the address of the object which the `Variant` stores on the heap or refers to.
+So invoking a copy of the `Variant`, such as a copy of the callable in a `MetaItem`, is recorded to the same item.
+Two `Variant`s holding the same function pointer are the same item too.
+
+```c++
+static ProfileKey getKey(const Variant & item);
+static void setName(const Variant & item, const std::string & name);
+static void addMetaItem(const MetaItem & item, const std::string & prefix = std::string());
+static void addMetaClass(const MetaClass * metaClass, const std::string & prefix = std::string());
+static void addMetaRepo(const MetaRepo * metaRepo);
+```
+
+`addMetaItem` names the callable or accessible in `item` as `prefix + name`. The overloads in an `OverloadedFunction` are
+named as `name#index`.  
+`addMetaClass` names the callables and accessibles registered in `metaClass`, not including the base classes.  
+`addMetaRepo` names the callables and accessibles in `metaRepo`, the members in the `MetaClass` of the registered types
+(as `TypeName::name`), and the items in the sub repos (as `RepoName::name`).  
+When the records, the report, or the trace are read, the items without names are named from all `MetaRepo`s which exist
+at that time, in the same way as `addMetaRepo`. The names given by the functions above take precedence.
+`addMetaRepo` is only needed if the repo is destroyed before the records are read.  
+An item without name is shown as its target address.
+
+## Histograms
+
+```c++
+static void enable();
+static void disable();
+static bool isEnabled();
+static void reset();
+static std::vector<ProfileRecord> getRecordList();
+static void writeReport(std::ostream & stream);
+static std::uint64_t getDroppedSampleCount();
+```
+
+`reset` clears all histograms, the names are kept.  
+`getRecordList` returns the items which have any samples, sorted by name.
+`ProfileRecord::getHistogram(phase)` returns the `ProfileHistogram` of the phase, which has the functions,
+
+```c++
+std::uint64_t getCount() const;
+double getTotal() const;
+double getMean() const;
+double getMax() const;
+double getPercentile(const double percentile) const;
+```
+
+The values are in nanoseconds. `percentile` is in [0, 100]. The relative error of the percentiles is within 1/16.  
+At most 4096 items can be recorded, the samples of the other items are dropped and counted by `getDroppedSampleCount`.
+
+## Trace
+
+```c++
+static void startTrace(const std::size_t maxEventCount = 100000);
+static void stopTrace();
+static bool isTracing();
+static std::size_t getTraceEventCount();
+static void writeTrace(std::ostream & stream);
+static bool writeTrace(const std::string & fileName);
+```
+
+`startTrace` starts recording trace events, the events after the first `maxEventCount` events are dropped.
+Starting a trace discards the previous trace. The histograms and the trace can be enabled independently.  
+`writeTrace` writes the events in Chrome trace event format, the phases other than `invoke`, `get`, and `set` are
+named as `name/phase`. `writeTrace(fileName)` returns false if the file can't be written.
+
+## Thread safety
+
+All functions in `Profiler` are thread safe. The samples are recorded with atomic operations, without locks.
+
+desc*/
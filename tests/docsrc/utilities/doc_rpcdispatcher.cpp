@@ -0,0 +1,184 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+#include "metapp/metarepo.h"
+
+#include <string>
+#include <vector>
+
+/*desc
+# RpcDispatcher -- binary RPC over the callables in MetaRepo
+
+## Overview
+
+A simple way to expose the reflected functions over RPC is to look up the callable by name (`MetaRepo::getCallable`),
+create `Variant` arguments from the decoded request, rank the overloads, and box the result.
+`RpcDispatcher` does the work once when it's created. It assigns an integer ID to each callable in a `MetaRepo`,
+and plans the decoders of the parameters and the encoder of the result for each method.
+Dispatching a request decodes the arguments to the slots which have the parameter types, invokes the callable by
+`MetaCallable::invokeRef`, and encodes the result. There is no name lookup, no overload ranking,
+and no `Variant` for the arguments. The result is boxed in the only `Variant`, which is returned by `invokeRef`,
+and is encoded from the address of the value.
+
+`RpcDispatcher` doesn't do any network I/O. It reads a request from a byte buffer and appends the response to a byte vector,
+so it can be used with any transport, or tested in process by passing the request buffer directly.
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/rpcdispatcher.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+//code
+int docRpcAdd(const int a, const long long b)
+{
+	return a + (int)b;
+}
+
+std::string docRpcGreet(const std::string & name)
+{
+	return "Hello " + name;
+}
+//code
+
+ExampleFunc
+{
+	//code
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerCallable("add", &docRpcAdd);
+	metaRepo.registerCallable("greet", &docRpcGreet);
+
+	const metapp::RpcDispatcher dispatcher(&metaRepo);
+	// The IDs are assigned in the registration order.
+	ASSERT(dispatcher.findMethodId("greet") == 1);
+
+	// The client writes the request.
+	std::vector<char> request;
+	metapp::writeRpcRequest(request, dispatcher.findMethodId("add"), 5, 6LL);
+
+	// The server dispatches it. Here the request buffer is passed directly, as a loopback.
+	std::vector<char> response;
+	ASSERT(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::ok);
+
+	// The client reads the response.
+	int sum = 0;
+	ASSERT(metapp::readRpcResponse(response.data(), response.size(), &sum) == metapp::ErrorCode::ok);
+	ASSERT(sum == 11);
+
+	request.clear();
+	response.clear();
+	metapp::writeRpcRequest(request, dispatcher.findMethodId("greet"), "metapp");
+	dispatcher.dispatch(request.data(), request.size(), response);
+	std::string greeting;
+	metapp::readRpcResponse(response.data(), response.size(), &greeting);
+	ASSERT(greeting == "Hello metapp");
+	//code
+}
+
+/*desc
+## Method IDs
+
+The IDs are assigned in the registration order of the callables in the `MetaRepo`, starting from 0.
+Each overload of an overloaded callable has its own ID, so dispatching never ranks the overloads.
+The IDs are stable as long as the callables are registered in the same order.
+`getFingerprint` returns a hash of the names and the signatures of all methods in the ID order,
+the client and the server can compare the fingerprints to check whether they have the same methods.
+
+## Wire format
+
+The values are in the native byte order and sizes, the client and the server must run on machines with
+the same byte order and the same sizes of the arithmetic types.
+Arithmetic values are written as their bytes, enums are written as the underlying type,
+strings are a 32 bit length followed by the characters, without the null terminator.
+A request is the 32 bit method ID followed by the arguments.
+A response is one byte of `ErrorCode`, followed by the result if the `ErrorCode` is `ok` and the method doesn't return `void`.
+
+## Supported types
+
+- Parameters: arithmetic types, enums, and `std::string`. They can be passed by value or by reference.
+- Results: the same as the parameters, plus `const char *` which is encoded as a string, and `void`.
+
+The callables must be non-member functions or static member functions, and must have a fixed parameter count.
+The methods with other signatures still have IDs, dispatching them responds `ErrorCode::unsupported`.
+
+## RpcDispatcher
+
+```c++
+class RpcDispatcher
+{
+public:
+	explicit RpcDispatcher(const MetaRepo * metaRepo);
+
+	std::size_t getMethodCount() const;
+	std::uint32_t findMethodId(const std::string & name, const std::size_t overloadIndex = 0) const;
+	const std::string & getMethodName(const std::uint32_t methodId) const;
+	const Variant & getMethod(const std::uint32_t methodId) const;
+	bool isMethodSupported(const std::uint32_t methodId) const;
+	std::uint64_t getFingerprint() const;
+
+	ErrorCode dispatch(const void * request, const std::size_t requestSize, std::vector<char> & response) const;
+};
+```
+
+The `MetaRepo` must outlive the dispatcher. The callables registered after the dispatcher is created are not dispatched.
+`findMethodId` returns the ID of the overload `overloadIndex` of the callable `name`, or `invalidRpcMethodId` if it's not found.
+`getMethodName`, `getMethod`, and `isMethodSupported` raise `OutOfRangeException` if the ID is out of range.
+`dispatch` decodes the request, invokes the method, and appends the response to `response`. It returns the `ErrorCode`
+in the response. It's `ErrorCode::outOfRange` if the method ID is unknown, `ErrorCode::illegalArgument` if the arguments are
+truncated or have extra bytes, `ErrorCode::unsupported` if the signature is not supported.
+The exceptions thrown by the callable are not caught.
+`dispatch` is thread safe, one dispatcher can serve requests in many threads.
+
+## Encoding functions
+
+```c++
+template <typename ...Args>
+void writeRpcRequest(std::vector<char> & buffer, const std::uint32_t methodId, const Args & ... args);
+
+template <typename T>
+ErrorCode readRpcResponse(const void * response, const std::size_t size, T * result);
+ErrorCode readRpcResponse(const void * response, const std::size_t size);
+```
+
+`writeRpcRequest` appends a request to `buffer`. The types of `args` must be the same as the parameters,
+for example, pass `6LL` to a `long long` parameter. The server doesn't cast the arguments.
+`readRpcResponse` reads the `ErrorCode`, and the result to `*result` if the `ErrorCode` is `ok`.
+It returns `ErrorCode::illegalArgument` if the response is truncated. The overload without `result` is for the methods which return `void`.
+`RpcWriter` and `RpcReader` are the underlying encoder and decoder, they can be used to implement custom messages
+with the same encoding.
+
+## Performance
+
+One core, `tests/benchmark/benchmark_rpcdispatcher.cpp`, GCC 12, -O3.
+"By name" looks up the callable by name, builds the `Variant` arguments, and invokes by `callableInvoke`.
+`add` has two overloads.
+
+|Method                                                    |By name               |By RpcDispatcher      |
+|----------------------------------------------------------|----------------------|----------------------|
+|`int add(int, long long)`                                 |1.46M calls/second    |8.83M calls/second    |
+|`std::string greet(const std::string &, int)`             |1.90M calls/second    |4.35M calls/second    |
+
+desc*/
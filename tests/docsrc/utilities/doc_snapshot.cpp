@@ -0,0 +1,237 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaindexable.h"
+
+#include <string>
+#include <vector>
+
+/*desc
+# Snapshot -- memory mapped image of reflected object graphs
+
+## Overview
+
+Loading a large configuration usually means parsing a file, then creating the objects and setting the properties
+by `accessibleSet`, one property at a time. The cost grows with the size of the configuration, and each process pays it again.
+A snapshot is a binary image of a reflected object graph. The references in the image, such as the strings, the arrays, and the
+schemas, are relative offsets, so the image can be mapped at any address, and can be shared by several processes.
+Reading a snapshot doesn't create any objects. `Snapshot` maps the image and gives read only views, the arithmetic values are
+references into the image, the objects are `SnapshotObject`, and the arrays are `SnapshotArray` which implements `MetaIndexable`.
+
+The image has a header, the values, and a schema table. Each schema has a fingerprint, which is a hash of the type layout,
+that's the names, the order, and the types of the fields. The fingerprint can be used to check whether the image is written
+from the same type layout as the reader.
+The values are in the native byte order and alignment, a snapshot can only be read on a machine with the same byte order
+and the same sizes of the arithmetic types. The header records the byte order, `Snapshot` rejects the images with a different byte order.
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/snapshot.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+//code
+struct Route
+{
+	std::string path;
+	int weight;
+};
+
+struct ServiceConfig
+{
+	std::string name;
+	double timeout;
+	std::vector<int> portList;
+	std::vector<Route> routeList;
+};
+
+template <>
+struct metapp::DeclareMetaType <Route> : metapp::DeclareMetaTypeBase <Route>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<Route>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("path", &Route::path);
+				mc.registerAccessible("weight", &Route::weight);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <ServiceConfig> : metapp::DeclareMetaTypeBase <ServiceConfig>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<ServiceConfig>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("name", &ServiceConfig::name);
+				mc.registerAccessible("timeout", &ServiceConfig::timeout);
+				mc.registerAccessible("portList", &ServiceConfig::portList);
+				mc.registerAccessible("routeList", &ServiceConfig::routeList);
+			}
+		);
+		return &metaClass;
+	}
+};
+//code
+
+ExampleFunc
+{
+	//code
+	ServiceConfig config { "gateway", 2.5, { 80, 443 }, { { "/api", 3 }, { "/static", 1 } } };
+
+	// The image can also be written to a file by writeSnapshotFile, and mapped by Snapshot::fromFile.
+	const std::vector<char> image = metapp::createSnapshot(metapp::Variant::reference(config));
+
+	const metapp::Snapshot snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	ASSERT(snapshot.matches<ServiceConfig>());
+
+	const metapp::SnapshotObject root = snapshot.getRoot().get<const metapp::SnapshotObject &>();
+	ASSERT(root.get("name").get<const char *>() == std::string("gateway"));
+	// The arithmetic values are const references into the image.
+	ASSERT(root.get("timeout").get<double>() == 2.5);
+
+	const metapp::SnapshotArray portList = root.get("portList").get<const metapp::SnapshotArray &>();
+	ASSERT(portList.getSize() == 2);
+	// The arithmetic arrays are contiguous in the image.
+	ASSERT(static_cast<const int *>(portList.getData())[1] == 443);
+
+	// SnapshotArray implements MetaIndexable.
+	const metapp::Variant routeList = root.get("routeList");
+	ASSERT(metapp::indexableGetSizeInfo(routeList).getSize() == 2);
+	const metapp::SnapshotObject route = metapp::indexableGet(routeList, 1).get<const metapp::SnapshotObject &>();
+	ASSERT(route.get("path").get<const char *>() == std::string("/static"));
+	ASSERT(route.get("weight").get<int>() == 1);
+	//code
+}
+
+/*desc
+## Supported types
+
+- Arithmetic types and enums. The enums are written as the underlying types.
+- `std::string` and `const char *`. They are read as null terminated `const char *`.
+- Classes with `MetaClass`. The non static accessibles, including the accessibles in the base classes, are written as the fields.
+- Containers with `MetaIndexable` or `MetaIterable` which have one up type, such as `std::vector`, `std::list`, and C arrays.
+They are written as arrays. The arrays of arithmetic types are contiguous.
+
+Other types, such as pointers to objects and `std::map`, raise `UnsupportedException` when the snapshot is written.
+
+## Functions
+
+```c++
+std::vector<char> createSnapshot(const Variant & root);
+void writeSnapshotFile(const std::string & fileName, const Variant & root);
+std::uint64_t getSnapshotFingerprint(const MetaType * metaType);
+```
+
+`createSnapshot` writes the image of `root` to a byte vector.
+`writeSnapshotFile` writes the image of `root` to the file. It raises `IllegalArgumentException` if the file can't be written.
+`getSnapshotFingerprint` returns the fingerprint of the schema of the type. It's the same for the same type layout in all programs.
+
+## SnapshotArray
+
+```c++
+class SnapshotArray
+{
+public:
+	std::size_t getSize() const;
+	Variant get(const std::size_t index) const;
+	const void * getData() const;
+	const MetaType * getElementMetaType() const;
+};
+```
+
+`get` returns the element. The arithmetic elements are const references into the image, the strings are `const char *`,
+the objects are `SnapshotObject`, and the arrays are `SnapshotArray`.
+`getData` and `getElementMetaType` return the element data and the element type if the elements are arithmetic, otherwise nullptr.
+`SnapshotArray` implements `MetaIndexable`, `indexableSet` raises `UnwritableException`.
+
+## SnapshotObject
+
+```c++
+class SnapshotObject
+{
+public:
+	std::size_t getFieldCount() const;
+	std::string getFieldName(const std::size_t index) const;
+	bool hasField(const std::string & name) const;
+
+	Variant get(const std::string & name) const;
+	Variant get(const std::size_t index) const;
+};
+```
+
+`get` returns an empty `Variant` if the field doesn't exist. The values are the same as `SnapshotArray::get`.
+Getting by index is faster than by name.
+`SnapshotObject` implements `MetaMappable`, the keys are the field names.
+
+## Snapshot
+
+```c++
+class Snapshot
+{
+public:
+	static Snapshot fromFile(const std::string & fileName);
+	static Snapshot fromMemory(const void * data, const std::size_t size);
+
+	bool isValid() const;
+	Variant getRoot() const;
+
+	std::size_t getSchemaCount() const;
+	std::uint64_t getSchemaFingerprint(const std::size_t index) const;
+	std::uint64_t getRootFingerprint() const;
+
+	template <typename T>
+	bool matches() const;
+};
+```
+
+`fromFile` maps the file read only. `fromMemory` uses the image in memory without copying it, the data must be aligned to 8 bytes
+and must be alive while the snapshot is used. Both functions check the header and the schemas, and raise `IllegalArgumentException`
+if the image is invalid. Checking the values requires reading the whole image, so they are checked when they are read instead.
+A string or an array which refers out of the image raises `IllegalArgumentException`, so a truncated or corrupted file
+never reads out of the image. The arithmetic values are not checked.  
+`SnapshotArray::get`, `SnapshotObject::get`, and `getSchemaFingerprint` raise `OutOfRangeException` if the index is out of range.  
+`Snapshot` is movable but not copyable. The views point into the image, they must not be used after the `Snapshot` is destroyed.
+`matches` returns true if the root was written from type `T` with the same layout as `T` in this program.
+
+## Performance
+
+Reading the configuration of 1M objects which have 3 properties each
+(`tests/benchmark/benchmark_snapshot.cpp`, GCC 12, -O3, one core),
+
+|Method                                                              |Time    |
+|--------------------------------------------------------------------|--------|
+|Reconstruct the objects by `accessibleSet`                          |763 ms  |
+|Open the snapshot and get the root array                            |< 1 ms  |
+|Open the snapshot and read a field of all objects                   |135 ms  |
+|Write the snapshot                                                  |633 ms  |
+
+desc*/
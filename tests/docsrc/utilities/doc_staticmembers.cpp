@@ -0,0 +1,204 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <sstream>
+
+/*desc
+# StaticMembers -- compile time member reflection
+
+## Overview
+
+The member data registered in `MetaClass` are accessed at running time through `Variant`.
+For templates that know the type at compile time, such as serialization and hashing,
+`DeclareMetaType` can also list the data members as a constexpr `StaticMemberList`.
+Iterating a `StaticMemberList` is expanded by templates, the callback receives the members
+with their real types, and the compiler can inline the code for each member, there is no `Variant` or virtual call.  
+`getMetaClassFromStaticMembers` generates the runtime `MetaClass` from the same list, so the static and the runtime
+reflections are always in sync.  
+`forEachMember` picks the static path if the type has static members, otherwise it uses the accessibles in the `MetaClass`.  
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/staticmembers.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+//code
+struct Size
+{
+	int width;
+	int height;
+	std::string unit;
+};
+
+template <>
+struct metapp::DeclareMetaType <Size> : metapp::DeclareMetaTypeBase <Size>
+{
+	// In C++11, the return type must be written explicitly, such as
+	// metapp::StaticMemberList<metapp::StaticMember<Size, int>, metapp::StaticMember<Size, int>, metapp::StaticMember<Size, std::string> >
+	static constexpr auto getStaticMembers() {
+		return metapp::makeStaticMemberList(
+			metapp::staticMember("width", &Size::width),
+			metapp::staticMember("height", &Size::height),
+			metapp::staticMember("unit", &Size::unit)
+		);
+	}
+
+	// The accessibles in the MetaClass are generated from getStaticMembers.
+	static const metapp::MetaClass * getMetaClass() {
+		return metapp::getMetaClassFromStaticMembers<Size>();
+	}
+};
+//code
+
+ExampleFunc
+{
+	//code
+	Size size { 3, 5, "cm" };
+
+	std::string text;
+	// The callback is called with int & and std::string &.
+	metapp::forEachStaticMember(size, [&text](const char * name, const auto & value) {
+		std::ostringstream stream;
+		stream << name << "=" << value << ";";
+		text += stream.str();
+	});
+	ASSERT(text == "width=3;height=5;unit=cm;");
+
+	// The runtime MetaClass is available too.
+	const metapp::MetaClass * metaClass = metapp::getMetaType<Size>()->getMetaClass();
+	ASSERT(metapp::accessibleGet(metaClass->getAccessible("height"), &size).get<int>() == 5);
+
+	static_assert(metapp::HasStaticMembers<Size>::value, "");
+	static_assert(metapp::getStaticMembers<Size>().getSize() == 3, "");
+	//code
+}
+
+/*desc
+## Declaring static members
+
+```c++
+template <typename C, typename T>
+struct StaticMember
+{
+	using ClassType = C;
+	using ValueType = T;
+
+	constexpr StaticMember(const char * name, T C::* pointer);
+
+	T & get(C & instance) const;
+	const T & get(const C & instance) const;
+
+	const char * name;
+	T C::* pointer;
+};
+
+template <typename C, typename T>
+constexpr StaticMember<C, T> staticMember(const char * name, T C::* pointer);
+
+template <typename ...Members>
+constexpr StaticMemberList<Members...> makeStaticMemberList(const Members & ... members);
+```
+
+`DeclareMetaType<T>` declares the static members by a static constexpr function `getStaticMembers()`
+which returns a `StaticMemberList`.  
+
+`StaticMemberList` has the member functions,  
+
+```c++
+static constexpr std::size_t getSize();
+template <typename Func>
+void forEach(Func && func) const;
+```
+
+`forEach` calls `func(member)` for each `StaticMember`, in the declaration order.
+
+## Global functions
+
+#### HasStaticMembers
+
+```c++
+template <typename T>
+struct HasStaticMembers;
+```
+
+`HasStaticMembers<T>::value` is true if `DeclareMetaType<T>` has `getStaticMembers()`. The cv qualifiers in `T` are ignored.
+
+#### getStaticMembers
+
+```c++
+template <typename T>
+constexpr auto getStaticMembers() -> decltype(DeclareMetaType<T>::getStaticMembers());
+```
+
+#### forEachStaticMember
+
+```c++
+template <typename T, typename Func>
+void forEachStaticMember(T & instance, Func && func);
+```
+
+Calls `func(const char * name, V & value)` for each static member of `instance`, `V` is the member type, with const added if `T` is const.  
+Only the members in `getStaticMembers` of `T` are visited, the base classes are not.
+
+#### forEachMember
+
+```c++
+template <typename T, typename Func>
+void forEachMember(T & instance, Func && func);
+```
+
+Visits the members of `T` and its base classes. The static and the dynamic paths visit the same members in the same order,
+first the members of `T`, then the members of the base classes in the order of `MetaClass::getAccessibleView`.  
+If `T` has static members, calls `func(const char * name, V & value)` for each static member of `T`, the same as `forEachStaticMember`.
+Otherwise, calls `func(const char * name, const Variant & value)` for each accessible in the `MetaClass` of `T`.  
+The base classes are registered by `MetaRepo::registerBase` at runtime, so in both paths, the members of the base classes are visited
+through the `MetaClass` of `T`, `func` is called with the `Variant` form for them. If `T` doesn't have `MetaClass`, the base classes are not visited.  
+`value` in the `Variant` form is the result of `accessibleGet`.  
+`func` is usually a generic lambda or a functor that accepts both forms.  
+
+#### registerStaticMembers
+
+```c++
+template <typename ...Members>
+void registerStaticMembers(MetaClass & metaClass, const StaticMemberList<Members...> & memberList);
+```
+
+Registers each static member as an accessible in `metaClass`. It's useful to register more meta data, such as callables, in the same `MetaClass`.
+
+#### getMetaClassFromStaticMembers
+
+```c++
+template <typename T>
+const MetaClass * getMetaClassFromStaticMembers();
+```
+
+Returns a `MetaClass` of which accessibles are registered from `getStaticMembers<T>()`.
+It's intended to be returned by `DeclareMetaType<T>::getMetaClass()`.
+
+desc*/
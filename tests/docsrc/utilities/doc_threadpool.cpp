@@ -0,0 +1,181 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "testutil.h"
+
+#include "metapp/allmetatypes.h"
+
+/*desc
+# Thread pool and asynchronous invocation
+
+## Overview
+
+`threadpool.h` provides a work stealing thread pool, `asyncinvoke.h` invokes any `MetaCallable` asynchronously
+on an executor such as the thread pool.  
+An asynchronous invocation moves the arguments into a pooled task slot, and returns a lightweight `InvokeFuture`.
+The task slots are recycled, and the thread pool queues tasks intrusively, so after warm up an invocation doesn't allocate memory
+unless the arguments themselves allocate.
+
+## Header
+desc*/
+
+//code
+#include "metapp/utilities/threadpool.h"
+#include "metapp/utilities/asyncinvoke.h"
+//code
+
+/*desc
+## Example
+
+desc*/
+
+ExampleFunc
+{
+	//code
+	struct MyClass {
+		int value;
+		int add(const int n) const {
+			return value + n;
+		}
+	};
+	MyClass obj { 5 };
+	metapp::Variant callable(&MyClass::add);
+	metapp::InvokeFuture future = metapp::callableInvokeAsync(
+		metapp::getDefaultThreadPool(), callable, &obj, 3
+	);
+	ASSERT(future.get().get<int>() == 8);
+	//code
+}
+
+/*desc
+## Executor
+
+```c++
+struct ExecutorTask
+{
+	explicit ExecutorTask(void (*run)(ExecutorTask * task) = nullptr);
+
+	void (*run)(ExecutorTask * task);
+	ExecutorTask * previous;
+	ExecutorTask * next;
+};
+
+class Executor
+{
+public:
+	virtual ~Executor() = default;
+
+	virtual void execute(ExecutorTask * task) = 0;
+	virtual void executeBatch(ExecutorTask * const * tasks, const std::size_t count);
+	virtual std::size_t getConcurrency() const;
+};
+```
+
+`ExecutorTask` is an intrusive task node. An executor links the queued tasks with `previous` and `next`,
+so queuing a task never allocates memory. The task must be alive until `run` is called.  
+`Executor` is the interface to run tasks. `execute` queues one task. `executeBatch` queues `count` tasks at once,
+the default implementation calls `execute` for each task.  
+`getConcurrency` returns the number of tasks the executor can run at the same time, the default implementation returns 1.  
+
+## ThreadPool
+
+```c++
+class ThreadPool : public Executor
+{
+public:
+	explicit ThreadPool(const std::size_t threadCount = 0);
+	~ThreadPool();
+
+	std::size_t getThreadCount() const;
+
+	void execute(ExecutorTask * task) override;
+	void executeBatch(ExecutorTask * const * tasks, const std::size_t count) override;
+	std::size_t getConcurrency() const override;
+
+	using TaskExceptionHandler = std::function<void (std::exception_ptr)>;
+	void setTaskExceptionHandler(TaskExceptionHandler handler);
+	std::exception_ptr takeTaskException();
+};
+
+ThreadPool & getDefaultThreadPool();
+```
+
+If `threadCount` is 0, the thread count is `std::thread::hardware_concurrency()`.  
+Each worker thread has its own task queue. A task submitted from a worker goes to the worker's own queue,
+a task submitted from other threads goes to the workers in round robin. An idle worker steals tasks from the other workers.  
+`executeBatch` spreads the tasks evenly on the workers, each worker queue is locked only once.  
+`getConcurrency` returns the thread count.  
+The destructor runs all pending tasks, then joins the threads.  
+An exception thrown by a task is caught, the worker thread keeps running. The exception is passed to the handler
+set by `setTaskExceptionHandler`, in the worker thread. If there is no handler, the first exception is kept until
+`takeTaskException` returns it, the later exceptions are discarded meanwhile.  
+Tasks which report errors to their callers, such as `callableInvokeAsync`, catch the exceptions by themselves.  
+If exceptions are disabled, or `METAPP_DISABLE_EXCEPTION` is defined, the tasks are not guarded.  
+`getDefaultThreadPool` returns a global thread pool which is created on the first call.  
+
+## InvokeFuture
+
+```c++
+class InvokeFuture
+{
+public:
+	InvokeFuture() noexcept;
+
+	bool isValid() const noexcept;
+	bool isReady() const noexcept;
+	void wait() const;
+	Variant get() const;
+};
+```
+
+`InvokeFuture` is the result of an asynchronous invocation. It's cheap to copy and move, it only holds a reference counted pointer to the task slot.  
+`isValid` returns false if the future is default constructed.  
+`isReady` returns true if the invocation has finished.  
+`wait` waits until the invocation finishes. If `wait` is called in a thread pool worker, the worker runs other pending tasks while waiting,
+so a task can wait for another task without dead lock.  
+`get` waits, then returns the result of the callable. If the callable threw an exception, `get` rethrows it.  
+
+## Functions
+
+#### callableInvokeAsync
+
+```c++
+template <typename ...Args>
+InvokeFuture callableInvokeAsync(Executor & executor, const Variant & callable, const Variant & instance, Args && ... args);
+```
+
+Invokes `callable` on `executor`. The arguments are the same as `callableInvoke`.  
+`args` are moved (if they are rvalues) or copied into the task slot, so the caller doesn't need to keep them alive.  
+`callable` and `instance` are copied. If `instance` is a pointer, the object must be alive until the invocation finishes.  
+
+#### callableInvokeAsyncBatch
+
+```c++
+void callableInvokeAsyncBatch(
+	Executor & executor,
+	const Variant & callable,
+	const ArgumentSpan & instances,
+	const ArgumentColumnSpan & argumentColumns,
+	const metapp::span<InvokeFuture> & futures
+);
+```
+
+Invokes `callable` once for each row in `argumentColumns`, each invocation is a task, and the tasks are submitted with `Executor::executeBatch`.  
+The layout of `instances` and `argumentColumns` is the same as `MetaCallable::invokeBatch`.
+The size of `futures` must equal to the row count, each element receives the future of the row.  
+
+desc*/
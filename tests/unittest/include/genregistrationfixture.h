@@ -0,0 +1,77 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The annotated classes for tools/genregistration.py, the generated code is compiled into the unittest,
+// and test_genregistration.cpp checks what it registers.
+
+#ifndef GENREGISTRATIONFIXTURE_H
+#define GENREGISTRATIONFIXTURE_H
+
+#include <string>
+#include <vector>
+
+namespace genfixture {
+
+//metapp:reflect
+struct Shape
+{
+	//metapp:field
+	int width;
+	//metapp:field
+	int height;
+	//metapp:field
+	std::string name;
+	// Not annotated, not registered
+	std::vector<int> tags;
+
+	//metapp:method
+	int getArea() const { return width * height; }
+	//metapp:method
+	int getWidth() const { return width; }
+	//metapp:method
+	void setName(const std::string & newName) { name = newName; }
+	//metapp:method
+	void resize(int newWidth) { width = newWidth; }
+	//metapp:method
+	void resize(int newWidth, int newHeight) {
+		width = newWidth;
+		height = newHeight;
+	}
+	//metapp:method
+	static Shape create(int width, int height) { return Shape { width, height, "created", {} }; }
+};
+
+// The member functions have the same signatures as the ones in Shape, so they share the thunks.
+//metapp:reflect
+struct Label
+{
+	//metapp:field
+	std::string text;
+
+	//metapp:method
+	int getLength() const { return static_cast<int>(text.size()); }
+	//metapp:method
+	void setText(const std::string & newText) { text = newText; }
+};
+
+//metapp:reflect
+struct Empty
+{
+};
+
+} // namespace genfixture
+
+#endif
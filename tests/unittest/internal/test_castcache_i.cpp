@@ -0,0 +1,239 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/implement/internal/castcache_i.h"
+#include "metapp/implement/internal/util_i.h"
+#include "metapp/metarepo.h"
+#include "metapp/variant.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+namespace {
+
+struct CastCacheBase { int a; };
+struct CastCacheDerived : CastCacheBase { int b; };
+
+// Can cast to int only if value is positive.
+struct CastCacheValueCast { int value; };
+// Can always cast to int, declared as castCacheable.
+struct CastCachePureCast { int value; };
+// Inherits from CastToTypes, and can cast to int only if value is positive.
+struct CastCacheInheritedCast { int value; };
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <CastCacheValueCast> : metapp::DeclareMetaTypeBase <CastCacheValueCast>
+{
+	static bool cast(metapp::Variant * result, const metapp::Variant * fromVar, const metapp::MetaType * toMetaType) {
+		if(toMetaType->equal(metapp::getMetaType<int>())) {
+			if(fromVar == nullptr) {
+				return true;
+			}
+			const int value = fromVar->get<const CastCacheValueCast &>().value;
+			if(value > 0) {
+				if(result != nullptr) {
+					*result = value;
+				}
+				return true;
+			}
+			return false;
+		}
+		return metapp::commonCast(result, fromVar, metapp::getMetaType<CastCacheValueCast>(), toMetaType);
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <CastCachePureCast> : metapp::DeclareMetaTypeBase <CastCachePureCast>
+{
+	static constexpr bool castCacheable = true;
+
+	static bool cast(metapp::Variant * result, const metapp::Variant * fromVar, const metapp::MetaType * toMetaType) {
+		if(toMetaType->equal(metapp::getMetaType<int>())) {
+			if(result != nullptr) {
+				*result = fromVar->get<const CastCachePureCast &>().value;
+			}
+			return true;
+		}
+		return metapp::commonCast(result, fromVar, metapp::getMetaType<CastCachePureCast>(), toMetaType);
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <CastCacheInheritedCast>
+	: metapp::DeclareMetaTypeBase <CastCacheInheritedCast>,
+		metapp::CastToTypes<CastCacheInheritedCast, metapp::TypeList<std::string> >
+{
+	static bool cast(metapp::Variant * result, const metapp::Variant * fromVar, const metapp::MetaType * toMetaType) {
+		if(toMetaType->equal(metapp::getMetaType<int>())) {
+			return fromVar == nullptr || fromVar->get<const CastCacheInheritedCast &>().value > 0;
+		}
+		return metapp::commonCast(result, fromVar, metapp::getMetaType<CastCacheInheritedCast>(), toMetaType);
+	}
+};
+
+namespace {
+
+TEST_CASE("CastCache, find and store")
+{
+	const metapp::MetaType * from = metapp::getMetaType<int>();
+	const metapp::MetaType * to = metapp::getMetaType<std::string>();
+	const std::uint64_t generation = metapp::internal_::getInheritanceGeneration();
+
+	metapp::internal_::storeCanCastCache(from, to, generation, false);
+	REQUIRE(metapp::internal_::findCanCastCache(from, to, generation) == metapp::internal_::CastCacheResult::no);
+	metapp::internal_::storeCanCastCache(from, to, generation, true);
+	REQUIRE(metapp::internal_::findCanCastCache(from, to, generation) == metapp::internal_::CastCacheResult::yes);
+	// A stale generation is a miss
+	REQUIRE(metapp::internal_::findCanCastCache(from, to, generation + 1) == metapp::internal_::CastCacheResult::unknown);
+	// Restore the correct result for other tests
+	metapp::internal_::storeCanCastCache(from, to, generation, false);
+}
+
+TEST_CASE("CastCache, canCast is invalidated by registering base class")
+{
+	CastCacheDerived derived;
+	metapp::Variant v(&derived);
+	REQUIRE(! v.canCast<CastCacheBase *>());
+	REQUIRE(! v.canCast<CastCacheBase *>());
+	{
+		metapp::MetaRepo metaRepo;
+		metaRepo.registerBase<CastCacheDerived, CastCacheBase>();
+		REQUIRE(v.canCast<CastCacheBase *>());
+		REQUIRE(v.canCast<CastCacheBase *>());
+	}
+	// The repo is destroyed, the hierarchy is gone.
+	REQUIRE(! v.canCast<CastCacheBase *>());
+}
+
+TEST_CASE("CastCache, metapp::Variant is not memoized")
+{
+	metapp::Variant holdingInt(metapp::Variant(5));
+	metapp::Variant holdingString(metapp::Variant(std::string("abc")));
+	REQUIRE(holdingInt.canCast<long>());
+	REQUIRE(! holdingString.canCast<long>());
+	REQUIRE(holdingInt.canCast<long>());
+}
+
+TEST_CASE("CastCache, user cast depending on the value is not memoized")
+{
+	const metapp::Variant positive(CastCacheValueCast { 1 });
+	const metapp::Variant negative(CastCacheValueCast { -1 });
+	REQUIRE(positive.canCast<int>());
+	REQUIRE(! negative.canCast<int>());
+	REQUIRE(positive.canCast<int>());
+	REQUIRE(! negative.canCast<int>());
+
+	// A wrong entry in the cache is ignored
+	metapp::internal_::storeCanCastCache(
+		negative.getMetaType(),
+		metapp::getMetaType<int>(),
+		metapp::internal_::getInheritanceGeneration(),
+		true
+	);
+	REQUIRE(! negative.canCast<int>());
+}
+
+TEST_CASE("CastCache, user cast inheriting from CastToTypes is not memoized")
+{
+	const metapp::Variant positive(CastCacheInheritedCast { 1 });
+	const metapp::Variant negative(CastCacheInheritedCast { -1 });
+	REQUIRE(positive.canCast<int>());
+	REQUIRE(! negative.canCast<int>());
+
+	// A wrong entry in the cache is ignored
+	metapp::internal_::storeCanCastCache(
+		negative.getMetaType(),
+		metapp::getMetaType<int>(),
+		metapp::internal_::getInheritanceGeneration(),
+		true
+	);
+	REQUIRE(! negative.canCast<int>());
+}
+
+TEST_CASE("CastCache, pointer which declares castCacheable explicitly is memoized")
+{
+	const char * text = "abc";
+	const metapp::Variant v(text);
+	REQUIRE(v.canCast<std::string>());
+
+	// The result comes from the cache
+	const std::uint64_t generation = metapp::internal_::getInheritanceGeneration();
+	metapp::internal_::storeCanCastCache(v.getMetaType(), metapp::getMetaType<std::string>(), generation, false);
+	REQUIRE(! v.canCast<std::string>());
+	metapp::internal_::storeCanCastCache(v.getMetaType(), metapp::getMetaType<std::string>(), generation, true);
+	REQUIRE(v.canCast<std::string>());
+}
+
+TEST_CASE("CastCache, castCacheable user cast is memoized")
+{
+	const metapp::Variant v(CastCachePureCast { 1 });
+	REQUIRE(v.canCast<int>());
+	REQUIRE(! v.canCast<std::string>());
+
+	// The result comes from the cache
+	const std::uint64_t generation = metapp::internal_::getInheritanceGeneration();
+	metapp::internal_::storeCanCastCache(v.getMetaType(), metapp::getMetaType<std::string>(), generation, true);
+	REQUIRE(v.canCast<std::string>());
+	metapp::internal_::storeCanCastCache(v.getMetaType(), metapp::getMetaType<std::string>(), generation, false);
+	REQUIRE(! v.canCast<std::string>());
+}
+
+TEST_CASE("CastCache, registering items doesn't invalidate the cache")
+{
+	const metapp::Variant v(CastCachePureCast { 1 });
+	// Creating a repo changes the inheritance generation.
+	metapp::MetaRepo metaRepo;
+	const std::uint64_t generation = metapp::internal_::getInheritanceGeneration();
+	REQUIRE(v.canCast<int>());
+	metaRepo.registerVariable("castCacheVariable", 1);
+	REQUIRE(metapp::internal_::getInheritanceGeneration() == generation);
+	REQUIRE(metapp::internal_::findCanCastCache(v.getMetaType(), metapp::getMetaType<int>(), generation)
+		== metapp::internal_::CastCacheResult::yes);
+}
+
+TEST_CASE("CastCache, multiple threads")
+{
+	constexpr int threadCount = 4;
+	std::atomic<int> errorCount(0);
+	std::vector<std::thread> threadList;
+	for(int i = 0; i < threadCount; ++i) {
+		threadList.emplace_back([&errorCount]() {
+			const metapp::Variant intValue(5);
+			const metapp::Variant stringValue(std::string("abc"));
+			for(int k = 0; k < 10000; ++k) {
+				if(! intValue.canCast<double>() || ! intValue.canCast<char>()
+					|| intValue.canCast<std::string>() || stringValue.canCast<int>()
+					|| ! stringValue.canCast<const std::string &>()) {
+					++errorCount;
+				}
+			}
+		});
+	}
+	for(auto & thread : threadList) {
+		thread.join();
+	}
+	REQUIRE(errorCount == 0);
+}
+
+} // namespace
@@ -0,0 +1,138 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/implement/internal/copyonwrite_i.h"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+namespace {
+
+// Counts the live versions.
+struct CountedValue
+{
+	static std::atomic<int> liveCount;
+
+	CountedValue() : valueList() {
+		++liveCount;
+	}
+
+	CountedValue(const CountedValue & other) : valueList(other.valueList) {
+		++liveCount;
+	}
+
+	~CountedValue() {
+		--liveCount;
+	}
+
+	std::vector<int> valueList;
+};
+
+std::atomic<int> CountedValue::liveCount(0);
+
+void appendValue(metapp::internal_::CopyOnWriteValue<CountedValue> & value, const int n)
+{
+	value.update([n](CountedValue & copy) -> bool {
+		copy.valueList.push_back(n);
+		return true;
+	});
+}
+
+TEST_CASE("CopyOnWriteValue, update and read")
+{
+	metapp::internal_::CopyOnWriteValue<CountedValue> value;
+	REQUIRE(value.read()->valueList.empty());
+
+	appendValue(value, 1);
+	appendValue(value, 2);
+	REQUIRE(value.read()->valueList == std::vector<int> { 1, 2 });
+
+	// The copy is discarded if the modifier returns false
+	value.update([](CountedValue & copy) -> bool {
+		copy.valueList.push_back(3);
+		return false;
+	});
+	REQUIRE(value.read()->valueList == std::vector<int> { 1, 2 });
+}
+
+TEST_CASE("CopyOnWriteValue, replaced versions are freed")
+{
+	const int initialCount = CountedValue::liveCount;
+	{
+		metapp::internal_::CopyOnWriteValue<CountedValue> value;
+		for(int i = 0; i < 100; ++i) {
+			appendValue(value, i);
+		}
+		REQUIRE(CountedValue::liveCount == initialCount + 1);
+
+		{
+			// The version held by a reader is kept until the reader leaves
+			const auto reader = value.read();
+			appendValue(value, 100);
+			appendValue(value, 101);
+			REQUIRE(CountedValue::liveCount == initialCount + 3);
+			REQUIRE(reader->valueList.size() == 100);
+		}
+		REQUIRE(CountedValue::liveCount == initialCount + 1);
+		REQUIRE(value.read()->valueList.size() == 102);
+	}
+	REQUIRE(CountedValue::liveCount == initialCount);
+}
+
+TEST_CASE("CopyOnWriteValue, multiple threads")
+{
+	constexpr int readerThreadCount = 3;
+	constexpr int writeCount = 2000;
+	const int initialCount = CountedValue::liveCount;
+	{
+		metapp::internal_::CopyOnWriteValue<CountedValue> value;
+		std::atomic<bool> finished(false);
+		std::atomic<int> errorCount(0);
+		std::vector<std::thread> threadList;
+		for(int i = 0; i < readerThreadCount; ++i) {
+			threadList.emplace_back([&value, &finished, &errorCount]() {
+				while(! finished) {
+					const auto reader = value.read();
+					// Each version holds 0, 1, 2... in order
+					const std::vector<int> & valueList = reader->valueList;
+					for(std::size_t k = 0; k < valueList.size(); ++k) {
+						if(valueList[k] != static_cast<int>(k)) {
+							++errorCount;
+						}
+					}
+				}
+			});
+		}
+		for(int i = 0; i < writeCount; ++i) {
+			appendValue(value, i);
+		}
+		finished = true;
+		for(auto & thread : threadList) {
+			thread.join();
+		}
+		REQUIRE(errorCount == 0);
+		REQUIRE(value.read()->valueList.size() == writeCount);
+		// The last reader or the last read above freed the replaced versions
+		REQUIRE(CountedValue::liveCount == initialCount + 1);
+	}
+	REQUIRE(CountedValue::liveCount == initialCount);
+}
+
+} // namespace
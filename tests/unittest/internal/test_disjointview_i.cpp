@@ -21,6 +21,9 @@
 #include <deque>
 #include <array>
 #include <iostream>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
 
 namespace {
 
@@ -71,6 +74,67 @@ TEST_CASE("DisjointView, [], at")
 	}
 }
 
+TEST_CASE("DisjointView, random access iterator")
+{
+	using ListType = std::deque<int>;
+	using ViewType = metapp::internal_::DisjointView<int, ListType>;
+
+	static_assert(std::is_same<
+		std::iterator_traits<ViewType::iterator>::iterator_category,
+		std::random_access_iterator_tag
+	>::value, "DisjointView iterator must be random access");
+
+	// More containers than smallListSize
+	std::array<ListType, 7> lists {
+		ListType { 1, 2 },
+		ListType {},
+		ListType { 3, 4, 5 },
+		ListType { 6 },
+		ListType { 7, 8 },
+		ListType { 9, 10, 11 },
+		ListType { 12 },
+	};
+	ViewType view;
+	for(auto it = lists.begin(); it != lists.end(); ++it) {
+		view.addContainer(&*it);
+	}
+	REQUIRE(view.size() == 12);
+	REQUIRE(view.end() - view.begin() == 12);
+	REQUIRE(std::distance(view.begin(), view.end()) == 12);
+
+	for(int i = 0; i < 12; ++i) {
+		REQUIRE(view[i] == i + 1);
+		REQUIRE(*(view.begin() + i) == i + 1);
+		REQUIRE(view.begin()[i] == i + 1);
+		REQUIRE(*(view.end() - (12 - i)) == i + 1);
+	}
+	REQUIRE(view.begin() + 12 == view.end());
+
+	SECTION("decrement") {
+		int expected = 12;
+		for(auto it = view.end(); it != view.begin();) {
+			--it;
+			REQUIRE(*it == expected);
+			--expected;
+		}
+		REQUIRE(expected == 0);
+	}
+
+	SECTION("reverse iterator") {
+		std::vector<int> reversed(view.rbegin(), view.rend());
+		REQUIRE(reversed.size() == 12);
+		REQUIRE(reversed.front() == 12);
+		REQUIRE(reversed.back() == 1);
+	}
+
+	SECTION("comparison and algorithms") {
+		REQUIRE(view.begin() < view.end());
+		REQUIRE(view.begin() + 3 >= view.begin() + 3);
+		REQUIRE(std::lower_bound(view.begin(), view.end(), 9) - view.begin() == 8);
+		REQUIRE(*std::find(view.begin(), view.end(), 6) == 6);
+	}
+}
+
 TEST_CASE("DisjointView, end")
 {
 	using ListType = std::deque<int>;
@@ -19,6 +19,8 @@
 #include "metapp/variant.h"
 #include "metapp/allmetatypes.h"
 
+#include <memory>
+
 TEST_CASE("metatypes, Accessor")
 {
 	int n = 5;
@@ -67,6 +69,28 @@ TEST_CASE("metatypes, Accessor, member data, std::map<int, std::string> Class1::
 	REQUIRE(fieldValue.get<const Map &>() == obj.value);
 }
 
+TEST_CASE("metatypes, Accessor, large callables are copied and destroyed")
+{
+	// The callables capture std::shared_ptr, they are not trivially copyable and are stored on the heap.
+	std::shared_ptr<int> value = std::make_shared<int>(5);
+	{
+		metapp::Variant v(metapp::createAccessor<int>(
+			[value]() { return *value; },
+			[value](const int newValue) { *value = newValue; }
+		));
+		REQUIRE(value.use_count() == 3);
+		metapp::Variant copied(v);
+		REQUIRE(value.use_count() == 3);
+		const metapp::Variant cloned = metapp::Variant(v.getMetaType(), v.getAddress());
+		REQUIRE(value.use_count() == 5);
+
+		metapp::accessibleSet(cloned, nullptr, 38);
+		REQUIRE(*value == 38);
+		REQUIRE(metapp::accessibleGet(copied, nullptr).get<int>() == 38);
+	}
+	REQUIRE(value.use_count() == 1);
+}
+
 TEST_CASE("metatypes, Accessor, MetaAccessible, int")
 {
 	int n = 5;
@@ -35,6 +35,7 @@ TEST_CASE("metatypes, tkArray, int[3]")
 	REQUIRE(metaIndexable != nullptr);
 	REQUIRE(metaIndexable->getSizeInfo(v).getSize() == 3);
 	REQUIRE(metaIndexable->get(v, 0).get<int>() == 3);
+	REQUIRE(metaIndexable->getValueType(v, 0) == metapp::getMetaType<int>());
 	REQUIRE(metaIndexable->get(v, 1).get<int>() == 8);
 	REQUIRE(metaIndexable->get(v, 2).get<int>() == 9);
 
@@ -37,4 +37,60 @@ TEST_CASE("metatypes, tkStdAny, std::any")
 	REQUIRE(std::any_cast<int>(v.get<std::any &>()) == 5);
 }
 
+namespace {
+
+struct AnyPoint
+{
+	int x;
+	int y;
+};
+
+} // namespace
+
+TEST_CASE("metatypes, std::any, MetaAccessible")
+{
+	std::any var = std::string("perfect");
+	metapp::Variant v = metapp::Variant::reference(var);
+	REQUIRE(metapp::accessibleGetClassType(v)->isVoid());
+	REQUIRE(! metapp::accessibleIsReadOnly(v));
+	REQUIRE(metapp::accessibleGetValueType(v)->equal(metapp::getMetaType<std::string>()));
+
+	metapp::Variant value = metapp::accessibleGet(v, nullptr);
+	REQUIRE(value.getMetaType()->isReference());
+	value.get<std::string &>() = "good";
+	REQUIRE(std::any_cast<std::string &>(var) == "good");
+
+	metapp::accessibleSet(v, nullptr, "fine");
+	REQUIRE(std::any_cast<std::string &>(var) == "fine");
+
+	var = 5;
+	REQUIRE(metapp::accessibleGet(v, nullptr).get<int>() == 5);
+	metapp::accessibleSet(v, nullptr, 6.5);
+	REQUIRE(std::any_cast<int>(var) == 6);
+
+	var.reset();
+	REQUIRE(metapp::accessibleGetValueType(v)->isVoid());
+	REQUIRE(metapp::accessibleGet(v, nullptr).isEmpty());
+}
+
+TEST_CASE("metatypes, std::any, MetaAccessible, registerStdAnyType")
+{
+	std::any var = AnyPoint { 1, 2 };
+	metapp::Variant v = metapp::Variant::reference(var);
+	REQUIRE(metapp::accessibleGetValueType(v)->isVoid());
+	REQUIRE_THROWS_AS(metapp::accessibleGet(v, nullptr), metapp::UnsupportedException);
+
+	// The registration is permanent, AnyPoint is only used by this test.
+	metapp::registerStdAnyType<AnyPoint>();
+	REQUIRE(metapp::accessibleGetValueType(v)->equal(metapp::getMetaType<AnyPoint>()));
+	metapp::accessibleGet(v, nullptr).get<AnyPoint &>().y = 5;
+	REQUIRE(std::any_cast<AnyPoint &>(var).y == 5);
+
+	// Registering again doesn't replace the published entry
+	const auto * entry = metapp::internal_::StdAnyTypeRegistry::getInstance().findEntry(typeid(AnyPoint));
+	REQUIRE(entry != nullptr);
+	metapp::registerStdAnyType<AnyPoint>();
+	REQUIRE(metapp::internal_::StdAnyTypeRegistry::getInstance().findEntry(typeid(AnyPoint)) == entry);
+}
+
 #endif
@@ -23,6 +23,8 @@
 #include "metapp/variant.h"
 #include "metapp/allmetatypes.h"
 
+#include <memory>
+
 TEST_CASE("metatypes, std::variant<std::string, int, long *>")
 {
 	using Type = std::variant<std::string, int, long *>;
@@ -41,4 +43,52 @@ TEST_CASE("metatypes, std::variant<std::string, int, long *>")
 	REQUIRE(metaType->getUpType(2)->getTypeKind() == metapp::tkPointer);
 }
 
+TEST_CASE("metatypes, std::variant<std::string, int, long *>, MetaAccessible")
+{
+	using Type = std::variant<std::string, int, long *>;
+	Type var("def");
+	metapp::Variant v = metapp::Variant::reference(var);
+	REQUIRE(metapp::accessibleGetClassType(v)->isVoid());
+	REQUIRE(! metapp::accessibleIsReadOnly(v));
+	REQUIRE(metapp::accessibleGetValueType(v)->equal(metapp::getMetaType<std::string>()));
+
+	metapp::Variant value = metapp::accessibleGet(v, nullptr);
+	REQUIRE(value.getMetaType()->isReference());
+	REQUIRE(value.get<const std::string &>() == "def");
+	// The reference is to the value in the std::variant, no copy.
+	value.get<std::string &>() = "abc";
+	REQUIRE(std::get<std::string>(var) == "abc");
+
+	var = 38;
+	REQUIRE(metapp::accessibleGetValueType(v)->equal(metapp::getMetaType<int>()));
+	REQUIRE(metapp::accessibleGet(v, nullptr).get<int>() == 38);
+
+	SECTION("set value of the active alternative") {
+		metapp::accessibleSet(v, nullptr, 5LL);
+		REQUIRE(std::get<int>(var) == 5);
+	}
+
+	SECTION("set value of another alternative") {
+		metapp::accessibleSet(v, nullptr, std::string("hello"));
+		REQUIRE(std::get<std::string>(var) == "hello");
+	}
+
+	SECTION("can't cast") {
+		double n = 1;
+		REQUIRE_THROWS_AS(metapp::accessibleSet(v, nullptr, &n), metapp::BadCastException);
+		REQUIRE(std::get<int>(var) == 38);
+	}
+}
+
+TEST_CASE("metatypes, std::variant<std::unique_ptr<int>, int>, MetaAccessible")
+{
+	using Type = std::variant<std::unique_ptr<int>, int>;
+	Type var(std::make_unique<int>(3));
+	metapp::Variant v = metapp::Variant::reference(var);
+	REQUIRE(*metapp::accessibleGet(v, nullptr).get<std::unique_ptr<int> &>() == 3);
+	metapp::accessibleSet(v, nullptr, 9);
+	REQUIRE(std::get<int>(var) == 9);
+	REQUIRE_THROWS_AS(metapp::accessibleSet(v, nullptr, std::make_shared<int>(1)), metapp::MetaException);
+}
+
 #endif
@@ -0,0 +1,122 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/allmetatypes.h"
+#include "metapp/metatypes/thunk_function.h"
+#include "metapp/interfaces/metaclass.h"
+
+#include <string>
+
+namespace {
+
+struct ThunkPoint
+{
+	int x;
+	std::string name;
+
+	int getX() const { return x; }
+	int getDoubleX() const { return x * 2; }
+	void setName(const std::string & newName) { name = newName; }
+	static int add(int a, int b) { return a + b; }
+};
+
+// The code is the same as the code generated by tools/genregistration.py
+
+using Signature0 = int (ThunkPoint::*)() const;
+
+metapp::Variant thunk0(const void * data, void * instance, const metapp::ArgumentSpan & /*arguments*/)
+{
+	const Signature0 func = *static_cast<const Signature0 *>(data);
+	return metapp::Variant::create<int>((static_cast<ThunkPoint *>(instance)->*func)());
+}
+
+using Signature1 = void (ThunkPoint::*)(const std::string &);
+
+metapp::Variant thunk1(const void * data, void * instance, const metapp::ArgumentSpan & arguments)
+{
+	const Signature1 func = *static_cast<const Signature1 *>(data);
+	(static_cast<ThunkPoint *>(instance)->*func)(
+		arguments[0].cast<const std::string &>().get<const std::string &>()
+	);
+	return metapp::Variant();
+}
+
+using Signature2 = int (*)(int, int);
+
+metapp::Variant thunk2(const void * data, void * /*instance*/, const metapp::ArgumentSpan & arguments)
+{
+	const Signature2 func = *static_cast<const Signature2 *>(data);
+	return metapp::Variant::create<int>((*func)(
+		arguments[0].cast<int>().get<int &>(),
+		arguments[1].cast<int>().get<int &>()
+	));
+}
+
+const Signature0 pointer0 = &ThunkPoint::getX;
+const Signature0 pointer1 = &ThunkPoint::getDoubleX;
+const Signature1 pointer2 = &ThunkPoint::setName;
+const Signature2 pointer3 = &ThunkPoint::add;
+
+TEST_CASE("metatypes, ThunkFunction, member functions share thunk")
+{
+	metapp::Variant getX(metapp::ThunkFunction(&thunk0, &pointer0, metapp::getMetaType<ThunkPoint>(), metapp::getMetaType<int>(), nullptr, 0));
+	metapp::Variant getDoubleX(metapp::ThunkFunction(&thunk0, &pointer1, metapp::getMetaType<ThunkPoint>(), metapp::getMetaType<int>(), nullptr, 0));
+	REQUIRE(metapp::getNonReferenceMetaType(getX)->equal(metapp::getNonReferenceMetaType(getDoubleX)));
+
+	ThunkPoint point { 5, "" };
+	REQUIRE(metapp::callableInvoke(getX, &point).get<int>() == 5);
+	REQUIRE(metapp::callableInvoke(getDoubleX, &point).get<int>() == 10);
+	REQUIRE(metapp::callableGetClassType(getX)->equal(metapp::getMetaType<ThunkPoint>()));
+	REQUIRE(metapp::callableGetReturnType(getX)->equal(metapp::getMetaType<int>()));
+	REQUIRE(metapp::callableGetParameterCountInfo(getX).getResultCount() == 1);
+	REQUIRE(metapp::callableGetParameterCountInfo(getX).getMinParameterCount() == 0);
+	REQUIRE(! metapp::callableIsStatic(getX));
+	REQUIRE(metapp::callableRankInvoke(getX, &point) == metapp::invokeRankMax);
+	REQUIRE(metapp::callableRankInvoke(getX, &point, 1) == metapp::invokeRankNone);
+	REQUIRE_THROWS_AS(metapp::callableInvoke(getX, &point, 1), metapp::IllegalArgumentException);
+
+	static const metapp::MetaType * const parameterTypes[] = { metapp::getMetaType<const std::string &>() };
+	metapp::Variant setName(metapp::ThunkFunction(&thunk1, &pointer2, metapp::getMetaType<ThunkPoint>(), metapp::voidMetaType, parameterTypes, 1));
+	REQUIRE(metapp::callableGetParameterCountInfo(setName).getResultCount() == 0);
+	REQUIRE(metapp::callableGetParameterType(setName, 0)->equal(metapp::getMetaType<const std::string &>()));
+	REQUIRE(metapp::callableGetParameterType(setName, 1)->isVoid());
+	REQUIRE(metapp::callableRankInvoke(setName, &point, std::string("abc")) == metapp::invokeRankMax);
+	REQUIRE(metapp::callableRankInvoke(setName, &point, "abc") == metapp::invokeRankCast);
+	REQUIRE(! metapp::callableCanInvoke(setName, &point, 5));
+	metapp::callableInvoke(setName, &point, "abc");
+	REQUIRE(point.name == "abc");
+}
+
+TEST_CASE("metatypes, ThunkFunction, static function in MetaClass")
+{
+	static const metapp::MetaType * const parameterTypes[] = { metapp::getMetaType<int>(), metapp::getMetaType<int>() };
+	metapp::MetaClass metaClass(metapp::getMetaType<ThunkPoint>(), [](metapp::MetaClass & mc) {
+		mc.registerCallable("add", metapp::ThunkFunction(&thunk2, &pointer3, metapp::voidMetaType, metapp::getMetaType<int>(), parameterTypes, 2));
+		mc.registerCallable("getX", metapp::ThunkFunction(&thunk0, &pointer0, metapp::getMetaType<ThunkPoint>(), metapp::getMetaType<int>(), nullptr, 0));
+	});
+	const metapp::MetaItem & add = metaClass.getCallable("add", metapp::MetaClass::flagNone);
+	REQUIRE(metapp::callableIsStatic(add));
+	REQUIRE(metapp::callableInvoke(add, nullptr, 3, 4.0).get<int>() == 7);
+
+	ThunkPoint point { 8, "" };
+	REQUIRE(metapp::callableInvoke(metaClass.getCallable("getX", metapp::MetaClass::flagNone), &point).get<int>() == 8);
+}
+
+} // namespace
+
@@ -0,0 +1,221 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/asyncinvoke.h"
+#include "metapp/utilities/threadpool.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <exception>
+
+namespace {
+
+struct CountTask : metapp::ExecutorTask
+{
+	CountTask() : metapp::ExecutorTask(&doRun), counter(nullptr) {
+	}
+
+	static void doRun(metapp::ExecutorTask * task) {
+		++*static_cast<CountTask *>(task)->counter;
+	}
+
+	std::atomic<int> * counter;
+};
+
+TEST_CASE("ThreadPool, execute and executeBatch")
+{
+	std::atomic<int> counter(0);
+	std::vector<CountTask> taskList(1000);
+	std::vector<metapp::ExecutorTask *> pointerList;
+	for(auto & task : taskList) {
+		task.counter = &counter;
+		pointerList.push_back(&task);
+	}
+	{
+		metapp::ThreadPool threadPool(4);
+		REQUIRE(threadPool.getThreadCount() == 4);
+		for(std::size_t i = 0; i < 500; ++i) {
+			threadPool.execute(pointerList[i]);
+		}
+		threadPool.executeBatch(pointerList.data() + 500, 500);
+		// The destructor runs all pending tasks
+	}
+	REQUIRE(counter == 1000);
+}
+
+struct ThrowTask : metapp::ExecutorTask
+{
+	ThrowTask() : metapp::ExecutorTask(&doRun) {
+	}
+
+	static void doRun(metapp::ExecutorTask * /*task*/) {
+		throw std::runtime_error("task error");
+	}
+};
+
+TEST_CASE("ThreadPool, the worker keeps running after a task throws")
+{
+	std::atomic<int> counter(0);
+	std::vector<ThrowTask> throwTaskList(8);
+	std::vector<CountTask> taskList(100);
+	{
+		metapp::ThreadPool threadPool(2);
+		for(auto & task : throwTaskList) {
+			threadPool.execute(&task);
+		}
+		for(auto & task : taskList) {
+			task.counter = &counter;
+			threadPool.execute(&task);
+		}
+		// The first exception is kept until it's taken.
+		std::exception_ptr exception;
+		while(! exception) {
+			std::this_thread::yield();
+			exception = threadPool.takeTaskException();
+		}
+		REQUIRE_THROWS_AS(std::rethrow_exception(exception), std::runtime_error);
+	}
+	REQUIRE(counter == 100);
+}
+
+TEST_CASE("ThreadPool, task exception handler")
+{
+	std::atomic<int> exceptionCount(0);
+	std::vector<ThrowTask> throwTaskList(8);
+	{
+		metapp::ThreadPool threadPool(2);
+		threadPool.setTaskExceptionHandler([&exceptionCount](std::exception_ptr exception) {
+			if(exception) {
+				++exceptionCount;
+			}
+		});
+		for(auto & task : throwTaskList) {
+			threadPool.execute(&task);
+		}
+		while(exceptionCount != 8) {
+			std::this_thread::yield();
+		}
+		REQUIRE(! threadPool.takeTaskException());
+	}
+	REQUIRE(exceptionCount == 8);
+}
+
+int asyncMultiply(const int a, const int b)
+{
+	return a * b;
+}
+
+struct AsyncClass
+{
+	std::string greet(const std::string & name) const {
+		return prefix + name;
+	}
+
+	std::string prefix;
+};
+
+TEST_CASE("callableInvokeAsync, free function")
+{
+	metapp::ThreadPool threadPool(2);
+	metapp::Variant func(&asyncMultiply);
+	std::vector<metapp::InvokeFuture> futureList;
+	for(int i = 0; i < 100; ++i) {
+		futureList.push_back(metapp::callableInvokeAsync(threadPool, func, nullptr, i, 3));
+	}
+	for(int i = 0; i < 100; ++i) {
+		REQUIRE(futureList[i].get().get<int>() == i * 3);
+		REQUIRE(futureList[i].isReady());
+	}
+}
+
+TEST_CASE("callableInvokeAsync, member function, arguments are moved into the task")
+{
+	metapp::ThreadPool threadPool(2);
+	AsyncClass obj { "Hello " };
+	metapp::Variant func(&AsyncClass::greet);
+	std::string name("metapp");
+	metapp::InvokeFuture future = metapp::callableInvokeAsync(threadPool, func, &obj, std::move(name));
+	REQUIRE(future.isValid());
+	REQUIRE(future.get().get<const std::string &>() == "Hello metapp");
+}
+
+TEST_CASE("callableInvokeAsync, exception is rethrown by get")
+{
+	metapp::ThreadPool threadPool(1);
+	metapp::Variant func(std::function<int ()>([]() -> int {
+		throw std::runtime_error("failed");
+	}));
+	metapp::InvokeFuture future = metapp::callableInvokeAsync(threadPool, func, nullptr);
+	future.wait();
+	REQUIRE(future.isReady());
+	REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+}
+
+TEST_CASE("callableInvokeAsync, discarded future")
+{
+	std::atomic<int> counter(0);
+	{
+		metapp::ThreadPool threadPool(2);
+		metapp::Variant func(std::function<void ()>([&counter]() {
+			++counter;
+		}));
+		for(int i = 0; i < 100; ++i) {
+			metapp::callableInvokeAsync(threadPool, func, nullptr);
+		}
+	}
+	REQUIRE(counter == 100);
+}
+
+TEST_CASE("callableInvokeAsyncBatch")
+{
+	metapp::ThreadPool threadPool(3);
+	metapp::Variant func(&asyncMultiply);
+	std::vector<metapp::Variant> columnA;
+	std::vector<metapp::Variant> columnB;
+	for(int i = 0; i < 200; ++i) {
+		columnA.push_back(i);
+		columnB.push_back(i + 1);
+	}
+	const metapp::ArgumentSpan columns[] = { columnA, columnB };
+	std::vector<metapp::InvokeFuture> futureList(200);
+	metapp::callableInvokeAsyncBatch(threadPool, func, {}, columns, futureList);
+	for(int i = 0; i < 200; ++i) {
+		REQUIRE(futureList[i].get().get<int>() == i * (i + 1));
+	}
+
+	std::vector<metapp::InvokeFuture> wrongSizeList(3);
+	REQUIRE_THROWS(metapp::callableInvokeAsyncBatch(threadPool, func, {}, columns, wrongSizeList));
+}
+
+TEST_CASE("callableInvokeAsync, nested tasks on the default pool")
+{
+	metapp::Variant inner(&asyncMultiply);
+	metapp::Variant outer(std::function<int (int)>([&inner](const int n) -> int {
+		return metapp::callableInvokeAsync(metapp::getDefaultThreadPool(), inner, nullptr, n, 2).get().get<int>();
+	}));
+	metapp::InvokeFuture future = metapp::callableInvokeAsync(metapp::getDefaultThreadPool(), outer, nullptr, 21);
+	REQUIRE(future.get().get<int>() == 42);
+}
+
+
+} // namespace
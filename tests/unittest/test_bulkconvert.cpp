@@ -0,0 +1,285 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/bulkconvert.h"
+#include "metapp/allmetatypes.h"
+
+#include <vector>
+#include <array>
+#include <deque>
+#include <list>
+#include <string>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+template <typename From, typename To>
+void checkBulkConvert()
+{
+	// The count is not a multiple of any vector width, so the scalar tail is tested too.
+	constexpr std::size_t count = 37;
+	From source[count];
+	for(std::size_t i = 0; i < count; ++i) {
+		source[i] = static_cast<From>((i * 7) % 100);
+	}
+	To destination[count] = {};
+	metapp::bulkConvert(
+		source, metapp::getMetaType<From>()->getTypeKind(),
+		count,
+		destination, metapp::getMetaType<To>()->getTypeKind()
+	);
+	for(std::size_t i = 0; i < count; ++i) {
+		REQUIRE(destination[i] == static_cast<To>(source[i]));
+	}
+}
+
+template <typename From, typename ...Tos>
+void checkBulkConvertRow(metapp::TypeList<Tos...>)
+{
+	using Expander = int[];
+	(void)Expander { 0, (checkBulkConvert<From, Tos>(), 0)... };
+}
+
+template <typename ...Froms>
+void checkBulkConvertAll(metapp::TypeList<Froms...>)
+{
+	using Expander = int[];
+	(void)Expander { 0, (checkBulkConvertRow<Froms>(metapp::internal_::ArithmeticTypeList()), 0)... };
+}
+
+template <typename From, typename To>
+void checkBulkConvertSigned()
+{
+	constexpr std::size_t count = 41;
+	From source[count];
+	for(std::size_t i = 0; i < count; ++i) {
+		source[i] = static_cast<From>(((double)i - 20.0) * 1.75);
+	}
+	To destination[count] = {};
+	metapp::bulkConvert(
+		source, metapp::getMetaType<From>()->getTypeKind(),
+		count,
+		destination, metapp::getMetaType<To>()->getTypeKind()
+	);
+	for(std::size_t i = 0; i < count; ++i) {
+		REQUIRE(destination[i] == static_cast<To>(source[i]));
+	}
+}
+
+template <typename From, typename To>
+To getSaturated(const From value)
+{
+	if(value != value) {
+		return 0;
+	}
+	if(value >= From(2) * static_cast<From>(std::numeric_limits<To>::max() / 2 + 1)) {
+		return std::numeric_limits<To>::max();
+	}
+	if(value <= static_cast<From>(std::numeric_limits<To>::lowest())) {
+		return std::numeric_limits<To>::lowest();
+	}
+	return static_cast<To>(value);
+}
+
+template <typename From, typename To>
+void checkBulkConvertSaturated()
+{
+	const From valueList[] = {
+		std::numeric_limits<From>::quiet_NaN(),
+		std::numeric_limits<From>::infinity(),
+		-std::numeric_limits<From>::infinity(),
+		std::numeric_limits<From>::max(),
+		std::numeric_limits<From>::lowest(),
+		static_cast<From>(1e10),
+		static_cast<From>(-1e10),
+		static_cast<From>(1e20),
+		static_cast<From>(-1e20),
+		static_cast<From>(2147483648.0),
+		static_cast<From>(-2147483648.0),
+		static_cast<From>(-2147483904.0),
+		static_cast<From>(9223372036854775808.0),
+		static_cast<From>(-9223372036854775808.0),
+		static_cast<From>(300.5),
+		static_cast<From>(-300.5),
+		static_cast<From>(-0.5),
+		static_cast<From>(65535.75),
+		static_cast<From>(3.25),
+	};
+	constexpr std::size_t valueCount = sizeof(valueList) / sizeof(valueList[0]);
+	// Repeat the values so all of them are in the vector lanes, and in the scalar tail.
+	constexpr std::size_t count = valueCount * 3 + 5;
+	From source[count];
+	for(std::size_t i = 0; i < count; ++i) {
+		source[i] = valueList[i % valueCount];
+	}
+	To destination[count] = {};
+	metapp::bulkConvert(
+		source, metapp::getMetaType<From>()->getTypeKind(),
+		count,
+		destination, metapp::getMetaType<To>()->getTypeKind()
+	);
+	for(std::size_t i = 0; i < count; ++i) {
+		REQUIRE(destination[i] == getSaturated<From, To>(source[i]));
+	}
+}
+
+const metapp::BulkConvertIsa isaList[] = {
+	metapp::BulkConvertIsa::scalar,
+	metapp::BulkConvertIsa::sse2,
+	metapp::BulkConvertIsa::avx2,
+	metapp::BulkConvertIsa::avx512,
+};
+
+struct BulkConvertIsaRestorer
+{
+	BulkConvertIsaRestorer() : isa(metapp::getBulkConvertIsa()) {}
+	~BulkConvertIsaRestorer() {
+		metapp::setBulkConvertIsa(isa);
+	}
+
+	metapp::BulkConvertIsa isa;
+};
+
+TEST_CASE("bulkConvert, all arithmetic types, all instruction sets")
+{
+	BulkConvertIsaRestorer restorer;
+	for(const metapp::BulkConvertIsa isa : isaList) {
+		const metapp::BulkConvertIsa actualIsa = metapp::setBulkConvertIsa(isa);
+		REQUIRE((int)actualIsa <= (int)isa);
+		REQUIRE(metapp::getBulkConvertIsa() == actualIsa);
+		checkBulkConvertAll(metapp::internal_::ArithmeticTypeList());
+	}
+}
+
+TEST_CASE("bulkConvert, negative and fractional values, all instruction sets")
+{
+	BulkConvertIsaRestorer restorer;
+	for(const metapp::BulkConvertIsa isa : isaList) {
+		metapp::setBulkConvertIsa(isa);
+		checkBulkConvertSigned<std::int32_t, double>();
+		checkBulkConvertSigned<std::int32_t, float>();
+		checkBulkConvertSigned<float, double>();
+		checkBulkConvertSigned<double, float>();
+		checkBulkConvertSigned<float, std::int32_t>();
+		checkBulkConvertSigned<double, std::int32_t>();
+		checkBulkConvertSigned<std::int64_t, double>();
+		checkBulkConvertSigned<double, std::int64_t>();
+		checkBulkConvertSigned<std::int64_t, float>();
+		checkBulkConvertSigned<float, std::int64_t>();
+	}
+}
+
+TEST_CASE("bulkConvert, floating point to integer saturates, all instruction sets")
+{
+	BulkConvertIsaRestorer restorer;
+	for(const metapp::BulkConvertIsa isa : isaList) {
+		metapp::setBulkConvertIsa(isa);
+		checkBulkConvertSaturated<float, std::int32_t>();
+		checkBulkConvertSaturated<double, std::int32_t>();
+		checkBulkConvertSaturated<float, std::int64_t>();
+		checkBulkConvertSaturated<double, std::int64_t>();
+		checkBulkConvertSaturated<float, std::uint32_t>();
+		checkBulkConvertSaturated<double, std::uint64_t>();
+		checkBulkConvertSaturated<double, std::int16_t>();
+		checkBulkConvertSaturated<float, std::uint8_t>();
+		checkBulkConvertSaturated<long double, std::int64_t>();
+	}
+}
+
+TEST_CASE("bulkConvert, not arithmetic")
+{
+	REQUIRE(! metapp::canBulkConvert(metapp::tkStdString, metapp::tkInt));
+	REQUIRE(metapp::canBulkConvert(metapp::tkBool, metapp::tkLongDouble));
+	int source = 0;
+	std::string destination;
+	REQUIRE_THROWS_AS(
+		metapp::bulkConvert(&source, metapp::tkInt, 1, &destination, metapp::tkStdString),
+		metapp::UnsupportedException
+	);
+}
+
+TEST_CASE("bulkConvert, indexables")
+{
+	SECTION("std::vector to std::vector, the destination is resized") {
+		std::vector<int> source { 1, 2, 3, 4, 5 };
+		std::vector<double> destination;
+		REQUIRE(metapp::bulkConvert(metapp::Variant::reference(source), metapp::Variant::reference(destination)) == 5);
+		REQUIRE(destination == std::vector<double> { 1, 2, 3, 4, 5 });
+	}
+
+	SECTION("std::array and C array") {
+		std::array<float, 3> source { { 1.5f, -2.5f, 3.0f } };
+		long long destination[3] = {};
+		REQUIRE(metapp::bulkConvert(metapp::Variant::reference(source), metapp::Variant::reference(destination)) == 3);
+		REQUIRE(destination[0] == 1);
+		REQUIRE(destination[1] == -2);
+		REQUIRE(destination[2] == 3);
+	}
+
+	SECTION("non contiguous containers are converted element by element") {
+		std::list<int> source { 1, 2, 3 };
+		std::deque<double> destination;
+		REQUIRE(metapp::bulkConvert(metapp::Variant::reference(source), metapp::Variant::reference(destination)) == 3);
+		REQUIRE(destination == std::deque<double> { 1, 2, 3 });
+	}
+
+	SECTION("non contiguous containers saturate the same as contiguous containers") {
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+		std::list<double> source { 1e20, -1e20, nan, 2.5 };
+		std::deque<std::int32_t> destination;
+		REQUIRE(metapp::bulkConvert(metapp::Variant::reference(source), metapp::Variant::reference(destination)) == 4);
+		REQUIRE(destination == std::deque<std::int32_t> {
+			std::numeric_limits<std::int32_t>::max(), std::numeric_limits<std::int32_t>::min(), 0, 2
+		});
+
+		std::vector<double> contiguousSource(source.begin(), source.end());
+		std::vector<std::int32_t> contiguousDestination;
+		metapp::bulkConvert(metapp::Variant::reference(contiguousSource), metapp::Variant::reference(contiguousDestination));
+		REQUIRE(std::equal(destination.begin(), destination.end(), contiguousDestination.begin()));
+	}
+
+	SECTION("non arithmetic elements are converted element by element") {
+		std::vector<const char *> source { "a", "b" };
+		std::vector<std::string> destination;
+		REQUIRE(metapp::bulkConvert(metapp::Variant::reference(source), metapp::Variant::reference(destination)) == 2);
+		REQUIRE(destination == std::vector<std::string> { "a", "b" });
+	}
+
+	SECTION("destination is too small") {
+		std::vector<int> source { 1, 2, 3 };
+		std::array<double, 2> destination {};
+		REQUIRE_THROWS_AS(
+			metapp::bulkConvert(metapp::Variant::reference(source), metapp::Variant::reference(destination)),
+			metapp::OutOfRangeException
+		);
+	}
+
+	SECTION("not indexable") {
+		int source = 1;
+		std::vector<double> destination;
+		REQUIRE_THROWS_AS(
+			metapp::bulkConvert(metapp::Variant::reference(source), metapp::Variant::reference(destination)),
+			metapp::UnsupportedException
+		);
+	}
+}
+
+} // namespace
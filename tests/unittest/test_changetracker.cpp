@@ -0,0 +1,409 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test.h"
+
+#include "metapp/utilities/changetracker.h"
+#include "metapp/utilities/dynamicobject.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/metarepo.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+
+namespace {
+
+metapp::MetaRepo trackMetaRepo;
+
+struct TrackBase
+{
+	int id;
+};
+
+struct TrackPlayer : TrackBase
+{
+	std::string name;
+	int score;
+	double speed;
+	std::vector<int> items;
+	std::map<std::string, int> stats;
+
+	int getLevel() const {
+		return level;
+	}
+
+	void setLevel(const int value) {
+		level = value;
+	}
+
+	int level;
+};
+
+// Untracks the instance when the test ends, even if the test fails.
+struct TrackGuard
+{
+	explicit TrackGuard(const metapp::Variant & instance) : instance(instance) {
+		metapp::ChangeTracker::track(instance);
+	}
+
+	~TrackGuard() {
+		metapp::ChangeTracker::untrack(instance);
+	}
+
+	metapp::Variant instance;
+};
+
+std::vector<std::string> getChangedNames(const metapp::Variant & instance, const std::uint64_t sinceGeneration)
+{
+	std::vector<std::string> nameList;
+	for(const metapp::ChangedField & field : metapp::ChangeTracker::getChangedFields(instance, sinceGeneration)) {
+		nameList.push_back(field.name);
+	}
+	return nameList;
+}
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <TrackBase> : metapp::DeclareMetaTypeBase <TrackBase>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<TrackBase>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("id", &TrackBase::id);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <TrackPlayer> : metapp::DeclareMetaTypeBase <TrackPlayer>
+{
+	static void setup()
+	{
+		trackMetaRepo.registerBase<TrackPlayer, TrackBase>();
+	}
+
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<TrackPlayer>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("name", &TrackPlayer::name);
+				mc.registerAccessible("score", &TrackPlayer::score);
+				mc.registerAccessible("speed", &TrackPlayer::speed);
+				mc.registerAccessible("items", &TrackPlayer::items);
+				mc.registerAccessible("stats", &TrackPlayer::stats);
+				mc.registerAccessible("level", metapp::createAccessor<int>(&TrackPlayer::getLevel, &TrackPlayer::setLevel));
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+const metapp::Variant & getPlayerAccessible(const std::string & name)
+{
+	return metapp::getMetaType<TrackPlayer>()->getMetaClass()->getAccessible(name).asAccessible();
+}
+
+TEST_CASE("ChangeTracker, track and untrack")
+{
+	TrackPlayer player {};
+	const std::size_t trackedCount = metapp::ChangeTracker::getTrackedCount();
+	REQUIRE(! metapp::ChangeTracker::isTracked(&player));
+
+	metapp::ChangeTracker::track(&player);
+	REQUIRE(metapp::ChangeTracker::isTracked(&player));
+	REQUIRE(metapp::ChangeTracker::isTracked(metapp::Variant::reference(player)));
+	// The same address with another type is another instance.
+	REQUIRE(! metapp::ChangeTracker::isTracked(metapp::Variant::reference(static_cast<TrackBase &>(player))));
+	metapp::ChangeTracker::track(metapp::Variant::reference(player));
+	REQUIRE(metapp::ChangeTracker::getTrackedCount() == trackedCount + 1);
+
+	metapp::ChangeTracker::untrack(&player);
+	REQUIRE(! metapp::ChangeTracker::isTracked(&player));
+	REQUIRE(metapp::ChangeTracker::getTrackedCount() == trackedCount);
+
+	REQUIRE_THROWS_AS(metapp::ChangeTracker::track((TrackPlayer *)nullptr), metapp::IllegalArgumentException);
+}
+
+TEST_CASE("ChangeTracker, accessibleSet")
+{
+	TrackPlayer player {};
+	TrackPlayer untrackedPlayer {};
+	const metapp::Variant instance = metapp::Variant::reference(player);
+	TrackGuard guard(instance);
+
+	const std::uint64_t start = metapp::ChangeTracker::getGeneration();
+	REQUIRE(metapp::ChangeTracker::getGeneration(instance) == 0);
+	REQUIRE(metapp::ChangeTracker::getChangedFields(instance, start).empty());
+
+	metapp::accessibleSet(getPlayerAccessible("score"), instance, 5);
+	metapp::accessibleSet(getPlayerAccessible("name"), &player, "Bob");
+	metapp::accessibleSet(getPlayerAccessible("score"), instance, 6);
+	metapp::accessibleSet(getPlayerAccessible("score"), &untrackedPlayer, 7);
+	REQUIRE(player.score == 6);
+	REQUIRE(player.name == "Bob");
+
+	const std::uint64_t afterScore = metapp::ChangeTracker::getGeneration();
+	REQUIRE(metapp::ChangeTracker::getGeneration(instance) == afterScore);
+	REQUIRE(afterScore == start + 3);
+	// The latest first, each field once.
+	REQUIRE(getChangedNames(instance, start) == std::vector<std::string> { "score", "name" });
+	REQUIRE(getChangedNames(instance, start + 1) == std::vector<std::string> { "score", "name" });
+	REQUIRE(getChangedNames(instance, start + 2) == std::vector<std::string> { "score" });
+	REQUIRE(getChangedNames(instance, afterScore).empty());
+
+	SECTION("the changed field has the accessible and the generation") {
+		const std::vector<metapp::ChangedField> fieldList = metapp::ChangeTracker::getChangedFields(instance, start);
+		REQUIRE(fieldList[0].type == metapp::ChangedFieldType::accessible);
+		REQUIRE(fieldList[0].generation == afterScore);
+		REQUIRE(fieldList[1].generation == start + 2);
+		REQUIRE(metapp::accessibleGet(fieldList[0].accessible, instance).get<int>() == 6);
+	}
+
+	SECTION("base class, accessor, tryAccessibleSet") {
+		metapp::accessibleSet(getPlayerAccessible("id"), instance, 9);
+		metapp::accessibleSet(getPlayerAccessible("level"), instance, 3);
+		REQUIRE(metapp::tryAccessibleSet(getPlayerAccessible("speed"), instance, 1.5) == metapp::ErrorCode::ok);
+		REQUIRE(metapp::tryAccessibleSet(getPlayerAccessible("speed"), instance, std::string()) == metapp::ErrorCode::badCast);
+		REQUIRE(player.level == 3);
+		REQUIRE(getChangedNames(instance, afterScore) == std::vector<std::string> { "speed", "level", "id" });
+	}
+
+	SECTION("a copy of the accessible is the same field") {
+		const metapp::Variant score(&TrackPlayer::score);
+		metapp::accessibleSet(score, instance, 8);
+		REQUIRE(getChangedNames(instance, afterScore) == std::vector<std::string> { "score" });
+	}
+
+	SECTION("accessible not registered in the class") {
+		const metapp::Variant level = metapp::createAccessor<int>(&TrackPlayer::getLevel, &TrackPlayer::setLevel);
+		metapp::accessibleSet(level, instance, 2);
+		const std::vector<metapp::ChangedField> fieldList = metapp::ChangeTracker::getChangedFields(instance, afterScore);
+		REQUIRE(fieldList.size() == 1);
+		REQUIRE(fieldList[0].name.empty());
+		REQUIRE(metapp::accessibleGet(fieldList[0].accessible, instance).get<int>() == 2);
+	}
+
+	SECTION("markChanged") {
+		player.speed = 3;
+		metapp::ChangeTracker::markChanged(instance, getPlayerAccessible("speed"));
+		REQUIRE(getChangedNames(instance, afterScore) == std::vector<std::string> { "speed" });
+	}
+
+	SECTION("untracked instance has no changes") {
+		metapp::ChangeTracker::untrack(instance);
+		metapp::accessibleSet(getPlayerAccessible("score"), instance, 1);
+		REQUIRE(metapp::ChangeTracker::getGeneration() == afterScore);
+		REQUIRE(metapp::ChangeTracker::getChangedFields(instance, start).empty());
+		REQUIRE(metapp::ChangeTracker::getGeneration(instance) == 0);
+	}
+}
+
+TEST_CASE("ChangeTracker, indexableSet and mappableSet")
+{
+	TrackPlayer player {};
+	player.items = { 1, 2, 3 };
+	const metapp::Variant instance = metapp::Variant::reference(player);
+	const metapp::Variant items = metapp::accessibleGet(getPlayerAccessible("items"), instance);
+	const metapp::Variant stats = metapp::accessibleGet(getPlayerAccessible("stats"), instance);
+	TrackGuard playerGuard(instance);
+	TrackGuard itemsGuard(items);
+	TrackGuard statsGuard(stats);
+
+	const std::uint64_t start = metapp::ChangeTracker::getGeneration();
+	metapp::indexableSet(items, 2, 30);
+	metapp::indexableSet(items, 0, 10);
+	metapp::indexableSet(items, 2, 31);
+	metapp::mappableSet(stats, "hp", 100);
+	metapp::mappableSet(stats, std::string("mp"), 50);
+	metapp::mappableSet(stats, "hp", 90);
+	REQUIRE(player.items == std::vector<int> { 10, 2, 31 });
+	REQUIRE(player.stats["hp"] == 90);
+
+	std::vector<metapp::ChangedField> fieldList = metapp::ChangeTracker::getChangedFields(items, start);
+	REQUIRE(fieldList.size() == 2);
+	REQUIRE(fieldList[0].type == metapp::ChangedFieldType::index);
+	REQUIRE(fieldList[0].index == 2);
+	REQUIRE(fieldList[1].index == 0);
+
+	fieldList = metapp::ChangeTracker::getChangedFields(stats, start);
+	REQUIRE(fieldList.size() == 2);
+	REQUIRE(fieldList[0].type == metapp::ChangedFieldType::key);
+	REQUIRE(fieldList[0].key.get<const std::string &>() == "hp");
+	REQUIRE(fieldList[1].key.get<const std::string &>() == "mp");
+
+	// The writes to the containers are not the changes of the object.
+	REQUIRE(metapp::ChangeTracker::getChangedFields(instance, start).empty());
+
+	SECTION("integral keys") {
+		std::map<int, std::string> names;
+		const metapp::Variant mappable = metapp::Variant::reference(names);
+		TrackGuard guard(mappable);
+		const std::uint64_t generation = metapp::ChangeTracker::getGeneration();
+		metapp::mappableSet(mappable, 3, "a");
+		metapp::mappableSet(mappable, 3LL, "b");
+		fieldList = metapp::ChangeTracker::getChangedFields(mappable, generation);
+		REQUIRE(fieldList.size() == 1);
+		REQUIRE(fieldList[0].key.get<long long>() == 3);
+		REQUIRE(names[3] == "b");
+	}
+
+	SECTION("DynamicObject") {
+		metapp::DynamicObject object;
+		const metapp::Variant mappable = metapp::Variant::reference(object);
+		TrackGuard guard(mappable);
+		const std::uint64_t generation = metapp::ChangeTracker::getGeneration();
+		metapp::mappableSet(mappable, "x", 1);
+		metapp::mappableSet(mappable, "y", 2);
+		metapp::mappableSet(mappable, "x", 3);
+		fieldList = metapp::ChangeTracker::getChangedFields(mappable, generation);
+		REQUIRE(fieldList.size() == 2);
+		REQUIRE(fieldList[0].key.get<const std::string &>() == "x");
+		REQUIRE(fieldList[1].key.get<const std::string &>() == "y");
+	}
+}
+
+TEST_CASE("ChangeTracker, the changes of fields and elements are merged by generation")
+{
+	// markChanged records an accessible change on the std::vector, so it has both kinds of changes.
+	std::vector<int> list { 1, 2 };
+	const metapp::Variant listInstance = metapp::Variant::reference(list);
+	TrackGuard guard(listInstance);
+	const std::uint64_t start = metapp::ChangeTracker::getGeneration();
+	metapp::indexableSet(listInstance, 0, 5);
+	metapp::ChangeTracker::markChanged(listInstance, getPlayerAccessible("score"));
+	metapp::indexableSet(listInstance, 1, 6);
+	const std::vector<metapp::ChangedField> fieldList = metapp::ChangeTracker::getChangedFields(listInstance, start);
+	REQUIRE(fieldList.size() == 3);
+	REQUIRE(fieldList[0].type == metapp::ChangedFieldType::index);
+	REQUIRE(fieldList[0].index == 1);
+	REQUIRE(fieldList[1].type == metapp::ChangedFieldType::accessible);
+	REQUIRE(fieldList[2].index == 0);
+	REQUIRE(fieldList[0].generation > fieldList[1].generation);
+	REQUIRE(fieldList[1].generation > fieldList[2].generation);
+}
+
+TEST_CASE("ChangeTracker, getChangedInstances")
+{
+	TrackPlayer player1 {};
+	TrackPlayer player2 {};
+	TrackPlayer player3 {};
+	TrackGuard guard1(&player1);
+	TrackGuard guard2(&player2);
+	TrackGuard guard3(&player3);
+	const std::uint64_t start = metapp::ChangeTracker::getGeneration();
+	REQUIRE(metapp::ChangeTracker::getChangedInstances(start).empty());
+
+	metapp::accessibleSet(getPlayerAccessible("score"), &player1, 1);
+	metapp::accessibleSet(getPlayerAccessible("score"), &player3, 2);
+	metapp::accessibleSet(getPlayerAccessible("name"), &player1, "a");
+
+	std::vector<metapp::ChangedInstance> instanceList = metapp::ChangeTracker::getChangedInstances(start);
+	REQUIRE(instanceList.size() == 2);
+	REQUIRE(instanceList[0].address == &player1);
+	REQUIRE(instanceList[0].metaType == metapp::getMetaType<TrackPlayer>());
+	REQUIRE(instanceList[0].generation == start + 3);
+	REQUIRE(instanceList[0].fieldList.size() == 2);
+	REQUIRE(instanceList[0].fieldList[0].name == "name");
+	REQUIRE(instanceList[0].fieldList[1].name == "score");
+	REQUIRE(instanceList[1].address == &player3);
+	REQUIRE(instanceList[1].fieldList.size() == 1);
+
+	// Only the fields changed after the generation are listed.
+	instanceList = metapp::ChangeTracker::getChangedInstances(start + 2);
+	REQUIRE(instanceList.size() == 1);
+	REQUIRE(instanceList[0].fieldList.size() == 1);
+	REQUIRE(instanceList[0].fieldList[0].name == "name");
+
+	metapp::ChangeTracker::untrack(&player1);
+	instanceList = metapp::ChangeTracker::getChangedInstances(start);
+	REQUIRE(instanceList.size() == 1);
+	REQUIRE(instanceList[0].address == &player3);
+
+	// The id of the untracked instance is reused.
+	TrackPlayer player4 {};
+	TrackGuard guard4(&player4);
+	metapp::accessibleSet(getPlayerAccessible("score"), &player4, 3);
+	instanceList = metapp::ChangeTracker::getChangedInstances(start);
+	REQUIRE(instanceList.size() == 2);
+	REQUIRE(instanceList[0].address == &player4);
+	REQUIRE(instanceList[1].address == &player3);
+}
+
+TEST_CASE("ChangeTracker, many tracked and untracked instances")
+{
+	// The untracked instances share the address filter slots with the tracked instances.
+	constexpr std::size_t playerCount = 10000;
+	std::vector<TrackPlayer> playerList(playerCount);
+	for(std::size_t i = 0; i < playerCount; i += 2) {
+		metapp::ChangeTracker::track(&playerList[i]);
+	}
+	const std::uint64_t start = metapp::ChangeTracker::getGeneration();
+	for(TrackPlayer & player : playerList) {
+		metapp::accessibleSet(getPlayerAccessible("score"), &player, 1);
+	}
+	REQUIRE(metapp::ChangeTracker::getGeneration() == start + playerCount / 2);
+	REQUIRE(metapp::ChangeTracker::getChangedInstances(start).size() == playerCount / 2);
+	for(std::size_t i = 0; i < playerCount; i += 2) {
+		metapp::ChangeTracker::untrack(&playerList[i]);
+	}
+
+	// After the instances are untracked, the writes are not recorded.
+	const std::uint64_t end = metapp::ChangeTracker::getGeneration();
+	for(TrackPlayer & player : playerList) {
+		metapp::accessibleSet(getPlayerAccessible("score"), &player, 2);
+	}
+	REQUIRE(metapp::ChangeTracker::getGeneration() == end);
+}
+
+TEST_CASE("ChangeTracker, write on several threads")
+{
+	constexpr int threadCount = 4;
+	constexpr int writeCount = 1000;
+	std::vector<TrackPlayer> playerList(threadCount);
+	for(TrackPlayer & player : playerList) {
+		metapp::ChangeTracker::track(&player);
+	}
+	const std::uint64_t start = metapp::ChangeTracker::getGeneration();
+
+	std::vector<std::thread> threadList;
+	for(int i = 0; i < threadCount; ++i) {
+		threadList.emplace_back([i, &playerList]() {
+			for(int k = 0; k < writeCount; ++k) {
+				metapp::accessibleSet(getPlayerAccessible(k % 2 == 0 ? "score" : "speed"), &playerList[i], k);
+			}
+		});
+	}
+	for(std::thread & thread : threadList) {
+		thread.join();
+	}
+
+	REQUIRE(metapp::ChangeTracker::getGeneration() == start + threadCount * writeCount);
+	for(TrackPlayer & player : playerList) {
+		REQUIRE(getChangedNames(&player, start) == std::vector<std::string> { "speed", "score" });
+		metapp::ChangeTracker::untrack(&player);
+	}
+}
+
+} // namespace
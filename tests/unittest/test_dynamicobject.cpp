@@ -0,0 +1,267 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/dynamicobject.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/interfaces/metamappable.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+TEST_CASE("DynamicObject, set, get, find")
+{
+	metapp::DynamicObject object;
+	REQUIRE(object.getPropertyCount() == 0);
+	REQUIRE(object.getShape() == metapp::DynamicShape::getRoot());
+	REQUIRE(object.get("x").isEmpty());
+	REQUIRE(object.find("x") == nullptr);
+
+	object.set("x", 5);
+	object.set("name", std::string("abc"));
+	REQUIRE(object.getPropertyCount() == 2);
+	REQUIRE(object.hasProperty("x"));
+	REQUIRE(object.get("x").get<int>() == 5);
+	REQUIRE(object.get("name").get<const std::string &>() == "abc");
+	REQUIRE(object.find("name")->get<const std::string &>() == "abc");
+
+	const metapp::DynamicShape * shape = object.getShape();
+	object.set("x", 38.5);
+	REQUIRE(object.getShape() == shape);
+	REQUIRE(object.get("x").get<double>() == 38.5);
+}
+
+TEST_CASE("DynamicObject, objects with the same properties in the same order share the shape")
+{
+	metapp::DynamicObject a;
+	a.set("x", 1);
+	a.set("y", 2);
+	metapp::DynamicObject b;
+	b.set("x", 3);
+	b.set("y", 4);
+	metapp::DynamicObject c;
+	c.set("y", 5);
+	c.set("x", 6);
+	REQUIRE(a.getShape() == b.getShape());
+	REQUIRE(a.getShape() != c.getShape());
+	REQUIRE(a.getShape()->getParent() == metapp::DynamicShape::getRoot()->addProperty("x"));
+	REQUIRE(a.getShape()->getPropertyName(0) == "x");
+	REQUIRE(a.getShape()->getPropertyName(1) == "y");
+	REQUIRE(c.getShape()->findSlot("x") == 1);
+	REQUIRE(c.getShape()->findSlot("z") == metapp::DynamicShape::npos);
+
+	metapp::DynamicObject d(a.getShape());
+	REQUIRE(d.getPropertyCount() == 2);
+	REQUIRE(d.getSlot(0).isEmpty());
+	d.set("y", 7);
+	REQUIRE(d.getShape() == a.getShape());
+	REQUIRE(d.getSlot(1).get<int>() == 7);
+}
+
+TEST_CASE("DynamicObject, remove")
+{
+	metapp::DynamicObject object;
+	object.set("a", 1);
+	object.set("b", 2);
+	object.set("c", 3);
+	REQUIRE(! object.remove("d"));
+	REQUIRE(object.remove("b"));
+	REQUIRE(object.getPropertyCount() == 2);
+	REQUIRE(! object.hasProperty("b"));
+	REQUIRE(object.get("a").get<int>() == 1);
+	REQUIRE(object.get("c").get<int>() == 3);
+
+	metapp::DynamicObject other;
+	other.set("a", 4);
+	other.set("c", 5);
+	REQUIRE(object.getShape() == other.getShape());
+}
+
+TEST_CASE("DynamicObject, many properties")
+{
+	metapp::DynamicObject object;
+	for(int i = 0; i < 50; ++i) {
+		object.set("property" + std::to_string(i), i);
+	}
+	REQUIRE(object.getPropertyCount() == 50);
+	for(int i = 0; i < 50; ++i) {
+		REQUIRE(object.getShape()->findSlot("property" + std::to_string(i)) == (std::size_t)i);
+		REQUIRE(object.get("property" + std::to_string(i)).get<int>() == i);
+	}
+	REQUIRE(object.getShape()->findSlot("property50") == metapp::DynamicShape::npos);
+}
+
+TEST_CASE("DynamicShape, child shapes only add one name to the parent")
+{
+	const metapp::DynamicShape * shape = metapp::DynamicShape::getRoot();
+	std::vector<const metapp::DynamicShape *> shapeList;
+	for(int i = 0; i < 30; ++i) {
+		shape = shape->addProperty("p" + std::to_string(i));
+		shapeList.push_back(shape);
+	}
+	for(int i = 0; i < 30; ++i) {
+		const metapp::DynamicShape * current = shapeList[i];
+		REQUIRE(current->getPropertyCount() == (std::size_t)i + 1);
+		REQUIRE(current->getParent() == (i == 0 ? metapp::DynamicShape::getRoot() : shapeList[i - 1]));
+		REQUIRE(current->getPropertyName((std::size_t)i) == "p" + std::to_string(i));
+		REQUIRE(current->getPropertyName(0) == "p0");
+		REQUIRE(current->findSlot("p" + std::to_string(i)) == (std::size_t)i);
+		REQUIRE(current->findSlot("p" + std::to_string(i + 1)) == metapp::DynamicShape::npos);
+		// Adding an existing property returns the same shape, no matter the lookup is built or not.
+		REQUIRE(current->addProperty("p0") == current);
+	}
+	REQUIRE(shapeList[29]->addProperty("p15") == shapeList[29]);
+	REQUIRE(shapeList[10]->addProperty("p11") == shapeList[11]);
+}
+
+TEST_CASE("DynamicShape, lookup is built by several threads")
+{
+	const metapp::DynamicShape * shape = metapp::DynamicShape::getRoot();
+	for(int i = 0; i < 40; ++i) {
+		shape = shape->addProperty("concurrent" + std::to_string(i));
+	}
+	std::vector<std::thread> threadList;
+	std::atomic<int> errorCount(0);
+	for(int t = 0; t < 4; ++t) {
+		threadList.emplace_back([shape, &errorCount]() {
+			for(int i = 0; i < 40; ++i) {
+				if(shape->findSlot("concurrent" + std::to_string(i)) != (std::size_t)i
+					|| shape->getPropertyName((std::size_t)i) != "concurrent" + std::to_string(i)) {
+					++errorCount;
+				}
+			}
+		});
+	}
+	for(std::thread & thread : threadList) {
+		thread.join();
+	}
+	REQUIRE(errorCount == 0);
+}
+
+TEST_CASE("DynamicObject, update properties of a large object")
+{
+	metapp::DynamicObject object;
+	for(int i = 0; i < 20; ++i) {
+		object.set("item" + std::to_string(i), i);
+	}
+	const metapp::DynamicShape * shape = object.getShape();
+	object.set("item3", 300);
+	object.set("item19", 1900);
+	REQUIRE(object.getShape() == shape);
+	REQUIRE(object.get("item3").get<int>() == 300);
+	REQUIRE(object.get("item19").get<int>() == 1900);
+	REQUIRE(object.remove("item10"));
+	REQUIRE(object.getPropertyCount() == 19);
+	REQUIRE(object.getShape()->getPropertyName(10) == "item11");
+	REQUIRE(object.get("item11").get<int>() == 11);
+}
+
+TEST_CASE("DynamicObject, set with a value referring to a slot in the same object")
+{
+	metapp::DynamicObject object;
+	object.set("a", std::string("hello"));
+	for(int i = 0; i < 20; ++i) {
+		object.set("copy" + std::to_string(i), object.get("a"));
+	}
+	REQUIRE(object.get("copy19").get<const std::string &>() == "hello");
+	REQUIRE(object.getSlot(20).getMetaType()->getTypeKind() == metapp::tkStdString);
+}
+
+TEST_CASE("DynamicPropertyCache")
+{
+	metapp::DynamicPropertyCache cache("y");
+	metapp::DynamicObject a;
+	a.set("x", 1);
+	a.set("y", 2);
+	metapp::DynamicObject b;
+	b.set("y", 3);
+	metapp::DynamicObject c;
+	c.set("x", 4);
+
+	for(int i = 0; i < 3; ++i) {
+		REQUIRE(cache.get(a).get<int>() == 2);
+		REQUIRE(cache.get(b).get<int>() == 3);
+		REQUIRE(cache.find(c) == nullptr);
+	}
+
+	cache.set(a, 5);
+	REQUIRE(a.get("y").get<int>() == 5);
+	cache.set(c, 6);
+	REQUIRE(c.get("y").get<int>() == 6);
+	REQUIRE(cache.get(c).get<int>() == 6);
+
+	// More shapes than the cache entries
+	std::vector<metapp::DynamicObject> objectList(10);
+	for(int i = 0; i < 10; ++i) {
+		objectList[i].set("p" + std::to_string(i), 0);
+		objectList[i].set("y", i);
+	}
+	for(int k = 0; k < 2; ++k) {
+		for(int i = 0; i < 10; ++i) {
+			REQUIRE(cache.get(objectList[i]).get<int>() == i);
+		}
+	}
+}
+
+TEST_CASE("DynamicObject, MetaMappable")
+{
+	metapp::Variant object = metapp::DynamicObject();
+	REQUIRE(object.getMetaType()->getMetaMappable() != nullptr);
+	REQUIRE(metapp::mappableGetValueType(object)->equal(metapp::getMetaType<metapp::Variant>()));
+	metapp::mappableSet(object, "x", 5);
+	metapp::mappableSet(object, std::string("y"), std::string("abc"));
+	REQUIRE(metapp::mappableGet(object, "x").get<const metapp::Variant &>().get<int>() == 5);
+	REQUIRE(metapp::mappableGet(object, "x").cast<int>().get<int>() == 5);
+	REQUIRE(metapp::mappableGet(object, "z").isEmpty());
+	REQUIRE(object.get<const metapp::DynamicObject &>().get("y").get<const std::string &>() == "abc");
+
+	std::vector<std::string> nameList;
+	metapp::mappableForEach(object, [&nameList](const metapp::Variant & key, const metapp::Variant & /*value*/) {
+		nameList.push_back(key.get<const std::string &>());
+		return true;
+	});
+	REQUIRE(nameList == std::vector<std::string> { "x", "y" });
+}
+
+TEST_CASE("DynamicProperty, MetaAccessible")
+{
+	metapp::DynamicObject object;
+	object.set("x", 5);
+	metapp::Variant accessible = metapp::DynamicProperty("x");
+	REQUIRE(accessible.getMetaType()->getMetaAccessible() != nullptr);
+	REQUIRE(! metapp::accessibleIsReadOnly(accessible));
+	REQUIRE(! metapp::accessibleIsStatic(accessible));
+	REQUIRE(metapp::accessibleGetClassType(accessible)->equal(metapp::getMetaType<metapp::DynamicObject>()));
+	REQUIRE(metapp::accessibleGetValueType(accessible)->equal(metapp::getMetaType<metapp::Variant>()));
+
+	REQUIRE(metapp::accessibleGet(accessible, &object).cast<int>().get<int>() == 5);
+	REQUIRE(metapp::accessibleGet(accessible, metapp::Variant::reference(object)).cast<int>().get<int>() == 5);
+	metapp::accessibleSet(accessible, &object, 38);
+	REQUIRE(object.get("x").get<int>() == 38);
+
+	metapp::Variant newProperty = metapp::DynamicProperty("y");
+	metapp::accessibleSet(newProperty, &object, std::string("abc"));
+	REQUIRE(object.get("y").get<const std::string &>() == "abc");
+	REQUIRE(metapp::accessibleGet(newProperty, &object).cast<std::string>().get<const std::string &>() == "abc");
+
+	const metapp::DynamicObject & constObject = object;
+	REQUIRE_THROWS(metapp::accessibleSet(accessible, &constObject, 1));
+}
@@ -0,0 +1,123 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/allmetatypes.h"
+
+#include <vector>
+#include <string>
+
+namespace {
+
+struct TryPoint
+{
+	int x;
+	const int y;
+};
+
+TEST_CASE("ErrorCode, Variant::tryCast")
+{
+	metapp::Variant result;
+
+	REQUIRE(metapp::Variant(5).tryCast<long>(&result) == metapp::ErrorCode::ok);
+	REQUIRE(result.get<long>() == 5);
+
+	REQUIRE(metapp::Variant(5).tryCast<int>(&result) == metapp::ErrorCode::ok);
+	REQUIRE(result.get<int>() == 5);
+
+	REQUIRE(metapp::Variant(5).tryCast<std::string>(&result) == metapp::ErrorCode::badCast);
+	REQUIRE(metapp::Variant(5).tryCast<std::string>(nullptr) == metapp::ErrorCode::badCast);
+	REQUIRE(metapp::Variant(5).tryCast<double>(nullptr) == metapp::ErrorCode::ok);
+}
+
+TEST_CASE("ErrorCode, tryCallableInvoke")
+{
+	metapp::Variant result;
+
+	metapp::Variant func(std::function<int (int)>([](const int n) {
+		return n * 2;
+	}));
+	REQUIRE(metapp::tryCallableInvoke(&result, func, nullptr, 5) == metapp::ErrorCode::ok);
+	REQUIRE(result.get<int>() == 10);
+	REQUIRE(metapp::tryCallableInvoke(&result, func, nullptr, "abc") == metapp::ErrorCode::illegalArgument);
+	REQUIRE(metapp::tryCallableInvoke(&result, func, nullptr) == metapp::ErrorCode::illegalArgument);
+	REQUIRE(metapp::tryCallableInvoke(nullptr, func, nullptr, 5) == metapp::ErrorCode::ok);
+
+	REQUIRE(metapp::tryCallableInvoke(&result, metapp::Variant(5), nullptr) == metapp::ErrorCode::unsupported);
+
+	metapp::Variant overloaded = metapp::OverloadedFunction();
+	metapp::OverloadedFunction & overloadedFunction = overloaded.get<metapp::OverloadedFunction &>();
+	overloadedFunction.addCallable(std::function<int ()>([]() {
+		return 1;
+	}));
+	overloadedFunction.addCallable(std::function<int (long)>([](const long n) {
+		return (int)n * 3;
+	}));
+	overloadedFunction.addCallable(std::function<int (const std::string &)>([](const std::string & s) {
+		return (int)s.size();
+	}));
+	REQUIRE(metapp::tryCallableInvoke(&result, overloaded, nullptr) == metapp::ErrorCode::ok);
+	REQUIRE(result.get<int>() == 1);
+	REQUIRE(metapp::tryCallableInvoke(&result, overloaded, nullptr, 5L) == metapp::ErrorCode::ok);
+	REQUIRE(result.get<int>() == 15);
+	REQUIRE(metapp::tryCallableInvoke(&result, overloaded, nullptr, std::string("abcd")) == metapp::ErrorCode::ok);
+	REQUIRE(result.get<int>() == 4);
+	REQUIRE(metapp::tryCallableInvoke(&result, overloaded, nullptr, std::vector<int>()) == metapp::ErrorCode::illegalArgument);
+	REQUIRE(metapp::tryCallableInvoke(&result, overloaded, nullptr, 1, 2) == metapp::ErrorCode::illegalArgument);
+}
+
+TEST_CASE("ErrorCode, tryIndexableGet")
+{
+	metapp::Variant result;
+
+	std::vector<int> container { 5, 6, 7 };
+	metapp::Variant v = metapp::Variant::reference(container);
+	REQUIRE(metapp::tryIndexableGet(&result, v, 2) == metapp::ErrorCode::ok);
+	REQUIRE(result.get<int>() == 7);
+	REQUIRE(metapp::tryIndexableGet(&result, v, 3) == metapp::ErrorCode::outOfRange);
+	REQUIRE(metapp::tryIndexableGet(nullptr, v, 0) == metapp::ErrorCode::ok);
+
+	REQUIRE(metapp::tryIndexableGet(&result, metapp::Variant(5), 0) == metapp::ErrorCode::unsupported);
+}
+
+TEST_CASE("ErrorCode, tryAccessibleSet")
+{
+	TryPoint point { 1, 2 };
+	metapp::Variant x(&TryPoint::x);
+	metapp::Variant y(&TryPoint::y);
+
+	REQUIRE(metapp::tryAccessibleSet(x, &point, 5) == metapp::ErrorCode::ok);
+	REQUIRE(point.x == 5);
+	REQUIRE(metapp::tryAccessibleSet(x, &point, 6.0) == metapp::ErrorCode::ok);
+	REQUIRE(point.x == 6);
+	REQUIRE(metapp::tryAccessibleSet(x, &point, std::string("abc")) == metapp::ErrorCode::badCast);
+	REQUIRE(point.x == 6);
+	REQUIRE(metapp::tryAccessibleSet(x, metapp::Variant(), 5) == metapp::ErrorCode::illegalArgument);
+	REQUIRE(metapp::tryAccessibleSet(y, &point, 5) == metapp::ErrorCode::unwritable);
+	REQUIRE(point.y == 2);
+
+	REQUIRE(metapp::tryAccessibleSet(metapp::Variant(5), &point, 5) == metapp::ErrorCode::unsupported);
+
+	int value = 1;
+	metapp::Variant pointer(&value);
+	REQUIRE(metapp::tryAccessibleSet(pointer, nullptr, 3) == metapp::ErrorCode::ok);
+	REQUIRE(value == 3);
+}
+
+} // namespace
+
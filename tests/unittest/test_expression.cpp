@@ -0,0 +1,434 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test.h"
+
+#include "metapp/utilities/expression.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/metarepo.h"
+
+#include <string>
+#include <vector>
+#include <thread>
+
+namespace {
+
+enum class ExprTier
+{
+	silver,
+	gold
+};
+
+enum class ExprColor
+{
+	red = 3,
+	blue = 5
+};
+
+struct ExprItem
+{
+	std::string name;
+	double price;
+	int quantity;
+};
+
+struct ExprCustomer
+{
+	std::string name;
+	ExprTier tier;
+	int age;
+	bool active;
+};
+
+struct ExprOrder
+{
+	std::vector<ExprItem> items;
+	ExprCustomer customer;
+	ExprCustomer * referrer;
+	long long id;
+	unsigned short priority;
+	float discount;
+	ExprColor color;
+	metapp::Variant extra;
+
+	double total() const {
+		double result = 0;
+		for(const ExprItem & item : items) {
+			result += item.price * item.quantity;
+		}
+		return result;
+	}
+
+	int scaled(const int factor) const {
+		return (int)id * factor;
+	}
+
+	std::string label(const std::string & prefix) const {
+		return prefix + std::to_string(id);
+	}
+
+	int getLimit() const {
+		return 2;
+	}
+
+	const ExprCustomer & getCustomer() const {
+		return customer;
+	}
+};
+
+struct ExprFixture
+{
+	ExprFixture()
+		: referrer { "Ann", ExprTier::silver, 40, true }, order()
+	{
+		order.items = { { "pen", 1.5, 4 }, { "book", 12.0, 1 }, { "cup", 4.25, 2 } };
+		order.customer = { "Bob", ExprTier::gold, 30, true };
+		order.referrer = &referrer;
+		order.id = 7;
+		order.priority = 65535;
+		order.discount = 0.5f;
+		order.color = ExprColor::blue;
+		order.extra = 5;
+	}
+
+	ExprCustomer referrer;
+	ExprOrder order;
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <ExprTier> : metapp::DeclareMetaTypeBase <ExprTier>
+{
+	static const metapp::MetaEnum * getMetaEnum() {
+		static const metapp::MetaEnum metaEnum([](metapp::MetaEnum & me) {
+			me.registerValue("silver", ExprTier::silver);
+			me.registerValue("gold", ExprTier::gold);
+		});
+		return &metaEnum;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <ExprColor> : metapp::DeclareMetaTypeBase <ExprColor>
+{
+	static const metapp::MetaEnum * getMetaEnum() {
+		static const metapp::MetaEnum metaEnum([](metapp::MetaEnum & me) {
+			me.registerValue("red", ExprColor::red);
+			me.registerValue("blue", ExprColor::blue);
+		});
+		return &metaEnum;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <ExprItem> : metapp::DeclareMetaTypeBase <ExprItem>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<ExprItem>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("name", &ExprItem::name);
+				mc.registerAccessible("price", &ExprItem::price);
+				mc.registerAccessible("quantity", &ExprItem::quantity);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <ExprCustomer> : metapp::DeclareMetaTypeBase <ExprCustomer>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<ExprCustomer>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("name", &ExprCustomer::name);
+				mc.registerAccessible("tier", &ExprCustomer::tier);
+				mc.registerAccessible("age", &ExprCustomer::age);
+				mc.registerAccessible("active", &ExprCustomer::active);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <ExprOrder> : metapp::DeclareMetaTypeBase <ExprOrder>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<ExprOrder>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerType("ExprTier", metapp::getMetaType<ExprTier>());
+				mc.registerAccessible("items", &ExprOrder::items);
+				mc.registerAccessible("customer", &ExprOrder::customer);
+				mc.registerAccessible("referrer", &ExprOrder::referrer);
+				mc.registerAccessible("id", &ExprOrder::id);
+				mc.registerAccessible("priority", &ExprOrder::priority);
+				mc.registerAccessible("discount", &ExprOrder::discount);
+				mc.registerAccessible("color", &ExprOrder::color);
+				mc.registerAccessible("extra", &ExprOrder::extra);
+				mc.registerAccessible("limit", metapp::createReadOnlyAccessor<int>(&ExprOrder::getLimit));
+				mc.registerAccessible("buyer", metapp::createReadOnlyAccessor<const ExprCustomer &>(&ExprOrder::getCustomer));
+				mc.registerCallable("total", &ExprOrder::total);
+				mc.registerCallable("scaled", &ExprOrder::scaled);
+				mc.registerCallable("label", &ExprOrder::label);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+// Evaluates by both bytecode and interpreter, they must give the same result.
+metapp::Variant evaluateExpression(const std::string & source, const metapp::Variant & root)
+{
+	const metapp::Expression expression = metapp::Expression::compile<ExprOrder>(source);
+	const metapp::Variant compiled = expression.evaluate(root);
+	const metapp::Variant interpreted = expression.interpret(root);
+	REQUIRE(compiled.getMetaType() == interpreted.getMetaType());
+	if(compiled.getMetaType() == metapp::getMetaType<bool>()) {
+		REQUIRE(compiled.get<bool>() == interpreted.get<bool>());
+	}
+	else if(compiled.getMetaType() == metapp::getMetaType<long long>()) {
+		REQUIRE(compiled.get<long long>() == interpreted.get<long long>());
+	}
+	else if(compiled.getMetaType() == metapp::getMetaType<double>()) {
+		REQUIRE(compiled.get<double>() == interpreted.get<double>());
+	}
+	else if(compiled.getMetaType() == metapp::getMetaType<std::string>()) {
+		REQUIRE(compiled.get<const std::string &>() == interpreted.get<const std::string &>());
+	}
+	return compiled;
+}
+
+TEST_CASE("Expression, literals and operators")
+{
+	ExprFixture fixture;
+	const metapp::Variant root = metapp::Variant::reference(fixture.order);
+
+	REQUIRE(evaluateExpression("1 + 2 * 3", root).get<long long>() == 7);
+	REQUIRE(evaluateExpression("(1 + 2) * 3", root).get<long long>() == 9);
+	REQUIRE(evaluateExpression("10 - 4 - 3", root).get<long long>() == 3);
+	REQUIRE(evaluateExpression("7 / 2", root).get<long long>() == 3);
+	REQUIRE(evaluateExpression("-7 % 3", root).get<long long>() == -1);
+	REQUIRE(evaluateExpression("7 / 2.0", root).get<double>() == 3.5);
+	REQUIRE(evaluateExpression("1e2 + .5", root).get<double>() == 100.5);
+	REQUIRE(evaluateExpression("- -3", root).get<long long>() == 3);
+	REQUIRE(evaluateExpression("true + 1", root).get<long long>() == 2);
+	REQUIRE(evaluateExpression("1 < 2 && 2 <= 2 && 3 > 2 && 3 >= 3 && 1 != 2 && 2 == 2", root).get<bool>());
+	REQUIRE(! evaluateExpression("!true || false", root).get<bool>());
+	REQUIRE(evaluateExpression("!0", root).get<bool>());
+	REQUIRE(evaluateExpression("1.5 > 1", root).get<bool>());
+	REQUIRE(evaluateExpression("\"ab\" + \"cd\"", root).get<const std::string &>() == "abcd");
+	REQUIRE(evaluateExpression("\"abc\" < \"abd\" && \"a\\\"b\" == \"a\\\"b\"", root).get<bool>());
+	REQUIRE(evaluateExpression("9223372036854775807 + 1", root).get<long long>() == (long long)(1ULL << 63));
+}
+
+TEST_CASE("Expression, members")
+{
+	ExprFixture fixture;
+	ExprOrder & order = fixture.order;
+	const metapp::Variant root = metapp::Variant::reference(order);
+
+	SECTION("member data of arithmetic types") {
+		REQUIRE(evaluateExpression("id", root).get<long long>() == 7);
+		REQUIRE(evaluateExpression("priority + 1", root).get<long long>() == 65536);
+		REQUIRE(evaluateExpression("discount * 2", root).get<double>() == 1.0);
+		REQUIRE(evaluateExpression("customer.age >= 18 && customer.active", root).get<bool>());
+	}
+
+	SECTION("strings") {
+		REQUIRE(evaluateExpression("customer.name", root).get<const std::string &>() == "Bob");
+		REQUIRE(evaluateExpression("customer.name + \"!\" == \"Bob!\"", root).get<bool>());
+	}
+
+	SECTION("enums") {
+		REQUIRE(evaluateExpression("customer.tier == ExprTier::gold", root).get<bool>());
+		REQUIRE(evaluateExpression("customer.tier", root).get<long long>() == 1);
+		metapp::MetaRepo metaRepo;
+		metaRepo.registerType<ExprColor>("ExprColor");
+		REQUIRE(evaluateExpression("color == ExprColor::blue && ExprColor::red == 3", root).get<bool>());
+	}
+
+	SECTION("pointer member") {
+		REQUIRE(evaluateExpression("referrer.name", root).get<const std::string &>() == "Ann");
+		REQUIRE(evaluateExpression("referrer.age - customer.age", root).get<long long>() == 10);
+	}
+
+	SECTION("object result refers to the object") {
+		const metapp::Variant customer = evaluateExpression("customer", root);
+		REQUIRE(&customer.get<ExprCustomer &>() == &order.customer);
+	}
+
+	SECTION("accessor") {
+		REQUIRE(evaluateExpression("limit * 10", root).get<long long>() == 20);
+		REQUIRE(evaluateExpression("buyer.name", root).get<const std::string &>() == "Bob");
+	}
+
+	SECTION("size of container") {
+		REQUIRE(evaluateExpression("items.size() > limit && customer.tier == ExprTier::gold", root).get<bool>());
+		order.items.pop_back();
+		order.items.pop_back();
+		REQUIRE(! evaluateExpression("items.size() > limit", root).get<bool>());
+	}
+
+	SECTION("Variant member") {
+		REQUIRE(evaluateExpression("extra + 1", root).get<long long>() == 6);
+		REQUIRE(evaluateExpression("extra * 1.5 > 7", root).get<bool>());
+		REQUIRE(evaluateExpression("!extra", root).get<bool>() == false);
+		order.extra = std::string("text");
+		REQUIRE(evaluateExpression("extra + \"!\"", root).get<const std::string &>() == "text!");
+	}
+
+	SECTION("members of Variant member, the inline cache follows the type") {
+		const metapp::Expression expression = metapp::Expression::compile<ExprOrder>("extra.name + \"?\"");
+		order.extra = metapp::Variant::reference(fixture.referrer);
+		REQUIRE(expression.evaluate(root).get<const std::string &>() == "Ann?");
+		order.extra = ExprItem { "pen", 1.0, 1 };
+		REQUIRE(expression.evaluate(root).get<const std::string &>() == "pen?");
+		REQUIRE(expression.interpret(root).get<const std::string &>() == "pen?");
+		// The cache keeps the members of both types when the type alternates.
+		for(int i = 0; i < 100; ++i) {
+			order.extra = metapp::Variant::reference(fixture.referrer);
+			REQUIRE(expression.evaluate(root).get<const std::string &>() == "Ann?");
+			order.extra = ExprItem { "pen", 1.0, 1 };
+			REQUIRE(expression.evaluate(root).get<const std::string &>() == "pen?");
+		}
+		order.extra = std::vector<int> { 1, 2, 3 };
+		REQUIRE(metapp::Expression::compile<ExprOrder>("extra.size()").evaluate(root).get<long long>() == 3);
+	}
+
+	SECTION("root can be pointer or value") {
+		REQUIRE(evaluateExpression("customer.age + id", &order).get<long long>() == 37);
+		REQUIRE(evaluateExpression("customer.age + id", order).get<long long>() == 37);
+	}
+}
+
+TEST_CASE("Expression, methods")
+{
+	ExprFixture fixture;
+	const metapp::Variant root = metapp::Variant::reference(fixture.order);
+
+	REQUIRE(evaluateExpression("total()", root).get<double>() == 26.5);
+	REQUIRE(evaluateExpression("total() * (1 - discount) > 13", root).get<bool>());
+	REQUIRE(evaluateExpression("scaled(3)", root).get<long long>() == 21);
+	REQUIRE(evaluateExpression("scaled(2.9) + scaled(true)", root).get<long long>() == 21);
+	REQUIRE(evaluateExpression("label(\"#\" + customer.name)", root).get<const std::string &>() == "#Bob7");
+	REQUIRE(evaluateExpression("scaled(extra)", root).get<long long>() == 35);
+}
+
+TEST_CASE("Expression, evaluateBool")
+{
+	ExprFixture fixture;
+	const metapp::Variant root = metapp::Variant::reference(fixture.order);
+
+	REQUIRE(metapp::Expression::compile<ExprOrder>("id > 0 && customer.name == \"Bob\"").evaluateBool(root));
+	REQUIRE(! metapp::Expression::compile<ExprOrder>("id < 0").evaluateBool(root));
+	REQUIRE(metapp::Expression::compile<ExprOrder>("id").evaluateBool(root));
+	REQUIRE(! metapp::Expression::compile<ExprOrder>("id - id").evaluateBool(root));
+	REQUIRE(metapp::Expression::compile<ExprOrder>("discount").evaluateBool(root));
+	REQUIRE(metapp::Expression::compile<ExprOrder>("extra").evaluateBool(root));
+	REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("customer.name").evaluateBool(root), metapp::UnsupportedException);
+	REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("customer").evaluateBool(root), metapp::UnsupportedException);
+}
+
+TEST_CASE("Expression, errors")
+{
+	ExprFixture fixture;
+	ExprOrder & order = fixture.order;
+	const metapp::Variant root = metapp::Variant::reference(order);
+
+	SECTION("syntax") {
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("1 +"), metapp::IllegalArgumentException);
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("(1"), metapp::IllegalArgumentException);
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("1 2"), metapp::IllegalArgumentException);
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("\"abc"), metapp::IllegalArgumentException);
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("id ="), metapp::IllegalArgumentException);
+	}
+
+	SECTION("unknown names") {
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("nothing"), metapp::IllegalArgumentException);
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("customer.nothing()"), metapp::IllegalArgumentException);
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("ExprTier::bronze"), metapp::IllegalArgumentException);
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("NoType::value"), metapp::IllegalArgumentException);
+	}
+
+	SECTION("unsupported operands") {
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("\"a\" - 1"), metapp::UnsupportedException);
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("customer + 1"), metapp::UnsupportedException);
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("1.5 % 2"), metapp::UnsupportedException);
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("id.name"), metapp::UnsupportedException);
+		order.extra = std::string("text");
+		REQUIRE_THROWS_AS(metapp::Expression::compile<ExprOrder>("extra - 1").evaluate(root), metapp::UnsupportedException);
+	}
+
+	SECTION("division by zero") {
+		const metapp::Expression expression = metapp::Expression::compile<ExprOrder>("1 / (id - 7)");
+		REQUIRE_THROWS_AS(expression.evaluate(root), metapp::IllegalArgumentException);
+		REQUIRE_THROWS_AS(expression.interpret(root), metapp::IllegalArgumentException);
+	}
+
+	SECTION("nullptr member") {
+		order.referrer = nullptr;
+		const metapp::Expression expression = metapp::Expression::compile<ExprOrder>("referrer.age");
+		REQUIRE_THROWS_AS(expression.evaluate(root), metapp::IllegalArgumentException);
+		REQUIRE_THROWS_AS(expression.interpret(root), metapp::IllegalArgumentException);
+	}
+
+	SECTION("wrong root") {
+		const metapp::Expression expression = metapp::Expression::compile<ExprOrder>("id");
+		REQUIRE_THROWS_AS(expression.evaluate(fixture.referrer), metapp::IllegalArgumentException);
+		REQUIRE_THROWS_AS(expression.evaluate((ExprOrder *)nullptr), metapp::IllegalArgumentException);
+	}
+
+	SECTION("short circuit skips the errors") {
+		order.referrer = nullptr;
+		REQUIRE(! evaluateExpression("id == 0 && referrer.age > 1", root).get<bool>());
+		REQUIRE(evaluateExpression("id == 7 || 1 / 0 > 1", root).get<bool>());
+	}
+}
+
+TEST_CASE("Expression, evaluate on several threads")
+{
+	constexpr int threadCount = 4;
+	ExprFixture fixture;
+	const metapp::Variant root = metapp::Variant::reference(fixture.order);
+	const metapp::Expression expression = metapp::Expression::compile<ExprOrder>(
+		"items.size() * customer.age + referrer.age + scaled(2) + extra"
+	);
+	std::vector<std::thread> threadList;
+	std::vector<long long> resultList(threadCount);
+	for(int i = 0; i < threadCount; ++i) {
+		threadList.emplace_back([&expression, &root, &resultList, i]() {
+			for(int k = 0; k < 1000; ++k) {
+				resultList[i] = expression.evaluate(root).get<long long>();
+			}
+		});
+	}
+	for(std::thread & thread : threadList) {
+		thread.join();
+	}
+	for(const long long result : resultList) {
+		REQUIRE(result == 3 * 30 + 40 + 14 + 5);
+	}
+}
+
+} // namespace
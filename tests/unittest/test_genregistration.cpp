@@ -0,0 +1,111 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The build generates the registration code from include/genregistrationfixture.h by tools/genregistration.py,
+// METAPP_TEST_GENREGISTRATION is defined if the generator can run (Python 3 is found).
+#ifdef METAPP_TEST_GENREGISTRATION
+
+#include "test.h"
+
+#include "genregistrationfixture_registration.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/metatypes/thunk_function.h"
+
+#include <cstddef>
+
+namespace {
+
+TEST_CASE("genregistration, generated MetaClass registers the annotated members")
+{
+	const metapp::MetaClass * metaClass = metapp::getMetaType<genfixture::Shape>()->getMetaClass();
+	REQUIRE(metaClass != nullptr);
+	REQUIRE(metaClass->getAccessibleView().size() == 3);
+	REQUIRE(metaClass->getAccessible("tags").isEmpty());
+
+	genfixture::Shape shape { 3, 4, "box", {} };
+	REQUIRE(metapp::accessibleGet(metaClass->getAccessible("width"), &shape).get<int>() == 3);
+	metapp::accessibleSet(metaClass->getAccessible("height"), &shape, 5);
+	REQUIRE(shape.height == 5);
+	REQUIRE(metapp::accessibleGet(metaClass->getAccessible("name"), &shape).get<const std::string &>() == "box");
+
+	REQUIRE(metapp::callableInvoke(metaClass->getCallable("getArea"), &shape).get<int>() == 15);
+	metapp::callableInvoke(metaClass->getCallable("setName"), &shape, std::string("square"));
+	REQUIRE(shape.name == "square");
+
+	// The overloads are registered with the same name, and are chosen by the arguments.
+	const metapp::MetaItem & resize = metaClass->getCallable("resize");
+	REQUIRE(metapp::getNonReferenceMetaType(resize)->getMetaCallable() != nullptr);
+	metapp::callableInvoke(resize, &shape, 7);
+	REQUIRE(shape.width == 7);
+	REQUIRE(shape.height == 5);
+	metapp::callableInvoke(resize, &shape, 8, 9);
+	REQUIRE(shape.width == 8);
+	REQUIRE(shape.height == 9);
+
+	const genfixture::Shape created = metapp::callableInvoke(metaClass->getCallable("create"), nullptr, 2, 6)
+		.get<const genfixture::Shape &>();
+	REQUIRE(created.getArea() == 12);
+	REQUIRE(created.name == "created");
+}
+
+TEST_CASE("genregistration, generated RegistrationTable")
+{
+	const metapp::RegistrationTable & table = metapp::DeclareMetaType<genfixture::Shape>::getRegistrationTable();
+	REQUIRE(table.fieldCount == 3);
+	REQUIRE(table.findField("width")->value == offsetof(genfixture::Shape, width));
+	REQUIRE(table.findField("height")->value == offsetof(genfixture::Shape, height));
+	REQUIRE(table.findField("name")->value == offsetof(genfixture::Shape, name));
+	REQUIRE(table.findField("tags") == nullptr);
+
+	REQUIRE(table.callableCount == 5);
+	REQUIRE(table.findCallable("resize")->value == 2);
+	REQUIRE(table.findCallable("getArea")->value == 1);
+	REQUIRE(table.findCallable("create")->value == 1);
+	for(std::size_t i = 1; i < table.callableCount; ++i) {
+		REQUIRE(table.callables[i - 1].nameHash <= table.callables[i].nameHash);
+	}
+}
+
+TEST_CASE("genregistration, member functions of different classes share the thunk")
+{
+	const metapp::MetaItem & getArea = metapp::getMetaType<genfixture::Shape>()->getMetaClass()->getCallable("getArea");
+	const metapp::MetaItem & getLength = metapp::getMetaType<genfixture::Label>()->getMetaClass()->getCallable("getLength");
+	REQUIRE(getArea.asCallable().get<const metapp::ThunkFunction &>().getInvoke()
+		== getLength.asCallable().get<const metapp::ThunkFunction &>().getInvoke());
+
+	genfixture::Label label { "abc" };
+	REQUIRE(metapp::callableInvoke(getLength, &label).get<int>() == 3);
+	metapp::callableInvoke(metapp::getMetaType<genfixture::Label>()->getMetaClass()->getCallable("setText"), &label, std::string("hello"));
+	REQUIRE(label.text == "hello");
+}
+
+TEST_CASE("genregistration, generated class without members")
+{
+	const metapp::MetaClass * metaClass = metapp::getMetaType<genfixture::Empty>()->getMetaClass();
+	REQUIRE(metaClass != nullptr);
+	REQUIRE(metaClass->getAccessibleView().empty());
+	REQUIRE(metaClass->getCallableView().empty());
+
+	const metapp::RegistrationTable & table = metapp::DeclareMetaType<genfixture::Empty>::getRegistrationTable();
+	REQUIRE(table.fieldCount == 0);
+	REQUIRE(table.callableCount == 0);
+	REQUIRE(table.findField("") == nullptr);
+}
+
+} // namespace
+
+#endif
@@ -0,0 +1,183 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/memoryreport.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/metarepo.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <sstream>
+
+namespace {
+
+struct MrClass
+{
+	int value;
+
+	int getValue() const {
+		return value;
+	}
+};
+
+int mrFunc1(int a)
+{
+	return a;
+}
+
+int mrFunc2(int a, int b)
+{
+	return a + b;
+}
+
+const metapp::MemoryReportEntry * findEntry(const metapp::MemoryReport & report, const std::string & name)
+{
+	for(const metapp::MemoryReportEntry & entry : report.getEntryList()) {
+		if(entry.name == name) {
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <MrClass> : metapp::DeclareMetaTypeBase <MrClass>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<MrClass>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("value", &MrClass::value);
+				mc.registerCallable("getValue", &MrClass::getValue);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+TEST_CASE("MemoryReport, empty MetaRepo")
+{
+	metapp::MetaRepo metaRepo;
+	metapp::MemoryReport report;
+	report.addMetaRepo(&metaRepo, "repo");
+	REQUIRE(report.getEntryList().size() == 1);
+	const metapp::MemoryReportEntry & entry = report.getEntryList()[0];
+	REQUIRE(entry.source == metapp::MemoryReportEntry::Source::metaRepo);
+	REQUIRE(entry.address == &metaRepo);
+	REQUIRE(entry.getUsage(metapp::MemoryKind::object).byteCount == sizeof(metapp::MetaRepo));
+	REQUIRE(entry.getUsage(metapp::MemoryKind::itemData).allocationCount == 0);
+	REQUIRE(entry.getTotal().allocationCount == 0);
+
+	// Adding the same repo again is ignored.
+	report.addMetaRepo(&metaRepo, "again");
+	REQUIRE(report.getEntryList().size() == 1);
+}
+
+TEST_CASE("MemoryReport, items, names, annotations")
+{
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerCallable("f1", &mrFunc1);
+	metaRepo.registerCallable("f2", &mrFunc2);
+	metaRepo.registerCallable("aVeryLongCallableNameWhichIsNotStoredLocally", &mrFunc2)
+		.registerAnnotation("description", std::string("the annotation value"));
+
+	metapp::MemoryReport report;
+	report.addMetaRepo(&metaRepo, "repo");
+	const metapp::MemoryReportEntry * entry = findEntry(report, "repo");
+	REQUIRE(entry != nullptr);
+	REQUIRE(entry->getUsage(metapp::MemoryKind::itemData).allocationCount == 3);
+	REQUIRE(entry->getUsage(metapp::MemoryKind::itemData).byteCount > 0);
+	REQUIRE(entry->getUsage(metapp::MemoryKind::nameIndex).allocationCount == 3);
+	REQUIRE(entry->getUsage(metapp::MemoryKind::name).allocationCount == 1);
+	REQUIRE(entry->getUsage(metapp::MemoryKind::itemList).allocationCount > 0);
+	// The map block, the node, and the std::string value.
+	REQUIRE(entry->getUsage(metapp::MemoryKind::annotation).allocationCount == 3);
+	REQUIRE(entry->getUsage(metapp::MemoryKind::overloadedFunction).allocationCount == 0);
+
+	REQUIRE(report.getTotal().byteCount == entry->getTotal().byteCount);
+	REQUIRE(report.getTotal(metapp::MemoryKind::itemData).allocationCount == 3);
+	REQUIRE(report.getTotal(metapp::MemoryReportEntry::Source::metaRepo).byteCount == entry->getTotal().byteCount);
+	REQUIRE(report.getTotal(metapp::MemoryReportEntry::Source::metaClass).byteCount == 0);
+}
+
+TEST_CASE("MemoryReport, OverloadedFunction")
+{
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerCallable("f", &mrFunc1);
+	metaRepo.registerCallable("f", &mrFunc2);
+
+	metapp::MemoryReport report;
+	report.addMetaRepo(&metaRepo);
+	const metapp::MemoryReportEntry & entry = report.getEntryList()[0];
+	REQUIRE(entry.getUsage(metapp::MemoryKind::itemData).allocationCount == 1);
+	// The OverloadedFunction object and the deque.
+	REQUIRE(entry.getUsage(metapp::MemoryKind::overloadedFunction).allocationCount >= 1);
+	REQUIRE(entry.getUsage(metapp::MemoryKind::overloadedFunction).byteCount > sizeof(metapp::OverloadedFunction));
+}
+
+TEST_CASE("MemoryReport, types, sub repos, and shared blocks")
+{
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerType<MrClass>("MrClass");
+	metaRepo.registerCallable("f", &mrFunc1);
+	metapp::MetaRepo subRepo;
+	subRepo.registerCallable("g", &mrFunc2);
+	metaRepo.registerRepo("sub", subRepo);
+
+	metapp::MemoryReport report;
+	report.addMetaRepo(&metaRepo, "main");
+	const metapp::MemoryReportEntry * classEntry = findEntry(report, "main::MrClass");
+	REQUIRE(classEntry != nullptr);
+	REQUIRE(classEntry->source == metapp::MemoryReportEntry::Source::metaClass);
+	REQUIRE(classEntry->address == metapp::getMetaType<MrClass>()->getMetaClass());
+	REQUIRE(classEntry->getUsage(metapp::MemoryKind::itemData).allocationCount == 2);
+
+	const metapp::MemoryReportEntry * subEntry = findEntry(report, "main::sub");
+	REQUIRE(subEntry != nullptr);
+	REQUIRE(subEntry->source == metapp::MemoryReportEntry::Source::metaRepo);
+	REQUIRE(subEntry->getUsage(metapp::MemoryKind::itemData).allocationCount == 1);
+
+	// The copy shares the item data with metaRepo, so the blocks are counted once.
+	metapp::MetaRepo copiedRepo(metaRepo);
+	report.addMetaRepo(&copiedRepo, "copied");
+	const metapp::MemoryReportEntry * copiedEntry = findEntry(report, "copied");
+	REQUIRE(copiedEntry != nullptr);
+	REQUIRE(copiedEntry->getUsage(metapp::MemoryKind::itemData).allocationCount == 0);
+	REQUIRE(copiedEntry->getUsage(metapp::MemoryKind::itemList).allocationCount == 0);
+
+	std::ostringstream stream;
+	report.write(stream);
+	REQUIRE(stream.str().find("main::MrClass") != std::string::npos);
+	REQUIRE(stream.str().find("total") != std::string::npos);
+}
+
+TEST_CASE("MemoryReport, addAllMetaRepos")
+{
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerCallable("f", &mrFunc1);
+	metapp::MemoryReport report;
+	report.addAllMetaRepos();
+	bool found = false;
+	for(const metapp::MemoryReportEntry & entry : report.getEntryList()) {
+		found = found || entry.address == &metaRepo;
+	}
+	REQUIRE(found);
+}
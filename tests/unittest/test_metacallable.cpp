@@ -23,6 +23,7 @@
 #include <string>
 #include <iostream>
 #include <climits>
+#include <vector>
 
 namespace {
 
@@ -39,4 +40,214 @@ TEST_CASE("MetaCallable, rankInvoke")
 }
 
 
+int batchAdd(const int a, const long b)
+{
+	return a + (int)b;
+}
+
+struct BatchClass
+{
+	int value;
+
+	int multiply(const int n) const {
+		return value * n;
+	}
+};
+
+TEST_CASE("MetaCallable, invokeBatch, free function")
+{
+	metapp::Variant func(&batchAdd);
+	std::vector<metapp::Variant> columnA { 1, 2, 3, 4 };
+	// mixed types in one column, the rows which don't match the first row are casted
+	std::vector<metapp::Variant> columnB { 10L, 20L, (char)30, 40.0 };
+	const metapp::ArgumentSpan columns[] = { columnA, columnB };
+	std::vector<metapp::Variant> results(4);
+	metapp::callableInvokeBatch(func, {}, columns, results);
+	REQUIRE(results[0].get<int>() == 11);
+	REQUIRE(results[1].get<int>() == 22);
+	REQUIRE(results[2].get<int>() == 33);
+	REQUIRE(results[3].get<int>() == 44);
+}
+
+TEST_CASE("MetaCallable, invokeBatch, empty result column discards results")
+{
+	int sum = 0;
+	metapp::Variant func(std::function<void (int)>([&sum](const int n) {
+		sum += n;
+	}));
+	std::vector<metapp::Variant> columnA { 1, 2, 3 };
+	const metapp::ArgumentSpan columns[] = { columnA };
+	metapp::callableInvokeBatch(func, {}, columns, {});
+	REQUIRE(sum == 6);
+}
+
+TEST_CASE("MetaCallable, invokeBatch, member function")
+{
+	metapp::Variant func(&BatchClass::multiply);
+	BatchClass objects[] = { { 2 }, { 3 }, { 5 } };
+	std::vector<metapp::Variant> columnA { 10, 100, 1000 };
+	const metapp::ArgumentSpan columns[] = { columnA };
+	std::vector<metapp::Variant> results(3);
+
+	SECTION("single instance") {
+		const metapp::Variant instance(&objects[0]);
+		metapp::callableInvokeBatch(func, metapp::ArgumentSpan(&instance, 1), columns, results);
+		REQUIRE(results[0].get<int>() == 20);
+		REQUIRE(results[1].get<int>() == 200);
+		REQUIRE(results[2].get<int>() == 2000);
+	}
+
+	SECTION("instance per row") {
+		std::vector<metapp::Variant> instances { &objects[0], &objects[1], &objects[2] };
+		metapp::callableInvokeBatch(func, instances, columns, results);
+		REQUIRE(results[0].get<int>() == 20);
+		REQUIRE(results[1].get<int>() == 300);
+		REQUIRE(results[2].get<int>() == 5000);
+	}
+}
+
+TEST_CASE("MetaCallable, invokeBatch, overloaded function")
+{
+	metapp::Variant func(metapp::OverloadedFunction{});
+	func.get<metapp::OverloadedFunction &>().addCallable(std::function<std::string (int)>([](const int) {
+		return std::string("int");
+	}));
+	func.get<metapp::OverloadedFunction &>().addCallable(std::function<std::string (std::string)>([](const std::string &) {
+		return std::string("string");
+	}));
+	std::vector<metapp::Variant> results(2);
+
+	SECTION("homogeneous") {
+		std::vector<metapp::Variant> columnA { 1, 2 };
+		const metapp::ArgumentSpan columns[] = { columnA };
+		metapp::callableInvokeBatch(func, {}, columns, results);
+		REQUIRE(results[0].get<const std::string &>() == "int");
+		REQUIRE(results[1].get<const std::string &>() == "int");
+	}
+
+	SECTION("heterogeneous") {
+		std::vector<metapp::Variant> columnA { 1, std::string("a") };
+		const metapp::ArgumentSpan columns[] = { columnA };
+		metapp::callableInvokeBatch(func, {}, columns, results);
+		REQUIRE(results[0].get<const std::string &>() == "int");
+		REQUIRE(results[1].get<const std::string &>() == "string");
+	}
+}
+
+TEST_CASE("MetaCallable, invokeBatch, mismatched column sizes")
+{
+	metapp::Variant func(&batchAdd);
+	std::vector<metapp::Variant> columnA { 1, 2, 3 };
+	std::vector<metapp::Variant> columnB { 1, 2 };
+	const metapp::ArgumentSpan columns[] = { columnA, columnB };
+	REQUIRE_THROWS(metapp::callableInvokeBatch(func, {}, columns, {}));
+}
+
+
+void refAppend(std::string & s, const std::string & suffix, const int count)
+{
+	for(int i = 0; i < count; ++i) {
+		s += suffix;
+	}
+}
+
+static_assert(std::is_trivially_copyable<metapp::VariantRef>::value, "");
+static_assert(sizeof(metapp::VariantRef) == sizeof(void *) * 2, "");
+
+TEST_CASE("MetaCallable, VariantRef")
+{
+	int n = 5;
+	const metapp::VariantRef ref = metapp::VariantRef::reference(n);
+	REQUIRE(ref.getMetaType() == metapp::getMetaType<int &>());
+	REQUIRE(ref.get<int>() == 5);
+	ref.get<int &>() = 6;
+	REQUIRE(n == 6);
+	// toVariant of a reference refers to the object
+	ref.toVariant().get<int &>() = 7;
+	REQUIRE(n == 7);
+
+	const metapp::Variant value(std::string("abc"));
+	const metapp::VariantRef refOfVariant(value);
+	REQUIRE(refOfVariant.getMetaType() == metapp::getMetaType<std::string>());
+	REQUIRE(refOfVariant.get<std::string>() == "abc");
+	// toVariant of a value is a copy
+	REQUIRE(refOfVariant.toVariant().get<const std::string &>() == "abc");
+
+	REQUIRE(metapp::VariantRef().isEmpty());
+	REQUIRE(metapp::VariantRef().toVariant().isEmpty());
+}
+
+TEST_CASE("MetaCallable, invokeRef, exact match")
+{
+	metapp::Variant func(&refAppend);
+	std::string s = "a";
+	const std::string suffix = "b";
+	const int count = 2;
+	const metapp::VariantRef arguments[] = {
+		metapp::VariantRef::reference(s),
+		metapp::VariantRef::reference(suffix),
+		metapp::VariantRef::reference(count)
+	};
+	metapp::callableInvokeRef(func, nullptr, arguments);
+	REQUIRE(s == "abb");
+}
+
+TEST_CASE("MetaCallable, invokeRef, cast")
+{
+	metapp::Variant func(&batchAdd);
+	const double a = 1.5;
+	const char b = 2;
+	const metapp::VariantRef arguments[] = {
+		metapp::VariantRef::reference(a),
+		metapp::VariantRef::reference(b)
+	};
+	REQUIRE(metapp::callableInvokeRef(func, nullptr, arguments).get<int>() == 3);
+
+	SECTION("variadic template invoke") {
+		REQUIRE(metapp::callableInvoke(func, nullptr, 1.5, 2).get<int>() == 3);
+		REQUIRE(metapp::callableInvoke(func, nullptr, metapp::Variant(1), metapp::Variant(2L)).get<int>() == 3);
+	}
+}
+
+TEST_CASE("MetaCallable, invokeRef, arguments from Variants")
+{
+	metapp::Variant func(&batchAdd);
+	const metapp::Variant variantList[] = { 3, 4L };
+	const metapp::VariantRef arguments[] = { variantList[0], variantList[1] };
+	REQUIRE(metapp::callableInvokeRef(func, nullptr, arguments).get<int>() == 7);
+}
+
+TEST_CASE("MetaCallable, invokeRef, member function")
+{
+	metapp::Variant func(&BatchClass::multiply);
+	BatchClass object { 3 };
+	const int n = 5;
+	const metapp::VariantRef arguments[] = { metapp::VariantRef::reference(n) };
+	REQUIRE(metapp::callableInvokeRef(func, &object, arguments).get<int>() == 15);
+}
+
+TEST_CASE("MetaCallable, invokeRef, overloaded function falls back to Variants")
+{
+	metapp::Variant func(metapp::OverloadedFunction{});
+	func.get<metapp::OverloadedFunction &>().addCallable(std::function<std::string (int)>([](const int) {
+		return std::string("int");
+	}));
+	func.get<metapp::OverloadedFunction &>().addCallable(std::function<std::string (std::string)>([](const std::string &) {
+		return std::string("string");
+	}));
+	const std::string s;
+	const metapp::VariantRef arguments[] = { metapp::VariantRef::reference(s) };
+	REQUIRE(metapp::callableInvokeRef(func, nullptr, arguments).get<const std::string &>() == "string");
+	REQUIRE(metapp::callableInvoke(func, nullptr, 1).get<const std::string &>() == "int");
+}
+
+TEST_CASE("MetaCallable, invokeRef, wrong argument count")
+{
+	metapp::Variant func(&batchAdd);
+	const int a = 1;
+	const metapp::VariantRef arguments[] = { metapp::VariantRef::reference(a) };
+	REQUIRE_THROWS(metapp::callableInvokeRef(func, nullptr, arguments));
+}
+
+
 } // namespace
@@ -19,6 +19,7 @@
 #include "metapp/variant.h"
 #include "metapp/interfaces/metaclass.h"
 #include "metapp/allmetatypes.h"
+#include "metapp/metarepo.h"
 
 #include <string>
 #include <iostream>
@@ -118,3 +119,92 @@ TEST_CASE("MetaClass, TestClass_63575107, getItem")
 	REQUIRE(metapp::callableInvoke(metaItem, &obj, 5).get<int>() == 11);
 }
 
+
+namespace {
+
+struct ViewCacheBase_63575107
+{
+	int baseValue;
+};
+
+struct ViewCacheDerived_63575107 : ViewCacheBase_63575107
+{
+	int derivedValue;
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <ViewCacheBase_63575107> : metapp::DeclareMetaTypeBase <ViewCacheBase_63575107>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<ViewCacheBase_63575107>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("baseValue", &ViewCacheBase_63575107::baseValue);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <ViewCacheDerived_63575107> : metapp::DeclareMetaTypeBase <ViewCacheDerived_63575107>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<ViewCacheDerived_63575107>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("derivedValue", &ViewCacheDerived_63575107::derivedValue);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+TEST_CASE("MetaClass, cached view including bases is rebuilt after registration")
+{
+	auto metaClass = metapp::getMetaType<ViewCacheDerived_63575107>()->getMetaClass();
+
+	// The base class is not registered yet
+	REQUIRE(metaClass->getAccessibleView().size() == 1);
+	REQUIRE(metaClass->getAccessibleView().size() == 1);
+
+	{
+		metapp::MetaRepo metaRepo;
+		metaRepo.registerBase<ViewCacheDerived_63575107, ViewCacheBase_63575107>();
+
+		auto view = metaClass->getAccessibleView();
+		REQUIRE(view.size() == 2);
+		REQUIRE(view[0].getName() == "derivedValue");
+		REQUIRE(view[1].getName() == "baseValue");
+		REQUIRE(metaClass->getAccessibleView().size() == 2);
+		REQUIRE(metaClass->getAccessibleView(metapp::MetaClass::flagNone).size() == 1);
+	}
+
+	// The repo is destroyed, the base class is not visible anymore
+	REQUIRE(metaClass->getAccessibleView().size() == 1);
+}
+
+TEST_CASE("MetaClass, cached view including bases is rebuilt after the base class items change")
+{
+	auto metaClass = metapp::getMetaType<ViewCacheDerived_63575107>()->getMetaClass();
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerBase<ViewCacheDerived_63575107, ViewCacheBase_63575107>();
+	REQUIRE(metaClass->getCallableView().size() == 0);
+
+	// Unrelated registrations keep the cached view valid
+	metapp::MetaRepo unrelatedRepo;
+	unrelatedRepo.registerVariable("unrelated", 1);
+	REQUIRE(metaClass->getCallableView().size() == 0);
+
+	auto baseMetaClass = const_cast<metapp::MetaClass *>(metapp::getMetaType<ViewCacheBase_63575107>()->getMetaClass());
+	baseMetaClass->registerCallable("getBaseValue", std::function<int (const ViewCacheBase_63575107 &)>(
+		[](const ViewCacheBase_63575107 & obj) {
+			return obj.baseValue;
+		}
+	));
+	auto view = metaClass->getCallableView();
+	REQUIRE(view.size() == 1);
+	REQUIRE(view[0].getName() == "getBaseValue");
+}
@@ -0,0 +1,268 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/metarepo.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+struct EventA
+{
+};
+
+struct EventB
+{
+};
+
+enum class Priority
+{
+	low,
+	high
+};
+
+struct HandlerBase
+{
+	void onA(const EventA &) {}
+	int count() const { return 0; }
+};
+
+struct Handler : HandlerBase
+{
+	void handleA(EventA &) {}
+	void handleB(const EventB &) {}
+	void handleAB(const EventA &, const EventB &) {}
+	int sum(int a, int b = 1) const { return a + b; }
+	std::string name() const { return ""; }
+	int value;
+};
+
+std::string freeHandleB(const EventB &)
+{
+	return "";
+}
+
+int freeVariadic(const metapp::Variant * /*arguments*/, const std::size_t argumentCount)
+{
+	return (int)argumentCount;
+}
+
+bool hasItem(const metapp::MetaItemPointerList & itemList, const std::string & name)
+{
+	return std::find_if(itemList.begin(), itemList.end(), [&name](const metapp::MetaItem * item) {
+		return item->getName() == name;
+	}) != itemList.end();
+}
+
+metapp::MetaRepo itemIndexMetaRepo;
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <HandlerBase> : metapp::DeclareMetaTypeBase <HandlerBase>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<HandlerBase>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerCallable("onA", &HandlerBase::onA).registerAnnotation("event", "A");
+				mc.registerCallable("count", &HandlerBase::count);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <Handler> : metapp::DeclareMetaTypeBase <Handler>
+{
+	static void setup()
+	{
+		itemIndexMetaRepo.registerBase<Handler, HandlerBase>();
+	}
+
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<Handler>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerCallable("handleA", &Handler::handleA).registerAnnotation("event", "A");
+				auto & itemB = mc.registerCallable("handleB", &Handler::handleB);
+				itemB.registerAnnotation("event", std::string("B"));
+				itemB.registerAnnotation("priority", Priority::high);
+				mc.registerCallable("handleAB", &Handler::handleAB).registerAnnotation("priority", 1);
+				mc.registerCallable("sum", metapp::createDefaultArgsFunction(&Handler::sum, { 1 }));
+				mc.registerCallable("name", &Handler::name);
+				mc.registerAccessible("value", &Handler::value).registerAnnotation("serialize", true);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+TEST_CASE("MetaClass, findCallablesByParameter")
+{
+	const metapp::MetaClass * metaClass = metapp::getMetaType<Handler>()->getMetaClass();
+
+	SECTION("reference and cv are ignored") {
+		const auto itemList = metaClass->findCallablesByParameter(1, 0, metapp::getMetaType<EventA>());
+		REQUIRE(itemList.size() == 2);
+		REQUIRE(itemList[0]->getName() == "handleA");
+		REQUIRE(itemList[1]->getName() == "onA");
+	}
+
+	SECTION("without base") {
+		const auto itemList = metaClass->findCallablesByParameter(
+			1, 0, metapp::getMetaType<const EventA &>(), metapp::MetaClass::flagNone
+		);
+		REQUIRE(itemList.size() == 1);
+		REQUIRE(itemList[0]->getName() == "handleA");
+	}
+
+	SECTION("parameter index") {
+		auto itemList = metaClass->findCallablesByParameter(2, 1, metapp::getMetaType<EventB>());
+		REQUIRE(itemList.size() == 1);
+		REQUIRE(itemList[0]->getName() == "handleAB");
+
+		itemList = metaClass->findCallablesByParameter(1, 0, metapp::getMetaType<EventB>());
+		REQUIRE(itemList.size() == 1);
+		REQUIRE(itemList[0]->getName() == "handleB");
+	}
+
+	SECTION("default arguments") {
+		REQUIRE(metaClass->findCallablesByParameter(1, 0, metapp::getMetaType<int>()).size() == 1);
+		REQUIRE(metaClass->findCallablesByParameter(2, 1, metapp::getMetaType<int>()).size() == 1);
+		REQUIRE(metaClass->findCallablesByParameter(3, 2, metapp::getMetaType<int>()).empty());
+	}
+}
+
+TEST_CASE("MetaClass, findCallablesByArity")
+{
+	const metapp::MetaClass * metaClass = metapp::getMetaType<Handler>()->getMetaClass();
+
+	auto itemList = metaClass->findCallablesByArity(0);
+	REQUIRE(itemList.size() == 2);
+	REQUIRE(hasItem(itemList, "name"));
+	REQUIRE(hasItem(itemList, "count"));
+
+	itemList = metaClass->findCallablesByArity(2);
+	REQUIRE(itemList.size() == 2);
+	REQUIRE(hasItem(itemList, "handleAB"));
+	REQUIRE(hasItem(itemList, "sum"));
+}
+
+TEST_CASE("MetaClass, findCallablesByReturnType")
+{
+	const metapp::MetaClass * metaClass = metapp::getMetaType<Handler>()->getMetaClass();
+
+	auto itemList = metaClass->findCallablesByReturnType(metapp::getMetaType<int>());
+	REQUIRE(itemList.size() == 2);
+	REQUIRE(hasItem(itemList, "sum"));
+	REQUIRE(hasItem(itemList, "count"));
+
+	itemList = metaClass->findCallablesByReturnType(metapp::getMetaType<void>(), metapp::MetaClass::flagNone);
+	REQUIRE(itemList.size() == 3);
+}
+
+TEST_CASE("MetaClass, findItemsByAnnotation")
+{
+	const metapp::MetaClass * metaClass = metapp::getMetaType<Handler>()->getMetaClass();
+
+	SECTION("by name") {
+		const auto itemList = metaClass->findItemsByAnnotation("event");
+		REQUIRE(itemList.size() == 3);
+		REQUIRE(metaClass->findItemsByAnnotation("event", metapp::MetaClass::flagNone).size() == 2);
+		REQUIRE(metaClass->findItemsByAnnotation("serialize").size() == 1);
+		REQUIRE(metaClass->findItemsByAnnotation("notExist").empty());
+	}
+
+	SECTION("by string value") {
+		auto itemList = metaClass->findItemsByAnnotationValue("event", "A");
+		REQUIRE(itemList.size() == 2);
+		REQUIRE(hasItem(itemList, "handleA"));
+		REQUIRE(hasItem(itemList, "onA"));
+
+		itemList = metaClass->findItemsByAnnotationValue("event", std::string("B"));
+		REQUIRE(itemList.size() == 1);
+		REQUIRE(itemList[0]->getName() == "handleB");
+	}
+
+	SECTION("by arithmetic or enum value") {
+		auto itemList = metaClass->findItemsByAnnotationValue("priority", 1);
+		REQUIRE(itemList.size() == 2);
+		itemList = metaClass->findItemsByAnnotationValue("priority", Priority::high);
+		REQUIRE(itemList.size() == 2);
+		itemList = metaClass->findItemsByAnnotationValue("priority", 1.0);
+		REQUIRE(itemList.size() == 2);
+		itemList = metaClass->findItemsByAnnotationValue("priority", 0);
+		REQUIRE(itemList.empty());
+		itemList = metaClass->findItemsByAnnotationValue("priority", "1");
+		REQUIRE(itemList.empty());
+	}
+}
+
+TEST_CASE("MetaRepo, find items, index is updated after registration")
+{
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerCallable("freeHandleB", &freeHandleB);
+	metaRepo.registerCallable("freeVariadic", metapp::createVariadicFunction(&freeVariadic));
+
+	REQUIRE(metaRepo.findCallablesByParameter(1, 0, metapp::getMetaType<EventB>()).size() == 1);
+	REQUIRE(metaRepo.findCallablesByReturnType(metapp::getMetaType<std::string>()).size() == 1);
+	// Variadic functions are found by any arity
+	REQUIRE(metaRepo.findCallablesByArity(5).size() == 1);
+	REQUIRE(metaRepo.findCallablesByArity(5)[0]->getName() == "freeVariadic");
+	REQUIRE(metaRepo.findItemsByAnnotation("tag").empty());
+
+	// Overloading, the item is found once
+	metaRepo.registerCallable("freeHandleB", std::function<void (const EventB &, int)>([](const EventB &, int) {}));
+	metaRepo.registerCallable("freeHandleB", std::function<void (const EventB &, double)>([](const EventB &, double) {}));
+	auto itemList = metaRepo.findCallablesByParameter(2, 0, metapp::getMetaType<EventB>());
+	REQUIRE(itemList.size() == 1);
+	REQUIRE(itemList[0]->getName() == "freeHandleB");
+	REQUIRE(metaRepo.findCallablesByParameter(1, 0, metapp::getMetaType<EventB>()).size() == 1);
+
+	int value = 0;
+	metaRepo.registerAccessible("value", &value).registerAnnotation("tag", 5);
+	REQUIRE(metaRepo.findItemsByAnnotation("tag").size() == 1);
+	REQUIRE(metaRepo.findItemsByAnnotationValue("tag", 5).size() == 1);
+}
+
+TEST_CASE("MetaRepo, find items, index is updated after the items in the repo change")
+{
+	metapp::MetaRepo metaRepo;
+	int value = 0;
+	metapp::MetaItem & item = metaRepo.registerAccessible("value", &value);
+	REQUIRE(metaRepo.findItemsByAnnotation("tag").empty());
+
+	// Registering in another repo doesn't change the items in metaRepo
+	metapp::MetaRepo otherRepo;
+	otherRepo.registerAccessible("other", &value).registerAnnotation("tag", 1);
+	REQUIRE(metaRepo.findItemsByAnnotation("tag").empty());
+	REQUIRE(otherRepo.findItemsByAnnotation("tag").size() == 1);
+
+	// Adding an annotation to a registered item updates the index
+	item.registerAnnotation("tag", 2);
+	REQUIRE(metaRepo.findItemsByAnnotation("tag").size() == 1);
+	REQUIRE(metaRepo.findItemsByAnnotationValue("tag", 2).size() == 1);
+	REQUIRE(otherRepo.findItemsByAnnotationValue("tag", 2).empty());
+}
@@ -96,3 +96,17 @@ TEST_CASE("MetaRepo, nested repo")
 }
 
 
+
+TEST_CASE("MetaRepo, copied item outlives the repo")
+{
+	metapp::MetaItem item;
+	{
+		metapp::MetaRepo metaRepo;
+		item = metaRepo.registerVariable("value", 1);
+		REQUIRE(metaRepo.getVariable("value").asVariable().get<int>() == 1);
+	}
+	item.setTarget(2);
+	item.registerAnnotation("note", 3);
+	REQUIRE(item.asVariable().get<int>() == 2);
+	REQUIRE(item.getAnnotation("note").get<int>() == 3);
+}
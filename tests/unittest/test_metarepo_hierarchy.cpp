@@ -22,6 +22,7 @@
 
 #include <string>
 #include <iostream>
+#include <memory>
 #include <climits>
 
 namespace {
@@ -240,4 +241,121 @@ TEST_CASE("MetaRepo, hierarchy, relationship")
 }
 
 
+struct DynamicBase
+{
+	virtual ~DynamicBase() {}
+	int base = 1;
+};
+
+struct DynamicOther
+{
+	virtual ~DynamicOther() {}
+	int other = 2;
+};
+
+struct DynamicDerived : DynamicBase
+{
+	int derived = 3;
+};
+
+struct DynamicGrand : DynamicDerived
+{
+	int grand = 4;
+};
+
+struct DynamicMulti : DynamicOther, DynamicBase
+{
+	int multi = 5;
+};
+
+struct DynamicVirtualDerived : virtual DynamicBase
+{
+	int virtualDerived = 6;
+};
+
+struct DynamicUnregistered : DynamicBase
+{
+};
+
+struct DynamicPlain
+{
+	int plain;
+};
+
+TEST_CASE("MetaRepo, hierarchy, getDynamicMetaType")
+{
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerBase<DynamicDerived, DynamicBase>();
+	metaRepo.registerBase<DynamicGrand, DynamicDerived>();
+	metaRepo.registerBase<DynamicMulti, DynamicOther, DynamicBase>();
+	metaRepo.registerBase<DynamicVirtualDerived, DynamicBase>();
+
+	SECTION("pointer to derived") {
+		DynamicDerived derived;
+		DynamicBase * base = &derived;
+		REQUIRE(metapp::getDynamicMetaType(base) == metapp::getMetaType<DynamicDerived>());
+		const metapp::Variant ref = metapp::getDynamicReference(base);
+		REQUIRE(ref.getMetaType()->isReference());
+		REQUIRE(&ref.get<DynamicDerived &>() == &derived);
+		REQUIRE(ref.get<DynamicDerived &>().derived == 3);
+	}
+
+	SECTION("the static type is the dynamic type") {
+		DynamicBase base;
+		REQUIRE(metapp::getDynamicMetaType(&base) == metapp::getMetaType<DynamicBase>());
+		REQUIRE(&metapp::getDynamicReference(&base).get<DynamicBase &>() == &base);
+	}
+
+	SECTION("more than one level") {
+		DynamicGrand grand;
+		DynamicBase * base = &grand;
+		REQUIRE(metapp::getDynamicMetaType(base) == metapp::getMetaType<DynamicGrand>());
+		REQUIRE(&metapp::getDynamicReference(base).get<DynamicGrand &>() == &grand);
+	}
+
+	SECTION("multiple inheritance adjusts the pointer") {
+		DynamicMulti multi;
+		DynamicBase * base = &multi;
+		REQUIRE((void *)base != (void *)&multi);
+		REQUIRE(metapp::getDynamicMetaType(base) == metapp::getMetaType<DynamicMulti>());
+		REQUIRE(&metapp::getDynamicReference(base).get<DynamicMulti &>() == &multi);
+		REQUIRE(metapp::getDynamicReference(base).get<DynamicMulti &>().multi == 5);
+	}
+
+	SECTION("virtual base") {
+		DynamicVirtualDerived derived;
+		DynamicBase * base = &derived;
+		REQUIRE(metapp::getDynamicMetaType(base) == metapp::getMetaType<DynamicVirtualDerived>());
+		REQUIRE(&metapp::getDynamicReference(base).get<DynamicVirtualDerived &>() == &derived);
+	}
+
+	SECTION("reference, const, and std::shared_ptr") {
+		DynamicDerived derived;
+		DynamicBase & base = derived;
+		REQUIRE(metapp::getDynamicMetaType(metapp::Variant::reference(base)) == metapp::getMetaType<DynamicDerived>());
+		const DynamicBase * constBase = &derived;
+		REQUIRE(metapp::getDynamicMetaType(constBase) == metapp::getMetaType<DynamicDerived>());
+		std::shared_ptr<DynamicBase> sp = std::make_shared<DynamicGrand>();
+		REQUIRE(metapp::getDynamicMetaType(sp) == metapp::getMetaType<DynamicGrand>());
+		REQUIRE(&metapp::getDynamicReference(sp).get<DynamicGrand &>() == sp.get());
+	}
+
+	SECTION("unregistered dynamic type falls back to the static type") {
+		DynamicUnregistered unregistered;
+		DynamicBase * base = &unregistered;
+		REQUIRE(metapp::getDynamicMetaType(base) == metapp::getMetaType<DynamicBase>());
+		REQUIRE(&metapp::getDynamicReference(base).get<DynamicBase &>() == base);
+	}
+
+	SECTION("non polymorphic and nullptr") {
+		DynamicPlain plain;
+		REQUIRE(metapp::getDynamicMetaType(&plain) == metapp::getMetaType<DynamicPlain>());
+		REQUIRE(metapp::getDynamicReference(&plain).isEmpty());
+		DynamicBase * base = nullptr;
+		REQUIRE(metapp::getDynamicMetaType(base) == metapp::getMetaType<DynamicBase>());
+		REQUIRE(metapp::getDynamicReference(base).isEmpty());
+	}
+}
+
+
 } // namespace
@@ -105,6 +105,27 @@ TEST_CASE("MetaRepoList, for loop")
 		}
 		REQUIRE(getMetaRepoListSize() == existedRepoCount);
 	}
+
+	SECTION("copy and move meta repos") {
+		{
+			metapp::MetaRepo metaRepo1;
+			metapp::MetaRepo metaRepo2(metaRepo1);
+			metapp::MetaRepo metaRepo3(std::move(metaRepo1));
+			{
+				metapp::MetaRepo metaRepo4(metaRepo2);
+				REQUIRE(getMetaRepoListSize() == existedRepoCount + 4);
+			}
+
+			for(auto repo : *metaRepoList) {
+				repoList.push_back(repo);
+			}
+			REQUIRE(repoList.size() == existedRepoCount + 3);
+			REQUIRE(repoList[existedRepoCount] == &metaRepo1);
+			REQUIRE(repoList[existedRepoCount + 1] == &metaRepo2);
+			REQUIRE(repoList[existedRepoCount + 2] == &metaRepo3);
+		}
+		REQUIRE(getMetaRepoListSize() == existedRepoCount);
+	}
 }
 
 TEST_CASE("MetaRepoList, findMetaRepoForHierarchy")
@@ -0,0 +1,144 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/nameindex.h"
+#include "metapp/metarepo.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaenum.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+struct IndexedClass
+{
+	int position;
+	int positionX;
+	void print() {}
+};
+
+enum class IndexedColor
+{
+	red,
+	green,
+	greenish
+};
+
+std::vector<std::string> getNameList(const metapp::MetaItemPointerList & itemList)
+{
+	std::vector<std::string> nameList;
+	for(const metapp::MetaItem * item : itemList) {
+		nameList.push_back(item->getName());
+	}
+	return nameList;
+}
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <IndexedClass> : metapp::DeclareMetaTypeBase <IndexedClass>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<IndexedClass>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("position", &IndexedClass::position);
+				mc.registerAccessible("positionX", &IndexedClass::positionX);
+				mc.registerCallable("print", &IndexedClass::print);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <IndexedColor> : metapp::DeclareMetaTypeBase <IndexedColor>
+{
+	static const metapp::MetaEnum * getMetaEnum() {
+		static const metapp::MetaEnum metaEnum([](metapp::MetaEnum & me) {
+			me.registerValue("red", IndexedColor::red);
+			me.registerValue("green", IndexedColor::green);
+			me.registerValue("greenish", IndexedColor::greenish);
+		});
+		return &metaEnum;
+	}
+};
+
+TEST_CASE("NameIndex, findByPrefix")
+{
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerType<IndexedClass>("IndexedClass");
+	metaRepo.registerType<IndexedColor>("IndexedColor");
+	metaRepo.registerVariable("pi", 3.14);
+
+	metapp::NameIndex nameIndex;
+	nameIndex.addMetaRepo(&metaRepo);
+
+	REQUIRE(getNameList(nameIndex.findByPrefix("pos")) == std::vector<std::string> { "position", "positionX" });
+	REQUIRE(getNameList(nameIndex.findByPrefix("p")) == std::vector<std::string> { "pi", "position", "positionX", "print" });
+	REQUIRE(getNameList(nameIndex.findByPrefix("gre")) == std::vector<std::string> { "green", "greenish" });
+	REQUIRE(getNameList(nameIndex.findByPrefix("Indexed")) == std::vector<std::string> { "IndexedClass", "IndexedColor" });
+	REQUIRE(nameIndex.findByPrefix("x").empty());
+	REQUIRE(nameIndex.findByPrefix("positionXY").empty());
+	REQUIRE(nameIndex.findByPrefix("").size() == nameIndex.getItemCount());
+	REQUIRE(nameIndex.getItemCount() == 3 + 3 + 3);
+
+	SECTION("limit") {
+		REQUIRE(getNameList(nameIndex.findByPrefix("p", 2)) == std::vector<std::string> { "pi", "position" });
+	}
+
+	SECTION("incremental update") {
+		metaRepo.registerVariable("pit", 1);
+		metaRepo.registerCallable("printAll", &IndexedClass::print);
+		REQUIRE(getNameList(nameIndex.findByPrefix("pi")) == std::vector<std::string> { "pi", "pit" });
+		REQUIRE(getNameList(nameIndex.findByPrefix("pr")) == std::vector<std::string> { "print", "printAll" });
+		REQUIRE(nameIndex.getItemCount() == 3 + 3 + 3 + 2);
+	}
+
+	SECTION("registering in unindexed repo") {
+		metapp::MetaRepo otherRepo;
+		otherRepo.registerVariable("pin", 1);
+		REQUIRE(getNameList(nameIndex.findByPrefix("pi")) == std::vector<std::string> { "pi" });
+		REQUIRE(nameIndex.getItemCount() == 3 + 3 + 3);
+
+		metaRepo.registerRepo("pie");
+		REQUIRE(getNameList(nameIndex.findByPrefix("pi")) == std::vector<std::string> { "pi", "pie" });
+	}
+}
+
+TEST_CASE("NameIndex, findFuzzy")
+{
+	metapp::NameIndex nameIndex;
+	nameIndex.addMetaType(metapp::getMetaType<IndexedClass>());
+	nameIndex.addMetaType(metapp::getMetaType<IndexedColor>());
+
+	REQUIRE(getNameList(nameIndex.findFuzzy("green", 0)) == std::vector<std::string> { "green" });
+	REQUIRE(getNameList(nameIndex.findFuzzy("gren", 1)) == std::vector<std::string> { "green" });
+	REQUIRE(getNameList(nameIndex.findFuzzy("grean", 1)) == std::vector<std::string> { "green" });
+	REQUIRE(getNameList(nameIndex.findFuzzy("greenis", 1)) == std::vector<std::string> { "greenish" });
+	REQUIRE(getNameList(nameIndex.findFuzzy("greenis", 3)) == std::vector<std::string> { "greenish", "green" });
+	REQUIRE(getNameList(nameIndex.findFuzzy("greenis", 3, 1)) == std::vector<std::string> { "greenish" });
+	REQUIRE(getNameList(nameIndex.findFuzzy("positoin", 2)) == std::vector<std::string> { "position" });
+	REQUIRE(getNameList(nameIndex.findFuzzy("positoin", 3)) == std::vector<std::string> { "position", "positionX" });
+	REQUIRE(getNameList(nameIndex.findFuzzy("rad", 1)) == std::vector<std::string> { "red" });
+	REQUIRE(nameIndex.findFuzzy("blue", 1).empty());
+	REQUIRE(getNameList(nameIndex.findFuzzy("", 3)) == std::vector<std::string> { "red" });
+}
@@ -0,0 +1,201 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/objectvisitor.h"
+#include "metapp/utilities/threadpool.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+namespace {
+
+struct GraphNode
+{
+	std::string name;
+	std::vector<GraphNode *> children;
+	std::shared_ptr<GraphNode> extra;
+};
+
+struct GraphHolder
+{
+	int id;
+	std::list<GraphNode> nodeList;
+	std::map<std::string, GraphNode *> nodeMap;
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <GraphNode> : metapp::DeclareMetaTypeBase <GraphNode>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<GraphNode>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("name", &GraphNode::name);
+				mc.registerAccessible("children", &GraphNode::children);
+				mc.registerAccessible("extra", &GraphNode::extra);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <GraphHolder> : metapp::DeclareMetaTypeBase <GraphHolder>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<GraphHolder>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("id", &GraphHolder::id);
+				mc.registerAccessible("nodeList", &GraphHolder::nodeList);
+				mc.registerAccessible("nodeMap", &GraphHolder::nodeMap);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+std::multiset<std::string> collectNodeNames(metapp::ObjectVisitor & visitor, const metapp::Variant & root)
+{
+	std::mutex mutex;
+	std::multiset<std::string> nameSet;
+	visitor.visit(root, [&mutex, &nameSet](const metapp::ObjectVisitor::Node & node) -> bool {
+		if(metapp::getNonReferenceMetaType(node.object)->equal(metapp::getMetaType<GraphNode>())) {
+			std::lock_guard<std::mutex> lock(mutex);
+			nameSet.insert(node.object.get<GraphNode &>().name);
+		}
+		return true;
+	});
+	return nameSet;
+}
+
+TEST_CASE("ObjectVisitor, members, containers, pointers and cycles")
+{
+	GraphNode a { "a", {}, nullptr };
+	GraphNode b { "b", {}, nullptr };
+	GraphNode c { "c", {}, nullptr };
+	a.children = { &b, &c };
+	b.children = { &c, &a };
+	c.children = { &c };
+	c.extra = std::make_shared<GraphNode>();
+	c.extra->name = "extra";
+
+	metapp::ObjectVisitor visitor;
+	// a is the root, b and c are reached by pointers, each node is visited once.
+	REQUIRE(collectNodeNames(visitor, metapp::Variant::reference(a)) == std::multiset<std::string> { "a", "b", "c", "extra" });
+	// Starting from a pointer works too.
+	REQUIRE(collectNodeNames(visitor, &b) == std::multiset<std::string> { "a", "b", "c", "extra" });
+}
+
+TEST_CASE("ObjectVisitor, node accessible and depth")
+{
+	GraphNode a { "a", {}, nullptr };
+	std::vector<std::string> accessibleNameList;
+	std::size_t maxVisitedDepth = 0;
+	metapp::ObjectVisitor visitor;
+	visitor.visit(metapp::Variant::reference(a), [&accessibleNameList, &maxVisitedDepth](const metapp::ObjectVisitor::Node & node) -> bool {
+		if(node.accessible != nullptr) {
+			accessibleNameList.push_back(node.accessible->getName());
+		}
+		maxVisitedDepth = std::max(maxVisitedDepth, node.depth);
+		return true;
+	});
+	REQUIRE(accessibleNameList == std::vector<std::string> { "name", "children", "extra" });
+	REQUIRE(maxVisitedDepth == 1);
+}
+
+TEST_CASE("ObjectVisitor, skip children and max depth")
+{
+	GraphNode a { "a", {}, nullptr };
+	GraphNode b { "b", {}, nullptr };
+	a.children = { &b };
+
+	metapp::ObjectVisitor visitor;
+	std::size_t count = 0;
+	visitor.visit(metapp::Variant::reference(a), [&count](const metapp::ObjectVisitor::Node &) -> bool {
+		++count;
+		return false;
+	});
+	REQUIRE(count == 1);
+
+	// depth 0: a, depth 1: members of a, depth 2: the pointer in children, depth 3: b
+	visitor.setMaxDepth(2);
+	REQUIRE(collectNodeNames(visitor, metapp::Variant::reference(a)) == std::multiset<std::string> { "a" });
+	visitor.setMaxDepth(3);
+	REQUIRE(collectNodeNames(visitor, metapp::Variant::reference(a)) == std::multiset<std::string> { "a", "b" });
+}
+
+TEST_CASE("ObjectVisitor, parallel")
+{
+	constexpr int nodeCount = 2000;
+	GraphHolder holder;
+	holder.id = 1;
+	std::vector<GraphNode *> pointerList;
+	for(int i = 0; i < nodeCount; ++i) {
+		holder.nodeList.push_back(GraphNode { std::to_string(i), {}, nullptr });
+		pointerList.push_back(&holder.nodeList.back());
+	}
+	for(int i = 0; i < nodeCount; ++i) {
+		// shared and cyclic pointers
+		pointerList[i]->children = { pointerList[(i + 1) % nodeCount], pointerList[(i * 7) % nodeCount] };
+		holder.nodeMap[std::to_string(i)] = pointerList[i];
+	}
+
+	metapp::ThreadPool threadPool(4);
+	metapp::ObjectVisitor visitor;
+	visitor.setExecutor(&threadPool);
+
+	SECTION("each node is visited once") {
+		// Each node is reached by value in nodeList, and by several pointers.
+		const std::multiset<std::string> nameSet = collectNodeNames(visitor, metapp::Variant::reference(holder));
+		REQUIRE(nameSet.size() == nodeCount);
+		for(int i = 0; i < nodeCount; ++i) {
+			REQUIRE(nameSet.count(std::to_string(i)) == 1);
+		}
+	}
+
+	SECTION("exception") {
+		std::atomic<int> count(0);
+		REQUIRE_THROWS_AS(
+			visitor.visit(metapp::Variant::reference(holder), [&count](const metapp::ObjectVisitor::Node &) -> bool {
+				if(++count == 100) {
+					throw std::runtime_error("failed");
+				}
+				return true;
+			}),
+			std::runtime_error
+		);
+	}
+}
+
+
+} // namespace
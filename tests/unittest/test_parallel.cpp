@@ -0,0 +1,320 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/parallel.h"
+#include "metapp/allmetatypes.h"
+
+#include <vector>
+#include <deque>
+#include <list>
+#include <set>
+#include <atomic>
+#include <stdexcept>
+
+namespace {
+
+// Packs 8 bools in a byte and returns the elements by value, the same as std::vector<bool>.
+// Setting neighbour elements from several threads is a data race.
+struct PackedBits
+{
+	std::vector<unsigned char> byteList;
+	std::size_t size;
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <PackedBits> : metapp::DeclareMetaTypeBase <PackedBits>
+{
+	static const metapp::MetaIndexable * getMetaIndexable() {
+		static const metapp::MetaIndexable metaIndexable(
+			&metaIndexableGetSizeInfo,
+			&metaIndexableGetValueType,
+			&metaIndexableResize,
+			&metaIndexableGet,
+			&metaIndexableSet
+		);
+		return &metaIndexable;
+	}
+
+private:
+	static metapp::MetaIndexable::SizeInfo metaIndexableGetSizeInfo(const metapp::Variant & indexable) {
+		return metapp::MetaIndexable::SizeInfo { indexable.get<PackedBits &>().size };
+	}
+
+	static const metapp::MetaType * metaIndexableGetValueType(const metapp::Variant & /*indexable*/, const std::size_t /*index*/) {
+		return metapp::getMetaType<bool>();
+	}
+
+	static void metaIndexableResize(const metapp::Variant & indexable, const std::size_t size) {
+		PackedBits & bits = indexable.get<PackedBits &>();
+		bits.byteList.resize((size + 7) / 8);
+		bits.size = size;
+	}
+
+	static metapp::Variant metaIndexableGet(const metapp::Variant & indexable, const std::size_t index) {
+		const PackedBits & bits = indexable.get<PackedBits &>();
+		return (bits.byteList[index / 8] & (1 << (index % 8))) != 0;
+	}
+
+	static void metaIndexableSet(const metapp::Variant & indexable, const std::size_t index, const metapp::Variant & value) {
+		PackedBits & bits = indexable.get<PackedBits &>();
+		const unsigned char mask = (unsigned char)(1 << (index % 8));
+		if(value.cast<bool>().get<bool>()) {
+			bits.byteList[index / 8] |= mask;
+		}
+		else {
+			bits.byteList[index / 8] &= (unsigned char)~mask;
+		}
+	}
+};
+
+namespace {
+
+TEST_CASE("MetaIndexable, getData")
+{
+	std::vector<int> vector { 1, 2, 3 };
+	REQUIRE(metapp::indexableGetData(metapp::Variant::reference(vector)) == vector.data());
+
+	std::array<int, 3> array { { 1, 2, 3 } };
+	REQUIRE(metapp::indexableGetData(metapp::Variant::reference(array)) == array.data());
+
+	int cArray[3] = { 1, 2, 3 };
+	REQUIRE(metapp::indexableGetData(metapp::Variant::reference(cArray)) == &cArray[0]);
+
+	std::deque<int> deque { 1, 2, 3 };
+	REQUIRE(metapp::indexableGetData(metapp::Variant::reference(deque)) == nullptr);
+
+	std::list<int> list { 1, 2, 3 };
+	REQUIRE(metapp::indexableGetData(metapp::Variant::reference(list)) == nullptr);
+	REQUIRE(! metapp::indexableGetSizeInfo(metapp::Variant::reference(list)).isRandomAccess());
+	REQUIRE(metapp::indexableGetSizeInfo(metapp::Variant::reference(deque)).isRandomAccess());
+}
+
+TEST_CASE("MetaIndexable, getElementAddress")
+{
+	std::deque<int> deque { 1, 2, 3 };
+	REQUIRE(metapp::indexableGetElementAddress(metapp::Variant::reference(deque), 2) == &deque[2]);
+	REQUIRE(metapp::indexableGetElementAddress(metapp::Variant::reference(deque), 3) == nullptr);
+
+	std::vector<int> vector { 1, 2, 3 };
+	REQUIRE(metapp::indexableGetElementAddress(metapp::Variant::reference(vector), 1) == &vector[1]);
+
+	std::list<int> list { 1, 2, 3 };
+	REQUIRE(metapp::indexableGetElementAddress(metapp::Variant::reference(list), 0) == nullptr);
+}
+
+using TestTypes_Parallel = std::tuple<std::vector<int>, std::deque<int>, std::list<int> >;
+
+TEMPLATE_LIST_TEST_CASE("parallelForEach", "", TestTypes_Parallel)
+{
+	metapp::ThreadPool threadPool(3);
+	TestType container;
+	for(int i = 0; i < 1000; ++i) {
+		container.push_back(i);
+	}
+	metapp::Variant v = metapp::Variant::reference(container);
+
+	SECTION("Variant element") {
+		std::atomic<long long> sum(0);
+		std::atomic<long long> indexSum(0);
+		metapp::parallelForEach(v, [&sum, &indexSum](const metapp::Variant & element, const std::size_t index) {
+			sum += element.get<int>();
+			indexSum += (long long)index;
+		}, 7, threadPool);
+		REQUIRE(sum == 999 * 1000 / 2);
+		REQUIRE(indexSum == 999 * 1000 / 2);
+	}
+
+	SECTION("typed element") {
+		metapp::parallelForEachAs<int>(v, [](int & element, const std::size_t index) {
+			element = (int)index * 2;
+		}, 0, threadPool);
+		int expected = 0;
+		for(const int n : container) {
+			REQUIRE(n == expected);
+			expected += 2;
+		}
+	}
+
+	SECTION("typed element, wrong type") {
+		REQUIRE_THROWS_AS(
+			metapp::parallelForEachAs<long>(v, [](long &, const std::size_t) {}, 0, threadPool),
+			metapp::BadCastException
+		);
+	}
+}
+
+TEST_CASE("parallelForEach, set is iterable only")
+{
+	std::set<int> container { 1, 2, 3, 4, 5 };
+	std::atomic<int> sum(0);
+	metapp::parallelForEachAs<const int>(metapp::Variant::reference(container), [&sum](const int & element, const std::size_t) {
+		sum += element;
+	}, 1);
+	REQUIRE(sum == 15);
+}
+
+TEST_CASE("parallelForEach, C array")
+{
+	int container[100];
+	metapp::parallelForEachAs<int>(metapp::Variant::reference(container), [](int & element, const std::size_t index) {
+		element = (int)index;
+	}, 10);
+	for(int i = 0; i < 100; ++i) {
+		REQUIRE(container[i] == i);
+	}
+}
+
+TEST_CASE("parallelForEach, exception is rethrown")
+{
+	std::vector<int> container(100);
+	REQUIRE_THROWS_AS(
+		metapp::parallelForEach(metapp::Variant::reference(container), [](const metapp::Variant &, const std::size_t index) {
+			if(index == 50) {
+				throw std::runtime_error("failed");
+			}
+		}, 1),
+		std::runtime_error
+	);
+}
+
+TEST_CASE("parallelForEach, nested in a thread pool task")
+{
+	std::vector<int> container(1000, 1);
+	std::atomic<int> sum(0);
+	metapp::Variant v = metapp::Variant::reference(container);
+	metapp::parallelForEach(v, [&v, &sum](const metapp::Variant &, const std::size_t) {
+		if(sum.load() == 0) {
+			metapp::parallelForEachAs<int>(v, [](int &, const std::size_t) {}, 10);
+		}
+		++sum;
+	}, 10);
+	REQUIRE(sum == 1000);
+}
+
+TEST_CASE("parallelForEachAs, std::deque and elements by value")
+{
+	SECTION("std::deque is written in place") {
+		std::deque<int> container(1000, 1);
+		metapp::parallelForEachAs<int>(metapp::Variant::reference(container), [](int & element, const std::size_t index) {
+			element = (int)index;
+		}, 16);
+		for(std::size_t i = 0; i < container.size(); ++i) {
+			REQUIRE(container[i] == (int)i);
+		}
+	}
+
+	SECTION("the elements returned by value are copies") {
+		PackedBits container { std::vector<unsigned char>(125, 0xff), 1000 };
+		std::atomic<int> count(0);
+		metapp::parallelForEachAs<bool>(metapp::Variant::reference(container), [&count](bool & element, const std::size_t) {
+			if(element) {
+				++count;
+			}
+			element = false;
+		}, 16);
+		REQUIRE(count == 1000);
+		REQUIRE(container.byteList[0] == 0xff);
+	}
+}
+
+TEST_CASE("parallelTransform")
+{
+	std::list<int> source { 1, 2, 3, 4, 5 };
+	std::vector<std::string> destination;
+	metapp::parallelTransform(
+		metapp::Variant::reference(source),
+		metapp::Variant::reference(destination),
+		[](const metapp::Variant & element, const std::size_t) -> metapp::Variant {
+			return std::string(element.get<int>(), 'a');
+		},
+		2
+	);
+	REQUIRE(destination.size() == 5);
+	REQUIRE(destination[0] == "a");
+	REQUIRE(destination[4] == "aaaaa");
+}
+
+TEST_CASE("parallelTransformAs")
+{
+	std::vector<int> source(1000);
+	for(int i = 0; i < 1000; ++i) {
+		source[i] = i;
+	}
+
+	SECTION("contiguous destination") {
+		std::vector<double> destination;
+		metapp::parallelTransformAs<int, double>(
+			metapp::Variant::reference(source),
+			metapp::Variant::reference(destination),
+			[](const int & element, const std::size_t) {
+				return element * 0.5;
+			}
+		);
+		REQUIRE(destination.size() == 1000);
+		REQUIRE(destination[999] == 499.5);
+	}
+
+	SECTION("non-contiguous destination") {
+		std::deque<long> destination;
+		metapp::parallelTransformAs<int, long>(
+			metapp::Variant::reference(source),
+			metapp::Variant::reference(destination),
+			[](const int & element, const std::size_t) {
+				return (long)element * 3;
+			}
+		);
+		REQUIRE(destination.size() == 1000);
+		REQUIRE(destination[999] == 2997);
+	}
+
+	SECTION("bit packed destination") {
+		PackedBits destination { {}, 0 };
+		metapp::parallelTransformAs<int, bool>(
+			metapp::Variant::reference(source),
+			metapp::Variant::reference(destination),
+			[](const int & element, const std::size_t) {
+				return element % 3 == 0;
+			},
+			1
+		);
+		REQUIRE(destination.size == 1000);
+		for(std::size_t i = 0; i < 1000; ++i) {
+			REQUIRE(((destination.byteList[i / 8] & (1 << (i % 8))) != 0) == (i % 3 == 0));
+		}
+	}
+
+	SECTION("fixed size destination is too small") {
+		std::array<double, 3> destination;
+		auto transform = [&source, &destination]() {
+			metapp::parallelTransformAs<int, double>(
+				metapp::Variant::reference(source),
+				metapp::Variant::reference(destination),
+				[](const int & element, const std::size_t) {
+					return (double)element;
+				}
+			);
+		};
+		REQUIRE_THROWS_AS(transform(), metapp::OutOfRangeException);
+	}
+}
+
+
+} // namespace
@@ -0,0 +1,269 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/profiler.h"
+#include "metapp/interfaces/metacallable.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/metarepo.h"
+
+#include <string>
+#include <sstream>
+
+namespace {
+
+const metapp::ProfileRecord * findRecord(const std::vector<metapp::ProfileRecord> & recordList, const metapp::Variant & item)
+{
+	const metapp::ProfileKey key = metapp::Profiler::getKey(item);
+	for(const metapp::ProfileRecord & record : recordList) {
+		if(record.key == key) {
+			return &record;
+		}
+	}
+	return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("Profiler, histogram")
+{
+	metapp::Profiler::enable();
+	metapp::Profiler::reset();
+	REQUIRE(metapp::Profiler::isEnabled());
+
+	metapp::Variant item(1);
+	metapp::Profiler::setName(item, "myItem");
+	for(std::uint64_t i = 1; i <= 1000; ++i) {
+		metapp::internal_::recordProfileSample(&item, metapp::ProfilePhase::invoke, 100, 100 + i);
+	}
+	metapp::internal_::recordProfileSample(&item, metapp::ProfilePhase::cast, 100, 110);
+	metapp::Profiler::disable();
+	REQUIRE(! metapp::Profiler::isEnabled());
+	// Not recorded after disabled.
+	metapp::internal_::recordProfileSample(&item, metapp::ProfilePhase::invoke, 100, 200);
+
+	const std::vector<metapp::ProfileRecord> recordList = metapp::Profiler::getRecordList();
+	const metapp::ProfileRecord * record = findRecord(recordList, item);
+	REQUIRE(record != nullptr);
+	REQUIRE(record->name == "myItem");
+
+	const metapp::ProfileHistogram & histogram = record->getHistogram(metapp::ProfilePhase::invoke);
+	REQUIRE(histogram.getCount() == 1000);
+	REQUIRE(histogram.getMax() > 0);
+	// The ticks may not be nanoseconds, so the values are compared relatively to the max (1000 ticks).
+	REQUIRE(histogram.getMean() / histogram.getMax() == Approx(0.5005).epsilon(0.001));
+	REQUIRE(histogram.getPercentile(50) / histogram.getMax() == Approx(0.5).epsilon(1.0 / 16));
+	REQUIRE(histogram.getPercentile(90) / histogram.getMax() == Approx(0.9).epsilon(1.0 / 16));
+	REQUIRE(histogram.getPercentile(100) == histogram.getMax());
+	REQUIRE(histogram.getPercentile(0) <= histogram.getPercentile(50));
+
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::cast).getCount() == 1);
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::call).getCount() == 0);
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::call).getPercentile(50) == 0);
+
+	std::ostringstream stream;
+	metapp::Profiler::writeReport(stream);
+	REQUIRE(stream.str().find("myItem") != std::string::npos);
+
+	metapp::Profiler::reset();
+	REQUIRE(findRecord(metapp::Profiler::getRecordList(), item) == nullptr);
+}
+
+TEST_CASE("Profiler, key")
+{
+	// The small values are identified by the value, the copies have the same key.
+	const metapp::Variant item(&findRecord);
+	const metapp::Variant copy(item);
+	REQUIRE(metapp::Profiler::getKey(copy) == metapp::Profiler::getKey(item));
+	REQUIRE(metapp::Profiler::getKey(metapp::Variant(&findRecord)) == metapp::Profiler::getKey(item));
+	REQUIRE(metapp::Profiler::getKey(metapp::Variant(5)) != metapp::Profiler::getKey(metapp::Variant(6)));
+	// The same value of different types has different keys.
+	REQUIRE(metapp::Profiler::getKey(metapp::Variant(5)) != metapp::Profiler::getKey(metapp::Variant(5u)));
+
+	// The objects on the heap are identified by the address, which is shared by the copies.
+	const metapp::Variant object(std::string("abc"));
+	const metapp::Variant objectCopy(object);
+	REQUIRE(metapp::Profiler::getKey(objectCopy) == metapp::Profiler::getKey(object));
+	REQUIRE(metapp::Profiler::getKey(metapp::Variant(std::string("abc"))) != metapp::Profiler::getKey(object));
+
+	// A reference is identified by the referred object.
+	std::string text;
+	REQUIRE(metapp::Profiler::getKey(metapp::Variant::reference(text)) == metapp::Profiler::getKey(metapp::Variant::reference(text)));
+
+	metapp::Profiler::enable();
+	metapp::Profiler::reset();
+	metapp::internal_::recordProfileSample(&item, metapp::ProfilePhase::invoke, 100, 110);
+	metapp::internal_::recordProfileSample(&copy, metapp::ProfilePhase::invoke, 100, 120);
+	metapp::Profiler::disable();
+	const metapp::ProfileRecord * record = findRecord(metapp::Profiler::getRecordList(), copy);
+	REQUIRE(record != nullptr);
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::invoke).getCount() == 2);
+}
+
+TEST_CASE("Profiler, trace")
+{
+	metapp::Variant item(2);
+	metapp::Profiler::setName(item, "trace\"Item");
+
+	REQUIRE(! metapp::Profiler::isTracing());
+	metapp::Profiler::startTrace(3);
+	REQUIRE(metapp::Profiler::isTracing());
+	// Tracing doesn't enable the histograms.
+	REQUIRE(! metapp::Profiler::isEnabled());
+	for(int i = 0; i < 5; ++i) {
+		metapp::internal_::ProfileTimer timer;
+		timer.record(&item, i == 0 ? metapp::ProfilePhase::cast : metapp::ProfilePhase::invoke);
+	}
+	metapp::Profiler::stopTrace();
+	REQUIRE(! metapp::Profiler::isTracing());
+	metapp::internal_::ProfileTimer().record(&item, metapp::ProfilePhase::invoke);
+	// The events exceed the capacity are dropped.
+	REQUIRE(metapp::Profiler::getTraceEventCount() == 3);
+	REQUIRE(findRecord(metapp::Profiler::getRecordList(), item) == nullptr);
+
+	std::ostringstream stream;
+	metapp::Profiler::writeTrace(stream);
+	const std::string trace = stream.str();
+	REQUIRE(trace.find("\"traceEvents\":[") != std::string::npos);
+	REQUIRE(trace.find("\"name\":\"trace\\\"Item/cast\"") != std::string::npos);
+	REQUIRE(trace.find("\"name\":\"trace\\\"Item\"") != std::string::npos);
+	REQUIRE(trace.find("\"ph\":\"X\"") != std::string::npos);
+	std::size_t eventCount = 0;
+	for(std::size_t pos = trace.find("\"ph\""); pos != std::string::npos; pos = trace.find("\"ph\"", pos + 1)) {
+		++eventCount;
+	}
+	REQUIRE(eventCount == 3);
+}
+
+#ifdef METAPP_ENABLE_PROFILING
+
+namespace {
+
+int profiledAdd(const int a, const int b)
+{
+	return a + b;
+}
+
+std::string profiledConcat(const std::string & a, const std::string & b)
+{
+	return a + b;
+}
+
+struct ProfiledClass
+{
+	int value;
+};
+
+} // namespace
+
+TEST_CASE("Profiler, hooks, callableInvoke and accessible")
+{
+	metapp::Variant callable(&profiledAdd);
+	metapp::Variant accessible(&ProfiledClass::value);
+	metapp::Profiler::setName(callable, "profiledAdd");
+
+	// Nothing is recorded when disabled.
+	REQUIRE(metapp::callableInvoke(callable, nullptr, 1, 2).get<int>() == 3);
+	REQUIRE(findRecord(metapp::Profiler::getRecordList(), callable) == nullptr);
+
+	metapp::Profiler::enable();
+	metapp::Profiler::reset();
+	REQUIRE(metapp::callableInvoke(callable, nullptr, 1, 2).get<int>() == 3);
+	REQUIRE(metapp::callableInvoke(callable, nullptr, 5, 6.0).get<int>() == 11);
+	ProfiledClass object { 5 };
+	REQUIRE(metapp::accessibleGet(accessible, &object).get<int>() == 5);
+	metapp::accessibleSet(accessible, &object, 8);
+	REQUIRE(object.value == 8);
+	metapp::Profiler::disable();
+
+	const std::vector<metapp::ProfileRecord> recordList = metapp::Profiler::getRecordList();
+	const metapp::ProfileRecord * record = findRecord(recordList, callable);
+	REQUIRE(record != nullptr);
+	REQUIRE(record->name == "profiledAdd");
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::invoke).getCount() == 2);
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::cast).getCount() == 2);
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::call).getCount() == 2);
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::box).getCount() == 2);
+
+	record = findRecord(recordList, accessible);
+	REQUIRE(record != nullptr);
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::get).getCount() == 1);
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::set).getCount() == 1);
+}
+
+TEST_CASE("Profiler, hooks, overloaded function and MetaRepo names")
+{
+	metapp::MetaRepo metaRepo;
+	metapp::OverloadedFunction overloadedFunction;
+	overloadedFunction.addCallable(&profiledAdd);
+	overloadedFunction.addCallable(&profiledConcat);
+	metaRepo.registerCallable("func", overloadedFunction);
+	const metapp::Variant & overloaded = metaRepo.getCallable("func").asCallable();
+	metapp::Profiler::addMetaRepo(&metaRepo);
+
+	metapp::Profiler::enable();
+	metapp::Profiler::reset();
+	REQUIRE(metapp::callableInvoke(overloaded, nullptr, std::string("a"), std::string("b")).get<const std::string &>() == "ab");
+	metapp::Profiler::disable();
+
+	const std::vector<metapp::ProfileRecord> recordList = metapp::Profiler::getRecordList();
+	const metapp::ProfileRecord * record = findRecord(recordList, overloaded);
+	REQUIRE(record != nullptr);
+	REQUIRE(record->name == "func");
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::invoke).getCount() == 1);
+
+	const metapp::Variant * concat = &overloaded.get<const metapp::OverloadedFunction &>().getCallableList()[1];
+	record = findRecord(recordList, *concat);
+	REQUIRE(record != nullptr);
+	REQUIRE(record->name == "func#1");
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::rank).getCount() == 1);
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::call).getCount() == 1);
+}
+
+TEST_CASE("Profiler, hooks, copied callables and the names from MetaRepo at export")
+{
+	struct LocalClass
+	{
+		static int triple(const int n) {
+			return n * 3;
+		}
+	};
+
+	metapp::MetaRepo metaRepo;
+	metapp::MetaRepo subRepo;
+	subRepo.registerCallable("triple", &LocalClass::triple);
+	metaRepo.registerRepo("sub", &subRepo);
+	// The callable is invoked via a copy, and the repos are not added to the profiler.
+	const metapp::Variant callable = subRepo.getCallable("triple").asCallable();
+
+	metapp::Profiler::enable();
+	metapp::Profiler::reset();
+	REQUIRE(metapp::callableInvoke(callable, nullptr, 2).get<int>() == 6);
+	REQUIRE(metapp::callableInvoke(subRepo.getCallable("triple"), nullptr, 3).get<int>() == 9);
+	metapp::Profiler::disable();
+
+	const std::vector<metapp::ProfileRecord> recordList = metapp::Profiler::getRecordList();
+	const metapp::ProfileRecord * record = findRecord(recordList, subRepo.getCallable("triple").asCallable());
+	REQUIRE(record != nullptr);
+	// The sub repo is named from its parent.
+	REQUIRE(record->name == "sub::triple");
+	REQUIRE(record->getHistogram(metapp::ProfilePhase::invoke).getCount() == 2);
+}
+
+#endif
@@ -0,0 +1,366 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/query.h"
+#include "metapp/utilities/threadpool.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/allmetatypes.h"
+#include "metapp/metarepo.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <memory>
+
+namespace {
+
+enum class QueryColor
+{
+	red,
+	green,
+	blue
+};
+
+struct QueryItem
+{
+	int id;
+	std::string name;
+	double price;
+	unsigned int stock;
+	QueryColor color;
+
+	int getRank() const {
+		return id % 3;
+	}
+};
+
+std::vector<QueryItem> makeQueryItemList()
+{
+	return std::vector<QueryItem> {
+		{ 0, "pen", 1.5, 20, QueryColor::blue },
+		{ 1, "book", 12.0, 5, QueryColor::red },
+		{ 2, "cup", 4.25, 0, QueryColor::green },
+		{ 3, "bag", -2.0, 7, QueryColor::red },
+		{ 4, "apple", 0.5, 100, QueryColor::green },
+		{ 5, "desk", 80.0, 2, QueryColor::blue },
+	};
+}
+
+struct QueryBase
+{
+	virtual ~QueryBase() {}
+
+	int level;
+	std::string tag;
+};
+
+struct QueryNode : virtual QueryBase
+{
+	int weight;
+};
+
+// The virtual base is at a different offset from QueryNode than in a complete QueryNode.
+struct QueryLeaf : QueryNode
+{
+	double extra[4];
+};
+
+QueryNode * initializeQueryNode(QueryNode * node, const int level, const std::string & tag, const int weight)
+{
+	node->level = level;
+	node->tag = tag;
+	node->weight = weight;
+	return node;
+}
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <QueryItem> : metapp::DeclareMetaTypeBase <QueryItem>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<QueryItem>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("id", &QueryItem::id);
+				mc.registerAccessible("name", &QueryItem::name);
+				mc.registerAccessible("price", &QueryItem::price);
+				mc.registerAccessible("stock", &QueryItem::stock);
+				mc.registerAccessible("color", &QueryItem::color);
+				mc.registerAccessible("rank", metapp::createReadOnlyAccessor<int>(&QueryItem::getRank));
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <QueryNode> : metapp::DeclareMetaTypeBase <QueryNode>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<QueryNode>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("level", &QueryBase::level);
+				mc.registerAccessible("tag", &QueryBase::tag);
+				mc.registerAccessible("weight", &QueryNode::weight);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+TEST_CASE("Query, where")
+{
+	std::vector<QueryItem> itemList = makeQueryItemList();
+	const metapp::Variant container = metapp::Variant::reference(itemList);
+
+	REQUIRE(metapp::Query::from<QueryItem>().execute(container) == std::vector<std::size_t> { 0, 1, 2, 3, 4, 5 });
+	REQUIRE(metapp::Query::from<QueryItem>().where("price", metapp::QueryOperator::greater, 1.5).execute(container)
+		== std::vector<std::size_t> { 1, 2, 5 });
+	REQUIRE(metapp::Query::from<QueryItem>().where("price", metapp::QueryOperator::greaterEqual, 1.5).execute(container)
+		== std::vector<std::size_t> { 0, 1, 2, 5 });
+	REQUIRE(metapp::Query::from<QueryItem>().where("price", metapp::QueryOperator::less, 0).execute(container)
+		== std::vector<std::size_t> { 3 });
+	// The value is cast to the property type
+	REQUIRE(metapp::Query::from<QueryItem>().where("id", metapp::QueryOperator::lessEqual, 2.7).execute(container)
+		== std::vector<std::size_t> { 0, 1, 2 });
+	REQUIRE(metapp::Query::from<QueryItem>().where("stock", metapp::QueryOperator::equal, 0).execute(container)
+		== std::vector<std::size_t> { 2 });
+	REQUIRE(metapp::Query::from<QueryItem>().where("name", metapp::QueryOperator::notEqual, "cup").count(container) == 5);
+	REQUIRE(metapp::Query::from<QueryItem>().where("name", metapp::QueryOperator::less, "c").execute(container)
+		== std::vector<std::size_t> { 1, 3, 4 });
+	REQUIRE(metapp::Query::from<QueryItem>().where("color", metapp::QueryOperator::equal, QueryColor::red).execute(container)
+		== std::vector<std::size_t> { 1, 3 });
+	REQUIRE(metapp::Query::from<QueryItem>().where("rank", metapp::QueryOperator::equal, 1).execute(container)
+		== std::vector<std::size_t> { 1, 4 });
+
+	// All conditions must match
+	REQUIRE(metapp::Query::from<QueryItem>()
+		.where("price", metapp::QueryOperator::greater, 1)
+		.where("stock", metapp::QueryOperator::greater, 3)
+		.execute(container)
+		== std::vector<std::size_t> { 0, 1 });
+}
+
+TEST_CASE("Query, orderBy")
+{
+	std::vector<QueryItem> itemList = makeQueryItemList();
+	const metapp::Variant container = metapp::Variant::reference(itemList);
+
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("price").execute(container)
+		== std::vector<std::size_t> { 3, 4, 0, 2, 1, 5 });
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("price", true).execute(container)
+		== std::vector<std::size_t> { 5, 1, 2, 0, 4, 3 });
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("name").execute(container)
+		== std::vector<std::size_t> { 4, 3, 1, 2, 5, 0 });
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("color").orderBy("stock", true).execute(container)
+		== std::vector<std::size_t> { 3, 1, 4, 2, 0, 5 });
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("rank").orderBy("name").execute(container)
+		== std::vector<std::size_t> { 3, 0, 4, 1, 2, 5 });
+	REQUIRE(metapp::Query::from<QueryItem>()
+		.where("stock", metapp::QueryOperator::greater, 4)
+		.orderBy("rank", true)
+		.execute(container)
+		== std::vector<std::size_t> { 1, 4, 0, 3 });
+}
+
+TEST_CASE("Query, orderBy many elements is stable")
+{
+	std::vector<QueryItem> itemList;
+	for(int i = 0; i < 5000; ++i) {
+		itemList.push_back(QueryItem { i, "", (double)((i * 7919) % 101) - 50.0, (unsigned int)(i % 10), QueryColor::red });
+	}
+	const metapp::Variant container = metapp::Variant::reference(itemList);
+
+	const std::vector<std::size_t> indexList = metapp::Query::from<QueryItem>().orderBy("price").orderBy("stock", true).execute(container);
+	REQUIRE(indexList.size() == itemList.size());
+	for(std::size_t i = 1; i < indexList.size(); ++i) {
+		const QueryItem & a = itemList[indexList[i - 1]];
+		const QueryItem & b = itemList[indexList[i]];
+		REQUIRE(a.price <= b.price);
+		if(a.price == b.price) {
+			REQUIRE(a.stock >= b.stock);
+			if(a.stock == b.stock) {
+				REQUIRE(a.id < b.id);
+			}
+		}
+	}
+}
+
+TEST_CASE("Query, group")
+{
+	std::vector<QueryItem> itemList = makeQueryItemList();
+	const metapp::Variant container = metapp::Variant::reference(itemList);
+
+	std::vector<metapp::QueryGroup> groupList = metapp::Query::from<QueryItem>().orderBy("price", true).group(container, "color");
+	REQUIRE(groupList.size() == 3);
+	REQUIRE(groupList[0].key.get<QueryColor>() == QueryColor::red);
+	REQUIRE(groupList[0].indexList == std::vector<std::size_t> { 1, 3 });
+	REQUIRE(groupList[1].key.get<QueryColor>() == QueryColor::green);
+	REQUIRE(groupList[1].indexList == std::vector<std::size_t> { 2, 4 });
+	REQUIRE(groupList[2].key.get<QueryColor>() == QueryColor::blue);
+	REQUIRE(groupList[2].indexList == std::vector<std::size_t> { 5, 0 });
+
+	// The key is a copy
+	groupList = metapp::Query::from<QueryItem>().where("id", metapp::QueryOperator::greater, 3).group(container, "name");
+	itemList[4].name = "changed";
+	REQUIRE(groupList.size() == 2);
+	REQUIRE(groupList[0].key.get<const std::string &>() == "apple");
+	REQUIRE(groupList[1].key.get<const std::string &>() == "desk");
+
+	groupList = metapp::Query::from<QueryItem>().group(container, "rank");
+	REQUIRE(groupList.size() == 3);
+	REQUIRE(groupList[1].key.cast<int>().get<int>() == 1);
+	REQUIRE(groupList[1].indexList == std::vector<std::size_t> { 1, 4 });
+}
+
+TEST_CASE("Query, containers")
+{
+	const std::vector<QueryItem> vectorList = makeQueryItemList();
+	const std::vector<std::size_t> expected { 3, 4, 0, 2, 1, 5 };
+
+	std::deque<QueryItem> dequeList(vectorList.begin(), vectorList.end());
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("price").execute(metapp::Variant::reference(dequeList)) == expected);
+
+	std::list<QueryItem> listList(vectorList.begin(), vectorList.end());
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("price").execute(metapp::Variant::reference(listList)) == expected);
+
+	std::vector<std::unique_ptr<QueryItem> > ownerList;
+	std::vector<QueryItem *> pointerList;
+	for(const QueryItem & item : vectorList) {
+		ownerList.emplace_back(new QueryItem(item));
+		pointerList.push_back(ownerList.back().get());
+	}
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("price").execute(metapp::Variant::reference(pointerList)) == expected);
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("rank").orderBy("name").execute(metapp::Variant::reference(pointerList))
+		== std::vector<std::size_t> { 3, 0, 4, 1, 2, 5 });
+
+	// Copied into the Variant
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("price").execute(vectorList) == expected);
+
+	std::vector<QueryItem> emptyList;
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("price").execute(metapp::Variant::reference(emptyList)).empty());
+}
+
+TEST_CASE("Query, null pointer elements")
+{
+	std::vector<QueryItem> itemList = makeQueryItemList();
+	std::vector<QueryItem *> pointerList {
+		&itemList[0], nullptr, &itemList[1], &itemList[2], &itemList[3], nullptr, &itemList[4], &itemList[5]
+	};
+	const metapp::Variant container = metapp::Variant::reference(pointerList);
+
+	// The null elements don't match any condition, even if the condition matches 0 or an empty string.
+	REQUIRE(metapp::Query::from<QueryItem>().where("price", metapp::QueryOperator::less, 1.0).execute(container)
+		== std::vector<std::size_t> { 4, 6 });
+	REQUIRE(metapp::Query::from<QueryItem>().where("stock", metapp::QueryOperator::equal, 0).execute(container)
+		== std::vector<std::size_t> { 3 });
+	REQUIRE(metapp::Query::from<QueryItem>().where("name", metapp::QueryOperator::less, "b").count(container) == 1);
+	REQUIRE(metapp::Query::from<QueryItem>().where("rank", metapp::QueryOperator::equal, 0).count(container) == 2);
+	// Without conditions all elements are matched.
+	REQUIRE(metapp::Query::from<QueryItem>().count(container) == 8);
+
+	// The null elements are placed first in both orders.
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("price").execute(container)
+		== std::vector<std::size_t> { 1, 5, 4, 6, 0, 3, 2, 7 });
+	REQUIRE(metapp::Query::from<QueryItem>().orderBy("name", true).execute(container)
+		== std::vector<std::size_t> { 1, 5, 0, 7, 3, 2, 4, 6 });
+
+	std::vector<metapp::QueryGroup> groupList = metapp::Query::from<QueryItem>().group(container, "stock");
+	REQUIRE(groupList.size() == 7);
+	REQUIRE(groupList[0].key.isEmpty());
+	REQUIRE(groupList[0].indexList == std::vector<std::size_t> { 1, 5 });
+	REQUIRE(groupList[1].key.get<unsigned int>() == 0);
+	REQUIRE(groupList[1].indexList == std::vector<std::size_t> { 3 });
+}
+
+TEST_CASE("Query, members of a virtual base class")
+{
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerBase<QueryNode, QueryBase>();
+
+	QueryNode node1;
+	QueryLeaf leaf1;
+	QueryNode node2;
+	QueryLeaf leaf2;
+	std::vector<QueryNode *> pointerList {
+		initializeQueryNode(&leaf1, 3, "c", 30),
+		initializeQueryNode(&node1, 1, "a", 10),
+		nullptr,
+		initializeQueryNode(&leaf2, 4, "a", 40),
+		initializeQueryNode(&node2, 2, "b", 20),
+	};
+	const metapp::Variant container = metapp::Variant::reference(pointerList);
+
+	REQUIRE(metapp::Query::from<QueryNode>().orderBy("level").execute(container)
+		== std::vector<std::size_t> { 2, 1, 4, 0, 3 });
+	REQUIRE(metapp::Query::from<QueryNode>().where("tag", metapp::QueryOperator::equal, "a").orderBy("weight", true).execute(container)
+		== std::vector<std::size_t> { 3, 1 });
+	REQUIRE(metapp::Query::from<QueryNode>().where("level", metapp::QueryOperator::greater, 2).count(container) == 2);
+
+	const std::vector<metapp::QueryGroup> groupList = metapp::Query::from<QueryNode>().group(container, "tag");
+	REQUIRE(groupList.size() == 4);
+	REQUIRE(groupList[0].key.isEmpty());
+	REQUIRE(groupList[1].key.get<const std::string &>() == "a");
+	REQUIRE(groupList[1].indexList == std::vector<std::size_t> { 1, 3 });
+	REQUIRE(groupList[3].key.get<const std::string &>() == "c");
+
+	// The objects stored by value have the same layout, the members are read at the offset.
+	std::vector<QueryNode> nodeList(3);
+	initializeQueryNode(&nodeList[0], 5, "x", 1);
+	initializeQueryNode(&nodeList[1], 2, "y", 2);
+	initializeQueryNode(&nodeList[2], 7, "z", 3);
+	REQUIRE(metapp::Query::from<QueryNode>().orderBy("level", true).execute(metapp::Variant::reference(nodeList))
+		== std::vector<std::size_t> { 2, 0, 1 });
+}
+
+TEST_CASE("Query, executor")
+{
+	std::vector<QueryItem> itemList;
+	for(int i = 0; i < 20000; ++i) {
+		itemList.push_back(QueryItem { i, std::to_string(i % 97), (double)(i % 1000), (unsigned int)i, QueryColor::red });
+	}
+	const metapp::Variant container = metapp::Variant::reference(itemList);
+
+	metapp::ThreadPool threadPool(4);
+	metapp::Query query = metapp::Query::from<QueryItem>();
+	query.where("price", metapp::QueryOperator::less, 500).where("rank", metapp::QueryOperator::notEqual, 0).orderBy("name");
+	const std::vector<std::size_t> expected = query.execute(container);
+	query.setExecutor(&threadPool);
+	REQUIRE(query.execute(container) == expected);
+	REQUIRE(expected.size() == query.count(container));
+	for(std::size_t i = 1; i < expected.size(); ++i) {
+		REQUIRE(itemList[expected[i - 1]].name <= itemList[expected[i]].name);
+	}
+}
+
+TEST_CASE("Query, errors")
+{
+	std::vector<QueryItem> itemList = makeQueryItemList();
+	REQUIRE_THROWS(metapp::Query::from<QueryItem>().where("notExist", metapp::QueryOperator::equal, 1));
+	REQUIRE_THROWS(metapp::Query::from<QueryItem>().orderBy("notExist"));
+	REQUIRE_THROWS(metapp::Query::from<int>().orderBy("id"));
+	std::vector<int> intList { 1, 2 };
+	REQUIRE_THROWS(metapp::Query::from<QueryItem>().execute(metapp::Variant::reference(intList)));
+	REQUIRE_THROWS(metapp::Query::from<QueryItem>().execute(5));
+}
+
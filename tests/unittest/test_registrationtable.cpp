@@ -0,0 +1,57 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/registrationtable.h"
+
+#include <algorithm>
+
+namespace {
+
+static_assert(metapp::hashRegistrationName("") == 2166136261u, "");
+static_assert(metapp::hashRegistrationName("a") == 0xe40c292cu, "");
+
+TEST_CASE("RegistrationTable, find entries")
+{
+	metapp::RegistrationEntry fields[] = {
+		{ "width", metapp::hashRegistrationName("width"), 0 },
+		{ "height", metapp::hashRegistrationName("height"), 4 },
+		{ "depth", metapp::hashRegistrationName("depth"), 8 },
+	};
+	std::sort(std::begin(fields), std::end(fields), [](const metapp::RegistrationEntry & a, const metapp::RegistrationEntry & b) {
+		return a.nameHash < b.nameHash;
+	});
+	const metapp::RegistrationEntry callables[] = {
+		{ "draw", metapp::hashRegistrationName("draw"), 2 },
+	};
+	const metapp::RegistrationTable table { fields, 3, callables, 1 };
+
+	REQUIRE(table.findField("height") != nullptr);
+	REQUIRE(table.findField("height")->value == 4);
+	REQUIRE(table.findField("depth")->value == 8);
+	REQUIRE(table.findField("width")->value == 0);
+	REQUIRE(table.findField("draw") == nullptr);
+	REQUIRE(table.findCallable("draw")->value == 2);
+	REQUIRE(table.findCallable("") == nullptr);
+
+	const metapp::RegistrationTable emptyTable { nullptr, 0, nullptr, 0 };
+	REQUIRE(emptyTable.findField("width") == nullptr);
+}
+
+} // namespace
+
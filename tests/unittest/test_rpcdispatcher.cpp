@@ -0,0 +1,245 @@
+// metapp library
+//
+// Copyright (C) 2022 Wang Qi (wqking)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test.h"
+
+#include "metapp/utilities/rpcdispatcher.h"
+#include "metapp/metarepo.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+enum class RpcLevel : short
+{
+	low = 1,
+	high = 9
+};
+
+int rpcAdd(const int a, const long long b)
+{
+	return a + (int)b;
+}
+
+std::string rpcConcat(const std::string & a, const std::string & b, const int count)
+{
+	std::string result;
+	for(int i = 0; i < count; ++i) {
+		result += a + b;
+	}
+	return result;
+}
+
+RpcLevel rpcRaise(const RpcLevel level, const bool raise)
+{
+	return raise ? RpcLevel::high : level;
+}
+
+int rpcCounter = 0;
+
+void rpcIncrease(const int n)
+{
+	rpcCounter += n;
+}
+
+const char * rpcName()
+{
+	return "rpc";
+}
+
+double rpcOverload(const double a)
+{
+	return a * 2;
+}
+
+std::string rpcOverload(const std::string & s)
+{
+	return s + s;
+}
+
+int rpcUnsupported(const std::vector<int> & list)
+{
+	return (int)list.size();
+}
+
+double rpcSum9(char a, short b, int c, long d, long long e, float f, double g, unsigned char h, unsigned int i)
+{
+	return a + b + c + d + e + f + g + h + i;
+}
+
+struct RpcFixture
+{
+	RpcFixture() {
+		metaRepo.registerCallable("add", &rpcAdd);
+		metaRepo.registerCallable("concat", &rpcConcat);
+		metaRepo.registerCallable("raise", &rpcRaise);
+		metaRepo.registerCallable("increase", &rpcIncrease);
+		metaRepo.registerCallable("name", &rpcName);
+		metaRepo.registerCallable("overload", metapp::selectOverload<double (double)>(&rpcOverload));
+		metaRepo.registerCallable("overload", metapp::selectOverload<std::string (const std::string &)>(&rpcOverload));
+		metaRepo.registerCallable("unsupported", &rpcUnsupported);
+		metaRepo.registerCallable("sum9", &rpcSum9);
+	}
+
+	metapp::MetaRepo metaRepo;
+};
+
+TEST_CASE("RpcDispatcher, method ID")
+{
+	RpcFixture fixture;
+	metapp::RpcDispatcher dispatcher(&fixture.metaRepo);
+	REQUIRE(dispatcher.getMethodCount() == 9);
+	REQUIRE(dispatcher.findMethodId("add") == 0);
+	REQUIRE(dispatcher.findMethodId("concat") == 1);
+	REQUIRE(dispatcher.findMethodId("overload") == 5);
+	REQUIRE(dispatcher.findMethodId("overload", 1) == 6);
+	REQUIRE(dispatcher.findMethodId("overload", 2) == metapp::invalidRpcMethodId);
+	REQUIRE(dispatcher.findMethodId("notExist") == metapp::invalidRpcMethodId);
+	REQUIRE(dispatcher.getMethodName(6) == "overload");
+	REQUIRE(dispatcher.isMethodSupported(0));
+	REQUIRE(! dispatcher.isMethodSupported(dispatcher.findMethodId("unsupported")));
+	REQUIRE(dispatcher.getMethod(0).get<int (*)(int, long long)>() == &rpcAdd);
+}
+
+TEST_CASE("RpcDispatcher, fingerprint")
+{
+	RpcFixture fixture;
+	RpcFixture other;
+	REQUIRE(metapp::RpcDispatcher(&fixture.metaRepo).getFingerprint() == metapp::RpcDispatcher(&other.metaRepo).getFingerprint());
+	other.metaRepo.registerCallable("add2", &rpcAdd);
+	REQUIRE(metapp::RpcDispatcher(&fixture.metaRepo).getFingerprint() != metapp::RpcDispatcher(&other.metaRepo).getFingerprint());
+}
+
+TEST_CASE("RpcDispatcher, dispatch")
+{
+	RpcFixture fixture;
+	const metapp::RpcDispatcher dispatcher(&fixture.metaRepo);
+	std::vector<char> request;
+	std::vector<char> response;
+
+	SECTION("arithmetic") {
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("add"), 5, 6LL);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::ok);
+		int result = 0;
+		REQUIRE(metapp::readRpcResponse(response.data(), response.size(), &result) == metapp::ErrorCode::ok);
+		REQUIRE(result == 11);
+	}
+
+	SECTION("string") {
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("concat"), std::string("ab"), "c", 2);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::ok);
+		std::string result;
+		REQUIRE(metapp::readRpcResponse(response.data(), response.size(), &result) == metapp::ErrorCode::ok);
+		REQUIRE(result == "abcabc");
+	}
+
+	SECTION("enum and bool") {
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("raise"), RpcLevel::low, true);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::ok);
+		RpcLevel result = RpcLevel::low;
+		REQUIRE(metapp::readRpcResponse(response.data(), response.size(), &result) == metapp::ErrorCode::ok);
+		REQUIRE(result == RpcLevel::high);
+	}
+
+	SECTION("void") {
+		rpcCounter = 1;
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("increase"), 3);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::ok);
+		REQUIRE(response.size() == 1);
+		REQUIRE(metapp::readRpcResponse(response.data(), response.size()) == metapp::ErrorCode::ok);
+		REQUIRE(rpcCounter == 4);
+	}
+
+	SECTION("const char * result") {
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("name"));
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::ok);
+		std::string result;
+		REQUIRE(metapp::readRpcResponse(response.data(), response.size(), &result) == metapp::ErrorCode::ok);
+		REQUIRE(result == "rpc");
+	}
+
+	SECTION("overloads have their own IDs") {
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("overload", 1), std::string("xy"));
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::ok);
+		std::string result;
+		REQUIRE(metapp::readRpcResponse(response.data(), response.size(), &result) == metapp::ErrorCode::ok);
+		REQUIRE(result == "xyxy");
+	}
+
+	SECTION("more arguments than the fixed frame") {
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("sum9"),
+			(char)1, (short)2, 3, 4L, 5LL, 6.0f, 7.0, (unsigned char)8, 9u);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::ok);
+		double result = 0;
+		REQUIRE(metapp::readRpcResponse(response.data(), response.size(), &result) == metapp::ErrorCode::ok);
+		REQUIRE(result == 45.0);
+	}
+
+	SECTION("several requests in one response buffer") {
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("add"), 1, 2LL);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::ok);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::ok);
+		REQUIRE(response.size() == (1 + sizeof(int)) * 2);
+		int result = 0;
+		REQUIRE(metapp::readRpcResponse(response.data() + 1 + sizeof(int), 1 + sizeof(int), &result) == metapp::ErrorCode::ok);
+		REQUIRE(result == 3);
+	}
+}
+
+TEST_CASE("RpcDispatcher, errors")
+{
+	RpcFixture fixture;
+	const metapp::RpcDispatcher dispatcher(&fixture.metaRepo);
+	std::vector<char> request;
+	std::vector<char> response;
+	int result = 0;
+
+	SECTION("unknown method") {
+		metapp::writeRpcRequest(request, 100u, 1);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::outOfRange);
+		REQUIRE(metapp::readRpcResponse(response.data(), response.size(), &result) == metapp::ErrorCode::outOfRange);
+	}
+
+	SECTION("unsupported signature") {
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("unsupported"), 1);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::unsupported);
+	}
+
+	SECTION("truncated arguments") {
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("concat"), std::string("abc"), std::string("d"), 1);
+		request.resize(request.size() - 6);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::illegalArgument);
+		REQUIRE(response.size() == 1);
+	}
+
+	SECTION("extra bytes") {
+		metapp::writeRpcRequest(request, dispatcher.findMethodId("add"), 1, 2LL, 3);
+		REQUIRE(dispatcher.dispatch(request.data(), request.size(), response) == metapp::ErrorCode::illegalArgument);
+	}
+
+	SECTION("empty request") {
+		REQUIRE(dispatcher.dispatch(request.data(), 0, response) == metapp::ErrorCode::illegalArgument);
+	}
+
+	SECTION("truncated response") {
+		REQUIRE(metapp::readRpcResponse(response.data(), 0, &result) == metapp::ErrorCode::illegalArgument);
+	}
+}
+
+
+} // namespace
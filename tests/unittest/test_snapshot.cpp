@@ -0,0 +1,431 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/snapshot.h"
+#include "metapp/interfaces/metaclass.h"
+#include "metapp/metarepo.h"
+#include "metapp/interfaces/metaaccessible.h"
+#include "metapp/interfaces/metaindexable.h"
+#include "metapp/interfaces/metamappable.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <cstring>
+#include <cstdio>
+
+namespace {
+
+enum class SnapshotLevel : short
+{
+	low = 1,
+	high = 9
+};
+
+struct SnapshotEndpoint
+{
+	std::string host;
+	unsigned short port;
+};
+
+struct SnapshotBase
+{
+	int version;
+};
+
+struct SnapshotConfig : SnapshotBase
+{
+	std::string name;
+	const char * label;
+	double ratio;
+	bool enabled;
+	SnapshotLevel level;
+	std::vector<int> idList;
+	std::list<std::string> tagList;
+	std::vector<SnapshotEndpoint> endpointList;
+	std::vector<std::vector<float> > matrix;
+	SnapshotEndpoint primary;
+	long long sizeList[3];
+};
+
+struct SnapshotTree
+{
+	int value;
+	std::vector<SnapshotTree> children;
+};
+
+struct SnapshotUnsupported
+{
+	std::map<int, int> table;
+};
+
+metapp::MetaRepo snapshotMetaRepo;
+
+SnapshotConfig makeSnapshotConfig()
+{
+	SnapshotConfig config;
+	config.version = 3;
+	config.name = "service";
+	config.label = "main";
+	config.ratio = 0.75;
+	config.enabled = true;
+	config.level = SnapshotLevel::high;
+	config.idList = { 5, 8, 13 };
+	config.tagList = { "a", "bb", "a long tag which is not in the short string buffer" };
+	config.endpointList = { { "localhost", 80 }, { "example.com", 8080 } };
+	config.matrix = { { 1.0f, 2.0f }, {}, { 3.5f } };
+	config.primary = { "primary", 443 };
+	config.sizeList[0] = 1;
+	config.sizeList[1] = -2;
+	config.sizeList[2] = 1LL << 40;
+	return config;
+}
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <SnapshotEndpoint> : metapp::DeclareMetaTypeBase <SnapshotEndpoint>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<SnapshotEndpoint>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("host", &SnapshotEndpoint::host);
+				mc.registerAccessible("port", &SnapshotEndpoint::port);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <SnapshotBase> : metapp::DeclareMetaTypeBase <SnapshotBase>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<SnapshotBase>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("version", &SnapshotBase::version);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <SnapshotConfig> : metapp::DeclareMetaTypeBase <SnapshotConfig>
+{
+	static void setup()
+	{
+		snapshotMetaRepo.registerBase<SnapshotConfig, SnapshotBase>();
+	}
+
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<SnapshotConfig>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("name", &SnapshotConfig::name);
+				mc.registerAccessible("label", &SnapshotConfig::label);
+				mc.registerAccessible("ratio", &SnapshotConfig::ratio);
+				mc.registerAccessible("enabled", &SnapshotConfig::enabled);
+				mc.registerAccessible("level", &SnapshotConfig::level);
+				mc.registerAccessible("idList", &SnapshotConfig::idList);
+				mc.registerAccessible("tagList", &SnapshotConfig::tagList);
+				mc.registerAccessible("endpointList", &SnapshotConfig::endpointList);
+				mc.registerAccessible("matrix", &SnapshotConfig::matrix);
+				mc.registerAccessible("primary", &SnapshotConfig::primary);
+				mc.registerAccessible("sizeList", &SnapshotConfig::sizeList);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <SnapshotTree> : metapp::DeclareMetaTypeBase <SnapshotTree>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<SnapshotTree>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("value", &SnapshotTree::value);
+				mc.registerAccessible("children", &SnapshotTree::children);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <SnapshotUnsupported> : metapp::DeclareMetaTypeBase <SnapshotUnsupported>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<SnapshotUnsupported>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("table", &SnapshotUnsupported::table);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+void checkSnapshotConfig(const metapp::Snapshot & snapshot)
+{
+	REQUIRE(snapshot.isValid());
+	REQUIRE(snapshot.matches<SnapshotConfig>());
+	REQUIRE(! snapshot.matches<SnapshotEndpoint>());
+
+	const metapp::Variant root = snapshot.getRoot();
+	REQUIRE(root.getMetaType()->equal(metapp::getMetaType<metapp::SnapshotObject>()));
+	const metapp::SnapshotObject config = root.get<const metapp::SnapshotObject &>();
+	REQUIRE(config.getFieldCount() == 12);
+	REQUIRE(config.hasField("version"));
+	REQUIRE(! config.hasField("notExist"));
+	REQUIRE(config.get("notExist").isEmpty());
+
+	REQUIRE(config.get("version").get<int>() == 3);
+	REQUIRE(config.get("name").cast<std::string>().get<const std::string &>() == "service");
+	REQUIRE(std::string(config.get("label").get<const char *>()) == "main");
+	REQUIRE(config.get("ratio").get<double>() == 0.75);
+	REQUIRE(config.get("enabled").get<bool>());
+	REQUIRE(config.get("level").get<short>() == 9);
+	// The values are read only references into the image.
+	REQUIRE(config.get("ratio").getMetaType()->isReference());
+	REQUIRE(! metapp::isMutable(config.get("ratio")));
+
+	const metapp::SnapshotArray idList = config.get("idList").get<const metapp::SnapshotArray &>();
+	REQUIRE(idList.getSize() == 3);
+	REQUIRE(idList.getElementMetaType()->equal(metapp::getMetaType<int>()));
+	const int * idData = static_cast<const int *>(idList.getData());
+	REQUIRE(idData[0] == 5);
+	REQUIRE(idData[2] == 13);
+	REQUIRE(idList.get(1).get<int>() == 8);
+
+	const metapp::SnapshotArray tagList = config.get("tagList").get<const metapp::SnapshotArray &>();
+	REQUIRE(tagList.getSize() == 3);
+	REQUIRE(tagList.getData() == nullptr);
+	REQUIRE(tagList.get(2).cast<std::string>().get<const std::string &>() == "a long tag which is not in the short string buffer");
+
+	const metapp::SnapshotArray endpointList = config.get("endpointList").get<const metapp::SnapshotArray &>();
+	REQUIRE(endpointList.getSize() == 2);
+	const metapp::SnapshotObject endpoint = endpointList.get(1).get<const metapp::SnapshotObject &>();
+	REQUIRE(std::string(endpoint.get("host").get<const char *>()) == "example.com");
+	REQUIRE(endpoint.get("port").get<unsigned short>() == 8080);
+
+	const metapp::SnapshotArray matrix = config.get("matrix").get<const metapp::SnapshotArray &>();
+	REQUIRE(matrix.getSize() == 3);
+	REQUIRE(matrix.get(0).get<const metapp::SnapshotArray &>().get(1).get<float>() == 2.0f);
+	REQUIRE(matrix.get(1).get<const metapp::SnapshotArray &>().getSize() == 0);
+	REQUIRE(matrix.get(2).get<const metapp::SnapshotArray &>().get(0).get<float>() == 3.5f);
+
+	REQUIRE(config.get("primary").get<const metapp::SnapshotObject &>().get("port").get<unsigned short>() == 443);
+
+	const metapp::SnapshotArray sizeList = config.get("sizeList").get<const metapp::SnapshotArray &>();
+	REQUIRE(sizeList.getSize() == 3);
+	REQUIRE(sizeList.get(1).get<long long>() == -2);
+	REQUIRE(sizeList.get(2).get<long long>() == (1LL << 40));
+}
+
+} // namespace
+
+TEST_CASE("Snapshot, memory")
+{
+	const SnapshotConfig config = makeSnapshotConfig();
+	const std::vector<char> image = metapp::createSnapshot(metapp::Variant::reference(config));
+	checkSnapshotConfig(metapp::Snapshot::fromMemory(image.data(), image.size()));
+
+	// A pointer to the root object
+	REQUIRE(metapp::createSnapshot(&config) == image);
+}
+
+TEST_CASE("Snapshot, the image is position independent")
+{
+	const SnapshotConfig config = makeSnapshotConfig();
+	std::vector<char> image = metapp::createSnapshot(metapp::Variant::reference(config));
+	std::vector<long long> buffer(image.size() / sizeof(long long) + 1);
+	std::memcpy(buffer.data(), image.data(), image.size());
+	image.clear();
+	image.shrink_to_fit();
+	checkSnapshotConfig(metapp::Snapshot::fromMemory(buffer.data(), buffer.size() * sizeof(long long)));
+}
+
+TEST_CASE("Snapshot, file")
+{
+	const std::string fileName = "metapp_test_snapshot.bin";
+	const SnapshotConfig config = makeSnapshotConfig();
+	metapp::writeSnapshotFile(fileName, metapp::Variant::reference(config));
+	{
+		metapp::Snapshot snapshot = metapp::Snapshot::fromFile(fileName);
+		checkSnapshotConfig(snapshot);
+
+		metapp::Snapshot moved(std::move(snapshot));
+		REQUIRE(! snapshot.isValid());
+		checkSnapshotConfig(moved);
+	}
+	std::remove(fileName.c_str());
+
+	REQUIRE_THROWS(metapp::Snapshot::fromFile("metapp_test_snapshot_not_exist.bin"));
+}
+
+TEST_CASE("Snapshot, MetaIndexable and MetaMappable")
+{
+	const SnapshotConfig config = makeSnapshotConfig();
+	const std::vector<char> image = metapp::createSnapshot(metapp::Variant::reference(config));
+	const metapp::Snapshot snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	const metapp::Variant root = snapshot.getRoot();
+
+	REQUIRE(metapp::mappableGet(root, "ratio").get<double>() == 0.75);
+	std::vector<std::string> nameList;
+	metapp::mappableForEach(root, [&nameList](const metapp::Variant & key, const metapp::Variant & /*value*/) {
+		nameList.push_back(key.get<const std::string &>());
+		return true;
+	});
+	REQUIRE(nameList.size() == 12);
+	REQUIRE(nameList[0] == "name");
+	REQUIRE(nameList[10] == "sizeList");
+	// The accessibles in the base class
+	REQUIRE(nameList[11] == "version");
+	REQUIRE_THROWS(metapp::mappableSet(root, "ratio", 1.0));
+
+	const metapp::Variant idList = metapp::mappableGet(root, "idList");
+	REQUIRE(metapp::indexableGetSizeInfo(idList).getSize() == 3);
+	REQUIRE(! metapp::indexableGetSizeInfo(idList).isResizable());
+	REQUIRE(metapp::indexableGet(idList, 2).get<int>() == 13);
+	REQUIRE(metapp::indexableGetData(idList) != nullptr);
+	REQUIRE(metapp::getNonReferenceMetaType(idList)->getMetaIndexable()->getValueType(idList, 0)->equal(metapp::getMetaType<int>()));
+	REQUIRE_THROWS(metapp::indexableSet(idList, 0, 1));
+}
+
+TEST_CASE("Snapshot, recursive types")
+{
+	SnapshotTree tree { 1, { { 2, {} }, { 3, { { 4, {} } } } } };
+	const std::vector<char> image = metapp::createSnapshot(metapp::Variant::reference(tree));
+	const metapp::Snapshot snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	REQUIRE(snapshot.matches<SnapshotTree>());
+	REQUIRE(snapshot.getSchemaCount() == 3);
+	const metapp::SnapshotObject root = snapshot.getRoot().get<const metapp::SnapshotObject &>();
+	REQUIRE(root.get("value").get<int>() == 1);
+	const metapp::SnapshotArray children = root.get("children").get<const metapp::SnapshotArray &>();
+	REQUIRE(children.getSize() == 2);
+	const metapp::SnapshotObject child = children.get(1).get<const metapp::SnapshotObject &>();
+	REQUIRE(child.get("value").get<int>() == 3);
+	REQUIRE(child.get("children").get<const metapp::SnapshotArray &>().get(0).get<const metapp::SnapshotObject &>().get("value").get<int>() == 4);
+}
+
+TEST_CASE("Snapshot, arithmetic and string roots")
+{
+	std::vector<double> numberList { 1.5, 2.5 };
+	std::vector<char> image = metapp::createSnapshot(metapp::Variant::reference(numberList));
+	metapp::Snapshot snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	REQUIRE(snapshot.matches<std::vector<double> >());
+	REQUIRE(snapshot.getRoot().get<const metapp::SnapshotArray &>().get(1).get<double>() == 2.5);
+
+	image = metapp::createSnapshot(std::string("abc"));
+	snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	REQUIRE(std::string(snapshot.getRoot().get<const char *>()) == "abc");
+
+	image = metapp::createSnapshot(38);
+	snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	REQUIRE(snapshot.getRoot().get<int>() == 38);
+}
+
+TEST_CASE("Snapshot, fingerprint")
+{
+	REQUIRE(metapp::getSnapshotFingerprint(metapp::getMetaType<SnapshotConfig>())
+		== metapp::getSnapshotFingerprint(metapp::getMetaType<SnapshotConfig>()));
+	REQUIRE(metapp::getSnapshotFingerprint(metapp::getMetaType<SnapshotConfig>())
+		!= metapp::getSnapshotFingerprint(metapp::getMetaType<SnapshotEndpoint>()));
+	REQUIRE(metapp::getSnapshotFingerprint(metapp::getMetaType<std::vector<int> >())
+		== metapp::getSnapshotFingerprint(metapp::getMetaType<std::list<int> >()));
+	REQUIRE(metapp::getSnapshotFingerprint(metapp::getMetaType<std::vector<int> >())
+		!= metapp::getSnapshotFingerprint(metapp::getMetaType<std::vector<unsigned int> >()));
+}
+
+TEST_CASE("Snapshot, errors")
+{
+	REQUIRE_THROWS(metapp::createSnapshot(SnapshotUnsupported()));
+	REQUIRE_THROWS(metapp::createSnapshot(std::map<int, int>()));
+	REQUIRE_THROWS(metapp::createSnapshot((SnapshotConfig *)nullptr));
+
+	const std::vector<char> image = metapp::createSnapshot(metapp::Variant::reference(makeSnapshotConfig()));
+	REQUIRE_THROWS(metapp::Snapshot::fromMemory(image.data(), 10));
+	std::vector<char> broken(image);
+	broken[0] = 'x';
+	REQUIRE_THROWS(metapp::Snapshot::fromMemory(broken.data(), broken.size()));
+
+	metapp::Snapshot snapshot;
+	REQUIRE(! snapshot.isValid());
+	REQUIRE(snapshot.getRoot().isEmpty());
+	REQUIRE(! snapshot.matches<SnapshotConfig>());
+}
+
+
+TEST_CASE("Snapshot, index out of range")
+{
+	const SnapshotConfig config = makeSnapshotConfig();
+	const std::vector<char> image = metapp::createSnapshot(metapp::Variant::reference(config));
+	const metapp::Snapshot snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	const metapp::SnapshotObject root = snapshot.getRoot().get<const metapp::SnapshotObject &>();
+	REQUIRE_THROWS_AS(root.get(root.getFieldCount()), metapp::OutOfRangeException);
+	REQUIRE_THROWS_AS(root.getFieldName(root.getFieldCount()), metapp::OutOfRangeException);
+	REQUIRE_THROWS_AS(snapshot.getSchemaFingerprint(snapshot.getSchemaCount()), metapp::OutOfRangeException);
+
+	const metapp::Variant idList = root.get("idList");
+	REQUIRE_THROWS_AS(idList.get<const metapp::SnapshotArray &>().get(3), metapp::OutOfRangeException);
+	REQUIRE_THROWS_AS(metapp::indexableGet(idList, 3), metapp::OutOfRangeException);
+	REQUIRE_THROWS_AS(metapp::SnapshotArray().get(0), metapp::OutOfRangeException);
+}
+
+TEST_CASE("Snapshot, corrupt references")
+{
+	// The root is a reference to the string or the array, rootOffset is at byte 24 in the header.
+	auto corruptRootReference = [](std::vector<char> & image, const std::int64_t offset, const std::uint64_t size) {
+		std::uint64_t rootOffset = 0;
+		std::memcpy(&rootOffset, image.data() + 24, sizeof(rootOffset));
+		std::memcpy(image.data() + rootOffset, &offset, sizeof(offset));
+		std::memcpy(image.data() + rootOffset + sizeof(offset), &size, sizeof(size));
+	};
+
+	std::vector<char> image = metapp::createSnapshot(std::string("abc"));
+	corruptRootReference(image, 1LL << 40, 3);
+	// The schemas are valid, the reference is checked when it's read.
+	metapp::Snapshot snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	REQUIRE_THROWS_AS(snapshot.getRoot(), metapp::IllegalArgumentException);
+
+	image = metapp::createSnapshot(std::string("abc"));
+	corruptRootReference(image, 16, 1ULL << 62);
+	snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	REQUIRE_THROWS_AS(snapshot.getRoot(), metapp::IllegalArgumentException);
+
+	std::vector<int> numberList { 1, 2, 3 };
+	image = metapp::createSnapshot(metapp::Variant::reference(numberList));
+	corruptRootReference(image, -(1LL << 40), 3);
+	snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	REQUIRE_THROWS_AS(snapshot.getRoot(), metapp::IllegalArgumentException);
+
+	image = metapp::createSnapshot(metapp::Variant::reference(numberList));
+	corruptRootReference(image, 16, (std::uint64_t)image.size());
+	snapshot = metapp::Snapshot::fromMemory(image.data(), image.size());
+	REQUIRE_THROWS_AS(snapshot.getRoot(), metapp::IllegalArgumentException);
+}
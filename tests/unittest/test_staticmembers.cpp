@@ -0,0 +1,258 @@
+// metapp library
+// 
+// Copyright (C) 2022 Wang Qi (wqking)
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//   http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "test.h"
+
+#include "metapp/utilities/staticmembers.h"
+#include "metapp/allmetatypes.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace {
+
+struct StaticPoint
+{
+	int x;
+	std::string name;
+	const double weight;
+};
+
+struct DynamicPoint
+{
+	int x;
+	std::string name;
+};
+
+struct StaticDerivedPoint : StaticPoint
+{
+	StaticDerivedPoint(const int x, const std::string & name, const int y)
+		: StaticPoint { x, name, 0.0 }, y(y)
+	{
+	}
+
+	int y;
+};
+
+struct DynamicDerivedPoint : DynamicPoint
+{
+	int y;
+};
+
+} // namespace
+
+template <>
+struct metapp::DeclareMetaType <StaticPoint> : metapp::DeclareMetaTypeBase <StaticPoint>
+{
+	static constexpr metapp::StaticMemberList<
+		metapp::StaticMember<StaticPoint, int>,
+		metapp::StaticMember<StaticPoint, std::string>,
+		metapp::StaticMember<StaticPoint, const double>
+	> getStaticMembers() {
+		return metapp::makeStaticMemberList(
+			metapp::staticMember("x", &StaticPoint::x),
+			metapp::staticMember("name", &StaticPoint::name),
+			metapp::staticMember("weight", &StaticPoint::weight)
+		);
+	}
+
+	static const metapp::MetaClass * getMetaClass() {
+		return metapp::getMetaClassFromStaticMembers<StaticPoint>();
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <DynamicPoint> : metapp::DeclareMetaTypeBase <DynamicPoint>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<DynamicPoint>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("x", &DynamicPoint::x);
+				mc.registerAccessible("name", &DynamicPoint::name);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <StaticDerivedPoint> : metapp::DeclareMetaTypeBase <StaticDerivedPoint>
+{
+	static constexpr metapp::StaticMemberList<
+		metapp::StaticMember<StaticDerivedPoint, int>
+	> getStaticMembers() {
+		return metapp::makeStaticMemberList(
+			metapp::staticMember("y", &StaticDerivedPoint::y)
+		);
+	}
+
+	static const metapp::MetaClass * getMetaClass() {
+		return metapp::getMetaClassFromStaticMembers<StaticDerivedPoint>();
+	}
+};
+
+template <>
+struct metapp::DeclareMetaType <DynamicDerivedPoint> : metapp::DeclareMetaTypeBase <DynamicDerivedPoint>
+{
+	static const metapp::MetaClass * getMetaClass() {
+		static const metapp::MetaClass metaClass(
+			metapp::getMetaType<DynamicDerivedPoint>(),
+			[](metapp::MetaClass & mc) {
+				mc.registerAccessible("y", &DynamicDerivedPoint::y);
+			}
+		);
+		return &metaClass;
+	}
+};
+
+namespace {
+
+static_assert(metapp::HasStaticMembers<StaticPoint>::value, "");
+static_assert(metapp::HasStaticMembers<const StaticPoint>::value, "");
+static_assert(! metapp::HasStaticMembers<DynamicPoint>::value, "");
+static_assert(! metapp::HasStaticMembers<int>::value, "");
+static_assert(metapp::getStaticMembers<StaticPoint>().getSize() == 3, "");
+static_assert(metapp::getStaticMembers<StaticPoint>().getFirst().pointer == &StaticPoint::x, "");
+
+// Collects the members in both the static and the dynamic form.
+struct MemberCollector
+{
+	std::map<std::string, std::string> * valueMap;
+
+	void operator() (const char * name, int & value) const {
+		(*valueMap)[name] = std::to_string(value);
+		value += 1;
+	}
+
+	void operator() (const char * name, const int & value) const {
+		(*valueMap)[name] = std::to_string(value);
+	}
+
+	void operator() (const char * name, const std::string & value) const {
+		(*valueMap)[name] = value;
+	}
+
+	void operator() (const char * name, const double & value) const {
+		(*valueMap)[name] = std::to_string((int)value);
+	}
+
+	void operator() (const char * name, const metapp::Variant & value) const {
+		if(metapp::getNonReferenceMetaType(value)->isArithmetic()) {
+			(*valueMap)[name] = std::to_string(value.cast<int>().get<int>());
+		}
+		else {
+			(*valueMap)[name] = value.get<const std::string &>();
+		}
+	}
+};
+
+TEST_CASE("StaticMembers, forEachStaticMember")
+{
+	StaticPoint point { 5, "abc", 3.0 };
+	std::map<std::string, std::string> valueMap;
+	metapp::forEachStaticMember(point, MemberCollector { &valueMap });
+	REQUIRE(valueMap.size() == 3);
+	REQUIRE(valueMap["x"] == "5");
+	REQUIRE(valueMap["name"] == "abc");
+	REQUIRE(valueMap["weight"] == "3");
+	// The member is accessed by reference
+	REQUIRE(point.x == 6);
+
+	const StaticPoint & constPoint = point;
+	metapp::forEachStaticMember(constPoint, MemberCollector { &valueMap });
+	REQUIRE(valueMap["x"] == "6");
+	REQUIRE(point.x == 6);
+}
+
+TEST_CASE("StaticMembers, forEachMember picks static or dynamic path")
+{
+	std::map<std::string, std::string> valueMap;
+
+	StaticPoint staticPoint { 1, "static", 2.0 };
+	metapp::forEachMember(staticPoint, MemberCollector { &valueMap });
+	REQUIRE(valueMap.size() == 3);
+	REQUIRE(valueMap["name"] == "static");
+	REQUIRE(staticPoint.x == 2);
+
+	valueMap.clear();
+	DynamicPoint dynamicPoint { 8, "dynamic" };
+	metapp::forEachMember(dynamicPoint, MemberCollector { &valueMap });
+	REQUIRE(valueMap.size() == 2);
+	REQUIRE(valueMap["x"] == "8");
+	REQUIRE(valueMap["name"] == "dynamic");
+}
+
+// Collects the member names in the visiting order.
+struct MemberNameCollector
+{
+	std::vector<std::string> * nameList;
+
+	template <typename T>
+	void operator() (const char * name, T && /*value*/) const {
+		nameList->push_back(name);
+	}
+};
+
+TEST_CASE("StaticMembers, forEachMember visits the base classes in both paths")
+{
+	metapp::MetaRepo metaRepo;
+	metaRepo.registerBase<StaticDerivedPoint, StaticPoint>();
+	metaRepo.registerBase<DynamicDerivedPoint, DynamicPoint>();
+
+	StaticDerivedPoint staticPoint(1, "static", 2);
+	std::vector<std::string> staticNameList;
+	metapp::forEachMember(staticPoint, MemberNameCollector { &staticNameList });
+	REQUIRE(staticNameList == std::vector<std::string> { "y", "x", "name", "weight" });
+
+	std::map<std::string, std::string> valueMap;
+	metapp::forEachMember(staticPoint, MemberCollector { &valueMap });
+	REQUIRE(valueMap["y"] == "2");
+	REQUIRE(valueMap["x"] == "1");
+	REQUIRE(valueMap["name"] == "static");
+	// forEachStaticMember visits only the static members of the class itself.
+	staticNameList.clear();
+	metapp::forEachStaticMember(staticPoint, MemberNameCollector { &staticNameList });
+	REQUIRE(staticNameList == std::vector<std::string> { "y" });
+
+	DynamicDerivedPoint dynamicPoint;
+	dynamicPoint.x = 3;
+	dynamicPoint.name = "dynamic";
+	dynamicPoint.y = 4;
+	std::vector<std::string> dynamicNameList;
+	metapp::forEachMember(dynamicPoint, MemberNameCollector { &dynamicNameList });
+	REQUIRE(dynamicNameList == std::vector<std::string> { "y", "x", "name" });
+}
+
+TEST_CASE("StaticMembers, MetaClass is generated from static members")
+{
+	const metapp::MetaClass * metaClass = metapp::getMetaType<StaticPoint>()->getMetaClass();
+	REQUIRE(metaClass != nullptr);
+	REQUIRE(metaClass->getAccessibleView().size() == 3);
+
+	StaticPoint point { 5, "abc", 3.0 };
+	const metapp::MetaItem & x = metaClass->getAccessible("x");
+	REQUIRE(metapp::accessibleGet(x, &point).get<int>() == 5);
+	metapp::accessibleSet(x, &point, 9);
+	REQUIRE(point.x == 9);
+	REQUIRE(metapp::accessibleGet(metaClass->getAccessible("name"), &point).get<const std::string &>() == "abc");
+	REQUIRE(metapp::accessibleIsReadOnly(metaClass->getAccessible("weight")));
+}
+
+} // namespace
+
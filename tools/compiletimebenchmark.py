@@ -0,0 +1,319 @@
+# metapp library
+
+# Copyright (C) 2022 Wang Qi (wqking)
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#   http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Measures the compile time and the object size of the metapp template instantiations.
+# For each construct, a translation unit instantiates the construct for COUNT synthetic classes,
+# the cost per instance is the difference to a baseline translation unit with the same classes
+# and headers but no instantiation, divided by COUNT.
+# See doc/benchmark.md for the details.
+#
+# Usage:
+#   python3 compiletimebenchmark.py [--compiler CXX] [--flags FLAGS] [--count COUNT] [--repeat REPEAT]
+#       [--construct NAME]... [--save FILE] [--compare FILE [--tolerance PERCENT]]
+#
+# The compiler must accept GCC style command line (-c, -o, -I). The section sizes are read using `size -A`,
+# they are not reported if `size` is not available or the object format is not recognized.
+
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+import time
+
+commonIncludeList = [ '<map>', '<string>', '<vector>' ]
+
+# Each construct has the code inside namespace metapp (specializations) and the expression to instantiate it.
+# {0} is replaced with the class name.
+constructList = [
+	{
+		'name' : 'getMetaType',
+		'description' : 'getMetaType<T>() of a class without DeclareMetaType',
+		'declaration' : '',
+		'expression' : 'metapp::getMetaType<{0}>()',
+	},
+	{
+		'name' : 'metaClass',
+		'description' : 'DeclareMetaType with getMetaClass, 2 accessibles and 1 callable',
+		'declaration' : '''template <>
+struct DeclareMetaType<{0}> : DeclareMetaTypeBase<{0}>
+{{
+	static const MetaClass * getMetaClass() {{
+		static const MetaClass metaClass(
+			getMetaType<{0}>(),
+			[](MetaClass & mc) {{
+				mc.registerAccessible("value", &{0}::value);
+				mc.registerAccessible("other", &{0}::other);
+				mc.registerCallable("method", &{0}::method);
+			}}
+		);
+		return &metaClass;
+	}}
+}};
+''',
+		'expression' : 'metapp::getMetaType<{0}>()',
+	},
+	{
+		'name' : 'castToTypes',
+		'description' : 'DeclareMetaType inheriting CastToTypes<T, TypeList<int, double, std::string> >',
+		'declaration' : '''template <>
+struct DeclareMetaType<{0}> : CastToTypes<{0}, TypeList<int, double, std::string> >
+{{
+}};
+''',
+		'expression' : 'metapp::getMetaType<{0}>()',
+	},
+	{
+		'name' : 'function',
+		'description' : 'free function int (T &, int, const std::string &), MetaCallableBase',
+		'declaration' : '',
+		'expression' : 'metapp::getMetaType<decltype(&function{0})>()',
+	},
+	{
+		'name' : 'memberFunction',
+		'description' : 'member function int (T::*)(int, double), MetaCallableBase',
+		'declaration' : '',
+		'expression' : 'metapp::getMetaType<decltype(&{0}::method)>()',
+	},
+	{
+		'name' : 'memberData',
+		'description' : 'member data int T::*, MetaAccessible',
+		'declaration' : '',
+		'expression' : 'metapp::getMetaType<decltype(&{0}::value)>()',
+	},
+	{
+		'name' : 'vector',
+		'description' : 'std::vector<T>, MetaIndexable and MetaIterable',
+		'declaration' : '',
+		'expression' : 'metapp::getMetaType<std::vector<{0}> >()',
+	},
+	{
+		'name' : 'map',
+		'description' : 'std::map<std::string, T>, MetaMappable and MetaIterable',
+		'declaration' : '',
+		'expression' : 'metapp::getMetaType<std::map<std::string, {0}> >()',
+	},
+]
+
+# The headers to measure the cost of including them
+headerList = [ '', 'metapp/variant.h', 'metapp/allmetatypes.h' ]
+
+# The headers included by the construct sources
+constructHeaderList = [ 'metapp/allmetatypes.h', 'metapp/interfaces/metaclass.h' ]
+
+def getClassName(index) :
+	return 'Type%d' % index
+
+def generateClasses(count) :
+	code = []
+	for i in range(count) :
+		className = getClassName(i)
+		code.append('struct %s' % className)
+		code.append('{')
+		code.append('\tint value;')
+		code.append('\tdouble other;')
+		code.append('\tint method(int a, double b) { return value + a + (int)(other * b); }')
+		code.append('\toperator int() const { return value; }')
+		code.append('\toperator double() const { return other; }')
+		code.append('\toperator std::string() const { return std::to_string(value); }')
+		code.append('};')
+		code.append('inline int function%s(%s & obj, int a, const std::string & s) { return obj.value + a + (int)s.size(); }' % (className, className))
+		code.append('')
+	return code
+
+def generateSource(count, construct, metappHeaderList) :
+	code = []
+	for include in commonIncludeList :
+		code.append('#include %s' % include)
+	for header in metappHeaderList :
+		code.append('#include "%s"' % header)
+	code.append('')
+	if construct is None :
+		code.append('int useAll()')
+		code.append('{')
+		code.append('\treturn 0;')
+		code.append('}')
+		return code
+	code.append('#include <cstddef>')
+	code.append('')
+	code.extend(generateClasses(count))
+	if construct['declaration'] != '' :
+		code.append('namespace metapp {')
+		code.append('')
+		for i in range(count) :
+			code.append(construct['declaration'].format(getClassName(i)))
+		code.append('} // namespace metapp')
+		code.append('')
+	# The meta types are returned through an external function so they are not optimized away
+	code.append('void useAll(const metapp::MetaType ** metaTypeList)')
+	code.append('{')
+	code.append('\tstd::size_t index = 0;')
+	if construct['expression'] != '' :
+		for i in range(count) :
+			code.append('\tmetaTypeList[index++] = %s;' % construct['expression'].format(getClassName(i)))
+	code.append('\t(void)index;')
+	code.append('}')
+	return code
+
+def readSectionSizes(objectFileName) :
+	try :
+		output = subprocess.run([ 'size', '-A', objectFileName ], stdout = subprocess.PIPE, stderr = subprocess.DEVNULL, universal_newlines = True).stdout
+	except OSError :
+		return None
+	text = 0
+	rodata = 0
+	found = False
+	for line in output.splitlines() :
+		itemList = line.split()
+		if len(itemList) < 2 or not itemList[1].isdigit() :
+			continue
+		if itemList[0].startswith('.text') :
+			text += int(itemList[1])
+			found = True
+		elif itemList[0].startswith('.rodata') :
+			rodata += int(itemList[1])
+			found = True
+	if not found :
+		return None
+	return { 'text' : text, 'rodata' : rodata }
+
+def compileSource(options, sourceCode, name) :
+	sourceFileName = os.path.join(options.output, name + '.cpp')
+	objectFileName = os.path.join(options.output, name + '.o')
+	with open(sourceFileName, 'w') as file :
+		file.write('\n'.join(sourceCode) + '\n')
+	commandLine = shlex.split(options.compiler) + shlex.split(options.flags) + [
+		'-I', options.include, '-c', sourceFileName, '-o', objectFileName
+	]
+	elapsed = None
+	for _ in range(max(1, options.repeat)) :
+		start = time.perf_counter()
+		result = subprocess.run(commandLine)
+		current = time.perf_counter() - start
+		if result.returncode != 0 :
+			print('Failed to compile %s' % sourceFileName)
+			sys.exit(1)
+		if elapsed is None or current < elapsed :
+			elapsed = current
+	item = {
+		'time' : elapsed * 1000.0,
+		'object' : os.path.getsize(objectFileName),
+	}
+	sections = readSectionSizes(objectFileName)
+	if sections is not None :
+		item.update(sections)
+	return item
+
+def formatValue(item, key, digits) :
+	if key not in item :
+		return '-'
+	return '%.*f' % (digits, item[key])
+
+metricList = [ ('time', 'Time(ms)', 2), ('object', 'Object', 0), ('text', '.text', 0), ('rodata', '.rodata', 0) ]
+
+def printTable(title, rowList) :
+	nameWidth = max([ len(title) ] + [ len(row[0]) for row in rowList ])
+	print('%-*s %12s %12s %12s %12s' % tuple([ nameWidth, title ] + [ metric[1] for metric in metricList ]))
+	for name, item in rowList :
+		print('%-*s %12s %12s %12s %12s' % tuple([ nameWidth, name ] + [ formatValue(item, metric[0], metric[2]) for metric in metricList ]))
+	print('')
+
+def compareResult(previous, current, tolerance) :
+	# Compile time is too noisy to fail on, only the sizes are checked.
+	regressionList = []
+	for name, item in current['constructs'].items() :
+		if name not in previous['constructs'] :
+			continue
+		previousItem = previous['constructs'][name]
+		for key in [ 'object', 'text', 'rodata' ] :
+			if key not in item or key not in previousItem or previousItem[key] <= 0 :
+				continue
+			change = (item[key] - previousItem[key]) * 100.0 / previousItem[key]
+			if change > tolerance :
+				regressionList.append('%s %s: %.0f -> %.0f (+%.1f%%)' % (name, key, previousItem[key], item[key], change))
+	return regressionList
+
+def doMain() :
+	scriptPath = os.path.dirname(os.path.abspath(__file__))
+	parser = argparse.ArgumentParser(description = 'Measure compile time and object size of metapp template instantiations')
+	parser.add_argument('--compiler', default = os.environ.get('CXX', 'c++'), help = 'the C++ compiler, default is $CXX or c++')
+	parser.add_argument('--flags', default = '-std=c++11 -O2', help = 'the compiler flags')
+	parser.add_argument('--include', default = os.path.join(scriptPath, '..', 'include'), help = 'the metapp include directory')
+	parser.add_argument('--output', default = 'compiletimebenchmark', help = 'the directory to write the generated sources and objects')
+	parser.add_argument('--count', type = int, default = 100, help = 'the number of instances of each construct')
+	parser.add_argument('--repeat', type = int, default = 1, help = 'compile each source REPEAT times and use the minimum time')
+	parser.add_argument('--construct', action = 'append', help = 'the construct to measure, can be repeated, default is all')
+	parser.add_argument('--save', help = 'save the result as JSON')
+	parser.add_argument('--compare', help = 'compare the sizes with a result saved by --save, exit with 1 on regression')
+	parser.add_argument('--tolerance', type = float, default = 10.0, help = 'the allowed growth in percent for --compare')
+	options = parser.parse_args()
+
+	selectedList = constructList
+	if options.construct :
+		nameList = [ construct['name'] for construct in constructList ]
+		for name in options.construct :
+			if name not in nameList :
+				print('Unknown construct %s, available: %s' % (name, ', '.join(nameList)))
+				sys.exit(1)
+		selectedList = [ construct for construct in constructList if construct['name'] in options.construct ]
+
+	if not os.path.exists(options.output) :
+		os.makedirs(options.output)
+
+	print('%s %s, %d instances per construct' % (options.compiler, options.flags, options.count))
+	print('')
+
+	headerRowList = []
+	for index, header in enumerate(headerList) :
+		item = compileSource(options, generateSource(0, None, [ header ] if header != '' else []), 'header%d' % index)
+		headerRowList.append((header if header != '' else '(standard headers only)', item))
+	printTable('Header', headerRowList)
+
+	# Same classes and headers as the constructs, without any instantiation
+	baselineConstruct = { 'declaration' : '', 'expression' : '' }
+	baseline = compileSource(options, generateSource(options.count, baselineConstruct, constructHeaderList), 'baseline')
+	constructRowList = []
+	result = { 'count' : options.count, 'compiler' : options.compiler, 'flags' : options.flags, 'constructs' : {} }
+	for construct in selectedList :
+		item = compileSource(options, generateSource(options.count, construct, constructHeaderList), construct['name'])
+		perInstance = {}
+		for key in item :
+			if key in baseline :
+				perInstance[key] = (item[key] - baseline[key]) / float(options.count)
+		constructRowList.append((construct['name'], perInstance))
+		result['constructs'][construct['name']] = perInstance
+	printTable('Per instance', constructRowList)
+
+	for construct in selectedList :
+		print('%-16s %s' % (construct['name'], construct['description']))
+
+	if options.save :
+		with open(options.save, 'w') as file :
+			json.dump(result, file, indent = 4)
+	if options.compare :
+		with open(options.compare, 'r') as file :
+			previous = json.load(file)
+		regressionList = compareResult(previous, result, options.tolerance)
+		print('')
+		if len(regressionList) > 0 :
+			print('Size regressions over %.1f%%:' % options.tolerance)
+			for regression in regressionList :
+				print('  ' + regression)
+			sys.exit(1)
+		print('No size regression over %.1f%%' % options.tolerance)
+
+doMain()
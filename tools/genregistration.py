@@ -0,0 +1,575 @@
+# metapp library
+
+# Copyright (C) 2022 Wang Qi (wqking)
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#   http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Generates the registration code of annotated classes, so the per signature templates
+# (DeclareMetaType of the function types, MetaCallableBase, the invokers) are not instantiated.
+# See doc/offline_registration.md for the annotation syntax and the generated code.
+#
+# Usage:
+#   python3 genregistration.py [--output DIR] [--include-prefix PREFIX] [--no-offsets] header...
+#   python3 genregistration.py --sample COUNT [--output DIR]
+
+import argparse
+import os
+import re
+import sys
+
+annotationReflect = '//metapp:reflect'
+annotationField = '//metapp:field'
+annotationMethod = '//metapp:method'
+
+# The last word of a parameter declaration is not a parameter name if it's one of these
+typeKeywords = {
+	'int', 'char', 'short', 'long', 'signed', 'unsigned', 'float', 'double', 'bool',
+	'void', 'wchar_t', 'char16_t', 'char32_t', 'const', 'volatile', 'auto'
+}
+
+# 32 bit FNV-1a, must be the same as metapp::hashRegistrationName
+def hashName(name) :
+	hash = 2166136261
+	for c in name.encode('utf-8') :
+		hash = ((hash ^ c) * 16777619) & 0xffffffff
+	return hash
+
+def stripComment(line) :
+	stripped = line.strip()
+	if stripped.startswith('//metapp:') :
+		return ''
+	index = line.find('//')
+	if index >= 0 :
+		line = line[: index]
+	return line
+
+def splitParameters(text) :
+	parameterList = []
+	depth = 0
+	current = ''
+	for c in text :
+		if c in '<([{' :
+			depth += 1
+		elif c in '>)]}' :
+			depth -= 1
+		if c == ',' and depth == 0 :
+			parameterList.append(current)
+			current = ''
+		else :
+			current += c
+	if current.strip() != '' :
+		parameterList.append(current)
+	return parameterList
+
+def normalizeType(text) :
+	text = re.sub(r'\s+', ' ', text.strip())
+	text = re.sub(r'\s*([*&])', r' \1', text)
+	return text.strip()
+
+def parseParameterType(text) :
+	depth = 0
+	for i, c in enumerate(text) :
+		if c in '<([{' :
+			depth += 1
+		elif c in '>)]}' :
+			depth -= 1
+		elif c == '=' and depth == 0 :
+			text = text[: i]
+			break
+	text = text.strip()
+	if text == 'void' :
+		return None
+	match = re.match(r'^(.*[\w>*&\s])\b(\w+)$', text)
+	if match :
+		typePart = match.group(1).strip()
+		name = match.group(2)
+		qualifierOnly = all(word in ('const', 'volatile') for word in typePart.split())
+		if name not in typeKeywords and typePart != '' and not qualifierOnly :
+			text = typePart
+	return normalizeType(text)
+
+def parseField(statement, className) :
+	statement = statement.strip().rstrip(';').strip()
+	statement = re.sub(r'\s*(=.*|\{.*\})$', '', statement)
+	match = re.match(r'^(?:mutable\s+)?(.*?[\w>*&\s])\s*\b(\w+)\s*(\[[^\]]*\])?$', statement)
+	if not match :
+		raise Exception('Can not parse field "%s" in class %s' % (statement, className))
+	return {
+		'name' : match.group(2),
+	}
+
+def parseMethod(statement, className) :
+	statement = re.sub(r'\s+', ' ', statement.strip())
+	openIndex = statement.find('(')
+	closeIndex = -1
+	depth = 0
+	for i in range(openIndex, len(statement)) :
+		if statement[i] == '(' :
+			depth += 1
+		elif statement[i] == ')' :
+			depth -= 1
+			if depth == 0 :
+				closeIndex = i
+				break
+	match = re.match(r'^((?:(?:static|virtual|inline|constexpr|explicit)\s+)*)(.+?)\s*\b(\w+)\s*$', statement[: max(openIndex, 0)])
+	if openIndex < 0 or closeIndex < 0 or not match :
+		raise Exception('Can not parse method "%s" in class %s' % (statement, className))
+	specifiers = match.group(1).split()
+	qualifiers = re.split(r'[;{=]', statement[closeIndex + 1 :])[0].split()
+	parameterTypeList = []
+	for parameter in splitParameters(statement[openIndex + 1 : closeIndex]) :
+		parameterType = parseParameterType(parameter)
+		if parameterType is not None :
+			parameterTypeList.append(parameterType)
+	return {
+		'name' : match.group(3),
+		'returnType' : normalizeType(match.group(2)),
+		'parameterTypeList' : parameterTypeList,
+		'isStatic' : 'static' in specifiers,
+		'isConst' : 'const' in qualifiers,
+	}
+
+def countBraces(line) :
+	line = re.sub(r'"(\\.|[^"\\])*"', '""', line)
+	line = re.sub(r"'(\\.|[^'\\])*'", "''", line)
+	return line.count('{') - line.count('}')
+
+# Returns a list of classes, each class is a dict with name, fieldList, and methodList
+def parseHeader(fileName) :
+	with open(fileName, 'r') as file :
+		lineList = file.read().splitlines()
+	classList = []
+	namespaceStack = []
+	depth = 0
+	pendingReflect = False
+	currentClass = None
+	classDepth = 0
+	pendingKind = None
+	statement = ''
+	for line in lineList :
+		stripped = line.strip()
+		if stripped == annotationReflect :
+			pendingReflect = True
+			continue
+		if currentClass is not None and stripped in (annotationField, annotationMethod) :
+			pendingKind = 'field' if stripped == annotationField else 'method'
+			statement = ''
+			continue
+		code = stripComment(line)
+		if pendingKind is not None :
+			statement += ' ' + code
+			if pendingKind == 'field' and ';' in statement :
+				currentClass['fieldList'].append(parseField(statement[: statement.index(';') + 1], currentClass['name']))
+				pendingKind = None
+			elif pendingKind == 'method' and re.search(r'\)[^;{]*[;{]', statement) :
+				currentClass['methodList'].append(parseMethod(statement, currentClass['name']))
+				pendingKind = None
+		namespaceMatch = re.match(r'^\s*namespace\s+([\w:]+)\s*\{', code)
+		if namespaceMatch :
+			namespaceStack.append((namespaceMatch.group(1), depth))
+		if pendingReflect :
+			classMatch = re.match(r'^\s*(?:struct|class)\s+(\w+)', code)
+			if classMatch :
+				namespace = '::'.join([ item[0] for item in namespaceStack ])
+				currentClass = {
+					'name' : (namespace + '::' if namespace != '' else '') + classMatch.group(1),
+					'namespace' : namespace,
+					'fieldList' : [],
+					'methodList' : [],
+				}
+				classList.append(currentClass)
+				classDepth = depth
+				pendingReflect = False
+		depth += countBraces(code)
+		while len(namespaceStack) > 0 and depth <= namespaceStack[-1][1] :
+			namespaceStack.pop()
+		if currentClass is not None and depth <= classDepth and '}' in code :
+			currentClass = None
+	return classList
+
+def makeIdentifier(name) :
+	return re.sub(r'\W', '_', name)
+
+def makeReferenceType(typeName) :
+	if typeName.endswith('&') :
+		return typeName
+	return typeName + ' &'
+
+def makeArgumentList(parameterTypeList) :
+	return ',\n'.join([
+		'\t\targuments[%d].cast<%s>().get<%s>()' % (i, t, makeReferenceType(t)) for i, t in enumerate(parameterTypeList)
+	])
+
+# The thunks, pointers, and tables are generated in an anonymous namespace nested in the namespace of the class,
+# so the type names in the declarations are resolved the same as in the header.
+class Generator :
+	def __init__(self, useOffsets) :
+		self.useOffsets = useOffsets
+		# key is (namespace, signature text), value is the index
+		self.signatureMap = {}
+		self.signatureCount = 0
+		self.pointerCount = 0
+		# key is namespace, value is the list of code
+		self.namespaceCodeMap = {}
+
+	def addCode(self, namespace, code) :
+		if namespace not in self.namespaceCodeMap :
+			self.namespaceCodeMap[namespace] = []
+		self.namespaceCodeMap[namespace].append(code)
+
+	def getNamespaceCodeList(self) :
+		result = []
+		for namespace, codeList in self.namespaceCodeMap.items() :
+			if namespace != '' :
+				result.append('namespace %s {' % namespace)
+				result.append('')
+			result.append('namespace {')
+			result.append('')
+			result += codeList
+			result.append('} // namespace')
+			result.append('')
+			if namespace != '' :
+				result.append('} // namespace %s' % namespace)
+				result.append('')
+		return result
+
+	# The signature doesn't depend on the class. A member function is called through a trampoline which takes
+	# the instance as void *, so the member functions of different classes with the same parameters share the thunk.
+	def getSignatureType(self, method) :
+		parameterTypeList = method['parameterTypeList']
+		if not method['isStatic'] :
+			parameterTypeList = [ 'void *' ] + parameterTypeList
+		return '%s (*)(%s)' % (method['returnType'], ', '.join(parameterTypeList))
+
+	# Returns the index of the thunk, the functions with the same signature in the same namespace share the thunk
+	def requireSignature(self, namespace, method) :
+		signatureType = self.getSignatureType(method)
+		key = (namespace, signatureType)
+		if key in self.signatureMap :
+			return self.signatureMap[key]
+		index = self.signatureCount
+		self.signatureCount += 1
+		self.signatureMap[key] = index
+		returnType = method['returnType']
+		parameterTypeList = method['parameterTypeList']
+		argumentList = makeArgumentList(parameterTypeList)
+		if not method['isStatic'] :
+			argumentList = '\t\tinstance' + (',\n' + argumentList if len(parameterTypeList) > 0 else '')
+		if argumentList == '' :
+			call = 'func()'
+		else :
+			call = 'func(\n%s\n\t)' % argumentList
+		code = []
+		code.append('// %s' % signatureType)
+		code.append('using Signature%d = %s;' % (index, signatureType))
+		code.append('')
+		code.append('metapp::Variant thunk%d(const void * data, void * %s, const metapp::ArgumentSpan & %s)' % (
+			index,
+			'/*instance*/' if method['isStatic'] else 'instance',
+			'arguments' if len(parameterTypeList) > 0 else '/*arguments*/'
+		))
+		code.append('{')
+		code.append('\tconst Signature%d func = *static_cast<const Signature%d *>(data);' % (index, index))
+		if returnType == 'void' :
+			code.append('\t%s;' % call)
+			code.append('\treturn metapp::Variant();')
+		else :
+			code.append('\treturn metapp::Variant::create<%s>(%s);' % (returnType, call))
+		code.append('}')
+		code.append('')
+		code.append('const metapp::MetaType * getReturnType%d()' % index)
+		code.append('{')
+		code.append('\treturn metapp::getMetaType<%s>();' % returnType)
+		code.append('}')
+		code.append('')
+		code.append('const metapp::MetaType * const * getParameterTypes%d()' % index)
+		code.append('{')
+		if len(parameterTypeList) == 0 :
+			code.append('\treturn nullptr;')
+		else :
+			code.append('\tstatic const metapp::MetaType * const parameterTypes[] = {')
+			for parameterType in parameterTypeList :
+				code.append('\t\tmetapp::getMetaType<%s>(),' % parameterType)
+			code.append('\t};')
+			code.append('\treturn parameterTypes;')
+		code.append('}')
+		code.append('')
+		self.addCode(namespace, '\n'.join(code))
+		return index
+
+	# Returns the code of the pointer which is passed to the thunk as the data.
+	# A member function is wrapped in a trampoline, which has the signature of the thunk.
+	def makePointerCode(self, className, method, signatureIndex, pointerIndex) :
+		if method['isStatic'] :
+			return 'const Signature%d pointer%d = &%s::%s;' % (signatureIndex, pointerIndex, className, method['name'])
+		parameterTypeList = method['parameterTypeList']
+		parameters = ''.join([ ', %s p%d' % (t, i) for i, t in enumerate(parameterTypeList) ])
+		arguments = ', '.join([ 'std::forward<%s>(p%d)' % (t, i) for i, t in enumerate(parameterTypeList) ])
+		return 'const Signature%d pointer%d = [](void * instance%s) -> %s {\n\treturn static_cast<%s%s *>(instance)->%s(%s);\n};' % (
+			signatureIndex,
+			pointerIndex,
+			parameters,
+			method['returnType'],
+			'const ' if method['isConst'] else '',
+			className,
+			method['name'],
+			arguments
+		)
+
+	def generateClass(self, theClass) :
+		className = theClass['name']
+		namespace = theClass['namespace']
+		prefix = namespace + '::' if namespace != '' else ''
+		identifier = makeIdentifier(className)
+		registerCodeList = []
+		for field in theClass['fieldList'] :
+			registerCodeList.append('\t\t\tmc.registerAccessible("%s", &%s::%s);' % (field['name'], className, field['name']))
+		overloadCountMap = {}
+		pointerCodeList = []
+		for method in theClass['methodList'] :
+			signatureIndex = self.requireSignature(namespace, method)
+			pointerIndex = self.pointerCount
+			self.pointerCount += 1
+			pointerCodeList.append(self.makePointerCode(className, method, signatureIndex, pointerIndex))
+			registerCodeList.append(
+				'\t\t\tmc.registerCallable("%s", metapp::ThunkFunction(&%sthunk%d, &%spointer%d, %s, %sgetReturnType%d(), %sgetParameterTypes%d(), %d));' % (
+					method['name'],
+					prefix,
+					signatureIndex,
+					prefix,
+					pointerIndex,
+					'metapp::voidMetaType' if method['isStatic'] else 'metapp::getMetaType<%s>()' % className,
+					prefix,
+					signatureIndex,
+					prefix,
+					signatureIndex,
+					len(method['parameterTypeList'])
+				)
+			)
+			overloadCountMap[method['name']] = overloadCountMap.get(method['name'], 0) + 1
+
+		code = pointerCodeList + [ '' ]
+		code.append('const metapp::RegistrationEntry %sFields[] = {' % identifier)
+		for field in sorted(theClass['fieldList'], key = lambda item : (hashName(item['name']), item['name'])) :
+			code.append('\t{ "%s", 0x%08xu, %s },' % (
+				field['name'],
+				hashName(field['name']),
+				'offsetof(%s, %s)' % (className, field['name']) if self.useOffsets else '0'
+			))
+		if len(theClass['fieldList']) == 0 :
+			code.append('\t{ "", 0, 0 }')
+		code.append('};')
+		code.append('')
+		code.append('const metapp::RegistrationEntry %sCallables[] = {' % identifier)
+		for name in sorted(overloadCountMap.keys(), key = lambda item : (hashName(item), item)) :
+			code.append('\t{ "%s", 0x%08xu, %d },' % (name, hashName(name), overloadCountMap[name]))
+		if len(overloadCountMap) == 0 :
+			code.append('\t{ "", 0, 0 }')
+		code.append('};')
+		code.append('')
+		self.addCode(namespace, '\n'.join(code))
+
+		code = []
+		code.append('const metapp::MetaClass * metapp::DeclareMetaType<%s>::getMetaClass()' % className)
+		code.append('{')
+		code.append('\tstatic const metapp::MetaClass metaClass(')
+		code.append('\t\tmetapp::getMetaType<%s>(),' % className)
+		code.append('\t\t[](metapp::MetaClass & %s) {' % ('mc' if len(registerCodeList) > 0 else '/*mc*/'))
+		code += registerCodeList
+		code.append('\t\t}')
+		code.append('\t);')
+		code.append('\treturn &metaClass;')
+		code.append('}')
+		code.append('')
+		code.append('const metapp::RegistrationTable & metapp::DeclareMetaType<%s>::getRegistrationTable()' % className)
+		code.append('{')
+		code.append('\tstatic const metapp::RegistrationTable registrationTable {')
+		code.append('\t\t%s%sFields, %d,' % (prefix, identifier, len(theClass['fieldList'])))
+		code.append('\t\t%s%sCallables, %d' % (prefix, identifier, len(overloadCountMap)))
+		code.append('\t};')
+		code.append('\treturn registrationTable;')
+		code.append('}')
+		code.append('')
+		return '\n'.join(code)
+
+	def generateDeclaration(self, theClass) :
+		className = theClass['name']
+		code = []
+		code.append('template <>')
+		code.append('struct metapp::DeclareMetaType <%s> : metapp::DeclareMetaTypeBase <%s>' % (className, className))
+		code.append('{')
+		code.append('\tstatic const metapp::MetaClass * getMetaClass();')
+		code.append('\tstatic const metapp::RegistrationTable & getRegistrationTable();')
+		code.append('};')
+		code.append('')
+		return '\n'.join(code)
+
+def generateFiles(headerFileName, outputPath, includePrefix, useOffsets) :
+	classList = parseHeader(headerFileName)
+	baseName = os.path.splitext(os.path.basename(headerFileName))[0]
+	outputHeaderName = baseName + '_registration.h'
+	outputSourceName = baseName + '_registration.cpp'
+	guard = 'METAPP_GENERATED_%s_REGISTRATION_H' % makeIdentifier(baseName).upper()
+	generator = Generator(useOffsets)
+
+	header = []
+	header.append('// Generated by tools/genregistration.py from %s, do not edit.' % os.path.basename(headerFileName))
+	header.append('')
+	header.append('#ifndef %s' % guard)
+	header.append('#define %s' % guard)
+	header.append('')
+	header.append('#include "%s%s"' % (includePrefix, os.path.basename(headerFileName)))
+	header.append('#include "metapp/metatype.h"')
+	header.append('#include "metapp/utilities/registrationtable.h"')
+	header.append('')
+	for theClass in classList :
+		header.append(generator.generateDeclaration(theClass))
+	header.append('#endif')
+	header.append('')
+
+	functionCodeList = []
+	for theClass in classList :
+		functionCodeList.append(generator.generateClass(theClass))
+
+	source = []
+	source.append('// Generated by tools/genregistration.py from %s, do not edit.' % os.path.basename(headerFileName))
+	source.append('')
+	source.append('#include "%s"' % outputHeaderName)
+	source.append('#include "metapp/allmetatypes.h"')
+	if generator.signatureCount > 0 :
+		source.append('#include "metapp/metatypes/thunk_function.h"')
+	source.append('#include "metapp/interfaces/metaclass.h"')
+	source.append('')
+	source.append('#include <cstddef>')
+	source.append('#include <utility>')
+	source.append('')
+	source += generator.getNamespaceCodeList()
+	source += functionCodeList
+
+	with open(os.path.join(outputPath, outputHeaderName), 'w') as file :
+		file.write('\n'.join(header))
+	with open(os.path.join(outputPath, outputSourceName), 'w') as file :
+		file.write('\n'.join(source))
+	print('Generate %s and %s, %d classes, %d thunks' % (outputHeaderName, outputSourceName, len(classList), generator.signatureCount))
+
+# Writes sample.h which contains `count` annotated classes, and sample_manual.h which registers the same classes
+# by hand in DeclareMetaType, to compare the compile time and the binary size.
+def generateSample(count, outputPath) :
+	header = []
+	manual = []
+	header.append('// Generated by tools/genregistration.py --sample %d' % count)
+	header.append('')
+	header.append('#ifndef METAPP_GENERATED_SAMPLE_H')
+	header.append('#define METAPP_GENERATED_SAMPLE_H')
+	header.append('')
+	header.append('#include <string>')
+	header.append('#include <vector>')
+	header.append('')
+	header.append('namespace sample {')
+	header.append('')
+	manual.append('// Generated by tools/genregistration.py --sample %d' % count)
+	manual.append('')
+	manual.append('#ifndef METAPP_GENERATED_SAMPLE_MANUAL_H')
+	manual.append('#define METAPP_GENERATED_SAMPLE_MANUAL_H')
+	manual.append('')
+	manual.append('#include "sample.h"')
+	manual.append('#include "metapp/allmetatypes.h"')
+	manual.append('#include "metapp/interfaces/metaclass.h"')
+	manual.append('')
+	for i in range(count) :
+		name = 'Sample%d' % i
+		header.append('//metapp:reflect')
+		header.append('struct %s' % name)
+		header.append('{')
+		header.append('\t//metapp:field')
+		header.append('\tint value;')
+		header.append('\t//metapp:field')
+		header.append('\tdouble ratio;')
+		header.append('\t//metapp:field')
+		header.append('\tstd::string name;')
+		header.append('\t//metapp:field')
+		header.append('\tstd::vector<int> items;')
+		header.append('')
+		header.append('\t//metapp:method')
+		header.append('\tint getValue() const { return value; }')
+		header.append('\t//metapp:method')
+		header.append('\tint getSize() const { return (int)items.size(); }')
+		header.append('\t//metapp:method')
+		header.append('\tvoid setValue(const int newValue) { value = newValue + %d; }' % i)
+		header.append('\t//metapp:method')
+		header.append('\tconst std::string & getName() const { return name; }')
+		header.append('\t//metapp:method')
+		header.append('\tvoid setName(const std::string & newName) { name = newName; }')
+		header.append('\t//metapp:method')
+		header.append('\tdouble scale(double factor, int offset) const { return ratio * factor + offset; }')
+		header.append('\t//metapp:method')
+		header.append('\tint compute(int a) { return a * %d; }' % (i + 1))
+		header.append('\t//metapp:method')
+		header.append('\tint compute(int a, int b) { return a * b + %d; }' % i)
+		header.append('\t//metapp:method')
+		header.append('\tstatic %s create(int value) { %s result {}; result.value = value; return result; }' % (name, name))
+		header.append('};')
+		header.append('')
+
+		qualifiedName = 'sample::' + name
+		manual.append('template <>')
+		manual.append('struct metapp::DeclareMetaType <%s> : metapp::DeclareMetaTypeBase <%s>' % (qualifiedName, qualifiedName))
+		manual.append('{')
+		manual.append('\tstatic const metapp::MetaClass * getMetaClass() {')
+		manual.append('\t\tstatic const metapp::MetaClass metaClass(')
+		manual.append('\t\t\tmetapp::getMetaType<%s>(),' % qualifiedName)
+		manual.append('\t\t\t[](metapp::MetaClass & mc) {')
+		for field in [ 'value', 'ratio', 'name', 'items' ] :
+			manual.append('\t\t\t\tmc.registerAccessible("%s", &%s::%s);' % (field, qualifiedName, field))
+		for method in [ 'getValue', 'getSize', 'setValue', 'getName', 'setName', 'scale', 'create' ] :
+			manual.append('\t\t\t\tmc.registerCallable("%s", &%s::%s);' % (method, qualifiedName, method))
+		manual.append('\t\t\t\tmc.registerCallable("compute", static_cast<int (%s::*)(int)>(&%s::compute));' % (qualifiedName, qualifiedName))
+		manual.append('\t\t\t\tmc.registerCallable("compute", static_cast<int (%s::*)(int, int)>(&%s::compute));' % (qualifiedName, qualifiedName))
+		manual.append('\t\t\t}')
+		manual.append('\t\t);')
+		manual.append('\t\treturn &metaClass;')
+		manual.append('\t}')
+		manual.append('};')
+		manual.append('')
+	header.append('} // namespace sample')
+	header.append('')
+	header.append('#endif')
+	header.append('')
+	manual.append('#endif')
+	manual.append('')
+	with open(os.path.join(outputPath, 'sample.h'), 'w') as file :
+		file.write('\n'.join(header))
+	with open(os.path.join(outputPath, 'sample_manual.h'), 'w') as file :
+		file.write('\n'.join(manual))
+	print('Generate sample.h and sample_manual.h, %d classes' % count)
+
+def doMain() :
+	parser = argparse.ArgumentParser(description = 'Generate metapp registration code from annotated headers.')
+	parser.add_argument('headers', nargs = '*', help = 'the annotated header files')
+	parser.add_argument('--output', default = '.', help = 'the directory to write the generated files')
+	parser.add_argument('--include-prefix', default = '', help = 'the prefix of the header path in the generated #include')
+	parser.add_argument('--no-offsets', action = 'store_true', help = 'don\'t use offsetof in the field tables, for non standard layout classes')
+	parser.add_argument('--sample', type = int, default = 0, help = 'generate a sample of COUNT classes instead')
+	args = parser.parse_args()
+	if not os.path.exists(args.output) :
+		os.makedirs(args.output)
+	if args.sample > 0 :
+		generateSample(args.sample, args.output)
+		return
+	if len(args.headers) == 0 :
+		parser.print_help()
+		sys.exit(1)
+	for headerFileName in args.headers :
+		generateFiles(headerFileName, args.output, args.include_prefix, not args.no_offsets)
+
+doMain()